@@ -164,6 +164,8 @@ void PreProcessPhysics::DefineContract( Helium::TaskContract &rContract )
 {
 	rContract.ExecutesWithin<Helium::StandardDependencies::ProcessPhysics>();
 	rContract.ExecuteBefore<Helium::ProcessPhysics>();
+	rContract.ReadsComponents<Helium::TransformComponent>();
+	rContract.WritesComponents<BulletBodyComponent>();
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -187,4 +189,6 @@ void PostProcessPhysics::DefineContract( Helium::TaskContract &rContract )
 {
 	rContract.ExecutesWithin<Helium::StandardDependencies::ProcessPhysics>();
 	rContract.ExecuteAfter<Helium::ProcessPhysics>();
+	rContract.ReadsComponents<BulletBodyComponent>();
+	rContract.WritesComponents<Helium::TransformComponent>();
 }
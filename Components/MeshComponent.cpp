@@ -200,7 +200,7 @@ void MeshComponent::GraphicsSceneObjectUpdate(
 			worldBounds.TransformBy( transform );
 		}
 
-		pSceneObject->SetWorldBounds( worldBounds );
+		pScene->SetSceneObjectWorldBounds( graphicsSceneObjectId, worldBounds );
 
 		return;
 	}
@@ -216,7 +216,7 @@ void MeshComponent::GraphicsSceneObjectUpdate(
 		worldBounds.TransformBy( transform );
 	}
 
-	pSceneObject->SetWorldBounds( worldBounds );
+	pScene->SetSceneObjectWorldBounds( graphicsSceneObjectId, worldBounds );
 
 	const DynamicArray< size_t >& rSubMeshDataIds = pThis->m_graphicsSceneObjectSubMeshDataIds;
 	size_t subMeshCount = rSubMeshDataIds.GetSize();
@@ -346,11 +346,9 @@ void Helium::MeshSceneObjectTransform::GraphicsSceneObjectUpdate( GraphicsScene
 
 //////////////////////////////////////////////////////////////////////////
 
-static GraphicsScene *pGraphicsScene = NULL;
-
-void UpdateMeshComponent(TransformComponent *pTransform, MeshComponent *pMeshComponent)
+void UpdateMeshComponent(TransformComponent *pTransform, MeshComponent *pMeshComponent, GraphicsScene &rGraphicsScene)
 {
-	pMeshComponent->Update( pGraphicsScene, pTransform );
+	pMeshComponent->Update( &rGraphicsScene, pTransform );
 }
 
 void UpdateMeshComponents( World *pWorld )
@@ -358,10 +356,10 @@ void UpdateMeshComponents( World *pWorld )
 	GraphicsManagerComponent *pGraphicsManager = pWorld->GetComponents().GetFirst<GraphicsManagerComponent>();
 	HELIUM_ASSERT( pGraphicsManager );
 
-	pGraphicsScene = pGraphicsManager->GetGraphicsScene();
+	GraphicsScene *pGraphicsScene = pGraphicsManager->GetGraphicsScene();
 	HELIUM_ASSERT( pGraphicsScene );
 
-	QueryComponents< TransformComponent, MeshComponent, UpdateMeshComponent >( pWorld );
+	QueryComponents< TransformComponent, MeshComponent, GraphicsScene, UpdateMeshComponent >( pWorld, *pGraphicsScene );
 }
 
 void Helium::UpdateMeshComponentsTask::DefineContract( TaskContract &rContract )
@@ -57,6 +57,7 @@ void ClearTransformComponentDirtyFlags( TransformComponent *pComponent )
 void Helium::ClearTransformComponentDirtyFlagsTask::DefineContract( TaskContract &rContract )
 {
 	rContract.ExecuteAfter<StandardDependencies::Render>();
+	rContract.WritesComponents<TransformComponent>();
 }
 
 //HELIUM_DEFINE_TASK(ClearTransformComponentDirtyFlagsTask, ForEachWorld<ClearTransformComponentDirtyFlags> )
@@ -28,6 +28,7 @@
 #include "Engine/Asset.h"
 
 #include "EngineJobs/EngineJobs.h"
+#include "EngineJobs/JobManager.h"
 
 #include "GraphicsJobs/GraphicsJobs.h"
 
@@ -59,6 +60,7 @@
 #include "Editor/Dialogs/PerforceWaitDialog.h"
 #include "Editor/Vault/VaultSettings.h"
 
+#include "Editor/Commands/CookCommand.h"
 #include "Editor/Commands/ProfileDumpCommand.h"
 
 #include "Editor/Clipboard/ClipboardDataWrapper.h"
@@ -225,6 +227,11 @@ bool App::OnInit()
 	HELIUM_VERIFY( asyncLoader.Initialize() );
 	m_InitializerStack.Push( AsyncLoader::DestroyStaticInstance );
 
+	// Job worker threads.
+	JobManager& jobManager = JobManager::GetStaticInstance();
+	HELIUM_VERIFY( jobManager.Initialize() );
+	m_InitializerStack.Push( JobManager::DestroyStaticInstance );
+
 	// Asset cache management.
 	FilePath baseDirectory;
 	if ( !FileLocations::GetBaseDirectory( baseDirectory ) )
@@ -628,6 +635,10 @@ int Main( int argc, const char** argv )
 	success &= profileDumpCommand.Initialize( error );
 	success &= processor.RegisterCommand( &profileDumpCommand, error );
 
+	CookCommand cookCommand;
+	success &= cookCommand.Initialize( error );
+	success &= processor.RegisterCommand( &cookCommand, error );
+
 	Helium::CommandLine::HelpCommand helpCommand;
 	helpCommand.SetOwner( &processor );
 	success &= helpCommand.Initialize( error );
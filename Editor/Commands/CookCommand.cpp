@@ -0,0 +1,211 @@
+#include "EditorPch.h"
+#include "CookCommand.h"
+
+#include "Platform/Process.h"
+
+#include "Foundation/Log.h"
+#include "Foundation/FilePath.h"
+#include "Foundation/Name.h"
+#include "Foundation/DirectoryIterator.h"
+
+#include "Reflect/Registry.h"
+
+#include "Application/InitializerStack.h"
+
+#include "Engine/FileLocations.h"
+#include "Engine/AsyncLoader.h"
+#include "Engine/AssetLoader.h"
+#include "Engine/CacheManager.h"
+#include "Engine/Asset.h"
+
+#include "EngineJobs/EngineJobs.h"
+#include "EngineJobs/JobManager.h"
+
+#include "PcSupport/AssetCooker.h"
+#include "PcSupport/AssetPreprocessor.h"
+#include "PcSupport/LooseAssetLoader.h"
+#include "PcSupport/PlatformPreprocessor.h"
+
+#include "PreprocessingPc/PcPreprocessor.h"
+
+#include "EditorScene/EditorSceneInit.h"
+
+#include <algorithm>
+
+using namespace Helium;
+using namespace Helium::Editor;
+
+CookCommand::CookCommand()
+	: Command( TXT( "cook" ), TXT( "[<PACKAGE>...]" ), TXT( "Preprocess and cache assets without starting the editor (all root packages if none are given)" ) )
+	, m_Compact( false )
+	, m_NoDictionary( false )
+{
+
+}
+
+bool CookCommand::Initialize( std::string& error )
+{
+	bool success = true;
+	success &= AddOption( new CommandLine::FlagOption( &m_Compact, TXT( "compact" ), TXT( "compact the caches once cooking is done, reclaiming the space used by superseded entries and training their compression dictionaries" ) ), error );
+	success &= AddOption( new CommandLine::FlagOption( &m_NoDictionary, TXT( "no_dictionary" ), TXT( "keep the existing compression dictionaries when compacting" ) ), error );
+
+	return success;
+}
+
+static bool CompareTimings( const AssetCooker::AssetTiming& rA, const AssetCooker::AssetTiming& rB )
+{
+	return ( rA.preprocessMs + rA.cacheMs ) > ( rB.preprocessMs + rB.cacheMs );
+}
+
+static bool InitializeCookSystems( InitializerStack& rInitializerStack, std::string& error )
+{
+	// Initialize sibling dynamically loaded modules.
+	Helium::FilePath path ( Helium::GetProcessPath() );
+	for ( DirectoryIterator itr ( FilePath( path.Directory() ) ); !itr.IsDone(); itr.Next() )
+	{
+		std::string ext = itr.GetItem().m_Path.Extension();
+		if ( ext == HELIUM_MODULE_EXTENSION )
+		{
+			ModuleHandle module = LoadModule( itr.GetItem().m_Path.c_str() );
+			HELIUM_ASSERT( module != HELIUM_INVALID_MODULE );
+		}
+	}
+
+	// Make sure various module-specific heaps are initialized from the main thread before use.
+	InitEngineJobsDefaultHeap();
+
+	// Register shutdown for general systems.
+	rInitializerStack.Push( FileLocations::Shutdown );
+	rInitializerStack.Push( Name::Shutdown );
+	rInitializerStack.Push( AssetPath::Shutdown );
+
+	// Async I/O.
+	AsyncLoader& asyncLoader = AsyncLoader::GetStaticInstance();
+	HELIUM_VERIFY( asyncLoader.Initialize() );
+	rInitializerStack.Push( AsyncLoader::DestroyStaticInstance );
+
+	// Job worker threads.
+	JobManager& jobManager = JobManager::GetStaticInstance();
+	HELIUM_VERIFY( jobManager.Initialize() );
+	rInitializerStack.Push( JobManager::DestroyStaticInstance );
+
+	// Asset cache management.
+	FilePath baseDirectory;
+	if ( !FileLocations::GetBaseDirectory( baseDirectory ) )
+	{
+		error = TXT( "Could not get base directory." );
+		return false;
+	}
+
+	HELIUM_VERIFY( CacheManager::InitializeStaticInstance( baseDirectory ) );
+	rInitializerStack.Push( CacheManager::DestroyStaticInstance );
+
+	// libs
+	rInitializerStack.Push( Reflect::ObjectRefCountSupport::Shutdown );
+	rInitializerStack.Push( Asset::Shutdown );
+	rInitializerStack.Push( AssetType::Shutdown );
+	rInitializerStack.Push( Reflect::Initialize, Reflect::Cleanup );
+	rInitializerStack.Push( Editor::Initialize,  Editor::Cleanup );
+
+	// Asset loader and preprocessor.
+	HELIUM_VERIFY( LooseAssetLoader::InitializeStaticInstance() );
+	rInitializerStack.Push( LooseAssetLoader::DestroyStaticInstance );
+
+	AssetPreprocessor* pAssetPreprocessor = AssetPreprocessor::CreateStaticInstance();
+	HELIUM_ASSERT( pAssetPreprocessor );
+	PlatformPreprocessor* pPlatformPreprocessor = new PcPreprocessor;
+	HELIUM_ASSERT( pPlatformPreprocessor );
+	pAssetPreprocessor->SetPlatformPreprocessor( Cache::PLATFORM_PC, pPlatformPreprocessor );
+
+	rInitializerStack.Push( AssetPreprocessor::DestroyStaticInstance );
+
+	return true;
+}
+
+bool CookCommand::Process( std::vector< std::string >::const_iterator& argsBegin, const std::vector< std::string >::const_iterator& argsEnd, std::string& error )
+{
+	m_Compact = false;
+	m_NoDictionary = false;
+	if ( !ParseOptions( argsBegin, argsEnd, error ) )
+	{
+		return false;
+	}
+
+	DynamicArray< AssetPath > packagePaths;
+	while ( argsBegin != argsEnd )
+	{
+		const std::string& arg = (*argsBegin);
+		++argsBegin;
+
+		AssetPath packagePath;
+		if ( !packagePath.Set( arg.c_str() ) || packagePath.IsEmpty() )
+		{
+			error = TXT( "Invalid package path: " ) + arg;
+			return false;
+		}
+
+		packagePaths.Push( packagePath );
+	}
+
+	InitializerStack initializerStack;
+	if ( !InitializeCookSystems( initializerStack, error ) )
+	{
+		initializerStack.Cleanup();
+		return false;
+	}
+
+	bool bSuccess;
+	{
+		AssetCooker cooker;
+		bSuccess = ( packagePaths.IsEmpty() ? cooker.CookAll() : cooker.Cook( packagePaths ) );
+
+		DynamicArray< AssetCooker::AssetTiming > timings = cooker.GetAssetTimings();
+		std::sort( timings.GetData(), timings.GetData() + timings.GetSize(), CompareTimings );
+
+		float preprocessMs = 0.0f;
+		float cacheMs = 0.0f;
+
+		Log::Print( TXT( "%10s %10s  %s\n" ), TXT( "Preprocess" ), TXT( "Cache" ), TXT( "Asset" ) );
+		for ( size_t timingIndex = 0; timingIndex < timings.GetSize(); ++timingIndex )
+		{
+			const AssetCooker::AssetTiming& rTiming = timings[ timingIndex ];
+			preprocessMs += rTiming.preprocessMs;
+			cacheMs += rTiming.cacheMs;
+
+			Log::Print(
+				TXT( "%8.2fms %8.2fms  %s%s\n" ),
+				rTiming.preprocessMs,
+				rTiming.cacheMs,
+				*rTiming.path.ToString(),
+				( rTiming.bSuccess ? TXT( "" ) : TXT( " (FAILED)" ) ) );
+		}
+
+		Log::Print(
+			( TXT( "Cooked %" ) PRIuSZ TXT( " assets (%" ) PRIuSZ TXT( " failed), %.2fms preprocessing, %.2fms caching.\n" ) ),
+			timings.GetSize(),
+			cooker.GetFailureCount(),
+			preprocessMs,
+			cacheMs );
+
+		if ( !bSuccess )
+		{
+			error = TXT( "Failed to cook one or more assets." );
+		}
+	}
+
+	// Compact even if some assets failed, as everything else was still cached.  Compaction is also where each cache's
+	// compression dictionary is trained on its cooked data, and the dictionary is written with the compacted TOC.
+	if ( m_Compact && !CacheManager::GetStaticInstance().CompactCaches( !m_NoDictionary ) )
+	{
+		if ( bSuccess )
+		{
+			error = TXT( "Failed to compact one or more caches." );
+		}
+
+		bSuccess = false;
+	}
+
+	initializerStack.Cleanup();
+
+	return bSuccess;
+}
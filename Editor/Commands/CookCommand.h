@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Application/CmdLineProcessor.h"
+
+namespace Helium
+{
+    namespace Editor
+    {
+        class CookCommand : public Helium::CommandLine::Command
+        {
+        public:
+            CookCommand();
+
+            virtual bool Initialize( std::string& error ) override;
+            virtual bool Process( std::vector< std::string >::const_iterator& argsBegin, const std::vector< std::string >::const_iterator& argsEnd, std::string& error ) override;
+
+        private:
+            bool m_Compact;
+            bool m_NoDictionary;
+        };
+    }
+}
\ No newline at end of file
@@ -37,6 +37,12 @@ const AssetType* AnimationResourceHandler::GetResourceType() const
     return Animation::GetStaticType();
 }
 
+/// @copydoc ResourceHandler::GetVersion()
+uint32_t AnimationResourceHandler::GetVersion() const
+{
+    return 1;
+}
+
 /// @copydoc ResourceHandler::GetSourceExtensions()
 void AnimationResourceHandler::GetSourceExtensions(
     const char* const*& rppExtensions,
@@ -118,6 +118,7 @@ static void* FreeTypeReallocate( FT_Memory /*pMemory*/, long currentSize, long n
 static FT_MemoryRec_ s_freeTypeMemory = { NULL, FreeTypeAllocate, FreeTypeFree, FreeTypeReallocate };
 
 FT_Library FontResourceHandler::sm_pLibrary = NULL;
+Mutex FontResourceHandler::sm_libraryLock;
 int32_t FontResourceHandler::sm_InitCount = 0;
 
 
@@ -151,6 +152,12 @@ const AssetType* FontResourceHandler::GetResourceType() const
     return Font::GetStaticType();
 }
 
+/// @copydoc ResourceHandler::GetVersion()
+uint32_t FontResourceHandler::GetVersion() const
+{
+    return 1;
+}
+
 /// @copydoc ResourceHandler::GetSourceExtensions()
 void FontResourceHandler::GetSourceExtensions( const char* const*& rppExtensions, size_t& rExtensionCount ) const
 {
@@ -160,6 +167,14 @@ void FontResourceHandler::GetSourceExtensions( const char* const*& rppExtensions
     rExtensionCount = HELIUM_ARRAY_COUNT( extensions );
 }
 
+/// @copydoc ResourceHandler::CanCacheConcurrently()
+bool FontResourceHandler::CanCacheConcurrently() const
+{
+    // Font faces are created from a shared FreeType library instance, but face creation and destruction are
+    // serialized, and each face is only ever used by the thread that created it.
+    return true;
+}
+
 /// @copydoc ResourceHandler::CacheResource()
 bool FontResourceHandler::CacheResource(
     AssetPreprocessor* pAssetPreprocessor,
@@ -233,7 +248,12 @@ bool FontResourceHandler::CacheResource(
     HELIUM_ASSERT( pLibrary );
 
     FT_Face pFace = NULL;
-    FT_Error error = FT_New_Memory_Face( pLibrary, pFileData, static_cast< FT_Long >( bytesRead ), 0, &pFace );
+    FT_Error error;
+    {
+        MutexScopeLock libraryLock( sm_libraryLock );
+        error = FT_New_Memory_Face( pLibrary, pFileData, static_cast< FT_Long >( bytesRead ), 0, &pFace );
+    }
+
     if( error != 0 )
     {
         HELIUM_TRACE(
@@ -258,7 +278,7 @@ bool FontResourceHandler::CacheResource(
             TXT( "FontResourceHandler: Failed to set size of font resource \"%s\".\n" ),
             *rSourceFilePath );
 
-        FT_Done_Face( pFace );
+        DestroyFace( pFace );
         delete [] pFileData;
 
         return false;
@@ -290,7 +310,7 @@ bool FontResourceHandler::CacheResource(
             textureSheetHeight,
             *pResource->GetPath().ToString() );
 
-        FT_Done_Face( pFace );
+        DestroyFace( pFace );
         delete [] pFileData;
 
         return false;
@@ -307,7 +327,7 @@ bool FontResourceHandler::CacheResource(
             textureSheetWidth,
             *pResource->GetPath().ToString() );
 
-        FT_Done_Face( pFace );
+        DestroyFace( pFace );
         delete [] pFileData;
 
         return false;
@@ -327,7 +347,7 @@ bool FontResourceHandler::CacheResource(
             texturePixelCount,
             *pResource->GetPath().ToString() );
 
-        FT_Done_Face( pFace );
+        DestroyFace( pFace );
         delete [] pFileData;
 
         return false;
@@ -493,7 +513,7 @@ bool FontResourceHandler::CacheResource(
     // Done processing the font itself, so free some resources.
     delete [] pTextureBuffer;
 
-    FT_Done_Face( pFace );
+    DestroyFace( pFace );
     delete [] pFileData;
 
     // Cache the font data.
@@ -563,6 +583,17 @@ void FontResourceHandler::DestroyStaticLibrary()
     }
 }
 
+/// Destroy a font face created from the static FreeType library instance.
+///
+/// @param[in] pFace  Font face to destroy.
+void FontResourceHandler::DestroyFace( FT_Face pFace )
+{
+    HELIUM_ASSERT( pFace );
+
+    MutexScopeLock libraryLock( sm_libraryLock );
+    FT_Done_Face( pFace );
+}
+
 /// Get the static FreeType library instance.
 ///
 /// @return  Handle for the static FreeType library instance.
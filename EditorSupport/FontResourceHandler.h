@@ -4,6 +4,8 @@
 
 #if HELIUM_TOOLS
 
+#include "Platform/Locks.h"
+
 #include "PcSupport/ResourceHandler.h"
 
 #include "Graphics/Font.h"
@@ -29,6 +31,8 @@ namespace Helium
         //@{
         virtual const AssetType* GetResourceType() const override;
         virtual void GetSourceExtensions( const char* const*& rppExtensions, size_t& rExtensionCount ) const override;
+        virtual uint32_t GetVersion() const override;
+        virtual bool CanCacheConcurrently() const override;
 
         virtual bool CacheResource(
             AssetPreprocessor* pAssetPreprocessor, Resource* pResource, const String& rSourceFilePath ) override;
@@ -44,8 +48,15 @@ namespace Helium
     private:
         /// FreeType library instance.
         static FT_Library sm_pLibrary;
+        /// Lock held while creating or destroying font faces using the FreeType library instance.
+        static Mutex sm_libraryLock;
 		static int32_t sm_InitCount;
 
+        /// @name Font Face Support
+        //@{
+        static void DestroyFace( FT_Face pFace );
+        //@}
+
         /// @name Texture Sheet Compression
         //@{
         static void CompressTexture(
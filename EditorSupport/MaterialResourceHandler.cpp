@@ -28,6 +28,12 @@ const AssetType* MaterialResourceHandler::GetResourceType() const
     return Material::GetStaticType();
 }
 
+/// @copydoc ResourceHandler::GetVersion()
+uint32_t MaterialResourceHandler::GetVersion() const
+{
+    return 1;
+}
+
 /// @copydoc ResourceHandler::CacheResource()
 bool MaterialResourceHandler::CacheResource(
     AssetPreprocessor* pAssetPreprocessor,
@@ -23,6 +23,7 @@ namespace Helium
         /// @name Resource Handling Support
         //@{
         virtual const AssetType* GetResourceType() const override;
+        virtual uint32_t GetVersion() const override;
 
         virtual bool CacheResource(
             AssetPreprocessor* pAssetPreprocessor, Resource* pResource, const String& rSourceFilePath ) override;
@@ -34,6 +34,12 @@ const AssetType* MeshResourceHandler::GetResourceType() const
 	return Mesh::GetStaticType();
 }
 
+/// @copydoc ResourceHandler::GetVersion()
+uint32_t MeshResourceHandler::GetVersion() const
+{
+	return 1;
+}
+
 /// @copydoc ResourceHandler::GetSourceExtensions()
 void MeshResourceHandler::GetSourceExtensions( const char* const*& rppExtensions, size_t& rExtensionCount ) const
 {
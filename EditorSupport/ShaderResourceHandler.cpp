@@ -32,6 +32,12 @@ const AssetType* ShaderResourceHandler::GetResourceType() const
     return Shader::GetStaticType();
 }
 
+/// @copydoc ResourceHandler::GetVersion()
+uint32_t ShaderResourceHandler::GetVersion() const
+{
+    return 1;
+}
+
 /// @copydoc ResourceHandler::GetSourceExtensions()
 void ShaderResourceHandler::GetSourceExtensions(
     const char* const*& rppExtensions,
@@ -43,6 +49,134 @@ void ShaderResourceHandler::GetSourceExtensions(
     rExtensionCount = HELIUM_ARRAY_COUNT( extensions );
 }
 
+/// @copydoc ResourceHandler::GetSourceDependencies()
+void ShaderResourceHandler::GetSourceDependencies(
+    const Resource* /*pResource*/,
+    const String& rSourceFilePath,
+    DynamicArray< FilePath >& rDependencies ) const
+{
+    GetIncludeFiles( rSourceFilePath, rDependencies );
+}
+
+/// Get the files included by a shader source file, either directly or through other included files.
+///
+/// Include file names are resolved relative to the directory containing the shader source file, as they are when the
+/// shader is compiled.  Files that cannot be read are still reported (so that creating them later is picked up), but
+/// are not searched for further includes.
+///
+/// @param[in]  rSourceFilePath  Path name of the shader source file.
+/// @param[out] rIncludeFiles    Array to which the path of each included file is added.
+void ShaderResourceHandler::GetIncludeFiles( const String& rSourceFilePath, DynamicArray< FilePath >& rIncludeFiles )
+{
+    FilePath shaderDirectory;
+    shaderDirectory.Set( FilePath( rSourceFilePath.GetData() ).Directory() );
+
+    size_t firstIncludeIndex = rIncludeFiles.GetSize();
+
+    DynamicArray< char > fileData;
+
+    // Search the shader source file, then each include file found so far.
+    for( size_t searchIndex = 0; firstIncludeIndex + searchIndex <= rIncludeFiles.GetSize(); ++searchIndex )
+    {
+        String fileName = ( searchIndex == 0
+            ? rSourceFilePath
+            : String( rIncludeFiles[ firstIncludeIndex + searchIndex - 1 ].c_str() ) );
+
+        FileStream* pFileStream = FileStream::OpenFileStream( fileName, FileStream::MODE_READ );
+        if( !pFileStream )
+        {
+            continue;
+        }
+
+        int64_t size64 = pFileStream->GetSize();
+        if( size64 <= 0 )
+        {
+            delete pFileStream;
+
+            continue;
+        }
+
+        size_t size = static_cast< size_t >( size64 );
+        fileData.Resize( size );
+        size = BufferedStream( pFileStream ).Read( fileData.GetData(), 1, size );
+
+        delete pFileStream;
+
+        // Find each "#include" directive at the start of a line.
+        const char* pCharacter = fileData.GetData();
+        const char* pEnd = pCharacter + size;
+        while( pCharacter < pEnd )
+        {
+            while( pCharacter < pEnd && ( *pCharacter == ' ' || *pCharacter == '\t' ) )
+            {
+                ++pCharacter;
+            }
+
+            static const char includeDirective[] = "include";
+            static const size_t includeDirectiveLength = HELIUM_ARRAY_COUNT( includeDirective ) - 1;
+
+            if( pCharacter < pEnd && *pCharacter == '#' )
+            {
+                ++pCharacter;
+                while( pCharacter < pEnd && ( *pCharacter == ' ' || *pCharacter == '\t' ) )
+                {
+                    ++pCharacter;
+                }
+
+                if( static_cast< size_t >( pEnd - pCharacter ) > includeDirectiveLength &&
+                    memcmp( pCharacter, includeDirective, includeDirectiveLength ) == 0 )
+                {
+                    pCharacter += includeDirectiveLength;
+                    while( pCharacter < pEnd && ( *pCharacter == ' ' || *pCharacter == '\t' ) )
+                    {
+                        ++pCharacter;
+                    }
+
+                    char terminator = ( pCharacter < pEnd && *pCharacter == '<' ? '>' : '"' );
+                    if( pCharacter < pEnd && ( *pCharacter == '"' || *pCharacter == '<' ) )
+                    {
+                        const char* pNameStart = ++pCharacter;
+                        while( pCharacter < pEnd && *pCharacter != terminator && *pCharacter != '\n' )
+                        {
+                            ++pCharacter;
+                        }
+
+                        if( pCharacter < pEnd && *pCharacter == terminator && pCharacter != pNameStart )
+                        {
+                            String includeName( pNameStart, static_cast< size_t >( pCharacter - pNameStart ) );
+                            FilePath includePath( shaderDirectory + includeName.GetData() );
+
+                            bool bFound = false;
+                            size_t includeCount = rIncludeFiles.GetSize();
+                            for( size_t otherIndex = firstIncludeIndex; otherIndex < includeCount; ++otherIndex )
+                            {
+                                if( rIncludeFiles[ otherIndex ].Get() == includePath.Get() )
+                                {
+                                    bFound = true;
+                                    break;
+                                }
+                            }
+
+                            if( !bFound )
+                            {
+                                rIncludeFiles.Push( includePath );
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Skip to the next line.
+            while( pCharacter < pEnd && *pCharacter != '\n' )
+            {
+                ++pCharacter;
+            }
+
+            ++pCharacter;
+        }
+    }
+}
+
 /// @copydoc ResourceHandler::CacheResource()
 bool ShaderResourceHandler::CacheResource(
     AssetPreprocessor* pAssetPreprocessor,
@@ -26,9 +26,18 @@ namespace Helium
         //@{
         virtual const AssetType* GetResourceType() const override;
         virtual void GetSourceExtensions( const char* const*& rppExtensions, size_t& rExtensionCount ) const override;
+        virtual uint32_t GetVersion() const override;
 
         virtual bool CacheResource(
             AssetPreprocessor* pAssetPreprocessor, Resource* pResource, const String& rSourceFilePath ) override;
+        virtual void GetSourceDependencies(
+            const Resource* pResource, const String& rSourceFilePath, DynamicArray< FilePath >& rDependencies ) const
+            override;
+        //@}
+
+        /// @name Static Utility Functions
+        //@{
+        static void GetIncludeFiles( const String& rSourceFilePath, DynamicArray< FilePath >& rIncludeFiles );
         //@}
 
     private:
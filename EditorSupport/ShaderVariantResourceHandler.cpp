@@ -3,6 +3,7 @@
 #if HELIUM_TOOLS
 
 #include "EditorSupport/ShaderVariantResourceHandler.h"
+#include "EditorSupport/ShaderResourceHandler.h"
 
 #include "Engine/FileLocations.h"
 #include "Foundation/FilePath.h"
@@ -42,6 +43,22 @@ const AssetType* ShaderVariantResourceHandler::GetResourceType() const
 	return ShaderVariant::GetStaticType();
 }
 
+/// @copydoc ResourceHandler::GetVersion()
+uint32_t ShaderVariantResourceHandler::GetVersion() const
+{
+	return 1;
+}
+
+/// @copydoc ResourceHandler::GetSourceDependencies()
+void ShaderVariantResourceHandler::GetSourceDependencies(
+	const Resource* /*pResource*/,
+	const String& rSourceFilePath,
+	DynamicArray< FilePath >& rDependencies ) const
+{
+	// Variants are compiled from the source file of their parent shader, along with everything it includes.
+	ShaderResourceHandler::GetIncludeFiles( rSourceFilePath, rDependencies );
+}
+
 /// @copydoc ResourceHandler::CacheResource()
 bool ShaderVariantResourceHandler::CacheResource(
 	AssetPreprocessor* pAssetPreprocessor,
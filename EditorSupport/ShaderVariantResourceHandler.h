@@ -29,9 +29,13 @@ namespace Helium
         /// @name Resource Handling Support
         //@{
         virtual const AssetType* GetResourceType() const override;
+        virtual uint32_t GetVersion() const override;
 
         virtual bool CacheResource(
             AssetPreprocessor* pAssetPreprocessor, Resource* pResource, const String& rSourceFilePath ) override;
+        virtual void GetSourceDependencies(
+            const Resource* pResource, const String& rSourceFilePath, DynamicArray< FilePath >& rDependencies ) const
+            override;
         //@}
 
     private:
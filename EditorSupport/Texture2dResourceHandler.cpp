@@ -38,6 +38,12 @@ const AssetType* Texture2dResourceHandler::GetResourceType() const
     return Texture2d::GetStaticType();
 }
 
+/// @copydoc ResourceHandler::GetVersion()
+uint32_t Texture2dResourceHandler::GetVersion() const
+{
+    return 1;
+}
+
 /// @copydoc ResourceHandler::GetSourceExtensions()
 void Texture2dResourceHandler::GetSourceExtensions(
     const char* const*& rppExtensions,
@@ -49,6 +55,13 @@ void Texture2dResourceHandler::GetSourceExtensions(
     rExtensionCount = HELIUM_ARRAY_COUNT( extensions );
 }
 
+/// @copydoc ResourceHandler::CanCacheConcurrently()
+bool Texture2dResourceHandler::CanCacheConcurrently() const
+{
+    // Source images are loaded and compressed using only local state.
+    return true;
+}
+
 /// @copydoc ResourceHandler::CacheResource()
 bool Texture2dResourceHandler::CacheResource(
     AssetPreprocessor* pAssetPreprocessor,
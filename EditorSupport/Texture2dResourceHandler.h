@@ -25,6 +25,8 @@ namespace Helium
         //@{
         virtual const AssetType* GetResourceType() const override;
         virtual void GetSourceExtensions( const char* const*& rppExtensions, size_t& rExtensionCount ) const override;
+        virtual uint32_t GetVersion() const override;
+        virtual bool CanCacheConcurrently() const override;
 
         virtual bool CacheResource(
             AssetPreprocessor* pAssetPreprocessor, Resource* pResource, const String& rSourceFilePath ) override;
@@ -118,6 +118,8 @@ Asset::ChildNameInstanceIndexMap* Asset::sm_pNameInstanceIndexMap = NULL;
 Pair< AssetPath, Asset::NameInstanceIndexMap >* Asset::sm_pEmptyNameInstanceIndexMap = NULL;
 Pair< Name, Asset::InstanceIndexSet >* Asset::sm_pEmptyInstanceIndexSet = NULL;
 
+Asset::PathObjectMap* volatile Asset::sm_pPathObjectMap = NULL;
+
 ReadWriteLock Asset::sm_objectListLock;
 
 DynamicArray< uint8_t > Asset::sm_serializationBuffer;
@@ -795,6 +797,17 @@ void Asset::ReplaceAsset( Asset* pNewAsset, const AssetPath &objectToReplace )
 	Helium::Swap( pOldAsset->m_spOwner, pNewAsset->m_spOwner );
 	Helium::Swap( pOldAsset->m_wpFirstChild, pNewAsset->m_wpFirstChild );
 	Helium::Swap( pOldAsset->m_wpNextSibling, pNewAsset->m_wpNextSibling );
+
+	// Point the swapped paths at their new objects.
+	if( !pOldAsset->m_path.IsEmpty() )
+	{
+		pOldAsset->AddToPathObjectMap();
+	}
+
+	if( !pNewAsset->m_path.IsEmpty() )
+	{
+		pNewAsset->AddToPathObjectMap();
+	}
 }
 
 #endif  // HELIUM_TOOLS
@@ -1006,42 +1019,21 @@ Asset* Asset::FindObject( AssetPath path )
 		return NULL;
 	}
 
-	// Assemble a list of object names and instance indices, from the top level on down.
-	size_t pathDepth = 0;
-	size_t packageDepth = 0;
-	for( AssetPath testPath = path; !testPath.IsEmpty(); testPath = testPath.GetParent() )
+	// Objects are indexed by their full path as they are named, so no walk of the object hierarchy (or lock on the
+	// object lists) is needed.
+	PathObjectMap* pPathObjectMap = sm_pPathObjectMap;
+	if( !pPathObjectMap )
 	{
-		++pathDepth;
-
-		if( testPath.IsPackage() )
-		{
-			++packageDepth;
-		}
+		return NULL;
 	}
 
-	StackMemoryHeap<>& rStackHeap = ThreadLocalStackAllocator::GetMemoryHeap();
-	StackMemoryHeap<>::Marker stackMarker( rStackHeap );
-
-	Name* pPathNames = static_cast< Name* >( rStackHeap.Allocate( sizeof( Name ) * pathDepth ) );
-	HELIUM_ASSERT( pPathNames );
-
-	uint32_t* pInstanceIndices = static_cast< uint32_t* >( rStackHeap.Allocate( sizeof( uint32_t ) * pathDepth ) );
-	HELIUM_ASSERT( pInstanceIndices );
-
-	size_t pathIndex = pathDepth;
-	for( AssetPath testPath = path; !testPath.IsEmpty(); testPath = testPath.GetParent() )
+	PathObjectMap::ConstAccessor objectAccessor;
+	if( !pPathObjectMap->Find( objectAccessor, path ) )
 	{
-		HELIUM_ASSERT( pathIndex != 0 );
-		--pathIndex;
-
-		pPathNames[ pathIndex ] = testPath.GetName();
-		pInstanceIndices[ pathIndex ] = testPath.GetInstanceIndex();
+		return NULL;
 	}
 
-	HELIUM_ASSERT( pathIndex == 0 );
-
-	// Search from the root.
-	return FindChildOf( NULL, pPathNames, pInstanceIndices, pathDepth, packageDepth );
+	return objectAccessor->Second();
 }
 
 /// Search for a direct child of the specified object with the given name.
@@ -1283,6 +1275,9 @@ void Asset::Shutdown()
 	delete sm_pEmptyInstanceIndexSet;
 	sm_pEmptyInstanceIndexSet = NULL;
 
+	delete sm_pPathObjectMap;
+	sm_pPathObjectMap = NULL;
+
 	sm_serializationBuffer.Clear();
 }
 
@@ -1384,13 +1379,23 @@ void Asset::SetCustomDestroyCallback( CUSTOM_DESTROY_CALLBACK* pDestroyCallback
 /// This should be called whenever the name of this object or one of its parents changes.
 void Asset::UpdatePath()
 {
-	// Update this object's path first.
+	// Update this object's path first, moving its entry in the path lookup map along with it.
+	if( !m_path.IsEmpty() )
+	{
+		RemoveFromPathObjectMap();
+	}
+
 	HELIUM_VERIFY( m_path.Set(
 		m_name,
 		IsPackage(),
 		( m_spOwner ? m_spOwner->m_path : AssetPath( NULL_NAME ) ),
 		m_instanceIndex ) );
 
+	if( !m_path.IsEmpty() )
+	{
+		AddToPathObjectMap();
+	}
+
 	// Update the path of each child object.
 	for( Asset* pChild = m_wpFirstChild; pChild != NULL; pChild = pChild->m_wpNextSibling )
 	{
@@ -1398,6 +1403,47 @@ void Asset::UpdatePath()
 	}
 }
 
+/// Map the current path of this object to this object in the path lookup map.
+///
+/// This must be called with a write lock held on the object list.
+///
+/// @see RemoveFromPathObjectMap()
+void Asset::AddToPathObjectMap()
+{
+	HELIUM_ASSERT( !m_path.IsEmpty() );
+
+	PathObjectMap& rPathObjectMap = GetPathObjectMap();
+
+	PathObjectMap::Accessor objectAccessor;
+	if( !rPathObjectMap.Insert( objectAccessor, PathObjectMap::ValueType( m_path, AssetWPtr( this ) ) ) )
+	{
+		// Path still mapped to an object being replaced (see ReplaceAsset()).
+		objectAccessor->Second() = this;
+	}
+}
+
+/// Remove the current path of this object from the path lookup map, if it is mapped to this object.
+///
+/// This must be called with a write lock held on the object list.
+///
+/// @see AddToPathObjectMap()
+void Asset::RemoveFromPathObjectMap()
+{
+	HELIUM_ASSERT( !m_path.IsEmpty() );
+
+	PathObjectMap* pPathObjectMap = sm_pPathObjectMap;
+	if( !pPathObjectMap )
+	{
+		return;
+	}
+
+	PathObjectMap::Accessor objectAccessor;
+	if( pPathObjectMap->Find( objectAccessor, m_path ) && objectAccessor->Second().HasObjectProxy( this ) )
+	{
+		HELIUM_VERIFY( pPathObjectMap->Remove( objectAccessor ) );
+	}
+}
+
 /// Custom destroy callback for objects created using CreateObject().
 ///
 /// @param[in] pObject  Asset to destroy.
@@ -1435,6 +1481,26 @@ Asset::ChildNameInstanceIndexMap& Asset::GetNameInstanceIndexMap()
 	return *sm_pNameInstanceIndexMap;
 }
 
+/// Get the static object path lookup map, creating it if necessary.
+///
+/// As with the name instance lookup map, this is constructed dynamically so that it can be destroyed during shutdown.
+/// It must only be created with a write lock held on the object list; lookups check for it without holding any lock.
+///
+/// @return  Reference to the object path lookup map.
+Asset::PathObjectMap& Asset::GetPathObjectMap()
+{
+	PathObjectMap* pPathObjectMap = sm_pPathObjectMap;
+	if( !pPathObjectMap )
+	{
+		pPathObjectMap = new PathObjectMap;
+		HELIUM_ASSERT( pPathObjectMap );
+
+		sm_pPathObjectMap = pPathObjectMap;
+	}
+
+	return *pPathObjectMap;
+}
+
 AssetRegistrar< Asset, void > Asset::s_Registrar(TXT("Helium::Asset"));
 
 
@@ -378,6 +378,8 @@ namespace Helium
 		typedef ConcurrentHashMap< Name, InstanceIndexSet > NameInstanceIndexMap;
 		/// Child object name instance lookup map type.
 		typedef ConcurrentHashMap< AssetPath, NameInstanceIndexMap > ChildNameInstanceIndexMap;
+		/// Object path lookup map type.
+		typedef ConcurrentHashMap< AssetPath, AssetWPtr > PathObjectMap;
 
 		/// Object name.
 		Name m_name;
@@ -416,6 +418,9 @@ namespace Helium
 		/// Empty name instance index lookup set.
 		static Pair< Name, InstanceIndexSet >* sm_pEmptyInstanceIndexSet;
 
+		/// Object lookup by full path (keyed by the interned path entry, so lookups don't need the object list lock).
+		static PathObjectMap* volatile sm_pPathObjectMap;
+
 		/// Read-write lock for synchronizing access to the object lists.
 		static ReadWriteLock sm_objectListLock;
 
@@ -425,6 +430,8 @@ namespace Helium
 		/// @name Private Utility Functions
 		//@{
 		void UpdatePath();
+		void AddToPathObjectMap();
+		void RemoveFromPathObjectMap();
 		//@}
 
 		/// @name Reference Counting Support, Private
@@ -435,6 +442,7 @@ namespace Helium
 		/// @name Static Asset Management
 		//@{
 		static ChildNameInstanceIndexMap& GetNameInstanceIndexMap();
+		static PathObjectMap& GetPathObjectMap();
 		//@}
 	};
 
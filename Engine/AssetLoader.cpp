@@ -5,6 +5,8 @@
 #include "Engine/Asset.h"
 #include "Engine/PackageLoader.h"
 #include "Engine/FileLocations.h"
+#include "Engine/AsyncLoader.h"
+#include "Engine/TaskDispatcher.h"
 
 /// Asset cache name.
 
@@ -19,6 +21,7 @@ AssetTracker* AssetTracker::sm_pInstance = NULL;
 /// Constructor.
 AssetLoader::AssetLoader()
 : m_loadRequestPool( LOAD_REQUEST_POOL_BLOCK_SIZE )
+, m_loadCompletedCounter( 0 )
 {
 }
 
@@ -159,26 +162,8 @@ bool AssetLoader::TryFinishLoad( size_t id, AssetPtr& rspObject )
 
 	rspObject = pRequest->spObject;
 
-	// Acquire an exclusive lock to the request entry.
-	AssetPath objectPath = pRequest->path;
-
-	ConcurrentHashMap< AssetPath, LoadRequest* >::Accessor requestAccessor;
-	HELIUM_VERIFY( m_loadRequestMap.Find( requestAccessor, objectPath ) );
-	HELIUM_ASSERT( requestAccessor->Second() == pRequest );
-
-
 	// Decrement the reference count on the load request, releasing it if the reference count reaches zero.
-	int32_t newRequestCount = AtomicDecrementRelease( pRequest->requestCount );
-	if( newRequestCount == 0 )
-	{
-		pRequest->spObject.Release();
-		pRequest->resolver.Clear();
-
-		m_loadRequestMap.Remove( requestAccessor );
-		m_loadRequestPool.Release( pRequest );
-	}
-
-	requestAccessor.Release();
+	ReleaseRequestReference( pRequest );
 
 #if HELIUM_TOOLS
 	if (rspObject)
@@ -201,13 +186,35 @@ bool AssetLoader::TryFinishLoad( size_t id, AssetPtr& rspObject )
 /// @param[out] rspObject  Smart pointer set to the loaded object if loading has completed.  If the object failed to
 ///                        load, this will be set to a null reference.
 ///
+/// While the request is still in progress, the current thread ticks the loader and runs any pending dispatched tasks
+/// (such as object deserialization), so this is safe to call from a job worker thread.  Once there is nothing left
+/// to help with, it sleeps until more progress is made elsewhere (an async file read completes, a dispatched task
+/// finishes, or a load request is updated on another thread) or FINISH_LOAD_TICK_INTERVAL elapses, instead of
+/// spinning.
+///
 /// @see TryFinishLoad(), BeginLoadObject(), BeginPreloadPackage()
 void AssetLoader::FinishLoad( size_t id, AssetPtr& rspObject )
 {
+	AsyncLoader& rAsyncLoader = AsyncLoader::GetStaticInstance();
+
 	while( !TryFinishLoad( id, rspObject ) )
 	{
+		// Read before ticking so that anything completing during the tick cuts the wait below short.
+		uint32_t progressCount = rAsyncLoader.GetProgressCount();
+
 		Tick();
-		Thread::Yield();
+		if( TryFinishLoad( id, rspObject ) )
+		{
+			break;
+		}
+
+		// The tasks this request is waiting on may be queued for this very thread.
+		if( TaskDispatcher::TryRunPendingTask() )
+		{
+			continue;
+		}
+
+		rAsyncLoader.WaitForProgress( progressCount, FINISH_LOAD_TICK_INTERVAL );
 	}
 }
 
@@ -263,63 +270,70 @@ bool AssetLoader::CacheObject( Asset* /*pObject*/, bool /*bEvictPlatformPreproce
 #endif  // HELIUM_TOOLS
 
 /// Update object loading.
+///
+/// Only load requests that have been woken up by an event since they were last updated are processed.
 void AssetLoader::Tick()
 {
-	// Tick package loaders first.
+	// Tick package loaders first.  Package loaders report objects that have finished preloading through
+	// NotifyObjectPreloaded(), queueing the corresponding load requests.
 	TickPackageLoaders();
 
-	// Build the list of object load requests to update this tick, incrementing the request count on each to prevent
-	// them from being released while we don't have a lock on the request hash map.
-	//HELIUM_ASSERT( m_loadRequestTickArray.IsEmpty() );
-	/// List of load requests to update in the current tick.
-	DynamicArray< LoadRequest* > m_loadRequestTickArray;
+	// Queue requests waiting on conditions that are checked once per tick.
+	QueueWaitingRequests();
 
-	ConcurrentHashMap< AssetPath, LoadRequest* >::ConstAccessor loadRequestConstAccessor;
-	if( m_loadRequestMap.First( loadRequestConstAccessor ) )
+	// Drain the ready queue.  Updating a request can wake up requests waiting on it, which are updated in the same
+	// tick.  Requests are updated on this thread (see the AssetLoader class documentation for why); the work they
+	// wait on is what runs on worker threads.
+	for( ;; )
 	{
-		do
-		{
-			LoadRequest* pRequest = loadRequestConstAccessor->Second();
-			HELIUM_ASSERT( pRequest );
-			AtomicIncrementUnsafe( pRequest->requestCount );
-			m_loadRequestTickArray.Add( pRequest );
+		m_eventLock.Lock();
 
-			++loadRequestConstAccessor;
-		} while( loadRequestConstAccessor.IsValid() );
-	}
+		HELIUM_ASSERT( m_processRequests.GetSize() == 0 );
+		m_processRequests.Swap( m_readyRequests );
 
-	// Tick object load requests.
-	size_t loadRequestCount = m_loadRequestTickArray.GetSize();
-	for( size_t requestIndex = 0; requestIndex < loadRequestCount; ++requestIndex )
-	{
-		LoadRequest* pRequest = m_loadRequestTickArray[ requestIndex ];
-		HELIUM_ASSERT( pRequest );
+		size_t requestCount = m_processRequests.GetSize();
+		for( size_t requestIndex = 0; requestIndex < requestCount; ++requestIndex )
+		{
+			AtomicAndRelease( m_processRequests[ requestIndex ]->stateFlags, ~LOAD_FLAG_QUEUED );
+		}
 
-		TickLoadRequest( pRequest );
+		m_eventLock.Unlock();
 
-		int32_t newRequestCount = AtomicDecrementRelease( pRequest->requestCount );
-		if( newRequestCount == 0 )
+		if( requestCount == 0 )
 		{
-			ConcurrentHashMap< AssetPath, LoadRequest* >::Accessor loadRequestAccessor;
-			if( m_loadRequestMap.Find( loadRequestAccessor, pRequest->path ) )
-			{
-				pRequest = loadRequestAccessor->Second();
-				HELIUM_ASSERT( pRequest );
-				if( pRequest->requestCount == 0 )
-				{
-					HELIUM_ASSERT( ( pRequest->stateFlags & LOAD_FLAG_FULLY_LOADED ) == LOAD_FLAG_FULLY_LOADED );
+			break;
+		}
 
-					pRequest->spObject.Release();
-					pRequest->resolver.Clear();
+		for( size_t requestIndex = 0; requestIndex < requestCount; ++requestIndex )
+		{
+			LoadRequest* pRequest = m_processRequests[ requestIndex ];
+			HELIUM_ASSERT( pRequest );
 
-					m_loadRequestMap.Remove( loadRequestAccessor );
-					m_loadRequestPool.Release( pRequest );
-				}
-			}
+			TickLoadRequest( pRequest );
+			ReleaseRequestReference( pRequest );
 		}
+
+		m_processRequests.Resize( 0 );
 	}
+}
 
-	//m_loadRequestTickArray.Resize( 0 );
+/// Notify the loader that a package loader has finished preloading an object.
+///
+/// Package loaders call this once TryFinishLoadObject() is expected to succeed for the object, so that the load
+/// request for it is updated on the next tick.  Paths with no load request in progress are ignored.
+///
+/// @param[in] path  Asset path.
+void AssetLoader::NotifyObjectPreloaded( AssetPath path )
+{
+	ConcurrentHashMap< AssetPath, LoadRequest* >::ConstAccessor requestConstAccessor;
+	if( m_loadRequestMap.Find( requestConstAccessor, path ) )
+	{
+		LoadRequest* pRequest = requestConstAccessor->Second();
+		HELIUM_ASSERT( pRequest );
+
+		AtomicOrRelease( pRequest->stateFlags, LOAD_FLAG_PACKAGE_NOTIFIED );
+		QueueReadyRequest( pRequest );
+	}
 }
 
 /// Get the global object loader instance.
@@ -363,6 +377,275 @@ void AssetLoader::OnLoadComplete( const AssetPath & /*path*/, Asset* /*pObject*/
 {
 }
 
+/// Add a load request to the ready queue if it is not already queued.
+///
+/// @param[in] pRequest  Load request to queue.
+void AssetLoader::QueueReadyRequest( LoadRequest* pRequest )
+{
+	HELIUM_ASSERT( pRequest );
+
+	m_eventLock.Lock();
+
+	bool bQueued = false;
+	if( !( AtomicOrRelease( pRequest->stateFlags, LOAD_FLAG_QUEUED ) & LOAD_FLAG_QUEUED ) )
+	{
+		AddRequestReference( pRequest );
+		m_readyRequests.Push( pRequest );
+		bQueued = true;
+	}
+
+	m_eventLock.Unlock();
+
+	// Wake up any thread waiting in FinishLoad() if this was queued from elsewhere.
+	if( bQueued )
+	{
+		AsyncLoader::GetStaticInstance().NotifyProgress();
+	}
+}
+
+/// Move a list of waiting load requests to the ready queue.
+///
+/// Each request in the list must hold a reference, which is transferred to the ready queue (or released if the
+/// request is already queued).  The event lock must be held by the caller.
+///
+/// @param[in] rRequests   Requests to move.  This will be cleared.
+/// @param[in] clearFlags  Load flags to clear on each request.
+void AssetLoader::MoveToReadyQueue( DynamicArray< LoadRequest* >& rRequests, int32_t clearFlags )
+{
+	size_t requestCount = rRequests.GetSize();
+	for( size_t requestIndex = 0; requestIndex < requestCount; ++requestIndex )
+	{
+		LoadRequest* pRequest = rRequests[ requestIndex ];
+		HELIUM_ASSERT( pRequest );
+
+		AtomicAndRelease( pRequest->stateFlags, ~clearFlags );
+		if( AtomicOrRelease( pRequest->stateFlags, LOAD_FLAG_QUEUED ) & LOAD_FLAG_QUEUED )
+		{
+			// The ready queue already holds a reference, so this can never release the request.
+			AtomicDecrementRelease( pRequest->requestCount );
+		}
+		else
+		{
+			m_readyRequests.Push( pRequest );
+		}
+	}
+
+	rRequests.Resize( 0 );
+}
+
+/// Set load progress flags on a request, waking up any requests waiting on it.
+///
+/// @param[in] pRequest  Load request.
+/// @param[in] flags     Flags to set.
+void AssetLoader::SetLoadFlags( LoadRequest* pRequest, int32_t flags )
+{
+	HELIUM_ASSERT( pRequest );
+
+	m_eventLock.Lock();
+
+	AtomicOrRelease( pRequest->stateFlags, flags );
+
+	// Requests only ever wait for a dependency to be preloaded or fully loaded.
+	if( flags & ( LOAD_FLAG_PRELOADED | LOAD_FLAG_LOADED ) )
+	{
+		MoveToReadyQueue( pRequest->waiters, LOAD_FLAG_WAITING );
+	}
+
+	if( flags & LOAD_FLAG_LOADED )
+	{
+		AtomicExchangeRelease( m_loadCompletedCounter, 1 );
+	}
+
+	m_eventLock.Unlock();
+
+	AsyncLoader::GetStaticInstance().NotifyProgress();
+}
+
+/// Park a load request until the first of its resolver's dependencies without the given load flags set gets them.
+///
+/// @param[in] pRequest         Load request.
+/// @param[in] dependencyFlags  Load flags to wait for.
+///
+/// @return  True if the request is waiting on a dependency, false if all dependencies already have the given flags
+///          set.
+bool AssetLoader::WaitForDependency( LoadRequest* pRequest, int32_t dependencyFlags )
+{
+	HELIUM_ASSERT( pRequest );
+
+	DynamicArray< AssetResolver::Fixup >& rFixups = pRequest->resolver.m_Fixups;
+	size_t fixupCount = rFixups.GetSize();
+	for( size_t fixupIndex = 0; fixupIndex < fixupCount; ++fixupIndex )
+	{
+		size_t loadRequestId = rFixups[ fixupIndex ].m_LoadRequestId;
+		if( IsInvalid( loadRequestId ) )
+		{
+			continue;
+		}
+
+		LoadRequest* pDependency = m_loadRequestPool.GetObject( loadRequestId );
+		HELIUM_ASSERT( pDependency );
+
+		// Flags are only set under the event lock, so checking them here guarantees the wake up won't be missed.
+		m_eventLock.Lock();
+
+		if( ( pDependency->stateFlags & dependencyFlags ) != dependencyFlags )
+		{
+			if( !( AtomicOrRelease( pRequest->stateFlags, LOAD_FLAG_WAITING ) & LOAD_FLAG_WAITING ) )
+			{
+				AddRequestReference( pRequest );
+				pDependency->waiters.Push( pRequest );
+			}
+
+			m_eventLock.Unlock();
+
+			return true;
+		}
+
+		m_eventLock.Unlock();
+	}
+
+	return false;
+}
+
+/// Park a load request until its package loader has finished preloading.
+///
+/// @param[in] pRequest  Load request.
+void AssetLoader::WaitForPackagePreload( LoadRequest* pRequest )
+{
+	HELIUM_ASSERT( pRequest );
+
+	PackageLoader* pPackageLoader = pRequest->pPackageLoader;
+	HELIUM_ASSERT( pPackageLoader );
+
+	m_eventLock.Lock();
+
+	PackagePreloadWait* pWait = NULL;
+	size_t waitCount = m_packagePreloadWaits.GetSize();
+	for( size_t waitIndex = 0; waitIndex < waitCount; ++waitIndex )
+	{
+		if( m_packagePreloadWaits[ waitIndex ].pPackageLoader == pPackageLoader )
+		{
+			pWait = &m_packagePreloadWaits[ waitIndex ];
+
+			break;
+		}
+	}
+
+	if( !pWait )
+	{
+		pWait = m_packagePreloadWaits.New();
+		HELIUM_ASSERT( pWait );
+		pWait->pPackageLoader = pPackageLoader;
+	}
+
+	AddRequestReference( pRequest );
+	pWait->requests.Push( pRequest );
+
+	m_eventLock.Unlock();
+}
+
+/// Add a load request to a list of requests checked on each tick if it is not already in one.
+///
+/// @param[in] rRequests  List of requests.
+/// @param[in] pRequest   Load request.
+void AssetLoader::AddPolledRequest( DynamicArray< LoadRequest* >& rRequests, LoadRequest* pRequest )
+{
+	HELIUM_ASSERT( pRequest );
+
+	m_eventLock.Lock();
+
+	if( !( AtomicOrRelease( pRequest->stateFlags, LOAD_FLAG_POLLED ) & LOAD_FLAG_POLLED ) )
+	{
+		AddRequestReference( pRequest );
+		rRequests.Push( pRequest );
+	}
+
+	m_eventLock.Unlock();
+}
+
+/// Queue load requests waiting on conditions that are checked once per tick.
+void AssetLoader::QueueWaitingRequests()
+{
+	m_eventLock.Lock();
+
+	MoveToReadyQueue( m_polledRequests, LOAD_FLAG_POLLED );
+
+	// Requests held by their package loader on a dependency are only retried once another load has completed.
+	if( m_loadCompletedCounter != 0 )
+	{
+		AtomicExchangeRelease( m_loadCompletedCounter, 0 );
+		MoveToReadyQueue( m_blockedPreloadRequests, LOAD_FLAG_POLLED );
+	}
+
+	// Check each package loader being waited on once, outside the event lock, as doing so may drive its preload
+	// process.  Waits are only removed here, so indices remain valid while the lock is released.
+	size_t waitIndex = 0;
+	while( waitIndex < m_packagePreloadWaits.GetSize() )
+	{
+		PackageLoader* pPackageLoader = m_packagePreloadWaits[ waitIndex ].pPackageLoader;
+		HELIUM_ASSERT( pPackageLoader );
+
+		m_eventLock.Unlock();
+		bool bPreloaded = pPackageLoader->TryFinishPreload();
+		m_eventLock.Lock();
+
+		if( bPreloaded )
+		{
+			MoveToReadyQueue( m_packagePreloadWaits[ waitIndex ].requests, 0 );
+			m_packagePreloadWaits.RemoveSwap( waitIndex );
+		}
+		else
+		{
+			++waitIndex;
+		}
+	}
+
+	m_eventLock.Unlock();
+}
+
+/// Add a reference to a load request, preventing it from being released.
+///
+/// @param[in] pRequest  Load request.
+void AssetLoader::AddRequestReference( LoadRequest* pRequest )
+{
+	HELIUM_ASSERT( pRequest );
+	AtomicIncrementRelease( pRequest->requestCount );
+}
+
+/// Release a reference to a load request, releasing the request itself once no references remain.
+///
+/// @param[in] pRequest  Load request.
+void AssetLoader::ReleaseRequestReference( LoadRequest* pRequest )
+{
+	HELIUM_ASSERT( pRequest );
+
+	int32_t newRequestCount = AtomicDecrementRelease( pRequest->requestCount );
+	if( newRequestCount != 0 )
+	{
+		return;
+	}
+
+	// Acquire an exclusive lock to the request entry, and make sure the request wasn't picked up again while we
+	// didn't have it.
+	ConcurrentHashMap< AssetPath, LoadRequest* >::Accessor loadRequestAccessor;
+	if( m_loadRequestMap.Find( loadRequestAccessor, pRequest->path ) )
+	{
+		pRequest = loadRequestAccessor->Second();
+		HELIUM_ASSERT( pRequest );
+		if( pRequest->requestCount == 0 )
+		{
+			HELIUM_ASSERT( ( pRequest->stateFlags & LOAD_FLAG_FULLY_LOADED ) == LOAD_FLAG_FULLY_LOADED );
+			HELIUM_ASSERT( pRequest->waiters.GetSize() == 0 );
+
+			pRequest->spObject.Release();
+			pRequest->resolver.Clear();
+
+			m_loadRequestMap.Remove( loadRequestAccessor );
+			m_loadRequestPool.Release( pRequest );
+		}
+	}
+}
+
 /// Update the given load request.
 ///
 /// @param[in] pRequest  Load request to update.
@@ -380,6 +663,7 @@ bool AssetLoader::TickLoadRequest( LoadRequest* pRequest )
 	{ \
 	if( AtomicOrAcquire( pRequest->stateFlags, LOAD_FLAG_IN_TICK ) & LOAD_FLAG_IN_TICK ) \
 	{ \
+	AddPolledRequest( m_polledRequests, pRequest ); \
 	return false; \
 	} \
 	\
@@ -481,6 +765,8 @@ bool AssetLoader::TickPreload( LoadRequest* pRequest )
 		if( !pPackageLoader->TryFinishPreload() )
 		{
 			// Still waiting for package loader preload.
+			WaitForPackagePreload( pRequest );
+
 			return false;
 		}
 
@@ -502,7 +788,7 @@ bool AssetLoader::TickPreload( LoadRequest* pRequest )
 				// finalization if necessary.
 				pObject->SetFlags( Asset::FLAG_PRELOADED | Asset::FLAG_LINKED );
 
-				AtomicOrRelease( pRequest->stateFlags, LOAD_FLAG_PRELOADED | LOAD_FLAG_LINKED );
+				SetLoadFlags( pRequest, LOAD_FLAG_PRELOADED | LOAD_FLAG_LINKED );
 
 				return true;
 			}
@@ -512,7 +798,7 @@ bool AssetLoader::TickPreload( LoadRequest* pRequest )
 				TXT( "AssetLoader: Asset \"%s\" is not serialized and does not exist in memory.\n" ),
 				*path.ToString() );
 
-			AtomicOrRelease( pRequest->stateFlags, LOAD_FLAG_FULLY_LOADED | LOAD_FLAG_ERROR );
+			SetLoadFlags( pRequest, LOAD_FLAG_FULLY_LOADED | LOAD_FLAG_ERROR );
 
 			return true;
 		}
@@ -525,14 +811,21 @@ bool AssetLoader::TickPreload( LoadRequest* pRequest )
 		pRequest->spObject );
 	if( !bFinished )
 	{
-		// Still waiting for object to load.
+		// Still waiting for object to load.  If the package loader has already reported the object as preloaded, it
+		// is holding on to it until a dependency finishes loading, so retry whenever a load completes.  Otherwise,
+		// the package loader will notify us once it has preloaded the object.
+		if( pRequest->stateFlags & LOAD_FLAG_PACKAGE_NOTIFIED )
+		{
+			AddPolledRequest( m_blockedPreloadRequests, pRequest );
+		}
+
 		return false;
 	}
 
 	// Preload complete.
 	SetInvalid( pRequest->packageLoadRequestId );
 
-	AtomicOrRelease( pRequest->stateFlags, LOAD_FLAG_PRELOADED );
+	SetLoadFlags( pRequest, LOAD_FLAG_PRELOADED );
 
 	return true;
 }
@@ -551,6 +844,11 @@ bool AssetLoader::TickLink( LoadRequest* pRequest )
 	{
 		if( !pRequest->resolver.ReadyToApplyFixups() )
 		{
+			if( !WaitForDependency( pRequest, LOAD_FLAG_PRELOADED ) )
+			{
+				QueueReadyRequest( pRequest );
+			}
+
 			return false;
 		}
 		
@@ -560,7 +858,7 @@ bool AssetLoader::TickLink( LoadRequest* pRequest )
 		pRequest->spObject->SetFlags( Asset::FLAG_LINKED );
 	}
 
-	AtomicOrRelease( pRequest->stateFlags, LOAD_FLAG_LINKED );
+	SetLoadFlags( pRequest, LOAD_FLAG_LINKED );
 
 	return true;
 }
@@ -581,6 +879,11 @@ bool AssetLoader::TickPrecache( LoadRequest* pRequest )
 		// TODO: SHouldn't this be in the linking phase?
 		if ( !pRequest->resolver.TryFinishPrecachingDependencies() )
 		{
+			if( !WaitForDependency( pRequest, LOAD_FLAG_FULLY_LOADED ) )
+			{
+				QueueReadyRequest( pRequest );
+			}
+
 			return false;
 		}
 
@@ -604,7 +907,7 @@ bool AssetLoader::TickPrecache( LoadRequest* pRequest )
 						*pAsset->GetPath().ToString() );
 
 					pAsset->SetFlags( Asset::FLAG_PRECACHED | Asset::FLAG_BROKEN );
-					AtomicOrRelease( pRequest->stateFlags, LOAD_FLAG_PRECACHED | LOAD_FLAG_ERROR );
+					SetLoadFlags( pRequest, LOAD_FLAG_PRECACHED | LOAD_FLAG_ERROR );
 
 					return true;
 				}
@@ -614,6 +917,9 @@ bool AssetLoader::TickPrecache( LoadRequest* pRequest )
 
 			if( !pAsset->TryFinishPrecacheResourceData() )
 			{
+				// Resource data loads don't report their completion, so check back on the next tick.
+				AddPolledRequest( m_polledRequests, pRequest );
+
 				return false;
 			}
 		}
@@ -621,7 +927,7 @@ bool AssetLoader::TickPrecache( LoadRequest* pRequest )
 		pAsset->SetFlags( Asset::FLAG_PRECACHED );
 	}
 
-	AtomicOrRelease( pRequest->stateFlags, LOAD_FLAG_PRECACHED );
+	SetLoadFlags( pRequest, LOAD_FLAG_PRECACHED );
 
 	return true;
 }
@@ -643,7 +949,7 @@ bool AssetLoader::TickFinalizeLoad( LoadRequest* pRequest )
 
 	// Loading now complete.
 	OnLoadComplete( pRequest->path, pObject, pRequest->pPackageLoader );
-	AtomicOrRelease( pRequest->stateFlags, LOAD_FLAG_LOADED );
+	SetLoadFlags( pRequest, LOAD_FLAG_LOADED );
 
 	return true;
 }
@@ -666,6 +972,17 @@ int64_t AssetLoader::GetAssetFileTimestamp( const AssetPath &path )
 	return pLoader->GetAssetFileSystemTimestamp( path );
 }
 
+FilePath AssetLoader::GetAssetFileSystemPath( const AssetPath &path )
+{
+	Package *pPackage = Asset::Find<Package>( path.GetParentPackage() );
+	HELIUM_ASSERT( pPackage );
+
+	PackageLoader *pLoader = pPackage->GetLoader();
+	HELIUM_ASSERT( pLoader );
+
+	return pLoader->GetAssetFileSystemPath( path );
+}
+
 #endif
 
 bool Helium::AssetIdentifier::Identify( const Reflect::ObjectPtr& object, Name* identity )
@@ -692,8 +1009,7 @@ bool Helium::AssetIdentifier::Identify( const Reflect::ObjectPtr& object, Name*
 
 bool Helium::AssetResolver::Resolve( const Name& identity, Reflect::ObjectPtr& pointer, const Reflect::MetaClass* pointerClass )
 {
-	// Paths begin with /
-	if (!identity.IsEmpty() && (*identity)[0] == '/')
+	if ( IsAssetIdentity( identity ) )
 	{
 		HELIUM_TRACE( TraceLevels::Info, TXT( "Resolving object [%s]\n" ), identity.Get() );
 
@@ -728,6 +1044,18 @@ bool Helium::AssetResolver::Resolve( const Name& identity, Reflect::ObjectPtr& p
 	return false;
 }
 
+/// Get whether an identity read during deserialization refers to an asset (as opposed to an object within the same
+/// archive).
+///
+/// @param[in] identity  Object identity.
+///
+/// @return  True if the identity is an asset path, false if not.
+bool Helium::AssetResolver::IsAssetIdentity( const Name& identity )
+{
+	// Paths begin with /
+	return ( !identity.IsEmpty() && (*identity)[0] == '/' );
+}
+
 bool Helium::AssetResolver::ReadyToApplyFixups()
 {
 	for ( DynamicArray< Fixup >::Iterator iter = m_Fixups.Begin();
@@ -790,6 +1118,49 @@ bool Helium::AssetResolver::TryFinishPrecachingDependencies()
 	return true;
 }
 
+/// @copydoc Reflect::ObjectResolver::Resolve()
+bool Helium::DeferredAssetResolver::Resolve( const Name& identity, Reflect::ObjectPtr& pointer, const Reflect::MetaClass* pointerClass )
+{
+	// Leave anything that isn't an asset reference to the archive, as AssetResolver would.
+	if ( !AssetResolver::IsAssetIdentity( identity ) )
+	{
+		return false;
+	}
+
+	Reference* pReference = m_references.New();
+	HELIUM_ASSERT( pReference );
+	pReference->identity = identity;
+	pReference->pPointer = &pointer;
+	pReference->pPointerClass = pointerClass;
+
+	return true;
+}
+
+/// Pass all recorded references on to another resolver, clearing the recorded references in the process.
+///
+/// This must be called on the thread ticking the asset loader.
+///
+/// @param[in] pResolver  Resolver to which the references should be passed.
+void Helium::DeferredAssetResolver::Replay( Reflect::ObjectResolver* pResolver )
+{
+	HELIUM_ASSERT( pResolver );
+
+	size_t referenceCount = m_references.GetSize();
+	for ( size_t referenceIndex = 0; referenceIndex < referenceCount; ++referenceIndex )
+	{
+		Reference& rReference = m_references[ referenceIndex ];
+		HELIUM_VERIFY( pResolver->Resolve( rReference.identity, *rReference.pPointer, rReference.pPointerClass ) );
+	}
+
+	m_references.Clear();
+}
+
+/// Discard all recorded references.
+void Helium::DeferredAssetResolver::Clear()
+{
+	m_references.Clear();
+}
+
 #if HELIUM_TOOLS
 
 AssetTracker* AssetTracker::GetStaticInstance()
@@ -2,6 +2,7 @@
 
 #include "Engine/Engine.h"
 
+#include "Platform/Locks.h"
 #include "Reflect/Translator.h"
 #include "Foundation/ConcurrentHashMap.h"
 #include "Foundation/ObjectPool.h"
@@ -27,6 +28,8 @@ namespace Helium
 		// Reflect::ObjectResolver interface
 		virtual bool Resolve( const Name& identity, Reflect::ObjectPtr& pointer, const Reflect::MetaClass* pointerClass );
 
+		static bool IsAssetIdentity( const Name& identity );
+
 		// Called by AssetLoader
 		bool ReadyToApplyFixups();
 		void ApplyFixups();
@@ -55,12 +58,57 @@ namespace Helium
 		DynamicArray< Fixup >  m_Fixups;
 	};
 
+	/// Object resolver that records asset references so that they can be resolved later.
+	///
+	/// Package loaders deserialize objects on worker threads through this resolver, as load requests for referenced
+	/// assets can only be started on the thread ticking the asset loader.  Once deserialization has finished, Replay()
+	/// is called on that thread to pass the recorded references on to the load request's resolver.
+	class HELIUM_ENGINE_API DeferredAssetResolver : public Reflect::ObjectResolver
+	{
+	public:
+		// Reflect::ObjectResolver interface
+		virtual bool Resolve( const Name& identity, Reflect::ObjectPtr& pointer, const Reflect::MetaClass* pointerClass );
+
+		void Replay( Reflect::ObjectResolver* pResolver );
+		void Clear();
+
+	private:
+		/// Recorded asset reference.
+		struct Reference
+		{
+			/// Asset identity.
+			Name identity;
+			/// Pointer to fix up (stored in the deserialized object).
+			Reflect::ObjectPtr* pPointer;
+			/// Type of object the pointer references.
+			const Reflect::MetaClass* pPointerClass;
+		};
+
+		/// Recorded references.
+		DynamicArray< Reference > m_references;
+	};
+
 	/// Asynchronous object loading interface
+	///
+	/// Load requests are advanced by events rather than by polling every outstanding request each tick.  A request
+	/// that cannot make progress is parked until the event it is blocked on occurs: its package loader finishing
+	/// preloading or reporting the object as preloaded (see NotifyObjectPreloaded()), a dependency it references
+	/// being preloaded or fully loaded, or (for requests precaching resource data) the next tick.  Requests whose
+	/// event has occurred are placed on a ready queue, which Tick() drains.
+	///
+	/// The expensive parts of a load already run on other threads: archive reads are dispatched by the package loaders
+	/// (see TaskDispatcher), and cache entry reads and decompression are asynchronous.  The ready queue itself is drained
+	/// on the ticking thread.  Advancing a request calls into its package loader, whose request tables are not
+	/// thread-safe, and into OnPrecacheReady(), Asset::ConditionalFinalizeLoad() and OnLoadComplete(), which run asset
+	/// and tools code that expects the loading thread.  The rest (applying fixups and updating flags) is a few pointer
+	/// assignments per request, which is cheaper than dispatching it.
 	class HELIUM_ENGINE_API AssetLoader : NonCopyable
 	{
 	public:
 		/// Number of request objects to allocate in each block of the request pool.
 		static const size_t LOAD_REQUEST_POOL_BLOCK_SIZE = 64;
+		/// Maximum time, in milliseconds, that FinishLoad() sleeps between ticks while waiting for loading progress.
+		static const uint32_t FINISH_LOAD_TICK_INTERVAL = 2;
 
 		friend AssetIdentifier;
 		friend AssetResolver;
@@ -93,11 +141,17 @@ namespace Helium
 		virtual void EnumerateRootPackages( DynamicArray< AssetPath > &packagePaths );
 
 		static int64_t GetAssetFileTimestamp( const AssetPath &path );
+		static FilePath GetAssetFileSystemPath( const AssetPath &path );
 #endif
 
 		virtual void Tick();
 		//@}
 
+		/// @name Package Loader Events
+		//@{
+		void NotifyObjectPreloaded( AssetPath path );
+		//@}
+
 		/// @name Static Access
 		//@{
 		static AssetLoader* GetStaticInstance();
@@ -132,6 +186,15 @@ namespace Helium
 
 			/// Set if ticking is in progress.
 			LOAD_FLAG_IN_TICK = 1 << 6,
+
+			/// Set while the request is in the ready queue.
+			LOAD_FLAG_QUEUED           = 1 << 7,
+			/// Set while the request is waiting on a dependency.
+			LOAD_FLAG_WAITING          = 1 << 8,
+			/// Set while the request is in a list polled each tick.
+			LOAD_FLAG_POLLED           = 1 << 9,
+			/// Set once the package loader has reported the object as preloaded.
+			LOAD_FLAG_PACKAGE_NOTIFIED = 1 << 10,
 		};
 
 		/// Asset load request information.
@@ -155,14 +218,41 @@ namespace Helium
 
 			AssetResolver resolver;
 
+			/// Requests waiting for this request to reach a later load stage.
+			DynamicArray< LoadRequest* > waiters;
+
 			bool forceReload;
 		};
 
+		/// Requests waiting for a package loader to finish preloading.
+		struct PackagePreloadWait
+		{
+			/// Package loader.
+			PackageLoader* pPackageLoader;
+			/// Waiting requests.
+			DynamicArray< LoadRequest* > requests;
+		};
+
 		/// Load request hash map.
 		ConcurrentHashMap< AssetPath, LoadRequest* > m_loadRequestMap;
 		/// Load request pool.
 		ObjectPool< LoadRequest > m_loadRequestPool;
 
+		/// Lock protecting the ready queue, wait lists, and request waiter lists.
+		SpinLock m_eventLock;
+		/// Requests ready to be updated.
+		DynamicArray< LoadRequest* > m_readyRequests;
+		/// Requests being updated by the current drain of the ready queue.
+		DynamicArray< LoadRequest* > m_processRequests;
+		/// Requests waiting on package loader preloading, grouped by package loader.
+		DynamicArray< PackagePreloadWait > m_packagePreloadWaits;
+		/// Requests polled each tick (precaching resource data, or updated elsewhere while being ticked).
+		DynamicArray< LoadRequest* > m_polledRequests;
+		/// Requests whose package loader has finished the object but is holding it until a dependency is loaded.
+		DynamicArray< LoadRequest* > m_blockedPreloadRequests;
+		/// Non-zero if a load request has fully loaded since blocked preload requests were last retried.
+		volatile int32_t m_loadCompletedCounter;
+
 		/// Singleton instance.
 		static AssetLoader* sm_pInstance;
 
@@ -177,6 +267,20 @@ namespace Helium
 
 	private:
 
+		/// @name Load Event Handling
+		//@{
+		void QueueReadyRequest( LoadRequest* pRequest );
+		void MoveToReadyQueue( DynamicArray< LoadRequest* >& rRequests, int32_t clearFlags );
+		void SetLoadFlags( LoadRequest* pRequest, int32_t flags );
+		bool WaitForDependency( LoadRequest* pRequest, int32_t dependencyFlags );
+		void WaitForPackagePreload( LoadRequest* pRequest );
+		void AddPolledRequest( DynamicArray< LoadRequest* >& rRequests, LoadRequest* pRequest );
+		void QueueWaitingRequests();
+
+		void AddRequestReference( LoadRequest* pRequest );
+		void ReleaseRequestReference( LoadRequest* pRequest );
+		//@}
+
 		/// @name Load Process Updating
 		//@{
 		bool TickLoadRequest( LoadRequest* pRequest );
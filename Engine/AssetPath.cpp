@@ -5,6 +5,9 @@
 
 #include "Foundation/ReferenceCounting.h"
 #include "Engine/Asset.h"
+#include "Engine/StableHash.h"
+
+#include <string.h>
 
 struct Helium::AssetPath::PendingLink
 {
@@ -17,8 +20,10 @@ struct Helium::AssetPath::PendingLink
 
 using namespace Helium;
 
-AssetPath::TableBucket* AssetPath::sm_pTable = NULL;
-StackMemoryHeap<>* AssetPath::sm_pEntryMemoryHeap = NULL;
+AssetPath::Table* volatile AssetPath::sm_pTable = NULL;
+SpinLock AssetPath::sm_tableLock;
+AssetPath::EntryBlock* AssetPath::sm_pEntryBlocks = NULL;
+ThreadLocalPointer* AssetPath::sm_pThreadEntryBlock = NULL;
 ObjectPool<AssetPath::PendingLink> *AssetPath::sm_pPendingLinksPool = NULL;
 
 /// Parse the object path in the specified string and store it in this object.
@@ -489,6 +494,28 @@ void AssetPath::ToFilePathString( String& rString ) const
 	EntryToFilePathString( *m_pEntry, rString );
 }
 
+/// Check whether the string representation of this path matches a given string without building the string.
+///
+/// @param[in] pString  String to compare against (does not need to be null-terminated).
+/// @param[in] length   Length of the string, in characters.
+///
+/// @return  True if ToString() would produce the same string, false if not.
+///
+/// @see ToString()
+bool AssetPath::MatchesString( const char* pString, size_t length ) const
+{
+	HELIUM_ASSERT( pString || length == 0 );
+
+	if( !m_pEntry )
+	{
+		return ( length == 0 );
+	}
+
+	const char* pEnd = pString + length;
+
+	return ( EntryMatchesString( *m_pEntry, pString, pEnd ) && pString == pEnd );
+}
+
 /// Clear out this object path.
 ///
 /// @see Set()
@@ -497,6 +524,19 @@ void AssetPath::Clear()
 	m_pEntry = NULL;
 }
 
+/// Compute a hash value for this path that depends only on the path contents.
+///
+/// Unlike ComputeHash(), which is only valid for the lifetime of the current process, this can be stored in files and
+/// compared against paths resolved in other runs.
+///
+/// @return  Stable hash value, or zero if this path is empty.
+///
+/// @see ComputeHash()
+uint64_t AssetPath::ComputeStableHash() const
+{
+	return ( m_pEntry ? ComputeEntryStableHash( *m_pEntry ) : 0 );
+}
+
 /// Release the object path table and free all allocated memory.
 ///
 /// This should only be called immediately prior to application exit.
@@ -504,11 +544,30 @@ void AssetPath::Shutdown()
 {
 	HELIUM_TRACE( TraceLevels::Info, TXT( "Shutting down AssetPath table.\n" ) );
 
-	delete [] sm_pTable;
+	DefaultAllocator allocator;
+
+	Table* pTable = sm_pTable;
+	while( pTable )
+	{
+		Table* pPreviousTable = pTable->pPrevious;
+		allocator.Free( pTable );
+		pTable = pPreviousTable;
+	}
+
 	sm_pTable = NULL;
 
-	delete sm_pEntryMemoryHeap;
-	sm_pEntryMemoryHeap = NULL;
+	EntryBlock* pBlock = sm_pEntryBlocks;
+	while( pBlock )
+	{
+		EntryBlock* pNextBlock = pBlock->pNext;
+		delete pBlock;
+		pBlock = pNextBlock;
+	}
+
+	sm_pEntryBlocks = NULL;
+
+	delete sm_pThreadEntryBlock;
+	sm_pThreadEntryBlock = NULL;
 
 	delete sm_pPendingLinksPool;
 	sm_pPendingLinksPool = NULL;
@@ -858,35 +917,200 @@ AssetPath::Entry* AssetPath::Add( const Entry& rEntry )
 {
 	// Lazily initialize the hash table.  Note that this is not inherently thread-safe, but there should always be
 	// at least one path created before any sub-threads are spawned.
-	if( !sm_pEntryMemoryHeap )
+	if( !sm_pTable )
 	{
-		sm_pEntryMemoryHeap = new StackMemoryHeap<>( STACK_HEAP_BLOCK_SIZE );
-		HELIUM_ASSERT( sm_pEntryMemoryHeap );
-
 		sm_pPendingLinksPool = new ObjectPool<PendingLink>( PENDING_LINKS_POOL_BLOCK_SIZE );
 		HELIUM_ASSERT( sm_pPendingLinksPool );
 
-		HELIUM_ASSERT( !sm_pTable );
-		sm_pTable = new TableBucket [ TABLE_BUCKET_COUNT ];
-		HELIUM_ASSERT( sm_pTable );
+		HELIUM_ASSERT( !sm_pThreadEntryBlock );
+		sm_pThreadEntryBlock = new ThreadLocalPointer;
+		HELIUM_ASSERT( sm_pThreadEntryBlock );
+
+		sm_pTable = CreateTable( TABLE_CAPACITY_INITIAL );
+	}
+
+	size_t hash = ComputeEntryTableHash( rEntry );
+
+	// Most entries will already exist, so search the table without locking first.
+	Table* pTable = sm_pTable;
+	HELIUM_ASSERT( pTable );
+
+	Entry* pTableEntry = FindInTable( *pTable, rEntry, hash );
+	if( pTableEntry )
+	{
+		return pTableEntry;
+	}
+
+	// Set up the new entry before locking so that the lock is only held while the table itself is updated.
+	Entry* pNewEntry = AllocateEntry( rEntry );
+	HELIUM_ASSERT( pNewEntry );
+
+	sm_tableLock.Lock();
+
+	// Check whether the entry was added (or the table grown) since the search above.
+	pTable = sm_pTable;
+	pTableEntry = FindInTable( *pTable, rEntry, hash );
+	if( pTableEntry )
+	{
+		sm_tableLock.Unlock();
+
+		FreeEntry( pNewEntry );
+
+		return pTableEntry;
+	}
+
+	// Grow the table if adding the entry would leave it more than half full.
+	if( ( pTable->entryCount + 1 ) * 2 > pTable->capacity )
+	{
+		Table* pNewTable = CreateTable( pTable->capacity * 2 );
+		HELIUM_ASSERT( pNewTable );
+
+		size_t slotMask = pNewTable->capacity - 1;
+		for( size_t slotIndex = 0; slotIndex < pTable->capacity; ++slotIndex )
+		{
+			Entry* pExistingEntry = pTable->pSlots[ slotIndex ];
+			if( pExistingEntry )
+			{
+				size_t newSlotIndex = ComputeEntryTableHash( *pExistingEntry ) & slotMask;
+				while( pNewTable->pSlots[ newSlotIndex ] )
+				{
+					newSlotIndex = ( newSlotIndex + 1 ) & slotMask;
+				}
+
+				pNewTable->pSlots[ newSlotIndex ] = pExistingEntry;
+			}
+		}
+
+		pNewTable->entryCount = pTable->entryCount;
+		pNewTable->pPrevious = pTable;
+
+		AtomicExchangeRelease( sm_pTable, pNewTable );
+		pTable = pNewTable;
+	}
+
+	// Linear probing for an empty slot.  Publishing the entry pointer makes the (already initialized) entry visible to
+	// lock-free lookups.
+	size_t slotMask = pTable->capacity - 1;
+	size_t slotIndex = hash & slotMask;
+	while( pTable->pSlots[ slotIndex ] )
+	{
+		slotIndex = ( slotIndex + 1 ) & slotMask;
 	}
 
-	HELIUM_ASSERT( sm_pTable );
+	AtomicExchangeRelease( pTable->pSlots[ slotIndex ], pNewEntry );
+	++pTable->entryCount;
+
+	sm_tableLock.Unlock();
+
+	return pNewEntry;
+}
+
+/// Search a hash table for an existing entry.
+///
+/// This can be called without holding the table lock.
+///
+/// @param[in] rTable  Table to search.
+/// @param[in] rEntry  Entry to match.
+/// @param[in] hash    Table hash of the entry (see ComputeEntryTableHash()).
+///
+/// @return  Table entry if found, null if not found.
+///
+/// @see Add()
+AssetPath::Entry* AssetPath::FindInTable( const Table& rTable, const Entry& rEntry, size_t hash )
+{
+	size_t slotMask = rTable.capacity - 1;
+	for( size_t slotIndex = hash & slotMask; ; slotIndex = ( slotIndex + 1 ) & slotMask )
+	{
+		Entry* pTableEntry = rTable.pSlots[ slotIndex ];
+		if( !pTableEntry )
+		{
+			return NULL;
+		}
+
+		if( EntryContentsMatch( rEntry, *pTableEntry ) )
+		{
+			return pTableEntry;
+		}
+	}
+}
 
-	// Compute the entry's hash table index and retrieve the corresponding bucket.
-	uint32_t bucketIndex = ComputeEntryStringHash( rEntry ) % TABLE_BUCKET_COUNT;
-	TableBucket& rBucket = sm_pTable[ bucketIndex ];
+/// Allocate a new entry from the current thread's entry arena.
+///
+/// Each thread allocates entries from its own block, so allocation never requires synchronization except when a new
+/// block is needed.
+///
+/// @param[in] rEntry  Entry contents.
+///
+/// @return  Newly allocated entry.
+///
+/// @see FreeEntry()
+AssetPath::Entry* AssetPath::AllocateEntry( const Entry& rEntry )
+{
+	HELIUM_ASSERT( sm_pThreadEntryBlock );
 
-	// Locate the entry in the table.  If it does not exist, add it.
-	size_t entryCount = 0;
-	Entry* pTableEntry = rBucket.Find( rEntry, entryCount );
-	if( !pTableEntry )
+	EntryBlock* pBlock = static_cast< EntryBlock* >( sm_pThreadEntryBlock->GetPointer() );
+	if( !pBlock || pBlock->entryCount >= ENTRY_BLOCK_CAPACITY )
 	{
-		pTableEntry = rBucket.Add( rEntry, entryCount );
-		HELIUM_ASSERT( pTableEntry );
+		pBlock = new EntryBlock;
+		HELIUM_ASSERT( pBlock );
+		pBlock->entryCount = 0;
+
+		sm_tableLock.Lock();
+		pBlock->pNext = sm_pEntryBlocks;
+		sm_pEntryBlocks = pBlock;
+		sm_tableLock.Unlock();
+
+		sm_pThreadEntryBlock->SetPointer( pBlock );
 	}
 
-	return pTableEntry;
+	Entry* pEntry = &pBlock->entries[ pBlock->entryCount ];
+	++pBlock->entryCount;
+
+	*pEntry = rEntry;
+
+	return pEntry;
+}
+
+/// Return an entry allocated with AllocateEntry() that was not added to the table.
+///
+/// This must be called on the thread that allocated the entry, with no other entries allocated in between.
+///
+/// @param[in] pEntry  Entry to free.
+///
+/// @see AllocateEntry()
+void AssetPath::FreeEntry( Entry* pEntry )
+{
+	HELIUM_ASSERT( pEntry );
+	HELIUM_ASSERT( sm_pThreadEntryBlock );
+
+	EntryBlock* pBlock = static_cast< EntryBlock* >( sm_pThreadEntryBlock->GetPointer() );
+	HELIUM_ASSERT( pBlock );
+	HELIUM_ASSERT( pBlock->entryCount != 0 );
+	HELIUM_ASSERT( pEntry == &pBlock->entries[ pBlock->entryCount - 1 ] );
+
+	--pBlock->entryCount;
+}
+
+/// Create an empty hash table.
+///
+/// @param[in] capacity  Number of slots (must be a power of two).
+///
+/// @return  Newly created table.
+AssetPath::Table* AssetPath::CreateTable( size_t capacity )
+{
+	HELIUM_ASSERT( capacity != 0 );
+	HELIUM_ASSERT( ( capacity & ( capacity - 1 ) ) == 0 );
+
+	Table* pTable = static_cast< Table* >( DefaultAllocator().Allocate( sizeof( Table ) + sizeof( Entry* ) * capacity ) );
+	HELIUM_ASSERT( pTable );
+
+	pTable->pPrevious = NULL;
+	pTable->capacity = capacity;
+	pTable->entryCount = 0;
+	pTable->pSlots = reinterpret_cast< Entry* volatile* >( pTable + 1 );
+	MemoryZero( const_cast< Entry** >( pTable->pSlots ), sizeof( Entry* ) * capacity );
+
+	return pTable;
 }
 
 /// Recursive function for building the string representation of an object path entry.
@@ -916,6 +1140,62 @@ void AssetPath::EntryToString( const Entry& rEntry, String& rString )
 	}
 }
 
+/// Recursive function for comparing the string representation of an object path entry against a string.
+///
+/// @param[in]     rEntry     Asset path entry.
+/// @param[in,out] rpString   Start of the string to compare.  On success, this is advanced past the matched portion.
+/// @param[in]     pEnd       End of the string to compare.
+///
+/// @return  True if the string starts with the string representation of the entry, false if not.
+bool AssetPath::EntryMatchesString( const Entry& rEntry, const char*& rpString, const char* pEnd )
+{
+	Entry* pParent = rEntry.pParent;
+	if( pParent && !EntryMatchesString( *pParent, rpString, pEnd ) )
+	{
+		return false;
+	}
+
+	const char* pString = rpString;
+	if( pString == pEnd || *pString != ( rEntry.bPackage ? HELIUM_PACKAGE_PATH_CHAR : HELIUM_OBJECT_PATH_CHAR ) )
+	{
+		return false;
+	}
+
+	++pString;
+
+	const char* pName = rEntry.name.Get();
+	size_t nameLength = strlen( pName );
+	if( static_cast< size_t >( pEnd - pString ) < nameLength || memcmp( pString, pName, nameLength ) != 0 )
+	{
+		return false;
+	}
+
+	pString += nameLength;
+
+	if( IsValid( rEntry.instanceIndex ) )
+	{
+		char instanceIndexString[ 16 ];
+		StringPrint(
+			instanceIndexString,
+			HELIUM_INSTANCE_PATH_CHAR_STRING TXT( "%" ) PRIu32,
+			rEntry.instanceIndex );
+		instanceIndexString[ HELIUM_ARRAY_COUNT( instanceIndexString ) - 1 ] = TXT( '\0' );
+
+		size_t instanceIndexLength = strlen( instanceIndexString );
+		if( static_cast< size_t >( pEnd - pString ) < instanceIndexLength ||
+			memcmp( pString, instanceIndexString, instanceIndexLength ) != 0 )
+		{
+			return false;
+		}
+
+		pString += instanceIndexLength;
+	}
+
+	rpString = pString;
+
+	return true;
+}
+
 /// Recursive function for building the file path string representation of an object path entry.
 ///
 /// @param[in]  rEntry   FilePath entry.
@@ -932,27 +1212,50 @@ void AssetPath::EntryToFilePathString( const Entry& rEntry, String& rString )
 	rString += rEntry.name.Get();
 }
 
-/// Compute a hash value for an object path entry based on the contents of the name strings (slow, should only be
-/// used internally when a string comparison is needed).
+/// Compute the hash table hash value for an object path entry.
+///
+/// Since names and parent entries are both interned, their addresses identify them, so no strings need to be
+/// traversed.
 ///
 /// @param[in] rEntry  Asset path entry.
 ///
 /// @return  Hash value.
-size_t AssetPath::ComputeEntryStringHash( const Entry& rEntry )
+size_t AssetPath::ComputeEntryTableHash( const Entry& rEntry )
 {
-	size_t hash = StringHash( rEntry.name.GetDirect() );
+	size_t hash = static_cast< size_t >( reinterpret_cast< uintptr_t >( rEntry.name.GetDirect() ) );
+	hash = ( ( hash * 33 ) ^ static_cast< size_t >( reinterpret_cast< uintptr_t >( rEntry.pParent ) ) );
 	hash = ( ( hash * 33 ) ^ rEntry.instanceIndex );
 	hash = ( ( hash * 33 ) ^
 		( rEntry.bPackage
 		? static_cast< size_t >( HELIUM_PACKAGE_PATH_CHAR )
 		: static_cast< size_t >( HELIUM_OBJECT_PATH_CHAR ) ) );
 
+	// Mix the high bits down, as the low bits of the addresses are mostly alignment.
+	hash ^= ( hash >> 15 );
+	hash *= 0x2c1b3c6dU;
+	hash ^= ( hash >> 12 );
+
+	return hash;
+}
+
+/// Compute a 64-bit hash value for an object path entry based on the contents of the name strings.
+///
+/// The result depends only on the path contents, so it remains the same across runs and can be stored in files.
+///
+/// @param[in] rEntry  Asset path entry.
+///
+/// @return  Hash value.
+uint64_t AssetPath::ComputeEntryStableHash( const Entry& rEntry )
+{
+	// Hash the parent path, then the delimiter, name and instance index of this entry.
 	Entry* pParent = rEntry.pParent;
-	if( pParent )
-	{
-		size_t parentHash = ComputeEntryStringHash( *pParent );
-		hash = ( ( hash * 33 ) ^ parentHash );
-	}
+	uint64_t hash = ( pParent ? ComputeEntryStableHash( *pParent ) : StableHash::SEED );
+
+	hash = StableHash::AddByte(
+		hash,
+		static_cast< uint8_t >( rEntry.bPackage ? HELIUM_PACKAGE_PATH_CHAR : HELIUM_OBJECT_PATH_CHAR ) );
+	hash = StableHash::AddString( hash, rEntry.name.Get() );
+	hash = StableHash::AddUint32( hash, rEntry.instanceIndex );
 
 	return hash;
 }
@@ -970,73 +1273,3 @@ bool AssetPath::EntryContentsMatch( const Entry& rEntry0, const Entry& rEntry1 )
 		( rEntry0.bPackage ? rEntry1.bPackage : !rEntry1.bPackage ) &&
 		rEntry0.pParent == rEntry1.pParent );
 }
-
-/// Find an existing object path entry in this table.
-///
-/// @param[in]  rEntry       Externally defined entry to match.
-/// @param[out] rEntryCount  Number of entries in this bucket when the search was performed.
-///
-/// @return  Table entry if found, null if not found.
-///
-/// @see Add()
-AssetPath::Entry* AssetPath::TableBucket::Find( const Entry& rEntry, size_t& rEntryCount )
-{
-	ScopeReadLock readLock( m_lock );
-
-	Entry* const * ppTableEntries = m_entries.GetData();
-	size_t entryCount = m_entries.GetSize();
-	HELIUM_ASSERT( ppTableEntries || entryCount == 0 );
-
-	rEntryCount = entryCount;
-
-	for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
-	{
-		Entry* pTableEntry = ppTableEntries[ entryIndex ];
-		HELIUM_ASSERT( pTableEntry );
-		if( EntryContentsMatch( rEntry, *pTableEntry ) )
-		{
-			return pTableEntry;
-		}
-	}
-
-	return NULL;
-}
-
-/// Add an object path entry to this table if it does not already exist.
-///
-/// @param[in] rEntry              Externally defined entry to locate or add.
-/// @param[in] previousEntryCount  Number of entries already checked during a previous Find() call (existing entries
-///                                are not expected to change).  In other words, the entry index from which to start
-///                                checking for any additional string entries that may have been added since the
-///                                previous Find() call.
-///
-/// @return  Pointer to the object path table entry.
-///
-/// @see Find()
-AssetPath::Entry* AssetPath::TableBucket::Add( const Entry& rEntry, size_t previousEntryCount )
-{
-	ScopeWriteLock writeLock( m_lock );
-
-	Entry* const * ppTableEntries = m_entries.GetData();
-	size_t entryCount = m_entries.GetSize();
-	HELIUM_ASSERT( ppTableEntries || entryCount == 0 );
-	HELIUM_ASSERT( previousEntryCount <= entryCount );
-	for( size_t entryIndex = previousEntryCount; entryIndex < entryCount; ++entryIndex )
-	{
-		Entry* pTableEntry = ppTableEntries[ entryIndex ];
-		HELIUM_ASSERT( pTableEntry );
-		if( EntryContentsMatch( rEntry, *pTableEntry ) )
-		{
-			return pTableEntry;
-		}
-	}
-
-	HELIUM_ASSERT( sm_pEntryMemoryHeap );
-	Entry* pNewEntry = static_cast< Entry* >( sm_pEntryMemoryHeap->Allocate( sizeof( Entry ) ) );
-	HELIUM_ASSERT( pNewEntry );
-	new( pNewEntry ) Entry( rEntry );
-
-	m_entries.Push( pNewEntry );
-
-	return pNewEntry;
-}
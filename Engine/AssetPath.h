@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Platform/Locks.h"
+#include "Platform/Thread.h"
 
 #include "Foundation/Name.h"
 #include "Foundation/ObjectPool.h"
@@ -35,10 +36,10 @@ namespace Helium
 	class HELIUM_ENGINE_API AssetPath
 	{
 	public:
-		/// Number of object path hash table buckets (prime numbers are recommended).
-		static const size_t TABLE_BUCKET_COUNT = 37;
-		/// Asset path stack memory heap block size.
-		static const size_t STACK_HEAP_BLOCK_SIZE = sizeof( char ) * 8192;
+		/// Initial number of object path hash table slots (must be a power of two).
+		static const size_t TABLE_CAPACITY_INITIAL = 4096;
+		/// Number of entries allocated at a time for each thread's entry arena.
+		static const size_t ENTRY_BLOCK_CAPACITY = 256;
 		/// Block size for pool of pending links
 		static const size_t PENDING_LINKS_POOL_BLOCK_SIZE = 64;
 
@@ -75,10 +76,13 @@ namespace Helium
 		void ToFilePathString( String& rString ) const;
 		inline String ToFilePathString() const;
 
+		bool MatchesString( const char* pString, size_t length ) const;
+
 		inline bool IsEmpty() const;
 		void Clear();
 
 		inline size_t ComputeHash() const;
+		uint64_t ComputeStableHash() const;
 		//@}
 
 		/// @name Overloaded Operators
@@ -114,30 +118,45 @@ namespace Helium
 			bool bPackage;
 		};
 
-		/// Asset path hash table bucket.
-		class TableBucket
+		/// Open-addressed asset path hash table.
+		///
+		/// Slots are only ever filled in (never cleared), so lookups can probe the table without any locks.  When the
+		/// table grows, entries are copied into a new table and the old table is retired (kept around until shutdown
+		/// for any threads still probing it).
+		struct Table
+		{
+			/// Previous (retired) table.
+			Table* pPrevious;
+			/// Number of slots (always a power of two).
+			size_t capacity;
+			/// Number of slots filled.
+			size_t entryCount;
+			/// Entry slots (null if empty).
+			Entry* volatile* pSlots;
+		};
+
+		/// Block of entries allocated for a single thread's entry arena.
+		struct EntryBlock
 		{
-		public:
-			/// @name Access
-			//@{
-			Entry* Find( const Entry& rEntry, size_t& rEntryCount );
-			Entry* Add( const Entry& rEntry, size_t previousEntryCount );
-			//@}
-
-		private:
-			/// Array of entry pointers.
-			DynamicArray< Entry* > m_entries;
-			/// Read-write lock for synchronizing access.
-			ReadWriteLock m_lock;
+			/// Next block in the list of all allocated blocks.
+			EntryBlock* pNext;
+			/// Number of entries used.
+			size_t entryCount;
+			/// Entry storage.
+			Entry entries[ ENTRY_BLOCK_CAPACITY ];
 		};
 
 		/// Asset path entry.
 		Entry* m_pEntry;
 
-		/// Asset path hash table.
-		static TableBucket* sm_pTable;
-		/// Stack-based memory heap for object path entry allocations.
-		static StackMemoryHeap<>* sm_pEntryMemoryHeap;
+		/// Current asset path hash table.
+		static Table* volatile sm_pTable;
+		/// Lock held while adding entries to the table.
+		static SpinLock sm_tableLock;
+		/// List of all allocated entry blocks.
+		static EntryBlock* sm_pEntryBlocks;
+		/// Entry block from which the current thread allocates new entries.
+		static ThreadLocalPointer* sm_pThreadEntryBlock;
 		static ObjectPool<PendingLink> *sm_pPendingLinksPool;
 
 		/// @name Private Utility Functions
@@ -152,11 +171,17 @@ namespace Helium
 			size_t& rNameCount, size_t& rPackageCount );
 
 		static Entry* Add( const Entry& rEntry );
+		static Entry* FindInTable( const Table& rTable, const Entry& rEntry, size_t hash );
+		static Entry* AllocateEntry( const Entry& rEntry );
+		static void FreeEntry( Entry* pEntry );
+		static Table* CreateTable( size_t capacity );
 
 		static void EntryToString( const Entry& rEntry, String& rString );
 		static void EntryToFilePathString( const Entry& rEntry, String& rString );
+		static bool EntryMatchesString( const Entry& rEntry, const char*& rpString, const char* pEnd );
 
-		static size_t ComputeEntryStringHash( const Entry& rEntry );
+		static size_t ComputeEntryTableHash( const Entry& rEntry );
+		static uint64_t ComputeEntryStableHash( const Entry& rEntry );
 		static bool EntryContentsMatch( const Entry& rEntry0, const Entry& rEntry1 );
 		//@}
 	};
@@ -1,11 +1,36 @@
 #include "EnginePch.h"
 #include "Engine/AsyncLoader.h"
 
+#include "Engine/AsyncLoaderBackend.h"
 #include "Engine/FileLocations.h"
-#include "Foundation/FileStream.h"
+
+#include "Platform/Timer.h"
+
+#include <algorithm>
+#include <string.h>
 
 using namespace Helium;
 
+namespace
+{
+	/// Order requests by file, then by offset within the file.
+	class RequestFileOrderCompare
+	{
+	public:
+		template< typename RequestType >
+		bool operator()( const RequestType* pRequest0, const RequestType* pRequest1 ) const
+		{
+			int fileOrder = strcmp( pRequest0->fileName.GetData(), pRequest1->fileName.GetData() );
+			if( fileOrder != 0 )
+			{
+				return ( fileOrder < 0 );
+			}
+
+			return ( pRequest0->offset < pRequest1->offset );
+		}
+	};
+}
+
 AsyncLoader* AsyncLoader::sm_pInstance = NULL;
 
 /// Constructor.
@@ -13,6 +38,7 @@ AsyncLoader::AsyncLoader()
 	: m_requestPool( REQUEST_POOL_BLOCK_SIZE )
 	, m_pThread( NULL )
 	, m_pWorker( NULL )
+	, m_pBackend( NULL )
 {
 }
 
@@ -31,8 +57,11 @@ bool AsyncLoader::Initialize()
 {
 	Shutdown();
 
-	// Start up the async loading thread.
-	m_pWorker = new LoadWorker;
+	// Set up file access and start up the async loading thread.
+	m_pBackend = AsyncLoaderBackend::Create( READ_IN_FLIGHT_LIMIT );
+	HELIUM_ASSERT( m_pBackend );
+
+	m_pWorker = new LoadWorker( m_pBackend );
 	HELIUM_ASSERT( m_pWorker );
 
 	m_pThread = new RunnableThread( m_pWorker );
@@ -61,6 +90,9 @@ void AsyncLoader::Shutdown()
 
 	delete m_pWorker;
 	m_pWorker = NULL;
+
+	delete m_pBackend;
+	m_pBackend = NULL;
 }
 
 /// Queue an async load request.
@@ -69,17 +101,21 @@ void AsyncLoader::Shutdown()
 /// @param[in] rFileName  FilePath name of the file from which to load.
 /// @param[in] offset     Byte offset within the file from which to load.
 /// @param[in] size       Number of bytes to read.
-/// @param[in] priority   Load priority.
+/// @param[in] priority         Load priority.
+/// @param[in] pCompletionFunc  Optional callback to run on the loading thread once the request completes.
+/// @param[in] pCompletionData  User data to pass to the completion callback.
 ///
 /// @return  ID identifying the load request if queued successfully, invalid index if the request queue failed.
 ///
-/// @see SyncRequest(), TrySyncRequest()
+/// @see SyncRequest(), TrySyncRequest(), WaitForRequest()
 size_t AsyncLoader::QueueRequest(
 	void* pBuffer,
 	const String& rFileName,
 	uint64_t offset,
 	size_t size,
-	EPriority priority )
+	EPriority priority,
+	COMPLETION_FUNC pCompletionFunc,
+	void* pCompletionData )
 {
 	HELIUM_ASSERT( pBuffer );
 	HELIUM_ASSERT( static_cast< size_t >( priority ) < static_cast< size_t >( PRIORITY_MAX ) );
@@ -98,7 +134,10 @@ size_t AsyncLoader::QueueRequest(
 	pRequest->offset = offset;
 	pRequest->size = size;
 	pRequest->priority = priority;
+	pRequest->pCompletionFunc = pCompletionFunc;
+	pRequest->pCompletionData = pCompletionData;
 
+	pRequest->pWaiter = NULL;
 	pRequest->bytesRead = 0;
 	AtomicExchangeRelease( pRequest->processedCounter, 0 );
 
@@ -128,9 +167,10 @@ size_t AsyncLoader::SyncRequest( size_t id )
 	Request* pRequest = m_requestPool.GetObject( id );
 	HELIUM_ASSERT( pRequest );
 
-	while( pRequest->processedCounter == 0 )
+	if( pRequest->processedCounter == 0 )
 	{
-		Thread::Yield();
+		HELIUM_ASSERT( m_pWorker );
+		m_pWorker->WaitForRequests( &pRequest, 1, true, Invalid< uint32_t >() );
 	}
 
 	size_t bytesRead = pRequest->bytesRead;
@@ -169,6 +209,152 @@ bool AsyncLoader::TrySyncRequest( size_t id, size_t& rBytesRead )
 	return true;
 }
 
+/// Block the current thread until the load request with the specified ID completes or the given timeout elapses.
+///
+/// Unlike SyncRequest(), this does not release the request information.  Only one thread may wait on a given request
+/// at a time.
+///
+/// @param[in] id         Request ID.
+/// @param[in] timeoutMs  Maximum time to wait, in milliseconds, or an invalid value to wait indefinitely.
+///
+/// @return  True if the request has completed, false if the timeout elapsed first.
+///
+/// @see WaitForAnyRequest(), WaitForAllRequests(), SyncRequest()
+bool AsyncLoader::WaitForRequest( size_t id, uint32_t timeoutMs )
+{
+	HELIUM_ASSERT( IsValid( id ) );
+
+	if( !m_pWorker )
+	{
+		return false;
+	}
+
+	Request* pRequest = m_requestPool.GetObject( id );
+	HELIUM_ASSERT( pRequest );
+
+	return IsValid( m_pWorker->WaitForRequests( &pRequest, 1, true, timeoutMs ) );
+}
+
+/// Block the current thread until any of the given load requests completes or the given timeout elapses.
+///
+/// @param[in] pIds       Request IDs.
+/// @param[in] idCount    Number of request IDs.
+/// @param[in] timeoutMs  Maximum time to wait, in milliseconds, or an invalid value to wait indefinitely.
+///
+/// @return  Index within the ID array of a completed request, or an invalid index if the timeout elapsed first.
+///
+/// @see WaitForRequest(), WaitForAllRequests()
+size_t AsyncLoader::WaitForAnyRequest( const size_t* pIds, size_t idCount, uint32_t timeoutMs )
+{
+	HELIUM_ASSERT( pIds || idCount == 0 );
+
+	if( idCount == 0 || !m_pWorker )
+	{
+		return Invalid< size_t >();
+	}
+
+	DynamicArray< Request* > requests;
+	requests.Reserve( idCount );
+	for( size_t idIndex = 0; idIndex < idCount; ++idIndex )
+	{
+		HELIUM_ASSERT( IsValid( pIds[ idIndex ] ) );
+		Request* pRequest = m_requestPool.GetObject( pIds[ idIndex ] );
+		HELIUM_ASSERT( pRequest );
+		requests.Push( pRequest );
+	}
+
+	return m_pWorker->WaitForRequests( requests.GetData(), idCount, false, timeoutMs );
+}
+
+/// Block the current thread until all of the given load requests complete or the given timeout elapses.
+///
+/// @param[in] pIds       Request IDs.
+/// @param[in] idCount    Number of request IDs.
+/// @param[in] timeoutMs  Maximum time to wait, in milliseconds, or an invalid value to wait indefinitely.
+///
+/// @return  True if all requests have completed, false if the timeout elapsed first.
+///
+/// @see WaitForRequest(), WaitForAnyRequest()
+bool AsyncLoader::WaitForAllRequests( const size_t* pIds, size_t idCount, uint32_t timeoutMs )
+{
+	HELIUM_ASSERT( pIds || idCount == 0 );
+
+	if( idCount == 0 )
+	{
+		return true;
+	}
+
+	if( !m_pWorker )
+	{
+		return false;
+	}
+
+	DynamicArray< Request* > requests;
+	requests.Reserve( idCount );
+	for( size_t idIndex = 0; idIndex < idCount; ++idIndex )
+	{
+		HELIUM_ASSERT( IsValid( pIds[ idIndex ] ) );
+		Request* pRequest = m_requestPool.GetObject( pIds[ idIndex ] );
+		HELIUM_ASSERT( pRequest );
+		requests.Push( pRequest );
+	}
+
+	return IsValid( m_pWorker->WaitForRequests( requests.GetData(), idCount, true, timeoutMs ) );
+}
+
+/// Get the current loading progress count, for passing to WaitForProgress().
+///
+/// The count changes each time a load request completes or progress is reported through NotifyProgress().
+///
+/// @return  Current progress count.
+///
+/// @see WaitForProgress(), NotifyProgress()
+uint32_t AsyncLoader::GetProgressCount() const
+{
+	return ( m_pWorker ? m_pWorker->GetProgressCount() : 0 );
+}
+
+/// Block the current thread until any load request completes, progress is reported through NotifyProgress(), or the
+/// given timeout elapses.
+///
+/// This is intended for threads driving their own load state machines (such as the asset loader) that have nothing
+/// else to do until more data arrives or other threads finish their part of the work.  The progress count should be
+/// read with GetProgressCount() before checking for work, so that progress made in the mean time is not missed.
+///
+/// @param[in] progressCount  Progress count from GetProgressCount().  Returns immediately if the count has changed.
+/// @param[in] timeoutMs      Maximum time to wait, in milliseconds.
+///
+/// @return  True if progress was made, false if the timeout elapsed first.
+///
+/// @see GetProgressCount(), NotifyProgress()
+bool AsyncLoader::WaitForProgress( uint32_t progressCount, uint32_t timeoutMs )
+{
+	if( !m_pWorker )
+	{
+		// Nothing can complete without the loading thread, so just wait out the timeout instead of letting the caller
+		// spin.
+		Thread::Sleep( timeoutMs );
+
+		return false;
+	}
+
+	return m_pWorker->WaitForProgress( progressCount, timeoutMs );
+}
+
+/// Wake up threads waiting in WaitForProgress().
+///
+/// This should be called by work running outside of the loading thread that other threads may be waiting on, such as
+/// dispatched decompression or deserialization tasks.
+///
+/// @see GetProgressCount(), WaitForProgress()
+void AsyncLoader::NotifyProgress()
+{
+	if( m_pWorker )
+	{
+		m_pWorker->NotifyProgress();
+	}
+}
+
 /// Block the current thread until all pending load requests have completed.
 ///
 /// Note that this does not release any requests.  SyncRequest() or TrySyncRequest() must still be called for all
@@ -233,73 +419,116 @@ void AsyncLoader::DestroyStaticInstance()
 }
 
 /// Constructor.
-AsyncLoader::LoadWorker::LoadWorker()
+AsyncLoader::Waiter::Waiter()
+	: condition( false, false )
+{
+}
+
+/// Constructor.
+AsyncLoader::RequestQueue::RequestQueue()
+{
+	for( size_t priorityIndex = 0; priorityIndex < PRIORITY_MAX; ++priorityIndex )
+	{
+		heads[ priorityIndex ] = 0;
+	}
+}
+
+/// Constructor.
+///
+/// @param[in] pBackend  Backend to use for file access.
+AsyncLoader::LoadWorker::LoadWorker( AsyncLoaderBackend* pBackend )
 	: m_wakeUpCondition( false, false )
+	, m_closeFilesCondition( false, false )
+	, m_progressCount( 0 )
+	, m_pBackend( pBackend )
+	, m_readOperationPool( READ_IN_FLIGHT_LIMIT )
+	, m_inFlightCount( 0 )
+	, m_openFileTick( 0 )
 	, m_stopCounter( 0 )
-	, m_processingCounter( 0 )
+	, m_pendingRequestCount( 0 )
+	, m_closeFilesCounter( 0 )
 {
+	HELIUM_ASSERT( pBackend );
 }
 
 /// Destructor.
 AsyncLoader::LoadWorker::~LoadWorker()
 {
+	for( size_t operationIndex = 0; operationIndex < m_readyOperations.GetSize(); ++operationIndex )
+	{
+		m_readOperationPool.Release( m_readyOperations[ operationIndex ] );
+	}
+
+	CloseOpenFiles();
 }
 
 /// Execute the async loading work.
 void AsyncLoader::LoadWorker::Run()
 {
-	BufferedStream* pBufferedStream = new BufferedStream;
-	HELIUM_ASSERT( pBufferedStream );
+	AsyncReadOperation* completedReads[ READ_IN_FLIGHT_LIMIT ];
 
-	while( m_stopCounter == 0 )
+	for( ; ; )
 	{
-		AtomicExchangeAcquire( m_processingCounter, 1 );
-
-		Request* pRequest;
+		bool bStopping = ( m_stopCounter != 0 );
+		if( bStopping && m_inFlightCount == 0 )
 		{
-			Locker< DynamicArray< Request* >, SpinLock >::Handle handle ( m_requestQueue );
-			pRequest = handle->IsEmpty() ? NULL : handle->Pop();
+			break;
 		}
-		if( !pRequest )
-		{
-			// Queue is empty, so sleep until notified.
-			AtomicExchangeRelease( m_processingCounter, 0 );
-			m_wakeUpCondition.Wait();
 
-			continue;
+		if( m_closeFilesCounter != 0 && m_inFlightCount == 0 )
+		{
+			CloseOpenFiles();
+			AtomicExchangeRelease( m_closeFilesCounter, 0 );
+			m_closeFilesCondition.Signal();
 		}
 
-		HELIUM_ASSERT( pRequest );
-
-		FileStream* pFileStream = FileStream::OpenFileStream( pRequest->fileName, FileStream::MODE_READ );
-		if( !pFileStream )
+		// Keep as many reads in flight as the backend allows, pulling in more queued requests as needed.
+		if( !bStopping )
 		{
-			SetInvalid( pRequest->bytesRead );
+			for( ; ; )
+			{
+				SubmitReadOperations();
+				if( m_inFlightCount >= m_pBackend->GetReadLimit() || !m_readyOperations.IsEmpty() )
+				{
+					break;
+				}
+
+				if( !DispatchRequests() )
+				{
+					break;
+				}
+			}
+
+			m_pBackend->FlushSubmissions();
 		}
-		else
-		{
-			pRequest->bytesRead = 0;
 
-			pBufferedStream->Open( pFileStream );
-			int64_t offset = pBufferedStream->Seek( pRequest->offset, SeekOrigins::Begin );
-			if( static_cast< uint64_t >( offset ) == pRequest->offset )
+		if( m_inFlightCount == 0 )
+		{
+			// Nothing queued and nothing in flight, so sleep until notified.
+			if( m_readyOperations.IsEmpty() )
 			{
-				pRequest->bytesRead = pBufferedStream->Read( pRequest->pBuffer, 1, pRequest->size );
+				m_wakeUpCondition.Wait();
 			}
 
-			pBufferedStream->Open( NULL );
-
-			delete pFileStream;
+			continue;
 		}
 
-		AtomicExchangeRelease( pRequest->processedCounter, 1 );
+		// Wait for reads to complete (the wait is interrupted if more requests are queued in the mean time).
+		size_t completedCount = m_pBackend->Reap( completedReads, HELIUM_ARRAY_COUNT( completedReads ), true );
+		for( size_t completedIndex = 0; completedIndex < completedCount; ++completedIndex )
+		{
+			AsyncReadOperation* pRead = completedReads[ completedIndex ];
+			HELIUM_ASSERT( pRead );
 
-		Thread::Yield();
-	}
+			ReadOperation* pOperation = static_cast< ReadOperation* >( pRead->pUserData );
+			HELIUM_ASSERT( pOperation );
 
-	AtomicExchangeRelease( m_processingCounter, 0 );
+			HELIUM_ASSERT( m_inFlightCount != 0 );
+			--m_inFlightCount;
 
-	delete pBufferedStream;
+			CompleteReadOperation( pOperation, pRead->bytesRead );
+		}
+	}
 }
 
 /// Request the load worker to stop processing and return at the next possible opportunity.
@@ -307,6 +536,7 @@ void AsyncLoader::LoadWorker::Stop()
 {
 	AtomicExchangeRelease( m_stopCounter, 1 );
 	m_wakeUpCondition.Signal();
+	m_pBackend->Interrupt();
 }
 
 /// Queue an async load request.
@@ -320,16 +550,189 @@ void AsyncLoader::LoadWorker::QueueRequest( Request* pRequest )
 {
 	HELIUM_ASSERT( pRequest );
 	HELIUM_ASSERT( pRequest->processedCounter == 0 );
+	HELIUM_ASSERT( static_cast< size_t >( pRequest->priority ) < static_cast< size_t >( PRIORITY_MAX ) );
 
 	// Prevent access to the load queue while an exclusive write lock is held.
 	ScopeReadLock nonExclusiveLock( m_writeLock );
 
+	AtomicIncrementAcquire( m_pendingRequestCount );
+
 	{
-		Locker< DynamicArray< Request* >, SpinLock >::Handle handle ( m_requestQueue );
-		handle->Push( pRequest );
+		Locker< RequestQueue, SpinLock >::Handle handle ( m_requestQueue );
+		handle->requests[ pRequest->priority ].Push( pRequest );
 	}
 
 	m_wakeUpCondition.Signal();
+	m_pBackend->Interrupt();
+}
+
+/// Block the current thread until one or all of the given requests have completed or the given timeout elapses.
+///
+/// The calling thread sleeps while waiting, and is woken by the loading thread as the requests complete.
+///
+/// @param[in] ppRequests    Requests on which to wait.
+/// @param[in] requestCount  Number of requests.
+/// @param[in] bWaitAll      True to wait for all requests to complete, false to wait for any one of them.
+/// @param[in] timeoutMs     Maximum time to wait, in milliseconds, or an invalid value to wait indefinitely.
+///
+/// @return  Index of a completed request (zero when waiting on all requests), or an invalid index if the timeout
+///          elapsed first.
+size_t AsyncLoader::LoadWorker::WaitForRequests(
+	Request* const* ppRequests,
+	size_t requestCount,
+	bool bWaitAll,
+	uint32_t timeoutMs )
+{
+	HELIUM_ASSERT( ppRequests );
+	HELIUM_ASSERT( requestCount != 0 );
+
+	Waiter waiter;
+	uint64_t startTickCount = Timer::GetTickCount();
+	bool bTimedOut = false;
+
+	for( ; ; )
+	{
+		// Check for completion and register as the waiter on each pending request while holding the completion lock,
+		// so that the loading thread cannot mark a request as processed without seeing the registration.
+		size_t completedIndex = Invalid< size_t >();
+		size_t pendingCount = 0;
+
+		m_completionLock.Lock();
+
+		for( size_t requestIndex = 0; requestIndex < requestCount; ++requestIndex )
+		{
+			Request* pRequest = ppRequests[ requestIndex ];
+			HELIUM_ASSERT( pRequest );
+			if( pRequest->processedCounter != 0 )
+			{
+				if( IsInvalid( completedIndex ) )
+				{
+					completedIndex = requestIndex;
+				}
+			}
+			else
+			{
+				++pendingCount;
+			}
+		}
+
+		bool bDone = ( bWaitAll ? pendingCount == 0 : IsValid( completedIndex ) );
+		if( bDone || bTimedOut )
+		{
+			for( size_t requestIndex = 0; requestIndex < requestCount; ++requestIndex )
+			{
+				Request* pRequest = ppRequests[ requestIndex ];
+				if( pRequest->pWaiter == &waiter )
+				{
+					pRequest->pWaiter = NULL;
+				}
+			}
+
+			m_completionLock.Unlock();
+
+			if( !bDone )
+			{
+				return Invalid< size_t >();
+			}
+
+			return ( bWaitAll ? 0 : completedIndex );
+		}
+
+		for( size_t requestIndex = 0; requestIndex < requestCount; ++requestIndex )
+		{
+			Request* pRequest = ppRequests[ requestIndex ];
+			if( pRequest->processedCounter == 0 )
+			{
+				HELIUM_ASSERT( !pRequest->pWaiter || pRequest->pWaiter == &waiter );
+				pRequest->pWaiter = &waiter;
+			}
+		}
+
+		m_completionLock.Unlock();
+
+		if( IsInvalid( timeoutMs ) )
+		{
+			waiter.condition.Wait();
+		}
+		else
+		{
+			uint32_t remainingMs = GetRemainingTimeout( timeoutMs, startTickCount );
+			bTimedOut = ( remainingMs == 0 || !waiter.condition.Wait( remainingMs ) );
+		}
+	}
+}
+
+/// Get the current progress count.
+///
+/// @return  Progress count.
+uint32_t AsyncLoader::LoadWorker::GetProgressCount() const
+{
+	return m_progressCount;
+}
+
+/// Block the current thread until progress is made or the given timeout elapses.
+///
+/// @param[in] progressCount  Progress count read before the caller last checked for work.
+/// @param[in] timeoutMs      Maximum time to wait, in milliseconds.
+///
+/// @return  True if progress was made, false if the timeout elapsed first.
+bool AsyncLoader::LoadWorker::WaitForProgress( uint32_t progressCount, uint32_t timeoutMs )
+{
+	Waiter waiter;
+
+	m_completionLock.Lock();
+
+	// The count is only changed while holding the completion lock, so any progress since it was read is caught here.
+	if( m_progressCount != progressCount )
+	{
+		m_completionLock.Unlock();
+
+		return true;
+	}
+
+	m_progressWaiters.Push( &waiter );
+
+	m_completionLock.Unlock();
+
+	bool bSignaled = waiter.condition.Wait( timeoutMs );
+	if( !bSignaled )
+	{
+		// Remove our registration, unless the loading thread got to it between the timeout and taking the lock.
+		m_completionLock.Lock();
+
+		size_t waiterCount = m_progressWaiters.GetSize();
+		for( size_t waiterIndex = 0; waiterIndex < waiterCount; ++waiterIndex )
+		{
+			if( m_progressWaiters[ waiterIndex ] == &waiter )
+			{
+				m_progressWaiters.RemoveSwap( waiterIndex );
+
+				break;
+			}
+		}
+
+		m_completionLock.Unlock();
+	}
+
+	return bSignaled;
+}
+
+/// Update the progress count and wake up all threads waiting on progress.
+void AsyncLoader::LoadWorker::NotifyProgress()
+{
+	m_completionLock.Lock();
+
+	++m_progressCount;
+
+	size_t waiterCount = m_progressWaiters.GetSize();
+	for( size_t waiterIndex = 0; waiterIndex < waiterCount; ++waiterIndex )
+	{
+		m_progressWaiters[ waiterIndex ]->condition.Signal();
+	}
+
+	m_progressWaiters.Resize( 0 );
+
+	m_completionLock.Unlock();
 }
 
 /// Block the current thread until all pending load requests have completed.
@@ -337,20 +740,33 @@ void AsyncLoader::LoadWorker::QueueRequest( Request* pRequest )
 /// @see QueueRequest()
 void AsyncLoader::LoadWorker::Flush()
 {
-	bool isEmpty;
-	{
-		Locker< DynamicArray< Request* >, SpinLock >::Handle handle ( m_requestQueue );
-		isEmpty = handle->IsEmpty();
-	}
+	Waiter waiter;
 
-	while( m_processingCounter != 0 && !isEmpty )
+	for( ; ; )
 	{
-		Thread::Yield();
+		// The pending request count is decremented before progress waiters are signaled, so checking it under the
+		// completion lock ensures that the final wake-up is not missed.
+		m_completionLock.Lock();
+
+		if( m_pendingRequestCount == 0 )
+		{
+			m_completionLock.Unlock();
+
+			break;
+		}
+
+		m_progressWaiters.Push( &waiter );
+
+		m_completionLock.Unlock();
+
+		waiter.condition.Wait();
 	}
 }
 
 /// Acquire an exclusive lock for writing to files and flush the async loader queue.
 ///
+/// Any files kept open by the loader are closed so that subsequent reads see the results of the write.
+///
 /// @see Unlock()
 void AsyncLoader::LoadWorker::Lock()
 {
@@ -358,6 +774,15 @@ void AsyncLoader::LoadWorker::Lock()
 	m_writeLock.LockWrite();
 
 	Flush();
+
+	AtomicExchangeRelease( m_closeFilesCounter, 1 );
+	m_wakeUpCondition.Signal();
+	m_pBackend->Interrupt();
+
+	while( m_closeFilesCounter != 0 )
+	{
+		m_closeFilesCondition.Wait();
+	}
 }
 
 /// Release an exclusive lock for writing to files.
@@ -367,3 +792,291 @@ void AsyncLoader::LoadWorker::Unlock()
 {
 	m_writeLock.UnlockWrite();
 }
+
+/// Pull a batch of requests off of the request queue and build read operations for them.
+///
+/// Requests are taken highest priority first.  Within the batch, requests for adjacent ranges of the same file are
+/// merged into a single read.
+///
+/// @return  True if any requests were dispatched, false if the queue was empty.
+bool AsyncLoader::LoadWorker::DispatchRequests()
+{
+	Request* batch[ MERGE_BATCH_SIZE ];
+	size_t batchSize = 0;
+
+	{
+		Locker< RequestQueue, SpinLock >::Handle handle ( m_requestQueue );
+		for( size_t priorityIndex = PRIORITY_MAX; priorityIndex-- > 0 && batchSize < MERGE_BATCH_SIZE; )
+		{
+			DynamicArray< Request* >& rRequests = handle->requests[ priorityIndex ];
+			size_t& rHead = handle->heads[ priorityIndex ];
+			while( rHead < rRequests.GetSize() && batchSize < MERGE_BATCH_SIZE )
+			{
+				batch[ batchSize++ ] = rRequests[ rHead++ ];
+			}
+
+			if( rHead == rRequests.GetSize() )
+			{
+				rRequests.Resize( 0 );
+				rHead = 0;
+			}
+		}
+	}
+
+	if( batchSize == 0 )
+	{
+		return false;
+	}
+
+	std::sort( batch, batch + batchSize, RequestFileOrderCompare() );
+
+	size_t batchIndex = 0;
+	while( batchIndex < batchSize )
+	{
+		Request* pFirstRequest = batch[ batchIndex ];
+
+		ReadOperation* pOperation = m_readOperationPool.Allocate();
+		HELIUM_ASSERT( pOperation );
+		pOperation->read.offset = pFirstRequest->offset;
+		pOperation->read.bufferCount = 0;
+		pOperation->read.bytesRead = 0;
+		pOperation->read.pUserData = pOperation;
+		pOperation->requestCount = 0;
+		SetInvalid( pOperation->openFileIndex );
+		pOperation->priority = pFirstRequest->priority;
+
+		uint64_t readEnd = pFirstRequest->offset;
+		do
+		{
+			Request* pRequest = batch[ batchIndex ];
+
+			AsyncReadOperation::Buffer& rBuffer = pOperation->read.buffers[ pOperation->read.bufferCount++ ];
+			rBuffer.pData = pRequest->pBuffer;
+			rBuffer.size = pRequest->size;
+
+			pOperation->requests[ pOperation->requestCount++ ] = pRequest;
+			pOperation->priority = Max( pOperation->priority, pRequest->priority );
+
+			readEnd += pRequest->size;
+			++batchIndex;
+		} while( batchIndex < batchSize &&
+			pOperation->requestCount < AsyncReadOperation::BUFFER_COUNT_MAX &&
+			batch[ batchIndex ]->offset == readEnd &&
+			batch[ batchIndex ]->fileName == pFirstRequest->fileName );
+
+		// Insert the read after all reads of the same or higher priority.
+		size_t insertIndex = m_readyOperations.GetSize();
+		m_readyOperations.Push( pOperation );
+		while( insertIndex > 0 && m_readyOperations[ insertIndex - 1 ]->priority < pOperation->priority )
+		{
+			m_readyOperations[ insertIndex ] = m_readyOperations[ insertIndex - 1 ];
+			--insertIndex;
+		}
+
+		m_readyOperations[ insertIndex ] = pOperation;
+	}
+
+	return true;
+}
+
+/// Submit as many ready read operations to the backend as possible.
+///
+/// Reads for files that cannot be opened right now (because all file slots are in use by reads in flight) are left
+/// in the ready list in their original order.
+void AsyncLoader::LoadWorker::SubmitReadOperations()
+{
+	size_t readLimit = m_pBackend->GetReadLimit();
+	size_t keepCount = 0;
+
+	size_t readyCount = m_readyOperations.GetSize();
+	for( size_t readyIndex = 0; readyIndex < readyCount; ++readyIndex )
+	{
+		ReadOperation* pOperation = m_readyOperations[ readyIndex ];
+		HELIUM_ASSERT( pOperation );
+
+		if( m_inFlightCount < readLimit )
+		{
+			size_t openFileIndex;
+			EAcquireResult result = AcquireOpenFile( pOperation->requests[ 0 ]->fileName, openFileIndex );
+			if( result == ACQUIRE_SUCCESS )
+			{
+				pOperation->openFileIndex = openFileIndex;
+				pOperation->read.fileHandle = m_openFiles[ openFileIndex ].handle;
+
+				++m_inFlightCount;
+				m_pBackend->Submit( &pOperation->read );
+
+				continue;
+			}
+
+			if( result == ACQUIRE_FAILED )
+			{
+				CompleteReadOperation( pOperation, Invalid< size_t >() );
+
+				continue;
+			}
+		}
+
+		m_readyOperations[ keepCount++ ] = pOperation;
+	}
+
+	m_readyOperations.Resize( keepCount );
+}
+
+/// Hand the results of a read operation out to each of its requests and release the operation.
+///
+/// @param[in] pOperation  Completed read operation.
+/// @param[in] bytesRead   Number of bytes read, or an invalid index if the file could not be opened.
+void AsyncLoader::LoadWorker::CompleteReadOperation( ReadOperation* pOperation, size_t bytesRead )
+{
+	HELIUM_ASSERT( pOperation );
+
+	if( IsValid( pOperation->openFileIndex ) )
+	{
+		OpenFile& rOpenFile = m_openFiles[ pOperation->openFileIndex ];
+		HELIUM_ASSERT( rOpenFile.readCount != 0 );
+		--rOpenFile.readCount;
+	}
+
+	size_t requestCount = pOperation->requestCount;
+	for( size_t requestIndex = 0; requestIndex < requestCount; ++requestIndex )
+	{
+		Request* pRequest = pOperation->requests[ requestIndex ];
+		HELIUM_ASSERT( pRequest );
+
+		if( IsInvalid( bytesRead ) )
+		{
+			SetInvalid( pRequest->bytesRead );
+		}
+		else
+		{
+			size_t requestBytesRead = Min( bytesRead, pRequest->size );
+			pRequest->bytesRead = requestBytesRead;
+			bytesRead -= requestBytesRead;
+		}
+
+		if( pRequest->pCompletionFunc )
+		{
+			pRequest->pCompletionFunc( pRequest->pCompletionData, pRequest->bytesRead );
+		}
+
+		// The request may be released by another thread as soon as it is marked as processed, so it must not be
+		// accessed afterward.  The waiter is signaled under the lock, as it is destroyed as soon as the waiting thread
+		// sees the request as processed.
+		m_completionLock.Lock();
+
+		Waiter* pWaiter = pRequest->pWaiter;
+		pRequest->pWaiter = NULL;
+		AtomicExchangeRelease( pRequest->processedCounter, 1 );
+		if( pWaiter )
+		{
+			pWaiter->condition.Signal();
+		}
+
+		m_completionLock.Unlock();
+
+		AtomicDecrementRelease( m_pendingRequestCount );
+	}
+
+	// Wake up any threads waiting on general loading progress.
+	NotifyProgress();
+
+	m_readOperationPool.Release( pOperation );
+}
+
+/// Get an open handle for a file, opening it if necessary.
+///
+/// @param[in]  rFileName  Name of the file to open.
+/// @param[out] rIndex     Index of the open file entry if successful.
+///
+/// @return  ACQUIRE_SUCCESS if the file is open, ACQUIRE_BUSY if it is not open and all file slots are in use by reads
+///          in flight, or ACQUIRE_FAILED if the file could not be opened.
+AsyncLoader::LoadWorker::EAcquireResult AsyncLoader::LoadWorker::AcquireOpenFile( const String& rFileName, size_t& rIndex )
+{
+	size_t openFileCount = m_openFiles.GetSize();
+	size_t leastRecentIndex = Invalid< size_t >();
+
+	for( size_t openFileIndex = 0; openFileIndex < openFileCount; ++openFileIndex )
+	{
+		OpenFile& rOpenFile = m_openFiles[ openFileIndex ];
+		if( rOpenFile.fileName == rFileName )
+		{
+			++rOpenFile.readCount;
+			rOpenFile.lastUseTick = ++m_openFileTick;
+			rIndex = openFileIndex;
+
+			return ACQUIRE_SUCCESS;
+		}
+
+		if( rOpenFile.readCount == 0 &&
+			( IsInvalid( leastRecentIndex ) || rOpenFile.lastUseTick < m_openFiles[ leastRecentIndex ].lastUseTick ) )
+		{
+			leastRecentIndex = openFileIndex;
+		}
+	}
+
+	// Reuse the least recently used idle slot once the open file limit has been reached.  Slots are never moved, as
+	// reads in flight refer to them by index.
+	if( openFileCount >= FILE_STREAM_LIMIT && IsInvalid( leastRecentIndex ) )
+	{
+		return ACQUIRE_BUSY;
+	}
+
+	uintptr_t handle = m_pBackend->OpenFile( rFileName );
+	if( IsInvalid( handle ) )
+	{
+		return ACQUIRE_FAILED;
+	}
+
+	if( openFileCount >= FILE_STREAM_LIMIT )
+	{
+		rIndex = leastRecentIndex;
+		m_pBackend->CloseFile( m_openFiles[ rIndex ].handle );
+	}
+	else
+	{
+		rIndex = openFileCount;
+		m_openFiles.Resize( openFileCount + 1 );
+	}
+
+	OpenFile& rOpenFile = m_openFiles[ rIndex ];
+	rOpenFile.fileName = rFileName;
+	rOpenFile.handle = handle;
+	rOpenFile.lastUseTick = ++m_openFileTick;
+	rOpenFile.readCount = 1;
+
+	return ACQUIRE_SUCCESS;
+}
+
+/// Close all open files.
+///
+/// This must only be called when no reads are in flight.
+void AsyncLoader::LoadWorker::CloseOpenFiles()
+{
+	HELIUM_ASSERT( m_inFlightCount == 0 );
+
+	size_t openFileCount = m_openFiles.GetSize();
+	for( size_t openFileIndex = 0; openFileIndex < openFileCount; ++openFileIndex )
+	{
+		m_pBackend->CloseFile( m_openFiles[ openFileIndex ].handle );
+	}
+
+	m_openFiles.Clear();
+}
+
+/// Get the time remaining for a wait.
+///
+/// @param[in] timeoutMs       Total timeout, in milliseconds.
+/// @param[in] startTickCount  Tick count at which the wait started.
+///
+/// @return  Number of milliseconds remaining, or zero if the timeout has elapsed.
+uint32_t AsyncLoader::LoadWorker::GetRemainingTimeout( uint32_t timeoutMs, uint64_t startTickCount )
+{
+	uint64_t elapsedMs = static_cast< uint64_t >( Timer::TicksToMilliseconds( Timer::GetTickCount() - startTickCount ) );
+	if( elapsedMs >= timeoutMs )
+	{
+		return 0;
+	}
+
+	return static_cast< uint32_t >( timeoutMs - elapsedMs );
+}
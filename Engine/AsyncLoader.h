@@ -9,6 +9,7 @@
 #include "Foundation/String.h"
 
 #include "Engine/Engine.h"
+#include "Engine/AsyncLoaderBackend.h"
 
 #ifdef _MSC_VER
 #pragma warning( push )
@@ -22,6 +23,15 @@
 namespace Helium
 {
 	/// Async loading manager.
+	///
+	/// Requests are queued per priority and served highest priority first, in the order queued.  A single loading
+	/// thread pulls batches of queued requests, merges requests for adjacent ranges of the same file into single
+	/// vectored reads, and keeps up to READ_IN_FLIGHT_LIMIT reads in flight through an AsyncLoaderBackend (io_uring on
+	/// Linux where available, a pool of pread threads on other POSIX platforms).  Up to FILE_STREAM_LIMIT files are
+	/// kept open between requests, with the least recently used idle file closed when another needs to be opened.
+	///
+	/// Threads waiting on requests sleep until the loading thread signals them as the requests they wait on complete.
+	/// Requests can also be given a completion callback, which is run on the loading thread.
 	class HELIUM_ENGINE_API AsyncLoader : NonCopyable
 	{
 	public:
@@ -29,6 +39,10 @@ namespace Helium
 		static const size_t REQUEST_POOL_BLOCK_SIZE = 128;
 		/// Maximum number of open file streams.
 		static const size_t FILE_STREAM_LIMIT = 16;
+		/// Maximum number of reads in flight at once.
+		static const size_t READ_IN_FLIGHT_LIMIT = 32;
+		/// Maximum number of queued requests pulled at once for merging into reads.
+		static const size_t MERGE_BATCH_SIZE = 64;
 
 		/// Load request priority.
 		enum EPriority
@@ -44,6 +58,13 @@ namespace Helium
 			PRIORITY_LAST = PRIORITY_MAX - 1
 		};
 
+		/// Request completion callback, run on the loading thread once a request completes.
+		///
+		/// The callback receives the user data given when queueing the request and the number of bytes read (an invalid
+		/// index if the file could not be opened).  The request must still be released with SyncRequest() or
+		/// TrySyncRequest(), and the callback must not block waiting on other requests.
+		typedef void ( *COMPLETION_FUNC )( void* pUserData, size_t bytesRead );
+
 		/// @name Initialization
 		//@{
 		bool Initialize();
@@ -54,10 +75,17 @@ namespace Helium
 		//@{
 		size_t QueueRequest(
 			void* pBuffer, const String& rFileName, uint64_t offset, size_t size,
-			EPriority priority = PRIORITY_NORMAL );
+			EPriority priority = PRIORITY_NORMAL, COMPLETION_FUNC pCompletionFunc = NULL, void* pCompletionData = NULL );
 		size_t SyncRequest( size_t id );
 		bool TrySyncRequest( size_t id, size_t& rBytesRead );
 
+		bool WaitForRequest( size_t id, uint32_t timeoutMs = Invalid< uint32_t >() );
+		size_t WaitForAnyRequest( const size_t* pIds, size_t idCount, uint32_t timeoutMs = Invalid< uint32_t >() );
+		bool WaitForAllRequests( const size_t* pIds, size_t idCount, uint32_t timeoutMs = Invalid< uint32_t >() );
+		uint32_t GetProgressCount() const;
+		bool WaitForProgress( uint32_t progressCount, uint32_t timeoutMs );
+		void NotifyProgress();
+
 		void Flush();
 
 		void Lock();
@@ -71,6 +99,18 @@ namespace Helium
 		//@}
 
 	private:
+		/// Thread blocked until one or more requests complete.
+		struct Waiter
+		{
+			/// Condition signaled by the loading thread to wake up the waiting thread.
+			Condition condition;
+
+			/// @name Construction/Destruction
+			//@{
+			Waiter();
+			//@}
+		};
+
 		/// Async load request data.
 		struct Request
 		{
@@ -84,20 +124,68 @@ namespace Helium
 			size_t size;
 			/// Priority.
 			EPriority priority;
+			/// Completion callback.
+			COMPLETION_FUNC pCompletionFunc;
+			/// Completion callback user data.
+			void* pCompletionData;
 
+			/// Thread waiting on this request (protected by the load worker completion lock).
+			Waiter* pWaiter;
 			/// Number of bytes read.
 			volatile size_t bytesRead;
 			/// Set to a non-zero value once this request has been processed.
 			volatile int32_t processedCounter;
 		};
 
+		/// Queued requests, in queue order for each priority.
+		struct RequestQueue
+		{
+			/// Requests for each priority.
+			DynamicArray< Request* > requests[ PRIORITY_MAX ];
+			/// Index of the oldest request for each priority.
+			size_t heads[ PRIORITY_MAX ];
+
+			/// @name Construction/Destruction
+			//@{
+			RequestQueue();
+			//@}
+		};
+
+		/// File kept open by the loading thread.
+		struct OpenFile
+		{
+			/// File name.
+			String fileName;
+			/// Backend file handle.
+			uintptr_t handle;
+			/// Tick at which the file was last used.
+			uint64_t lastUseTick;
+			/// Number of reads in flight against the file.
+			uint32_t readCount;
+		};
+
+		/// Read covering one or more requests for adjacent ranges of the same file.
+		struct ReadOperation
+		{
+			/// Backend read operation.
+			AsyncReadOperation read;
+			/// Requests covered by the read, in file order.
+			Request* requests[ AsyncReadOperation::BUFFER_COUNT_MAX ];
+			/// Number of requests covered by the read.
+			size_t requestCount;
+			/// Index of the open file being read.
+			size_t openFileIndex;
+			/// Highest priority of the requests covered by the read.
+			EPriority priority;
+		};
+
 		/// Async loading thread runnable.
 		class LoadWorker : public Runnable
 		{
 		public:
 			/// @name Construction/Destruction
 			//@{
-			LoadWorker();
+			explicit LoadWorker( AsyncLoaderBackend* pBackend );
 			virtual ~LoadWorker();
 			//@}
 
@@ -114,6 +202,10 @@ namespace Helium
 			/// @name External Request Queue Control
 			//@{
 			void QueueRequest( Request* pRequest );
+			size_t WaitForRequests( Request* const* ppRequests, size_t requestCount, bool bWaitAll, uint32_t timeoutMs );
+			uint32_t GetProgressCount() const;
+			bool WaitForProgress( uint32_t progressCount, uint32_t timeoutMs );
+			void NotifyProgress();
 			void Flush();
 
 			void Lock();
@@ -121,18 +213,63 @@ namespace Helium
 			//@}
 
 		private:
+			/// Result of trying to acquire an open file.
+			enum EAcquireResult
+			{
+				ACQUIRE_SUCCESS,
+				ACQUIRE_BUSY,
+				ACQUIRE_FAILED
+			};
+
 			/// Async load request queue.
-			Locker< DynamicArray< Request* >, SpinLock > m_requestQueue;
+			Locker< RequestQueue, SpinLock > m_requestQueue;
 			/// Condition used to wake up the worker thread when load requests are queued (or when it should shut down).
 			Condition m_wakeUpCondition;
 
+			/// Lock held while marking requests as processed and while registering threads waiting on them.
+			SpinLock m_completionLock;
+			/// Threads waiting for any request to complete (or for progress to be reported through NotifyProgress()).
+			DynamicArray< Waiter* > m_progressWaiters;
+			/// Number of times progress waiters have been woken up (updated while holding the completion lock).
+			volatile uint32_t m_progressCount;
+			/// Condition signaled once open files have been closed for an exclusive write lock.
+			Condition m_closeFilesCondition;
+
 			/// Read-write lock used for synchronization of external file writes.
 			ReadWriteLock m_writeLock;
 
+			/// Backend used for file access.
+			AsyncLoaderBackend* m_pBackend;
+			/// Read operation pool.
+			ObjectPool< ReadOperation > m_readOperationPool;
+			/// Reads built from queued requests but not yet submitted, highest priority first.
+			DynamicArray< ReadOperation* > m_readyOperations;
+			/// Number of reads submitted to the backend that have not yet been completed.
+			size_t m_inFlightCount;
+
+			/// Files kept open between requests.
+			DynamicArray< OpenFile > m_openFiles;
+			/// Counter used for tracking when each open file was last used.
+			uint64_t m_openFileTick;
+
 			/// Non-zero if this thread should stop when next possible, zero if it should continue.
 			volatile int32_t m_stopCounter;
-			/// Non-zero if this thread is currently processing a load request.
-			volatile int32_t m_processingCounter;
+			/// Number of requests queued that have not yet been processed.
+			volatile int32_t m_pendingRequestCount;
+			/// Non-zero if all open files should be closed once no reads are in flight.
+			volatile int32_t m_closeFilesCounter;
+
+			/// @name Private Utility Functions
+			//@{
+			bool DispatchRequests();
+			void SubmitReadOperations();
+			void CompleteReadOperation( ReadOperation* pOperation, size_t bytesRead );
+
+			EAcquireResult AcquireOpenFile( const String& rFileName, size_t& rIndex );
+			void CloseOpenFiles();
+
+			static uint32_t GetRemainingTimeout( uint32_t timeoutMs, uint64_t startTickCount );
+			//@}
 		};
 
 		/// Pool of async load request objects.
@@ -142,6 +279,8 @@ namespace Helium
 		RunnableThread* m_pThread;
 		/// Async loading thread worker.
 		LoadWorker* m_pWorker;
+		/// File I/O backend.
+		AsyncLoaderBackend* m_pBackend;
 
 		/// Singleton instance.
 		static AsyncLoader* sm_pInstance;
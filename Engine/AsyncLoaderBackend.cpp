@@ -0,0 +1,821 @@
+#include "EnginePch.h"
+#include "Engine/AsyncLoaderBackend.h"
+
+#include "Platform/Atomic.h"
+#include "Platform/Condition.h"
+#include "Platform/Locks.h"
+#include "Platform/Thread.h"
+#include "Foundation/DynamicArray.h"
+#include "Foundation/FileStream.h"
+
+#if !HELIUM_OS_WIN
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
+
+#if HELIUM_OS_LINUX && defined( __has_include )
+#if __has_include( <linux/io_uring.h> )
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined( __NR_io_uring_setup ) && defined( __NR_io_uring_enter ) && defined( __NR_io_uring_register )
+#define HELIUM_ASYNC_LOADER_IO_URING 1
+#endif
+#endif
+#endif
+
+#ifndef HELIUM_ASYNC_LOADER_IO_URING
+#define HELIUM_ASYNC_LOADER_IO_URING 0
+#endif
+
+using namespace Helium;
+
+/// Destructor.
+AsyncLoaderBackend::~AsyncLoaderBackend()
+{
+}
+
+namespace
+{
+	/// Backend reading through FileStream objects on the async loading thread, one read at a time.
+	///
+	/// Used on platforms without positional reads, or if the other backends fail to start.
+	class StreamAsyncLoaderBackend : public AsyncLoaderBackend
+	{
+	public:
+		StreamAsyncLoaderBackend()
+		{
+		}
+
+		virtual uintptr_t OpenFile( const String& rFileName )
+		{
+			FileStream* pFileStream = FileStream::OpenFileStream( rFileName, FileStream::MODE_READ );
+
+			return ( pFileStream ? reinterpret_cast< uintptr_t >( pFileStream ) : Invalid< uintptr_t >() );
+		}
+
+		virtual void CloseFile( uintptr_t fileHandle )
+		{
+			delete reinterpret_cast< FileStream* >( fileHandle );
+		}
+
+		virtual size_t GetReadLimit() const
+		{
+			return 1;
+		}
+
+		virtual void Submit( AsyncReadOperation* pOperation )
+		{
+			HELIUM_ASSERT( pOperation );
+
+			FileStream* pFileStream = reinterpret_cast< FileStream* >( pOperation->fileHandle );
+			HELIUM_ASSERT( pFileStream );
+
+			pOperation->bytesRead = 0;
+
+			int64_t offset = pFileStream->Seek( static_cast< int64_t >( pOperation->offset ), SeekOrigins::Begin );
+			if( static_cast< uint64_t >( offset ) == pOperation->offset )
+			{
+				for( size_t bufferIndex = 0; bufferIndex < pOperation->bufferCount; ++bufferIndex )
+				{
+					const AsyncReadOperation::Buffer& rBuffer = pOperation->buffers[ bufferIndex ];
+					size_t bytesRead = pFileStream->Read( rBuffer.pData, 1, rBuffer.size );
+					pOperation->bytesRead += bytesRead;
+					if( bytesRead != rBuffer.size )
+					{
+						break;
+					}
+				}
+			}
+
+			m_completed.Push( pOperation );
+		}
+
+		virtual void FlushSubmissions()
+		{
+		}
+
+		virtual size_t Reap( AsyncReadOperation** ppCompleted, size_t maxCount, bool /*bWait*/ )
+		{
+			size_t count = Min( maxCount, m_completed.GetSize() );
+			for( size_t completedIndex = 0; completedIndex < count; ++completedIndex )
+			{
+				ppCompleted[ completedIndex ] = m_completed[ completedIndex ];
+			}
+
+			size_t remainingCount = m_completed.GetSize() - count;
+			for( size_t completedIndex = 0; completedIndex < remainingCount; ++completedIndex )
+			{
+				m_completed[ completedIndex ] = m_completed[ count + completedIndex ];
+			}
+
+			m_completed.Resize( remainingCount );
+
+			return count;
+		}
+
+		virtual void Interrupt()
+		{
+		}
+
+	private:
+		/// Operations completed but not yet reaped.
+		DynamicArray< AsyncReadOperation* > m_completed;
+	};
+
+#if !HELIUM_OS_WIN
+	/// Read a range of a file into a set of buffers, retrying interrupted and partial reads.
+	///
+	/// @param[in] fileDescriptor  File to read.
+	/// @param[in] pOperation      Read operation.
+	///
+	/// @return  Number of bytes read.
+	size_t ReadBuffers( int fileDescriptor, const AsyncReadOperation* pOperation )
+	{
+		size_t totalRead = 0;
+
+#if HELIUM_OS_LINUX
+		HELIUM_COMPILE_ASSERT( sizeof( AsyncReadOperation::Buffer ) == sizeof( iovec ) );
+
+		// Try to read everything with a single call first.
+		ssize_t result;
+		do
+		{
+			result = preadv(
+				fileDescriptor,
+				reinterpret_cast< const iovec* >( pOperation->buffers ),
+				static_cast< int >( pOperation->bufferCount ),
+				static_cast< off_t >( pOperation->offset ) );
+		} while( result < 0 && errno == EINTR );
+
+		if( result <= 0 )
+		{
+			return 0;
+		}
+
+		totalRead = static_cast< size_t >( result );
+#endif
+
+		// Finish off any short reads one buffer at a time.
+		size_t bufferStart = 0;
+		for( size_t bufferIndex = 0; bufferIndex < pOperation->bufferCount; ++bufferIndex )
+		{
+			const AsyncReadOperation::Buffer& rBuffer = pOperation->buffers[ bufferIndex ];
+			size_t bufferEnd = bufferStart + rBuffer.size;
+
+			while( totalRead < bufferEnd )
+			{
+				size_t bufferOffset = totalRead - bufferStart;
+				ssize_t readResult = pread(
+					fileDescriptor,
+					static_cast< uint8_t* >( rBuffer.pData ) + bufferOffset,
+					rBuffer.size - bufferOffset,
+					static_cast< off_t >( pOperation->offset + totalRead ) );
+				if( readResult < 0 && errno == EINTR )
+				{
+					continue;
+				}
+
+				if( readResult <= 0 )
+				{
+					return totalRead;
+				}
+
+				totalRead += static_cast< size_t >( readResult );
+			}
+
+			bufferStart = bufferEnd;
+		}
+
+		return totalRead;
+	}
+
+	/// Open a file for reading using a POSIX file descriptor.
+	///
+	/// @param[in] rFileName  File name.
+	///
+	/// @return  File descriptor, or an invalid value if the file could not be opened.
+	uintptr_t OpenFileDescriptor( const String& rFileName )
+	{
+		int fileDescriptor;
+		do
+		{
+			fileDescriptor = open( rFileName.GetData(), O_RDONLY | O_CLOEXEC );
+		} while( fileDescriptor < 0 && errno == EINTR );
+
+		return ( fileDescriptor < 0 ? Invalid< uintptr_t >() : static_cast< uintptr_t >( fileDescriptor ) );
+	}
+
+	/// Backend issuing blocking positional reads from a pool of threads.
+	class PreadAsyncLoaderBackend : public AsyncLoaderBackend
+	{
+	public:
+		/// Number of reading threads.
+		static const size_t THREAD_COUNT = 8;
+
+		explicit PreadAsyncLoaderBackend( size_t readLimit )
+			: m_readLimit( readLimit )
+			, m_workCondition( false, false )
+			, m_completionCondition( false, false )
+			, m_queueHead( 0 )
+			, m_stopCounter( 0 )
+		{
+		}
+
+		virtual ~PreadAsyncLoaderBackend()
+		{
+			AtomicExchangeRelease( m_stopCounter, 1 );
+			m_workCondition.Signal();
+
+			for( size_t threadIndex = 0; threadIndex < m_threads.GetSize(); ++threadIndex )
+			{
+				m_threads[ threadIndex ]->Join();
+				delete m_threads[ threadIndex ];
+				delete m_readers[ threadIndex ];
+			}
+		}
+
+		bool Start()
+		{
+			for( size_t threadIndex = 0; threadIndex < THREAD_COUNT; ++threadIndex )
+			{
+				Reader* pReader = new Reader( this );
+				HELIUM_ASSERT( pReader );
+
+				RunnableThread* pThread = new RunnableThread( pReader );
+				HELIUM_ASSERT( pThread );
+				if( !pThread->Start( TXT( "AsyncLoader - file reading" ) ) )
+				{
+					delete pThread;
+					delete pReader;
+
+					break;
+				}
+
+				m_readers.Push( pReader );
+				m_threads.Push( pThread );
+			}
+
+			return !m_threads.IsEmpty();
+		}
+
+		virtual uintptr_t OpenFile( const String& rFileName )
+		{
+			return OpenFileDescriptor( rFileName );
+		}
+
+		virtual void CloseFile( uintptr_t fileHandle )
+		{
+			close( static_cast< int >( fileHandle ) );
+		}
+
+		virtual size_t GetReadLimit() const
+		{
+			return m_readLimit;
+		}
+
+		virtual void Submit( AsyncReadOperation* pOperation )
+		{
+			HELIUM_ASSERT( pOperation );
+
+			m_queueLock.Lock();
+			m_queue.Push( pOperation );
+			m_queueLock.Unlock();
+		}
+
+		virtual void FlushSubmissions()
+		{
+			m_workCondition.Signal();
+		}
+
+		virtual size_t Reap( AsyncReadOperation** ppCompleted, size_t maxCount, bool bWait )
+		{
+			size_t count = TakeCompleted( ppCompleted, maxCount );
+			if( count == 0 && bWait )
+			{
+				m_completionCondition.Wait();
+				count = TakeCompleted( ppCompleted, maxCount );
+			}
+
+			return count;
+		}
+
+		virtual void Interrupt()
+		{
+			m_completionCondition.Signal();
+		}
+
+	private:
+		/// Reading thread runnable.
+		class Reader : public Runnable
+		{
+		public:
+			explicit Reader( PreadAsyncLoaderBackend* pBackend )
+				: m_pBackend( pBackend )
+			{
+			}
+
+			virtual void Run()
+			{
+				m_pBackend->ReaderRun();
+			}
+
+		private:
+			/// Owning backend.
+			PreadAsyncLoaderBackend* m_pBackend;
+		};
+
+		/// Maximum number of reads in flight.
+		size_t m_readLimit;
+
+		/// Reading threads.
+		DynamicArray< RunnableThread* > m_threads;
+		/// Reading thread runnables.
+		DynamicArray< Reader* > m_readers;
+
+		/// Condition used to wake up reading threads when reads are submitted (or when they should shut down).
+		Condition m_workCondition;
+		/// Condition signaled when reads complete (or when the loading thread is interrupted).
+		Condition m_completionCondition;
+
+		/// Submitted reads.
+		DynamicArray< AsyncReadOperation* > m_queue;
+		/// Index of the oldest submitted read in the queue.
+		size_t m_queueHead;
+		/// Submitted read queue lock.
+		SpinLock m_queueLock;
+
+		/// Completed reads.
+		DynamicArray< AsyncReadOperation* > m_completed;
+		/// Completed read list lock.
+		SpinLock m_completedLock;
+
+		/// Non-zero if the reading threads should stop.
+		volatile int32_t m_stopCounter;
+
+		/// Reading thread loop.
+		void ReaderRun()
+		{
+			while( m_stopCounter == 0 )
+			{
+				AsyncReadOperation* pOperation = NULL;
+				bool bMoreQueued = false;
+
+				m_queueLock.Lock();
+				if( m_queueHead < m_queue.GetSize() )
+				{
+					pOperation = m_queue[ m_queueHead++ ];
+					if( m_queueHead == m_queue.GetSize() )
+					{
+						m_queue.Resize( 0 );
+						m_queueHead = 0;
+					}
+
+					bMoreQueued = ( m_queueHead < m_queue.GetSize() );
+				}
+				m_queueLock.Unlock();
+
+				if( !pOperation )
+				{
+					m_workCondition.Wait();
+
+					continue;
+				}
+
+				// Pass the wake-up on so that other idle threads pick up the remaining reads.
+				if( bMoreQueued )
+				{
+					m_workCondition.Signal();
+				}
+
+				pOperation->bytesRead = ReadBuffers( static_cast< int >( pOperation->fileHandle ), pOperation );
+
+				m_completedLock.Lock();
+				m_completed.Push( pOperation );
+				m_completedLock.Unlock();
+
+				m_completionCondition.Signal();
+			}
+
+			// Pass the stop request on to the next thread.
+			m_workCondition.Signal();
+		}
+
+		/// Take completed reads off of the completed list.
+		size_t TakeCompleted( AsyncReadOperation** ppCompleted, size_t maxCount )
+		{
+			m_completedLock.Lock();
+
+			size_t count = Min( maxCount, m_completed.GetSize() );
+			size_t remainingCount = m_completed.GetSize() - count;
+			for( size_t completedIndex = 0; completedIndex < count; ++completedIndex )
+			{
+				ppCompleted[ completedIndex ] = m_completed[ remainingCount + completedIndex ];
+			}
+
+			m_completed.Resize( remainingCount );
+
+			m_completedLock.Unlock();
+
+			return count;
+		}
+	};
+#endif  // !HELIUM_OS_WIN
+
+#if HELIUM_ASYNC_LOADER_IO_URING
+	/// Backend submitting vectored reads through a Linux io_uring instance.
+	///
+	/// The ring's completion queue is tied to an eventfd so that the loading thread can wait on completions and
+	/// interrupt requests at the same time.
+	class IoUringAsyncLoaderBackend : public AsyncLoaderBackend
+	{
+	public:
+		explicit IoUringAsyncLoaderBackend( size_t readLimit )
+			: m_readLimit( readLimit )
+			, m_ringFd( -1 )
+			, m_completionEventFd( -1 )
+			, m_interruptEventFd( -1 )
+			, m_pSubmissionRing( NULL )
+			, m_submissionRingSize( 0 )
+			, m_pCompletionRing( NULL )
+			, m_completionRingSize( 0 )
+			, m_pSubmissionEntries( NULL )
+			, m_submissionEntriesSize( 0 )
+			, m_pendingSubmitCount( 0 )
+		{
+		}
+
+		virtual ~IoUringAsyncLoaderBackend()
+		{
+			if( m_pSubmissionEntries )
+			{
+				munmap( m_pSubmissionEntries, m_submissionEntriesSize );
+			}
+
+			if( m_pCompletionRing && m_pCompletionRing != m_pSubmissionRing )
+			{
+				munmap( m_pCompletionRing, m_completionRingSize );
+			}
+
+			if( m_pSubmissionRing )
+			{
+				munmap( m_pSubmissionRing, m_submissionRingSize );
+			}
+
+			if( m_ringFd >= 0 )
+			{
+				close( m_ringFd );
+			}
+
+			if( m_completionEventFd >= 0 )
+			{
+				close( m_completionEventFd );
+			}
+
+			if( m_interruptEventFd >= 0 )
+			{
+				close( m_interruptEventFd );
+			}
+		}
+
+		bool Start()
+		{
+			io_uring_params parameters;
+			MemoryZero( &parameters, sizeof( parameters ) );
+
+			m_ringFd = static_cast< int >( syscall( __NR_io_uring_setup, static_cast< unsigned >( m_readLimit ), &parameters ) );
+			if( m_ringFd < 0 )
+			{
+				return false;
+			}
+
+			m_submissionRingSize = parameters.sq_off.array + parameters.sq_entries * sizeof( uint32_t );
+			m_completionRingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof( io_uring_cqe );
+
+			bool bSingleMap = ( parameters.features & IORING_FEAT_SINGLE_MMAP ) != 0;
+			if( bSingleMap )
+			{
+				m_submissionRingSize = Max( m_submissionRingSize, m_completionRingSize );
+				m_completionRingSize = m_submissionRingSize;
+			}
+
+			m_pSubmissionRing = MapRing( m_submissionRingSize, IORING_OFF_SQ_RING );
+			if( !m_pSubmissionRing )
+			{
+				return false;
+			}
+
+			m_pCompletionRing = ( bSingleMap ? m_pSubmissionRing : MapRing( m_completionRingSize, IORING_OFF_CQ_RING ) );
+			if( !m_pCompletionRing )
+			{
+				return false;
+			}
+
+			m_submissionEntriesSize = parameters.sq_entries * sizeof( io_uring_sqe );
+			m_pSubmissionEntries = static_cast< io_uring_sqe* >( MapRing( m_submissionEntriesSize, IORING_OFF_SQES ) );
+			if( !m_pSubmissionEntries )
+			{
+				return false;
+			}
+
+			uint8_t* pSubmissionRing = static_cast< uint8_t* >( m_pSubmissionRing );
+			m_pSubmissionHead = reinterpret_cast< uint32_t* >( pSubmissionRing + parameters.sq_off.head );
+			m_pSubmissionTail = reinterpret_cast< uint32_t* >( pSubmissionRing + parameters.sq_off.tail );
+			m_submissionMask = *reinterpret_cast< uint32_t* >( pSubmissionRing + parameters.sq_off.ring_mask );
+			m_pSubmissionArray = reinterpret_cast< uint32_t* >( pSubmissionRing + parameters.sq_off.array );
+
+			uint8_t* pCompletionRing = static_cast< uint8_t* >( m_pCompletionRing );
+			m_pCompletionHead = reinterpret_cast< uint32_t* >( pCompletionRing + parameters.cq_off.head );
+			m_pCompletionTail = reinterpret_cast< uint32_t* >( pCompletionRing + parameters.cq_off.tail );
+			m_completionMask = *reinterpret_cast< uint32_t* >( pCompletionRing + parameters.cq_off.ring_mask );
+			m_pCompletionEntries = reinterpret_cast< io_uring_cqe* >( pCompletionRing + parameters.cq_off.cqes );
+
+			// Never allow more reads in flight than the completion queue can hold.
+			m_readLimit = Min( m_readLimit, static_cast< size_t >( parameters.sq_entries ) );
+
+			m_completionEventFd = eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK );
+			m_interruptEventFd = eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK );
+			if( m_completionEventFd < 0 || m_interruptEventFd < 0 )
+			{
+				return false;
+			}
+
+			if( syscall( __NR_io_uring_register, m_ringFd, IORING_REGISTER_EVENTFD, &m_completionEventFd, 1 ) < 0 )
+			{
+				return false;
+			}
+
+			return true;
+		}
+
+		virtual uintptr_t OpenFile( const String& rFileName )
+		{
+			return OpenFileDescriptor( rFileName );
+		}
+
+		virtual void CloseFile( uintptr_t fileHandle )
+		{
+			close( static_cast< int >( fileHandle ) );
+		}
+
+		virtual size_t GetReadLimit() const
+		{
+			return m_readLimit;
+		}
+
+		virtual void Submit( AsyncReadOperation* pOperation )
+		{
+			HELIUM_ASSERT( pOperation );
+
+			uint32_t tail = *m_pSubmissionTail;
+			uint32_t index = tail & m_submissionMask;
+
+			io_uring_sqe& rEntry = m_pSubmissionEntries[ index ];
+			MemoryZero( &rEntry, sizeof( rEntry ) );
+			rEntry.opcode = IORING_OP_READV;
+			rEntry.fd = static_cast< int >( pOperation->fileHandle );
+			rEntry.off = pOperation->offset;
+			rEntry.addr = reinterpret_cast< uintptr_t >( pOperation->buffers );
+			rEntry.len = static_cast< uint32_t >( pOperation->bufferCount );
+			rEntry.user_data = reinterpret_cast< uintptr_t >( pOperation );
+
+			m_pSubmissionArray[ index ] = index;
+			__atomic_store_n( m_pSubmissionTail, tail + 1, __ATOMIC_RELEASE );
+
+			++m_pendingSubmitCount;
+		}
+
+		virtual void FlushSubmissions()
+		{
+			while( m_pendingSubmitCount != 0 )
+			{
+				long result = syscall( __NR_io_uring_enter, m_ringFd, m_pendingSubmitCount, 0, 0, NULL, 0 );
+				if( result < 0 )
+				{
+					if( errno == EINTR || errno == EAGAIN || errno == EBUSY )
+					{
+						continue;
+					}
+
+					HELIUM_TRACE( TraceLevels::Error, TXT( "AsyncLoader: io_uring submission failed (errno %d).\n" ), errno );
+
+					FailPendingSubmissions();
+
+					break;
+				}
+
+				m_pendingSubmitCount -= static_cast< uint32_t >( result );
+			}
+		}
+
+		virtual size_t Reap( AsyncReadOperation** ppCompleted, size_t maxCount, bool bWait )
+		{
+			size_t count = TakeCompleted( ppCompleted, maxCount );
+			if( count == 0 && bWait )
+			{
+				pollfd pollFds[ 2 ];
+				pollFds[ 0 ].fd = m_completionEventFd;
+				pollFds[ 0 ].events = POLLIN;
+				pollFds[ 0 ].revents = 0;
+				pollFds[ 1 ].fd = m_interruptEventFd;
+				pollFds[ 1 ].events = POLLIN;
+				pollFds[ 1 ].revents = 0;
+				poll( pollFds, 2, -1 );
+
+				uint64_t eventCount;
+				while( read( m_completionEventFd, &eventCount, sizeof( eventCount ) ) > 0 )
+				{
+				}
+
+				while( read( m_interruptEventFd, &eventCount, sizeof( eventCount ) ) > 0 )
+				{
+				}
+
+				count = TakeCompleted( ppCompleted, maxCount );
+			}
+
+			return count;
+		}
+
+		virtual void Interrupt()
+		{
+			// The event is a counter, so a failed write can only mean it is already signaled.
+			uint64_t eventCount = 1;
+			while( write( m_interruptEventFd, &eventCount, sizeof( eventCount ) ) < 0 && errno == EINTR )
+			{
+			}
+		}
+
+	private:
+		/// Maximum number of reads in flight.
+		size_t m_readLimit;
+
+		/// Ring file descriptor.
+		int m_ringFd;
+		/// Event signaled by the kernel when completions are posted.
+		int m_completionEventFd;
+		/// Event used to interrupt waits for completions.
+		int m_interruptEventFd;
+
+		/// Submission queue ring mapping.
+		void* m_pSubmissionRing;
+		/// Submission queue ring mapping size.
+		size_t m_submissionRingSize;
+		/// Completion queue ring mapping (may be the same as the submission queue ring mapping).
+		void* m_pCompletionRing;
+		/// Completion queue ring mapping size.
+		size_t m_completionRingSize;
+		/// Submission queue entries.
+		io_uring_sqe* m_pSubmissionEntries;
+		/// Submission queue entry mapping size.
+		size_t m_submissionEntriesSize;
+
+		/// Submission queue head.
+		uint32_t* m_pSubmissionHead;
+		/// Submission queue tail.
+		uint32_t* m_pSubmissionTail;
+		/// Submission queue index mask.
+		uint32_t m_submissionMask;
+		/// Submission queue index array.
+		uint32_t* m_pSubmissionArray;
+		/// Completion queue head.
+		uint32_t* m_pCompletionHead;
+		/// Completion queue tail.
+		uint32_t* m_pCompletionTail;
+		/// Completion queue index mask.
+		uint32_t m_completionMask;
+		/// Completion queue entries.
+		io_uring_cqe* m_pCompletionEntries;
+
+		/// Number of entries added to the submission queue but not yet submitted.
+		uint32_t m_pendingSubmitCount;
+		/// Reads that could not be submitted, to be reported as failed completions.
+		DynamicArray< AsyncReadOperation* > m_failedOperations;
+
+		/// Map part of the ring into memory.
+		void* MapRing( size_t size, off_t offset )
+		{
+			void* pMemory = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, offset );
+
+			return ( pMemory == MAP_FAILED ? NULL : pMemory );
+		}
+
+		/// Take back all entries in the submission queue that the kernel has not consumed, and queue them up to be
+		/// reported as failed reads.  The loading thread is the only one entering the ring, so nothing can consume the
+		/// entries while this runs.
+		void FailPendingSubmissions()
+		{
+			uint32_t head = __atomic_load_n( m_pSubmissionHead, __ATOMIC_ACQUIRE );
+			uint32_t tail = *m_pSubmissionTail;
+			HELIUM_ASSERT( tail - head == m_pendingSubmitCount );
+
+			for( uint32_t position = head; position != tail; ++position )
+			{
+				const io_uring_sqe& rEntry = m_pSubmissionEntries[ m_pSubmissionArray[ position & m_submissionMask ] ];
+
+				AsyncReadOperation* pOperation = reinterpret_cast< AsyncReadOperation* >( rEntry.user_data );
+				HELIUM_ASSERT( pOperation );
+				pOperation->bytesRead = 0;
+				m_failedOperations.Push( pOperation );
+			}
+
+			__atomic_store_n( m_pSubmissionTail, head, __ATOMIC_RELEASE );
+			m_pendingSubmitCount = 0;
+		}
+
+		/// Take failed submissions and completed reads off of the completion queue.
+		size_t TakeCompleted( AsyncReadOperation** ppCompleted, size_t maxCount )
+		{
+			size_t count = 0;
+			while( count < maxCount && !m_failedOperations.IsEmpty() )
+			{
+				ppCompleted[ count++ ] = m_failedOperations.GetLast();
+				m_failedOperations.Pop();
+			}
+
+			uint32_t head = *m_pCompletionHead;
+			uint32_t tail = __atomic_load_n( m_pCompletionTail, __ATOMIC_ACQUIRE );
+
+			for( ; head != tail && count < maxCount; ++head )
+			{
+				const io_uring_cqe& rEntry = m_pCompletionEntries[ head & m_completionMask ];
+
+				AsyncReadOperation* pOperation = reinterpret_cast< AsyncReadOperation* >( rEntry.user_data );
+				HELIUM_ASSERT( pOperation );
+
+				// Finish off short reads synchronously; these only happen at the end of a file or on error.
+				if( rEntry.res < 0 )
+				{
+					pOperation->bytesRead = 0;
+				}
+				else
+				{
+					size_t totalSize = 0;
+					for( size_t bufferIndex = 0; bufferIndex < pOperation->bufferCount; ++bufferIndex )
+					{
+						totalSize += pOperation->buffers[ bufferIndex ].size;
+					}
+
+					pOperation->bytesRead = static_cast< size_t >( rEntry.res );
+					if( pOperation->bytesRead != 0 && pOperation->bytesRead < totalSize )
+					{
+						pOperation->bytesRead = ReadBuffers( static_cast< int >( pOperation->fileHandle ), pOperation );
+					}
+				}
+
+				ppCompleted[ count++ ] = pOperation;
+			}
+
+			__atomic_store_n( m_pCompletionHead, head, __ATOMIC_RELEASE );
+
+			return count;
+		}
+	};
+#endif  // HELIUM_ASYNC_LOADER_IO_URING
+}
+
+/// Create the best available backend for the current platform.
+///
+/// On Linux, an io_uring backend is used if the kernel supports it.  Otherwise, POSIX platforms fall back to a pool of
+/// threads issuing positional reads, and other platforms read through FileStream objects one request at a time.
+///
+/// @param[in] readLimit  Maximum number of reads to keep in flight at once.
+///
+/// @return  Newly created backend.
+AsyncLoaderBackend* AsyncLoaderBackend::Create( size_t readLimit )
+{
+	HELIUM_ASSERT( readLimit != 0 );
+
+#if HELIUM_ASYNC_LOADER_IO_URING
+	IoUringAsyncLoaderBackend* pIoUringBackend = new IoUringAsyncLoaderBackend( readLimit );
+	HELIUM_ASSERT( pIoUringBackend );
+	if( pIoUringBackend->Start() )
+	{
+		return pIoUringBackend;
+	}
+
+	HELIUM_TRACE( TraceLevels::Info, TXT( "AsyncLoader: io_uring not available, using pread threads.\n" ) );
+	delete pIoUringBackend;
+#endif
+
+#if !HELIUM_OS_WIN
+	PreadAsyncLoaderBackend* pPreadBackend = new PreadAsyncLoaderBackend( readLimit );
+	HELIUM_ASSERT( pPreadBackend );
+	if( pPreadBackend->Start() )
+	{
+		return pPreadBackend;
+	}
+
+	HELIUM_TRACE( TraceLevels::Warning, TXT( "AsyncLoader: Failed to start pread threads.\n" ) );
+	delete pPreadBackend;
+#endif
+
+	StreamAsyncLoaderBackend* pStreamBackend = new StreamAsyncLoaderBackend;
+	HELIUM_ASSERT( pStreamBackend );
+
+	return pStreamBackend;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Foundation/String.h"
+
+#include "Engine/Engine.h"
+
+namespace Helium
+{
+	/// Read of a contiguous range of a file, scattered across one or more output buffers.
+	struct AsyncReadOperation
+	{
+		/// Maximum number of output buffers.
+		static const size_t BUFFER_COUNT_MAX = 16;
+
+		/// Output buffer (layout-compatible with POSIX iovec).
+		struct Buffer
+		{
+			/// Buffer address.
+			void* pData;
+			/// Buffer size.
+			size_t size;
+		};
+
+		/// File to read.
+		uintptr_t fileHandle;
+		/// Byte offset within the file from which to begin reading.
+		uint64_t offset;
+		/// Output buffers, filled in order.
+		Buffer buffers[ BUFFER_COUNT_MAX ];
+		/// Number of output buffers.
+		size_t bufferCount;
+
+		/// Number of bytes read, set once the operation completes.
+		size_t bytesRead;
+		/// Caller data.
+		void* pUserData;
+	};
+
+	/// File I/O backend used by the async loader for issuing reads.
+	///
+	/// All functions are called from the async loading thread, except for Interrupt() which may be called from any
+	/// thread.
+	class AsyncLoaderBackend : NonCopyable
+	{
+	public:
+		/// @name Construction/Destruction
+		//@{
+		virtual ~AsyncLoaderBackend();
+		//@}
+
+		/// @name File Handles
+		//@{
+		virtual uintptr_t OpenFile( const String& rFileName ) = 0;
+		virtual void CloseFile( uintptr_t fileHandle ) = 0;
+		//@}
+
+		/// @name Reading
+		//@{
+		virtual size_t GetReadLimit() const = 0;
+
+		virtual void Submit( AsyncReadOperation* pOperation ) = 0;
+		virtual void FlushSubmissions() = 0;
+		virtual size_t Reap( AsyncReadOperation** ppCompleted, size_t maxCount, bool bWait ) = 0;
+
+		virtual void Interrupt() = 0;
+		//@}
+
+		/// @name Static Construction
+		//@{
+		static AsyncLoaderBackend* Create( size_t readLimit );
+		//@}
+	};
+}
@@ -5,9 +5,23 @@
 #include "Foundation/MemoryStream.h"
 #include "Foundation/StringConverter.h"
 
+#include "Platform/Thread.h"
+
 #include "Engine/Asset.h"
 #include "Engine/FileLocations.h"
 #include "Engine/AsyncLoader.h"
+#include "Engine/TaskDispatcher.h"
+
+#include <algorithm>
+#include <string.h>
+
+#if HELIUM_OS_WIN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#endif
 
 #define USE_BSON_FOR_CACHE_FORMAT 0
 #define USE_JSON_FOR_CACHE_FORMAT 1
@@ -32,8 +46,98 @@ using namespace Helium;
 static const uint32_t TOC_MAGIC = 0xcac4e70c;
 /// TOC header magic number (byte-swapped).
 static const uint32_t TOC_MAGIC_SWAPPED = 0x0ce7c4ca;
+/// Magic number marking compression information following the entries in TOCs using the original format.
+static const uint32_t TOC_COMPRESSION_MAGIC = 0xcac4e7c0;
 /// Cache format version number.
-const uint32_t Cache::sm_Version = 0;
+const uint32_t Cache::sm_Version = 2;
+
+/// Maximum number of seeds to try when placing a bucket of keys in the compact TOC perfect hash.
+static const uint32_t COMPACT_TOC_SEED_LIMIT = 1 << 24;
+
+/// Hash a compact TOC key for the perfect hash.
+///
+/// Seed zero selects the displacement bucket for the key, and each non-zero seed gives an alternative record slot.
+///
+/// @param[in] pathHash      Stable path hash.
+/// @param[in] subDataIndex  Sub-data index.
+/// @param[in] seed          Hash seed.
+///
+/// @return  Hash value.
+static uint64_t HashCompactTocKey( uint64_t pathHash, uint32_t subDataIndex, uint32_t seed )
+{
+	uint64_t hash = pathHash ^
+		( static_cast< uint64_t >( subDataIndex ) * 0x9e3779b97f4a7c15ULL ) ^
+		( static_cast< uint64_t >( seed ) * 0xc2b2ae3d27d4eb4fULL );
+
+	// 64-bit finalizer from MurmurHash3.
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+namespace
+{
+	/// Order perfect hash buckets by decreasing size, so that the most constrained buckets are placed first.
+	class CompactTocBucketCompare
+	{
+	public:
+		/// Constructor.
+		///
+		/// @param[in] pBucketSizes  Number of keys in each bucket.
+		explicit CompactTocBucketCompare( const uint32_t* pBucketSizes )
+			: m_pBucketSizes( pBucketSizes )
+		{
+		}
+
+		bool operator()( uint32_t bucket0, uint32_t bucket1 ) const
+		{
+			uint32_t size0 = m_pBucketSizes[ bucket0 ];
+			uint32_t size1 = m_pBucketSizes[ bucket1 ];
+
+			return ( size0 > size1 || ( size0 == size1 && bucket0 < bucket1 ) );
+		}
+
+	private:
+		/// Number of keys in each bucket.
+		const uint32_t* m_pBucketSizes;
+	};
+
+	/// Order entries by path string, then (if entries are given) by sub-data index.
+	class CompactTocPathCompare
+	{
+	public:
+		/// Constructor.
+		///
+		/// @param[in] pPaths     Entry path strings.
+		/// @param[in] ppEntries  Entries corresponding to each path string, or null to compare by path string only.
+		explicit CompactTocPathCompare( const String* pPaths, Cache::Entry* const* ppEntries = NULL )
+			: m_pPaths( pPaths )
+			, m_ppEntries( ppEntries )
+		{
+		}
+
+		bool operator()( uint32_t entry0, uint32_t entry1 ) const
+		{
+			int result = strcmp( m_pPaths[ entry0 ].GetData(), m_pPaths[ entry1 ].GetData() );
+			if( result == 0 && m_ppEntries )
+			{
+				return ( m_ppEntries[ entry0 ]->subDataIndex < m_ppEntries[ entry1 ]->subDataIndex );
+			}
+
+			return ( result < 0 );
+		}
+
+	private:
+		/// Entry path strings.
+		const String* m_pPaths;
+		/// Entries corresponding to each path string.
+		Cache::Entry* const* m_ppEntries;
+	};
+}
 
 /// Constructor.
 Cache::Cache()
@@ -43,7 +147,15 @@ Cache::Cache()
 , m_asyncLoadId( Invalid< size_t >() )
 , m_pTocBuffer( NULL )
 , m_tocSize( Invalid< uint32_t >() )
+, m_pCompactDisplacements( NULL )
+, m_pCompactRecords( NULL )
+, m_pCompactStrings( NULL )
+, m_compactEntryCount( 0 )
+, m_compactStringBlobSize( 0 )
+, m_pCompactEntries( NULL )
 , m_pEntryPool( NULL )
+, m_uncommittedEntryCount( 0 )
+, m_entryLoadPool( ENTRY_LOAD_POOL_BLOCK_SIZE )
 {
 }
 
@@ -80,6 +192,9 @@ bool Cache::Initialize( Name name, EPlatform platform, const char* pTocFileName,
 	m_name = name;
 	m_platform = platform;
 
+	// Complete or discard any compaction that was interrupted before the cache was last shut down.
+	RecoverCompaction( String( pTocFileName ), String( pCacheFileName ) );
+
 	Status status;
 	status.Read( pTocFileName );
 	int64_t tocSize64 = status.m_Size;
@@ -110,26 +225,46 @@ bool Cache::Initialize( Name name, EPlatform platform, const char* pTocFileName,
 /// @see Initialize()
 void Cache::Shutdown()
 {
+	if( m_uncommittedEntryCount != 0 )
+	{
+		CommitToc();
+		m_uncommittedEntryCount = 0;
+	}
+
 	m_name = NULL_NAME;
 	m_platform = PLATFORM_INVALID;
 
 	m_tocFileName.Clear();
 	m_cacheFileName.Clear();
 
+	m_cacheFileMapping.Close();
+
 	if( IsValid( m_asyncLoadId ) )
 	{
 		AsyncLoader::GetStaticInstance().SyncRequest( m_asyncLoadId );
 		SetInvalid( m_asyncLoadId );
 	}
 
+	ReleaseCompactToc();
+
 	DefaultAllocator().Free( m_pTocBuffer );
 	m_pTocBuffer = NULL;
 	SetInvalid( m_tocSize );
 
 	m_bTocLoaded = false;
 
+	// Entry loads reference entries and the dictionary, so they must all be finished by now.
+#ifndef NDEBUG
+	size_t entryLoadCount = m_entryLoads.GetSize();
+	for( size_t loadIndex = 0; loadIndex < entryLoadCount; ++loadIndex )
+	{
+		HELIUM_ASSERT( !m_entryLoads.IsElementValid( loadIndex ) );
+	}
+#endif
+
 	m_entries.Clear();
 	m_entryMap.Clear();
+	m_dictionary.Clear();
 
 	delete m_pEntryPool;
 	m_pEntryPool = NULL;
@@ -171,6 +306,29 @@ bool Cache::BeginLoadToc()
 		return false;
 	}
 
+	// If the cache file is mapped, use a compact TOC in place from its own mapping instead of reading it in.
+	if( m_cacheFileMapping.IsOpen() && m_tocFileMapping.Open( m_tocFileName ) )
+	{
+		const uint8_t* pToc = m_tocFileMapping.GetData();
+		size_t tocSize = static_cast< size_t >( m_tocFileMapping.GetSize() );
+
+		CompactTocHeader header;
+		if( tocSize >= sizeof( header ) )
+		{
+			MemoryCopy( &header, pToc, sizeof( header ) );
+			if( header.magic == TOC_MAGIC &&
+				header.version == sm_Version &&
+				FinalizeCompactTocLoad( pToc, tocSize ) )
+			{
+				m_bTocLoaded = true;
+
+				return true;
+			}
+		}
+
+		m_tocFileMapping.Close();
+	}
+
 	HELIUM_ASSERT( !m_pTocBuffer );
 	DefaultAllocator allocator;
 	m_pTocBuffer = static_cast< uint8_t* >( allocator.Allocate( m_tocSize ) );
@@ -256,8 +414,12 @@ bool Cache::TryFinishLoadToc()
 
 		bool bFinalizeResult = FinalizeTocLoad();
 
-		DefaultAllocator().Free( m_pTocBuffer );
-		m_pTocBuffer = NULL;
+		// Compact TOCs are used in place, so the buffer is kept until the cache is shut down.
+		if( !m_pCompactRecords )
+		{
+			DefaultAllocator().Free( m_pTocBuffer );
+			m_pTocBuffer = NULL;
+		}
 
 		if( !bFinalizeResult )
 		{
@@ -292,14 +454,96 @@ void Cache::EnforceTocLoad()
 
 		if( BeginLoadToc() )
 		{
-			while( !TryFinishLoadToc() )
+			// Sleep until the TOC read completes rather than polling for it.
+			AsyncLoader& rLoader = AsyncLoader::GetStaticInstance();
+			while( !IsTocLoaded() && !TryFinishLoadToc() )
 			{
-				Thread::Yield();
+				rLoader.WaitForRequest( m_asyncLoadId );
 			}
 		}
 	}
 }
 
+/// Map the cache file into memory for reading entry data in place.
+///
+/// Once mapped, entry data can be accessed using GetMappedEntryData() instead of being read into separately allocated
+/// buffers.  The mapping is released when the cache is shut down.  Mapped caches are read-only, so no further entries
+/// can be cached while the file is mapped.
+///
+/// @return  True if the cache file is mapped, false if mapping failed.
+///
+/// @see IsCacheFileMapped(), GetMappedEntryData()
+bool Cache::MapCacheFile()
+{
+	if( m_cacheFileMapping.IsOpen() )
+	{
+		return true;
+	}
+
+	if( m_cacheFileName.IsEmpty() )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache::MapCacheFile(): Called without having initialized the cache.\n" ) );
+
+		return false;
+	}
+
+	if( !m_cacheFileMapping.Open( m_cacheFileName ) )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Warning,
+			TXT( "Cache::MapCacheFile(): Failed to map cache file \"%s\".\n" ),
+			*m_cacheFileName );
+
+		return false;
+	}
+
+	m_cacheFileMapping.AdviseRandomAccess();
+
+	return true;
+}
+
+/// Get the address of the data for a cache entry within the mapped cache file.
+///
+/// This is the data as stored in the cache file, so it can only be used in place if the entry is not compressed.
+///
+/// @param[in] rEntry  Cache entry.
+///
+/// @return  Entry data, or null if the cache file is not mapped or the entry lies outside the mapped file.
+///
+/// @see MapCacheFile(), AdviseEntryReadahead()
+const uint8_t* Cache::GetMappedEntryData( const Entry& rEntry ) const
+{
+	if( !m_cacheFileMapping.IsOpen() )
+	{
+		return NULL;
+	}
+
+	uint64_t mappedSize = m_cacheFileMapping.GetSize();
+	if( rEntry.offset > mappedSize || rEntry.size > mappedSize - rEntry.offset )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache::GetMappedEntryData(): Entry \"%s\" lies outside of cache file \"%s\".\n" ),
+			*rEntry.path.ToString(),
+			*m_cacheFileName );
+
+		return NULL;
+	}
+
+	return m_cacheFileMapping.GetData() + rEntry.offset;
+}
+
+/// Hint that the data for a cache entry within the mapped cache file will be read soon, allowing the system to begin
+/// paging it in before it is accessed.
+///
+/// @param[in] rEntry  Cache entry.
+///
+/// @see GetMappedEntryData()
+void Cache::AdviseEntryReadahead( const Entry& rEntry ) const
+{
+	m_cacheFileMapping.AdviseWillNeed( rEntry.offset, rEntry.size );
+}
+
 /// Search for a cache entry with the given object path name.
 ///
 /// @param[in] path          Asset path.
@@ -315,7 +559,19 @@ const Cache::Entry* Cache::FindEntry( AssetPath path, uint32_t subDataIndex ) co
 	EntryMapType::ConstAccessor mapAccessor;
 	if( !m_entryMap.Find( mapAccessor, key ) )
 	{
-		return NULL;
+		// Entries in a compact TOC are only expanded the first time they are looked up.
+		if( !m_pCompactRecords || path.IsEmpty() )
+		{
+			return NULL;
+		}
+
+		uint32_t recordIndex = FindCompactRecord( path, subDataIndex );
+		if( IsInvalid( recordIndex ) )
+		{
+			return NULL;
+		}
+
+		return ExpandCompactRecord( recordIndex, path );
 	}
 
 	Entry* pEntry = mapAccessor->Second();
@@ -324,406 +580,2056 @@ const Cache::Entry* Cache::FindEntry( AssetPath path, uint32_t subDataIndex ) co
 	return pEntry;
 }
 
-/// Add or update an entry in the cache.
+/// Get the information for the cache entry with the specified index.
 ///
-/// @param[in] path          Asset path.
-/// @param[in] subDataIndex  Sub-data index associated with the cached data.
-/// @param[in] pData         Data to cache.
-/// @param[in] timestamp     Timestamp value to associate with the entry in the cache.
-/// @param[in] size          Number of bytes to cache.
+/// @param[in] index  Asset entry index.
 ///
-/// @return  True if the cache was updated successfully, false if not.
-bool Cache::CacheEntry(
-					   AssetPath path,
-					   uint32_t subDataIndex,
-					   const void* pData,
-					   int64_t timestamp,
-					   uint32_t size )
+/// @return  Asset entry information.
+///
+/// @see GetEntryCount()
+const Cache::Entry& Cache::GetEntry( uint32_t index ) const
 {
-	HELIUM_ASSERT( pData || size == 0 );
-
-	Status status;
-	status.Read( m_cacheFileName.GetData() );
-	int64_t cacheFileSize = status.m_Size;
-	uint64_t entryOffset = ( cacheFileSize == -1 ? 0 : static_cast< uint64_t >( cacheFileSize ) );
-
-	HELIUM_ASSERT( m_pEntryPool );
-	Entry* pEntryUpdate = m_pEntryPool->Allocate();
-	HELIUM_ASSERT( pEntryUpdate );
-	pEntryUpdate->offset = entryOffset;
-	pEntryUpdate->timestamp = timestamp;
-	pEntryUpdate->path = path;
-	pEntryUpdate->subDataIndex = subDataIndex;
-	pEntryUpdate->size = size;
-
-	uint64_t originalOffset = 0;
-	int64_t originalTimestamp = 0;
-	uint32_t originalSize = 0;
-
-	EntryKey key;
-	key.path = path;
-	key.subDataIndex = subDataIndex;
-
-	EntryMapType::Accessor entryAccessor;
-	bool bNewEntry = m_entryMap.Insert( entryAccessor, KeyValue< EntryKey, Entry* >( key, pEntryUpdate ) );
-	if( bNewEntry )
-	{
-		HELIUM_TRACE( TraceLevels::Info, TXT( "Cache: Adding \"%s\" to cache \"%s\".\n" ), *path.ToString(), *m_cacheFileName );
-
-		m_entries.Push( pEntryUpdate );
-	}
-	else
+	if( m_pCompactRecords )
 	{
-		HELIUM_TRACE( TraceLevels::Info, TXT( "Cache: Updating \"%s\" in cache \"%s\".\n" ), *path.ToString(), *m_cacheFileName );
-
-		m_pEntryPool->Release( pEntryUpdate );
-
-		pEntryUpdate = entryAccessor->Second();
-		HELIUM_ASSERT( pEntryUpdate );
+		HELIUM_ASSERT( index < m_compactEntryCount );
 
-		originalOffset = pEntryUpdate->offset;
-		originalTimestamp = pEntryUpdate->timestamp;
-		originalSize = pEntryUpdate->size;
+		// Only resolve the path the first time the record is accessed.
+		const Entry* pEntry = m_pCompactEntries[ index ];
+		if( pEntry )
+		{
+			return *pEntry;
+		}
 
-		if( originalSize < size )
+		AssetPath path;
+		const char* pPathString = GetCompactRecordPath( index );
+		if( pPathString )
 		{
-			pEntryUpdate->offset = entryOffset;
+			path.Set( pPathString );
 		}
 		else
 		{
-			entryOffset = originalOffset;
+			HELIUM_TRACE(
+				TraceLevels::Error,
+				TXT( "Cache::GetEntry(): Invalid path string for entry %" ) PRIu32 TXT( " in TOC \"%s\".\n" ),
+				index,
+				*m_tocFileName );
 		}
 
-		pEntryUpdate->timestamp = timestamp;
-		pEntryUpdate->size = size;
+		pEntry = ExpandCompactRecord( index, path );
+		HELIUM_ASSERT( pEntry );
+
+		return *pEntry;
 	}
 
-	AsyncLoader& rLoader = AsyncLoader::GetStaticInstance();
+	HELIUM_ASSERT( index < m_entries.GetSize() );
 
-	rLoader.Lock();
+	Entry* pEntry = m_entries[ index ];
+	HELIUM_ASSERT( pEntry );
 
-	bool bCacheSuccess = true;
+	return *pEntry;
+}
 
-	FileStream* pCacheStream = FileStream::OpenFileStream( m_cacheFileName, FileStream::MODE_WRITE, false );
-	if( !pCacheStream )
+/// Begin asynchronous loading of the data for a cache entry.
+///
+/// Compressed entries are read into a separate buffer and decompressed once read.  If a task dispatch function is
+/// installed (see TaskDispatcher::SetDispatchFunction()), decompression is started as soon as the read completes, on
+/// whichever thread the dispatch function runs it; otherwise, it is performed when the load is finished.
+///
+/// @param[in] rEntry                Entry to load.
+/// @param[in] pBuffer               Buffer in which to store the entry data.  This must be at least as large as the
+///                                  entry's uncompressed size (or loadSizeMax, if smaller).
+/// @param[in] loadSizeMax           Maximum number of bytes to load.
+/// @param[in] bWriteCombinedBuffer  True if the buffer may be in write-combined memory (such as a locked graphics
+///                                  buffer), in which case data is only ever copied into it sequentially.
+///
+/// @return  ID associated with the load request, or an invalid index if the load could not be started.
+///
+/// @see TryFinishLoadEntry(), SyncLoadEntry(), ReadEntry()
+size_t Cache::BeginLoadEntry( const Entry& rEntry, void* pBuffer, size_t loadSizeMax, bool bWriteCombinedBuffer )
+{
+	HELIUM_ASSERT( pBuffer );
+
+	if( rEntry.codec >= static_cast< uint32_t >( CacheCompression::CODEC_MAX ) )
 	{
-		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Failed to open cache \"%s\" for writing.\n" ), *m_cacheFileName );
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache::BeginLoadEntry(): Entry \"%s\" in cache \"%s\" uses an unknown codec (%" ) PRIu32 TXT( ").\n" ),
+			*rEntry.path.ToString(),
+			*m_name,
+			rEntry.codec );
 
-		bCacheSuccess = false;
+		return Invalid< size_t >();
+	}
+
+	m_entryLoadLock.Lock();
+	EntryLoad* pLoad = m_entryLoadPool.Allocate();
+	m_entryLoadLock.Unlock();
+	HELIUM_ASSERT( pLoad );
+
+	pLoad->pCache = this;
+	pLoad->pBuffer = pBuffer;
+	pLoad->loadSize = Min< size_t >( rEntry.uncompressedSize, loadSizeMax );
+	pLoad->pCompressedData = NULL;
+	pLoad->pCompressedBuffer = NULL;
+	pLoad->pDecompressedBuffer = NULL;
+	pLoad->compressedSize = rEntry.size;
+	pLoad->uncompressedSize = rEntry.uncompressedSize;
+	pLoad->codec = static_cast< CacheCompression::ECodec >( rEntry.codec );
+	SetInvalid( pLoad->asyncLoadId );
+	pLoad->bytesRead = 0;
+	pLoad->bDecompressSuccess = false;
+	pLoad->decompressDispatchCounter = 0;
+	pLoad->decompressFinishCounter = 0;
+
+	const uint8_t* pMappedData = GetMappedEntryData( rEntry );
+	AsyncLoader& rAsyncLoader = AsyncLoader::GetStaticInstance();
+
+	if( pLoad->codec == CacheCompression::CODEC_NONE )
+	{
+		if( pMappedData )
+		{
+			MemoryCopy( pBuffer, pMappedData, pLoad->loadSize );
+			pLoad->bytesRead = pLoad->loadSize;
+		}
+		else
+		{
+			pLoad->asyncLoadId = rAsyncLoader.QueueRequest(
+				pBuffer,
+				m_cacheFileName,
+				rEntry.offset,
+				pLoad->loadSize );
+			HELIUM_ASSERT( IsValid( pLoad->asyncLoadId ) );
+		}
 	}
 	else
 	{
-		HELIUM_TRACE(
-			TraceLevels::Info,
-			TXT( "Cache: Caching \"%s\" to \"%s\" (%" ) PRIu32 TXT( " bytes @ offset %" ) PRIu64 TXT( ").\n" ),
-			*path.ToString(),
-			*m_cacheFileName,
-			size,
-			entryOffset );
+		// Decompress into a separate buffer if only part of the data is wanted, or if the decompressor would need to
+		// read back from write-combined memory.
+		if( pLoad->loadSize < pLoad->uncompressedSize || bWriteCombinedBuffer )
+		{
+			pLoad->pDecompressedBuffer = static_cast< uint8_t* >(
+				DefaultAllocator().Allocate( pLoad->uncompressedSize ) );
+			HELIUM_ASSERT( pLoad->pDecompressedBuffer );
+		}
 
-		uint64_t seekOffset = static_cast< uint64_t >( pCacheStream->Seek(
-			static_cast< int64_t >( entryOffset ),
-			SeekOrigins::Begin ) );
-		if( seekOffset != entryOffset )
+		if( pMappedData )
 		{
-			HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Cache file offset seek failed.\n" ) );
+			pLoad->pCompressedData = pMappedData;
+			pLoad->bytesRead = pLoad->compressedSize;
+			AdviseEntryReadahead( rEntry );
 
-			if( bNewEntry )
-			{
-				m_entries.Pop();
-				m_entryMap.Remove( entryAccessor );
-				m_pEntryPool->Release( pEntryUpdate );
-			}
-			else
+			if( TaskDispatcher::HasDispatchFunction() )
 			{
-				pEntryUpdate->offset = originalOffset;
-				pEntryUpdate->timestamp = originalTimestamp;
-				pEntryUpdate->size = originalSize;
+				pLoad->decompressDispatchCounter = 1;
+				TaskDispatcher::Dispatch( DecompressEntryLoad, pLoad );
 			}
-
-			bCacheSuccess = false;
 		}
 		else
 		{
-			size_t writeSize = pCacheStream->Write( pData, 1, size );
-			if( writeSize != size )
-			{
-				HELIUM_TRACE(
-					TraceLevels::Error,
-					( TXT( "Cache: Failed to write %" ) PRIu32 TXT( " bytes to cache \"%s\" (%" ) PRIuSZ
-					TXT( " bytes written).\n" ) ),
-					size,
-					*m_cacheFileName,
-					writeSize );
-
-				if( bNewEntry )
-				{
-					m_entries.Pop();
-					m_entryMap.Remove( entryAccessor );
-					m_pEntryPool->Release( pEntryUpdate );
-				}
-				else
-				{
-					pEntryUpdate->offset = originalOffset;
-					pEntryUpdate->timestamp = originalTimestamp;
-					pEntryUpdate->size = originalSize;
-				}
-
-				bCacheSuccess = false;
-			}
-			else
-			{
-				HELIUM_TRACE( TraceLevels::Info, TXT( "Cache: Rewriting TOC file \"%s\".\n" ), *m_tocFileName );
-
-				FileStream* pTocStream = FileStream::OpenFileStream( m_tocFileName, FileStream::MODE_WRITE, true );
-				if( !pTocStream )
-				{
-					HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Failed to open TOC \"%s\" for writing.\n" ), *m_tocFileName );
-				}
-				else
-				{
-					BufferedStream* pBufferedStream = new BufferedStream( pTocStream );
-					HELIUM_ASSERT( pBufferedStream );
-
-					pBufferedStream->Write( &TOC_MAGIC, sizeof( TOC_MAGIC ), 1 );
-					pBufferedStream->Write( &sm_Version, sizeof( sm_Version ), 1 );
-
-					uint32_t entryCount = static_cast< uint32_t >( m_entries.GetSize() );
-					pBufferedStream->Write( &entryCount, sizeof( entryCount ), 1 );
-
-					String entryPath;
-					uint_fast32_t entryCountFast = entryCount;
-					for( uint_fast32_t entryIndex = 0; entryIndex < entryCountFast; ++entryIndex )
-					{
-						Entry* pEntry = m_entries[ entryIndex ];
-						HELIUM_ASSERT( pEntry );
-
-						pEntry->path.ToString( entryPath );
-						HELIUM_ASSERT( entryPath.GetSize() < UINT16_MAX );
-						uint16_t pathSize = static_cast< uint16_t >( entryPath.GetSize() );
-						pBufferedStream->Write( &pathSize, sizeof( pathSize ), 1 );
-
-						pBufferedStream->Write( *entryPath, sizeof( char ), pathSize );
-
-						pBufferedStream->Write( &pEntry->subDataIndex, sizeof( pEntry->subDataIndex ), 1 );
-
-						pBufferedStream->Write( &pEntry->offset, sizeof( pEntry->offset ), 1 );
-						pBufferedStream->Write( &pEntry->timestamp, sizeof( pEntry->timestamp ), 1 );
-						pBufferedStream->Write( &pEntry->size, sizeof( pEntry->size ), 1 );
-					}
-
-					delete pBufferedStream;
-					delete pTocStream;
-				}
-			}
+			pLoad->pCompressedBuffer = static_cast< uint8_t* >( DefaultAllocator().Allocate( pLoad->compressedSize ) );
+			HELIUM_ASSERT( pLoad->pCompressedBuffer );
+			pLoad->pCompressedData = pLoad->pCompressedBuffer;
+
+			pLoad->asyncLoadId = rAsyncLoader.QueueRequest(
+				pLoad->pCompressedBuffer,
+				m_cacheFileName,
+				rEntry.offset,
+				pLoad->compressedSize,
+				AsyncLoader::PRIORITY_NORMAL,
+				OnEntryReadComplete,
+				pLoad );
+			HELIUM_ASSERT( IsValid( pLoad->asyncLoadId ) );
 		}
-
-		delete pCacheStream;
 	}
 
-	rLoader.Unlock();
+	m_entryLoadLock.Lock();
+	size_t loadId = m_entryLoads.Add( pLoad );
+	m_entryLoadLock.Unlock();
 
-	return bCacheSuccess;
+	return loadId;
 }
 
-/// Finalize the TOC loading process.
+/// Test for completion of an entry load in a non-blocking fashion, finishing the load if it has completed.
 ///
-/// Note that this does not free any resources on a failed load (the caller is responsible for such clean-up work).
+/// @param[in]  loadId        ID associated with the load request.
+/// @param[out] rBytesLoaded  Number of bytes stored in the output buffer if the load completed successfully, or an
+///                           invalid index if it failed.
 ///
-/// @return  True if the TOC load was successful, false if not.
-bool Cache::FinalizeTocLoad()
+/// @return  True if the load has completed and its ID has been released, false if it is still in progress.
+///
+/// @see BeginLoadEntry(), SyncLoadEntry()
+bool Cache::TryFinishLoadEntry( size_t loadId, size_t& rBytesLoaded )
 {
-	HELIUM_ASSERT( m_pTocBuffer );
+	m_entryLoadLock.Lock();
+	HELIUM_ASSERT( m_entryLoads.IsElementValid( loadId ) );
+	EntryLoad* pLoad = m_entryLoads[ loadId ];
+	m_entryLoadLock.Unlock();
+	HELIUM_ASSERT( pLoad );
 
-	const uint8_t* pTocCurrent = m_pTocBuffer;
-	const uint8_t* pTocMax = pTocCurrent + m_tocSize;
+	if( IsValid( pLoad->asyncLoadId ) )
+	{
+		size_t bytesRead = 0;
+		if( !AsyncLoader::GetStaticInstance().TrySyncRequest( pLoad->asyncLoadId, bytesRead ) )
+		{
+			return false;
+		}
 
-	StackMemoryHeap<>& rStackHeap = ThreadLocalStackAllocator::GetMemoryHeap();
+		SetInvalid( pLoad->asyncLoadId );
 
-	// Validate the TOC header.
-	uint32_t magic;
-	if( !CheckedTocRead( MemoryCopy, magic, TXT( "the header magic" ), pTocCurrent, pTocMax ) )
+		// Reads of compressed data have already recorded their size in OnEntryReadComplete(), which may have dispatched
+		// decompression that is reading it right now, so only uncompressed loads take the size from here.
+		if( pLoad->codec == CacheCompression::CODEC_NONE )
+		{
+			pLoad->bytesRead = bytesRead;
+		}
+	}
+
+	if( pLoad->codec == CacheCompression::CODEC_NONE )
+	{
+		rBytesLoaded = pLoad->bytesRead;
+	}
+	else
+	{
+		// Decompress here if decompression was not dispatched when the read completed.
+		if( pLoad->decompressDispatchCounter == 0 )
+		{
+			DecompressEntryLoad( pLoad );
+		}
+		else if( pLoad->decompressFinishCounter == 0 )
+		{
+			return false;
+		}
+
+		if( pLoad->bDecompressSuccess )
+		{
+			if( pLoad->pDecompressedBuffer )
+			{
+				MemoryCopy( pLoad->pBuffer, pLoad->pDecompressedBuffer, pLoad->loadSize );
+			}
+
+			rBytesLoaded = pLoad->loadSize;
+		}
+		else
+		{
+			SetInvalid( rBytesLoaded );
+		}
+	}
+
+	ReleaseEntryLoad( loadId, pLoad );
+
+	return true;
+}
+
+/// Block until an entry load has completed, finishing the load.
+///
+/// @param[in] loadId  ID associated with the load request.
+///
+/// @return  Number of bytes stored in the output buffer if successful, or an invalid index if the load failed.
+///
+/// @see BeginLoadEntry(), TryFinishLoadEntry()
+size_t Cache::SyncLoadEntry( size_t loadId )
+{
+	m_entryLoadLock.Lock();
+	HELIUM_ASSERT( m_entryLoads.IsElementValid( loadId ) );
+	EntryLoad* pLoad = m_entryLoads[ loadId ];
+	m_entryLoadLock.Unlock();
+	HELIUM_ASSERT( pLoad );
+
+	AsyncLoader& rAsyncLoader = AsyncLoader::GetStaticInstance();
+	if( IsValid( pLoad->asyncLoadId ) )
+	{
+		rAsyncLoader.WaitForRequest( pLoad->asyncLoadId );
+	}
+
+	// Dispatched decompression reports progress to the async loader once it finishes, so sleep until then.
+	size_t bytesLoaded;
+	for( ; ; )
+	{
+		uint32_t progressCount = rAsyncLoader.GetProgressCount();
+		if( TryFinishLoadEntry( loadId, bytesLoaded ) )
+		{
+			break;
+		}
+
+		if( TaskDispatcher::TryRunPendingTask() )
+		{
+			continue;
+		}
+
+		rAsyncLoader.WaitForProgress( progressCount, SYNC_LOAD_WAIT_INTERVAL );
+	}
+
+	return bytesLoaded;
+}
+
+/// Read and decompress the data for a cache entry immediately.
+///
+/// @param[in]  rEntry  Entry to read.
+/// @param[out] rData   Entry data.
+///
+/// @return  True if successful, false if not.
+///
+/// @see BeginLoadEntry()
+bool Cache::ReadEntry( const Entry& rEntry, DynamicArray< uint8_t >& rData ) const
+{
+	const uint8_t* pMappedData = GetMappedEntryData( rEntry );
+	if( pMappedData )
+	{
+		return DecompressEntryData( rEntry, pMappedData, rData );
+	}
+
+	FileStream* pStream = FileStream::OpenFileStream( m_cacheFileName, FileStream::MODE_READ );
+	if( !pStream )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache::ReadEntry(): Failed to open cache \"%s\".\n" ), *m_cacheFileName );
+
+		return false;
+	}
+
+	DynamicArray< uint8_t > storedData;
+	bool bReadResult = ReadStoredEntryData( *pStream, rEntry, storedData );
+	delete pStream;
+
+	if( !bReadResult )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache::ReadEntry(): Failed to read \"%s\" from cache \"%s\".\n" ),
+			*rEntry.path.ToString(),
+			*m_cacheFileName );
+
+		return false;
+	}
+
+	if( rEntry.codec == CacheCompression::CODEC_NONE )
+	{
+		rData.Swap( storedData );
+
+		return true;
+	}
+
+	return DecompressEntryData( rEntry, storedData.GetData(), rData );
+}
+
+/// Add or update an entry in the cache.
+///
+/// @param[in] path          Asset path.
+/// @param[in] subDataIndex  Sub-data index associated with the cached data.
+/// @param[in] pData         Data to cache.
+/// @param[in] timestamp     Timestamp value to associate with the entry in the cache.
+/// @param[in] size          Number of bytes to cache.
+/// @param[in] codec         Codec with which to compress the data.  Data that does not compress is stored uncompressed
+///                          regardless.
+///
+/// @return  True if the cache was updated successfully, false if not.
+bool Cache::CacheEntry(
+					   AssetPath path,
+					   uint32_t subDataIndex,
+					   const void* pData,
+					   int64_t timestamp,
+					   uint32_t size,
+					   CacheCompression::ECodec codec )
+{
+	HELIUM_ASSERT( pData || size == 0 );
+
+	HELIUM_ASSERT( !m_cacheFileMapping.IsOpen() );
+	if( m_cacheFileMapping.IsOpen() )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache::CacheEntry(): Cannot cache \"%s\" in memory-mapped cache \"%s\".\n" ),
+			*path.ToString(),
+			*m_name );
+
+		return false;
+	}
+
+	// Modifying the cache requires the full set of entries, which compact TOCs only expand on demand.
+	if( m_pCompactRecords && !ExpandCompactToc() )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache::CacheEntry(): Failed to expand the TOC for cache \"%s\".\n" ),
+			*m_name );
+
+		return false;
+	}
+
+	// Compress the data, falling back to storing it uncompressed if it does not get any smaller.
+	DynamicArray< uint8_t > compressedData;
+	const void* pStoredData = pData;
+	uint32_t storedSize = size;
+	if( codec != CacheCompression::CODEC_NONE )
+	{
+		bool bCompressResult = CacheCompression::Compress(
+			codec,
+			pData,
+			size,
+			compressedData,
+			m_dictionary.GetData(),
+			m_dictionary.GetSize() );
+		if( bCompressResult && compressedData.GetSize() < size )
+		{
+			pStoredData = compressedData.GetData();
+			storedSize = static_cast< uint32_t >( compressedData.GetSize() );
+		}
+		else
+		{
+			codec = CacheCompression::CODEC_NONE;
+		}
+	}
+
+	Status status;
+	status.Read( m_cacheFileName.GetData() );
+	int64_t cacheFileSize = status.m_Size;
+	uint64_t entryOffset = ( cacheFileSize == -1 ? 0 : static_cast< uint64_t >( cacheFileSize ) );
+
+	AsyncLoader& rLoader = AsyncLoader::GetStaticInstance();
+
+	rLoader.Lock();
+
+	// Entry data is always appended, so data referenced by the last committed TOC is never overwritten.  Superseded
+	// data is left in place until the cache is compacted.
+	bool bCacheSuccess = false;
+
+	FileStream* pCacheStream = FileStream::OpenFileStream( m_cacheFileName, FileStream::MODE_WRITE, false );
+	if( !pCacheStream )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Failed to open cache \"%s\" for writing.\n" ), *m_cacheFileName );
+	}
+	else
+	{
+		HELIUM_TRACE(
+			TraceLevels::Info,
+			( TXT( "Cache: Caching \"%s\" to \"%s\" (%" ) PRIu32 TXT( " bytes, %" ) PRIu32 TXT( " stored @ offset %" )
+			PRIu64 TXT( ").\n" ) ),
+			*path.ToString(),
+			*m_cacheFileName,
+			size,
+			storedSize,
+			entryOffset );
+
+		uint64_t seekOffset = static_cast< uint64_t >( pCacheStream->Seek(
+			static_cast< int64_t >( entryOffset ),
+			SeekOrigins::Begin ) );
+		if( seekOffset != entryOffset )
+		{
+			HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Cache file offset seek failed.\n" ) );
+		}
+		else
+		{
+			size_t writeSize = pCacheStream->Write( pStoredData, 1, storedSize );
+			if( writeSize != storedSize )
+			{
+				HELIUM_TRACE(
+					TraceLevels::Error,
+					( TXT( "Cache: Failed to write %" ) PRIu32 TXT( " bytes to cache \"%s\" (%" ) PRIuSZ
+					TXT( " bytes written).\n" ) ),
+					storedSize,
+					*m_cacheFileName,
+					writeSize );
+			}
+			else
+			{
+				bCacheSuccess = true;
+			}
+		}
+
+		delete pCacheStream;
+	}
+
+	rLoader.Unlock();
+
+	if( !bCacheSuccess )
+	{
+		return false;
+	}
+
+	// Point the entry at the new data.
+	HELIUM_ASSERT( m_pEntryPool );
+	Entry* pEntryUpdate = m_pEntryPool->Allocate();
+	HELIUM_ASSERT( pEntryUpdate );
+	pEntryUpdate->offset = entryOffset;
+	pEntryUpdate->timestamp = timestamp;
+	pEntryUpdate->path = path;
+	pEntryUpdate->subDataIndex = subDataIndex;
+	pEntryUpdate->size = storedSize;
+	pEntryUpdate->uncompressedSize = size;
+	pEntryUpdate->codec = codec;
+
+	EntryKey key;
+	key.path = path;
+	key.subDataIndex = subDataIndex;
+
+	EntryMapType::Accessor entryAccessor;
+	if( m_entryMap.Insert( entryAccessor, KeyValue< EntryKey, Entry* >( key, pEntryUpdate ) ) )
+	{
+		HELIUM_TRACE( TraceLevels::Info, TXT( "Cache: Added \"%s\" to cache \"%s\".\n" ), *path.ToString(), *m_cacheFileName );
+
+		m_entries.Push( pEntryUpdate );
+	}
+	else
+	{
+		HELIUM_TRACE( TraceLevels::Info, TXT( "Cache: Updated \"%s\" in cache \"%s\".\n" ), *path.ToString(), *m_cacheFileName );
+
+		m_pEntryPool->Release( pEntryUpdate );
+
+		pEntryUpdate = entryAccessor->Second();
+		HELIUM_ASSERT( pEntryUpdate );
+		pEntryUpdate->offset = entryOffset;
+		pEntryUpdate->timestamp = timestamp;
+		pEntryUpdate->size = storedSize;
+		pEntryUpdate->uncompressedSize = size;
+		pEntryUpdate->codec = codec;
+	}
+
+	// Commit the TOC once enough entries have been written, rather than for every entry.
+	++m_uncommittedEntryCount;
+	if( m_uncommittedEntryCount >= TOC_COMMIT_BATCH_SIZE )
+	{
+		return CommitToc();
+	}
+
+	return true;
+}
+
+/// Write out the TOC if any entries have been cached since it was last written.
+///
+/// The new TOC is written to a temporary file which then replaces the existing TOC, after first making sure that all
+/// appended entry data is on disk.  If the process is interrupted at any point, the cache is left with either the
+/// previous TOC or the new one, each of which only references data that has been fully written.
+///
+/// This is called automatically once TOC_COMMIT_BATCH_SIZE entries have been cached, and when the cache is shut down.
+///
+/// @return  True if the TOC is up to date, false if writing it out failed.
+///
+/// @see CacheEntry(), Compact()
+bool Cache::CommitToc()
+{
+	if( m_uncommittedEntryCount == 0 )
+	{
+		return true;
+	}
+
+	HELIUM_TRACE(
+		TraceLevels::Info,
+		TXT( "Cache: Committing TOC file \"%s\" (%" ) PRIuSZ TXT( " new entries).\n" ),
+		*m_tocFileName,
+		m_uncommittedEntryCount );
+
+	DynamicArray< uint8_t > tocBuffer;
+	DynamicMemoryStream tocStream( &tocBuffer );
+	WriteToc( tocStream );
+
+	AsyncLoader& rLoader = AsyncLoader::GetStaticInstance();
+	rLoader.Lock();
+
+	bool bCommitSuccess = SyncFileData( m_cacheFileName ) &&
+		WriteFileAtomic( m_tocFileName, tocBuffer.GetData(), tocBuffer.GetSize() );
+
+	rLoader.Unlock();
+
+	if( !bCommitSuccess )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Failed to commit TOC file \"%s\".\n" ), *m_tocFileName );
+
+		return false;
+	}
+
+	HELIUM_ASSERT( tocBuffer.GetSize() < UINT32_MAX );
+	m_tocSize = static_cast< uint32_t >( tocBuffer.GetSize() );
+	m_uncommittedEntryCount = 0;
+
+	return true;
+}
+
+/// Rewrite the cache file without any superseded entry data, ordering entries by path so that the data for related
+/// objects is stored together.
+///
+/// This is intended to be run as an offline pass once a batch of assets has been cached.  The new cache file and TOC
+/// are first written in full to pending files alongside the current ones.  The pending TOC is written last, and its
+/// presence marks the compaction as committed: both pending files are then moved into place, and if the process is
+/// interrupted before that finishes, the next Initialize() call completes the move (see RecoverCompaction()).  An
+/// interruption before the pending TOC is written leaves the existing cache file and TOC untouched.
+///
+/// @param[in] bTrainDictionary  True to train a new compression dictionary on the data in this cache and recompress
+///                              all compressed entries with it.
+///
+/// @return  True if compaction was successful, false if not.
+///
+/// @see CacheEntry(), CommitToc()
+bool Cache::Compact( bool bTrainDictionary )
+{
+	HELIUM_ASSERT( !m_cacheFileMapping.IsOpen() );
+	if( m_cacheFileMapping.IsOpen() )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache::Compact(): Cannot compact memory-mapped cache \"%s\".\n" ), *m_name );
+
+		return false;
+	}
+
+	EnforceTocLoad();
+
+	if( m_pCompactRecords && !ExpandCompactToc() )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache::Compact(): Failed to expand the TOC for cache \"%s\".\n" ), *m_name );
+
+		return false;
+	}
+
+	size_t entryCount = m_entries.GetSize();
+
+	// Order entries by path, then by sub-data index.
+	DynamicArray< String > paths;
+	paths.Resize( entryCount );
+	DynamicArray< uint32_t > entryOrder;
+	entryOrder.Resize( entryCount );
+	for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
+	{
+		m_entries[ entryIndex ]->path.ToString( paths[ entryIndex ] );
+		entryOrder[ entryIndex ] = static_cast< uint32_t >( entryIndex );
+	}
+
+	std::sort(
+		entryOrder.GetData(),
+		entryOrder.GetData() + entryCount,
+		CompactTocPathCompare( paths.GetData(), m_entries.GetData() ) );
+
+	// Copy the live data for each entry into a pending cache file, which replaces the existing cache file once the
+	// TOC referencing it has been written.
+	String tempFileName;
+	String pendingTocFileName;
+	GetCompactionFileNames( m_tocFileName, m_cacheFileName, pendingTocFileName, tempFileName );
+
+	DynamicArray< uint64_t > newOffsets;
+	newOffsets.Resize( entryCount );
+	DynamicArray< uint32_t > newSizes;
+	newSizes.Resize( entryCount );
+	DynamicArray< uint32_t > newCodecs;
+	newCodecs.Resize( entryCount );
+	DynamicArray< uint8_t > newDictionary;
+	uint64_t newOffset = 0;
+
+	AsyncLoader& rLoader = AsyncLoader::GetStaticInstance();
+	rLoader.Lock();
+
+	bool bSuccess = false;
+
+	FileStream* pSourceStream = FileStream::OpenFileStream( m_cacheFileName, FileStream::MODE_READ );
+	FileStream* pDestStream = FileStream::OpenFileStream( tempFileName, FileStream::MODE_WRITE, true );
+	if( !pSourceStream || !pDestStream )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache::Compact(): Failed to open \"%s\" and \"%s\" for compaction.\n" ),
+			*m_cacheFileName,
+			*tempFileName );
+	}
+	else
+	{
+		bSuccess = true;
+
+		DynamicArray< uint8_t > storedData;
+		DynamicArray< uint8_t > entryData;
+
+		// Train the dictionary on a sample of the entries, spread evenly across the cache.
+		if( bTrainDictionary )
+		{
+			uint64_t totalSize = 0;
+			for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
+			{
+				totalSize += m_entries[ entryIndex ]->uncompressedSize;
+			}
+
+			// Pick every Nth entry in path order, where N is chosen such that the samples total roughly
+			// DICTIONARY_SAMPLE_SIZE_MAX bytes based on the average entry size.
+			size_t sampleStride = 1;
+			if( totalSize > CacheCompression::DICTIONARY_SAMPLE_SIZE_MAX )
+			{
+				uint64_t averageSize = Max< uint64_t >( totalSize / entryCount, 1 );
+				uint64_t sampleCount = Max< uint64_t >( CacheCompression::DICTIONARY_SAMPLE_SIZE_MAX / averageSize, 1 );
+				sampleStride = static_cast< size_t >( Max< uint64_t >( entryCount / sampleCount, 1 ) );
+			}
+
+			DynamicArray< DynamicArray< uint8_t > > samples;
+			for( size_t orderIndex = 0; orderIndex < entryCount && bSuccess; orderIndex += sampleStride )
+			{
+				const Entry& rEntry = *m_entries[ entryOrder[ orderIndex ] ];
+				bSuccess =
+					ReadStoredEntryData( *pSourceStream, rEntry, storedData ) &&
+					DecompressEntryData( rEntry, storedData.GetData(), entryData );
+				if( bSuccess )
+				{
+					samples.New( entryData );
+				}
+			}
+
+			if( bSuccess )
+			{
+				CacheCompression::TrainDictionary( samples, CacheCompression::DICTIONARY_SIZE_MAX, newDictionary );
+
+				HELIUM_TRACE(
+					TraceLevels::Info,
+					( TXT( "Cache::Compact(): Trained %" ) PRIuSZ TXT( "-byte dictionary for cache \"%s\" from %" )
+					PRIuSZ TXT( " samples.\n" ) ),
+					newDictionary.GetSize(),
+					*m_name,
+					samples.GetSize() );
+			}
+		}
+		else
+		{
+			newDictionary = m_dictionary;
+		}
+
+		DynamicArray< uint8_t > recompressedData;
+		for( size_t orderIndex = 0; orderIndex < entryCount && bSuccess; ++orderIndex )
+		{
+			uint32_t entryIndex = entryOrder[ orderIndex ];
+			const Entry& rEntry = *m_entries[ entryIndex ];
+
+			if( !ReadStoredEntryData( *pSourceStream, rEntry, storedData ) )
+			{
+				HELIUM_TRACE(
+					TraceLevels::Error,
+					TXT( "Cache::Compact(): Failed to read data for \"%s\" from cache \"%s\".\n" ),
+					*paths[ entryIndex ],
+					*m_cacheFileName );
+
+				bSuccess = false;
+
+				break;
+			}
+
+			const DynamicArray< uint8_t >* pNewData = &storedData;
+			uint32_t codec = rEntry.codec;
+
+			// Recompress entries with the new dictionary, storing them uncompressed if that no longer helps.
+			if( bTrainDictionary && codec != CacheCompression::CODEC_NONE )
+			{
+				if( !DecompressEntryData( rEntry, storedData.GetData(), entryData ) )
+				{
+					bSuccess = false;
+
+					break;
+				}
+
+				bool bCompressResult = CacheCompression::Compress(
+					static_cast< CacheCompression::ECodec >( codec ),
+					entryData.GetData(),
+					entryData.GetSize(),
+					recompressedData,
+					newDictionary.GetData(),
+					newDictionary.GetSize() );
+				if( bCompressResult && recompressedData.GetSize() < entryData.GetSize() )
+				{
+					pNewData = &recompressedData;
+				}
+				else
+				{
+					pNewData = &entryData;
+					codec = CacheCompression::CODEC_NONE;
+				}
+			}
+
+			size_t newSize = pNewData->GetSize();
+			newOffsets[ entryIndex ] = newOffset;
+			newSizes[ entryIndex ] = static_cast< uint32_t >( newSize );
+			newCodecs[ entryIndex ] = codec;
+			newOffset += newSize;
+
+			if( pDestStream->Write( pNewData->GetData(), 1, newSize ) != newSize )
+			{
+				HELIUM_TRACE(
+					TraceLevels::Error,
+					TXT( "Cache::Compact(): Failed to write data for \"%s\" to \"%s\".\n" ),
+					*paths[ entryIndex ],
+					*tempFileName );
+
+				bSuccess = false;
+			}
+		}
+	}
+
+	delete pSourceStream;
+	delete pDestStream;
+
+	bSuccess = bSuccess && SyncFileData( tempFileName );
+
+	// Switch the entries over to their compacted locations and new order (so that the TOC also follows file order),
+	// keeping the previous state around in case the new TOC cannot be written.
+	DynamicArray< Entry* > previousEntries;
+	DynamicArray< uint8_t > previousDictionary;
+	if( bSuccess )
+	{
+		for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
+		{
+			Entry* pEntry = m_entries[ entryIndex ];
+			Swap( pEntry->offset, newOffsets[ entryIndex ] );
+			Swap( pEntry->size, newSizes[ entryIndex ] );
+			Swap( pEntry->codec, newCodecs[ entryIndex ] );
+		}
+
+		previousDictionary = m_dictionary;
+		m_dictionary = newDictionary;
+
+		previousEntries = m_entries;
+		for( size_t orderIndex = 0; orderIndex < entryCount; ++orderIndex )
+		{
+			m_entries[ orderIndex ] = previousEntries[ entryOrder[ orderIndex ] ];
+		}
+
+		// Writing the pending TOC commits the compaction.
+		DynamicArray< uint8_t > tocBuffer;
+		DynamicMemoryStream tocStream( &tocBuffer );
+		WriteToc( tocStream );
+
+		bSuccess = WriteFileAtomic( pendingTocFileName, tocBuffer.GetData(), tocBuffer.GetSize() );
+		if( bSuccess )
+		{
+			HELIUM_ASSERT( tocBuffer.GetSize() < UINT32_MAX );
+			m_tocSize = static_cast< uint32_t >( tocBuffer.GetSize() );
+			m_uncommittedEntryCount = 0;
+		}
+		else
+		{
+			m_entries = previousEntries;
+			m_dictionary = previousDictionary;
+
+			for( size_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
+			{
+				Entry* pEntry = m_entries[ entryIndex ];
+				Swap( pEntry->offset, newOffsets[ entryIndex ] );
+				Swap( pEntry->size, newSizes[ entryIndex ] );
+				Swap( pEntry->codec, newCodecs[ entryIndex ] );
+			}
+		}
+	}
+
+	if( !bSuccess )
+	{
+		RemoveFile( tempFileName );
+	}
+	else if( !RecoverCompaction( m_tocFileName, m_cacheFileName ) )
+	{
+		// The compaction is committed, but the pending files could not be moved into place yet.  Loads through this
+		// cache would read the old cache file with the new TOC, so fail them until the cache is reinitialized.
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			( TXT( "Cache::Compact(): Failed to move the compacted cache \"%s\" into place; it will be moved when the " )
+			TXT( "cache is next initialized.\n" ) ),
+			*m_cacheFileName );
+
+		bSuccess = false;
+	}
+
+	rLoader.Unlock();
+
+	if( !bSuccess )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache::Compact(): Failed to compact cache \"%s\".\n" ), *m_cacheFileName );
+
+		return false;
+	}
+
+	HELIUM_TRACE(
+		TraceLevels::Info,
+		TXT( "Cache::Compact(): Compacted cache \"%s\" to %" ) PRIu64 TXT( " bytes.\n" ),
+		*m_cacheFileName,
+		newOffset );
+
+	return true;
+}
+
+/// Get the names of the pending files written by Compact() for a given cache.
+///
+/// @param[in]  rTocFileName           TOC file name.
+/// @param[in]  rCacheFileName         Cache file name.
+/// @param[out] rPendingTocFileName    Name of the pending TOC file.
+/// @param[out] rPendingCacheFileName  Name of the pending cache file.
+void Cache::GetCompactionFileNames(
+	const String& rTocFileName,
+	const String& rCacheFileName,
+	String& rPendingTocFileName,
+	String& rPendingCacheFileName )
+{
+	rPendingTocFileName = rTocFileName;
+	rPendingTocFileName += TXT( ".compact" );
+
+	rPendingCacheFileName = rCacheFileName;
+	rPendingCacheFileName += TXT( ".compact" );
+}
+
+/// Finish moving the pending files from a committed compaction into place, or discard an uncommitted one.
+///
+/// A compaction is committed once its pending TOC file exists (it is written atomically, and only after the pending
+/// cache file is complete).  The pending cache file is always moved into place before the pending TOC, so finding only
+/// the pending TOC means that the cache file has already been replaced.
+///
+/// @param[in] rTocFileName    TOC file name.
+/// @param[in] rCacheFileName  Cache file name.
+///
+/// @return  True if no compaction is left pending, false if the pending files could not be moved into place.
+///
+/// @see Compact()
+bool Cache::RecoverCompaction( const String& rTocFileName, const String& rCacheFileName )
+{
+	String pendingTocFileName;
+	String pendingCacheFileName;
+	GetCompactionFileNames( rTocFileName, rCacheFileName, pendingTocFileName, pendingCacheFileName );
+
+	Status status;
+	bool bPendingToc = status.Read( pendingTocFileName.GetData() );
+	bool bPendingCache = status.Read( pendingCacheFileName.GetData() );
+
+	if( !bPendingToc )
+	{
+		if( bPendingCache )
+		{
+			HELIUM_TRACE(
+				TraceLevels::Warning,
+				TXT( "Cache: Discarding incomplete compacted cache file \"%s\".\n" ),
+				*pendingCacheFileName );
+
+			RemoveFile( pendingCacheFileName );
+		}
+
+		return true;
+	}
+
+	HELIUM_TRACE(
+		TraceLevels::Info,
+		TXT( "Cache: Moving compacted cache \"%s\" into place.\n" ),
+		*rCacheFileName );
+
+	return ( !bPendingCache || RenameFileAtomic( pendingCacheFileName, rCacheFileName ) ) &&
+		RenameFileAtomic( pendingTocFileName, rTocFileName );
+}
+
+/// Flush any buffered writes to a file through to disk.
+///
+/// @param[in] rFileName  Name of the file to flush.
+///
+/// @return  True if successful, false if not.
+bool Cache::SyncFileData( const String& rFileName )
+{
+#if HELIUM_OS_WIN
+	HANDLE hFile = CreateFileA(
+		rFileName.GetData(),
+		GENERIC_WRITE,
+		FILE_SHARE_READ | FILE_SHARE_WRITE,
+		NULL,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		NULL );
+	if( hFile == INVALID_HANDLE_VALUE )
+	{
+		return false;
+	}
+
+	bool bResult = ( FlushFileBuffers( hFile ) != FALSE );
+	CloseHandle( hFile );
+#else
+	int fileDescriptor = open( rFileName.GetData(), O_RDONLY );
+	if( fileDescriptor < 0 )
+	{
+		return false;
+	}
+
+	bool bResult = ( fsync( fileDescriptor ) == 0 );
+	close( fileDescriptor );
+#endif
+
+	if( !bResult )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Failed to flush \"%s\" to disk.\n" ), *rFileName );
+	}
+
+	return bResult;
+}
+
+/// Replace one file with another, such that the destination file is never left partially written.
+///
+/// @param[in] rSourceFileName  Name of the file to move.
+/// @param[in] rDestFileName    Name of the file to replace.
+///
+/// @return  True if successful, false if not.
+bool Cache::RenameFileAtomic( const String& rSourceFileName, const String& rDestFileName )
+{
+#if HELIUM_OS_WIN
+	bool bResult = ( MoveFileExA(
+		rSourceFileName.GetData(),
+		rDestFileName.GetData(),
+		MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ) != FALSE );
+#else
+	bool bResult = ( rename( rSourceFileName.GetData(), rDestFileName.GetData() ) == 0 );
+#endif
+
+	if( !bResult )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache: Failed to move \"%s\" to \"%s\".\n" ),
+			*rSourceFileName,
+			*rDestFileName );
+	}
+
+	return bResult;
+}
+
+/// Delete a file, ignoring any errors.
+///
+/// @param[in] rFileName  Name of the file to delete.
+void Cache::RemoveFile( const String& rFileName )
+{
+#if HELIUM_OS_WIN
+	DeleteFileA( rFileName.GetData() );
+#else
+	unlink( rFileName.GetData() );
+#endif
+}
+
+/// Write the contents of a file by writing to a temporary file that replaces the existing file once flushed to disk.
+///
+/// @param[in] rFileName  Name of the file to write.
+/// @param[in] pData      Data to write.
+/// @param[in] size       Number of bytes to write.
+///
+/// @return  True if successful, false if not (in which case any existing file is left unchanged).
+bool Cache::WriteFileAtomic( const String& rFileName, const void* pData, size_t size )
+{
+	HELIUM_ASSERT( pData || size == 0 );
+
+	String tempFileName = rFileName;
+	tempFileName += TXT( ".tmp" );
+
+	FileStream* pStream = FileStream::OpenFileStream( tempFileName, FileStream::MODE_WRITE, true );
+	if( !pStream )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Failed to open \"%s\" for writing.\n" ), *tempFileName );
+
+		return false;
+	}
+
+	size_t writeSize = pStream->Write( pData, 1, size );
+	delete pStream;
+
+	bool bResult = ( writeSize == size && SyncFileData( tempFileName ) && RenameFileAtomic( tempFileName, rFileName ) );
+	if( !bResult )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "Cache: Failed to write \"%s\".\n" ), *rFileName );
+
+		RemoveFile( tempFileName );
+	}
+
+	return bResult;
+}
+
+/// Finalize the TOC loading process.
+///
+/// Note that this does not free any resources on a failed load (the caller is responsible for such clean-up work).
+///
+/// @return  True if the TOC load was successful, false if not.
+bool Cache::FinalizeTocLoad()
+{
+	HELIUM_ASSERT( m_pTocBuffer );
+
+	const uint8_t* pTocCurrent = m_pTocBuffer;
+	const uint8_t* pTocMax = pTocCurrent + m_tocSize;
+
+	StackMemoryHeap<>& rStackHeap = ThreadLocalStackAllocator::GetMemoryHeap();
+
+	// Validate the TOC header.
+	uint32_t magic;
+	if( !CheckedTocRead( MemoryCopy, magic, TXT( "the header magic" ), pTocCurrent, pTocMax ) )
+	{
+		return false;
+	}
+
+	LOAD_VALUE_CALLBACK* pLoadFunction = NULL;
+	if( magic == TOC_MAGIC )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Info,
+			TXT( "Cache::FinalizeTocLoad(): TOC \"%s\" identified (no byte swapping).\n" ),
+			*m_tocFileName );
+
+		pLoadFunction = MemoryCopy;
+	}
+	else if( magic == TOC_MAGIC_SWAPPED )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Info,
+			TXT( "Cache::FinalizeTocLoad(): TOC \"%s\" identified (byte swapping is necessary).\n" ),
+			*m_tocFileName );
+		HELIUM_TRACE(
+			TraceLevels::Warning,
+			( TXT( "Cache::TryFinishLoadToc(): Cache for TOC \"%s\" uses byte swapping, which may incur " )
+			TXT( "performance penalties.\n" ) ),
+			*m_tocFileName );
+
+		pLoadFunction = ReverseByteOrder;
+	}
+	else
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache::FinalizeTocLoad(): TOC \"%s\" has invalid file magic.\n" ),
+			*m_tocFileName );
+
+		return false;
+	}
+
+	uint32_t version;
+	if( !CheckedTocRead( pLoadFunction, version, TXT( "the cache version number" ), pTocCurrent, pTocMax ) )
+	{
+		return false;
+	}
+
+	if( version > sm_Version )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			( TXT( "Cache::FinalizeTocLoad(): Cache version number (%" ) PRIu32 TXT( ") exceeds the maximum " )
+			TXT( "supported version (%" ) PRIu32 TXT( ").\n" ) ),
+			version,
+			sm_Version );
+
+		return false;
+	}
+
+	if( version >= COMPACT_TOC_VERSION )
+	{
+		// Compact TOCs are used in place, so only the current layout can be used.
+		if( version != sm_Version )
+		{
+			HELIUM_TRACE(
+				TraceLevels::Error,
+				( TXT( "Cache::FinalizeTocLoad(): Compact TOC \"%s\" uses an out-of-date format (version %" ) PRIu32
+				TXT( ").  The cache must be rebuilt.\n" ) ),
+				*m_tocFileName,
+				version );
+
+			return false;
+		}
+
+		if( pLoadFunction != MemoryCopy )
+		{
+			HELIUM_TRACE(
+				TraceLevels::Error,
+				TXT( "Cache::FinalizeTocLoad(): Compact TOC \"%s\" does not use the native byte order.\n" ),
+				*m_tocFileName );
+
+			return false;
+		}
+
+		return FinalizeCompactTocLoad( m_pTocBuffer, m_tocSize );
+	}
+
+	// Read the numbers of entries in the cache.
+	uint32_t entryCount;
+	bool bReadResult = CheckedTocRead(
+		pLoadFunction,
+		entryCount,
+		TXT( "the number of entries in the cache" ),
+		pTocCurrent,
+		pTocMax );
+	if( !bReadResult )
+	{
+		return false;
+	}
+
+	// Load the entry information.
+	EntryKey key;
+
+	uint_fast32_t entryCountFast = entryCount;
+	m_entries.Reserve( entryCountFast );
+	for( uint_fast32_t entryIndex = 0; entryIndex < entryCountFast; ++entryIndex )
+	{
+		uint16_t entryPathSize;
+		bReadResult = CheckedTocRead(
+			pLoadFunction,
+			entryPathSize,
+			TXT( "entry AssetPath string size" ),
+			pTocCurrent,
+			pTocMax );
+		if( !bReadResult )
+		{
+			return false;
+		}
+
+		uint_fast16_t entryPathSizeFast = entryPathSize;
+
+		StackMemoryHeap<>::Marker stackMarker( rStackHeap );
+		char* pPathString = static_cast< char* >( rStackHeap.Allocate(
+			sizeof( char ) * ( entryPathSizeFast + 1 ) ) );
+		HELIUM_ASSERT( pPathString );
+		pPathString[ entryPathSizeFast ] = TXT( '\0' );
+
+		for( uint_fast16_t characterIndex = 0; characterIndex < entryPathSizeFast; ++characterIndex )
+		{
+			bReadResult = CheckedTocRead(
+				pLoadFunction,
+				pPathString[ characterIndex ],
+				TXT( "entry AssetPath string character" ),
+				pTocCurrent,
+				pTocMax );
+			if( !bReadResult )
+			{
+				return false;
+			}
+		}
+
+		AssetPath entryPath;
+		if( !entryPath.Set( pPathString ) )
+		{
+			HELIUM_TRACE(
+				TraceLevels::Error,
+				TXT( "Cache::FinalizeTocLoad(): Failed to set AssetPath for entry %" ) PRIuFAST16 TXT( ".\n" ),
+				entryIndex );
+
+			return false;
+		}
+
+		uint32_t entrySubDataIndex;
+		bReadResult = CheckedTocRead(
+			pLoadFunction,
+			entrySubDataIndex,
+			TXT( "entry sub-data index" ),
+			pTocCurrent,
+			pTocMax );
+		if( !bReadResult )
+		{
+			return false;
+		}
+
+		key.path = entryPath;
+		key.subDataIndex = entrySubDataIndex;
+
+		EntryMapType::ConstAccessor entryAccessor;
+		if( m_entryMap.Find( entryAccessor, key ) )
+		{
+			HELIUM_TRACE(
+				TraceLevels::Error,
+				( TXT( "Cache::FinalizeTocLoad(): Duplicate entry found for AssetPath \"%s\", sub-data %" ) PRIu32
+				TXT( ".\n" ) ),
+				pPathString,
+				entrySubDataIndex );
+
+			return false;
+		}
+
+		uint64_t entryOffset;
+		if( !CheckedTocRead( pLoadFunction, entryOffset, TXT( "entry offset" ), pTocCurrent, pTocMax ) )
+		{
+			return false;
+		}
+
+		int64_t entryTimestamp;
+		if( !CheckedTocRead( pLoadFunction, entryTimestamp, TXT( "entry timestamp" ), pTocCurrent, pTocMax ) )
+		{
+			return false;
+		}
+
+		uint32_t entrySize;
+		if( !CheckedTocRead( pLoadFunction, entrySize, TXT( "entry size" ), pTocCurrent, pTocMax ) )
+		{
+			return false;
+		}
+
+		Entry* pEntry = m_pEntryPool->Allocate();
+		HELIUM_ASSERT( pEntry );
+		pEntry->path = entryPath;
+		pEntry->subDataIndex = entrySubDataIndex;
+		pEntry->offset = entryOffset;
+		pEntry->timestamp = entryTimestamp;
+		pEntry->size = entrySize;
+		pEntry->uncompressedSize = entrySize;
+		pEntry->codec = CacheCompression::CODEC_NONE;
+
+		m_entries.Add( pEntry );
+
+		HELIUM_VERIFY( m_entryMap.Insert( entryAccessor, KeyValue< EntryKey, Entry* >( key, pEntry ) ) );
+	}
+
+	// Compression information follows the entries, if any entries are compressed.
+	uint32_t compressionMagic;
+	if( pTocCurrent + sizeof( compressionMagic ) > pTocMax )
+	{
+		return true;
+	}
+
+	pLoadFunction( &compressionMagic, pTocCurrent, sizeof( compressionMagic ) );
+	if( compressionMagic != TOC_COMPRESSION_MAGIC )
+	{
+		return true;
+	}
+
+	pTocCurrent += sizeof( compressionMagic );
+
+	uint32_t dictionarySize;
+	if( !CheckedTocRead( pLoadFunction, dictionarySize, TXT( "the dictionary size" ), pTocCurrent, pTocMax ) )
+	{
+		return false;
+	}
+
+	if( dictionarySize > static_cast< size_t >( pTocMax - pTocCurrent ) )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache::FinalizeTocLoad(): Not enough bytes in TOC \"%s\" for the compression dictionary.\n" ),
+			*m_tocFileName );
+
+		return false;
+	}
+
+	m_dictionary.Resize( dictionarySize );
+	MemoryCopy( m_dictionary.GetData(), pTocCurrent, dictionarySize );
+	pTocCurrent += dictionarySize;
+
+	for( uint_fast32_t entryIndex = 0; entryIndex < entryCountFast; ++entryIndex )
+	{
+		Entry* pEntry = m_entries[ entryIndex ];
+		HELIUM_ASSERT( pEntry );
+
+		bReadResult =
+			CheckedTocRead( pLoadFunction, pEntry->codec, TXT( "entry codec" ), pTocCurrent, pTocMax ) &&
+			CheckedTocRead(
+				pLoadFunction,
+				pEntry->uncompressedSize,
+				TXT( "entry uncompressed size" ),
+				pTocCurrent,
+				pTocMax );
+		if( !bReadResult )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/// Set up use of a compact TOC in place.
+///
+/// Only the header and section bounds are validated here.  Individual records are validated as they are used, so
+/// that loading does not need to touch every page of the TOC.
+///
+/// @param[in] pToc     TOC file contents, which must remain valid until ReleaseCompactToc() is called.
+/// @param[in] tocSize  Size of the TOC file contents, in bytes.
+///
+/// @return  True if the TOC was set up successfully, false if not.
+bool Cache::FinalizeCompactTocLoad( const uint8_t* pToc, size_t tocSize )
+{
+	HELIUM_ASSERT( pToc );
+	HELIUM_COMPILE_ASSERT( sizeof( CompactTocHeader ) == 24 );
+	HELIUM_COMPILE_ASSERT( sizeof( CompactTocRecord ) == 48 );
+
+	CompactTocHeader header;
+	if( tocSize < sizeof( header ) )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache::FinalizeCompactTocLoad(): Not enough bytes in TOC \"%s\" for the header.\n" ),
+			*m_tocFileName );
+
+		return false;
+	}
+
+	MemoryCopy( &header, pToc, sizeof( header ) );
+	HELIUM_ASSERT( header.magic == TOC_MAGIC );
+	HELIUM_ASSERT( header.version >= COMPACT_TOC_VERSION );
+
+	// The displacement table follows the header, padded so that the records are 8-byte aligned.
+	uint64_t entryCount = header.entryCount;
+	uint64_t displacementOffset = sizeof( header );
+	uint64_t recordOffset = ( displacementOffset + entryCount * sizeof( int32_t ) + 7 ) & ~static_cast< uint64_t >( 7 );
+	uint64_t stringOffset = recordOffset + entryCount * sizeof( CompactTocRecord );
+	uint64_t dictionaryOffset = stringOffset + header.stringBlobSize;
+	if( dictionaryOffset + header.dictionarySize > tocSize )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			( TXT( "Cache::FinalizeCompactTocLoad(): TOC \"%s\" is truncated (%" ) PRIu32 TXT( " entries, %" )
+			PRIuSZ TXT( " bytes).\n" ) ),
+			*m_tocFileName,
+			header.entryCount,
+			tocSize );
+
+		return false;
+	}
+
+	if( ( reinterpret_cast< uintptr_t >( pToc ) & 7 ) != 0 )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache::FinalizeCompactTocLoad(): TOC \"%s\" buffer is not 8-byte aligned.\n" ),
+			*m_tocFileName );
+
+		return false;
+	}
+
+	m_pCompactDisplacements = reinterpret_cast< const int32_t* >( pToc + displacementOffset );
+	m_pCompactRecords = reinterpret_cast< const CompactTocRecord* >( pToc + recordOffset );
+	m_pCompactStrings = reinterpret_cast< const char* >( pToc + stringOffset );
+	m_compactEntryCount = header.entryCount;
+	m_compactStringBlobSize = header.stringBlobSize;
+
+	HELIUM_ASSERT( !m_pCompactEntries );
+	if( m_compactEntryCount != 0 )
+	{
+		m_pCompactEntries = static_cast< Entry* volatile* >(
+			DefaultAllocator().Allocate( sizeof( Entry* ) * m_compactEntryCount ) );
+		HELIUM_ASSERT( m_pCompactEntries );
+		MemoryZero( const_cast< Entry** >( m_pCompactEntries ), sizeof( Entry* ) * m_compactEntryCount );
+	}
+
+	m_dictionary.Resize( header.dictionarySize );
+	MemoryCopy( m_dictionary.GetData(), pToc + dictionaryOffset, header.dictionarySize );
+
+	HELIUM_TRACE(
+		TraceLevels::Info,
+		TXT( "Cache::FinalizeCompactTocLoad(): Using compact TOC \"%s\" (%" ) PRIu32 TXT( " entries).\n" ),
+		*m_tocFileName,
+		m_compactEntryCount );
+
+	return true;
+}
+
+/// Stop using the compact TOC, if any, and release its memory.
+///
+/// Entries that have already been expanded remain valid.
+void Cache::ReleaseCompactToc()
+{
+	if( !m_pCompactRecords )
+	{
+		return;
+	}
+
+	m_pCompactDisplacements = NULL;
+	m_pCompactRecords = NULL;
+	m_pCompactStrings = NULL;
+	m_compactEntryCount = 0;
+	m_compactStringBlobSize = 0;
+
+	DefaultAllocator().Free( const_cast< Entry** >( m_pCompactEntries ) );
+	m_pCompactEntries = NULL;
+
+	m_tocFileMapping.Close();
+
+	DefaultAllocator().Free( m_pTocBuffer );
+	m_pTocBuffer = NULL;
+}
+
+/// Look up the record for an entry in the compact TOC.
+///
+/// @param[in] path          Entry path.
+/// @param[in] subDataIndex  Entry sub-data index.
+///
+/// @return  Index of the entry record, or an invalid index if no entry exists with the given key.
+uint32_t Cache::FindCompactRecord( AssetPath path, uint32_t subDataIndex ) const
+{
+	HELIUM_ASSERT( m_pCompactRecords );
+	HELIUM_ASSERT( !path.IsEmpty() );
+
+	uint64_t pathHash = path.ComputeStableHash();
+
+	uint32_t entryCount = m_compactEntryCount;
+	if( entryCount == 0 )
+	{
+		return Invalid< uint32_t >();
+	}
+
+	// Negative displacements store the record index directly (used for buckets with a single key), and positive
+	// displacements give the seed with which to hash the key to its record.
+	int32_t displacement =
+		m_pCompactDisplacements[ HashCompactTocKey( pathHash, subDataIndex, 0 ) % entryCount ];
+	uint32_t recordIndex = ( displacement < 0
+		? static_cast< uint32_t >( -( displacement + 1 ) )
+		: static_cast< uint32_t >(
+			HashCompactTocKey( pathHash, subDataIndex, static_cast< uint32_t >( displacement ) ) % entryCount ) );
+	if( recordIndex >= entryCount )
+	{
+		return Invalid< uint32_t >();
+	}
+
+	// Keys not in the table still map to some record, so the key must be checked.  The hash only rules out most
+	// mismatches, so the stored path is compared as well.
+	const CompactTocRecord& rRecord = m_pCompactRecords[ recordIndex ];
+	if( rRecord.pathHash != pathHash || rRecord.subDataIndex != subDataIndex )
+	{
+		return Invalid< uint32_t >();
+	}
+
+	const char* pRecordPath = GetCompactRecordPath( recordIndex );
+	if( !pRecordPath )
+	{
+		return Invalid< uint32_t >();
+	}
+
+	if( !path.MatchesString( pRecordPath, rRecord.pathSize ) )
+	{
+		return Invalid< uint32_t >();
+	}
+
+	return recordIndex;
+}
+
+/// Get the path string for a compact TOC record.
+///
+/// @param[in] recordIndex  Record index.
+///
+/// @return  Null-terminated path string within the string blob, or null if the record's path is out of bounds.
+const char* Cache::GetCompactRecordPath( uint32_t recordIndex ) const
+{
+	HELIUM_ASSERT( m_pCompactRecords );
+	HELIUM_ASSERT( recordIndex < m_compactEntryCount );
+
+	const CompactTocRecord& rRecord = m_pCompactRecords[ recordIndex ];
+	if( rRecord.pathOffset >= m_compactStringBlobSize ||
+		rRecord.pathSize >= m_compactStringBlobSize - rRecord.pathOffset ||
+		m_pCompactStrings[ rRecord.pathOffset + rRecord.pathSize ] != TXT( '\0' ) )
+	{
+		return NULL;
+	}
+
+	return m_pCompactStrings + rRecord.pathOffset;
+}
+
+/// Get the entry for a compact TOC record, expanding it if it has not been looked up before.
+///
+/// @param[in] recordIndex  Record index.
+/// @param[in] path         Entry path (already resolved by the caller).
+///
+/// @return  Cache entry.
+const Cache::Entry* Cache::ExpandCompactRecord( uint32_t recordIndex, AssetPath path ) const
+{
+	HELIUM_ASSERT( m_pCompactRecords );
+	HELIUM_ASSERT( recordIndex < m_compactEntryCount );
+	HELIUM_ASSERT( m_pEntryPool );
+
+	const CompactTocRecord& rRecord = m_pCompactRecords[ recordIndex ];
+
+	EntryKey key;
+	key.path = path;
+	key.subDataIndex = rRecord.subDataIndex;
+
+	// Records are only expanded once, so the published entry can be returned without taking the lock.
+	Entry* pEntry = m_pCompactEntries[ recordIndex ];
+	if( pEntry )
+	{
+		return pEntry;
+	}
+
+	m_compactEntryLock.Lock();
+
+	// Another thread may have expanded the same record in the mean time.
+	pEntry = m_pCompactEntries[ recordIndex ];
+	if( pEntry )
+	{
+		m_compactEntryLock.Unlock();
+
+		return pEntry;
+	}
+
+	pEntry = m_pEntryPool->Allocate();
+	HELIUM_ASSERT( pEntry );
+	pEntry->offset = rRecord.offset;
+	pEntry->timestamp = rRecord.timestamp;
+	pEntry->path = path;
+	pEntry->subDataIndex = rRecord.subDataIndex;
+	pEntry->size = rRecord.size;
+	pEntry->uncompressedSize = rRecord.uncompressedSize;
+	pEntry->codec = rRecord.codec;
+
+	EntryMapType::Accessor entryAccessor;
+	if( !m_entryMap.Insert( entryAccessor, KeyValue< EntryKey, Entry* >( key, pEntry ) ) )
+	{
+		m_pEntryPool->Release( pEntry );
+		pEntry = entryAccessor->Second();
+		HELIUM_ASSERT( pEntry );
+	}
+
+	// Publish the entry for lock-free lookups by record index once it is fully set up.
+	AtomicExchangeRelease( m_pCompactEntries[ recordIndex ], pEntry );
+
+	m_compactEntryLock.Unlock();
+
+	return pEntry;
+}
+
+/// Expand all entries in the compact TOC and switch over to the entry list used for modifiable caches.
+///
+/// @return  True if successful, false if not.
+bool Cache::ExpandCompactToc()
+{
+	HELIUM_ASSERT( m_pCompactRecords );
+
+	uint32_t entryCount = m_compactEntryCount;
+
+	m_entries.Clear();
+	m_entries.Reserve( entryCount );
+	for( uint32_t recordIndex = 0; recordIndex < entryCount; ++recordIndex )
 	{
-		return false;
+		const Entry& rEntry = GetEntry( recordIndex );
+		if( rEntry.path.IsEmpty() )
+		{
+			m_entries.Clear();
+
+			return false;
+		}
+
+		m_entries.Push( const_cast< Entry* >( &rEntry ) );
 	}
 
-	LOAD_VALUE_CALLBACK* pLoadFunction = NULL;
-	if( magic == TOC_MAGIC )
+	ReleaseCompactToc();
+
+	return true;
+}
+
+/// Write out the TOC for the current set of entries.
+///
+/// The compact format is written whenever possible, falling back to the original format if a perfect hash cannot
+/// be built for the entries.
+///
+/// @param[in] rStream  Stream to which the TOC should be written.
+void Cache::WriteToc( Stream& rStream ) const
+{
+	HELIUM_ASSERT( !m_pCompactRecords );
+
+	if( WriteCompactToc( rStream ) )
 	{
-		HELIUM_TRACE(
-			TraceLevels::Info,
-			TXT( "Cache::FinalizeTocLoad(): TOC \"%s\" identified (no byte swapping).\n" ),
-			*m_tocFileName );
+		return;
+	}
 
-		pLoadFunction = MemoryCopy;
+	HELIUM_TRACE(
+		TraceLevels::Warning,
+		TXT( "Cache: Failed to build compact TOC for \"%s\".  Writing TOC in the original format.\n" ),
+		*m_tocFileName );
+
+	const uint32_t version = 0;
+	rStream.Write( &TOC_MAGIC, sizeof( TOC_MAGIC ), 1 );
+	rStream.Write( &version, sizeof( version ), 1 );
+
+	uint32_t entryCount = static_cast< uint32_t >( m_entries.GetSize() );
+	rStream.Write( &entryCount, sizeof( entryCount ), 1 );
+
+	String entryPath;
+	uint_fast32_t entryCountFast = entryCount;
+	for( uint_fast32_t entryIndex = 0; entryIndex < entryCountFast; ++entryIndex )
+	{
+		Entry* pEntry = m_entries[ entryIndex ];
+		HELIUM_ASSERT( pEntry );
+
+		pEntry->path.ToString( entryPath );
+		HELIUM_ASSERT( entryPath.GetSize() < UINT16_MAX );
+		uint16_t pathSize = static_cast< uint16_t >( entryPath.GetSize() );
+		rStream.Write( &pathSize, sizeof( pathSize ), 1 );
+
+		rStream.Write( *entryPath, sizeof( char ), pathSize );
+
+		rStream.Write( &pEntry->subDataIndex, sizeof( pEntry->subDataIndex ), 1 );
+
+		rStream.Write( &pEntry->offset, sizeof( pEntry->offset ), 1 );
+		rStream.Write( &pEntry->timestamp, sizeof( pEntry->timestamp ), 1 );
+		rStream.Write( &pEntry->size, sizeof( pEntry->size ), 1 );
 	}
-	else if( magic == TOC_MAGIC_SWAPPED )
+
+	// Compression information is written after the entries, where it is ignored by older versions.
+	bool bAnyCompressed = ( m_dictionary.GetSize() != 0 );
+	for( uint_fast32_t entryIndex = 0; entryIndex < entryCountFast && !bAnyCompressed; ++entryIndex )
 	{
-		HELIUM_TRACE(
-			TraceLevels::Info,
-			TXT( "Cache::FinalizeTocLoad(): TOC \"%s\" identified (byte swapping is necessary).\n" ),
-			*m_tocFileName );
-		HELIUM_TRACE(
-			TraceLevels::Warning,
-			( TXT( "Cache::TryFinishLoadToc(): Cache for TOC \"%s\" uses byte swapping, which may incur " )
-			TXT( "performance penalties.\n" ) ),
-			*m_tocFileName );
+		bAnyCompressed = ( m_entries[ entryIndex ]->codec != CacheCompression::CODEC_NONE );
+	}
 
-		pLoadFunction = ReverseByteOrder;
+	if( bAnyCompressed )
+	{
+		rStream.Write( &TOC_COMPRESSION_MAGIC, sizeof( TOC_COMPRESSION_MAGIC ), 1 );
+
+		uint32_t dictionarySize = static_cast< uint32_t >( m_dictionary.GetSize() );
+		rStream.Write( &dictionarySize, sizeof( dictionarySize ), 1 );
+		rStream.Write( m_dictionary.GetData(), 1, dictionarySize );
+
+		for( uint_fast32_t entryIndex = 0; entryIndex < entryCountFast; ++entryIndex )
+		{
+			Entry* pEntry = m_entries[ entryIndex ];
+			HELIUM_ASSERT( pEntry );
+
+			rStream.Write( &pEntry->codec, sizeof( pEntry->codec ), 1 );
+			rStream.Write( &pEntry->uncompressedSize, sizeof( pEntry->uncompressedSize ), 1 );
+		}
 	}
-	else
+}
+
+/// Write out the TOC for the current set of entries in the compact format.
+///
+/// A minimal perfect hash is built using hash-and-displace: keys are grouped into buckets by hash, and buckets are
+/// placed largest first by searching for a seed that sends each of their keys to a free record slot.  Buckets with a
+/// single key are placed directly into the remaining free slots.
+///
+/// @param[in] rStream  Stream to which the TOC should be written.
+///
+/// @return  True if the TOC was written, false if a perfect hash could not be built (nothing is written in this case).
+bool Cache::WriteCompactToc( Stream& rStream ) const
+{
+	uint32_t entryCount = static_cast< uint32_t >( m_entries.GetSize() );
+
+	DynamicArray< uint64_t > pathHashes;
+	pathHashes.Resize( entryCount );
+	DynamicArray< uint32_t > bucketSizes;
+	bucketSizes.Resize( entryCount );
+	DynamicArray< uint32_t > entryBuckets;
+	entryBuckets.Resize( entryCount );
+	for( uint32_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
 	{
-		HELIUM_TRACE(
-			TraceLevels::Error,
-			TXT( "Cache::FinalizeTocLoad(): TOC \"%s\" has invalid file magic.\n" ),
-			*m_tocFileName );
+		bucketSizes[ entryIndex ] = 0;
+	}
 
-		return false;
+	for( uint32_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
+	{
+		const Entry* pEntry = m_entries[ entryIndex ];
+		HELIUM_ASSERT( pEntry );
+
+		uint64_t pathHash = pEntry->path.ComputeStableHash();
+		pathHashes[ entryIndex ] = pathHash;
+
+		uint32_t bucket = static_cast< uint32_t >(
+			HashCompactTocKey( pathHash, pEntry->subDataIndex, 0 ) % entryCount );
+		entryBuckets[ entryIndex ] = bucket;
+		++bucketSizes[ bucket ];
 	}
 
-	uint32_t version;
-	if( !CheckedTocRead( pLoadFunction, version, TXT( "the cache version number" ), pTocCurrent, pTocMax ) )
+	// Group entry indices by bucket.
+	DynamicArray< uint32_t > bucketStarts;
+	bucketStarts.Resize( entryCount + 1 );
+	bucketStarts[ 0 ] = 0;
+	for( uint32_t bucket = 0; bucket < entryCount; ++bucket )
 	{
-		return false;
+		bucketStarts[ bucket + 1 ] = bucketStarts[ bucket ] + bucketSizes[ bucket ];
 	}
 
-	if( version > sm_Version )
+	DynamicArray< uint32_t > bucketEntries;
+	bucketEntries.Resize( entryCount );
+	DynamicArray< uint32_t > bucketFill;
+	bucketFill.Resize( entryCount );
+	for( uint32_t bucket = 0; bucket < entryCount; ++bucket )
 	{
-		HELIUM_TRACE(
-			TraceLevels::Error,
-			( TXT( "Cache::FinalizeTocLoad(): Cache version number (%" ) PRIu32 TXT( ") exceeds the maximum " )
-			TXT( "supported version (%" ) PRIu32 TXT( ").\n" ) ),
-			version,
-			sm_Version );
+		bucketFill[ bucket ] = bucketStarts[ bucket ];
+	}
 
-		return false;
+	for( uint32_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
+	{
+		bucketEntries[ bucketFill[ entryBuckets[ entryIndex ] ]++ ] = entryIndex;
 	}
 
-	// Read the numbers of entries in the cache.
-	uint32_t entryCount;
-	bool bReadResult = CheckedTocRead(
-		pLoadFunction,
-		entryCount,
-		TXT( "the number of entries in the cache" ),
-		pTocCurrent,
-		pTocMax );
-	if( !bReadResult )
+	DynamicArray< uint32_t > bucketOrder;
+	bucketOrder.Resize( entryCount );
+	for( uint32_t bucket = 0; bucket < entryCount; ++bucket )
 	{
-		return false;
+		bucketOrder[ bucket ] = bucket;
 	}
 
-	// Load the entry information.
-	EntryKey key;
+	std::sort(
+		bucketOrder.GetData(),
+		bucketOrder.GetData() + entryCount,
+		CompactTocBucketCompare( bucketSizes.GetData() ) );
+
+	// Place each bucket.
+	DynamicArray< int32_t > displacements;
+	displacements.Resize( entryCount );
+	DynamicArray< uint32_t > slotEntries;
+	slotEntries.Resize( entryCount );
+	for( uint32_t slot = 0; slot < entryCount; ++slot )
+	{
+		displacements[ slot ] = 0;
+		SetInvalid( slotEntries[ slot ] );
+	}
 
-	uint_fast32_t entryCountFast = entryCount;
-	m_entries.Reserve( entryCountFast );
-	for( uint_fast32_t entryIndex = 0; entryIndex < entryCountFast; ++entryIndex )
+	DynamicArray< uint32_t > bucketSlots;
+	uint32_t freeSlot = 0;
+	for( uint32_t orderIndex = 0; orderIndex < entryCount; ++orderIndex )
 	{
-		uint16_t entryPathSize;
-		bReadResult = CheckedTocRead(
-			pLoadFunction,
-			entryPathSize,
-			TXT( "entry AssetPath string size" ),
-			pTocCurrent,
-			pTocMax );
-		if( !bReadResult )
+		uint32_t bucket = bucketOrder[ orderIndex ];
+		uint32_t bucketSize = bucketSizes[ bucket ];
+		const uint32_t* pBucketEntries = bucketEntries.GetData() + bucketStarts[ bucket ];
+
+		if( bucketSize == 0 )
 		{
-			return false;
+			break;
 		}
 
-		uint_fast16_t entryPathSizeFast = entryPathSize;
-
-		StackMemoryHeap<>::Marker stackMarker( rStackHeap );
-		char* pPathString = static_cast< char* >( rStackHeap.Allocate(
-			sizeof( char ) * ( entryPathSizeFast + 1 ) ) );
-		HELIUM_ASSERT( pPathString );
-		pPathString[ entryPathSizeFast ] = TXT( '\0' );
-
-		for( uint_fast16_t characterIndex = 0; characterIndex < entryPathSizeFast; ++characterIndex )
+		if( bucketSize == 1 )
 		{
-			bReadResult = CheckedTocRead(
-				pLoadFunction,
-				pPathString[ characterIndex ],
-				TXT( "entry AssetPath string character" ),
-				pTocCurrent,
-				pTocMax );
-			if( !bReadResult )
+			while( IsValid( slotEntries[ freeSlot ] ) )
 			{
-				return false;
+				++freeSlot;
 			}
-		}
 
-		AssetPath entryPath;
-		if( !entryPath.Set( pPathString ) )
-		{
-			HELIUM_TRACE(
-				TraceLevels::Error,
-				TXT( "Cache::FinalizeTocLoad(): Failed to set AssetPath for entry %" ) PRIuFAST16 TXT( ".\n" ),
-				entryIndex );
+			slotEntries[ freeSlot ] = pBucketEntries[ 0 ];
+			displacements[ bucket ] = -static_cast< int32_t >( freeSlot ) - 1;
 
-			return false;
+			continue;
 		}
 
-		uint32_t entrySubDataIndex;
-		bReadResult = CheckedTocRead(
-			pLoadFunction,
-			entrySubDataIndex,
-			TXT( "entry sub-data index" ),
-			pTocCurrent,
-			pTocMax );
-		if( !bReadResult )
+		bucketSlots.Resize( bucketSize );
+
+		uint32_t seed = 1;
+		for( ; seed < COMPACT_TOC_SEED_LIMIT; ++seed )
 		{
-			return false;
-		}
+			uint32_t placedCount = 0;
+			for( ; placedCount < bucketSize; ++placedCount )
+			{
+				uint32_t entryIndex = pBucketEntries[ placedCount ];
+				uint32_t slot = static_cast< uint32_t >( HashCompactTocKey(
+					pathHashes[ entryIndex ],
+					m_entries[ entryIndex ]->subDataIndex,
+					seed ) % entryCount );
+				if( IsValid( slotEntries[ slot ] ) )
+				{
+					break;
+				}
 
-		key.path = entryPath;
-		key.subDataIndex = entrySubDataIndex;
+				// Claim the slot for now, so that keys in the same bucket cannot share it.
+				slotEntries[ slot ] = entryIndex;
+				bucketSlots[ placedCount ] = slot;
+			}
 
-		EntryMapType::ConstAccessor entryAccessor;
-		if( m_entryMap.Find( entryAccessor, key ) )
-		{
-			HELIUM_TRACE(
-				TraceLevels::Error,
-				( TXT( "Cache::FinalizeTocLoad(): Duplicate entry found for AssetPath \"%s\", sub-data %" ) PRIu32
-				TXT( ".\n" ) ),
-				pPathString,
-				entrySubDataIndex );
+			if( placedCount == bucketSize )
+			{
+				break;
+			}
 
-			return false;
+			for( uint32_t placedIndex = 0; placedIndex < placedCount; ++placedIndex )
+			{
+				SetInvalid( slotEntries[ bucketSlots[ placedIndex ] ] );
+			}
 		}
 
-		uint64_t entryOffset;
-		if( !CheckedTocRead( pLoadFunction, entryOffset, TXT( "entry offset" ), pTocCurrent, pTocMax ) )
+		// Keys that collide in all 64 bits (or duplicate entries) cannot be separated by any seed.
+		if( seed >= COMPACT_TOC_SEED_LIMIT )
 		{
 			return false;
 		}
 
-		int64_t entryTimestamp;
-		if( !CheckedTocRead( pLoadFunction, entryTimestamp, TXT( "entry timestamp" ), pTocCurrent, pTocMax ) )
+		displacements[ bucket ] = static_cast< int32_t >( seed );
+	}
+
+	// Build the string blob, storing each unique path once in sorted order.
+	DynamicArray< String > paths;
+	paths.Resize( entryCount );
+	DynamicArray< uint32_t > pathOrder;
+	pathOrder.Resize( entryCount );
+	for( uint32_t entryIndex = 0; entryIndex < entryCount; ++entryIndex )
+	{
+		m_entries[ entryIndex ]->path.ToString( paths[ entryIndex ] );
+		pathOrder[ entryIndex ] = entryIndex;
+	}
+
+	std::sort( pathOrder.GetData(), pathOrder.GetData() + entryCount, CompactTocPathCompare( paths.GetData() ) );
+
+	DynamicArray< uint32_t > pathOffsets;
+	pathOffsets.Resize( entryCount );
+	uint32_t stringBlobSize = 0;
+	for( uint32_t orderIndex = 0; orderIndex < entryCount; ++orderIndex )
+	{
+		uint32_t entryIndex = pathOrder[ orderIndex ];
+		if( orderIndex != 0 && paths[ entryIndex ] == paths[ pathOrder[ orderIndex - 1 ] ] )
 		{
-			return false;
+			pathOffsets[ entryIndex ] = pathOffsets[ pathOrder[ orderIndex - 1 ] ];
+
+			continue;
 		}
 
-		uint32_t entrySize;
-		if( !CheckedTocRead( pLoadFunction, entrySize, TXT( "entry size" ), pTocCurrent, pTocMax ) )
+		pathOffsets[ entryIndex ] = stringBlobSize;
+		stringBlobSize += static_cast< uint32_t >( paths[ entryIndex ].GetSize() + 1 );
+	}
+
+	// Write the header, displacement table, records, string blob, and dictionary.
+	CompactTocHeader header;
+	header.magic = TOC_MAGIC;
+	header.version = sm_Version;
+	header.entryCount = entryCount;
+	header.stringBlobSize = stringBlobSize;
+	header.dictionarySize = static_cast< uint32_t >( m_dictionary.GetSize() );
+	header.reserved = 0;
+	rStream.Write( &header, sizeof( header ), 1 );
+
+	if( entryCount != 0 )
+	{
+		rStream.Write( displacements.GetData(), sizeof( int32_t ), entryCount );
+	}
+
+	// The header is 24 bytes, so at most one 4-byte pad is needed to align the records.
+	if( ( entryCount & 1 ) != 0 )
+	{
+		const uint32_t padding = 0;
+		rStream.Write( &padding, sizeof( padding ), 1 );
+	}
+
+	for( uint32_t slot = 0; slot < entryCount; ++slot )
+	{
+		uint32_t entryIndex = slotEntries[ slot ];
+		HELIUM_ASSERT( IsValid( entryIndex ) );
+
+		const Entry* pEntry = m_entries[ entryIndex ];
+
+		CompactTocRecord record;
+		record.pathHash = pathHashes[ entryIndex ];
+		record.offset = pEntry->offset;
+		record.timestamp = pEntry->timestamp;
+		record.subDataIndex = pEntry->subDataIndex;
+		record.size = pEntry->size;
+		record.pathOffset = pathOffsets[ entryIndex ];
+		record.pathSize = static_cast< uint32_t >( paths[ entryIndex ].GetSize() );
+		record.uncompressedSize = pEntry->uncompressedSize;
+		record.codec = pEntry->codec;
+		rStream.Write( &record, sizeof( record ), 1 );
+	}
+
+	for( uint32_t orderIndex = 0; orderIndex < entryCount; ++orderIndex )
+	{
+		uint32_t entryIndex = pathOrder[ orderIndex ];
+		if( orderIndex != 0 && pathOffsets[ entryIndex ] == pathOffsets[ pathOrder[ orderIndex - 1 ] ] )
 		{
-			return false;
+			continue;
 		}
 
-		Entry* pEntry = m_pEntryPool->Allocate();
-		HELIUM_ASSERT( pEntry );
-		pEntry->path = entryPath;
-		pEntry->subDataIndex = entrySubDataIndex;
-		pEntry->offset = entryOffset;
-		pEntry->timestamp = entryTimestamp;
-		pEntry->size = entrySize;
+		const String& rPath = paths[ entryIndex ];
+		rStream.Write( rPath.GetData(), sizeof( char ), rPath.GetSize() + 1 );
+	}
 
-		m_entries.Add( pEntry );
+	rStream.Write( m_dictionary.GetData(), 1, m_dictionary.GetSize() );
 
-		HELIUM_VERIFY( m_entryMap.Insert( entryAccessor, KeyValue< EntryKey, Entry* >( key, pEntry ) ) );
+	return true;
+}
+
+/// Read the data for an entry as stored in the cache file.
+///
+/// @param[in]  rStream  Cache file stream.
+/// @param[in]  rEntry   Entry to read.
+/// @param[out] rData    Stored entry data.
+///
+/// @return  True if successful, false if not.
+bool Cache::ReadStoredEntryData( Stream& rStream, const Entry& rEntry, DynamicArray< uint8_t >& rData ) const
+{
+	rData.Resize( rEntry.size );
+	if( rEntry.size == 0 )
+	{
+		return true;
 	}
 
-	return true;
+	int64_t seekOffset = rStream.Seek( static_cast< int64_t >( rEntry.offset ), SeekOrigins::Begin );
+
+	return ( static_cast< uint64_t >( seekOffset ) == rEntry.offset &&
+		rStream.Read( rData.GetData(), 1, rEntry.size ) == rEntry.size );
+}
+
+/// Decompress the stored data for an entry.
+///
+/// @param[in]  rEntry   Entry.
+/// @param[in]  pData    Stored entry data.
+/// @param[out] rOutput  Decompressed entry data.
+///
+/// @return  True if successful, false if not.
+bool Cache::DecompressEntryData( const Entry& rEntry, const uint8_t* pData, DynamicArray< uint8_t >& rOutput ) const
+{
+	rOutput.Resize( rEntry.uncompressedSize );
+
+	bool bDecompressResult = CacheCompression::Decompress(
+		static_cast< CacheCompression::ECodec >( rEntry.codec ),
+		pData,
+		rEntry.size,
+		rOutput.GetData(),
+		rEntry.uncompressedSize,
+		m_dictionary.GetData(),
+		m_dictionary.GetSize() );
+	if( !bDecompressResult )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "Cache: Failed to decompress \"%s\" (sub-data %" ) PRIu32 TXT( ") from cache \"%s\".\n" ),
+			*rEntry.path.ToString(),
+			rEntry.subDataIndex,
+			*m_name );
+	}
+
+	return bDecompressResult;
+}
+
+/// Free the resources used by a finished entry load.
+///
+/// @param[in] loadId  Entry load ID.
+/// @param[in] pLoad   Entry load.
+void Cache::ReleaseEntryLoad( size_t loadId, EntryLoad* pLoad )
+{
+	HELIUM_ASSERT( pLoad );
+
+	DefaultAllocator allocator;
+	allocator.Free( pLoad->pCompressedBuffer );
+	allocator.Free( pLoad->pDecompressedBuffer );
+
+	m_entryLoadLock.Lock();
+	m_entryLoads.Remove( loadId );
+	m_entryLoadPool.Release( pLoad );
+	m_entryLoadLock.Unlock();
+}
+
+/// Async loader completion callback for reads of compressed entry data.
+///
+/// This is run on the async loading thread, so decompression is only started here if it can be dispatched to
+/// another thread.
+///
+/// @param[in] pUserData  Entry load.
+/// @param[in] bytesRead  Number of bytes read.
+void Cache::OnEntryReadComplete( void* pUserData, size_t bytesRead )
+{
+	EntryLoad* pLoad = static_cast< EntryLoad* >( pUserData );
+	HELIUM_ASSERT( pLoad );
+
+	pLoad->bytesRead = bytesRead;
+	if( bytesRead == pLoad->compressedSize && TaskDispatcher::HasDispatchFunction() )
+	{
+		pLoad->decompressDispatchCounter = 1;
+		TaskDispatcher::Dispatch( DecompressEntryLoad, pLoad );
+	}
+}
+
+/// Decompress the data for an entry load once it has been read.
+///
+/// @param[in] pUserData  Entry load.
+void Cache::DecompressEntryLoad( void* pUserData )
+{
+	EntryLoad* pLoad = static_cast< EntryLoad* >( pUserData );
+	HELIUM_ASSERT( pLoad );
+
+	bool bSuccess = false;
+	if( pLoad->bytesRead == pLoad->compressedSize )
+	{
+		const Cache* pCache = pLoad->pCache;
+		HELIUM_ASSERT( pCache );
+
+		void* pDestination = ( pLoad->pDecompressedBuffer ? pLoad->pDecompressedBuffer : pLoad->pBuffer );
+		bSuccess = CacheCompression::Decompress(
+			pLoad->codec,
+			pLoad->pCompressedData,
+			pLoad->compressedSize,
+			pDestination,
+			pLoad->uncompressedSize,
+			pCache->m_dictionary.GetData(),
+			pCache->m_dictionary.GetSize() );
+		if( !bSuccess )
+		{
+			HELIUM_TRACE(
+				TraceLevels::Error,
+				TXT( "Cache: Failed to decompress entry data from cache \"%s\".\n" ),
+				*pCache->m_cacheFileName );
+		}
+	}
+
+	pLoad->bDecompressSuccess = bSuccess;
+	AtomicExchangeRelease( pLoad->decompressFinishCounter, 1 );
+
+	// Wake up any thread waiting for the load to finish.
+	AsyncLoader::GetStaticInstance().NotifyProgress();
 }
 
 /// Read a value from the cache TOC, check the TOC bounds in the process.
@@ -5,20 +5,49 @@
 
 #include "Foundation/ConcurrentHashMap.h"
 #include "Foundation/ObjectPool.h"
+#include "Foundation/SparseArray.h"
 #include "Engine/AssetPath.h"
+#include "Engine/CacheCompression.h"
+#include "Engine/CacheFileMapping.h"
 #include "Reflect/Object.h"
 
 namespace Helium
 {
+	class Stream;
+
 	/// Serialization cache interface.
+	///
+	/// Current table of contents files use a compact format that is used in place once loaded (memory-mapped if the
+	/// cache file is mapped): fixed-size entry records placed by a prebuilt minimal perfect hash of each entry's path
+	/// and sub-data index, followed by a sorted blob of path strings.  Entry information is only expanded into Entry
+	/// structures as entries are looked up.  TOC files in the original variable-length format are still supported.
+	///
+	/// Entry data is only ever appended to the cache file, and the TOC is rewritten in batches (see CommitToc()) by
+	/// replacing it with a fully written temporary file, so an interrupted write never leaves a TOC referencing
+	/// incomplete data.  Space used by superseded entries can be reclaimed offline with Compact() (run by the editor's
+	/// "cook -compact" command through CacheManager::CompactCaches()), which stages the new cache file and TOC as
+	/// pending files so that an interrupted compaction can be completed on the next Initialize().
+	///
+	/// Entries can be stored compressed (see CacheCompression), with a dictionary shared by all entries in the cache
+	/// that is trained when compacting (by default when compacting through "cook -compact").  Entry data should be loaded through BeginLoadEntry() or ReadEntry(), which
+	/// take care of decompression.
 	class HELIUM_ENGINE_API Cache : NonCopyable
 	{
 	public:
 		/// Current cache file format version number.
 		static const uint32_t sm_Version;
+		/// Earliest cache file format version using the compact TOC format.
+		static const uint32_t COMPACT_TOC_VERSION = 1;
 
 		/// Default Entry pool block size (for use with modifiable caches on the PC).
 		static const size_t ENTRY_POOL_BLOCK_SIZE = 64;
+		/// Entry load pool block size.
+		static const size_t ENTRY_LOAD_POOL_BLOCK_SIZE = 32;
+		/// Number of cached entries after which the TOC is automatically committed.
+		static const size_t TOC_COMMIT_BATCH_SIZE = 256;
+		/// Maximum time to wait for dispatched decompression before checking again when synchronously loading an
+		/// entry, in milliseconds (finished tasks normally wake the waiting thread right away).
+		static const uint32_t SYNC_LOAD_WAIT_INTERVAL = 10;
 
 		/// Cache platforms.
 		enum EPlatform
@@ -39,7 +68,7 @@ namespace Helium
 		{
 			/// Entry offset.
 			uint64_t offset;
-			/// Entry timestamp.
+			/// Entry timestamp (for preprocessed resources, the content key of the resource data instead).
 			int64_t timestamp;
 
 			/// Entry path name.
@@ -47,8 +76,12 @@ namespace Helium
 			/// Sub-data index.
 			uint32_t subDataIndex;
 
-			/// Entry size.
+			/// Size of the entry data as stored in the cache file.
 			uint32_t size;
+			/// Size of the entry data once decompressed.
+			uint32_t uncompressedSize;
+			/// Compression codec (CacheCompression::ECodec).
+			uint32_t codec;
 		};
 
 		/// @name Construction/Destruction
@@ -72,6 +105,15 @@ namespace Helium
 		void EnforceTocLoad();
 		//@}
 
+		/// @name Memory Mapping
+		//@{
+		bool MapCacheFile();
+		inline bool IsCacheFileMapped() const;
+
+		const uint8_t* GetMappedEntryData( const Entry& rEntry ) const;
+		void AdviseEntryReadahead( const Entry& rEntry ) const;
+		//@}
+
 		/// @name Data Access
 		//@{
 		inline Name GetName() const;
@@ -81,10 +123,26 @@ namespace Helium
 		inline const String& GetCacheFileName() const;
 
 		inline uint32_t GetEntryCount() const;
-		inline const Entry& GetEntry( uint32_t index ) const;
+		const Entry& GetEntry( uint32_t index ) const;
 		const Entry* FindEntry( AssetPath path, uint32_t subDataIndex ) const;
 
-		bool CacheEntry( AssetPath path, uint32_t subDataIndex, const void* pData, int64_t timestamp, uint32_t size );
+		bool CacheEntry(
+			AssetPath path, uint32_t subDataIndex, const void* pData, int64_t timestamp, uint32_t size,
+			CacheCompression::ECodec codec = CacheCompression::CODEC_NONE );
+		bool CommitToc();
+
+		bool Compact( bool bTrainDictionary = false );
+		//@}
+
+		/// @name Entry Data Loading
+		//@{
+		size_t BeginLoadEntry(
+			const Entry& rEntry, void* pBuffer, size_t loadSizeMax = Invalid< size_t >(),
+			bool bWriteCombinedBuffer = false );
+		bool TryFinishLoadEntry( size_t loadId, size_t& rBytesLoaded );
+		size_t SyncLoadEntry( size_t loadId );
+
+		bool ReadEntry( const Entry& rEntry, DynamicArray< uint8_t >& rData ) const;
 		//@}
 
 #if HELIUM_TOOLS
@@ -93,6 +151,11 @@ namespace Helium
 		static Reflect::ObjectPtr ReadCacheObjectFromBuffer( const DynamicArray< uint8_t > &_buffer, Reflect::ObjectResolver *pResolver = 0 );
 		static Reflect::ObjectPtr ReadCacheObjectFromBuffer( const uint8_t *_buffer, const size_t _offset, const size_t _count, Reflect::ObjectResolver *pResolver = 0 );
 
+		/// @name File Utilities
+		//@{
+		static bool WriteFileAtomic( const String& rFileName, const void* pData, size_t size );
+		//@}
+
 	private:
 		/// Value read callback.
 		typedef void ( LOAD_VALUE_CALLBACK )( void* pDestination, const void* pSource, size_t byteCount );
@@ -121,6 +184,82 @@ namespace Helium
 			//@}
 		};
 
+		/// Compact TOC file header.
+		struct CompactTocHeader
+		{
+			/// File magic number.
+			uint32_t magic;
+			/// Cache format version number.
+			uint32_t version;
+			/// Number of entries.
+			uint32_t entryCount;
+			/// Size of the path string blob, in bytes.
+			uint32_t stringBlobSize;
+			/// Size of the compression dictionary following the path string blob, in bytes.
+			uint32_t dictionarySize;
+			/// Reserved (keeps the header size a multiple of 8 bytes).
+			uint32_t reserved;
+		};
+
+		/// Compact TOC entry record, stored in the slot given by the perfect hash of its path and sub-data index.
+		struct CompactTocRecord
+		{
+			/// Stable hash of the entry path (see AssetPath::ComputeStableHash()).
+			uint64_t pathHash;
+			/// Entry offset.
+			uint64_t offset;
+			/// Entry timestamp.
+			int64_t timestamp;
+			/// Sub-data index.
+			uint32_t subDataIndex;
+			/// Entry size.
+			uint32_t size;
+			/// Byte offset of the null-terminated path string within the string blob.
+			uint32_t pathOffset;
+			/// Length of the path string, not including the null terminator.
+			uint32_t pathSize;
+			/// Entry size once decompressed.
+			uint32_t uncompressedSize;
+			/// Compression codec.
+			uint32_t codec;
+		};
+
+		/// In-progress load of entry data.
+		struct EntryLoad
+		{
+			/// Owning cache.
+			const Cache* pCache;
+			/// Buffer in which the loaded data is to be stored.
+			void* pBuffer;
+			/// Number of bytes to store in the output buffer.
+			size_t loadSize;
+
+			/// Stored (compressed) entry data, once read.
+			const uint8_t* pCompressedData;
+			/// Buffer allocated for reading compressed data (null if not reading or reading from the mapped file).
+			uint8_t* pCompressedBuffer;
+			/// Buffer allocated for decompressing into before copying to the output buffer (null if decompressing
+			/// directly into the output buffer).
+			uint8_t* pDecompressedBuffer;
+			/// Size of the stored entry data.
+			uint32_t compressedSize;
+			/// Size of the entry data once decompressed.
+			uint32_t uncompressedSize;
+			/// Compression codec.
+			CacheCompression::ECodec codec;
+
+			/// Async load request ID.
+			size_t asyncLoadId;
+			/// Number of bytes read.
+			size_t bytesRead;
+			/// True if decompression succeeded.
+			bool bDecompressSuccess;
+			/// Set to a non-zero value once decompression has been dispatched.
+			volatile int32_t decompressDispatchCounter;
+			/// Set to a non-zero value once decompression has finished.
+			volatile int32_t decompressFinishCounter;
+		};
+
 		/// Cache entry hash map type.
 		typedef ConcurrentHashMap< EntryKey, Entry*, EntryKeyHash > EntryMapType;
 
@@ -145,20 +284,84 @@ namespace Helium
 		/// Size of the TOC, in bytes.
 		uint32_t m_tocSize;
 
+		/// Read-only mapping of the cache file, if mapped.
+		CacheFileMapping m_cacheFileMapping;
+		/// Read-only mapping of the TOC file, if the cache file is mapped and the TOC is in the compact format.
+		CacheFileMapping m_tocFileMapping;
+
+		/// Compact TOC perfect hash displacement table (null if the TOC is not in the compact format).
+		const int32_t* m_pCompactDisplacements;
+		/// Compact TOC entry records.
+		const CompactTocRecord* m_pCompactRecords;
+		/// Compact TOC path string blob.
+		const char* m_pCompactStrings;
+		/// Number of entries in the compact TOC.
+		uint32_t m_compactEntryCount;
+		/// Size of the compact TOC path string blob, in bytes.
+		uint32_t m_compactStringBlobSize;
+		/// Entries expanded so far from the compact TOC, indexed by record (null for records not yet expanded).
+		Entry* volatile* m_pCompactEntries;
+		/// Lock used to synchronize expansion of compact TOC records into entries.
+		mutable SpinLock m_compactEntryLock;
+
 		/// Cache entry pool.
 		ObjectPool< Entry >* m_pEntryPool;
-		/// Cache entry information.
+		/// Cache entry information (not used for compact TOCs until the cache is modified).
 		DynamicArray< Entry* > m_entries;
-		/// Entry lookup hash map.
-		EntryMapType m_entryMap;
+		/// Entry lookup hash map (for compact TOCs, only holds entries that have been expanded so far).
+		mutable EntryMapType m_entryMap;
+		/// Number of entries cached since the TOC was last committed.
+		size_t m_uncommittedEntryCount;
+
+		/// Compression dictionary shared by all compressed entries.
+		DynamicArray< uint8_t > m_dictionary;
+
+		/// Entry load pool.
+		ObjectPool< EntryLoad > m_entryLoadPool;
+		/// In-progress entry loads.
+		SparseArray< EntryLoad* > m_entryLoads;
+		/// Lock used to synchronize access to entry loads.
+		SpinLock m_entryLoadLock;
 
 		/// @name Loading Utility Functions
 		//@{
 		bool FinalizeTocLoad();
+		bool FinalizeCompactTocLoad( const uint8_t* pToc, size_t tocSize );
+		void ReleaseCompactToc();
+		//@}
+
+		/// @name Compact TOC Support
+		//@{
+		uint32_t FindCompactRecord( AssetPath path, uint32_t subDataIndex ) const;
+		const char* GetCompactRecordPath( uint32_t recordIndex ) const;
+		const Entry* ExpandCompactRecord( uint32_t recordIndex, AssetPath path ) const;
+		bool ExpandCompactToc();
+
+		bool WriteCompactToc( Stream& rStream ) const;
+		void WriteToc( Stream& rStream ) const;
+		//@}
+
+		/// @name Entry Data Utility Functions
+		//@{
+		bool ReadStoredEntryData( Stream& rStream, const Entry& rEntry, DynamicArray< uint8_t >& rData ) const;
+		bool DecompressEntryData( const Entry& rEntry, const uint8_t* pData, DynamicArray< uint8_t >& rOutput ) const;
+		void ReleaseEntryLoad( size_t loadId, EntryLoad* pLoad );
+
+		static void OnEntryReadComplete( void* pUserData, size_t bytesRead );
+		static void DecompressEntryLoad( void* pUserData );
 		//@}
 
 		/// @name Private Static Utility Functions
 		//@{
+		static bool SyncFileData( const String& rFileName );
+		static bool RenameFileAtomic( const String& rSourceFileName, const String& rDestFileName );
+		static void RemoveFile( const String& rFileName );
+
+		static void GetCompactionFileNames(
+			const String& rTocFileName, const String& rCacheFileName, String& rPendingTocFileName,
+			String& rPendingCacheFileName );
+		static bool RecoverCompaction( const String& rTocFileName, const String& rCacheFileName );
+
 		template< typename T > static bool CheckedTocRead(
 			LOAD_VALUE_CALLBACK* pLoadFunction, T& rValue, const char* pDescription, const uint8_t*& rpTocCurrent,
 			const uint8_t* pTocMax );
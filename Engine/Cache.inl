@@ -8,6 +8,16 @@ bool Helium::Cache::IsTocLoaded() const
     return m_bTocLoaded;
 }
 
+/// Get whether the cache file has been memory-mapped for reading.
+///
+/// @return  True if the cache file is mapped, false if not.
+///
+/// @see MapCacheFile(), GetMappedEntryData()
+bool Helium::Cache::IsCacheFileMapped() const
+{
+    return m_cacheFileMapping.IsOpen();
+}
+
 /// Get the name used to identify this cache.
 ///
 /// @return  Cache name.
@@ -51,25 +61,13 @@ const Helium::String& Helium::Cache::GetCacheFileName() const
 /// @see GetEntry()
 uint32_t Helium::Cache::GetEntryCount() const
 {
+    if( m_pCompactRecords )
+    {
+        return m_compactEntryCount;
+    }
+
     size_t entryCount = m_entries.GetSize();
     HELIUM_ASSERT( entryCount <= UINT32_MAX );
 
     return static_cast< uint32_t >( entryCount );
 }
-
-/// Get the information for the cache entry with the specified index.
-///
-/// @param[in] index  Asset entry index.
-///
-/// @return  Asset entry information.
-///
-/// @see GetEntryCount()
-const Helium::Cache::Entry& Helium::Cache::GetEntry( uint32_t index ) const
-{
-    HELIUM_ASSERT( index < m_entries.GetSize() );
-
-    Entry* pEntry = m_entries[ index ];
-    HELIUM_ASSERT( pEntry );
-
-    return *pEntry;
-}
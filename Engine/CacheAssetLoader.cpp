@@ -8,15 +8,22 @@ using namespace Helium;
 /// Constructor.
 CacheAssetLoader::CacheAssetLoader()
 {
+	// Non-tools builds never write to the caches, so they can be mapped and shared with other processes.
+#if HELIUM_TOOLS
+	const bool bMapCacheFiles = false;
+#else
+	const bool bMapCacheFiles = true;
+#endif
+
 	m_pAssetPackageLoader = new CachePackageLoader;
 	HELIUM_ASSERT( m_pAssetPackageLoader );
-	HELIUM_VERIFY( m_pAssetPackageLoader->Initialize( Name( TXT("Asset") ) ) );
+	HELIUM_VERIFY( m_pAssetPackageLoader->Initialize( Name( TXT("Asset") ), bMapCacheFiles ) );
 
 	HELIUM_VERIFY( m_pAssetPackageLoader->BeginPreload() );
 
 	m_pConfigPackageLoader = new CachePackageLoader;
 	HELIUM_ASSERT( m_pConfigPackageLoader );
-	HELIUM_VERIFY( m_pConfigPackageLoader->Initialize( Name( TXT("Config") ) ) );
+	HELIUM_VERIFY( m_pConfigPackageLoader->Initialize( Name( TXT("Config") ), bMapCacheFiles ) );
 
 	HELIUM_VERIFY( m_pConfigPackageLoader->BeginPreload() );
 }
@@ -0,0 +1,731 @@
+#include "EnginePch.h"
+#include "Engine/CacheCompression.h"
+
+#include "zlib/zlib.h"
+
+#include <algorithm>
+
+using namespace Helium;
+
+/// Minimum LZ4 match length.
+static const size_t LZ4_MATCH_SIZE_MIN = 4;
+/// Number of bytes at the end of an LZ4 block that must always be stored as literals.
+static const size_t LZ4_LAST_LITERAL_SIZE = 5;
+/// Minimum distance from the end of an LZ4 block at which the last match can start.
+static const size_t LZ4_MATCH_FIND_LIMIT = 12;
+/// Maximum LZ4 match offset.
+static const size_t LZ4_OFFSET_MAX = 65535;
+/// Number of bits in LZ4 match hash table indices.
+static const uint32_t LZ4_HASH_BITS = 12;
+/// Number of literals scanned without finding a match before the LZ4 compressor begins skipping ahead faster.
+static const uint32_t LZ4_SKIP_TRIGGER = 6;
+
+/// Size of the substrings counted when training a dictionary, in bytes.
+static const size_t TRAINING_KMER_SIZE = 8;
+/// Size of the segments selected for inclusion in a trained dictionary, in bytes.
+static const size_t TRAINING_SEGMENT_SIZE = 64;
+/// Number of bits in dictionary training substring hash table indices.
+static const uint32_t TRAINING_HASH_BITS = 20;
+
+/// Read a 32-bit value from a potentially unaligned address.
+static inline uint32_t ReadUnaligned32( const uint8_t* pData )
+{
+	uint32_t value;
+	MemoryCopy( &value, pData, sizeof( value ) );
+
+	return value;
+}
+
+/// Compute the LZ4 match hash table index for the four bytes at the given address.
+static inline uint32_t HashLz4( const uint8_t* pData )
+{
+	return ( ReadUnaligned32( pData ) * 2654435761U ) >> ( 32 - LZ4_HASH_BITS );
+}
+
+/// Compute the dictionary training hash table index for the substring at the given address.
+static inline uint32_t HashTrainingKmer( const uint8_t* pData )
+{
+	uint64_t value;
+	MemoryCopy( &value, pData, sizeof( value ) );
+	HELIUM_COMPILE_ASSERT( sizeof( value ) == TRAINING_KMER_SIZE );
+
+	return static_cast< uint32_t >( ( value * 0x9e3779b97f4a7c15ULL ) >> ( 64 - TRAINING_HASH_BITS ) );
+}
+
+/// Write an LZ4 length continuation (the part of a length exceeding the 4-bit token field).
+static inline uint8_t* WriteLz4Length( uint8_t* pOutput, size_t length )
+{
+	while( length >= 255 )
+	{
+		*pOutput++ = 255;
+		length -= 255;
+	}
+
+	*pOutput++ = static_cast< uint8_t >( length );
+
+	return pOutput;
+}
+
+/// Read an LZ4 length continuation.
+///
+/// @return  True if successful, false if the input ended before the length.
+static inline bool ReadLz4Length( const uint8_t*& rpInput, const uint8_t* pInputEnd, size_t& rLength )
+{
+	uint8_t value;
+	do
+	{
+		if( rpInput >= pInputEnd )
+		{
+			return false;
+		}
+
+		value = *rpInput++;
+		rLength += value;
+	} while( value == 255 );
+
+	return true;
+}
+
+/// Compress a block of data.
+///
+/// @param[in]  codec           Codec to use.
+/// @param[in]  pSource         Data to compress.
+/// @param[in]  sourceSize      Size of the data to compress, in bytes.
+/// @param[out] rDestination    Compressed data.
+/// @param[in]  pDictionary     Dictionary with which to prime the compressor (can be null).
+/// @param[in]  dictionarySize  Dictionary size, in bytes.
+///
+/// @return  True if successful, false if not.
+///
+/// @see Decompress()
+bool CacheCompression::Compress(
+	ECodec codec,
+	const void* pSource,
+	size_t sourceSize,
+	DynamicArray< uint8_t >& rDestination,
+	const uint8_t* pDictionary,
+	size_t dictionarySize )
+{
+	HELIUM_ASSERT( pSource || sourceSize == 0 );
+	HELIUM_ASSERT( pDictionary || dictionarySize == 0 );
+
+	switch( codec )
+	{
+	case CODEC_NONE:
+		rDestination.Resize( sourceSize );
+		MemoryCopy( rDestination.GetData(), pSource, sourceSize );
+
+		return true;
+
+	case CODEC_LZ4:
+		CompressLz4( pSource, sourceSize, rDestination, pDictionary, dictionarySize );
+
+		return true;
+
+	case CODEC_DEFLATE:
+		return CompressDeflate( pSource, sourceSize, rDestination, pDictionary, dictionarySize );
+
+	default:
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "CacheCompression::Compress(): Invalid codec %" ) PRId32 TXT( ".\n" ),
+			static_cast< int32_t >( codec ) );
+	}
+
+	return false;
+}
+
+/// Decompress a block of data.
+///
+/// @param[in] codec            Codec with which the data was compressed.
+/// @param[in] pSource          Compressed data.
+/// @param[in] sourceSize       Size of the compressed data, in bytes.
+/// @param[in] pDestination     Buffer in which to store the decompressed data.
+/// @param[in] destinationSize  Size of the decompressed data, in bytes.
+/// @param[in] pDictionary      Dictionary with which the data was compressed (can be null).
+/// @param[in] dictionarySize   Dictionary size, in bytes.
+///
+/// @return  True if successful, false if the data is corrupt or does not decompress to exactly the expected size.
+///
+/// @see Compress()
+bool CacheCompression::Decompress(
+	ECodec codec,
+	const void* pSource,
+	size_t sourceSize,
+	void* pDestination,
+	size_t destinationSize,
+	const uint8_t* pDictionary,
+	size_t dictionarySize )
+{
+	HELIUM_ASSERT( pSource || sourceSize == 0 );
+	HELIUM_ASSERT( pDestination || destinationSize == 0 );
+	HELIUM_ASSERT( pDictionary || dictionarySize == 0 );
+
+	switch( codec )
+	{
+	case CODEC_NONE:
+		if( sourceSize != destinationSize )
+		{
+			return false;
+		}
+
+		MemoryCopy( pDestination, pSource, sourceSize );
+
+		return true;
+
+	case CODEC_LZ4:
+		return DecompressLz4( pSource, sourceSize, pDestination, destinationSize, pDictionary, dictionarySize );
+
+	case CODEC_DEFLATE:
+		return DecompressDeflate( pSource, sourceSize, pDestination, destinationSize, pDictionary, dictionarySize );
+
+	default:
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "CacheCompression::Decompress(): Invalid codec %" ) PRId32 TXT( ".\n" ),
+			static_cast< int32_t >( codec ) );
+	}
+
+	return false;
+}
+
+/// Build a compression dictionary from a set of sample data.
+///
+/// Substrings are counted by the number of samples in which they occur, and fixed-size segments of the samples are
+/// then picked greedily by the total count of the substrings they contain (with the substrings of each picked segment
+/// no longer counted towards the remaining segments).  The best segments are placed at the end of the dictionary,
+/// where they can be referenced with the shortest match offsets.
+///
+/// @param[in]  rSamples           Sample data.  Only up to DICTIONARY_SAMPLE_SIZE_MAX bytes, spread evenly across the
+///                                samples, are used.
+/// @param[in]  dictionarySizeMax  Maximum dictionary size (clamped to DICTIONARY_SIZE_MAX).
+/// @param[out] rDictionary        Trained dictionary.  This will be empty if no substrings are shared between
+///                                samples.
+void CacheCompression::TrainDictionary(
+	const DynamicArray< DynamicArray< uint8_t > >& rSamples,
+	size_t dictionarySizeMax,
+	DynamicArray< uint8_t >& rDictionary )
+{
+	rDictionary.Resize( 0 );
+
+	dictionarySizeMax = Min( dictionarySizeMax, DICTIONARY_SIZE_MAX );
+
+	size_t sampleCount = rSamples.GetSize();
+	size_t totalSampleSize = 0;
+	for( size_t sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex )
+	{
+		totalSampleSize += rSamples[ sampleIndex ].GetSize();
+	}
+
+	size_t sampleStride = totalSampleSize / DICTIONARY_SAMPLE_SIZE_MAX + 1;
+
+	// Count the number of samples in which each substring occurs.
+	const size_t hashTableSize = static_cast< size_t >( 1 ) << TRAINING_HASH_BITS;
+
+	DynamicArray< uint32_t > kmerCounts;
+	kmerCounts.Resize( hashTableSize );
+	DynamicArray< uint32_t > kmerLastSamples;
+	kmerLastSamples.Resize( hashTableSize );
+	for( size_t hashIndex = 0; hashIndex < hashTableSize; ++hashIndex )
+	{
+		kmerCounts[ hashIndex ] = 0;
+		SetInvalid( kmerLastSamples[ hashIndex ] );
+	}
+
+	for( size_t sampleIndex = 0; sampleIndex < sampleCount; sampleIndex += sampleStride )
+	{
+		const DynamicArray< uint8_t >& rSample = rSamples[ sampleIndex ];
+		size_t sampleSize = rSample.GetSize();
+		if( sampleSize < TRAINING_KMER_SIZE )
+		{
+			continue;
+		}
+
+		const uint8_t* pSampleData = rSample.GetData();
+		for( size_t offset = 0; offset <= sampleSize - TRAINING_KMER_SIZE; ++offset )
+		{
+			uint32_t hashIndex = HashTrainingKmer( pSampleData + offset );
+			if( kmerLastSamples[ hashIndex ] != static_cast< uint32_t >( sampleIndex ) )
+			{
+				kmerLastSamples[ hashIndex ] = static_cast< uint32_t >( sampleIndex );
+				++kmerCounts[ hashIndex ];
+			}
+		}
+	}
+
+	// Substrings found in only one sample are of no use to other entries.
+	for( size_t hashIndex = 0; hashIndex < hashTableSize; ++hashIndex )
+	{
+		if( kmerCounts[ hashIndex ] < 2 )
+		{
+			kmerCounts[ hashIndex ] = 0;
+		}
+	}
+
+	// Score each candidate segment, keeping them in a max-heap of (score, candidate index) pairs.
+	DynamicArray< uint32_t > candidateSamples;
+	DynamicArray< uint32_t > candidateOffsets;
+	DynamicArray< uint64_t > candidateHeap;
+	for( size_t sampleIndex = 0; sampleIndex < sampleCount; sampleIndex += sampleStride )
+	{
+		const DynamicArray< uint8_t >& rSample = rSamples[ sampleIndex ];
+		size_t sampleSize = rSample.GetSize();
+		const uint8_t* pSampleData = rSample.GetData();
+		for( size_t offset = 0; offset + TRAINING_SEGMENT_SIZE <= sampleSize; offset += TRAINING_SEGMENT_SIZE )
+		{
+			uint64_t score = 0;
+			for( size_t kmerOffset = 0; kmerOffset <= TRAINING_SEGMENT_SIZE - TRAINING_KMER_SIZE; ++kmerOffset )
+			{
+				score += kmerCounts[ HashTrainingKmer( pSampleData + offset + kmerOffset ) ];
+			}
+
+			if( score != 0 )
+			{
+				uint64_t candidateIndex = candidateSamples.GetSize();
+				candidateSamples.Push( static_cast< uint32_t >( sampleIndex ) );
+				candidateOffsets.Push( static_cast< uint32_t >( offset ) );
+				candidateHeap.Push( ( Min< uint64_t >( score, UINT32_MAX ) << 32 ) | candidateIndex );
+			}
+		}
+	}
+
+	uint64_t* pHeapBegin = candidateHeap.GetData();
+	size_t heapSize = candidateHeap.GetSize();
+	std::make_heap( pHeapBegin, pHeapBegin + heapSize );
+
+	// Pick segments.  Scores only ever decrease as segments are picked, so a candidate whose updated score is still at
+	// least that of the next best candidate can be picked without rescoring any others.
+	DynamicArray< uint32_t > pickedCandidates;
+	size_t pickedSize = 0;
+	while( heapSize != 0 && pickedSize + TRAINING_SEGMENT_SIZE <= dictionarySizeMax )
+	{
+		std::pop_heap( pHeapBegin, pHeapBegin + heapSize );
+		--heapSize;
+
+		uint32_t candidateIndex = static_cast< uint32_t >( pHeapBegin[ heapSize ] );
+		const uint8_t* pSegment =
+			rSamples[ candidateSamples[ candidateIndex ] ].GetData() + candidateOffsets[ candidateIndex ];
+
+		uint64_t score = 0;
+		for( size_t kmerOffset = 0; kmerOffset <= TRAINING_SEGMENT_SIZE - TRAINING_KMER_SIZE; ++kmerOffset )
+		{
+			score += kmerCounts[ HashTrainingKmer( pSegment + kmerOffset ) ];
+		}
+
+		if( score == 0 )
+		{
+			continue;
+		}
+
+		if( heapSize != 0 && score < ( pHeapBegin[ 0 ] >> 32 ) )
+		{
+			pHeapBegin[ heapSize ] = ( score << 32 ) | candidateIndex;
+			++heapSize;
+			std::push_heap( pHeapBegin, pHeapBegin + heapSize );
+
+			continue;
+		}
+
+		pickedCandidates.Push( candidateIndex );
+		pickedSize += TRAINING_SEGMENT_SIZE;
+
+		for( size_t kmerOffset = 0; kmerOffset <= TRAINING_SEGMENT_SIZE - TRAINING_KMER_SIZE; ++kmerOffset )
+		{
+			kmerCounts[ HashTrainingKmer( pSegment + kmerOffset ) ] = 0;
+		}
+	}
+
+	// Store the picked segments with the best last.
+	rDictionary.Resize( pickedSize );
+	uint8_t* pDictionaryData = rDictionary.GetData();
+	size_t pickedCount = pickedCandidates.GetSize();
+	for( size_t pickedIndex = 0; pickedIndex < pickedCount; ++pickedIndex )
+	{
+		uint32_t candidateIndex = pickedCandidates[ pickedIndex ];
+		MemoryCopy(
+			pDictionaryData + pickedSize - ( pickedIndex + 1 ) * TRAINING_SEGMENT_SIZE,
+			rSamples[ candidateSamples[ candidateIndex ] ].GetData() + candidateOffsets[ candidateIndex ],
+			TRAINING_SEGMENT_SIZE );
+	}
+}
+
+/// Compress a block of data in the LZ4 block format.
+///
+/// Matches are found using a single-entry hash table of previous positions.  If a dictionary is given, it is treated
+/// as data immediately preceding the source data, so matches can reference it.
+///
+/// @param[in]  pSource         Data to compress.
+/// @param[in]  sourceSize      Size of the data to compress, in bytes.
+/// @param[out] rDestination    Compressed data.
+/// @param[in]  pDictionary     Dictionary (can be null).
+/// @param[in]  dictionarySize  Dictionary size, in bytes.
+void CacheCompression::CompressLz4(
+	const void* pSource,
+	size_t sourceSize,
+	DynamicArray< uint8_t >& rDestination,
+	const uint8_t* pDictionary,
+	size_t dictionarySize )
+{
+	// Only the part of the dictionary within match range of the source data can be used.
+	if( dictionarySize > LZ4_OFFSET_MAX )
+	{
+		pDictionary += dictionarySize - LZ4_OFFSET_MAX;
+		dictionarySize = LZ4_OFFSET_MAX;
+	}
+
+	// Matches are found within a single buffer holding the dictionary followed by the source data.
+	DynamicArray< uint8_t > combinedBuffer;
+	const uint8_t* pBase = static_cast< const uint8_t* >( pSource );
+	if( dictionarySize != 0 )
+	{
+		combinedBuffer.Resize( dictionarySize + sourceSize );
+		MemoryCopy( combinedBuffer.GetData(), pDictionary, dictionarySize );
+		MemoryCopy( combinedBuffer.GetData() + dictionarySize, pSource, sourceSize );
+		pBase = combinedBuffer.GetData();
+	}
+
+	size_t inputEnd = dictionarySize + sourceSize;
+
+	// Allocate for the worst case (incompressible data).
+	rDestination.Resize( sourceSize + sourceSize / 255 + 16 );
+	uint8_t* pOutputBegin = rDestination.GetData();
+	uint8_t* pOutput = pOutputBegin;
+
+	size_t anchor = dictionarySize;
+	if( sourceSize > LZ4_MATCH_FIND_LIMIT )
+	{
+		const size_t hashTableSize = static_cast< size_t >( 1 ) << LZ4_HASH_BITS;
+
+		DynamicArray< uint32_t > hashTable;
+		hashTable.Resize( hashTableSize );
+		for( size_t hashIndex = 0; hashIndex < hashTableSize; ++hashIndex )
+		{
+			SetInvalid( hashTable[ hashIndex ] );
+		}
+
+		if( dictionarySize >= LZ4_MATCH_SIZE_MIN )
+		{
+			for( size_t position = 0; position <= dictionarySize - LZ4_MATCH_SIZE_MIN; ++position )
+			{
+				hashTable[ HashLz4( pBase + position ) ] = static_cast< uint32_t >( position );
+			}
+		}
+
+		size_t matchLimit = inputEnd - LZ4_LAST_LITERAL_SIZE;
+		size_t findLimit = inputEnd - LZ4_MATCH_FIND_LIMIT;
+
+		size_t position = dictionarySize;
+		uint32_t missCount = 0;
+		while( position < findLimit )
+		{
+			uint32_t hashIndex = HashLz4( pBase + position );
+			size_t matchPosition = hashTable[ hashIndex ];
+			hashTable[ hashIndex ] = static_cast< uint32_t >( position );
+
+			if( IsInvalid( static_cast< uint32_t >( matchPosition ) ) ||
+				position - matchPosition > LZ4_OFFSET_MAX ||
+				ReadUnaligned32( pBase + matchPosition ) != ReadUnaligned32( pBase + position ) )
+			{
+				// Skip ahead faster through data that does not appear to compress.
+				position += 1 + ( missCount++ >> LZ4_SKIP_TRIGGER );
+
+				continue;
+			}
+
+			missCount = 0;
+
+			// Extend the match backward into any pending literals, then forward.
+			while( position > anchor && matchPosition > 0 && pBase[ position - 1 ] == pBase[ matchPosition - 1 ] )
+			{
+				--position;
+				--matchPosition;
+			}
+
+			size_t matchSize = LZ4_MATCH_SIZE_MIN;
+			while( position + matchSize < matchLimit && pBase[ matchPosition + matchSize ] == pBase[ position + matchSize ] )
+			{
+				++matchSize;
+			}
+
+			// Write the sequence.
+			size_t literalSize = position - anchor;
+			uint8_t* pToken = pOutput++;
+			if( literalSize >= 15 )
+			{
+				*pToken = 15 << 4;
+				pOutput = WriteLz4Length( pOutput, literalSize - 15 );
+			}
+			else
+			{
+				*pToken = static_cast< uint8_t >( literalSize << 4 );
+			}
+
+			MemoryCopy( pOutput, pBase + anchor, literalSize );
+			pOutput += literalSize;
+
+			size_t offset = position - matchPosition;
+			*pOutput++ = static_cast< uint8_t >( offset );
+			*pOutput++ = static_cast< uint8_t >( offset >> 8 );
+
+			size_t matchSizeCode = matchSize - LZ4_MATCH_SIZE_MIN;
+			if( matchSizeCode >= 15 )
+			{
+				*pToken |= 15;
+				pOutput = WriteLz4Length( pOutput, matchSizeCode - 15 );
+			}
+			else
+			{
+				*pToken |= static_cast< uint8_t >( matchSizeCode );
+			}
+
+			position += matchSize;
+			anchor = position;
+
+			// Record a position within the match so that runs of similar data continue to find matches.
+			if( position < findLimit )
+			{
+				hashTable[ HashLz4( pBase + position - 2 ) ] = static_cast< uint32_t >( position - 2 );
+			}
+		}
+	}
+
+	// Write the remaining data as literals.
+	size_t literalSize = inputEnd - anchor;
+	uint8_t* pToken = pOutput++;
+	if( literalSize >= 15 )
+	{
+		*pToken = 15 << 4;
+		pOutput = WriteLz4Length( pOutput, literalSize - 15 );
+	}
+	else
+	{
+		*pToken = static_cast< uint8_t >( literalSize << 4 );
+	}
+
+	MemoryCopy( pOutput, pBase + anchor, literalSize );
+	pOutput += literalSize;
+
+	size_t compressedSize = static_cast< size_t >( pOutput - pOutputBegin );
+	HELIUM_ASSERT( compressedSize <= rDestination.GetSize() );
+	rDestination.Resize( compressedSize );
+}
+
+/// Decompress a block of data in the LZ4 block format.
+///
+/// All reads and writes are bounds checked, so corrupt data is detected rather than causing memory to be overrun.
+///
+/// @param[in] pSource          Compressed data.
+/// @param[in] sourceSize       Size of the compressed data, in bytes.
+/// @param[in] pDestination     Buffer in which to store the decompressed data.
+/// @param[in] destinationSize  Size of the decompressed data, in bytes.
+/// @param[in] pDictionary      Dictionary with which the data was compressed (can be null).
+/// @param[in] dictionarySize   Dictionary size, in bytes.
+///
+/// @return  True if successful, false if not.
+bool CacheCompression::DecompressLz4(
+	const void* pSource,
+	size_t sourceSize,
+	void* pDestination,
+	size_t destinationSize,
+	const uint8_t* pDictionary,
+	size_t dictionarySize )
+{
+	const uint8_t* pInput = static_cast< const uint8_t* >( pSource );
+	const uint8_t* pInputEnd = pInput + sourceSize;
+	uint8_t* pOutputBegin = static_cast< uint8_t* >( pDestination );
+	uint8_t* pOutput = pOutputBegin;
+	uint8_t* pOutputEnd = pOutputBegin + destinationSize;
+
+	for( ; ; )
+	{
+		if( pInput >= pInputEnd )
+		{
+			return false;
+		}
+
+		uint8_t token = *pInput++;
+
+		// Copy literals.
+		size_t literalSize = token >> 4;
+		if( literalSize == 15 && !ReadLz4Length( pInput, pInputEnd, literalSize ) )
+		{
+			return false;
+		}
+
+		if( literalSize > static_cast< size_t >( pInputEnd - pInput ) ||
+			literalSize > static_cast< size_t >( pOutputEnd - pOutput ) )
+		{
+			return false;
+		}
+
+		MemoryCopy( pOutput, pInput, literalSize );
+		pInput += literalSize;
+		pOutput += literalSize;
+
+		// The last sequence has no match.
+		if( pInput == pInputEnd )
+		{
+			break;
+		}
+
+		if( pInputEnd - pInput < 2 )
+		{
+			return false;
+		}
+
+		size_t offset = pInput[ 0 ] | ( static_cast< size_t >( pInput[ 1 ] ) << 8 );
+		pInput += 2;
+
+		size_t matchSize = token & 15;
+		if( matchSize == 15 && !ReadLz4Length( pInput, pInputEnd, matchSize ) )
+		{
+			return false;
+		}
+
+		matchSize += LZ4_MATCH_SIZE_MIN;
+
+		size_t outputSize = static_cast< size_t >( pOutput - pOutputBegin );
+		if( offset == 0 || offset > outputSize + dictionarySize ||
+			matchSize > static_cast< size_t >( pOutputEnd - pOutput ) )
+		{
+			return false;
+		}
+
+		// Copy any part of the match that lies within the dictionary first.
+		const uint8_t* pMatch;
+		if( offset > outputSize )
+		{
+			size_t dictionaryOffset = offset - outputSize;
+			size_t copySize = Min( matchSize, dictionaryOffset );
+			MemoryCopy( pOutput, pDictionary + dictionarySize - dictionaryOffset, copySize );
+			pOutput += copySize;
+			matchSize -= copySize;
+
+			pMatch = pOutputBegin;
+		}
+		else
+		{
+			pMatch = pOutput - offset;
+		}
+
+		// Matches can overlap the data they produce, in which case they must be copied a byte at a time.
+		if( static_cast< size_t >( pOutput - pMatch ) >= matchSize )
+		{
+			MemoryCopy( pOutput, pMatch, matchSize );
+			pOutput += matchSize;
+		}
+		else
+		{
+			for( size_t byteIndex = 0; byteIndex < matchSize; ++byteIndex )
+			{
+				*pOutput++ = *pMatch++;
+			}
+		}
+	}
+
+	return ( pOutput == pOutputEnd );
+}
+
+/// Compress a block of data as a zlib stream.
+///
+/// @param[in]  pSource         Data to compress.
+/// @param[in]  sourceSize      Size of the data to compress, in bytes.
+/// @param[out] rDestination    Compressed data.
+/// @param[in]  pDictionary     Preset dictionary (can be null).
+/// @param[in]  dictionarySize  Dictionary size, in bytes.
+///
+/// @return  True if successful, false if not.
+bool CacheCompression::CompressDeflate(
+	const void* pSource,
+	size_t sourceSize,
+	DynamicArray< uint8_t >& rDestination,
+	const uint8_t* pDictionary,
+	size_t dictionarySize )
+{
+	HELIUM_ASSERT( sourceSize <= UINT32_MAX );
+
+	z_stream stream;
+	MemoryZero( &stream, sizeof( stream ) );
+	if( deflateInit( &stream, Z_BEST_COMPRESSION ) != Z_OK )
+	{
+		return false;
+	}
+
+	if( dictionarySize != 0 &&
+		deflateSetDictionary( &stream, pDictionary, static_cast< uInt >( dictionarySize ) ) != Z_OK )
+	{
+		deflateEnd( &stream );
+
+		return false;
+	}
+
+	rDestination.Resize( deflateBound( &stream, static_cast< uLong >( sourceSize ) ) );
+
+	stream.next_in = static_cast< Bytef* >( const_cast< void* >( pSource ) );
+	stream.avail_in = static_cast< uInt >( sourceSize );
+	stream.next_out = rDestination.GetData();
+	stream.avail_out = static_cast< uInt >( rDestination.GetSize() );
+
+	int result = deflate( &stream, Z_FINISH );
+	size_t compressedSize = stream.total_out;
+	deflateEnd( &stream );
+
+	if( result != Z_STREAM_END )
+	{
+		rDestination.Resize( 0 );
+
+		return false;
+	}
+
+	rDestination.Resize( compressedSize );
+
+	return true;
+}
+
+/// Decompress a zlib stream.
+///
+/// @param[in] pSource          Compressed data.
+/// @param[in] sourceSize       Size of the compressed data, in bytes.
+/// @param[in] pDestination     Buffer in which to store the decompressed data.
+/// @param[in] destinationSize  Size of the decompressed data, in bytes.
+/// @param[in] pDictionary      Preset dictionary with which the data was compressed (can be null).
+/// @param[in] dictionarySize   Dictionary size, in bytes.
+///
+/// @return  True if successful, false if not.
+bool CacheCompression::DecompressDeflate(
+	const void* pSource,
+	size_t sourceSize,
+	void* pDestination,
+	size_t destinationSize,
+	const uint8_t* pDictionary,
+	size_t dictionarySize )
+{
+	HELIUM_ASSERT( sourceSize <= UINT32_MAX );
+	HELIUM_ASSERT( destinationSize <= UINT32_MAX );
+
+	z_stream stream;
+	MemoryZero( &stream, sizeof( stream ) );
+	if( inflateInit( &stream ) != Z_OK )
+	{
+		return false;
+	}
+
+	stream.next_in = static_cast< Bytef* >( const_cast< void* >( pSource ) );
+	stream.avail_in = static_cast< uInt >( sourceSize );
+	stream.next_out = static_cast< Bytef* >( pDestination );
+	stream.avail_out = static_cast< uInt >( destinationSize );
+
+	int result = inflate( &stream, Z_FINISH );
+	if( result == Z_NEED_DICT && dictionarySize != 0 )
+	{
+		if( inflateSetDictionary( &stream, pDictionary, static_cast< uInt >( dictionarySize ) ) == Z_OK )
+		{
+			result = inflate( &stream, Z_FINISH );
+		}
+	}
+
+	bool bSuccess = ( result == Z_STREAM_END && stream.total_out == destinationSize );
+	inflateEnd( &stream );
+
+	return bSuccess;
+}
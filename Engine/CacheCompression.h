@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Foundation/DynamicArray.h"
+
+#include "Engine/Engine.h"
+
+namespace Helium
+{
+	/// Compression of cache entry data.
+	///
+	/// Two codecs are provided: an LZ4 block codec for frequently loaded data, where decompression speed matters most,
+	/// and deflate for bulk data that is loaded less often, where the reduction in I/O matters most.  Both can be
+	/// primed with a shared dictionary trained on typical entry data (see TrainDictionary()), which greatly improves
+	/// the compression of small entries such as serialized property data.
+	///
+	/// Decompression of entries being loaded is run through the TaskDispatcher, allowing it to be spread across worker
+	/// threads.
+	class HELIUM_ENGINE_API CacheCompression
+	{
+	public:
+		/// Compression codecs.
+		enum ECodec
+		{
+			CODEC_FIRST   =  0,
+			CODEC_INVALID = -1,
+
+			/// Uncompressed.
+			CODEC_NONE,
+			/// LZ4 block format.
+			CODEC_LZ4,
+			/// Deflate (zlib stream).
+			CODEC_DEFLATE,
+
+			CODEC_MAX,
+			CODEC_LAST = CODEC_MAX - 1
+		};
+
+		/// Maximum dictionary size, in bytes (the deflate window size).
+		static const size_t DICTIONARY_SIZE_MAX = 32 * 1024;
+		/// Maximum total size of the samples used for training a dictionary, in bytes.
+		static const size_t DICTIONARY_SAMPLE_SIZE_MAX = 16 * 1024 * 1024;
+
+		/// @name Compression
+		//@{
+		static bool Compress(
+			ECodec codec, const void* pSource, size_t sourceSize, DynamicArray< uint8_t >& rDestination,
+			const uint8_t* pDictionary, size_t dictionarySize );
+		static bool Decompress(
+			ECodec codec, const void* pSource, size_t sourceSize, void* pDestination, size_t destinationSize,
+			const uint8_t* pDictionary, size_t dictionarySize );
+		//@}
+
+		/// @name Dictionary Training
+		//@{
+		static void TrainDictionary(
+			const DynamicArray< DynamicArray< uint8_t > >& rSamples, size_t dictionarySizeMax,
+			DynamicArray< uint8_t >& rDictionary );
+		//@}
+
+	private:
+		/// @name LZ4 Block Format Support
+		//@{
+		static void CompressLz4(
+			const void* pSource, size_t sourceSize, DynamicArray< uint8_t >& rDestination, const uint8_t* pDictionary,
+			size_t dictionarySize );
+		static bool DecompressLz4(
+			const void* pSource, size_t sourceSize, void* pDestination, size_t destinationSize,
+			const uint8_t* pDictionary, size_t dictionarySize );
+		//@}
+
+		/// @name Deflate Support
+		//@{
+		static bool CompressDeflate(
+			const void* pSource, size_t sourceSize, DynamicArray< uint8_t >& rDestination, const uint8_t* pDictionary,
+			size_t dictionarySize );
+		static bool DecompressDeflate(
+			const void* pSource, size_t sourceSize, void* pDestination, size_t destinationSize,
+			const uint8_t* pDictionary, size_t dictionarySize );
+		//@}
+	};
+}
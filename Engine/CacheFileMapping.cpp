@@ -0,0 +1,191 @@
+#include "EnginePch.h"
+#include "Engine/CacheFileMapping.h"
+
+#if HELIUM_OS_WIN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace Helium;
+
+/// Constructor.
+CacheFileMapping::CacheFileMapping()
+: m_pData( NULL )
+, m_size( 0 )
+#if HELIUM_OS_WIN
+, m_hMapping( NULL )
+#endif
+{
+}
+
+/// Destructor.
+CacheFileMapping::~CacheFileMapping()
+{
+	Close();
+}
+
+/// Map the contents of a file into memory for reading.
+///
+/// @param[in] rFileName  Name of the file to map.
+///
+/// @return  True if the file was mapped successfully, false if not (including if the file is empty).
+///
+/// @see Close()
+bool CacheFileMapping::Open( const String& rFileName )
+{
+	Close();
+
+#if HELIUM_OS_WIN
+	HANDLE hFile = CreateFileA(
+		rFileName.GetData(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		NULL,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		NULL );
+	if( hFile == INVALID_HANDLE_VALUE )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "CacheFileMapping::Open(): Failed to open \"%s\".\n" ), *rFileName );
+
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if( !GetFileSizeEx( hFile, &fileSize ) || fileSize.QuadPart == 0 )
+	{
+		CloseHandle( hFile );
+
+		return false;
+	}
+
+	// The mapping object keeps the file open, so the file handle itself is no longer needed once it exists.
+	HANDLE hMapping = CreateFileMappingA( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+	CloseHandle( hFile );
+	if( !hMapping )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "CacheFileMapping::Open(): Failed to map \"%s\".\n" ), *rFileName );
+
+		return false;
+	}
+
+	void* pData = MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 );
+	if( !pData )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "CacheFileMapping::Open(): Failed to map \"%s\".\n" ), *rFileName );
+		CloseHandle( hMapping );
+
+		return false;
+	}
+
+	m_hMapping = hMapping;
+	m_size = static_cast< uint64_t >( fileSize.QuadPart );
+#else
+	int fileDescriptor = open( rFileName.GetData(), O_RDONLY );
+	if( fileDescriptor < 0 )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "CacheFileMapping::Open(): Failed to open \"%s\".\n" ), *rFileName );
+
+		return false;
+	}
+
+	struct stat fileStatus;
+	if( fstat( fileDescriptor, &fileStatus ) != 0 || fileStatus.st_size <= 0 )
+	{
+		close( fileDescriptor );
+
+		return false;
+	}
+
+	// Shared read-only mappings reference the page cache directly, so the file contents are never copied into
+	// process-private memory.  The mapping remains valid after the descriptor is closed.
+	size_t fileSize = static_cast< size_t >( fileStatus.st_size );
+	void* pData = mmap( NULL, fileSize, PROT_READ, MAP_SHARED, fileDescriptor, 0 );
+	close( fileDescriptor );
+	if( pData == MAP_FAILED )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "CacheFileMapping::Open(): Failed to map \"%s\".\n" ), *rFileName );
+
+		return false;
+	}
+
+	m_size = static_cast< uint64_t >( fileSize );
+#endif
+
+	m_pData = static_cast< const uint8_t* >( pData );
+
+	return true;
+}
+
+/// Unmap the currently mapped file, if any.
+///
+/// @see Open()
+void CacheFileMapping::Close()
+{
+	if( !m_pData )
+	{
+		return;
+	}
+
+#if HELIUM_OS_WIN
+	UnmapViewOfFile( m_pData );
+	CloseHandle( m_hMapping );
+	m_hMapping = NULL;
+#else
+	munmap( const_cast< uint8_t* >( m_pData ), static_cast< size_t >( m_size ) );
+#endif
+
+	m_pData = NULL;
+	m_size = 0;
+}
+
+/// Hint that the mapping will be accessed in no particular order.
+///
+/// This disables speculative readahead around each page fault, as objects are loaded on demand rather than by
+/// sweeping through the file.  Readahead of the data actually needed is requested with AdviseWillNeed() instead.
+///
+/// @see AdviseWillNeed()
+void CacheFileMapping::AdviseRandomAccess() const
+{
+#if !HELIUM_OS_WIN
+	if( m_pData )
+	{
+		madvise( const_cast< uint8_t* >( m_pData ), static_cast< size_t >( m_size ), MADV_RANDOM );
+	}
+#endif
+}
+
+/// Hint that a range of the mapping will be accessed soon, allowing the system to start reading it in
+/// asynchronously.
+///
+/// @param[in] offset  Byte offset of the range within the file.
+/// @param[in] size    Size of the range, in bytes.
+///
+/// @see AdviseRandomAccess()
+void CacheFileMapping::AdviseWillNeed( uint64_t offset, uint64_t size ) const
+{
+#if !HELIUM_OS_WIN
+	if( !m_pData || offset >= m_size || size == 0 )
+	{
+		return;
+	}
+
+	size = Min( size, m_size - offset );
+
+	// madvise() requires a page-aligned start address.
+	static const uint64_t pageSize = static_cast< uint64_t >( sysconf( _SC_PAGESIZE ) );
+	uint64_t alignedOffset = offset - offset % pageSize;
+
+	madvise(
+		const_cast< uint8_t* >( m_pData + alignedOffset ),
+		static_cast< size_t >( size + ( offset - alignedOffset ) ),
+		MADV_WILLNEED );
+#else
+	HELIUM_UNREF( offset );
+	HELIUM_UNREF( size );
+#endif
+}
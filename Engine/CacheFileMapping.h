@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Foundation/String.h"
+
+#include "Engine/Engine.h"
+
+namespace Helium
+{
+	/// Read-only memory mapping of a cache file.
+	///
+	/// Mapped pages are backed directly by the operating system file cache, so any number of processes mapping the same
+	/// cache file share a single copy of its contents in memory.
+	class HELIUM_ENGINE_API CacheFileMapping : NonCopyable
+	{
+	public:
+		/// @name Construction/Destruction
+		//@{
+		CacheFileMapping();
+		~CacheFileMapping();
+		//@}
+
+		/// @name Mapping
+		//@{
+		bool Open( const String& rFileName );
+		void Close();
+		inline bool IsOpen() const;
+		//@}
+
+		/// @name Data Access
+		//@{
+		inline const uint8_t* GetData() const;
+		inline uint64_t GetSize() const;
+		//@}
+
+		/// @name Paging Hints
+		//@{
+		void AdviseRandomAccess() const;
+		void AdviseWillNeed( uint64_t offset, uint64_t size ) const;
+		//@}
+
+	private:
+		/// Base address of the mapped file contents.
+		const uint8_t* m_pData;
+		/// Size of the mapped file contents, in bytes.
+		uint64_t m_size;
+
+#if HELIUM_OS_WIN
+		/// File mapping object handle.
+		void* m_hMapping;
+#endif
+	};
+}
+
+#include "Engine/CacheFileMapping.inl"
@@ -0,0 +1,29 @@
+/// Get whether a file is currently mapped.
+///
+/// @return  True if a file is mapped, false if not.
+///
+/// @see Open(), Close()
+bool Helium::CacheFileMapping::IsOpen() const
+{
+    return ( m_pData != NULL );
+}
+
+/// Get the base address of the mapped file contents.
+///
+/// @return  Mapped file contents, or null if no file is mapped.
+///
+/// @see GetSize()
+const uint8_t* Helium::CacheFileMapping::GetData() const
+{
+    return m_pData;
+}
+
+/// Get the size of the mapped file contents.
+///
+/// @return  Mapped size, in bytes.
+///
+/// @see GetData()
+uint64_t Helium::CacheFileMapping::GetSize() const
+{
+    return m_size;
+}
@@ -93,6 +93,41 @@ Cache* CacheManager::GetCache( Name name, Cache::EPlatform platform )
 	return pCache;
 }
 
+/// Compact every cache that has been opened through this manager, for all platforms.
+///
+/// This is an offline operation (see Cache::Compact()), and should only be run once all caching is done, such as at
+/// the end of a cook.
+///
+/// @param[in] bTrainDictionaries  True to train a new compression dictionary for each cache as it is compacted.
+///
+/// @return  True if all caches were compacted successfully, false if any failed.
+bool CacheManager::CompactCaches( bool bTrainDictionaries )
+{
+	bool bSuccess = true;
+
+	for( size_t platformIndex = 0; platformIndex < static_cast< size_t >( Cache::PLATFORM_MAX ); ++platformIndex )
+	{
+		ConcurrentHashMap< Name, Cache* >::ConstAccessor cacheAccessor;
+		if( m_cacheMaps[ platformIndex ].First( cacheAccessor ) )
+		{
+			do
+			{
+				Cache* pCache = cacheAccessor->Second();
+				HELIUM_ASSERT( pCache );
+
+				if( !pCache->Compact( bTrainDictionaries ) )
+				{
+					bSuccess = false;
+				}
+
+				++cacheAccessor;
+			} while( cacheAccessor.IsValid() );
+		}
+	}
+
+	return bSuccess;
+}
+
 /// Get the cache data directory for the specified platform.
 ///
 /// @param[in] platform  Target platform, or Cache::PLATFORM_INVALID name to use the current platform.
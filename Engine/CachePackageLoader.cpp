@@ -6,6 +6,7 @@
 #include "Engine/AsyncLoader.h"
 #include "Engine/CacheManager.h"
 #include "Engine/Resource.h"
+#include "Engine/TaskDispatcher.h"
 
 using namespace Helium;
 
@@ -25,12 +26,15 @@ CachePackageLoader::~CachePackageLoader()
 
 /// Initialize this package loader for loading from the specified cache files.
 ///
-/// @param[in] cacheName  Name of the cache to use.
+/// @param[in] cacheName      Name of the cache to use.
+/// @param[in] bMapCacheFile  True to memory-map the cache file and deserialize objects directly from it, false to read
+///                           object data into temporary buffers.  If the cache file cannot be mapped, object data will
+///                           be read into buffers instead.
 ///
 /// @return  True if initialization was successful, false if not.
 ///
 /// @see Shutdown()
-bool CachePackageLoader::Initialize( Name cacheName )
+bool CachePackageLoader::Initialize( Name cacheName, bool bMapCacheFile )
 {
 	HELIUM_ASSERT( !cacheName.IsEmpty() );
 
@@ -50,6 +54,14 @@ bool CachePackageLoader::Initialize( Name cacheName )
 		return false;
 	}
 
+	if( bMapCacheFile && !m_pCache->MapCacheFile() )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Warning,
+			TXT( "CachePackageLoader::Initialize(): Failed to map cache \"%s\".  Using buffered reads instead.\n" ),
+			*cacheName );
+	}
+
 	return true;
 }
 
@@ -60,8 +72,6 @@ void CachePackageLoader::Shutdown()
 {
 	DefaultAllocator allocator;
 
-	AsyncLoader& rAsyncLoader = AsyncLoader::GetStaticInstance();
-
 	size_t loadRequestCount = m_loadRequests.GetSize();
 	for( size_t requestIndex = 0; requestIndex < loadRequestCount; ++requestIndex )
 	{
@@ -69,9 +79,35 @@ void CachePackageLoader::Shutdown()
 		{
 			LoadRequest* pRequest = m_loadRequests[ requestIndex ];
 			HELIUM_ASSERT( pRequest );
+
+			// Deserialization tasks read from the request buffers, so let any in progress finish first.  Help run
+			// pending tasks where possible (the task may be queued behind this thread), otherwise sleep until the
+			// task reports progress.
+			AsyncLoader& rAsyncLoader = AsyncLoader::GetStaticInstance();
+			for( ; ; )
+			{
+				uint32_t progressCount = rAsyncLoader.GetProgressCount();
+				if( pRequest->deserializeState != DESERIALIZE_STATE_PENDING )
+				{
+					break;
+				}
+
+				if( TaskDispatcher::TryRunPendingTask() )
+				{
+					continue;
+				}
+
+				rAsyncLoader.WaitForProgress( progressCount, AssetLoader::FINISH_LOAD_TICK_INTERVAL );
+			}
+
+			pRequest->spDeserializedObject.Release();
+			pRequest->spDeserializedResourceData.Release();
+			pRequest->deferredResolver.Clear();
+
 			if( IsValid( pRequest->asyncLoadId ) )
 			{
-				rAsyncLoader.SyncRequest( pRequest->asyncLoadId );
+				HELIUM_ASSERT( m_pCache );
+				m_pCache->SyncLoadEntry( pRequest->asyncLoadId );
 			}
 
 			allocator.Free( pRequest->pAsyncLoadBuffer );
@@ -147,10 +183,12 @@ size_t CachePackageLoader::BeginLoadObject( AssetPath path, Reflect::ObjectResol
 
 		SetInvalid( pRequest->asyncLoadId );
 		pRequest->pAsyncLoadBuffer = NULL;
+		pRequest->pMappedData = NULL;
 		pRequest->pPropertyDataBegin = NULL;
 		pRequest->pPropertyDataEnd = NULL;
 		pRequest->pPersistentResourceDataBegin = NULL;
 		pRequest->pPersistentResourceDataEnd = NULL;
+		pRequest->deserializeState = DESERIALIZE_STATE_IDLE;
 		SetInvalid( pRequest->ownerLoadIndex );
 		HELIUM_ASSERT( !pRequest->spOwner );
 		pRequest->forceReload = forceReload;
@@ -206,10 +244,12 @@ size_t CachePackageLoader::BeginLoadObject( AssetPath path, Reflect::ObjectResol
 	HELIUM_ASSERT( !pRequest->spObject );
 	SetInvalid( pRequest->asyncLoadId );
 	pRequest->pAsyncLoadBuffer = NULL;
+	pRequest->pMappedData = NULL;
 	pRequest->pPropertyDataBegin = NULL;
 	pRequest->pPropertyDataEnd = NULL;
 	pRequest->pPersistentResourceDataBegin = NULL;
 	pRequest->pPersistentResourceDataEnd = NULL;
+	pRequest->deserializeState = DESERIALIZE_STATE_IDLE;
 	SetInvalid( pRequest->ownerLoadIndex );
 	HELIUM_ASSERT( !pRequest->spOwner );
 	pRequest->forceReload = forceReload;
@@ -235,22 +275,54 @@ size_t CachePackageLoader::BeginLoadObject( AssetPath path, Reflect::ObjectResol
 	{
 		HELIUM_ASSERT( !pObject || !pObject->GetAnyFlagSet( Asset::FLAG_LOADED | Asset::FLAG_LINKED ) );
 
-		HELIUM_TRACE(
-			TraceLevels::Debug,
-			TXT( "CachePackageLoader::BeginLoadObject(): Issuing async load of property data for \"%s\".\n" ),
-			*path.ToString() );
+		// If the cache file is mapped and the entry is not compressed, deserialize straight from the mapping, hinting
+		// that the entry will be needed so that it can be paged in before the request is next ticked.
+		if( pEntry->codec == CacheCompression::CODEC_NONE )
+		{
+			pRequest->pMappedData = m_pCache->GetMappedEntryData( *pEntry );
+		}
+
+
+		if( pRequest->pMappedData )
+		{
+			HELIUM_TRACE(
+				TraceLevels::Debug,
+				TXT( "CachePackageLoader::BeginLoadObject(): Using mapped property data for \"%s\".\n" ),
+				*path.ToString() );
+
+			m_pCache->AdviseEntryReadahead( *pEntry );
+		}
+		else
+		{
+			HELIUM_TRACE(
+				TraceLevels::Debug,
+				TXT( "CachePackageLoader::BeginLoadObject(): Issuing async load of property data for \"%s\".\n" ),
+				*path.ToString() );
 
-		size_t entrySize = pEntry->size;
-		pRequest->pAsyncLoadBuffer = static_cast< uint8_t* >( DefaultAllocator().Allocate( entrySize ) );
-		HELIUM_ASSERT( pRequest->pAsyncLoadBuffer );
+			size_t entrySize = pEntry->uncompressedSize;
+			pRequest->pAsyncLoadBuffer = static_cast< uint8_t* >( DefaultAllocator().Allocate( entrySize ) );
+			HELIUM_ASSERT( pRequest->pAsyncLoadBuffer );
 
-		AsyncLoader& rLoader = AsyncLoader::GetStaticInstance();
-		pRequest->asyncLoadId = rLoader.QueueRequest(
-			pRequest->pAsyncLoadBuffer,
-			m_pCache->GetCacheFileName(),
-			pEntry->offset,
-			entrySize );
-		HELIUM_ASSERT( IsValid( pRequest->asyncLoadId ) );
+			pRequest->asyncLoadId = m_pCache->BeginLoadEntry( *pEntry, pRequest->pAsyncLoadBuffer );
+			if( IsInvalid( pRequest->asyncLoadId ) )
+			{
+				HELIUM_TRACE(
+					TraceLevels::Error,
+					TXT( "CachePackageLoader::BeginLoadObject(): Failed to begin loading property data for \"%s\".\n" ),
+					*path.ToString() );
+
+				DefaultAllocator().Free( pRequest->pAsyncLoadBuffer );
+				pRequest->pAsyncLoadBuffer = NULL;
+
+				if( pObject )
+				{
+					pObject->SetFlags( Asset::FLAG_PRELOADED | Asset::FLAG_LINKED );
+					pObject->ConditionalFinalizeLoad();
+				}
+
+				pRequest->flags = LOAD_FLAG_PRELOADED | LOAD_FLAG_ERROR;
+			}
+		}
 	}
 
 	size_t requestId = m_loadRequests.Add( pRequest );
@@ -300,7 +372,7 @@ bool CachePackageLoader::TryFinishLoadObject( size_t requestId, AssetPtr& rspObj
 		pObject->SetFlags( Asset::FLAG_BROKEN );
 	}
 
-	if ( pObject->IsPackage() )
+	if ( pObject && pObject->IsPackage() )
 	{
 		Package *pPackage = Reflect::AssertCast<Package>( pObject );
 		pPackage->SetLoader( this );
@@ -334,6 +406,9 @@ bool CachePackageLoader::TryFinishLoadObject( size_t requestId, AssetPtr& rspObj
 /// Update this package loader.
 void CachePackageLoader::Tick()
 {
+	AssetLoader* pAssetLoader = AssetLoader::GetStaticInstance();
+	HELIUM_ASSERT( pAssetLoader );
+
 	// Process pending load requests.
 	size_t loadRequestSize = m_loadRequests.GetSize();
 	for( size_t loadRequestIndex = 0; loadRequestIndex < loadRequestSize; ++loadRequestIndex )
@@ -348,7 +423,7 @@ void CachePackageLoader::Tick()
 
 		if( !( pRequest->flags & LOAD_FLAG_PRELOADED ) )
 		{
-			if( IsValid( pRequest->asyncLoadId ) )
+			if( IsValid( pRequest->asyncLoadId ) || pRequest->pMappedData )
 			{
 				if( !TickCacheLoad( pRequest ) )
 				{
@@ -364,10 +439,15 @@ void CachePackageLoader::Tick()
 					continue;
 				}
 			}
+
+			// Let the asset loader know the object can be picked up.
+			HELIUM_ASSERT( pRequest->pEntry );
+			pAssetLoader->NotifyObjectPreloaded( pRequest->pEntry->path );
 		}
 
 		HELIUM_ASSERT( IsInvalid( pRequest->asyncLoadId ) );
 		HELIUM_ASSERT( pRequest->pAsyncLoadBuffer == NULL );
+		HELIUM_ASSERT( pRequest->pMappedData == NULL );
 	}
 }
 
@@ -392,6 +472,8 @@ AssetPath CachePackageLoader::GetAssetPath( size_t index ) const
 
 /// Tick the async loading of binary serialized data from the object cache for the given load request.
 ///
+/// For mapped caches, the entry data is already available and is used in place.
+///
 /// @param[in] pRequest  Load request.
 ///
 /// @return  True if the cache load process has completed, false if it still requires processing.
@@ -400,15 +482,25 @@ bool CachePackageLoader::TickCacheLoad( LoadRequest* pRequest )
 	HELIUM_ASSERT( pRequest );
 	HELIUM_ASSERT( !( pRequest->flags & LOAD_FLAG_PRELOADED ) );
 
-	AsyncLoader& rAsyncLoader = AsyncLoader::GetStaticInstance();
-
+	const uint8_t* pData = pRequest->pMappedData;
 	size_t bytesRead = 0;
-	if( !rAsyncLoader.TrySyncRequest( pRequest->asyncLoadId, bytesRead ) )
+	if( pData )
 	{
-		return false;
+		HELIUM_ASSERT( pRequest->pEntry );
+		bytesRead = pRequest->pEntry->size;
+		pRequest->pMappedData = NULL;
 	}
+	else
+	{
+		HELIUM_ASSERT( m_pCache );
+		if( !m_pCache->TryFinishLoadEntry( pRequest->asyncLoadId, bytesRead ) )
+		{
+			return false;
+		}
 
-	SetInvalid( pRequest->asyncLoadId );
+		SetInvalid( pRequest->asyncLoadId );
+		pData = pRequest->pAsyncLoadBuffer;
+	}
 
 	if( bytesRead == 0 || IsInvalid( bytesRead ) )
 	{
@@ -419,16 +511,9 @@ bool CachePackageLoader::TickCacheLoad( LoadRequest* pRequest )
 			TXT( "CachePackageLoader: Failed to read cache data for object \"%s\".\n" ),
 			*pRequest->pEntry->path.ToString() );
 	}
-	else
+	else if( ReadCacheData( pRequest, pData, bytesRead ) )
 	{
-		uint8_t* pBufferEnd = pRequest->pAsyncLoadBuffer + bytesRead;
-		pRequest->pPropertyDataEnd = pBufferEnd;
-		pRequest->pPersistentResourceDataEnd = pBufferEnd;
-
-		if( ReadCacheData( pRequest ) )
-		{
-			return true;
-		}
+		return true;
 	}
 
 	// An error occurred attempting to load the property data, so mark any existing object as fully loaded (nothing
@@ -496,12 +581,47 @@ bool CachePackageLoader::TickDeserialize( LoadRequest* pRequest )
 	Asset* pOwner = pRequest->spOwner;
 
 	HELIUM_ASSERT( !pOwner || pOwner->IsFullyLoaded() );
-	
-	Reflect::ObjectPtr cached_object = Cache::ReadCacheObjectFromBuffer(
-		pRequest->pPropertyDataBegin, 
-		0, 
-		pRequest->pPropertyDataEnd - pRequest->pPropertyDataBegin, 
-		pRequest->pResolver);
+
+	// Deserialize the object data on a worker thread, leaving registration of the object and resolution of its asset
+	// references to this thread once the task has completed.
+	if( pRequest->deserializeState == DESERIALIZE_STATE_IDLE )
+	{
+		pRequest->deserializeState = DESERIALIZE_STATE_PENDING;
+		TaskDispatcher::Dispatch( DeserializeTask, pRequest );
+	}
+
+	if( pRequest->deserializeState != DESERIALIZE_STATE_DONE )
+	{
+		return false;
+	}
+
+	pRequest->deserializeState = DESERIALIZE_STATE_IDLE;
+
+	if( pRequest->pResolver )
+	{
+		pRequest->deferredResolver.Replay( pRequest->pResolver );
+	}
+
+	Reflect::ObjectPtr cached_object = pRequest->spDeserializedObject;
+	pRequest->spDeserializedObject.Release();
+
+	Reflect::ObjectPtr cached_prd = pRequest->spDeserializedResourceData;
+	pRequest->spDeserializedResourceData.Release();
+
+	DefaultAllocator().Free( pRequest->pAsyncLoadBuffer );
+	pRequest->pAsyncLoadBuffer = NULL;
+
+	if (!cached_object.ReferencesObject())
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "CachePackageLoader: Failed to deserialize object \"%s\".\n" ),
+			*pCacheEntry->path.ToString() );
+
+		pRequest->flags |= LOAD_FLAG_PRELOADED | LOAD_FLAG_ERROR;
+
+		return true;
+	}
 
 	AssetPtr assetPtr = Reflect::AssertCast<Asset>(cached_object);
 
@@ -515,54 +635,28 @@ bool CachePackageLoader::TickDeserialize( LoadRequest* pRequest )
 
 	Asset *pObject = assetPtr;
 	HELIUM_ASSERT( pObject );
-		
-	if (!cached_object.ReferencesObject())
-	{
-		HELIUM_TRACE(
-			TraceLevels::Error,
-			TXT( "CachePackageLoader: Failed to deserialize object \"%s\".\n" ),
-			*pCacheEntry->path.ToString() );
-
-		pObject->SetFlags( Asset::FLAG_LINKED );
-		pObject->ConditionalFinalizeLoad();
 
-		pRequest->flags |= LOAD_FLAG_ERROR;
-	}
-	else
+	if( !pObject->IsDefaultTemplate() )
 	{
-		//cached_object->CopyTo(pObject);
-				
-		if( !pObject->IsDefaultTemplate() )
+		// Load persistent resource data.
+		Resource* pResource = Reflect::SafeCast< Resource >( pObject );
+		if( pResource )
 		{
-			// Load persistent resource data.
-			Resource* pResource = Reflect::SafeCast< Resource >( pObject );
-			if( pResource )
+			if (!cached_prd.ReferencesObject())
 			{
-				Reflect::ObjectPtr cached_prd = Cache::ReadCacheObjectFromBuffer(
-					pRequest->pPersistentResourceDataBegin, 
-					0, 
-					(pRequest->pPersistentResourceDataEnd - pRequest->pPersistentResourceDataBegin),
-					pRequest->pResolver);
-
-				if (!cached_prd.ReferencesObject())
-				{
-					HELIUM_TRACE(
-						TraceLevels::Error,
-						( TXT( "CachePackageLoader: Failed to deserialize persistent resource " )
-						TXT( "data for \"%s\".\n" ) ),
-						*pCacheEntry->path.ToString() );
-				}
-				else
-				{
-					pResource->LoadPersistentResourceObject(cached_prd);
-				}
+				HELIUM_TRACE(
+					TraceLevels::Error,
+					( TXT( "CachePackageLoader: Failed to deserialize persistent resource " )
+					TXT( "data for \"%s\".\n" ) ),
+					*pCacheEntry->path.ToString() );
+			}
+			else
+			{
+				pResource->LoadPersistentResourceObject(cached_prd);
 			}
 		}
 	}
 
-	DefaultAllocator().Free( pRequest->pAsyncLoadBuffer );
-	pRequest->pAsyncLoadBuffer = NULL;
-
 	pObject->SetFlags( Asset::FLAG_PRELOADED );
 
 	pRequest->flags |= LOAD_FLAG_PRELOADED;
@@ -571,6 +665,42 @@ bool CachePackageLoader::TickDeserialize( LoadRequest* pRequest )
 	return true;
 }
 
+/// Task for deserializing the object and persistent resource data of a load request.
+///
+/// This may be run on any thread, so it only reads from the request buffers, and records asset references using the
+/// request's deferred resolver instead of resolving them directly.
+///
+/// @param[in] pData  Load request.
+void CachePackageLoader::DeserializeTask( void* pData )
+{
+	LoadRequest* pRequest = static_cast< LoadRequest* >( pData );
+	HELIUM_ASSERT( pRequest );
+	HELIUM_ASSERT( pRequest->deserializeState == DESERIALIZE_STATE_PENDING );
+
+	Reflect::ObjectResolver* pResolver = ( pRequest->pResolver ? &pRequest->deferredResolver : NULL );
+
+	pRequest->spDeserializedObject = Cache::ReadCacheObjectFromBuffer(
+		pRequest->pPropertyDataBegin, 
+		0, 
+		pRequest->pPropertyDataEnd - pRequest->pPropertyDataBegin, 
+		pResolver);
+
+	Reflect::Object* pObject = pRequest->spDeserializedObject;
+	if( pObject && Reflect::SafeCast< Resource >( pObject ) )
+	{
+		pRequest->spDeserializedResourceData = Cache::ReadCacheObjectFromBuffer(
+			pRequest->pPersistentResourceDataBegin, 
+			0, 
+			(pRequest->pPersistentResourceDataEnd - pRequest->pPersistentResourceDataBegin),
+			pResolver);
+	}
+
+	AtomicExchangeRelease( pRequest->deserializeState, DESERIALIZE_STATE_DONE );
+
+	// Wake up any thread waiting for the load to finish.
+	AsyncLoader::GetStaticInstance().NotifyProgress();
+}
+
 /// Recursive function for resolving a package request.
 ///
 /// @param[out] rspPackage   Resolved package.
@@ -605,15 +735,17 @@ void CachePackageLoader::ResolvePackage( AssetPtr& rspPackage, AssetPath package
 /// Deserialize the link tables for an object load.
 ///
 /// @param[in] pRequest  Load request data.
-bool CachePackageLoader::ReadCacheData( LoadRequest* pRequest )
+/// @param[in] pData     Cache entry data (either the async load buffer or the entry within the mapped cache file).
+/// @param[in] size      Size of the cache entry data, in bytes.
+bool CachePackageLoader::ReadCacheData( LoadRequest* pRequest, const uint8_t* pData, size_t size )
 {
 	HELIUM_ASSERT( pRequest );
+	HELIUM_ASSERT( pData );
 
-	uint8_t* pBufferCurrent = pRequest->pAsyncLoadBuffer;
-	uint8_t* pPropertyDataEnd = pRequest->pPropertyDataEnd;
-	HELIUM_ASSERT( pBufferCurrent );
-	HELIUM_ASSERT( pPropertyDataEnd );
-	HELIUM_ASSERT( pBufferCurrent <= pPropertyDataEnd );
+	const uint8_t* pBufferCurrent = pData;
+	const uint8_t* pPropertyDataEnd = pData + size;
+	pRequest->pPropertyDataEnd = pPropertyDataEnd;
+	pRequest->pPersistentResourceDataEnd = pPropertyDataEnd;
 
 	// We know the owner's path immediately just by looking at the path we're currently loading
 	AssetPath parentPath = pRequest->pEntry->path.GetParent();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Engine/Asset.h"
+#include "Engine/AssetLoader.h"
 #include "Engine/PackageLoader.h"
 
 #include "Engine/Cache.h"
@@ -8,6 +9,15 @@
 namespace Helium
 {
 	/// Package loader for loading objects from a binary cache.
+	///
+	/// By default, the data for each object is read into a temporary buffer using the async loader.  Alternatively, the
+	/// cache file can be memory-mapped once, in which case objects are deserialized directly from the mapped pages (with
+	/// readahead requested as each object load begins), and processes loading the same cache share its pages in memory.
+	///
+	/// Once an object's owner has loaded, its property and persistent resource data are deserialized by a task run
+	/// through the TaskDispatcher, so independent objects can be deserialized in parallel on worker threads.  Asset
+	/// references read by the task are recorded and resolved, along with object registration, on the thread ticking
+	/// the loader.
 	class CachePackageLoader : public PackageLoader
 	{
 	public:
@@ -22,7 +32,7 @@ namespace Helium
 
 		/// @name Initialization
 		//@{
-		bool Initialize( Name cacheName );
+		bool Initialize( Name cacheName, bool bMapCacheFile = false );
 		void Shutdown();
 		//@} 
 
@@ -55,6 +65,17 @@ namespace Helium
 			LOAD_FLAG_ERROR = 1 << 1
 		};
 
+		/// Object deserialization task states.
+		enum EDeserializeState
+		{
+			/// Deserialization task not yet started.
+			DESERIALIZE_STATE_IDLE,
+			/// Deserialization task dispatched.
+			DESERIALIZE_STATE_PENDING,
+			/// Deserialization task completed.
+			DESERIALIZE_STATE_DONE
+		};
+
 		/// Asset load request data.
 		struct LoadRequest
 		{
@@ -65,19 +86,30 @@ namespace Helium
 			/// Temporary object reference (hold while loading is in progress).
 			AssetPtr spObject;
 
-			/// Async load ID.
+			/// Cache entry load ID.
 			size_t asyncLoadId;
 			/// Async load buffer.
 			uint8_t* pAsyncLoadBuffer;
+			/// Cache entry data within the mapped cache file, until the cache data has been read.
+			const uint8_t* pMappedData;
 
-			/// Pointer to where the property data begins within the pAsyncLoadBuffer
-			uint8_t* pPropertyDataBegin;
+			/// Pointer to where the property data begins within the cache entry data
+			const uint8_t* pPropertyDataBegin;
 			/// End of the property data
-			uint8_t* pPropertyDataEnd;
-			/// Pointer to where the persistent resource data begins within the pAsyncLoadBuffer
-			uint8_t* pPersistentResourceDataBegin;
+			const uint8_t* pPropertyDataEnd;
+			/// Pointer to where the persistent resource data begins within the cache entry data
+			const uint8_t* pPersistentResourceDataBegin;
 			/// End of the persistent resource data.
-			uint8_t* pPersistentResourceDataEnd;
+			const uint8_t* pPersistentResourceDataEnd;
+
+			/// Deserialization task state (EDeserializeState).
+			volatile int32_t deserializeState;
+			/// Object read by the deserialization task.
+			Reflect::ObjectPtr spDeserializedObject;
+			/// Persistent resource data read by the deserialization task.
+			Reflect::ObjectPtr spDeserializedResourceData;
+			/// Resolver recording asset references read by the deserialization task.
+			DeferredAssetResolver deferredResolver;
 
 			// Load index for the owning asset
 			size_t ownerLoadIndex;
@@ -110,7 +142,8 @@ namespace Helium
 		/// @name Static Private Utility Functions
 		//@{
 		static void ResolvePackage( AssetPtr& spPackage, AssetPath packagePath );
-		static bool ReadCacheData( LoadRequest* pRequest );
+		static bool ReadCacheData( LoadRequest* pRequest, const uint8_t* pData, size_t size );
+		static void DeserializeTask( void* pData );
 		//@}
 	};
 }
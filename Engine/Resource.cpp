@@ -18,6 +18,7 @@ Resource::Resource()
 		preprocessedDataIndex < HELIUM_ARRAY_COUNT( m_preprocessedData );
 		++preprocessedDataIndex )
 	{
+		m_preprocessedData[ preprocessedDataIndex ].contentKey = 0;
 		m_preprocessedData[ preprocessedDataIndex ].bLoaded = false;
 	}
 #endif
@@ -72,7 +73,7 @@ size_t Resource::GetSubDataSize( uint32_t subDataIndex ) const
 	AssetPath resourcePath = GetPath();
 	const Cache::Entry* pCacheEntry = pCache->FindEntry( resourcePath, subDataIndex );
 
-	return ( pCacheEntry ? pCacheEntry->size : Invalid< size_t >() );
+	return ( pCacheEntry ? pCacheEntry->uncompressedSize : Invalid< size_t >() );
 }
 
 /// Begin asynchronous loading of the specified resource sub-data.
@@ -131,12 +132,9 @@ size_t Resource::BeginLoadSubData( void* pBuffer, uint32_t subDataIndex, size_t
 		return Invalid< size_t >();
 	}
 
-	// Begin an asynchronous load.
-	size_t subDataSize = pCacheEntry->size;
-	size_t loadSize = Min( subDataSize, loadSizeMax );
-
-	AsyncLoader& rAsyncLoader = AsyncLoader::GetStaticInstance();
-	size_t loadId = rAsyncLoader.QueueRequest( pBuffer, pCache->GetCacheFileName(), pCacheEntry->offset, loadSize );
+	// Begin an asynchronous load.  Resource buffers are frequently locked graphics buffers, so the cache is told to
+	// avoid decompressing directly into them.
+	size_t loadId = pCache->BeginLoadEntry( *pCacheEntry, pBuffer, loadSizeMax, true );
 
 	return loadId;
 }
@@ -158,11 +156,15 @@ bool Resource::TryFinishLoadSubData( size_t loadId )
 	}
 #endif
 
-	// Check the async load request.
-	AsyncLoader& rAsyncLoader = AsyncLoader::GetStaticInstance();
+	// Check the cache load request.
+	Name cacheName = GetCacheName();
+	HELIUM_ASSERT( !cacheName.IsEmpty() );
+
+	Cache* pCache = CacheManager::GetStaticInstance().GetCache( cacheName );
+	HELIUM_ASSERT( pCache );
 
 	size_t bytesRead;
-	bool bFinished = rAsyncLoader.TrySyncRequest( loadId, bytesRead );
+	bool bFinished = pCache->TryFinishLoadEntry( loadId, bytesRead );
 
 	return bFinished;
 }
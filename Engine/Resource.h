@@ -31,6 +31,8 @@ namespace Helium
 			/// Non-persistent sub-resource data.
 			/// pmd: Not sure that this is non-persitent anymore. See pResourceCache->CacheEntry call in AssetPreprocessor::CacheObject
 			DynamicArray< DynamicArray< uint8_t > > subDataBuffers;
+			/// Content key of the source data from which this data was preprocessed (valid once loaded).
+			uint64_t contentKey;
 			/// True if this data is loaded (even if the buffers are empty).
 			bool bLoaded;
 		};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Engine/Engine.h"
+
+namespace Helium
+{
+	/// 64-bit FNV-1a hashing for values that must remain the same across runs and platforms, such as hashes stored in
+	/// cache TOCs, package indices and content keys.
+	///
+	/// Hashes are built incrementally: start from SEED and add data to it.  Integer values are added one byte at a
+	/// time starting from the least significant byte, so their hashes do not depend on the byte order of the host.
+	class HELIUM_ENGINE_API StableHash
+	{
+	public:
+		/// Initial hash value.
+		static const uint64_t SEED = 14695981039346656037ULL;
+
+		/// @name Hashing
+		//@{
+		static inline uint64_t AddByte( uint64_t hash, uint8_t value );
+		static inline uint64_t AddUint32( uint64_t hash, uint32_t value );
+		static inline uint64_t AddData( uint64_t hash, const void* pData, size_t size );
+		static inline uint64_t AddString( uint64_t hash, const char* pString );
+		//@}
+
+	private:
+		/// FNV-1a prime.
+		static const uint64_t PRIME = 1099511628211ULL;
+	};
+}
+
+#include "Engine/StableHash.inl"
@@ -0,0 +1,64 @@
+/// Add a single byte to a hash.
+///
+/// @param[in] hash   Current hash value.
+/// @param[in] value  Byte to add.
+///
+/// @return  Updated hash value.
+uint64_t Helium::StableHash::AddByte( uint64_t hash, uint8_t value )
+{
+    return ( hash ^ value ) * PRIME;
+}
+
+/// Add a 32-bit integer to a hash, least significant byte first.
+///
+/// @param[in] hash   Current hash value.
+/// @param[in] value  Value to add.
+///
+/// @return  Updated hash value.
+uint64_t Helium::StableHash::AddUint32( uint64_t hash, uint32_t value )
+{
+    for( size_t byteIndex = 0; byteIndex < sizeof( value ); ++byteIndex )
+    {
+        hash = AddByte( hash, static_cast< uint8_t >( value >> ( byteIndex * 8 ) ) );
+    }
+
+    return hash;
+}
+
+/// Add a block of data to a hash.
+///
+/// @param[in] hash   Current hash value.
+/// @param[in] pData  Data to add.
+/// @param[in] size   Size of the data, in bytes.
+///
+/// @return  Updated hash value.
+uint64_t Helium::StableHash::AddData( uint64_t hash, const void* pData, size_t size )
+{
+    HELIUM_ASSERT( pData || size == 0 );
+
+    const uint8_t* pBytes = static_cast< const uint8_t* >( pData );
+    for( size_t byteIndex = 0; byteIndex < size; ++byteIndex )
+    {
+        hash = AddByte( hash, pBytes[ byteIndex ] );
+    }
+
+    return hash;
+}
+
+/// Add the characters of a null-terminated string (not including the terminator) to a hash.
+///
+/// @param[in] hash     Current hash value.
+/// @param[in] pString  String to add.
+///
+/// @return  Updated hash value.
+uint64_t Helium::StableHash::AddString( uint64_t hash, const char* pString )
+{
+    HELIUM_ASSERT( pString );
+
+    for( const char* pCharacter = pString; *pCharacter != TXT( '\0' ); ++pCharacter )
+    {
+        hash = AddByte( hash, static_cast< uint8_t >( *pCharacter ) );
+    }
+
+    return hash;
+}
@@ -0,0 +1,70 @@
+#include "EnginePch.h"
+#include "Engine/TaskDispatcher.h"
+
+using namespace Helium;
+
+TaskDispatcher::DISPATCH_FUNC volatile TaskDispatcher::sm_pDispatchFunction = NULL;
+TaskDispatcher::HELP_FUNC volatile TaskDispatcher::sm_pHelpFunction = NULL;
+
+/// Set the function used to dispatch tasks.
+///
+/// This should only be changed while no dispatched tasks are in progress (typically when starting up or shutting down
+/// the system providing the dispatch function).
+///
+/// @param[in] pFunction      Dispatch function, or null to run tasks on the thread that needs their results.
+/// @param[in] pHelpFunction  Function for running a pending task on a thread waiting for dispatched tasks, or null if
+///                           waiting threads can't help.
+///
+/// @see Dispatch(), HasDispatchFunction(), TryRunPendingTask()
+void TaskDispatcher::SetDispatchFunction( DISPATCH_FUNC pFunction, HELP_FUNC pHelpFunction )
+{
+	sm_pDispatchFunction = pFunction;
+	sm_pHelpFunction = pHelpFunction;
+}
+
+/// Run a task through the installed dispatch function, or immediately on the calling thread if no dispatch function is
+/// installed.
+///
+/// @param[in] pFunction  Task function.
+/// @param[in] pData      Data to pass to the task function.
+///
+/// @see SetDispatchFunction()
+void TaskDispatcher::Dispatch( TASK_FUNC pFunction, void* pData )
+{
+	HELIUM_ASSERT( pFunction );
+
+	DISPATCH_FUNC pDispatchFunction = sm_pDispatchFunction;
+	if( pDispatchFunction )
+	{
+		pDispatchFunction( pFunction, pData );
+	}
+	else
+	{
+		pFunction( pData );
+	}
+}
+
+/// Get whether a dispatch function is installed.
+///
+/// @return  True if tasks can be dispatched to other threads, false if they would be run on the calling thread.
+///
+/// @see SetDispatchFunction()
+bool TaskDispatcher::HasDispatchFunction()
+{
+	return ( sm_pDispatchFunction != NULL );
+}
+
+/// Run a single pending task on the calling thread, if the installed dispatch system has one available.
+///
+/// Threads blocking on the results of dispatched tasks should call this before going to sleep.  If every thread the
+/// tasks were dispatched to is itself waiting on them, nothing else would ever run them.
+///
+/// @return  True if a task was run, false if no task was pending (or no help function is installed).
+///
+/// @see SetDispatchFunction()
+bool TaskDispatcher::TryRunPendingTask()
+{
+	HELP_FUNC pHelpFunction = sm_pHelpFunction;
+
+	return ( pHelpFunction && pHelpFunction() );
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Engine/Engine.h"
+
+namespace Helium
+{
+	/// Hook for running engine tasks on other threads.
+	///
+	/// Engine cannot depend on the job system, so systems that can spread work across threads (cache entry
+	/// decompression, object deserialization) hand their tasks to a dispatch function installed by whichever module
+	/// provides the threads (the EngineJobs JobManager installs one when initialized).  If no dispatch function is
+	/// installed, tasks are run on the calling thread.
+	///
+	/// Threads waiting on dispatched tasks should call TryRunPendingTask() while they wait, as the waiting thread may
+	/// itself be one of the threads the tasks were dispatched to.
+	class HELIUM_ENGINE_API TaskDispatcher
+	{
+	public:
+		/// Task function.
+		typedef void ( *TASK_FUNC )( void* pData );
+		/// Function for running a task asynchronously.  The task must eventually be run exactly once, on any thread.
+		typedef void ( *DISPATCH_FUNC )( TASK_FUNC pFunction, void* pData );
+		/// Function for running a single pending task on the calling thread.  Returns true if a task was run.
+		typedef bool ( *HELP_FUNC )();
+
+		/// @name Task Dispatch
+		//@{
+		static void SetDispatchFunction( DISPATCH_FUNC pFunction, HELP_FUNC pHelpFunction = NULL );
+		static void Dispatch( TASK_FUNC pFunction, void* pData );
+		static bool HasDispatchFunction();
+		static bool TryRunPendingTask();
+		//@}
+
+	private:
+		/// Installed task dispatch function.
+		static DISPATCH_FUNC volatile sm_pDispatchFunction;
+		/// Installed function for running pending tasks on a waiting thread.
+		static HELP_FUNC volatile sm_pHelpFunction;
+	};
+}
@@ -1,17 +1,16 @@
-
 #pragma once
 
-#include "Engine/Engine.h"
+#include "EngineJobs/EngineJobs.h"
+#include "EngineJobs/JobManager.h"
 
 #include "Platform/Trace.h"
-#include "Foundation/DynamicArray.h"
-#include "Engine/JobContext.h"
 
 namespace Helium
 {
-	class JobContext;
-
-	/// WorldManager update job launcher.
+	/// Base template for jobs run through the JobManager.
+	///
+	/// Derived job types provide a Run() implementation for their parameters type.  The static RunCallback() matches
+	/// JOB_FUNC, so instances can be passed directly to JobManager::Spawn().
 	template< class ParametersType >
 	class JobBase : Helium::NonCopyable
 	{
@@ -31,12 +30,11 @@ namespace Helium
 
 		/// @name Job Execution
 		//@{
-		inline void Run( JobContext* pContext );
-		inline static void RunCallback( void* pJob, JobContext* pContext )
+		inline void Run();
+		inline static void RunCallback( void* pJob )
 		{
 			HELIUM_ASSERT( pJob );
-			HELIUM_ASSERT( pContext );
-			static_cast< JobBase< ParametersType >* >( pJob )->Run( pContext );
+			static_cast< JobBase< ParametersType >* >( pJob )->Run();
 		}
 		//@}
 
@@ -45,4 +43,4 @@ namespace Helium
 	private:
 		ParametersType m_parameters;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,562 @@
+#include "EngineJobsPch.h"
+#include "EngineJobs/JobManager.h"
+
+#include "Platform/Atomic.h"
+#include "Platform/Trace.h"
+
+#include "Engine/TaskDispatcher.h"
+
+#if !HELIUM_OS_WIN
+#include <unistd.h>
+#endif
+
+using namespace Helium;
+
+JobManager* JobManager::sm_pInstance = NULL;
+
+/// Get the number of processor cores available to this process.
+///
+/// @return  Number of available processor cores (always at least one).
+static uint32_t GetAvailableProcessorCount()
+{
+#if HELIUM_OS_WIN
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo( &systemInfo );
+    uint32_t processorCount = static_cast< uint32_t >( systemInfo.dwNumberOfProcessors );
+#else
+    long processorCount = sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+
+    return ( processorCount > 0 ? static_cast< uint32_t >( processorCount ) : 1 );
+}
+
+/// Constructor.
+JobManager::JobManager()
+    : m_pQueues( NULL )
+    , m_queueCount( 0 )
+    , m_wakeUpCondition( false, false )
+    , m_waitCondition( false, false )
+    , m_waitingThreadCount( 0 )
+    , m_pendingJobCount( 0 )
+    , m_stopCounter( 0 )
+{
+}
+
+/// Destructor.
+JobManager::~JobManager()
+{
+    Shutdown();
+}
+
+/// Start up the job worker threads.
+///
+/// @param[in] workerThreadCount  Number of worker threads to start.  If this is zero, one worker thread will be
+///                               started for each available processor core other than the one used by the calling
+///                               thread.
+///
+/// @return  True if initialization was successful, false if not.
+///
+/// @see Shutdown()
+bool JobManager::Initialize( uint32_t workerThreadCount )
+{
+    Shutdown();
+
+    if( workerThreadCount == 0 )
+    {
+        uint32_t processorCount = GetAvailableProcessorCount();
+        workerThreadCount = ( processorCount > 1 ? processorCount - 1 : 1 );
+    }
+
+    workerThreadCount = Min( workerThreadCount, WORKER_THREAD_MAX );
+
+    // Queue zero is shared by all threads that are not workers, and each worker owns one of the remaining queues.
+    m_queueCount = workerThreadCount + 1;
+    m_pQueues = new Locker< JobQueue, SpinLock >[ m_queueCount ];
+    HELIUM_ASSERT( m_pQueues );
+
+    AtomicExchangeRelease( m_pendingJobCount, 0 );
+    AtomicExchangeRelease( m_stopCounter, 0 );
+
+    m_workers.Reserve( workerThreadCount );
+    m_workerThreads.Reserve( workerThreadCount );
+
+    for( uint32_t workerIndex = 0; workerIndex < workerThreadCount; ++workerIndex )
+    {
+        Worker* pWorker = new Worker( this, workerIndex + 1 );
+        HELIUM_ASSERT( pWorker );
+        m_workers.Push( pWorker );
+
+        RunnableThread* pThread = new RunnableThread( pWorker );
+        HELIUM_ASSERT( pThread );
+        m_workerThreads.Push( pThread );
+
+        String threadName;
+        threadName.Format( TXT( "JobManager - worker %" ) PRIu32, workerIndex );
+        HELIUM_VERIFY( pThread->Start( threadName ) );
+    }
+
+    HELIUM_TRACE(
+        TraceLevels::Info,
+        TXT( "JobManager: Started %" ) PRIu32 TXT( " worker threads.\n" ),
+        workerThreadCount );
+
+    // Let engine tasks (cache entry decompression, object deserialization) run on the worker threads.
+    TaskDispatcher::SetDispatchFunction( DispatchEngineTask, RunPendingEngineTask );
+
+    return true;
+}
+
+/// Stop all worker threads.
+///
+/// Any jobs still queued are run on the calling thread before returning.
+///
+/// @see Initialize()
+void JobManager::Shutdown()
+{
+    if( !m_pQueues )
+    {
+        return;
+    }
+
+    // Callers must not have any engine tasks in flight at this point, so later tasks can be handed back to the threads
+    // needing their results.
+    TaskDispatcher::SetDispatchFunction( NULL );
+
+    AtomicExchangeRelease( m_stopCounter, 1 );
+
+    size_t workerThreadCount = m_workerThreads.GetSize();
+    for( size_t workerIndex = 0; workerIndex < workerThreadCount; ++workerIndex )
+    {
+        m_wakeUpCondition.Signal();
+    }
+
+    for( size_t workerIndex = 0; workerIndex < workerThreadCount; ++workerIndex )
+    {
+        RunnableThread* pThread = m_workerThreads[ workerIndex ];
+        HELIUM_ASSERT( pThread );
+        pThread->Join();
+        delete pThread;
+
+        delete m_workers[ workerIndex ];
+    }
+
+    m_workerThreads.Clear();
+    m_workers.Clear();
+
+    // Flush anything left in the queues so that no waiting counters are left hanging.
+    Job job;
+    while( TryAcquireJob( 0, job ) )
+    {
+        ExecuteJob( job );
+    }
+
+    delete [] m_pQueues;
+    m_pQueues = NULL;
+    m_queueCount = 0;
+}
+
+/// Spawn a job.
+///
+/// If the job manager has not been initialized, the job is run immediately on the calling thread.
+///
+/// @param[in] pFunction  Job callback.
+/// @param[in] pJob       Job instance to pass to the callback.  This must remain valid until the job has finished.
+/// @param[in] pCounter   Optional counter to increment now and decrement once the job has finished.
+///
+/// @see WaitForCounter(), SetContinuation()
+void JobManager::Spawn( JOB_FUNC pFunction, void* pJob, JobCounter* pCounter )
+{
+    HELIUM_ASSERT( pFunction );
+
+    if( pCounter )
+    {
+        AtomicIncrementAcquire( pCounter->m_count );
+    }
+
+    Job job;
+    job.pFunction = pFunction;
+    job.pJob = pJob;
+    job.pCounter = pCounter;
+
+    QueueJob( job );
+}
+
+/// Set the job to spawn once all jobs spawned against a counter have finished.
+///
+/// This must be called before any jobs are spawned against the counter, and at least one job must then be spawned
+/// against it for the continuation to run.  The counter must not be reused until the continuation has finished, and
+/// the continuation stays attached until the counter is waited on with WaitForCounter() or given a new continuation.
+///
+/// @param[in] rCounter              Counter to which the continuation should be attached.
+/// @param[in] pFunction             Continuation job callback.
+/// @param[in] pJob                  Continuation job instance.
+/// @param[in] pContinuationCounter  Optional counter to increment now and decrement once the continuation has
+///                                  finished.
+///
+/// @see Spawn()
+void JobManager::SetContinuation(
+    JobCounter& rCounter,
+    JOB_FUNC pFunction,
+    void* pJob,
+    JobCounter* pContinuationCounter )
+{
+    HELIUM_ASSERT( pFunction );
+    HELIUM_ASSERT( rCounter.m_count == 0 );
+    HELIUM_ASSERT( pContinuationCounter != &rCounter );
+
+    // Any continuation left from a previous use of the counter has already been spawned, so it is simply replaced.
+
+    rCounter.m_pContinuationFunction = pFunction;
+    rCounter.m_pContinuation = pJob;
+    rCounter.m_pContinuationCounter = pContinuationCounter;
+
+    // The pending continuation counts as outstanding work so that waiting on the continuation counter does not return
+    // before the continuation has been spawned.
+    if( pContinuationCounter )
+    {
+        AtomicIncrementAcquire( pContinuationCounter->m_count );
+    }
+}
+
+/// Block the current thread until all jobs spawned against a counter have finished.
+///
+/// The calling thread runs other pending jobs while waiting, so this can safely be called from within a job.  If no
+/// jobs are available to run, the calling thread sleeps until a counter reaches zero or a new job is queued.
+///
+/// @param[in] rCounter  Counter on which to wait.
+///
+/// @see Spawn()
+void JobManager::WaitForCounter( JobCounter& rCounter )
+{
+    uint32_t queueIndex = GetCurrentQueueIndex();
+
+    Job job;
+    while( rCounter.m_count != 0 )
+    {
+        if( m_pQueues && TryAcquireJob( queueIndex, job ) )
+        {
+            ExecuteJob( job );
+
+            continue;
+        }
+
+        // Register as waiting before rechecking the counter so that a job finishing in between either sees this thread
+        // waiting and signals it, or has already brought the counter to zero.  Any wake-up lost to another waiter
+        // consuming the signal is covered by the timeout.
+        AtomicIncrementAcquire( m_waitingThreadCount );
+        if( rCounter.m_count != 0 && m_pendingJobCount == 0 )
+        {
+            m_waitCondition.Wait( WAIT_IDLE_TIMEOUT );
+        }
+        AtomicDecrementRelease( m_waitingThreadCount );
+    }
+
+    // No job can access the counter once it reaches zero, so any continuation (already spawned by the last job) can be
+    // detached safely here to make the counter reusable.
+    rCounter.m_pContinuationFunction = NULL;
+    rCounter.m_pContinuation = NULL;
+    rCounter.m_pContinuationCounter = NULL;
+}
+
+/// Run a single pending job on the calling thread, if one is available.
+///
+/// @return  True if a job was run, false if no jobs were pending.
+bool JobManager::TryRunPendingJob()
+{
+    if( !m_pQueues )
+    {
+        return false;
+    }
+
+    Job job;
+    if( !TryAcquireJob( GetCurrentQueueIndex(), job ) )
+    {
+        return false;
+    }
+
+    ExecuteJob( job );
+
+    return true;
+}
+
+/// Get the singleton JobManager instance, creating it if necessary.
+///
+/// @return  Reference to the JobManager instance.
+///
+/// @see DestroyStaticInstance()
+JobManager& JobManager::GetStaticInstance()
+{
+    if( !sm_pInstance )
+    {
+        sm_pInstance = new JobManager;
+        HELIUM_ASSERT( sm_pInstance );
+    }
+
+    return *sm_pInstance;
+}
+
+/// Destroy the singleton JobManager instance.
+///
+/// @see GetStaticInstance()
+void JobManager::DestroyStaticInstance()
+{
+    if( sm_pInstance )
+    {
+        sm_pInstance->Shutdown();
+        delete sm_pInstance;
+        sm_pInstance = NULL;
+    }
+}
+
+/// Get the index of the job queue owned by the calling thread.
+///
+/// @return  Job queue index (zero if the calling thread is not a worker thread).
+uint32_t JobManager::GetCurrentQueueIndex() const
+{
+    return static_cast< uint32_t >( reinterpret_cast< uintptr_t >( m_currentQueue.GetPointer() ) );
+}
+
+/// Add a job to the queue owned by the calling thread, running it immediately if it cannot be queued.
+///
+/// @param[in] rJob  Job to queue.  Any counter associated with the job should already be incremented.
+void JobManager::QueueJob( const Job& rJob )
+{
+    if( !m_pQueues )
+    {
+        ExecuteJob( rJob );
+
+        return;
+    }
+
+    bool bQueued;
+    {
+        Locker< JobQueue, SpinLock >::Handle handle( m_pQueues[ GetCurrentQueueIndex() ] );
+        bQueued = handle->PushBack( rJob );
+    }
+
+    if( !bQueued )
+    {
+        // Queue is full, so just run the job now.
+        ExecuteJob( rJob );
+
+        return;
+    }
+
+    AtomicIncrementRelease( m_pendingJobCount );
+    m_wakeUpCondition.Signal();
+
+    // Threads blocked on a counter can help run the new job as well.
+    WakeWaitingThread();
+}
+
+/// Take the next job to run, first from the back of the given queue and then from the front of the other queues.
+///
+/// @param[in]  queueIndex  Index of the queue owned by the calling thread.
+/// @param[out] rJob        Acquired job.
+///
+/// @return  True if a job was acquired, false if all queues were empty.
+bool JobManager::TryAcquireJob( uint32_t queueIndex, Job& rJob )
+{
+    HELIUM_ASSERT( m_pQueues );
+    HELIUM_ASSERT( queueIndex < m_queueCount );
+
+    if( m_pendingJobCount == 0 )
+    {
+        return false;
+    }
+
+    bool bAcquired;
+    {
+        Locker< JobQueue, SpinLock >::Handle handle( m_pQueues[ queueIndex ] );
+        bAcquired = handle->PopBack( rJob );
+    }
+
+    for( uint32_t victimOffset = 1; !bAcquired && victimOffset < m_queueCount; ++victimOffset )
+    {
+        uint32_t victimIndex = ( queueIndex + victimOffset ) % m_queueCount;
+
+        Locker< JobQueue, SpinLock >::Handle handle( m_pQueues[ victimIndex ] );
+        bAcquired = handle->PopFront( rJob );
+    }
+
+    if( bAcquired )
+    {
+        AtomicDecrementRelease( m_pendingJobCount );
+    }
+
+    return bAcquired;
+}
+
+/// Run a job and signal its counter, spawning any continuation attached to the counter.
+///
+/// @param[in] rJob  Job to run.
+void JobManager::ExecuteJob( const Job& rJob )
+{
+    HELIUM_ASSERT( rJob.pFunction );
+    rJob.pFunction( rJob.pJob );
+
+    JobCounter* pCounter = rJob.pCounter;
+    if( !pCounter )
+    {
+        return;
+    }
+
+    // Continuation data must be read before decrementing, as the counter may be released or reused by a waiting
+    // thread as soon as it reaches zero, so the counter must not be touched at all afterwards.  The continuation
+    // fields are reset by the thread owning the counter instead (see WaitForCounter() and SetContinuation()).
+    JOB_FUNC pContinuationFunction = pCounter->m_pContinuationFunction;
+    void* pContinuation = pCounter->m_pContinuation;
+    JobCounter* pContinuationCounter = pCounter->m_pContinuationCounter;
+
+    if( AtomicDecrementRelease( pCounter->m_count ) != 0 )
+    {
+        return;
+    }
+
+    WakeWaitingThread();
+
+    if( pContinuationFunction )
+    {
+        // The continuation counter was already incremented when the continuation was set.
+        Job continuation;
+        continuation.pFunction = pContinuationFunction;
+        continuation.pJob = pContinuation;
+        continuation.pCounter = pContinuationCounter;
+        QueueJob( continuation );
+    }
+}
+
+/// Wake up a thread blocked in WaitForCounter(), if any, so that it can recheck its counter and the job queues.
+void JobManager::WakeWaitingThread()
+{
+    if( m_waitingThreadCount != 0 )
+    {
+        m_waitCondition.Signal();
+    }
+}
+
+/// TaskDispatcher dispatch function, spawning engine tasks as jobs on the static JobManager instance.
+///
+/// @param[in] pFunction  Task function.
+/// @param[in] pData      Task data.
+void JobManager::DispatchEngineTask( JOB_FUNC pFunction, void* pData )
+{
+    GetStaticInstance().Spawn( pFunction, pData, NULL );
+}
+
+/// TaskDispatcher help function, running a pending job from the static JobManager instance on the calling thread.
+///
+/// @return  True if a job was run, false if no jobs were pending.
+bool JobManager::RunPendingEngineTask()
+{
+    return GetStaticInstance().TryRunPendingJob();
+}
+
+/// Constructor.
+JobManager::JobQueue::JobQueue()
+    : head( 0 )
+    , tail( 0 )
+{
+}
+
+/// Push a job onto the back of this queue.
+///
+/// @param[in] rJob  Job to push.
+///
+/// @return  True if the job was queued, false if the queue is full.
+bool JobManager::JobQueue::PushBack( const Job& rJob )
+{
+    if( tail - head >= JOB_QUEUE_SIZE )
+    {
+        return false;
+    }
+
+    jobs[ tail & ( JOB_QUEUE_SIZE - 1 ) ] = rJob;
+    ++tail;
+
+    return true;
+}
+
+/// Pop the most recently pushed job from the back of this queue.
+///
+/// @param[out] rJob  Popped job.
+///
+/// @return  True if a job was popped, false if the queue is empty.
+bool JobManager::JobQueue::PopBack( Job& rJob )
+{
+    if( tail == head )
+    {
+        return false;
+    }
+
+    --tail;
+    rJob = jobs[ tail & ( JOB_QUEUE_SIZE - 1 ) ];
+
+    return true;
+}
+
+/// Pop the oldest job from the front of this queue.
+///
+/// @param[out] rJob  Popped job.
+///
+/// @return  True if a job was popped, false if the queue is empty.
+bool JobManager::JobQueue::PopFront( Job& rJob )
+{
+    if( tail == head )
+    {
+        return false;
+    }
+
+    rJob = jobs[ head & ( JOB_QUEUE_SIZE - 1 ) ];
+    ++head;
+
+    return true;
+}
+
+/// Constructor.
+///
+/// @param[in] pManager    Owning job manager.
+/// @param[in] queueIndex  Index of the job queue owned by this worker.
+JobManager::Worker::Worker( JobManager* pManager, uint32_t queueIndex )
+    : m_pManager( pManager )
+    , m_queueIndex( queueIndex )
+{
+    HELIUM_ASSERT( pManager );
+    HELIUM_ASSERT( queueIndex != 0 );
+}
+
+/// Destructor.
+JobManager::Worker::~Worker()
+{
+}
+
+/// Run jobs until the job manager is shut down.
+void JobManager::Worker::Run()
+{
+    JobManager* pManager = m_pManager;
+    HELIUM_ASSERT( pManager );
+
+    pManager->m_currentQueue.SetPointer( reinterpret_cast< void* >( static_cast< uintptr_t >( m_queueIndex ) ) );
+
+    Job job;
+    while( pManager->m_stopCounter == 0 )
+    {
+        if( !pManager->TryAcquireJob( m_queueIndex, job ) )
+        {
+            // Nothing to do, so sleep until notified (the timeout covers wake-ups coalesced by the condition).
+            pManager->m_wakeUpCondition.Wait( WORKER_IDLE_TIMEOUT );
+
+            continue;
+        }
+
+        // Wake up another worker if there is still work available so that jobs fan out across all cores.
+        if( pManager->m_pendingJobCount != 0 )
+        {
+            pManager->m_wakeUpCondition.Signal();
+        }
+
+        pManager->ExecuteJob( job );
+    }
+
+    pManager->m_currentQueue.SetPointer( NULL );
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "Platform/Condition.h"
+#include "Platform/Locks.h"
+#include "Platform/Thread.h"
+
+#include "Foundation/DynamicArray.h"
+
+#include "EngineJobs/EngineJobs.h"
+
+namespace Helium
+{
+    /// Job entry point.
+    ///
+    /// @param[in] pJob  Job instance to run.
+    typedef void ( *JOB_FUNC )( void* pJob );
+
+    /// Counter tracking the completion of a group of spawned jobs.
+    ///
+    /// The counter is incremented when a job is spawned against it and decremented once that job has finished
+    /// running.  A continuation job can be attached prior to spawning any jobs against the counter, in which case it
+    /// will be spawned as soon as the counter drops back to zero.
+    class HELIUM_ENGINE_JOBS_API JobCounter : NonCopyable
+    {
+    public:
+        /// @name Construction/Destruction
+        //@{
+        inline JobCounter();
+        inline ~JobCounter();
+        //@}
+
+        /// @name Status
+        //@{
+        inline int32_t GetCount() const;
+        inline bool IsDone() const;
+        //@}
+
+    private:
+        friend class JobManager;
+
+        /// Number of jobs spawned against this counter that have not yet finished.
+        volatile int32_t m_count;
+
+        /// Continuation job callback.
+        JOB_FUNC m_pContinuationFunction;
+        /// Continuation job instance.
+        void* m_pContinuation;
+        /// Counter to signal once the continuation job has finished.
+        JobCounter* m_pContinuationCounter;
+    };
+
+    /// Per-core work-stealing job scheduler.
+    ///
+    /// One worker thread is started for each available processor core (less one for the thread driving the
+    /// application).  Each worker owns a job queue: jobs spawned from a worker are pushed onto and popped from the
+    /// back of that worker's own queue, while idle workers steal from the front of other queues.  Jobs spawned from
+    /// threads that are not workers go into a shared queue that all workers steal from.
+    ///
+    /// Threads waiting on a JobCounter help execute pending jobs until the counter reaches zero, so jobs may freely
+    /// spawn and wait on child jobs.  Waiting threads with nothing to help with sleep until a counter reaches zero or
+    /// another job is queued.
+    class HELIUM_ENGINE_JOBS_API JobManager : NonCopyable
+    {
+    public:
+        /// Capacity of each job queue (must be a power of two).  Jobs spawned while a queue is full are run immediately.
+        static const uint32_t JOB_QUEUE_SIZE = 1024;
+        /// Maximum number of worker threads.
+        static const uint32_t WORKER_THREAD_MAX = 64;
+        /// Time (in milliseconds) an idle worker thread will sleep before rechecking the job queues.
+        static const uint32_t WORKER_IDLE_TIMEOUT = 2;
+        /// Time (in milliseconds) a thread in WaitForCounter() will sleep before rechecking its counter and the job
+        /// queues.
+        static const uint32_t WAIT_IDLE_TIMEOUT = 2;
+
+        /// @name Initialization
+        //@{
+        bool Initialize( uint32_t workerThreadCount = 0 );
+        void Shutdown();
+
+        inline bool IsInitialized() const;
+        inline uint32_t GetWorkerThreadCount() const;
+        //@}
+
+        /// @name Job Execution
+        //@{
+        void Spawn( JOB_FUNC pFunction, void* pJob, JobCounter* pCounter );
+        template< typename JobType > void Spawn( JobType& rJob, JobCounter* pCounter );
+
+        void SetContinuation(
+            JobCounter& rCounter, JOB_FUNC pFunction, void* pJob, JobCounter* pContinuationCounter );
+        template< typename JobType > void SetContinuation(
+            JobCounter& rCounter, JobType& rJob, JobCounter* pContinuationCounter );
+
+        void WaitForCounter( JobCounter& rCounter );
+        bool TryRunPendingJob();
+        //@}
+
+        /// @name Static Access
+        //@{
+        static JobManager& GetStaticInstance();
+        static void DestroyStaticInstance();
+        //@}
+
+    private:
+        /// Queued job.
+        struct Job
+        {
+            /// Job callback.
+            JOB_FUNC pFunction;
+            /// Job instance.
+            void* pJob;
+            /// Counter to decrement once the job has finished.
+            JobCounter* pCounter;
+        };
+
+        /// Fixed-size double-ended job queue.
+        struct JobQueue
+        {
+            /// Ring buffer of queued jobs.
+            Job jobs[ JOB_QUEUE_SIZE ];
+            /// Index of the first (oldest) job in the queue.
+            uint32_t head;
+            /// Index one past the last (newest) job in the queue.
+            uint32_t tail;
+
+            /// @name Construction/Destruction
+            //@{
+            JobQueue();
+            //@}
+
+            /// @name Queue Operations
+            //@{
+            bool PushBack( const Job& rJob );
+            bool PopBack( Job& rJob );
+            bool PopFront( Job& rJob );
+            //@}
+        };
+
+        /// Job worker thread runnable.
+        class Worker : public Runnable
+        {
+        public:
+            /// @name Construction/Destruction
+            //@{
+            Worker( JobManager* pManager, uint32_t queueIndex );
+            virtual ~Worker();
+            //@}
+
+            /// @name Runnable Interface
+            //@{
+            virtual void Run();
+            //@}
+
+        private:
+            /// Owning job manager.
+            JobManager* m_pManager;
+            /// Index of the job queue owned by this worker.
+            uint32_t m_queueIndex;
+        };
+
+        /// Job queues (index zero is shared by all threads that are not workers).
+        Locker< JobQueue, SpinLock >* m_pQueues;
+        /// Number of job queues.
+        uint32_t m_queueCount;
+
+        /// Worker threads.
+        DynamicArray< RunnableThread* > m_workerThreads;
+        /// Worker thread runnables.
+        DynamicArray< Worker* > m_workers;
+
+        /// Index of the job queue owned by the current thread (zero for threads that are not workers).
+        ThreadLocalPointer m_currentQueue;
+
+        /// Condition used to wake up idle worker threads when jobs are spawned (or when they should shut down).
+        Condition m_wakeUpCondition;
+        /// Condition used to wake up threads blocked in WaitForCounter() when a counter reaches zero or a job is queued.
+        Condition m_waitCondition;
+        /// Number of threads blocked in WaitForCounter().
+        volatile int32_t m_waitingThreadCount;
+        /// Number of jobs that have been queued but not yet picked up by a thread.
+        volatile int32_t m_pendingJobCount;
+        /// Non-zero if worker threads should stop when next possible, zero if they should continue.
+        volatile int32_t m_stopCounter;
+
+        /// Singleton instance.
+        static JobManager* sm_pInstance;
+
+        /// @name Construction/Destruction
+        //@{
+        JobManager();
+        ~JobManager();
+        //@}
+
+        /// @name Private Utility Functions
+        //@{
+        uint32_t GetCurrentQueueIndex() const;
+        void QueueJob( const Job& rJob );
+        bool TryAcquireJob( uint32_t queueIndex, Job& rJob );
+        void ExecuteJob( const Job& rJob );
+        void WakeWaitingThread();
+
+        static void DispatchEngineTask( JOB_FUNC pFunction, void* pData );
+        static bool RunPendingEngineTask();
+        //@}
+    };
+}
+
+#include "EngineJobs/JobManager.inl"
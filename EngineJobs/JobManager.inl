@@ -0,0 +1,77 @@
+namespace Helium
+{
+	/// Constructor.
+	JobCounter::JobCounter()
+		: m_count( 0 )
+		, m_pContinuationFunction( NULL )
+		, m_pContinuation( NULL )
+		, m_pContinuationCounter( NULL )
+	{
+	}
+
+	/// Destructor.
+	JobCounter::~JobCounter()
+	{
+		HELIUM_ASSERT( m_count == 0 );
+	}
+
+	/// Get the number of jobs spawned against this counter that have not yet finished.
+	///
+	/// @return  Number of outstanding jobs.
+	///
+	/// @see IsDone()
+	int32_t JobCounter::GetCount() const
+	{
+		return m_count;
+	}
+
+	/// Get whether all jobs spawned against this counter have finished.
+	///
+	/// @return  True if no jobs are outstanding, false if not.
+	///
+	/// @see GetCount()
+	bool JobCounter::IsDone() const
+	{
+		return ( m_count == 0 );
+	}
+
+	/// Get whether worker threads have been started.
+	///
+	/// @return  True if the job manager has been initialized, false if not.
+	///
+	/// @see Initialize(), Shutdown()
+	bool JobManager::IsInitialized() const
+	{
+		return ( m_pQueues != NULL );
+	}
+
+	/// Get the number of worker threads running jobs.
+	///
+	/// @return  Worker thread count.
+	uint32_t JobManager::GetWorkerThreadCount() const
+	{
+		return static_cast< uint32_t >( m_workerThreads.GetSize() );
+	}
+
+	/// Spawn a job.
+	///
+	/// @param[in] rJob      Job to run.  The job must provide a static RunCallback( void* ) function and must remain
+	///                      valid until it has finished running.
+	/// @param[in] pCounter  Optional counter to increment now and decrement once the job has finished.
+	template< typename JobType >
+	void JobManager::Spawn( JobType& rJob, JobCounter* pCounter )
+	{
+		Spawn( &JobType::RunCallback, &rJob, pCounter );
+	}
+
+	/// Set the job to spawn once all jobs spawned against a counter have finished.
+	///
+	/// @param[in] rCounter              Counter to which the continuation should be attached.
+	/// @param[in] rJob                  Continuation job.
+	/// @param[in] pContinuationCounter  Optional counter to signal once the continuation has finished.
+	template< typename JobType >
+	void JobManager::SetContinuation( JobCounter& rCounter, JobType& rJob, JobCounter* pContinuationCounter )
+	{
+		SetContinuation( rCounter, &JobType::RunCallback, &rJob, pContinuationCounter );
+	}
+}
@@ -0,0 +1,157 @@
+#include "EngineJobsPch.h"
+#include "EngineJobs/RadixSortJob.h"
+
+#include "EngineJobs/JobManager.h"
+
+using namespace Helium;
+
+/// Sort the keys.
+void RadixSortJob::Run()
+{
+    size_t count = m_parameters.count;
+    if( count <= 1 || m_parameters.keyBitCount == 0 )
+    {
+        return;
+    }
+
+    HELIUM_ASSERT( m_parameters.pKeys );
+    HELIUM_ASSERT( m_parameters.pScratch );
+    HELIUM_ASSERT( m_parameters.keyShift + m_parameters.keyBitCount <= 64 );
+
+    // Split the keys into blocks of at least singleJobCount keys, one or two per available thread.
+    size_t blockCount = 1;
+    JobManager& rJobManager = JobManager::GetStaticInstance();
+    if( rJobManager.IsInitialized() )
+    {
+        size_t singleJobCount = Max( m_parameters.singleJobCount, static_cast< size_t >( 1 ) );
+        blockCount = ( count + singleJobCount - 1 ) / singleJobCount;
+        blockCount = Min( blockCount, static_cast< size_t >( rJobManager.GetWorkerThreadCount() + 1 ) * 2 );
+        blockCount = Min( blockCount, BLOCK_COUNT_MAX );
+    }
+
+    DynamicArray< BlockJob > blocks;
+    blocks.Resize( blockCount );
+
+    uint64_t* pSource = m_parameters.pKeys;
+    uint64_t* pDestination = m_parameters.pScratch;
+
+    uint32_t shiftEnd = m_parameters.keyShift + m_parameters.keyBitCount;
+    for( uint32_t shift = m_parameters.keyShift; shift < shiftEnd; shift += RADIX_BIT_COUNT )
+    {
+        // Count the digits in each block.
+        size_t blockStart = 0;
+        for( size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex )
+        {
+            size_t blockEnd = count * ( blockIndex + 1 ) / blockCount;
+
+            BlockJob& rBlock = blocks[ blockIndex ];
+            rBlock.pSource = pSource + blockStart;
+            rBlock.pDestination = pDestination;
+            rBlock.count = blockEnd - blockStart;
+            rBlock.shift = shift;
+            rBlock.bScatter = false;
+
+            blockStart = blockEnd;
+        }
+
+        RunBlocks( blocks.GetData(), blockCount );
+
+        // Compute where each block writes each digit, skipping the pass entirely if all keys share the same digit.
+        // Keys from earlier blocks are placed first so that the sort is stable.
+        size_t offset = 0;
+        bool bSkipPass = false;
+        for( uint32_t digit = 0; digit < RADIX_SIZE && !bSkipPass; ++digit )
+        {
+            size_t digitStart = offset;
+            for( size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex )
+            {
+                BlockJob& rBlock = blocks[ blockIndex ];
+                rBlock.offsets[ digit ] = offset;
+                offset += rBlock.counts[ digit ];
+            }
+
+            bSkipPass = ( offset - digitStart == count );
+        }
+
+        if( bSkipPass )
+        {
+            continue;
+        }
+
+        for( size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex )
+        {
+            blocks[ blockIndex ].bScatter = true;
+        }
+
+        RunBlocks( blocks.GetData(), blockCount );
+
+        Swap( pSource, pDestination );
+    }
+
+    if( pSource != m_parameters.pKeys )
+    {
+        MemoryCopy( m_parameters.pKeys, pSource, count * sizeof( uint64_t ) );
+    }
+}
+
+/// Run a set of block jobs, spreading them across the job worker threads.
+///
+/// @param[in] pBlocks     Block jobs to run.
+/// @param[in] blockCount  Number of block jobs.
+void RadixSortJob::RunBlocks( BlockJob* pBlocks, size_t blockCount )
+{
+    HELIUM_ASSERT( pBlocks );
+    HELIUM_ASSERT( blockCount != 0 );
+
+    if( blockCount == 1 )
+    {
+        pBlocks[ 0 ].Run();
+
+        return;
+    }
+
+    JobManager& rJobManager = JobManager::GetStaticInstance();
+
+    JobCounter counter;
+    for( size_t blockIndex = 1; blockIndex < blockCount; ++blockIndex )
+    {
+        rJobManager.Spawn( pBlocks[ blockIndex ], &counter );
+    }
+
+    pBlocks[ 0 ].Run();
+    rJobManager.WaitForCounter( counter );
+}
+
+/// Count or scatter the keys in this block.
+void RadixSortJob::BlockJob::Run()
+{
+    const uint64_t* pKey = pSource;
+    const uint64_t* pKeyEnd = pSource + count;
+
+    if( bScatter )
+    {
+        for( ; pKey != pKeyEnd; ++pKey )
+        {
+            uint64_t key = *pKey;
+            size_t digit = static_cast< size_t >( ( key >> shift ) & ( RADIX_SIZE - 1 ) );
+            pDestination[ offsets[ digit ]++ ] = key;
+        }
+
+        return;
+    }
+
+    MemoryZero( counts, sizeof( counts ) );
+    for( ; pKey != pKeyEnd; ++pKey )
+    {
+        ++counts[ static_cast< size_t >( ( *pKey >> shift ) & ( RADIX_SIZE - 1 ) ) ];
+    }
+}
+
+/// Callback executed to run the job.
+///
+/// @param[in] pJob  Job to run.
+void RadixSortJob::BlockJob::RunCallback( void* pJob )
+{
+    HELIUM_ASSERT( pJob );
+    static_cast< BlockJob* >( pJob )->Run();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Foundation/DynamicArray.h"
+
+#include "EngineJobs/EngineJobs.h"
+
+namespace Helium
+{
+    /// Parallel least-significant-digit radix sort of 64-bit keys.
+    ///
+    /// Only the bits in [keyShift, keyShift + keyBitCount) are used for ordering; bits below keyShift are carried along
+    /// with each key (typically an index into the array of items being sorted).  The sort is stable, and passes in
+    /// which every key shares the same digit are skipped.  Large arrays are split into blocks that are counted and
+    /// scattered in separate jobs.
+    class HELIUM_ENGINE_JOBS_API RadixSortJob : NonCopyable
+    {
+    public:
+        /// Number of key bits sorted per pass.
+        static const uint32_t RADIX_BIT_COUNT = 8;
+        /// Number of buckets per pass.
+        static const uint32_t RADIX_SIZE = 1 << RADIX_BIT_COUNT;
+        /// Maximum number of blocks into which the keys are split.
+        static const size_t BLOCK_COUNT_MAX = 32;
+
+        class Parameters
+        {
+        public:
+            /// [inout] Keys to sort.
+            uint64_t* pKeys;
+            /// [in] Scratch buffer holding at least "count" keys.
+            uint64_t* pScratch;
+            /// [in] Number of keys to sort.
+            size_t count;
+            /// [in] Lowest bit used for ordering.
+            uint32_t keyShift;
+            /// [in] Number of bits used for ordering.
+            uint32_t keyBitCount;
+            /// [in] Minimum number of keys handled by each job.
+            size_t singleJobCount;
+
+            /// @name Construction/Destruction
+            //@{
+            inline Parameters();
+            //@}
+        };
+
+        /// @name Construction/Destruction
+        //@{
+        inline RadixSortJob();
+        inline ~RadixSortJob();
+        //@}
+
+        /// @name Parameters
+        //@{
+        inline Parameters& GetParameters();
+        inline const Parameters& GetParameters() const;
+        inline void SetParameters( const Parameters& rParameters );
+        //@}
+
+        /// @name Job Execution
+        //@{
+        void Run();
+        inline static void RunCallback( void* pJob );
+        //@}
+
+    private:
+        /// Job counting or scattering the keys in one block for a single pass.
+        class BlockJob
+        {
+        public:
+            /// Keys to read.
+            const uint64_t* pSource;
+            /// Keys to write (scatter only).
+            uint64_t* pDestination;
+            /// Number of keys in this block.
+            size_t count;
+            /// Bit shift of the digit being sorted.
+            uint32_t shift;
+            /// True to scatter the keys, false to count them.
+            bool bScatter;
+
+            /// Number of keys in this block with each digit.
+            size_t counts[ RADIX_SIZE ];
+            /// Destination index for the next key with each digit (scatter only).
+            size_t offsets[ RADIX_SIZE ];
+
+            void Run();
+            static void RunCallback( void* pJob );
+        };
+
+        /// Job parameters.
+        Parameters m_parameters;
+
+        /// @name Private Utility Functions
+        //@{
+        static void RunBlocks( BlockJob* pBlocks, size_t blockCount );
+        //@}
+    };
+}
+
+#include "EngineJobs/RadixSortJob.inl"
@@ -0,0 +1,62 @@
+namespace Helium
+{
+	/// Constructor.
+	RadixSortJob::RadixSortJob()
+	{
+	}
+
+	/// Destructor.
+	RadixSortJob::~RadixSortJob()
+	{
+	}
+
+	/// Get the parameters for this job.
+	///
+	/// @return  Reference to the structure containing the job parameters.
+	///
+	/// @see SetParameters()
+	RadixSortJob::Parameters& RadixSortJob::GetParameters()
+	{
+		return m_parameters;
+	}
+
+	/// Get the parameters for this job.
+	///
+	/// @return  Constant reference to the structure containing the job parameters.
+	///
+	/// @see SetParameters()
+	const RadixSortJob::Parameters& RadixSortJob::GetParameters() const
+	{
+		return m_parameters;
+	}
+
+	/// Set the job parameters.
+	///
+	/// @param[in] rParameters  Structure containing the job parameters.
+	///
+	/// @see GetParameters()
+	void RadixSortJob::SetParameters( const Parameters& rParameters )
+	{
+		m_parameters = rParameters;
+	}
+
+	/// Callback executed to run the job.
+	///
+	/// @param[in] pJob  Job to run.
+	void RadixSortJob::RunCallback( void* pJob )
+	{
+		HELIUM_ASSERT( pJob );
+		static_cast< RadixSortJob* >( pJob )->Run();
+	}
+
+	/// Constructor.
+	RadixSortJob::Parameters::Parameters()
+		: pKeys( NULL )
+		, pScratch( NULL )
+		, count( 0 )
+		, keyShift( 0 )
+		, keyBitCount( 64 )
+		, singleJobCount( 4096 )
+	{
+	}
+}
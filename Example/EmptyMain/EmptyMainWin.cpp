@@ -69,8 +69,12 @@ int main( int argc, const char* argv[] )
 
 		if( bSystemInitSuccess )
 		{
-			Window::NativeHandle windowHandle = rendererInitialization.GetMainWindow()->GetNativeHandle();
-			Input::Initialize(windowHandle, false);
+			// Headless systems have no main window or input devices.
+			if( !pGameSystem->IsHeadless() )
+			{
+				Window::NativeHandle windowHandle = rendererInitialization.GetMainWindow()->GetNativeHandle();
+				Input::Initialize(windowHandle, false);
+			}
 
 			// Run the application.
 			result = pGameSystem->Run();
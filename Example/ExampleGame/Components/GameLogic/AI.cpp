@@ -34,9 +34,9 @@ void AIComponentChasePlayerDefinition::PopulateMetaType( Helium::Reflect::MetaSt
 // TaskProcessAI
 
 typedef DynamicArray< Pair< PlayerComponent *, Simd::Vector3 > > PlayerList;
-static PlayerList g_PlayerList;
 
-void UpdateAI_ChasePlayer( AIComponentChasePlayer *pAiComponent, AvatarControllerComponent *pController )
+// Runs in parallel, only reads the shared player list and writes its own controller
+void UpdateAI_ChasePlayer( AIComponentChasePlayer *pAiComponent, AvatarControllerComponent *pController, PlayerList &rPlayerList )
 {
 	PlayerComponent *pTarget = NULL;
 	float pTargetDistanceSquared = NumericLimits<float>::Maximum;
@@ -48,7 +48,7 @@ void UpdateAI_ChasePlayer( AIComponentChasePlayer *pAiComponent, AvatarControlle
 	if ( pTransform )
 	{
 		myPosition = pTransform->GetPosition();
-		for (PlayerList::Iterator iter = g_PlayerList.Begin(); iter != g_PlayerList.End(); ++iter)
+		for (PlayerList::ConstIterator iter = rPlayerList.Begin(); iter != rPlayerList.End(); ++iter)
 		{
 			float d = (iter->Second() - myPosition).GetMagnitudeSquared();
 			if ( d < pTargetDistanceSquared )
@@ -79,7 +79,7 @@ void UpdateAI_ChasePlayer( AIComponentChasePlayer *pAiComponent, AvatarControlle
 
 void ProcessAI( World *pWorld )
 {
-	g_PlayerList.Clear();
+	PlayerList playerList;
 
 	for ( ImplementingComponentIterator<PlayerComponent> iterator( *pWorld->GetComponentManager() ); iterator.GetBaseComponent(); iterator.Advance() )
 	{
@@ -89,12 +89,12 @@ void ProcessAI( World *pWorld )
 
 			if ( pTransform )
 			{
-				g_PlayerList.New( *iterator, pTransform->GetPosition() );
+				playerList.New( *iterator, pTransform->GetPosition() );
 			}
 		}
 	}
 
-	QueryComponents< AIComponentChasePlayer, AvatarControllerComponent, UpdateAI_ChasePlayer >( pWorld );
+	ParallelQueryComponents< AIComponentChasePlayer, AvatarControllerComponent, PlayerList, UpdateAI_ChasePlayer >( pWorld, playerList );
 }
 
 HELIUM_DEFINE_TASK( TaskProcessAI, ( ForEachWorld< ProcessAI > ), TickTypes::Gameplay )
@@ -103,4 +103,8 @@ void TaskProcessAI::DefineContract( Helium::TaskContract &rContract )
 {
 	rContract.ExecuteAfter<Helium::StandardDependencies::ReceiveInput>();
 	rContract.ExecuteBefore<Helium::StandardDependencies::ProcessPhysics>();
+	rContract.ReadsComponents<PlayerComponent>();
+	rContract.ReadsComponents<TransformComponent>();
+	rContract.ReadsComponents<AIComponentChasePlayer>();
+	rContract.WritesComponents<AvatarControllerComponent>();
 }
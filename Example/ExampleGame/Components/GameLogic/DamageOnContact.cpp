@@ -70,4 +70,9 @@ HELIUM_DEFINE_TASK( ApplyDamageOnContact, (ForEachWorld< QueryComponents< HasPhy
 void ExampleGame::ApplyDamageOnContact::DefineContract( Helium::TaskContract &rContract )
 {
 	rContract.ExecutesWithin<ExampleGame::DoDamage>();
+
+	// Destroying entities only sets their DeferredDestroy tag, so this doesn't need to run alone
+	rContract.ReadsComponents<HasPhysicalContactsComponent>();
+	rContract.ReadsComponents<DamageOnContactComponent>();
+	rContract.WritesComponents<HealthComponent>();
 }
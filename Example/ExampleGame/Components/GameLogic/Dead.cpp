@@ -9,19 +9,9 @@ using namespace Helium;
 using namespace ExampleGame;
 
 //////////////////////////////////////////////////////////////////////////
-// DeadComponent
+// DeadTag
 
-HELIUM_DEFINE_COMPONENT(ExampleGame::DeadComponent, 128);
-
-void DeadComponent::PopulateMetaType( Reflect::MetaStruct& comp )
-{
-
-}
-
-void DeadComponent::Initialize( float damageAmount )
-{
-	m_DamageAmount = damageAmount;
-}
+const EntityTagId ExampleGame::DeadTag = EntityTags::Register( "Dead" );
 
 //////////////////////////////////////////////////////////////////////////
 // DespawnOnDeathComponent
@@ -51,12 +41,17 @@ void DespawnOnDeathComponentDefinition::PopulateMetaType( Reflect::MetaStruct& c
 //////////////////////////////////////////////////////////////////////////
 // TaskDestroyAllDead
 
-void DoDestroyAllDead( DespawnOnDeathComponent *pDespawnOnDeathComponent, DeadComponent *pHealthComponent )
+void DoDestroyAllDead( DespawnOnDeathComponent *pDespawnOnDeathComponent )
 {
 	pDespawnOnDeathComponent->GetEntity()->DeferredDestroy();
 }
 
-HELIUM_DEFINE_TASK( TaskDestroyAllDead, ( ForEachWorld< QueryComponents< DespawnOnDeathComponent, DeadComponent, DoDestroyAllDead > > ), TickTypes::Gameplay )
+void DestroyAllDeadInWorld( World *pWorld )
+{
+	QueryTaggedComponents< DespawnOnDeathComponent, DoDestroyAllDead >( pWorld, DeadTag );
+}
+
+HELIUM_DEFINE_TASK( TaskDestroyAllDead, ( ForEachWorld< DestroyAllDeadInWorld > ), TickTypes::Gameplay )
 
 void TaskDestroyAllDead::DefineContract( Helium::TaskContract &rContract )
 {
@@ -13,20 +13,8 @@
 
 namespace ExampleGame
 {
-	class DeadComponentDefinition;
-
-	typedef Helium::StrongPtr<DeadComponentDefinition> DeadComponentDefinitionPtr;	
-	typedef Helium::StrongPtr<const DeadComponentDefinition> ConstDeadComponentDefinitionPtr;
-
-	struct EXAMPLE_GAME_API DeadComponent : public Helium::Component
-	{
-		HELIUM_DECLARE_COMPONENT( ExampleGame::DeadComponent, Helium::Component );
-		static void PopulateMetaType( Helium::Reflect::MetaStruct& comp );
-
-		void Initialize( float damageAmount );
-
-		float m_DamageAmount;
-	};
+	// Tag set on entities whose health ran out
+	EXAMPLE_GAME_API extern const Helium::EntityTagId DeadTag;
 
 	class DespawnOnDeathComponentDefinition;
 
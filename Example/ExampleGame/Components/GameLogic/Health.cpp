@@ -3,6 +3,7 @@
 #include "Health.h"
 #include "Framework/WorldManager.h"
 #include "ExampleGame/Components/GameLogic/Dead.h"
+#include "Bullet/BulletWorldComponent.h"
 
 
 using namespace Helium;
@@ -32,7 +33,6 @@ void HealthComponent::Initialize( const HealthComponentDefinition &definition )
 {
 	m_Health = ( definition.m_InitialHealth < 0.0f) ? definition.m_MaxHealth : definition.m_InitialHealth;
 	m_MaxHealth = definition.m_MaxHealth;
-	m_CreatedDeadComponent = false;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -52,29 +52,33 @@ HELIUM_DEFINE_ABSTRACT_TASK(DoDamage);
 
 void ExampleGame::DoDamage::DefineContract( TaskContract &rContract )
 {
-	rContract.ExecuteAfter<StandardDependencies::ProcessPhysics>();
+	// Damage comes from the contacts found by the simulation step, so it doesn't have to wait for transforms to be
+	// copied back from the physics bodies (PostProcessPhysics), and can run alongside it
+	rContract.ExecuteAfter<Helium::ProcessPhysics>();
 	rContract.ExecuteBefore<StandardDependencies::Render>();
 }
 
 //////////////////////////////////////////////////////////////////////////
 
-void DoKillAllWithZeroHealth( HealthComponent *pHealthComponent )
+void DoKillAllWithZeroHealth( HealthComponent *pHealthComponent, ComponentCommandBuffer &rCommands )
 {
-	if ( pHealthComponent->m_Health < HELIUM_EPSILON )
+	// Tags are only written when the command buffers are executed, so reading them here is safe
+	if ( pHealthComponent->m_Health < HELIUM_EPSILON && !pHealthComponent->GetEntity()->HasTag( DeadTag ) )
 	{
-		if (!pHealthComponent->m_CreatedDeadComponent && !pHealthComponent->GetComponentCollection()->GetFirst<DeadComponent>())
-		{
-			pHealthComponent->AllocateSiblingComponent<DeadComponent>();
-		}
-
-		pHealthComponent->m_CreatedDeadComponent = true;
+		rCommands.SetEntityTag( pHealthComponent, DeadTag );
 	}
 }
 
-HELIUM_DEFINE_TASK( KillAllWithZeroHealth, ( ForEachWorld< QueryComponents< HealthComponent, DoKillAllWithZeroHealth > > ), TickTypes::Gameplay )
+void KillAllWithZeroHealthInWorld( World *pWorld )
+{
+	ParallelQueryComponents< HealthComponent, DoKillAllWithZeroHealth >( pWorld );
+}
+
+HELIUM_DEFINE_TASK( KillAllWithZeroHealth, ( ForEachWorld< KillAllWithZeroHealthInWorld > ), TickTypes::Gameplay )
 
 void ExampleGame::KillAllWithZeroHealth::DefineContract( Helium::TaskContract &rContract )
 {
 	rContract.ExecuteAfter<ExampleGame::DoDamage>();
 	rContract.ExecuteBefore<Helium::StandardDependencies::Render>();
+	rContract.ReadsComponents<HealthComponent>();
 }
@@ -6,6 +6,7 @@
 #include "Foundation/DynamicArray.h"
 #include "Framework/TaskScheduler.h"
 #include "Framework/Entity.h"
+#include "Framework/EntityComponent.h"
 #include "Components/TransformComponent.h"
 #include "Bullet/BulletBodyComponent.h"
 
@@ -18,9 +19,9 @@ namespace ExampleGame
 	typedef Helium::StrongPtr<HealthComponentDefinition> HealthComponentDefinitionPtr;	
 	typedef Helium::StrongPtr<const HealthComponentDefinition> ConstHealthComponentDefinitionPtr;
 			
-	struct EXAMPLE_GAME_API HealthComponent : public Helium::Component
+	struct EXAMPLE_GAME_API HealthComponent : public Helium::EntityComponent
 	{
-		HELIUM_DECLARE_COMPONENT( ExampleGame::HealthComponent, Helium::Component );
+		HELIUM_DECLARE_COMPONENT( ExampleGame::HealthComponent, Helium::EntityComponent );
 		static void PopulateMetaType( Helium::Reflect::MetaStruct& comp );
 		
 		void Initialize( const HealthComponentDefinition &definition);
@@ -28,7 +29,6 @@ namespace ExampleGame
 
 		float m_Health;
 		float m_MaxHealth;
-		bool m_CreatedDeadComponent;
 	};
 	
 	class EXAMPLE_GAME_API HealthComponentDefinition : public Helium::ComponentDefinitionHelper<HealthComponent, HealthComponentDefinition>
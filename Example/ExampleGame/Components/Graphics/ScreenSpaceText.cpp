@@ -60,12 +60,9 @@ ExampleGame::ScreenSpaceTextComponentDefinition::ScreenSpaceTextComponentDefinit
 
 }
 
-static GraphicsManagerComponent *g_pGraphicsManager;
-static BufferedDrawer *g_pBufferedDrawer;
-
-void DrawScreenSpaceText( ScreenSpaceTextComponent *pShaderComponent )
+void DrawScreenSpaceText( ScreenSpaceTextComponent *pShaderComponent, GraphicsManagerComponent &rGraphicsManager )
 {
-	pShaderComponent->Render( *g_pGraphicsManager );
+	pShaderComponent->Render( rGraphicsManager );
 };
 
 void DrawScreenSpaceText( World *pWorld )
@@ -74,10 +71,10 @@ void DrawScreenSpaceText( World *pWorld )
 	HELIUM_ASSERT( 0 );
 #else // GRAPHICS_SCENE_BUFFERED_DRAWER
 
-	g_pGraphicsManager = pWorld->GetComponents().GetFirst<GraphicsManagerComponent>();
-	HELIUM_ASSERT( g_pGraphicsManager );
+	GraphicsManagerComponent *pGraphicsManager = pWorld->GetComponents().GetFirst<GraphicsManagerComponent>();
+	HELIUM_ASSERT( pGraphicsManager );
 
-	QueryComponents< ScreenSpaceTextComponent, DrawScreenSpaceText >( pWorld );
+	QueryComponents< ScreenSpaceTextComponent, GraphicsManagerComponent, DrawScreenSpaceText >( pWorld, *pGraphicsManager );
 #endif
 }
 
@@ -154,12 +154,10 @@ ExampleGame::SpriteComponentDefinition::SpriteComponentDefinition()
 
 }
 
-static BufferedDrawer *g_pBufferedDrawer;
-
-void DrawSprite( SpriteComponent *pShaderComponent, Helium::TransformComponent *pTransformComponent )
+void DrawSprite( SpriteComponent *pShaderComponent, Helium::TransformComponent *pTransformComponent, BufferedDrawer &rBufferedDrawer )
 {
 	// TODO: Make this not use buffered drawer
-	pShaderComponent->Render( *g_pBufferedDrawer, *pTransformComponent );
+	pShaderComponent->Render( rBufferedDrawer, *pTransformComponent );
 };
 
 void DrawSprites( World *pWorld )
@@ -171,8 +169,7 @@ void DrawSprites( World *pWorld )
 	GraphicsManagerComponent *pGraphicsManager = pWorld->GetComponents().GetFirst<GraphicsManagerComponent>();
 	HELIUM_ASSERT( pGraphicsManager );
 
-	g_pBufferedDrawer = &pGraphicsManager->GetBufferedDrawer();
-	QueryComponents< SpriteComponent, TransformComponent, DrawSprite >( pWorld );
+	QueryComponents< SpriteComponent, TransformComponent, BufferedDrawer, DrawSprite >( pWorld, pGraphicsManager->GetBufferedDrawer() );
 #endif
 }
 
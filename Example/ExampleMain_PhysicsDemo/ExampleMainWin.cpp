@@ -159,11 +159,15 @@ int main( int argc, const char* argv[] )
 					pWorld->GetRootSlice()->CreateEntity(spCubeDefinition, locatedParamSet.Get());
 				}
 
-				Window::NativeHandle windowHandle = rendererInitialization.GetMainWindow()->GetNativeHandle();
-				Input::Initialize(windowHandle, false);
-				Input::SetWindowSize( 
-					rendererInitialization.GetMainWindow()->GetWidth(),
-					rendererInitialization.GetMainWindow()->GetHeight());
+				// Headless systems have no main window or input devices.
+				if( !pGameSystem->IsHeadless() )
+				{
+					Window::NativeHandle windowHandle = rendererInitialization.GetMainWindow()->GetNativeHandle();
+					Input::Initialize(windowHandle, false);
+					Input::SetWindowSize( 
+						rendererInitialization.GetMainWindow()->GetWidth(),
+						rendererInitialization.GetMainWindow()->GetHeight());
+				}
 
 				// Run the application.
 				result = pGameSystem->Run();
@@ -83,11 +83,15 @@ int main( int argc, const char* argv[] )
 
 		if( bSystemInitSuccess )
 		{
-			Window::NativeHandle windowHandle = rendererInitialization.GetMainWindow()->GetNativeHandle();
-			Input::Initialize(windowHandle, false);
-			Input::SetWindowSize( 
-				rendererInitialization.GetMainWindow()->GetWidth(),
-				rendererInitialization.GetMainWindow()->GetHeight());
+			// Headless systems have no main window or input devices.
+			if( !pGameSystem->IsHeadless() )
+			{
+				Window::NativeHandle windowHandle = rendererInitialization.GetMainWindow()->GetNativeHandle();
+				Input::Initialize(windowHandle, false);
+				Input::SetWindowSize( 
+					rendererInitialization.GetMainWindow()->GetWidth(),
+					rendererInitialization.GetMainWindow()->GetHeight());
+			}
 
 			// Run the application.
 			result = pGameSystem->Run();
@@ -0,0 +1,324 @@
+#include "FrameworkPch.h"
+#include "Framework/ComponentArchetype.h"
+
+using namespace Helium;
+using namespace Helium::Components;
+
+ArchetypeStorage::ArchetypeStorage()
+{
+
+}
+
+ArchetypeStorage::~ArchetypeStorage()
+{
+	for (DynamicArray< Archetype * >::Iterator iter = m_Archetypes.Begin(); iter != m_Archetypes.End(); ++iter)
+	{
+		Archetype *pArchetype = *iter;
+
+		// Collections outliving the storage must not point at freed archetypes
+		for (DynamicArray< ComponentCollection * >::Iterator collection_iter = pArchetype->m_Collections.Begin();
+			collection_iter != pArchetype->m_Collections.End(); ++collection_iter)
+		{
+			(*collection_iter)->m_Archetype = NULL;
+			(*collection_iter)->m_ArchetypeRow = Invalid<uint32_t>();
+		}
+
+		delete pArchetype;
+	}
+
+	m_Archetypes.Clear();
+
+	for (DynamicArray< ArchetypeQuery * >::Iterator iter = m_Queries.Begin(); iter != m_Queries.End(); ++iter)
+	{
+		delete *iter;
+	}
+
+	m_Queries.Clear();
+}
+
+void ArchetypeStorage::AddCollection( ComponentCollection &rCollection )
+{
+	if ( rCollection.m_Archetype || rCollection.m_Components.IsEmpty() )
+	{
+		return;
+	}
+
+	// Build the collection's sorted signature
+	DynamicArray< TypeId > signature;
+	signature.Reserve( rCollection.m_Components.GetSize() );
+
+	for (Map< TypeId, Component * >::ConstIterator iter = rCollection.m_Components.Begin();
+		iter != rCollection.m_Components.End(); ++iter)
+	{
+		size_t insert_index = signature.GetSize();
+		signature.Push( iter->First() );
+		while ( insert_index > 0 && signature[ insert_index - 1 ] > iter->First() )
+		{
+			signature[ insert_index ] = signature[ insert_index - 1 ];
+			--insert_index;
+		}
+
+		signature[ insert_index ] = iter->First();
+	}
+
+	InsertRow( FindOrCreateArchetype( signature ), rCollection );
+}
+
+void ArchetypeStorage::OnFirstComponentChanged( ComponentCollection &rCollection, TypeId typeId )
+{
+	Archetype *pCurrent = rCollection.m_Archetype ? rCollection.m_Archetype : &m_EmptyArchetype;
+	Component *pFirst = rCollection.GetFirst( typeId );
+	size_t column = pCurrent->FindColumn( typeId );
+
+	if ( ( pFirst != NULL ) == IsValid( column ) )
+	{
+		// Same set of types, only the first component of this type changed
+		if ( pFirst )
+		{
+			pCurrent->m_Columns[ column ][ rCollection.m_ArchetypeRow ] = pFirst;
+		}
+
+		return;
+	}
+
+	// The collection gained or lost a type, move it to the archetype for its new signature
+	Archetype *pTarget = GetTransition( pCurrent, typeId );
+
+	if ( rCollection.m_Archetype )
+	{
+		RemoveRow( rCollection );
+	}
+
+	if ( pTarget != &m_EmptyArchetype )
+	{
+		InsertRow( pTarget, rCollection );
+	}
+}
+
+const ArchetypeQuery& ArchetypeStorage::GetQuery( const TypeId *types, size_t typesCount )
+{
+	HELIUM_ASSERT( typesCount );
+
+	// Tasks running in parallel may run queries on the same storage
+	m_QueriesLock.Lock();
+
+	ArchetypeQuery *pQuery = NULL;
+	for (DynamicArray< ArchetypeQuery * >::Iterator iter = m_Queries.Begin(); iter != m_Queries.End(); ++iter)
+	{
+		const DynamicArray< TypeId > &rTypes = (*iter)->m_Types;
+		if ( rTypes.GetSize() != typesCount )
+		{
+			continue;
+		}
+
+		bool match = true;
+		for ( size_t i = 0; i < typesCount; ++i )
+		{
+			if ( rTypes[ i ] != types[ i ] )
+			{
+				match = false;
+				break;
+			}
+		}
+
+		if ( match )
+		{
+			pQuery = *iter;
+			break;
+		}
+	}
+
+	if ( !pQuery )
+	{
+		pQuery = new ArchetypeQuery();
+		pQuery->m_Types.AddArray( types, typesCount );
+		pQuery->m_ArchetypeCount = 0;
+		m_Queries.Push( pQuery );
+	}
+
+	// Pick up any archetypes created since the query last ran
+	if ( pQuery->m_ArchetypeCount != m_Archetypes.GetSize() )
+	{
+		UpdateQuery( *pQuery );
+	}
+
+	m_QueriesLock.Unlock();
+
+	return *pQuery;
+}
+
+void ArchetypeStorage::UpdateQuery( ArchetypeQuery &rQuery ) const
+{
+	const size_t typesCount = rQuery.m_Types.GetSize();
+
+	ArchetypeMatch match;
+	match.m_TypeColumns.Resize( typesCount );
+
+	for ( size_t archetype_index = rQuery.m_ArchetypeCount; archetype_index < m_Archetypes.GetSize(); ++archetype_index )
+	{
+		const Archetype *pArchetype = m_Archetypes[ archetype_index ];
+		match.m_Archetype = pArchetype;
+		match.m_Simple = true;
+
+		bool matches = true;
+		for ( size_t type_index = 0; matches && type_index < typesCount; ++type_index )
+		{
+			DynamicArray< size_t > &rColumns = match.m_TypeColumns[ type_index ];
+			rColumns.Resize( 0 );
+
+			const DynamicArray< TypeId > &rImplementingTypes = GetTypeData( rQuery.m_Types[ type_index ] )->m_ImplementingTypes;
+			for ( size_t column = 0; column < pArchetype->m_Signature.GetSize(); ++column )
+			{
+				for (DynamicArray< TypeId >::ConstIterator iter = rImplementingTypes.Begin(); iter != rImplementingTypes.End(); ++iter)
+				{
+					if ( *iter == pArchetype->m_Signature[ column ] )
+					{
+						rColumns.Push( column );
+						break;
+					}
+				}
+			}
+
+			matches = !rColumns.IsEmpty();
+			match.m_Simple = match.m_Simple && rColumns.GetSize() == 1;
+		}
+
+		if ( matches )
+		{
+			rQuery.m_Matches.Push( match );
+		}
+	}
+
+	rQuery.m_ArchetypeCount = m_Archetypes.GetSize();
+}
+
+Archetype* ArchetypeStorage::FindOrCreateArchetype( const DynamicArray< TypeId > &rSignature )
+{
+	if ( rSignature.IsEmpty() )
+	{
+		return &m_EmptyArchetype;
+	}
+
+	for (DynamicArray< Archetype * >::Iterator iter = m_Archetypes.Begin(); iter != m_Archetypes.End(); ++iter)
+	{
+		const DynamicArray< TypeId > &rOtherSignature = (*iter)->m_Signature;
+		if ( rOtherSignature.GetSize() != rSignature.GetSize() )
+		{
+			continue;
+		}
+
+		bool match = true;
+		for ( size_t i = 0; i < rSignature.GetSize(); ++i )
+		{
+			if ( rOtherSignature[ i ] != rSignature[ i ] )
+			{
+				match = false;
+				break;
+			}
+		}
+
+		if ( match )
+		{
+			return *iter;
+		}
+	}
+
+	Archetype *pArchetype = new Archetype();
+	pArchetype->m_Signature = rSignature;
+	pArchetype->m_Columns.Resize( rSignature.GetSize() );
+	m_Archetypes.Push( pArchetype );
+
+	return pArchetype;
+}
+
+Archetype* ArchetypeStorage::GetTransition( Archetype *pArchetype, TypeId typeId )
+{
+	Map< TypeId, Archetype * >::Iterator iter = pArchetype->m_Transitions.Find( typeId );
+	if ( iter != pArchetype->m_Transitions.End() )
+	{
+		return iter->Second();
+	}
+
+	// Toggle the type in a copy of the signature, keeping it sorted
+	DynamicArray< TypeId > signature;
+	signature.Reserve( pArchetype->m_Signature.GetSize() + 1 );
+
+	bool toggled = false;
+	for (DynamicArray< TypeId >::ConstIterator type_iter = pArchetype->m_Signature.Begin();
+		type_iter != pArchetype->m_Signature.End(); ++type_iter)
+	{
+		if ( !toggled && *type_iter >= typeId )
+		{
+			toggled = true;
+			if ( *type_iter == typeId )
+			{
+				continue;
+			}
+
+			signature.Push( typeId );
+		}
+
+		signature.Push( *type_iter );
+	}
+
+	if ( !toggled )
+	{
+		signature.Push( typeId );
+	}
+
+	Archetype *pTarget = FindOrCreateArchetype( signature );
+	pArchetype->m_Transitions.Insert( iter, Map< TypeId, Archetype * >::ValueType( typeId, pTarget ) );
+
+	return pTarget;
+}
+
+void ArchetypeStorage::InsertRow( Archetype *pArchetype, ComponentCollection &rCollection )
+{
+	HELIUM_ASSERT( pArchetype != &m_EmptyArchetype );
+	HELIUM_ASSERT( !rCollection.m_Archetype );
+
+	rCollection.m_Archetype = pArchetype;
+	rCollection.m_ArchetypeRow = static_cast< uint32_t >( pArchetype->m_Collections.GetSize() );
+	pArchetype->m_Collections.Push( &rCollection );
+
+	for ( size_t i = 0; i < pArchetype->m_Signature.GetSize(); ++i )
+	{
+		Component *pFirst = rCollection.GetFirst( pArchetype->m_Signature[ i ] );
+		HELIUM_ASSERT( pFirst );
+		pArchetype->m_Columns[ i ].Push( pFirst );
+	}
+}
+
+void ArchetypeStorage::RemoveRow( ComponentCollection &rCollection )
+{
+	Archetype *pArchetype = rCollection.m_Archetype;
+	HELIUM_ASSERT( pArchetype );
+
+	size_t row = rCollection.m_ArchetypeRow;
+	size_t last_row = pArchetype->m_Collections.GetSize() - 1;
+	HELIUM_ASSERT( pArchetype->m_Collections[ row ] == &rCollection );
+
+	// Swap the last row into the one being removed
+	if ( row != last_row )
+	{
+		ComponentCollection *pMoved = pArchetype->m_Collections[ last_row ];
+		pArchetype->m_Collections[ row ] = pMoved;
+		pMoved->m_ArchetypeRow = static_cast< uint32_t >( row );
+
+		for (DynamicArray< DynamicArray< Component * > >::Iterator column_iter = pArchetype->m_Columns.Begin();
+			column_iter != pArchetype->m_Columns.End(); ++column_iter)
+		{
+			(*column_iter)[ row ] = (*column_iter)[ last_row ];
+		}
+	}
+
+	pArchetype->m_Collections.Pop();
+	for (DynamicArray< DynamicArray< Component * > >::Iterator column_iter = pArchetype->m_Columns.Begin();
+		column_iter != pArchetype->m_Columns.End(); ++column_iter)
+	{
+		column_iter->Pop();
+	}
+
+	rCollection.m_Archetype = NULL;
+	rCollection.m_ArchetypeRow = Invalid<uint32_t>();
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Platform/Locks.h"
+#include "Foundation/DynamicArray.h"
+#include "Foundation/Map.h"
+#include "Framework/Framework.h"
+#include "Framework/Components.h"
+
+namespace Helium
+{
+	namespace Components
+	{
+		// All component collections that hold exactly the same set of component types. Each collection is a row, and
+		// each type in the signature is a column holding the first component of that type for every row. Queries walk
+		// the columns of matching archetypes linearly instead of looking each type up in every collection's map.
+		//
+		// Unlike a classic archetype ECS, component data is NOT stored in the columns themselves, only pointers to it.
+		// Components must stay in the pool that allocated them, at a fixed address:
+		//  - Pool::GetPool() finds a component's pool from its address (the pool block alignment plus the offset in
+		//    its inline data), so a component copied into a table would no longer know its pool.
+		//  - Chains of components of one type (m_Next/m_Previous) and ComponentHandle are pool indices, which moving a
+		//    component between archetypes would invalidate.
+		//  - A component is allocated from its typed pool before its collection is known, so its archetype (and so
+		//    its column) is not known when its storage is chosen.
+		// Moving data between tables would therefore mean reworking every pool, handle and chain. Each column is
+		// instead a dense pointer array: a query still walks matching collections linearly with no map lookups, at
+		// the cost of one indirection per component. Pools allocate slots in order, so components created together
+		// are usually adjacent in memory anyway.
+		struct HELIUM_FRAMEWORK_API Archetype
+		{
+			inline size_t                       GetRowCount() const;
+			inline size_t                       FindColumn( TypeId typeId ) const;
+
+			DynamicArray< TypeId >                       m_Signature;    //< Sorted component types of every row
+			DynamicArray< ComponentCollection * >        m_Collections;  //< Collection for each row
+			DynamicArray< DynamicArray< Component * > >  m_Columns;      //< First component of each signature type, per row
+
+			// Archetypes reached by adding or removing a single type, filled in as transitions happen
+			Map< TypeId, Archetype * >                   m_Transitions;
+		};
+
+		// An archetype matching a query, with the columns holding each queried type (or a type derived from it)
+		struct ArchetypeMatch
+		{
+			const Archetype *                        m_Archetype;
+			DynamicArray< DynamicArray< size_t > >   m_TypeColumns;  //< Column indices, per queried type
+			bool                                     m_Simple;       //< True if every queried type has exactly one column
+		};
+
+		// Archetypes matching a set of queried types, kept by the storage so queries don't test every archetype's
+		// signature each time they run. Archetypes are never destroyed, so only archetypes created since the list was
+		// last used need to be checked.
+		struct ArchetypeQuery
+		{
+			DynamicArray< TypeId >                   m_Types;
+			DynamicArray< ArchetypeMatch >           m_Matches;
+			size_t                                   m_ArchetypeCount;  //< Number of archetypes checked so far
+		};
+
+		// Optional archetype tables kept by a ComponentManager. Pools notify the storage whenever the first component
+		// of a type in a collection changes, which either updates a column in place or moves the collection to the
+		// archetype matching its new set of types.
+		class HELIUM_FRAMEWORK_API ArchetypeStorage : NonCopyable
+		{
+		public:
+			ArchetypeStorage();
+			~ArchetypeStorage();
+
+			void                      AddCollection( ComponentCollection &rCollection );
+			void                      OnFirstComponentChanged( ComponentCollection &rCollection, TypeId typeId );
+
+			inline size_t             GetArchetypeCount() const;
+			inline const Archetype*   GetArchetype( size_t index ) const;
+
+			const ArchetypeQuery&     GetQuery( const TypeId *types, size_t typesCount );
+
+		private:
+			Archetype*                FindOrCreateArchetype( const DynamicArray< TypeId > &rSignature );
+			Archetype*                GetTransition( Archetype *pArchetype, TypeId typeId );
+			void                      InsertRow( Archetype *pArchetype, ComponentCollection &rCollection );
+			void                      RemoveRow( ComponentCollection &rCollection );
+
+			void                      UpdateQuery( ArchetypeQuery &rQuery ) const;
+
+			DynamicArray< Archetype * > m_Archetypes;
+
+			DynamicArray< ArchetypeQuery * > m_Queries;
+			SpinLock                    m_QueriesLock;
+
+			// Collections without any components are not stored, but this is where their transitions start from
+			Archetype                   m_EmptyArchetype;
+		};
+	}
+}
+
+#include "Framework/ComponentArchetype.inl"
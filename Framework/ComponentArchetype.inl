@@ -0,0 +1,34 @@
+namespace Helium
+{
+	namespace Components
+	{
+		size_t Archetype::GetRowCount() const
+		{
+			return m_Collections.GetSize();
+		}
+
+		size_t Archetype::FindColumn( TypeId typeId ) const
+		{
+			for ( size_t i = 0; i < m_Signature.GetSize(); ++i )
+			{
+				if ( m_Signature[ i ] == typeId )
+				{
+					return i;
+				}
+			}
+
+			return Invalid< size_t >();
+		}
+
+		size_t ArchetypeStorage::GetArchetypeCount() const
+		{
+			return m_Archetypes.GetSize();
+		}
+
+		const Archetype* ArchetypeStorage::GetArchetype( size_t index ) const
+		{
+			HELIUM_ASSERT( index < m_Archetypes.GetSize() );
+			return m_Archetypes[ index ];
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#include "FrameworkPch.h"
+#include "Framework/ComponentCommandBuffer.h"
+
+#include "Framework/EntityComponent.h"
+
+using namespace Helium;
+
+ComponentCommandBuffer::ComponentCommandBuffer()
+{
+
+}
+
+void ComponentCommandBuffer::FreeComponent( Component *pComponent )
+{
+	HELIUM_ASSERT( pComponent );
+
+	Command command;
+	command.m_Type = Command::Free;
+	command.m_Component = pComponent;
+	command.m_Generation = pComponent->GetInlineData().m_Generation;
+	command.m_TypeId = Invalid<Components::TypeId>();
+	command.m_Tag = Invalid<EntityTagId>();
+	m_Commands.Push( command );
+}
+
+void ComponentCommandBuffer::AllocateSiblingComponent( Components::TypeId typeId, Component *pSibling )
+{
+	HELIUM_ASSERT( pSibling );
+
+	Command command;
+	command.m_Type = Command::AllocateSibling;
+	command.m_Component = pSibling;
+	command.m_Generation = pSibling->GetInlineData().m_Generation;
+	command.m_TypeId = typeId;
+	command.m_Tag = Invalid<EntityTagId>();
+	m_Commands.Push( command );
+}
+
+void ComponentCommandBuffer::SetEntityTag( EntityComponent *pComponent, EntityTagId tag )
+{
+	HELIUM_ASSERT( pComponent );
+
+	Command command;
+	command.m_Type = Command::SetEntityTag;
+	command.m_Component = pComponent;
+	command.m_Generation = pComponent->GetInlineData().m_Generation;
+	command.m_TypeId = Invalid<Components::TypeId>();
+	command.m_Tag = tag;
+	m_Commands.Push( command );
+}
+
+void ComponentCommandBuffer::Execute()
+{
+	for (DynamicArray< Command >::Iterator iter = m_Commands.Begin(); iter != m_Commands.End(); ++iter)
+	{
+		Component *pComponent = iter->m_Component;
+
+		// The component was freed since the command was recorded, so there's nothing to free or allocate next to
+		Components::Pool *pPool = Components::Pool::GetPool( pComponent );
+		if ( pComponent->GetInlineData().m_Generation != iter->m_Generation || !pPool->GetComponentCollection( pComponent ) )
+		{
+			continue;
+		}
+
+		switch ( iter->m_Type )
+		{
+		case Command::Free:
+			pPool->Free( pComponent );
+			break;
+
+		case Command::AllocateSibling:
+			pPool->GetComponentManager()->Allocate( iter->m_TypeId, pComponent->GetOwner(), *pPool->GetComponentCollection( pComponent ) );
+			break;
+
+		case Command::SetEntityTag:
+			static_cast< EntityComponent * >( pComponent )->GetEntity()->SetTag( iter->m_Tag );
+			break;
+		}
+	}
+
+	m_Commands.Clear();
+}
+
+void ComponentCommandBuffer::Clear()
+{
+	m_Commands.Clear();
+}
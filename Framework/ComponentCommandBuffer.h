@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Foundation/DynamicArray.h"
+#include "Framework/Framework.h"
+#include "Framework/Components.h"
+#include "Framework/EntityTags.h"
+
+namespace Helium
+{
+	class EntityComponent;
+
+	// Records structural changes (freeing and allocating components) so they can be made later from a single thread.
+	// Parallel queries hand one of these to each chunk, and apply them in chunk order once every chunk has finished.
+	class HELIUM_FRAMEWORK_API ComponentCommandBuffer
+	{
+	public:
+		ComponentCommandBuffer();
+
+		// Free the component when the buffer is executed. Components freed (or freed and reused) in the meantime are
+		// left alone.
+		void                FreeComponent( Component *pComponent );
+
+		// Allocate a component of the given type into the sibling's collection when the buffer is executed
+		void                AllocateSiblingComponent( Components::TypeId typeId, Component *pSibling );
+		template <class T> 
+		inline void         AllocateSiblingComponent( Component *pSibling );
+
+		// Set a tag on the entity owning the component when the buffer is executed
+		void                SetEntityTag( EntityComponent *pComponent, EntityTagId tag );
+
+		void                Execute();
+		void                Clear();
+		inline bool         IsEmpty() const;
+
+	private:
+		struct Command
+		{
+			enum Type
+			{
+				Free,
+				AllocateSibling,
+				SetEntityTag,
+			};
+
+			Type                         m_Type;
+			Component*                   m_Component;    //< Component to free, or sibling to allocate next to
+			Components::GenerationIndex  m_Generation;   //< Generation of the component when the command was recorded
+			Components::TypeId           m_TypeId;       //< Type to allocate
+			EntityTagId                  m_Tag;          //< Tag to set
+		};
+
+		DynamicArray< Command > m_Commands;
+	};
+}
+
+#include "Framework/ComponentCommandBuffer.inl"
@@ -0,0 +1,13 @@
+namespace Helium
+{
+	template <class T>
+	void ComponentCommandBuffer::AllocateSiblingComponent( Component *pSibling )
+	{
+		AllocateSiblingComponent( Components::GetType<T>(), pSibling );
+	}
+
+	bool ComponentCommandBuffer::IsEmpty() const
+	{
+		return m_Commands.IsEmpty();
+	}
+}
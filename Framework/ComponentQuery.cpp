@@ -1,11 +1,76 @@
 
 #include "FrameworkPch.h"
 #include "Framework/ComponentQuery.h"
+#include "Framework/ComponentArchetype.h"
+#include "Framework/ComponentCommandBuffer.h"
+#include "EngineJobs/JobManager.h"
 #include <limits>
 #include <vector>
 
 using namespace Helium;
 
+// Passes each tuple to a query callback
+struct CallbackTupleSink
+{
+	ComponentTupleCallback m_Callback;
+
+	void operator()(DynamicArray<Component *> &tuple) const
+	{
+		m_Callback(tuple);
+	}
+};
+
+// Passes each tuple to a query callback along with the query's context
+struct ContextCallbackTupleSink
+{
+	ComponentTupleContextCallback m_Callback;
+	void *m_pContext;
+
+	void operator()(DynamicArray<Component *> &tuple) const
+	{
+		m_Callback(tuple, m_pContext);
+	}
+};
+
+// Appends each tuple to a flat array
+struct GatherTupleSink
+{
+	DynamicArray<Component *> *m_pTuples;
+
+	void operator()(DynamicArray<Component *> &tuple) const
+	{
+		for (DynamicArray<Component *>::ConstIterator iter = tuple.Begin(); iter != tuple.End(); ++iter)
+		{
+			m_pTuples->Push(*iter);
+		}
+	}
+};
+
+// Appends each component of a tuple to the array for its queried type. Can drop the first tuple, which a parallel
+// query has already handed out straight from the archetype columns when gathering the rest of a row.
+struct GatherColumnSink
+{
+	DynamicArray< DynamicArray<Component *> > *m_pColumns;
+	mutable bool m_SkipFirst;
+
+	void operator()(DynamicArray<Component *> &tuple) const
+	{
+		if (m_SkipFirst)
+		{
+			m_SkipFirst = false;
+			return;
+		}
+
+		for (size_t type_index = 0; type_index < tuple.GetSize(); ++type_index)
+		{
+			(*m_pColumns)[type_index].Push(tuple[type_index]);
+		}
+	}
+};
+
+template <class Sink>
+void EmitCachedQueryTuples( const Components::CachedQuery &rQuery, const Sink &sink );
+
 struct FoundComponentList
 {
 	Component *m_Component;
@@ -39,7 +104,383 @@ void EmitTuples(DynamicArray<Component *> &tuple, std::vector<FoundComponentList
 	while ( ( c = c->GetNextComponent() ) );
 }
 
+template <class Sink>
+void EmitArchetypeTuples(DynamicArray<Component *> &tuple, const Components::ArchetypeMatch &match, size_t row, size_t type_index, const Sink &emit_tuple_callback)
+{
+	const DynamicArray< size_t > &type_columns = match.m_TypeColumns[type_index];
+	for (DynamicArray< size_t >::ConstIterator column_iter = type_columns.Begin(); column_iter != type_columns.End(); ++column_iter)
+	{
+		// The column holds the first component of the type, any others are chained from it
+		Component *c = match.m_Archetype->m_Columns[*column_iter][row];
+		HELIUM_ASSERT( c );
+		do
+		{
+			tuple[type_index] = c;
+
+			if (type_index < match.m_TypeColumns.GetSize() - 1)
+			{
+				EmitArchetypeTuples(tuple, match, row, type_index + 1, emit_tuple_callback);
+			}
+			else
+			{
+				emit_tuple_callback(tuple);
+			}
+		}
+		while ( ( c = c->GetNextComponent() ) );
+	}
+}
+
+// Appends every tuple found in the archetype tables to rTuples, typesCount components at a time
+void GatherArchetypeTuples(Components::ArchetypeStorage &rStorage, const Components::TypeId *types, size_t typesCount, DynamicArray<Component *> &rTuples)
+{
+	DynamicArray<Component *> tuple;
+	tuple.Resize(typesCount);
+
+	GatherTupleSink sink = { &rTuples };
+
+	const Components::ArchetypeQuery &rQuery = rStorage.GetQuery(types, typesCount);
+	for (DynamicArray< Components::ArchetypeMatch >::ConstIterator match_iter = rQuery.m_Matches.Begin();
+		match_iter != rQuery.m_Matches.End(); ++match_iter)
+	{
+		const size_t row_count = match_iter->m_Archetype->GetRowCount();
+		for (size_t row = 0; row < row_count; ++row)
+		{
+			EmitArchetypeTuples(tuple, *match_iter, row, 0, sink);
+		}
+	}
+}
+
+// Callbacks may allocate or free components, which moves collections between archetypes (or cached query rows) and
+// swaps rows around under whatever is being walked. The matching tuples are gathered up front instead, and tuples
+// holding a component that was freed (or freed and reused) by an earlier callback are skipped.
+template <class Sink>
+void EmitLiveTuples(const DynamicArray<Component *> &tuples, size_t typesCount, const Sink &emit_tuple_callback)
+{
+	if (tuples.IsEmpty())
+	{
+		return;
+	}
+
+	DynamicArray<Components::GenerationIndex> generations;
+	generations.Reserve(tuples.GetSize());
+	for (DynamicArray<Component *>::ConstIterator iter = tuples.Begin(); iter != tuples.End(); ++iter)
+	{
+		generations.Push( (*iter)->GetInlineData().m_Generation );
+	}
+
+	DynamicArray<Component *> tuple;
+	tuple.Resize(typesCount);
+
+	for (size_t first = 0; first < tuples.GetSize(); first += typesCount)
+	{
+		bool live = true;
+		for (size_t type_index = 0; live && type_index < typesCount; ++type_index)
+		{
+			Component *c = tuples[first + type_index];
+			live = c->GetInlineData().m_Generation == generations[first + type_index] &&
+				Components::Pool::GetPool( c )->GetComponentCollection( c );
+
+			tuple[type_index] = c;
+		}
+
+		if (live)
+		{
+			emit_tuple_callback(tuple);
+		}
+	}
+}
+
+template <class Sink>
+void QueryArchetypesInternal(Components::ArchetypeStorage &rStorage, const Components::TypeId *types, size_t typesCount, const Sink &emit_tuple_callback)
+{
+	DynamicArray<Component *> tuples;
+	GatherArchetypeTuples(rStorage, types, typesCount, tuples);
+	EmitLiveTuples(tuples, typesCount, emit_tuple_callback);
+}
+
 void Helium::QueryComponentsInternal(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, ComponentTupleCallback emit_tuple_callback)
+{
+	// If no types to query, do nothing
+	if (!typesCount)
+	{
+		return;
+	}
+
+	// Walk the archetype tables if the manager keeps them
+	if (Components::ArchetypeStorage *pArchetypeStorage = rManager.GetArchetypeStorage())
+	{
+		CallbackTupleSink sink = { emit_tuple_callback };
+		QueryArchetypesInternal(*pArchetypeStorage, types, typesCount, sink);
+		return;
+	}
+
+	// Otherwise use the manager's persistent query for these types
+	rManager.GetCachedQuery(types, typesCount).Execute(emit_tuple_callback);
+}
+
+void Helium::QueryComponentsInternal(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, ComponentTupleContextCallback emit_tuple_callback, void *pContext)
+{
+	if (!typesCount)
+	{
+		return;
+	}
+
+	if (Components::ArchetypeStorage *pArchetypeStorage = rManager.GetArchetypeStorage())
+	{
+		ContextCallbackTupleSink sink = { emit_tuple_callback, pContext };
+		QueryArchetypesInternal(*pArchetypeStorage, types, typesCount, sink);
+		return;
+	}
+
+	rManager.GetCachedQuery(types, typesCount).Execute(emit_tuple_callback, pContext);
+}
+
+void Helium::GatherComponentTuples(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, DynamicArray<Component *> &rTuples)
+{
+	if (!typesCount)
+	{
+		return;
+	}
+
+	// Single types are already stored linearly in their pools
+	if (typesCount == 1)
+	{
+		for ( ComponentIteratorBase iterator(rManager, Components::GetTypeData( types[0] )->m_ImplementingTypes); iterator.GetBaseComponent(); iterator.Advance() )
+		{
+			rTuples.Push( iterator.GetBaseComponent() );
+		}
+
+		return;
+	}
+
+	if (Components::ArchetypeStorage *pArchetypeStorage = rManager.GetArchetypeStorage())
+	{
+		GatherArchetypeTuples(*pArchetypeStorage, types, typesCount, rTuples);
+		return;
+	}
+
+	rManager.GetCachedQuery(types, typesCount).Gather(rTuples);
+}
+
+// Same as GatherComponentTuples(), but appends each component to the array for its queried type
+void GatherComponentColumns(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, DynamicArray< DynamicArray<Component *> > &rColumns)
+{
+	if (typesCount == 1)
+	{
+		for ( ComponentIteratorBase iterator(rManager, Components::GetTypeData( types[0] )->m_ImplementingTypes); iterator.GetBaseComponent(); iterator.Advance() )
+		{
+			rColumns[0].Push( iterator.GetBaseComponent() );
+		}
+
+		return;
+	}
+
+	GatherColumnSink sink = { &rColumns, false };
+	EmitCachedQueryTuples(rManager.GetCachedQuery(types, typesCount), sink);
+}
+
+struct QueryChunkJob
+{
+	Component * const * const *m_pColumns;          // Per queried type, unless the chunk covers a match that isn't simple
+	size_t m_Count;                                 // Tuples in the chunk, or rows for chunks of archetype rows
+	const Components::ArchetypeMatch *m_pMatch;     // Match whose rows the chunk covers, null if the tuples were gathered
+	size_t m_FirstRow;
+	size_t m_TypesCount;
+	ComponentTupleChunkCallback m_Callback;
+	void *m_pContext;
+	ComponentCommandBuffer m_Commands;
+
+	static void RunCallback(void *pJob)
+	{
+		QueryChunkJob *pChunk = static_cast<QueryChunkJob *>(pJob);
+		const Components::ArchetypeMatch *pMatch = pChunk->m_pMatch;
+
+		// Gathered tuples and simple matches are handed to the callback in place
+		if (!pMatch || pMatch->m_Simple)
+		{
+			pChunk->m_Callback(pChunk->m_pColumns, pChunk->m_Count, pChunk->m_pContext, pChunk->m_Commands);
+			if (!pMatch)
+			{
+				return;
+			}
+		}
+
+		// Collect whatever the columns can't describe: tuples using components chained after the first of their
+		// type, or every tuple of the rows if a queried type is spread over several columns
+		const size_t typesCount = pChunk->m_TypesCount;
+
+		DynamicArray< DynamicArray<Component *> > columns;
+		columns.Resize(typesCount);
+
+		DynamicArray<Component *> tuple;
+		tuple.Resize(typesCount);
+
+		for (size_t row = 0; row < pChunk->m_Count; ++row)
+		{
+			if (pMatch->m_Simple)
+			{
+				bool chained = false;
+				for (size_t type_index = 0; !chained && type_index < typesCount; ++type_index)
+				{
+					chained = IsValid( pChunk->m_pColumns[type_index][row]->GetInlineData().m_Next );
+				}
+
+				if (!chained)
+				{
+					continue;
+				}
+			}
+
+			GatherColumnSink sink = { &columns, pMatch->m_Simple };
+			EmitArchetypeTuples(tuple, *pMatch, pChunk->m_FirstRow + row, 0, sink);
+		}
+
+		if (columns[0].IsEmpty())
+		{
+			return;
+		}
+
+		DynamicArray<Component * const *> column_pointers;
+		column_pointers.Resize(typesCount);
+		for (size_t type_index = 0; type_index < typesCount; ++type_index)
+		{
+			column_pointers[type_index] = columns[type_index].GetData();
+		}
+
+		pChunk->m_Callback(column_pointers.GetData(), columns[0].GetSize(), pChunk->m_pContext, pChunk->m_Commands);
+	}
+};
+
+void Helium::ParallelQueryComponentsInternal(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, ComponentTupleChunkCallback callback, void *pContext, size_t chunkSize)
+{
+	if (!typesCount)
+	{
+		return;
+	}
+
+	chunkSize = Max(chunkSize, static_cast<size_t>(1));
+
+	DynamicArray<QueryChunkJob> chunks;
+	DynamicArray<Component * const *> column_pointers;      // Columns of each chunk, typesCount at a time
+	DynamicArray< DynamicArray<Component *> > gathered;      // Tuples gathered up front if there are no archetype tables
+
+	if (Components::ArchetypeStorage *pArchetypeStorage = rManager.GetArchetypeStorage())
+	{
+		// Chunks are ranges of rows in the matching archetypes, which the jobs read in place
+		const Components::ArchetypeQuery &rQuery = pArchetypeStorage->GetQuery(types, typesCount);
+
+		size_t chunkCount = 0;
+		for (DynamicArray< Components::ArchetypeMatch >::ConstIterator match_iter = rQuery.m_Matches.Begin();
+			match_iter != rQuery.m_Matches.End(); ++match_iter)
+		{
+			chunkCount += (match_iter->m_Archetype->GetRowCount() + chunkSize - 1) / chunkSize;
+		}
+
+		if (!chunkCount)
+		{
+			return;
+		}
+
+		chunks.Resize(chunkCount);
+		column_pointers.Resize(chunkCount * typesCount);
+
+		size_t chunk_index = 0;
+		for (DynamicArray< Components::ArchetypeMatch >::ConstIterator match_iter = rQuery.m_Matches.Begin();
+			match_iter != rQuery.m_Matches.End(); ++match_iter)
+		{
+			const Components::Archetype *pArchetype = match_iter->m_Archetype;
+			const size_t row_count = pArchetype->GetRowCount();
+
+			for (size_t first_row = 0; first_row < row_count; first_row += chunkSize, ++chunk_index)
+			{
+				Component * const **pColumns = column_pointers.GetData() + chunk_index * typesCount;
+				if (match_iter->m_Simple)
+				{
+					for (size_t type_index = 0; type_index < typesCount; ++type_index)
+					{
+						pColumns[type_index] = pArchetype->m_Columns[ match_iter->m_TypeColumns[type_index][0] ].GetData() + first_row;
+					}
+				}
+
+				QueryChunkJob &rChunk = chunks[chunk_index];
+				rChunk.m_pColumns = pColumns;
+				rChunk.m_Count = Min(chunkSize, row_count - first_row);
+				rChunk.m_pMatch = &*match_iter;
+				rChunk.m_FirstRow = first_row;
+			}
+		}
+	}
+	else
+	{
+		gathered.Resize(typesCount);
+		GatherComponentColumns(rManager, types, typesCount, gathered);
+
+		const size_t tupleCount = gathered[0].GetSize();
+		if (!tupleCount)
+		{
+			return;
+		}
+
+		const size_t chunkCount = (tupleCount + chunkSize - 1) / chunkSize;
+		chunks.Resize(chunkCount);
+		column_pointers.Resize(chunkCount * typesCount);
+
+		for (size_t chunk_index = 0; chunk_index < chunkCount; ++chunk_index)
+		{
+			const size_t first_tuple = chunk_index * chunkSize;
+
+			Component * const **pColumns = column_pointers.GetData() + chunk_index * typesCount;
+			for (size_t type_index = 0; type_index < typesCount; ++type_index)
+			{
+				pColumns[type_index] = gathered[type_index].GetData() + first_tuple;
+			}
+
+			QueryChunkJob &rChunk = chunks[chunk_index];
+			rChunk.m_pColumns = pColumns;
+			rChunk.m_Count = Min(chunkSize, tupleCount - first_tuple);
+			rChunk.m_pMatch = NULL;
+			rChunk.m_FirstRow = first_tuple;
+		}
+	}
+
+	const size_t chunkCount = chunks.GetSize();
+	for (size_t chunk_index = 0; chunk_index < chunkCount; ++chunk_index)
+	{
+		QueryChunkJob &rChunk = chunks[chunk_index];
+		rChunk.m_TypesCount = typesCount;
+		rChunk.m_Callback = callback;
+		rChunk.m_pContext = pContext;
+	}
+
+	JobManager &rJobManager = JobManager::GetStaticInstance();
+	if (chunkCount == 1 || !rJobManager.IsInitialized())
+	{
+		for (size_t chunk_index = 0; chunk_index < chunkCount; ++chunk_index)
+		{
+			QueryChunkJob::RunCallback(&chunks[chunk_index]);
+		}
+	}
+	else
+	{
+		// Run the first chunk here while the workers pick up the rest
+		JobCounter counter;
+		for (size_t chunk_index = 1; chunk_index < chunkCount; ++chunk_index)
+		{
+			rJobManager.Spawn(chunks[chunk_index], &counter);
+		}
+
+		QueryChunkJob::RunCallback(&chunks[0]);
+		rJobManager.WaitForCounter(counter);
+	}
+
+	// Nothing is looking at the tuples any more, so apply structural changes in chunk order
+	for (size_t chunk_index = 0; chunk_index < chunkCount; ++chunk_index)
+	{
+		chunks[chunk_index].m_Commands.Execute();
+	}
+}
+
+void Helium::QueryComponentsUncached(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, ComponentTupleCallback emit_tuple_callback)
 {
 	// If no types to query, do nothing
 	if (!typesCount)
@@ -69,6 +510,9 @@ void Helium::QueryComponentsInternal(ComponentManager &rManager, const Component
 	std::sort(found_components.begin(), found_components.end(), SortFoundComponentList);
 	
 	const DynamicArray< Components::TypeId > &implementing_types = Components::GetTypeData( found_components[0].m_TypeId )->m_ImplementingTypes;
+
+	DynamicArray<Component *> tuple;
+	tuple.Resize(typesCount);
 	
 	// For every component
 	for ( ComponentIteratorBase iterator(rManager, implementing_types); iterator.GetBaseComponent(); iterator.Advance() )
@@ -94,10 +538,304 @@ void Helium::QueryComponentsInternal(ComponentManager &rManager, const Component
 		
 		if (emit_tuples)
 		{
-			DynamicArray<Component *> tuple;
-			tuple.Resize(typesCount);
 			tuple[found_components[0].m_TypeIndex] = outer_component;
 			EmitTuples(tuple, found_components, 1, emit_tuple_callback);
 		}
 	}
 }
+
+//////////////////////////////////////////////////////////////////////////
+// CachedQuery
+
+Components::CachedQuery::CachedQuery( ComponentManager &rManager, const TypeId *types, size_t typesCount )
+{
+	HELIUM_ASSERT( typesCount );
+
+	m_Types.Reserve( typesCount );
+	m_ImplementingTypes.Reserve( typesCount );
+	m_RefreshComponents.Resize( typesCount );
+
+	for (size_t type_index = 0; type_index < typesCount; ++type_index)
+	{
+		m_Types.Push( types[type_index] );
+
+		const DynamicArray< TypeId > &implementing_types = GetTypeData( types[type_index] )->m_ImplementingTypes;
+		m_ImplementingTypes.Push( &implementing_types );
+
+		// Keep a sorted list of every type whose changes can affect the query
+		for (DynamicArray< TypeId >::ConstIterator iter = implementing_types.Begin(); iter != implementing_types.End(); ++iter)
+		{
+			if ( IsAffectedBy( *iter ) )
+			{
+				continue;
+			}
+
+			size_t insert_index = m_AffectingTypes.GetSize();
+			m_AffectingTypes.Push( *iter );
+			while ( insert_index > 0 && m_AffectingTypes[ insert_index - 1 ] > *iter )
+			{
+				m_AffectingTypes[ insert_index ] = m_AffectingTypes[ insert_index - 1 ];
+				--insert_index;
+			}
+
+			m_AffectingTypes[ insert_index ] = *iter;
+		}
+	}
+
+	// Pick up every collection that already has a component implementing the first type
+	for ( ComponentIteratorBase iterator( rManager, *m_ImplementingTypes[ 0 ] ); iterator.GetBaseComponent(); iterator.Advance() )
+	{
+		ComponentCollection *pCollection = iterator.GetBaseComponent()->GetComponentCollection();
+		HELIUM_ASSERT( pCollection );
+		Refresh( *pCollection );
+	}
+}
+
+Components::CachedQuery::~CachedQuery()
+{
+	// Collections may outlive the query, so take our rows out of their lists
+	while ( !m_Collections.IsEmpty() )
+	{
+		RemoveRow( m_Collections.GetSize() - 1 );
+	}
+}
+
+bool Components::CachedQuery::Matches( const TypeId *types, size_t typesCount ) const
+{
+	if ( typesCount != m_Types.GetSize() )
+	{
+		return false;
+	}
+
+	for (size_t type_index = 0; type_index < typesCount; ++type_index)
+	{
+		if ( types[type_index] != m_Types[type_index] )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool Components::CachedQuery::IsAffectedBy( TypeId typeId ) const
+{
+	// Binary search the sorted list
+	size_t low = 0;
+	size_t high = m_AffectingTypes.GetSize();
+	while ( low < high )
+	{
+		size_t middle = ( low + high ) / 2;
+		if ( m_AffectingTypes[ middle ] < typeId )
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	return low < m_AffectingTypes.GetSize() && m_AffectingTypes[ low ] == typeId;
+}
+
+void Components::CachedQuery::Refresh( ComponentCollection &rCollection )
+{
+	// Find the row we already have for this collection, if any
+	size_t row = Invalid< size_t >();
+	for (DynamicArray< CachedQueryRow >::ConstIterator iter = rCollection.m_CachedQueryRows.Begin();
+		iter != rCollection.m_CachedQueryRows.End(); ++iter)
+	{
+		if ( iter->m_Query == this )
+		{
+			row = iter->m_Row;
+			break;
+		}
+	}
+
+	const size_t typesCount = m_Types.GetSize();
+	Component **components = m_RefreshComponents.GetData();
+
+	bool simple = true;
+	for (size_t type_index = 0; type_index < typesCount; ++type_index)
+	{
+		components[ type_index ] = NULL;
+
+		const DynamicArray< TypeId > &implementing_types = *m_ImplementingTypes[ type_index ];
+		for (DynamicArray< TypeId >::ConstIterator iter = implementing_types.Begin(); iter != implementing_types.End(); ++iter)
+		{
+			Component *pComponent = rCollection.GetFirst( *iter );
+			if ( !pComponent )
+			{
+				continue;
+			}
+
+			if ( components[ type_index ] )
+			{
+				simple = false;
+				break;
+			}
+
+			components[ type_index ] = pComponent;
+		}
+
+		// The collection doesn't match, drop it if we had it
+		if ( !components[ type_index ] )
+		{
+			if ( IsValid( row ) )
+			{
+				RemoveRow( row );
+			}
+
+			return;
+		}
+	}
+
+	if ( !IsValid( row ) )
+	{
+		row = m_Collections.GetSize();
+		AddRow( rCollection );
+	}
+
+	MemoryCopy( m_Components.GetData() + row * typesCount, components, typesCount * sizeof( Component * ) );
+	m_Simple[ row ] = simple;
+}
+
+void Components::CachedQuery::AddRow( ComponentCollection &rCollection )
+{
+	CachedQueryRow queryRow;
+	queryRow.m_Query = this;
+	queryRow.m_Row = static_cast< uint32_t >( m_Collections.GetSize() );
+	rCollection.m_CachedQueryRows.Push( queryRow );
+
+	m_Collections.Push( &rCollection );
+	m_Components.Resize( m_Components.GetSize() + m_Types.GetSize() );
+	m_Simple.Push( true );
+}
+
+void Components::CachedQuery::RemoveRow( size_t row )
+{
+	const size_t typesCount = m_Types.GetSize();
+	const size_t last_row = m_Collections.GetSize() - 1;
+	HELIUM_ASSERT( row <= last_row );
+
+	// Take the row out of its collection's list
+	DynamicArray< CachedQueryRow > &rRemovedRows = m_Collections[ row ]->m_CachedQueryRows;
+	for ( size_t i = 0; i < rRemovedRows.GetSize(); ++i )
+	{
+		if ( rRemovedRows[ i ].m_Query == this )
+		{
+			rRemovedRows.RemoveSwap( i );
+			break;
+		}
+	}
+
+	// Swap the last row into the one being removed
+	if ( row != last_row )
+	{
+		ComponentCollection *pMoved = m_Collections[ last_row ];
+		m_Collections[ row ] = pMoved;
+		m_Simple[ row ] = m_Simple[ last_row ];
+		MemoryCopy(
+			m_Components.GetData() + row * typesCount,
+			m_Components.GetData() + last_row * typesCount,
+			typesCount * sizeof( Component * ) );
+
+		for (DynamicArray< CachedQueryRow >::Iterator iter = pMoved->m_CachedQueryRows.Begin();
+			iter != pMoved->m_CachedQueryRows.End(); ++iter)
+		{
+			if ( iter->m_Query == this )
+			{
+				iter->m_Row = static_cast< uint32_t >( row );
+				break;
+			}
+		}
+	}
+
+	m_Collections.Pop();
+	m_Simple.Pop();
+	m_Components.Resize( last_row * typesCount );
+}
+
+template <class Sink>
+void EmitCollectionTuples( const Components::CachedQuery &rQuery, DynamicArray<Component *> &tuple, ComponentCollection &rCollection, size_t typeIndex, const Sink &sink )
+{
+	const DynamicArray< Components::TypeId > &implementing_types = rQuery.GetImplementingTypes( typeIndex );
+	for (DynamicArray< Components::TypeId >::ConstIterator iter = implementing_types.Begin(); iter != implementing_types.End(); ++iter)
+	{
+		for ( Component *c = rCollection.GetFirst( *iter ); c; c = c->GetNextComponent() )
+		{
+			tuple[ typeIndex ] = c;
+
+			if ( typeIndex < rQuery.GetTypeCount() - 1 )
+			{
+				EmitCollectionTuples( rQuery, tuple, rCollection, typeIndex + 1, sink );
+			}
+			else
+			{
+				sink( tuple );
+			}
+		}
+	}
+}
+
+// Walks the rows without calling out to anything that could change them, see EmitLiveTuples() for running callbacks
+template <class Sink>
+void EmitCachedQueryTuples( const Components::CachedQuery &rQuery, const Sink &sink )
+{
+	const size_t typesCount = rQuery.GetTypeCount();
+
+	DynamicArray<Component *> tuple;
+	tuple.Resize( typesCount );
+
+	const size_t rowCount = rQuery.GetRowCount();
+	for ( size_t row = 0; row < rowCount; ++row )
+	{
+		bool single = rQuery.IsRowSimple( row );
+		if ( single )
+		{
+			// Common case: a single component of each type
+			Component * const *pRowComponents = rQuery.GetRowComponents( row );
+			for (size_t type_index = 0; type_index < typesCount; ++type_index)
+			{
+				tuple[ type_index ] = pRowComponents[ type_index ];
+				single = single && !IsValid( pRowComponents[ type_index ]->GetInlineData().m_Next );
+			}
+		}
+
+		if ( single )
+		{
+			sink( tuple );
+		}
+		else
+		{
+			EmitCollectionTuples( rQuery, tuple, *rQuery.GetRowCollection( row ), 0, sink );
+		}
+	}
+}
+
+void Components::CachedQuery::Execute( ComponentTupleCallback callback ) const
+{
+	DynamicArray<Component *> tuples;
+	Gather( tuples );
+
+	CallbackTupleSink sink = { callback };
+	EmitLiveTuples( tuples, GetTypeCount(), sink );
+}
+
+void Components::CachedQuery::Execute( ComponentTupleContextCallback callback, void *pContext ) const
+{
+	DynamicArray<Component *> tuples;
+	Gather( tuples );
+
+	ContextCallbackTupleSink sink = { callback, pContext };
+	EmitLiveTuples( tuples, GetTypeCount(), sink );
+}
+
+void Components::CachedQuery::Gather( DynamicArray<Component *> &rTuples ) const
+{
+	rTuples.Reserve( rTuples.GetSize() + GetRowCount() * GetTypeCount() );
+
+	GatherTupleSink sink = { &rTuples };
+	EmitCachedQueryTuples( *this, sink );
+}
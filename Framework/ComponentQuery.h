@@ -7,9 +7,79 @@
 
 namespace Helium
 {
+	class ComponentCommandBuffer;
+
 	typedef void (*ComponentTupleCallback)(DynamicArray<Component *> &tuple);
+
+	// Same as ComponentTupleCallback, along with a user context passed through by the query
+	typedef void (*ComponentTupleContextCallback)(DynamicArray<Component *> &tuple, void *pContext);
+
+	// Processes a chunk of tuples found by a parallel query. There is one array of tupleCount components per queried type,
+	// so tuple i is pColumns[0][i], pColumns[1][i] and so on. With archetype tables these usually point straight into
+	// the archetype columns.
+	typedef void (*ComponentTupleChunkCallback)(Component * const * const *pColumns, size_t tupleCount, void *pContext, ComponentCommandBuffer &rCommands);
+
+	namespace Components
+	{
+		// Default number of tuples handed to each job by a parallel query
+		const static size_t PARALLEL_QUERY_CHUNK_SIZE = 64;
+	}
 	
 	void HELIUM_FRAMEWORK_API QueryComponentsInternal(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, ComponentTupleCallback callback);
+	void HELIUM_FRAMEWORK_API QueryComponentsInternal(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, ComponentTupleContextCallback callback, void *pContext);
+
+	// Walks the pools directly without registering a cached query. Slower, but useful for one-off queries.
+	void HELIUM_FRAMEWORK_API QueryComponentsUncached(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, ComponentTupleCallback callback);
+
+	// Appends every matching tuple to rTuples, typesCount components at a time
+	void HELIUM_FRAMEWORK_API GatherComponentTuples(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, DynamicArray<Component *> &rTuples);
+
+	// Splits the matching tuples into chunks and processes them on the job manager's worker threads. With archetype
+	// tables, each chunk is a range of rows in a matching archetype and reads its columns in place; otherwise the tuples
+	// are gathered up front. Structural changes must go through the chunk's command buffer, which is applied on the
+	// calling thread after all chunks are done.
+	void HELIUM_FRAMEWORK_API ParallelQueryComponentsInternal(ComponentManager &rManager, const Components::TypeId *types, size_t typesCount, ComponentTupleChunkCallback callback, void *pContext, size_t chunkSize);
+
+	namespace Components
+	{
+		// Persistent query registered on a ComponentManager. Keeps a dense list of the collections that have a component
+		// implementing each of the queried types, along with the first such component of each type. The manager
+		// refreshes a collection's row whenever the first component of a type in it changes, so running the query over
+		// an unchanged set of entities only walks the rows.
+		class HELIUM_FRAMEWORK_API CachedQuery : NonCopyable
+		{
+		public:
+			CachedQuery( ComponentManager &rManager, const TypeId *types, size_t typesCount );
+			~CachedQuery();
+
+			bool                        Matches( const TypeId *types, size_t typesCount ) const;
+			bool                        IsAffectedBy( TypeId typeId ) const;
+			void                        Refresh( ComponentCollection &rCollection );
+			void                        Execute( ComponentTupleCallback callback ) const;
+			void                        Execute( ComponentTupleContextCallback callback, void *pContext ) const;
+			void                        Gather( DynamicArray<Component *> &rTuples ) const;
+
+			inline size_t               GetTypeCount() const;
+			inline const DynamicArray< TypeId >& GetImplementingTypes( size_t typeIndex ) const;
+			inline size_t               GetRowCount() const;
+			inline ComponentCollection* GetRowCollection( size_t row ) const;
+			inline Component * const *  GetRowComponents( size_t row ) const;
+			inline bool                 IsRowSimple( size_t row ) const;
+
+		private:
+			void                        AddRow( ComponentCollection &rCollection );
+			void                        RemoveRow( size_t row );
+
+			DynamicArray< TypeId >                         m_Types;
+			DynamicArray< const DynamicArray< TypeId > * > m_ImplementingTypes;  //< Per queried type
+			DynamicArray< TypeId >                         m_AffectingTypes;     //< All implementing types, sorted
+
+			DynamicArray< ComponentCollection * >          m_Collections;        //< Collection for each row
+			DynamicArray< Component * >                    m_Components;         //< First component of each queried type, per row
+			DynamicArray< bool >                           m_Simple;             //< False if a queried type is implemented by several types in the row's collection
+			DynamicArray< Component * >                    m_RefreshComponents;  //< Scratch space for Refresh(), one per queried type
+		};
+	}
 	
 	template <class A, class B, void (*F)(A *, B *)>
 	void TupleHandler(DynamicArray<Component *> &components)
@@ -27,4 +97,86 @@ namespace Helium
 			static_cast<B *>(components[1]), 
 			static_cast<C *>(components[2]));
 	}
+
+	template <class A, class B, class Context, void (*F)(A *, B *, Context &)>
+	void TupleContextHandler(DynamicArray<Component *> &components, void *pContext)
+	{
+		F(
+			static_cast<A *>(components[0]), 
+			static_cast<B *>(components[1]), 
+			*static_cast<Context *>(pContext));
+	}
+
+	template <class A, class B, class C, class Context, void (*F)(A *, B *, C *, Context &)>
+	void TupleContextHandler(DynamicArray<Component *> &components, void *pContext)
+	{
+		F(
+			static_cast<A *>(components[0]), 
+			static_cast<B *>(components[1]), 
+			static_cast<C *>(components[2]), 
+			*static_cast<Context *>(pContext));
+	}
+
+	template <class A, void (*F)(A *, ComponentCommandBuffer &)>
+	void TupleChunkCommandHandler(Component * const * const *pColumns, size_t tupleCount, void *, ComponentCommandBuffer &rCommands)
+	{
+		for (size_t i = 0; i < tupleCount; ++i)
+		{
+			F(static_cast<A *>(pColumns[0][i]), rCommands);
+		}
+	}
+
+	template <class A, class B, class Context, void (*F)(A *, B *, Context &)>
+	void TupleChunkContextHandler(Component * const * const *pColumns, size_t tupleCount, void *pContext, ComponentCommandBuffer &)
+	{
+		Context &rContext = *static_cast<Context *>(pContext);
+		for (size_t i = 0; i < tupleCount; ++i)
+		{
+			F(
+				static_cast<A *>(pColumns[0][i]), 
+				static_cast<B *>(pColumns[1][i]), 
+				rContext);
+		}
+	}
+
+	template <class A, class Context, void (*F)(A *, Context &, ComponentCommandBuffer &)>
+	void TupleChunkHandler(Component * const * const *pColumns, size_t tupleCount, void *pContext, ComponentCommandBuffer &rCommands)
+	{
+		Context &rContext = *static_cast<Context *>(pContext);
+		for (size_t i = 0; i < tupleCount; ++i)
+		{
+			F(static_cast<A *>(pColumns[0][i]), rContext, rCommands);
+		}
+	}
+
+	template <class A, class B, class Context, void (*F)(A *, B *, Context &, ComponentCommandBuffer &)>
+	void TupleChunkHandler(Component * const * const *pColumns, size_t tupleCount, void *pContext, ComponentCommandBuffer &rCommands)
+	{
+		Context &rContext = *static_cast<Context *>(pContext);
+		for (size_t i = 0; i < tupleCount; ++i)
+		{
+			F(
+				static_cast<A *>(pColumns[0][i]), 
+				static_cast<B *>(pColumns[1][i]), 
+				rContext, 
+				rCommands);
+		}
+	}
+
+	template <class A, class B, class C, class Context, void (*F)(A *, B *, C *, Context &, ComponentCommandBuffer &)>
+	void TupleChunkHandler(Component * const * const *pColumns, size_t tupleCount, void *pContext, ComponentCommandBuffer &rCommands)
+	{
+		Context &rContext = *static_cast<Context *>(pContext);
+		for (size_t i = 0; i < tupleCount; ++i)
+		{
+			F(
+				static_cast<A *>(pColumns[0][i]), 
+				static_cast<B *>(pColumns[1][i]), 
+				static_cast<C *>(pColumns[2][i]), 
+				rContext, 
+				rCommands);
+		}
+	}
 }
+
+#include "Framework/ComponentQuery.inl"
@@ -0,0 +1,41 @@
+namespace Helium
+{
+	namespace Components
+	{
+		size_t CachedQuery::GetTypeCount() const
+		{
+			return m_Types.GetSize();
+		}
+
+		const DynamicArray< TypeId >& CachedQuery::GetImplementingTypes( size_t typeIndex ) const
+		{
+			HELIUM_ASSERT( typeIndex < m_ImplementingTypes.GetSize() );
+			return *m_ImplementingTypes[ typeIndex ];
+		}
+
+		size_t CachedQuery::GetRowCount() const
+		{
+			return m_Collections.GetSize();
+		}
+
+		ComponentCollection* CachedQuery::GetRowCollection( size_t row ) const
+		{
+			HELIUM_ASSERT( row < m_Collections.GetSize() );
+			return m_Collections[ row ];
+		}
+
+		// First component of each queried type for the row, in query order. Further components of a type in the same
+		// collection are chained from it. Only complete if IsRowSimple() is true.
+		Component * const * CachedQuery::GetRowComponents( size_t row ) const
+		{
+			HELIUM_ASSERT( row < m_Collections.GetSize() );
+			return m_Components.GetData() + row * m_Types.GetSize();
+		}
+
+		bool CachedQuery::IsRowSimple( size_t row ) const
+		{
+			HELIUM_ASSERT( row < m_Simple.GetSize() );
+			return m_Simple[ row ];
+		}
+	}
+}
@@ -1,8 +1,12 @@
 
 #include "FrameworkPch.h"
 #include "Framework/Components.h"
+#include "Framework/ComponentArchetype.h"
+#include "Framework/ComponentQuery.h"
 #include "Framework/SystemDefinition.h"
 
+#include "Platform/Atomic.h"
+#include "Platform/Locks.h"
 #include "Foundation/Numeric.h"
 #include "Reflect/TranslatorDeduction.h"
 #include "Engine/Asset.h"
@@ -25,8 +29,43 @@ namespace
 	int32_t                    g_ComponentsInitCount = 0;
 	int32_t                    g_ComponentManagerInstanceCount = 0;
 	DynamicArray<TypeData *>   g_ComponentTypes;
-	ComponentPtrBase*          g_ComponentPtrRegistry[COMPONENT_PTR_CHECK_FREQUENCY];
-	uint16_t                   g_ComponentProcessPendingDeletesCallCount = 0;
+
+	// Pools by handle slot. Slots are only written (under g_PoolTableLock) when pools are created or destroyed, handles
+	// read them without locking. The generation is published last with release semantics when a pool is created, and
+	// bumped first when it is destroyed, so a reader that sees the same generation before and after reading the pool
+	// pointer knows the pointer belongs to that generation.
+	struct PoolTableEntry
+	{
+		PoolTableEntry()
+			: m_Pool( NULL )
+			, m_Generation( 0 )
+		{
+		}
+
+		Pool* volatile         m_Pool;
+		volatile int32_t       m_Generation;   //< Only the low 16 bits are used by handles
+	};
+
+	// The table grows a block at a time. Blocks are never freed or moved, so readers can index them without locking.
+	const size_t               POOL_TABLE_BLOCK_COUNT = MAX_POOL_COUNT / POOL_TABLE_BLOCK_SIZE;
+	PoolTableEntry*            g_PoolTableBlocks[POOL_TABLE_BLOCK_COUNT];
+	DynamicArray<PoolIndex>    g_FreePoolIndices;
+	size_t                     g_PoolTableCount = 0;
+	SpinLock                   g_PoolTableLock; //< Worlds may be created and destroyed on different threads
+
+	// Must be called with g_PoolTableLock held, or for a slot that is known to be in use
+	PoolTableEntry &GetPoolTableEntry( size_t poolIndex )
+	{
+		HELIUM_ASSERT( poolIndex < g_PoolTableCount );
+		return g_PoolTableBlocks[ poolIndex / POOL_TABLE_BLOCK_SIZE ][ poolIndex % POOL_TABLE_BLOCK_SIZE ];
+	}
+
+	// Advance a slot's generation, skipping 0 so a zeroed handle never resolves
+	void BumpPoolTableGeneration( PoolTableEntry &rEntry )
+	{
+		int32_t generation = ( rEntry.m_Generation + 1 ) & 0xffff;
+		AtomicExchangeRelease( rEntry.m_Generation, generation ? generation : 1 );
+	}
 }
 
 ComponentRegistrar<Helium::Component, void> Helium::Component::s_ComponentRegistrar("Helium::Component");
@@ -178,6 +217,42 @@ Pool* Pool::CreatePool( ComponentManager *pComponentManager, const TypeData &rTy
 	HELIUM_ASSERT( componentSize );
 	componentSize = PAD_VALUE(componentSize, HELIUM_SIMD_ALIGNMENT);
 
+	// Claim a handle slot first, so running out of them doesn't leave a half built pool behind
+	g_PoolTableLock.Lock();
+	PoolIndex poolIndex;
+	if ( !g_FreePoolIndices.IsEmpty() )
+	{
+		poolIndex = g_FreePoolIndices.GetLast();
+		g_FreePoolIndices.Pop();
+	}
+	else if ( g_PoolTableCount < MAX_POOL_COUNT )
+	{
+		// Add a block to the table once the last one is full. It is in place before any handle can refer to it.
+		if ( g_PoolTableCount % POOL_TABLE_BLOCK_SIZE == 0 )
+		{
+			PoolTableEntry *&rpBlock = g_PoolTableBlocks[ g_PoolTableCount / POOL_TABLE_BLOCK_SIZE ];
+			if ( !rpBlock )
+			{
+				rpBlock = new PoolTableEntry[ POOL_TABLE_BLOCK_SIZE ];
+				HELIUM_ASSERT( rpBlock );
+			}
+		}
+
+		poolIndex = static_cast<PoolIndex>( g_PoolTableCount++ );
+	}
+	else
+	{
+		g_PoolTableLock.Unlock();
+
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			"Components::Pool::CreatePool - Out of pool handle slots (%" PRIuSZ " pools alive), cannot create pool for type %s\n",
+			MAX_POOL_COUNT,
+			rTypeData.m_Structure->m_Name);
+		return NULL;
+	}
+	g_PoolTableLock.Unlock();
+
 	size_t poolSize = PAD_VALUE( sizeof( Components::Pool ), HELIUM_SIMD_ALIGNMENT );
 	size_t memoryRequried = poolSize + componentSize * count;
 	Pool *pool = (Pool *)g_ComponentAllocator.AllocateAligned( POOL_ALIGN_SIZE, memoryRequried );
@@ -192,6 +267,17 @@ Pool* Pool::CreatePool( ComponentManager *pComponentManager, const TypeData &rTy
 	pool->m_ComponentSize = componentSize;
 	pool->m_FirstUnallocatedIndex = 0;
 	pool->m_ComponentOffset = rTypeData.GetOffsetOfComponent();
+
+	pool->m_PoolIndex = poolIndex;
+
+	g_PoolTableLock.Lock();
+
+	// Publish the pool before its generation, so readers can't pair the new generation with an older pointer
+	PoolTableEntry &rEntry = GetPoolTableEntry( pool->m_PoolIndex );
+	rEntry.m_Pool = pool;
+	BumpPoolTableGeneration( rEntry );
+	pool->m_PoolGeneration = static_cast<uint16_t>( rEntry.m_Generation );
+	g_PoolTableLock.Unlock();
 		
 	pool->m_Roster.Resize( count );
 
@@ -238,12 +324,42 @@ void Pool::DestroyPool( Pool *pPool )
 			pPool->m_Type->m_Structure->m_Name);
 	}
 
+	g_PoolTableLock.Lock();
+	PoolTableEntry &rEntry = GetPoolTableEntry( pPool->m_PoolIndex );
+	HELIUM_ASSERT( rEntry.m_Pool == pPool );
+
+	// Invalidate handles to the pool before clearing the pointer
+	BumpPoolTableGeneration( rEntry );
+	rEntry.m_Pool = NULL;
+	g_FreePoolIndices.Push( pPool->m_PoolIndex );
+	g_PoolTableLock.Unlock();
+
 	HELIUM_DELETE_A( g_ComponentAllocator, pPool->m_ParallelData );
 	pPool->~Pool();
 	g_ComponentAllocator.FreeAligned( pPool );
 	
 }
 
+Pool* Pool::FindPool( PoolIndex poolIndex, uint16_t poolGeneration )
+{
+	// A block is published before any pool in it, so a missing block means the handle was never valid
+	PoolTableEntry *pBlock = g_PoolTableBlocks[ poolIndex / POOL_TABLE_BLOCK_SIZE ];
+	if ( !pBlock )
+	{
+		return NULL;
+	}
+
+	const PoolTableEntry &rEntry = pBlock[ poolIndex % POOL_TABLE_BLOCK_SIZE ];
+	if ( rEntry.m_Generation != poolGeneration )
+	{
+		return NULL;
+	}
+
+	// The slot may be reused between reading the generation and the pool, so check the generation again afterwards
+	Pool *pPool = rEntry.m_Pool;
+	return rEntry.m_Generation == poolGeneration ? pPool : NULL;
+}
+
 void Pool::InsertIntoChain(Component *_insertee, ComponentIndex _insertee_index, Component *nextComponent)
 {
 	// If we are inserting into a 0-length chain do nothing
@@ -295,6 +411,12 @@ void Pool::RemoveFromChain(Component *_component, ComponentIndex index)
 		m_ParallelData[ index ].m_Collection->m_Components.Remove( m_TypeId );
 	}
 
+	// Whether it was replaced or removed, the collection's first component of this type was affected
+	if ( previous_index == Invalid<ComponentIndex>() )
+	{
+		m_ComponentManager->OnFirstComponentChanged( *m_ParallelData[ index ].m_Collection, m_TypeId );
+	}
+
 	// If we have a next node, repoint its previous pointer to our previous pointer
 	if ( _component->m_InlineData.m_Next != Invalid<uint16_t>() )
 	{
@@ -349,6 +471,10 @@ Component* Pool::Allocate( IHasComponents *owner, ComponentCollection &collectio
 	m_Type->Construct( component );
 	HELIUM_ASSERT( component->m_InlineData.m_OffsetToPoolStart);
 
+	// New components always become the first of their type in the collection. Only notify once the component is fully
+	// set up, as listeners look up its collection.
+	m_ComponentManager->OnFirstComponentChanged( collection, m_TypeId );
+
 	return component;
 }
 
@@ -422,6 +548,7 @@ void Helium::Components::Pool::SpewRosterToTty()
 
 Helium::ComponentManager::ComponentManager(World *pWorld)
 	: m_World(pWorld)
+	, m_ArchetypeStorage(NULL)
 {
 	for (DynamicArray<TypeData *>::Iterator iter = g_ComponentTypes.Begin();
 		iter != g_ComponentTypes.End(); ++iter)
@@ -436,6 +563,15 @@ Helium::ComponentManager::~ComponentManager()
 {
 	Tick(); // Process pending deletes if necessary
 
+	// Delete the cached queries first, so that freeing the remaining components doesn't refresh them
+	for (DynamicArray<CachedQuery *>::Iterator iter = m_CachedQueries.Begin();
+		iter != m_CachedQueries.End(); ++iter)
+	{
+		delete *iter;
+	}
+
+	m_CachedQueries.Clear();
+
 	for (DynamicArray<Pool *>::Iterator iter = m_Pools.Begin();
 		iter != m_Pools.End(); ++iter)
 	{
@@ -455,104 +591,109 @@ Helium::ComponentManager::~ComponentManager()
 	}
 
 	m_Pools.Clear();
+
+	delete m_ArchetypeStorage;
+	m_ArchetypeStorage = NULL;
 }
 
-void Helium::Components::Tick()
+CachedQuery& Helium::ComponentManager::GetCachedQuery( const TypeId *types, size_t typesCount )
 {
-	++g_ComponentProcessPendingDeletesCallCount;
-
-	// Look at our registry of component ptrs, we may need to force some of them to invalidate (a ptr must be checked
-	// at least once every 256 frames in case the generation counter overlaps)
-	uint32_t registry_index = g_ComponentProcessPendingDeletesCallCount % COMPONENT_PTR_CHECK_FREQUENCY;
-	ComponentPtrBase *component_ptr = g_ComponentPtrRegistry[registry_index];
-
-	// Double-check that the component head index is set
-	HELIUM_ASSERT(!component_ptr || component_ptr->m_ComponentPtrRegistryHeadIndex == registry_index);
+	// Tasks running in parallel may look up queries on the same manager
+	m_CachedQueriesLock.Lock();
 
-	while (component_ptr)
+	CachedQuery *pQuery = NULL;
+	for (DynamicArray<CachedQuery *>::Iterator iter = m_CachedQueries.Begin();
+		iter != m_CachedQueries.End(); ++iter)
 	{
-		// Don't do the check until we get our next pointer, as a failed check will splice out the ptr from our doubly
-		// linked list.
-		ComponentPtrBase *component_ptr_to_check = component_ptr;
-		component_ptr = component_ptr->GetNextComponetPtr();
-		component_ptr_to_check->Check();
+		if ( (*iter)->Matches( types, typesCount ) )
+		{
+			pQuery = *iter;
+			break;
+		}
 	}
-	
-	// Even after we evict components, we still need to verify that we either have no component or the head component
-	// has a properly set index
-	HELIUM_ASSERT(
-		!g_ComponentPtrRegistry[registry_index] || 
-		g_ComponentPtrRegistry[registry_index]->m_ComponentPtrRegistryHeadIndex == registry_index);
-}
 
-void Helium::ComponentManager::RegisterComponentPtr( ComponentPtrBase &pPtr )
-{
-	uint16_t registry_index = g_ComponentProcessPendingDeletesCallCount % COMPONENT_PTR_CHECK_FREQUENCY;
-	pPtr.m_Next = g_ComponentPtrRegistry[registry_index];
-	
-	if (pPtr.m_Next)
+	if ( !pQuery )
 	{
-		// Make the current head component's previous pointer point to the new component, and clear the head component index
-		HELIUM_ASSERT(pPtr.m_Next->m_ComponentPtrRegistryHeadIndex == registry_index);
-		pPtr.m_Next->m_Previous = &pPtr;
-		pPtr.m_Next->m_ComponentPtrRegistryHeadIndex = Helium::Invalid<uint16_t>();
+		pQuery = new CachedQuery( *this, types, typesCount );
+		m_CachedQueries.Push( pQuery );
 	}
 
-	pPtr.m_ComponentPtrRegistryHeadIndex = registry_index;
-	g_ComponentPtrRegistry[registry_index] = &pPtr;
+	m_CachedQueriesLock.Unlock();
+
+	return *pQuery;
 }
 
-size_t Helium::ComponentManager::CountAllocatedComponentsThatImplement( Components::TypeId typeId ) const
+void Helium::ComponentManager::OnFirstComponentChanged( ComponentCollection &rCollection, TypeId typeId )
 {
-	TypeData *pTypeData = g_ComponentTypes[ typeId ];
+	if ( m_ArchetypeStorage )
+	{
+		m_ArchetypeStorage->OnFirstComponentChanged( rCollection, typeId );
+	}
 
-	size_t count = 0;
-	for (DynamicArray< TypeId >::Iterator iter = pTypeData->m_ImplementingTypes.Begin();
-		iter != pTypeData->m_ImplementingTypes.End(); ++iter)
+	// Queries may be created by tasks running in parallel with this
+	m_CachedQueriesLock.Lock();
+
+	for (DynamicArray<CachedQuery *>::Iterator iter = m_CachedQueries.Begin();
+		iter != m_CachedQueries.End(); ++iter)
 	{
-		count += m_Pools[ *iter ]->GetAllocatedCount();
+		if ( (*iter)->IsAffectedBy( typeId ) )
+		{
+			(*iter)->Refresh( rCollection );
+		}
 	}
 
-	return count;
+	m_CachedQueriesLock.Unlock();
 }
 
-void Helium::ComponentPtrBase::Unlink() const
+void Helium::ComponentManager::EnableArchetypeStorage()
 {
-	// If we are the head node in the component ptr registry, we need to point it to the new head
-	if (m_ComponentPtrRegistryHeadIndex != Helium::Invalid<uint16_t>())
+	if ( m_ArchetypeStorage )
 	{
-		ComponentPtrBase *current_head = g_ComponentPtrRegistry[m_ComponentPtrRegistryHeadIndex];
-		HELIUM_ASSERT(current_head == this);
-		HELIUM_ASSERT(!m_Previous);
+		return;
+	}
 
-		// If this new node is legit, mark it as a head node
-		if (m_Next)
+	m_ArchetypeStorage = new ArchetypeStorage();
+
+	// Add every collection that already owns components from this manager
+	for (DynamicArray<Pool *>::Iterator iter = m_Pools.Begin();
+		iter != m_Pools.End(); ++iter)
+	{
+		Pool *pPool = *iter;
+		if ( !pPool )
 		{
-			g_ComponentPtrRegistry[m_ComponentPtrRegistryHeadIndex] = m_Next;
-			m_Next->m_ComponentPtrRegistryHeadIndex = m_ComponentPtrRegistryHeadIndex;
-			m_Next->m_Previous = NULL;
+			continue;
 		}
-		else
+
+		for ( ComponentIndex i = 0; i < pPool->GetAllocatedCount(); ++i )
 		{
-			g_ComponentPtrRegistry[m_ComponentPtrRegistryHeadIndex] = NULL;
+			Component *pComponent = pPool->GetComponentByRosterIndex( i );
+			m_ArchetypeStorage->AddCollection( *pPool->GetComponentCollection( pComponent ) );
 		}
-
-		// Unmark ourself as a head node
-		m_ComponentPtrRegistryHeadIndex = Helium::Invalid<uint16_t>();
-	} 
-	// Unlink ourself from doubly linked list of component ptrs
-	else if (m_Previous)
-	{
-		m_Previous->m_Next = m_Next;
 	}
+}
 
-	if (m_Next)
+void Helium::Components::Tick()
+{
+	// Nothing to do every frame at the moment. Component handles are validated when they are resolved, so there is no
+	// registry of pointers to sweep any more.
+}
+
+size_t Helium::ComponentManager::CountAllocatedComponentsThatImplement( Components::TypeId typeId ) const
+{
+	TypeData *pTypeData = g_ComponentTypes[ typeId ];
+
+	size_t count = 0;
+	for (DynamicArray< TypeId >::Iterator iter = pTypeData->m_ImplementingTypes.Begin();
+		iter != pTypeData->m_ImplementingTypes.End(); ++iter)
 	{
-		m_Next->m_Previous = m_Previous;
+		// Pools are null for types without instances, or if the pool could not be created
+		if ( m_Pools[ *iter ] )
+		{
+			count += m_Pools[ *iter ]->GetAllocatedCount();
+		}
 	}
 
-	m_Previous = 0;
-	m_Next = 0;
+	return count;
 }
 
 #if HELIUM_TOOLS
@@ -2,6 +2,7 @@
 
 #include <vector>
 
+#include "Platform/Locks.h"
 #include "Reflect/MetaStruct.h"
 #include "Reflect/Registry.h"
 #include "Reflect/Object.h"
@@ -55,7 +56,6 @@
 	Helium::Components::ComponentRegistrar<__Type, __Type::ComponentBase> __Type::s_ComponentRegistrar(#__Type, __Count); \
 	HELIUM_DEFINE_DERIVED_STRUCT( __Type )
 
-#define HELIUM_COMPONENT_PTR_CHECK_FREQUENCY (256)
 #define HELIUM_COMPONENT_POOL_ALIGN_SIZE (32)
 #define HELIUM_COMPONENT_POOL_ALIGN_SIZE_MASK (~(POOL_ALIGN_SIZE-1))
 
@@ -70,6 +70,10 @@ namespace Helium
 
 	namespace Components
 	{
+		struct Archetype;
+		class ArchetypeStorage;
+		class CachedQuery;
+
 		template <class T>
 		struct ComponentListT
 		{
@@ -89,9 +93,13 @@ namespace Helium
 		typedef uint16_t TypeId;
 		typedef uint16_t ComponentIndex;
 		typedef uint16_t ComponentSizeType;
-		typedef uint8_t GenerationIndex;
+		typedef uint16_t GenerationIndex;
+		typedef uint16_t PoolIndex;
 
-		const static uint32_t COMPONENT_PTR_CHECK_FREQUENCY = 256;
+		// The global table handles use to find pools (one pool per component type per world) grows in blocks of this
+		// many slots as pools are created, up to the full range of PoolIndex
+		const static PoolIndex POOL_TABLE_BLOCK_SIZE = 256;
+		const static size_t MAX_POOL_COUNT = 65536;
 		const static uintptr_t POOL_ALIGN_SIZE = 32;
 		const static uintptr_t POOL_ALIGN_SIZE_MASK = ~(POOL_ALIGN_SIZE-1);
 		
@@ -162,6 +170,13 @@ namespace Helium
 			bool             m_Delete;
 		};
 		
+		// Row of a component collection in a cached query
+		struct CachedQueryRow
+		{
+			CachedQuery*     m_Query;
+			uint32_t         m_Row;
+		};
+		
 		struct HELIUM_FRAMEWORK_API DataParallel
 		{
 			ComponentCollection*  m_Collection;
@@ -174,10 +189,14 @@ namespace Helium
 			static Pool*               CreatePool( ComponentManager *pComponentManager, const TypeData &rTypeData, ComponentIndex count );
 			static void                DestroyPool( Pool *pPool );
 			static inline Pool*        GetPool( const Component *component );
+			static Pool*               FindPool( PoolIndex poolIndex, uint16_t poolGeneration );
 									   
 			inline TypeId              GetTypeId() const;
 			inline ComponentManager*   GetComponentManager() const;
 			inline World*              GetWorld() const;
+			inline PoolIndex           GetPoolIndex() const;
+			inline uint16_t            GetPoolGeneration() const;
+			inline ComponentIndex      GetComponentCount() const;
 			inline Component*          GetComponent(ComponentIndex index) const;
 			inline ComponentIndex      GetComponentIndex(const Component *component) const;
 			inline ComponentCollection* GetComponentCollection(const Component *component) const;
@@ -219,6 +238,8 @@ namespace Helium
 			TypeId                     m_TypeId;
 			ComponentSizeType          m_ComponentSize;
 			ComponentIndex             m_FirstUnallocatedIndex;
+			PoolIndex                  m_PoolIndex;              //< Slot in the global pool table
+			uint16_t                   m_PoolGeneration;         //< Generation of the slot, so handles to destroyed pools fail
 		};
 		
 		HELIUM_FRAMEWORK_API void                Initialize( SystemDefinition *pSystemDefinition );
@@ -242,7 +263,6 @@ namespace Helium
 	public:
 		virtual                  ~ComponentManager();
 
-		void                     RegisterComponentPtr( ComponentPtrBase &pPtr );
 		inline World*            GetWorld() const;
 		inline const Components::Pool*  GetPool( Components::TypeId typeId );
 
@@ -254,12 +274,28 @@ namespace Helium
 		template < class T > size_t    CountAllocatedComponents();
 		template < class T > size_t    CountAllocatedComponentsThatImplement();
 
+		// Keep component collections grouped into archetype tables so queries can walk them linearly. Can be enabled
+		// at any time, collections that already have components are added immediately.
+		void                     EnableArchetypeStorage();
+		inline bool              IsArchetypeStorageEnabled() const;
+		inline Components::ArchetypeStorage* GetArchetypeStorage() const;
+
+		// Get the persistent query for the given types, creating it if this is the first time it is used
+		Components::CachedQuery& GetCachedQuery( const Components::TypeId *types, size_t typesCount );
+
 	private:
 		friend ComponentManager* Helium::Components::CreateManager( World *pWorld );
+		friend Components::Pool;
 		ComponentManager(World *pWorld);
 
+		// Called by pools when the first component of a type in a collection was replaced, added or removed
+		void                     OnFirstComponentChanged( ComponentCollection &rCollection, Components::TypeId typeId );
+
 		World *m_World;
 		DynamicArray<Components::Pool *> m_Pools;
+		Components::ArchetypeStorage *m_ArchetypeStorage;
+		DynamicArray<Components::CachedQuery *> m_CachedQueries;
+		SpinLock m_CachedQueriesLock;
 	};
 
 
@@ -336,7 +372,16 @@ namespace Helium
 
 	private:
 		friend Components::Pool;
+		friend Components::ArchetypeStorage;
+		friend Components::CachedQuery;
 		Map< Components::TypeId, Component * > m_Components;
+
+		// Rows of this collection in cached queries
+		DynamicArray< Components::CachedQueryRow > m_CachedQueryRows;
+
+		// Archetype table and row holding this collection, if the component manager uses archetype storage
+		Components::Archetype *m_Archetype;
+		uint32_t m_ArchetypeRow;
 	};
 
 	//! All components have some data for bookkeeping
@@ -361,10 +406,42 @@ namespace Helium
 
 	private:
 		friend Components::Pool;
-		friend ComponentPtrBase;
 		Components::DataInline m_InlineData;
 	};
 
+
+	// Weak reference to a component packed into 64 bits: pool table slot (16), pool slot generation (16), component
+	// index within the pool (16) and component generation (16). Resolving it looks the pool up in the global pool table
+	// and compares generations, so there's no shared state to update when handles are created, copied or destroyed,
+	// and handles can be freely passed between threads.
+	//
+	// The component generation is the 16 bit GenerationIndex kept in each component's inline data, so a handle can
+	// only be fooled if its component slot is freed and reallocated exactly 65536 times (or a multiple of it) while it
+	// is held.
+	class HELIUM_FRAMEWORK_API ComponentHandle
+	{
+	public:
+		inline ComponentHandle();
+		inline explicit ComponentHandle( const Component *pComponent );
+
+		// Returns NULL if the component was freed since the handle was made
+		inline Component* Get() const;
+
+		// Skips the generation check, only safe if the component is known to still be allocated
+		inline Component* UncheckedGet() const;
+
+		inline bool       IsNull() const;
+		inline void       Reset();
+		inline uint64_t   GetValue() const;
+
+		inline bool operator==( const ComponentHandle &rhs ) const;
+		inline bool operator!=( const ComponentHandle &rhs ) const;
+
+	private:
+		inline Components::Pool* GetPool() const;
+
+		uint64_t m_Value;
+	};
 	
 	// Code that need not be template aware goes here
 	class HELIUM_FRAMEWORK_API ComponentPtrBase
@@ -373,35 +450,15 @@ namespace Helium
 		inline void Check() const;
 		inline bool IsGood() const;
 		inline void Reset(Component *_component = 0);
-
-		ComponentPtrBase *GetNextComponetPtr() { return m_Next; }
-		friend ComponentManager;
-		friend void Helium::Components::Tick();
+		inline const ComponentHandle &GetHandle() const;
 
 	protected:
 		inline ComponentPtrBase();
-		inline ~ComponentPtrBase();
-
-		inline void Reset(Component *_component) const;
-		void Unlink() const;
-			
-		// Component we point to. NOTE: This will ALWAYS be a type T component because 
-		// this class never sets m_Component to anything but NULL. Our non-base template
-		// class is the only way to construct this class or assign a pointer
-		mutable Component *m_Component; 
-
-	private:
-		// Doubly linked list lets us unsplice ourself easily from list of "allocated" ComponentPtrs
-		mutable ComponentPtrBase *m_Next;
-		mutable ComponentPtrBase *m_Previous;
-			
-		// We set this generation when a component is assigned
-		mutable Components::GenerationIndex m_Generation;
 
-		// If not assigned to Helium::Invalid<uint16_t>(), this node is head of
-		// linked list and is pointed to by g_ComponentPtrRegistry. Destruction of this
-		// Ptr will automatically fix that reference.
-		mutable uint16_t m_ComponentPtrRegistryHeadIndex;
+		// Handle of the component we point to. NOTE: This will ALWAYS be a type T component because this class never
+		// sets it to anything but NULL. Our non-base template class is the only way to construct this class or assign
+		// a pointer. Cleared by Check() once the component is freed.
+		mutable ComponentHandle m_Handle;
 	};
 
 	// Code that uses T goes here
@@ -107,6 +107,21 @@ namespace Helium
 			return m_World;
 		}
 
+		PoolIndex Pool::GetPoolIndex() const
+		{
+			return m_PoolIndex;
+		}
+
+		uint16_t Pool::GetPoolGeneration() const
+		{
+			return m_PoolGeneration;
+		}
+
+		ComponentIndex Pool::GetComponentCount() const
+		{
+			return static_cast<ComponentIndex>( m_Roster.GetSize() );
+		}
+
 		Component* Pool::GetComponent( ComponentIndex index ) const
 		{
 			if ( IsValid<ComponentIndex>( index ) )
@@ -339,12 +354,21 @@ namespace Helium
 	
 	Component* ComponentManager::Allocate( Components::TypeId type, Components::IHasComponents *pOwner, ComponentCollection &rCollection )
 	{
-		return m_Pools[ type ]->Allocate( pOwner, rCollection );
+		Components::Pool *pPool = m_Pools[ type ];
+		if ( !pPool )
+		{
+			// Types without instances (or whose pool could not be created) have no pool
+			HELIUM_ASSERT_MSG( false, TXT( "Could not allocate component of type %s. The type has no component pool." ),
+				Components::GetTypeData( type )->m_Structure->m_Name );
+			return NULL;
+		}
+
+		return pPool->Allocate( pOwner, rCollection );
 	}
 
 	size_t ComponentManager::CountAllocatedComponents( Components::TypeId typeId ) const
 	{
-		return m_Pools[ typeId ]->GetAllocatedCount();
+		return m_Pools[ typeId ] ? m_Pools[ typeId ]->GetAllocatedCount() : 0;
 	}
 	
 	World * ComponentManager::GetWorld() const
@@ -373,8 +397,20 @@ namespace Helium
 	{
 		return m_Pools[ typeId ];
 	}
+
+	bool ComponentManager::IsArchetypeStorageEnabled() const
+	{
+		return m_ArchetypeStorage != NULL;
+	}
+
+	Components::ArchetypeStorage * ComponentManager::GetArchetypeStorage() const
+	{
+		return m_ArchetypeStorage;
+	}
 	
 	Helium::ComponentCollection::ComponentCollection()
+		: m_Archetype( NULL )
+		, m_ArchetypeRow( Invalid<uint32_t>() )
 	{
 
 	}
@@ -510,67 +546,118 @@ namespace Helium
 		return GetComponentManager()->Allocate<T>( GetOwner(), *GetComponentCollection() );
 	}
 
-	void ComponentPtrBase::Check() const
+	ComponentHandle::ComponentHandle()
+		: m_Value( 0 )
 	{
-		// If no component, we're done
-		if (!m_Component)
+
+	}
+
+	ComponentHandle::ComponentHandle( const Component *pComponent )
+		: m_Value( 0 )
+	{
+		if ( pComponent )
 		{
-			return;
+			Components::Pool *pPool = Components::Pool::GetPool( pComponent );
+			HELIUM_ASSERT( pPool );
+
+			m_Value = 
+				( static_cast<uint64_t>( pPool->GetPoolIndex() ) << 48 ) |
+				( static_cast<uint64_t>( pPool->GetPoolGeneration() ) << 32 ) |
+				( static_cast<uint64_t>( pPool->GetComponentIndex( pComponent ) ) << 16 ) |
+				static_cast<uint64_t>( pComponent->GetInlineData().m_Generation );
 		}
+	}
+
+	Components::Pool* ComponentHandle::GetPool() const
+	{
+		return Components::Pool::FindPool( 
+			static_cast<Components::PoolIndex>( m_Value >> 48 ), 
+			static_cast<uint16_t>( m_Value >> 32 ) );
+	}
 
-		// If generation doesn't match
-		if (m_Component->m_InlineData.m_Generation != m_Generation)
+	Component* ComponentHandle::Get() const
+	{
+		Components::Pool *pPool = GetPool();
+		if ( !pPool )
 		{
-			// Drop the component
-			Reset(NULL);
+			return NULL;
 		}
+
+		Components::ComponentIndex index = static_cast<Components::ComponentIndex>( m_Value >> 16 );
+		if ( index >= pPool->GetComponentCount() )
+		{
+			return NULL;
+		}
+
+		Component *pComponent = pPool->GetComponent( index );
+		if ( pComponent->GetInlineData().m_Generation != static_cast<Components::GenerationIndex>( m_Value ) ||
+			!pPool->GetComponentCollection( pComponent ) )
+		{
+			return NULL;
+		}
+
+		return pComponent;
 	}
 
-	bool ComponentPtrBase::IsGood() const
+	Component* ComponentHandle::UncheckedGet() const
 	{
-		Check();
-		return (m_Component != NULL);
+		Components::Pool *pPool = GetPool();
+		return pPool ? pPool->GetComponent( static_cast<Components::ComponentIndex>( m_Value >> 16 ) ) : NULL;
 	}
 
-	void ComponentPtrBase::Reset( Component *_component )
+	bool ComponentHandle::IsNull() const
 	{
-		const ComponentPtrBase *ptr = this;
-		ptr->Reset(_component);
+		return m_Value == 0;
 	}
 
-	void ComponentPtrBase::Reset( Component *_component ) const
+	void ComponentHandle::Reset()
 	{
-		if (m_Component == _component)
-		{
-			// Is also desired case for assigning null to null ptr
-			return;
-		}
+		m_Value = 0;
+	}
 
-		Unlink();
-		HELIUM_ASSERT(m_ComponentPtrRegistryHeadIndex == Helium::Invalid<uint16_t>());
-		m_Component = _component;
+	uint64_t ComponentHandle::GetValue() const
+	{
+		return m_Value;
+	}
 
-		if (m_Component)
+	bool ComponentHandle::operator==( const ComponentHandle &rhs ) const
+	{
+		return m_Value == rhs.m_Value;
+	}
+
+	bool ComponentHandle::operator!=( const ComponentHandle &rhs ) const
+	{
+		return m_Value != rhs.m_Value;
+	}
+
+	void ComponentPtrBase::Check() const
+	{
+		// Drop the component if it was freed
+		if ( !m_Handle.IsNull() && !m_Handle.Get() )
 		{
-			m_Generation = m_Component->m_InlineData.m_Generation;
-			m_Component->GetComponentManager()->RegisterComponentPtr( *const_cast<ComponentPtrBase *>(this) );
-			HELIUM_ASSERT( m_ComponentPtrRegistryHeadIndex != Helium::Invalid<uint16_t>() );
-			HELIUM_ASSERT( !m_Next || m_Next->m_ComponentPtrRegistryHeadIndex == Helium::Invalid<uint16_t>() );
+			m_Handle.Reset();
 		}
 	}
 
-	ComponentPtrBase::ComponentPtrBase() 
-		: m_Next(0)
-		, m_Previous(0)
-		, m_Component(0)
-		, m_ComponentPtrRegistryHeadIndex(Helium::Invalid<uint16_t>())
+	bool ComponentPtrBase::IsGood() const
 	{
+		Check();
+		return !m_Handle.IsNull();
+	}
 
+	void ComponentPtrBase::Reset( Component *_component )
+	{
+		m_Handle = ComponentHandle( _component );
 	}
 
-	ComponentPtrBase::~ComponentPtrBase()
+	const ComponentHandle &ComponentPtrBase::GetHandle() const
 	{
-		Unlink();
+		return m_Handle;
+	}
+
+	ComponentPtrBase::ComponentPtrBase() 
+	{
+
 	}
 		
 	template <class T>
@@ -588,7 +675,7 @@ namespace Helium
 	template <class T>
 	ComponentPtr<T>::ComponentPtr( const ComponentPtr& _rhs )
 	{
-		Reset(_rhs.m_Component);
+		m_Handle = _rhs.m_Handle;
 	}
 
 	template <class T>
@@ -600,21 +687,31 @@ namespace Helium
 	template <class T>
 	T * ComponentPtr<T>::UncheckedGet() const
 	{
-		return static_cast<T*>(m_Component);
+		return static_cast<T*>(m_Handle.UncheckedGet());
 	}
 
 	template <class T>
 	T * ComponentPtr<T>::Get()
 	{
-		Check();
-		return UncheckedGet();
+		Component *pComponent = m_Handle.Get();
+		if ( !pComponent )
+		{
+			m_Handle.Reset();
+		}
+
+		return static_cast<T*>(pComponent);
 	}
 
 	template <class T>
 	const T * ComponentPtr<T>::Get() const
 	{
-		Check();
-		return UncheckedGet();
+		Component *pComponent = m_Handle.Get();
+		if ( !pComponent )
+		{
+			m_Handle.Reset();
+		}
+
+		return static_cast<T*>(pComponent);
 	}
 
 	template <class T>
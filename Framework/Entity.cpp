@@ -61,6 +61,44 @@ void Entity::ClearSliceInfo()
 	SetInvalid( m_sliceIndex );
 }
 
+/// Set a tag on this entity. Tags are stored by the entity's slice, so entities that are not in a slice can't be
+/// tagged.
+///
+/// @param[in] tag  Tag to set.
+///
+/// @return  True if the tag was set, false if the entity is not in a slice or the tag is not registered.
+///
+/// @see ClearTag(), HasTag()
+bool Entity::SetTag( EntityTagId tag )
+{
+	return m_spSlice && m_spSlice->SetEntityTag( m_sliceIndex, tag );
+}
+
+/// Clear a tag on this entity.
+///
+/// @param[in] tag  Tag to clear.
+///
+/// @see SetTag(), HasTag()
+void Entity::ClearTag( EntityTagId tag )
+{
+	if ( m_spSlice )
+	{
+		m_spSlice->ClearEntityTag( m_sliceIndex, tag );
+	}
+}
+
+/// Get whether a tag is set on this entity.
+///
+/// @param[in] tag  Tag to test.
+///
+/// @return  True if the tag is set, false if not (or if the entity is not in a slice).
+///
+/// @see SetTag(), ClearTag()
+bool Entity::HasTag( EntityTagId tag ) const
+{
+	return m_spSlice && m_spSlice->HasEntityTag( m_sliceIndex, tag );
+}
+
 ComponentCollection& Helium::Entity::VirtualGetComponents()
 {
 	return GetComponents();
@@ -25,8 +25,7 @@ namespace Helium
 		static void PopulateMetaType( Reflect::MetaStruct& comp );
 		
 		Entity()
-			: m_DeferredDestroy(false)
-			, m_sliceIndex(Invalid<size_t>()) { }
+			: m_sliceIndex(Invalid<size_t>()) { }
 		~Entity();
 		
 		// TODO: Wish I could inline this but cyclical #includes..
@@ -56,8 +55,16 @@ namespace Helium
 		void ClearSliceInfo();
 		//@}
 
-		void DeferredDestroy() { m_DeferredDestroy = true; }
-		bool IsDeferredDestroySet() { return m_DeferredDestroy; }
+		/// @name Tags
+		//@{
+		bool SetTag( EntityTagId tag );
+		void ClearTag( EntityTagId tag );
+		bool HasTag( EntityTagId tag ) const;
+		//@}
+
+		// Entities that aren't in a slice are never destroyed by the world manager, so this returns false for them
+		bool DeferredDestroy() { return SetTag( EntityTags::DeferredDestroy ); }
+		bool IsDeferredDestroySet() const { return HasTag( EntityTags::DeferredDestroy ); }
 		
 	private:
 		// Avoid using these vfuncs if you can! Use GetComponents() and GetWorld
@@ -72,8 +79,6 @@ namespace Helium
 		/// Path to creating definition. Not storing definition because we don't want to
 		/// keep it allocated if we don't need to.
 		AssetPath m_DefinitionPath;
-
-		bool m_DeferredDestroy;
 		
 	};
 	typedef Helium::StrongPtr<Entity> EntityPtr;
@@ -0,0 +1,155 @@
+#include "FrameworkPch.h"
+#include "Framework/EntityTags.h"
+
+#if HELIUM_CC_CL
+#include <intrin.h>
+#endif
+
+using namespace Helium;
+
+namespace
+{
+	// Constant initialized, so tags can be registered from other modules' static initializers
+	const char* s_TagNames[ EntityTags::MAX_TAGS ] = { "DeferredDestroy" };
+	size_t s_TagCount = 1;
+
+	inline size_t CountTrailingZeros( uint32_t word )
+	{
+		HELIUM_ASSERT( word );
+#if HELIUM_CC_CL
+		unsigned long index;
+		_BitScanForward( &index, static_cast< unsigned long >( word ) );
+		return index;
+#else
+		return static_cast< size_t >( __builtin_ctz( word ) );
+#endif
+	}
+
+	inline size_t FindHighestBit( uint32_t word )
+	{
+		HELIUM_ASSERT( word );
+#if HELIUM_CC_CL
+		unsigned long index;
+		_BitScanReverse( &index, static_cast< unsigned long >( word ) );
+		return index;
+#else
+		return 31 - static_cast< size_t >( __builtin_clz( word ) );
+#endif
+	}
+}
+
+EntityTagId EntityTags::Register( const char *name )
+{
+	HELIUM_ASSERT( name );
+	HELIUM_ASSERT( s_TagCount < MAX_TAGS );
+
+	s_TagNames[ s_TagCount ] = name;
+	return static_cast< EntityTagId >( s_TagCount++ );
+}
+
+size_t EntityTags::GetCount()
+{
+	return s_TagCount;
+}
+
+const char* EntityTags::GetName( EntityTagId tag )
+{
+	HELIUM_ASSERT( tag < s_TagCount );
+	return s_TagNames[ tag ];
+}
+
+EntityTagBitSet::EntityTagBitSet()
+	: m_SetCount( 0 )
+{
+
+}
+
+void EntityTagBitSet::ClearAll()
+{
+	m_Words.Clear();
+	m_SetCount = 0;
+}
+
+void EntityTagBitSet::Grow( size_t bitCount )
+{
+	size_t word_count = ( bitCount + BITS_PER_WORD - 1 ) / BITS_PER_WORD;
+	size_t old_size = m_Words.GetSize();
+	if ( word_count > old_size )
+	{
+		m_Words.Resize( word_count );
+		for ( size_t i = old_size; i < word_count; ++i )
+		{
+			m_Words[ i ] = 0;
+		}
+	}
+}
+
+size_t EntityTagBitSet::FindFirst() const
+{
+	return m_Words.IsEmpty() ? Invalid< size_t >() : FindFirstFromWord( 0, m_Words[ 0 ] );
+}
+
+size_t EntityTagBitSet::FindNext( size_t index ) const
+{
+	size_t next = index + 1;
+	size_t word_index = next / BITS_PER_WORD;
+	if ( word_index >= m_Words.GetSize() )
+	{
+		return Invalid< size_t >();
+	}
+
+	// Mask off the bits up to and including index in its word
+	uint32_t word = m_Words[ word_index ] & ( ~static_cast< uint32_t >( 0 ) << ( next % BITS_PER_WORD ) );
+	return FindFirstFromWord( word_index, word );
+}
+
+size_t EntityTagBitSet::FindLast() const
+{
+	return m_Words.IsEmpty() ? Invalid< size_t >() : FindLastFromWord( m_Words.GetSize() - 1, m_Words.GetLast() );
+}
+
+size_t EntityTagBitSet::FindPrevious( size_t index ) const
+{
+	if ( index == 0 || m_Words.IsEmpty() )
+	{
+		return Invalid< size_t >();
+	}
+
+	size_t previous = Min( index - 1, m_Words.GetSize() * BITS_PER_WORD - 1 );
+	size_t word_index = previous / BITS_PER_WORD;
+
+	// Mask off the bits from index upwards in its word
+	uint32_t word = m_Words[ word_index ] & ( ~static_cast< uint32_t >( 0 ) >> ( BITS_PER_WORD - 1 - previous % BITS_PER_WORD ) );
+	return FindLastFromWord( word_index, word );
+}
+
+size_t EntityTagBitSet::FindFirstFromWord( size_t wordIndex, uint32_t word ) const
+{
+	const size_t word_count = m_Words.GetSize();
+	while ( !word )
+	{
+		if ( m_SetCount == 0 || ++wordIndex >= word_count )
+		{
+			return Invalid< size_t >();
+		}
+
+		word = m_Words[ wordIndex ];
+	}
+
+	return wordIndex * BITS_PER_WORD + CountTrailingZeros( word );
+}
+
+size_t EntityTagBitSet::FindLastFromWord( size_t wordIndex, uint32_t word ) const
+{
+	while ( !word )
+	{
+		if ( m_SetCount == 0 || wordIndex-- == 0 )
+		{
+			return Invalid< size_t >();
+		}
+
+		word = m_Words[ wordIndex ];
+	}
+
+	return wordIndex * BITS_PER_WORD + FindHighestBit( word );
+}
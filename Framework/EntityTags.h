@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Platform/Atomic.h"
+#include "Foundation/DynamicArray.h"
+#include "Framework/Framework.h"
+
+namespace Helium
+{
+	// Tags are data-less markers on entities (like "destroy me at the end of the frame" or "dead"). Instead of being
+	// allocated like components, each slice keeps one bitset per tag parallel to its entity list, so finding tagged
+	// entities costs a scan of 32 entities per word instead of a visit to every entity.
+	typedef uint16_t EntityTagId;
+
+	namespace EntityTags
+	{
+		const static EntityTagId MAX_TAGS = 64;
+
+		// Built in tags
+		const static EntityTagId DeferredDestroy = 0;
+
+		// Register a new tag. Meant to be called while initializing statics, like component registration.
+		HELIUM_FRAMEWORK_API EntityTagId Register( const char *name );
+
+		HELIUM_FRAMEWORK_API size_t      GetCount();
+		HELIUM_FRAMEWORK_API const char* GetName( EntityTagId tag );
+	}
+
+	// Dense bitset with one bit per entity in a slice. Searches test a whole word at a time and skip empty words.
+	// Words are plain 32 bit integers rather than 64 bit or SSE lanes, as Set() and Clear() need the platform's 32 bit
+	// atomic operations; searches already stop early once m_SetCount shows no bits are left.
+	// Set() and Clear() update their word atomically so tasks running in parallel can tag entities in the same slice,
+	// but they never grow the bitset, so it must be sized with Grow() (single threaded) before any bits are set.
+	class HELIUM_FRAMEWORK_API EntityTagBitSet
+	{
+	public:
+		static const size_t BITS_PER_WORD = 32;
+
+		EntityTagBitSet();
+
+		inline bool         Test( size_t index ) const;
+		inline void         Set( size_t index );
+		inline void         Clear( size_t index );
+		void                ClearAll();
+
+		// Make room for at least bitCount bits, new bits are cleared
+		void                Grow( size_t bitCount );
+
+		// Moves the bit at lastIndex into index and clears lastIndex, mirroring DynamicArray::RemoveSwap()
+		inline void         RemoveSwap( size_t index, size_t lastIndex );
+
+		inline size_t       GetSetCount() const;
+		inline bool         IsEmpty() const;
+
+		// Searches return an invalid index once there are no more set bits
+		size_t              FindFirst() const;
+		size_t              FindNext( size_t index ) const;
+		size_t              FindLast() const;
+		size_t              FindPrevious( size_t index ) const;
+
+	private:
+		size_t              FindFirstFromWord( size_t wordIndex, uint32_t word ) const;
+		size_t              FindLastFromWord( size_t wordIndex, uint32_t word ) const;
+
+		// 32 bit words so they can be updated with the platform's atomic operations
+		DynamicArray< uint32_t > m_Words;
+		volatile int32_t         m_SetCount;
+	};
+}
+
+#include "Framework/EntityTags.inl"
@@ -0,0 +1,65 @@
+namespace Helium
+{
+	bool EntityTagBitSet::Test( size_t index ) const
+	{
+		size_t word_index = index / BITS_PER_WORD;
+		return word_index < m_Words.GetSize() && ( m_Words[ word_index ] & ( static_cast< uint32_t >( 1 ) << ( index % BITS_PER_WORD ) ) );
+	}
+
+	void EntityTagBitSet::Set( size_t index )
+	{
+		size_t word_index = index / BITS_PER_WORD;
+		HELIUM_ASSERT( word_index < m_Words.GetSize() );
+
+		int32_t mask = static_cast< int32_t >( static_cast< uint32_t >( 1 ) << ( index % BITS_PER_WORD ) );
+		if ( !( AtomicOr( reinterpret_cast< volatile int32_t& >( m_Words[ word_index ] ), mask ) & mask ) )
+		{
+			AtomicIncrement( m_SetCount );
+		}
+	}
+
+	void EntityTagBitSet::Clear( size_t index )
+	{
+		size_t word_index = index / BITS_PER_WORD;
+		if ( word_index >= m_Words.GetSize() )
+		{
+			return;
+		}
+
+		int32_t mask = static_cast< int32_t >( static_cast< uint32_t >( 1 ) << ( index % BITS_PER_WORD ) );
+		if ( AtomicAnd( reinterpret_cast< volatile int32_t& >( m_Words[ word_index ] ), ~mask ) & mask )
+		{
+			AtomicDecrement( m_SetCount );
+		}
+	}
+
+	void EntityTagBitSet::RemoveSwap( size_t index, size_t lastIndex )
+	{
+		HELIUM_ASSERT( index <= lastIndex );
+
+		// Removing the last entity just drops its bit, there is nothing to move
+		if ( index == lastIndex )
+		{
+			Clear( index );
+		}
+		else if ( Test( lastIndex ) )
+		{
+			Clear( lastIndex );
+			Set( index );
+		}
+		else
+		{
+			Clear( index );
+		}
+	}
+
+	size_t EntityTagBitSet::GetSetCount() const
+	{
+		return static_cast< size_t >( m_SetCount );
+	}
+
+	bool EntityTagBitSet::IsEmpty() const
+	{
+		return m_SetCount == 0;
+	}
+}
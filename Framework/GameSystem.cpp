@@ -2,6 +2,7 @@
 #include "Framework/GameSystem.h"
 
 #include "Engine/AsyncLoader.h"
+#include "EngineJobs/JobManager.h"
 #include "Engine/FileLocations.h"
 #include "Foundation/FilePath.h"
 #include "Foundation/DirectoryIterator.h"
@@ -26,7 +27,9 @@ using namespace Helium;
 /// Constructor.
 GameSystem::GameSystem()
 : m_pAssetLoaderInitialization( NULL )
+, m_pRendererInitialization( NULL )
 , m_bStopRunning( false )
+, m_bHeadless( false )
 {
 }
 
@@ -46,7 +49,8 @@ GameSystem::~GameSystem()
 /// @param[in] rConfigInitialization         Interface for initializing application configuration settings.
 /// @param[in] rWindowManagerInitialization  Interface for creating and initializing the global window manager
 ///                                          instance.
-/// @param[in] rRendererInitialization       Interface for creating and initializing the global renderer instance.
+/// @param[in] rRendererInitialization       Interface for creating and initializing the global renderer instance
+///                                          (not used if the -headless command-line switch is given).
 /// @param[in] pWorldType                    Type of World to create for the main world.  If this is null, the
 ///                                          actual World type will be used.
 bool GameSystem::Initialize(
@@ -78,6 +82,8 @@ bool GameSystem::Initialize(
 	}
 #endif
 
+	m_bHeadless = HasArgument( TXT( "-headless" ) );
+
 #if HELIUM_SHARED
 	// Initialize sibling dynamically loaded modules.
 	FilePath path ( *m_moduleName );
@@ -105,6 +111,16 @@ bool GameSystem::Initialize(
 		return false;
 	}
 
+	// Start up the job worker threads.
+	bool bJobManagerInitSuccess = JobManager::GetStaticInstance().Initialize();
+	HELIUM_ASSERT( bJobManagerInitSuccess );
+	if( !bJobManagerInitSuccess )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "GameSystem::Initialize(): Job manager initialization failed.\n" ) );
+
+		return false;
+	}
+
 	//pmd - Initialize the cache manager
 	FilePath baseDirectory;
 	if ( !FileLocations::GetBaseDirectory( baseDirectory ) )
@@ -158,7 +174,15 @@ bool GameSystem::Initialize(
 
 	Components::Initialize( m_spSystemDefinition.Get() );
 
-	TaskScheduler::CalculateSchedule( TickTypes::RenderingGame, m_Schedule );
+	// Headless systems only run gameplay tasks, which don't touch the renderer or input devices.
+	TaskScheduler::CalculateSchedule( m_bHeadless ? TickTypes::HeadlessGame : TickTypes::RenderingGame, m_Schedule );
+
+	// Let tasks that declare their component access overlap on the job manager's worker threads.
+	m_Schedule.m_Parallel = HasArgument( TXT( "-parallel_tasks" ) );
+	if( m_Schedule.m_Parallel )
+	{
+		HELIUM_TRACE( TraceLevels::Info, TXT( "GameSystem::Initialize(): Running tasks in parallel.\n" ) );
+	}
 
 	// Create and initialize the window manager (note that we need a window manager for message loop processing, so
 	// the instance cannot be left null).
@@ -172,7 +196,9 @@ bool GameSystem::Initialize(
 	}
 	
 	// Create and initialize the renderer.
-	bool bRendererInitSuccess = rRendererInitialization.Initialize();
+	RendererInitialization& rActiveRendererInitialization =
+		( m_bHeadless ? m_NullRendererInitialization : rRendererInitialization );
+	bool bRendererInitSuccess = rActiveRendererInitialization.Initialize();
 	HELIUM_ASSERT( bRendererInitSuccess );
 	if( !bRendererInitSuccess )
 	{
@@ -181,7 +207,7 @@ bool GameSystem::Initialize(
 		return false;
 	}
 
-	m_pRendererInitialization = &rRendererInitialization;
+	m_pRendererInitialization = &rActiveRendererInitialization;
 	
 	// Initialize the world manager and main game world.
 	WorldManager& rWorldManager = WorldManager::GetStaticInstance();
@@ -194,6 +220,13 @@ bool GameSystem::Initialize(
 		return false;
 	}
 
+	// Nothing in a headless schedule is shared between worlds, so each world can be updated as its own job.
+	rWorldManager.SetUpdateWorldsSeparately( m_bHeadless );
+	if( m_bHeadless )
+	{
+		HELIUM_TRACE( TraceLevels::Info, TXT( "GameSystem::Initialize(): Running headless.\n" ) );
+	}
+
 	// Initialization complete.
 	return true;
 }
@@ -231,6 +264,7 @@ void GameSystem::Shutdown()
 	AssetType::Shutdown();
 	Asset::Shutdown();
 
+	JobManager::DestroyStaticInstance();
 	AsyncLoader::DestroyStaticInstance();
 
 	Reflect::ObjectRefCountSupport::Shutdown();
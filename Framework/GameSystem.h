@@ -2,6 +2,7 @@
 
 #include "Framework/System.h"
 #include "Framework/SystemDefinition.h"
+#include "Framework/NullRendererInitialization.h"
 #include "Framework/TaskScheduler.h"
 
 #define NO_GFX (1)
@@ -57,6 +58,8 @@ namespace Helium
 
 		virtual void StopRunning();
 
+		inline bool IsHeadless() const;
+
 	protected:
 		/// AssetLoader initialization interface.
 		AssetLoaderInitialization*   m_pAssetLoaderInitialization;
@@ -65,5 +68,11 @@ namespace Helium
 		AssetAwareThreadSynchronizer m_AssetSyncUtility;
 		TaskSchedule                 m_Schedule;
 		bool                         m_bStopRunning;
+		/// True if running without a renderer, input or client tasks (-headless command-line switch).
+		bool                         m_bHeadless;
+		/// Renderer initialization used instead of the one given to Initialize() when running headless.
+		NullRendererInitialization   m_NullRendererInitialization;
 	};
 }
+
+#include "Framework/GameSystem.inl"
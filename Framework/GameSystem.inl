@@ -0,0 +1,12 @@
+namespace Helium
+{
+	/// Get whether this system is running headless (as a dedicated server, for example).
+	///
+	/// Headless systems don't create a renderer and only run gameplay tasks, with each world updated as a separate job.
+	///
+	/// @return  True if running headless, false if not.
+	bool GameSystem::IsHeadless() const
+	{
+		return m_bHeadless;
+	}
+}
@@ -68,6 +68,18 @@ Entity* Slice::CreateEntity(EntityDefinition *pEntityDefinition, ParameterSet *p
     HELIUM_ASSERT( IsValid( sliceIndex ) );
     entity->SetSliceInfo( this, sliceIndex );
 
+    // Make room for the entity in every tag's bits now, since tags may be set from tasks running in parallel and the
+    // bitsets can't be grown safely then.
+    if( m_entityTags.GetSize() < EntityTags::GetCount() )
+    {
+        m_entityTags.Resize( EntityTags::GetCount() );
+    }
+
+    for( DynamicArray< EntityTagBitSet >::Iterator tagIter = m_entityTags.Begin(); tagIter != m_entityTags.End(); ++tagIter )
+    {
+        tagIter->Grow( m_entities.GetSize() );
+    }
+
     pEntityDefinition->FinalizeEntity(entity, pParameterSet);
 
     return entity.Get();
@@ -105,6 +117,11 @@ bool Slice::DestroyEntity( Entity* pEntity )
 
     // Update the index of the entity which has been moved to fill the entity list entry we just removed.
     size_t entityCount = m_entities.GetSize();
+    for( DynamicArray< EntityTagBitSet >::Iterator tagIter = m_entityTags.Begin(); tagIter != m_entityTags.End(); ++tagIter )
+    {
+        tagIter->RemoveSwap( index, entityCount );
+    }
+
     if( index < entityCount )
     {
         Entity* pMovedEntity = m_entities[ index ];
@@ -117,6 +134,47 @@ bool Slice::DestroyEntity( Entity* pEntity )
 }
 
 
+/// Set a tag on an entity in this slice.  This is safe to call from tasks running in parallel, as long as the entity
+/// list itself is not being modified.
+///
+/// @param[in] index  Entity index.
+/// @param[in] tag    Tag to set.
+///
+/// @return  True if the tag was set, false if the entity index or tag is out of range.
+///
+/// @see ClearEntityTag(), HasEntityTag(), GetEntityTags()
+bool Slice::SetEntityTag( size_t index, EntityTagId tag )
+{
+    if( index >= m_entities.GetSize() || tag >= m_entityTags.GetSize() )
+    {
+        HELIUM_TRACE(
+            TraceLevels::Error,
+            TXT( "Slice::SetEntityTag(): Entity index %" ) PRIuSZ TXT( " or tag %" ) PRIu16 TXT( " is out of range.\n" ),
+            index,
+            tag );
+
+        return false;
+    }
+
+    m_entityTags[ tag ].Set( index );
+
+    return true;
+}
+
+/// Clear a tag on an entity in this slice.  Like SetEntityTag(), this is safe to call from tasks running in parallel.
+///
+/// @param[in] index  Entity index.
+/// @param[in] tag    Tag to clear.
+///
+/// @see SetEntityTag(), HasEntityTag(), GetEntityTags()
+void Slice::ClearEntityTag( size_t index, EntityTagId tag )
+{
+    if( index < m_entities.GetSize() && tag < m_entityTags.GetSize() )
+    {
+        m_entityTags[ tag ].Clear( index );
+    }
+}
+
 /// Set the world to which this slice is currently bound, along with the index of this slice within the world.
 ///
 /// @param[in] pWorld      World to set.
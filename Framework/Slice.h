@@ -3,6 +3,7 @@
 #include "Framework/Framework.h"
 
 #include "Framework/ParameterSet.h"
+#include "Framework/EntityTags.h"
 #include "Reflect/Object.h"
 
 namespace Helium
@@ -48,6 +49,14 @@ namespace Helium
         Entity* GetEntity( size_t index ) const;
         //@}
 
+        /// @name Entity Tags
+        //@{
+        bool SetEntityTag( size_t index, EntityTagId tag );
+        void ClearEntityTag( size_t index, EntityTagId tag );
+        inline bool HasEntityTag( size_t index, EntityTagId tag ) const;
+        inline const EntityTagBitSet* GetEntityTags( EntityTagId tag ) const;
+        //@}
+
         /// @name World Registration
         //@{
         World *GetWorld();
@@ -65,6 +74,8 @@ namespace Helium
 
         /// Entities.
         DynamicArray< EntityPtr > m_entities;
+        /// Tag bits for each entity, indexed by tag and then by entity index.
+        DynamicArray< EntityTagBitSet > m_entityTags;
 
         /// Slice world.
         WorldWPtr m_spWorld;
@@ -21,4 +21,31 @@ namespace Helium
         return m_entities.GetSize();
     }
 
+    /// Get whether an entity in this slice has a tag set.
+    ///
+    /// @param[in] index  Entity index.
+    /// @param[in] tag    Tag to test.
+    ///
+    /// @return  True if the tag is set, false if not.
+    ///
+    /// @see SetEntityTag(), ClearEntityTag(), GetEntityTags()
+    bool Slice::HasEntityTag( size_t index, EntityTagId tag ) const
+    {
+        HELIUM_ASSERT( index < m_entities.GetSize() );
+
+        return tag < m_entityTags.GetSize() && m_entityTags[ tag ].Test( index );
+    }
+
+    /// Get the bits for a tag, one per entity in this slice.
+    ///
+    /// @param[in] tag  Tag to get.
+    ///
+    /// @return  Tag bits, or null if no entity has been created in this slice yet.
+    ///
+    /// @see SetEntityTag(), ClearEntityTag(), HasEntityTag()
+    const EntityTagBitSet* Slice::GetEntityTags( EntityTagId tag ) const
+    {
+        return tag < m_entityTags.GetSize() ? &m_entityTags[ tag ] : NULL;
+    }
+
 }
@@ -25,6 +25,27 @@ void System::Shutdown()
     m_arguments.Clear();
 }
 
+/// Check whether a given command-line argument was specified.
+///
+/// @param[in] pArgument  Argument to find (case-insensitive).
+///
+/// @return  True if the argument was specified, false if not.
+bool System::HasArgument( const char* pArgument ) const
+{
+    HELIUM_ASSERT( pArgument );
+
+    size_t argumentCount = m_arguments.GetSize();
+    for( size_t argumentIndex = 0; argumentIndex < argumentCount; ++argumentIndex )
+    {
+        if( CaseInsensitiveCompareString( *m_arguments[ argumentIndex ], pArgument ) == 0 )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 /// Get the singleton System instance.
 ///
 /// A system instance must be initialized first through the interface of one of the System subclasses.
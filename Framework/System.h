@@ -24,6 +24,11 @@ namespace Helium
 
 		virtual void StopRunning() = 0;
 
+		/// @name Command-line Arguments
+		//@{
+		bool HasArgument( const char* pArgument ) const;
+		//@}
+
 	protected:
 		/// Module file name.
 		String m_moduleName;
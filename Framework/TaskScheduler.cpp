@@ -2,6 +2,9 @@
 #include "FrameworkPch.h"
 #include "TaskScheduler.h"
 #include "Foundation/Map.h"
+#include "Platform/Atomic.h"
+#include "Framework/Components.h"
+#include "EngineJobs/JobManager.h"
 
 using namespace Helium;
 
@@ -10,6 +13,7 @@ TaskDefinition *TaskDefinition::s_FirstTaskDefinition = NULL;
 bool TaskScheduler::m_ContractsDefined = false;
 
 bool InsertToTaskList(A_TaskDefinitionPtr &rTaskInfoList, DynamicArray<TaskFunc> &rTaskFuncList, A_TaskDefinitionPtr &rTaskStack, const TaskDefinition *pTask, uint32_t tickType);
+void CalculateExecutionGraph(TaskSchedule &schedule);
 
 bool TaskScheduler::CalculateSchedule(uint32_t tickType, TaskSchedule &schedule)
 {	
@@ -106,11 +110,25 @@ bool TaskScheduler::CalculateSchedule(uint32_t tickType, TaskSchedule &schedule)
 		{
 			schedule.m_ScheduleInfo.Clear();
 			schedule.m_ScheduleFunc.Clear();
+			schedule.m_Successors.Clear();
+			schedule.m_PredecessorCounts.Clear();
+			schedule.m_Exclusive.Clear();
+			schedule.m_HasSharedStateTasks = false;
 			return false;
 		}
 
 		task = task->m_Next;
 	}
+
+	schedule.m_HasSharedStateTasks = false;
+	for (A_TaskDefinitionPtr::ConstIterator iter = schedule.m_ScheduleInfo.Begin(); iter != schedule.m_ScheduleInfo.End(); ++iter)
+	{
+		if ( (*iter)->m_Func && ( (*iter)->m_Contract.m_TickType & ( TickTypes::Render | TickTypes::Client ) ) )
+		{
+			schedule.m_HasSharedStateTasks = true;
+			break;
+		}
+	}
 	
 	HELIUM_TRACE(TraceLevels::Info, TXT( "Successfully generated a schedule for all tasks.\n" ));
 
@@ -171,6 +189,9 @@ bool TaskScheduler::CalculateSchedule(uint32_t tickType, TaskSchedule &schedule)
 #endif
 #endif
 	
+	// Needs the abstract tasks to follow order requirements through them, so do this before compacting
+	CalculateExecutionGraph(schedule);
+
 	size_t i_copy_to = 0;
 	size_t i_copy_from = 0;
 	const size_t taskCount = schedule.m_ScheduleFunc.GetSize();
@@ -280,7 +301,173 @@ bool InsertToTaskList(A_TaskDefinitionPtr &rTaskInfoList, DynamicArray<TaskFunc>
 	return true;
 }
 
-void TaskScheduler::ExecuteSchedule( const TaskSchedule &schedule, DynamicArray< WorldPtr > &rWorlds )
+// Returns true if any component type in a shares a pool with any component type in b. Declaring a type covers all
+// of the types derived from it, so compare the implementing types of both sides.
+bool ComponentAccessOverlaps(const DynamicArray<const Components::TypeData *> &a, const DynamicArray<const Components::TypeData *> &b)
+{
+	for (DynamicArray<const Components::TypeData *>::ConstIterator a_iter = a.Begin(); a_iter != a.End(); ++a_iter)
+	{
+		for (DynamicArray<Components::TypeId>::ConstIterator a_type_iter = (*a_iter)->m_ImplementingTypes.Begin();
+			a_type_iter != (*a_iter)->m_ImplementingTypes.End(); ++a_type_iter)
+		{
+			for (DynamicArray<const Components::TypeData *>::ConstIterator b_iter = b.Begin(); b_iter != b.End(); ++b_iter)
+			{
+				for (DynamicArray<Components::TypeId>::ConstIterator b_type_iter = (*b_iter)->m_ImplementingTypes.Begin();
+					b_type_iter != (*b_iter)->m_ImplementingTypes.End(); ++b_type_iter)
+				{
+					if (*a_type_iter == *b_type_iter)
+					{
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+// Two tasks may run at the same time only if both declared their component access and neither writes anything the
+// other touches
+bool TasksConflict(const TaskContract &a, const TaskContract &b)
+{
+	if (!a.DeclaresComponentAccess() || !b.DeclaresComponentAccess())
+	{
+		return true;
+	}
+
+	return ComponentAccessOverlaps(a.m_WrittenComponentTypes, b.m_WrittenComponentTypes) ||
+		ComponentAccessOverlaps(a.m_WrittenComponentTypes, b.m_ReadComponentTypes) ||
+		ComponentAccessOverlaps(a.m_ReadComponentTypes, b.m_WrittenComponentTypes);
+}
+
+void AddUniqueIndex(DynamicArray<size_t> &rIndices, size_t index)
+{
+	for (DynamicArray<size_t>::ConstIterator iter = rIndices.Begin(); iter != rIndices.End(); ++iter)
+	{
+		if (*iter == index)
+		{
+			return;
+		}
+	}
+
+	rIndices.Add(index);
+}
+
+void CalculateExecutionGraph(TaskSchedule &schedule)
+{
+	const size_t fullCount = schedule.m_ScheduleInfo.GetSize();
+
+	// Map each task in the full schedule to its index once abstract tasks are compacted out
+	typedef Helium::Map<const TaskDefinition *, size_t> M_TaskIndexMap;
+	M_TaskIndexMap fullIndices;
+	DynamicArray<size_t> compactIndices;
+	compactIndices.Reserve(fullCount);
+
+	size_t concreteCount = 0;
+	for (size_t i = 0; i < fullCount; ++i)
+	{
+		fullIndices.Insert(M_TaskIndexMap::ValueType(schedule.m_ScheduleInfo[i], i));
+		compactIndices.Add(schedule.m_ScheduleFunc[i] ? concreteCount++ : Invalid<size_t>());
+	}
+
+	// For each task, the nearest concrete tasks it must follow. Abstract tasks pass along their own predecessors so
+	// that order requirements through them are kept. The schedule is in dependency order, so required tasks have
+	// already been visited.
+	DynamicArray< DynamicArray<size_t> > predecessors;
+	predecessors.Resize(fullCount);
+
+	for (size_t i = 0; i < fullCount; ++i)
+	{
+		const TaskDefinition *pTask = schedule.m_ScheduleInfo[i];
+		for (A_TaskDefinitionPtr::ConstIterator required_iter = pTask->m_RequiredTasks.Begin();
+			required_iter != pTask->m_RequiredTasks.End(); ++required_iter)
+		{
+			// Required tasks that don't run under this tick type were never scheduled
+			M_TaskIndexMap::ConstIterator index_iter = fullIndices.Find(*required_iter);
+			if (index_iter == fullIndices.End())
+			{
+				continue;
+			}
+
+			const size_t requiredIndex = index_iter->Second();
+			HELIUM_ASSERT(requiredIndex < i);
+
+			if (IsValid(compactIndices[requiredIndex]))
+			{
+				AddUniqueIndex(predecessors[i], compactIndices[requiredIndex]);
+			}
+			else
+			{
+				for (DynamicArray<size_t>::ConstIterator iter = predecessors[requiredIndex].Begin();
+					iter != predecessors[requiredIndex].End(); ++iter)
+				{
+					AddUniqueIndex(predecessors[i], *iter);
+				}
+			}
+		}
+	}
+
+	// Gather the concrete tasks
+	A_TaskDefinitionPtr concreteTasks;
+	DynamicArray< DynamicArray<size_t> > concretePredecessors;
+	concreteTasks.Reserve(concreteCount);
+	concretePredecessors.Reserve(concreteCount);
+
+	for (size_t i = 0; i < fullCount; ++i)
+	{
+		if (IsValid(compactIndices[i]))
+		{
+			concreteTasks.Add(schedule.m_ScheduleInfo[i]);
+			concretePredecessors.New(predecessors[i]);
+		}
+	}
+
+	// Tasks that conflict over component access keep their relative order from the serial schedule
+	for (size_t j = 0; j < concreteCount; ++j)
+	{
+		for (size_t i = 0; i < j; ++i)
+		{
+			if (TasksConflict(concreteTasks[i]->m_Contract, concreteTasks[j]->m_Contract))
+			{
+				AddUniqueIndex(concretePredecessors[j], i);
+			}
+		}
+	}
+
+	schedule.m_Successors.Clear();
+	schedule.m_Successors.Resize(concreteCount);
+	schedule.m_PredecessorCounts.Clear();
+	schedule.m_PredecessorCounts.Reserve(concreteCount);
+	schedule.m_Exclusive.Clear();
+	schedule.m_Exclusive.Reserve(concreteCount);
+
+	for (size_t j = 0; j < concreteCount; ++j)
+	{
+		for (DynamicArray<size_t>::ConstIterator iter = concretePredecessors[j].Begin();
+			iter != concretePredecessors[j].End(); ++iter)
+		{
+			schedule.m_Successors[*iter].Add(j);
+		}
+
+		schedule.m_PredecessorCounts.Add(static_cast<uint32_t>(concretePredecessors[j].GetSize()));
+		schedule.m_Exclusive.Add(!concreteTasks[j]->m_Contract.DeclaresComponentAccess());
+	}
+}
+
+void TaskScheduler::ExecuteSchedule( const TaskSchedule &schedule, DynamicArray< WorldPtr > &rWorlds, TaskScheduleState &rState )
+{
+	if ( schedule.m_Parallel && JobManager::GetStaticInstance().IsInitialized() )
+	{
+		ExecuteScheduleParallel( schedule, rWorlds, rState );
+	}
+	else
+	{
+		ExecuteScheduleSerial( schedule, rWorlds );
+	}
+}
+
+void TaskScheduler::ExecuteScheduleSerial( const TaskSchedule &schedule, DynamicArray< WorldPtr > &rWorlds )
 {
 	int i = 0;
 	for (DynamicArray<TaskFunc>::ConstIterator iter = schedule.m_ScheduleFunc.Begin(); iter != schedule.m_ScheduleFunc.End(); ++iter)
@@ -290,6 +477,117 @@ void TaskScheduler::ExecuteSchedule( const TaskSchedule &schedule, DynamicArray<
 	}
 }
 
+namespace
+{
+	void ReleaseTask( TaskScheduleState &rState, size_t taskIndex )
+	{
+		if ( rState.m_pSchedule->m_Exclusive[ taskIndex ] )
+		{
+			// Exclusive tasks conflict with every other task, so nothing else in the schedule is running or can start
+			// until this one finishes. That leaves at most one ready at a time, and the thread executing the schedule
+			// only picks it up once the job counter shows that every job has finished.
+			HELIUM_ASSERT( IsInvalid( rState.m_ReadyExclusiveTask ) );
+			rState.m_ReadyExclusiveTask = taskIndex;
+		}
+		else
+		{
+			JobManager::GetStaticInstance().Spawn( rState.m_Jobs[ taskIndex ], rState.m_pCounter );
+		}
+	}
+
+	void CompleteTask( TaskScheduleState &rState, size_t taskIndex )
+	{
+		const DynamicArray< size_t > &rSuccessors = rState.m_pSchedule->m_Successors[ taskIndex ];
+		for ( DynamicArray< size_t >::ConstIterator iter = rSuccessors.Begin(); iter != rSuccessors.End(); ++iter )
+		{
+			if ( AtomicDecrementRelease( rState.m_RemainingPredecessors[ *iter ] ) == 0 )
+			{
+				ReleaseTask( rState, *iter );
+			}
+		}
+	}
+}
+
+void TaskScheduleState::TaskJob::RunCallback( void *pJob )
+{
+	TaskJob *pTaskJob = static_cast< TaskJob * >( pJob );
+	HELIUM_ASSERT( pTaskJob );
+
+	TaskScheduleState *pState = pTaskJob->m_pState;
+	pState->m_pSchedule->m_ScheduleFunc[ pTaskJob->m_TaskIndex ]( *pState->m_pWorlds );
+
+	// Successors are spawned before this job is counted as finished, so the counter can't reach zero while there is
+	// still work left to release
+	CompleteTask( *pState, pTaskJob->m_TaskIndex );
+}
+
+// Tasks that declared their component access run as jobs as soon as everything they depend on has finished. Tasks
+// that did not run on this thread, which helps out with pending jobs while waiting on them.
+void TaskScheduler::ExecuteScheduleParallel( const TaskSchedule &schedule, DynamicArray< WorldPtr > &rWorlds, TaskScheduleState &rState )
+{
+	const size_t taskCount = schedule.m_ScheduleFunc.GetSize();
+	HELIUM_ASSERT( schedule.m_Successors.GetSize() == taskCount );
+	HELIUM_ASSERT( schedule.m_PredecessorCounts.GetSize() == taskCount );
+	HELIUM_ASSERT( schedule.m_Exclusive.GetSize() == taskCount );
+
+	if ( taskCount == 0 )
+	{
+		return;
+	}
+
+	JobCounter counter;
+
+	rState.m_pSchedule = &schedule;
+	rState.m_pWorlds = &rWorlds;
+	rState.m_pCounter = &counter;
+	rState.m_ReadyExclusiveTask = Invalid< size_t >();
+
+	// Storage is only reallocated when the schedule grows. Job state pointers are reset every time in case the state
+	// itself has moved since the last execution.
+	rState.m_Jobs.Resize( taskCount );
+	rState.m_RemainingPredecessors.Resize( taskCount );
+	for ( size_t i = 0; i < taskCount; ++i )
+	{
+		rState.m_Jobs[ i ].m_pState = &rState;
+		rState.m_Jobs[ i ].m_TaskIndex = i;
+		rState.m_RemainingPredecessors[ i ] = static_cast< int32_t >( schedule.m_PredecessorCounts[ i ] );
+	}
+
+	for ( size_t i = 0; i < taskCount; ++i )
+	{
+		if ( schedule.m_PredecessorCounts[ i ] == 0 )
+		{
+			ReleaseTask( rState, i );
+		}
+	}
+
+	// Once every job has finished, either an exclusive task has been released or the whole schedule is done
+	JobManager &rJobManager = JobManager::GetStaticInstance();
+	for ( ; ; )
+	{
+		rJobManager.WaitForCounter( counter );
+
+		size_t exclusiveTask = rState.m_ReadyExclusiveTask;
+		if ( IsInvalid( exclusiveTask ) )
+		{
+			break;
+		}
+
+		rState.m_ReadyExclusiveTask = Invalid< size_t >();
+		schedule.m_ScheduleFunc[ exclusiveTask ]( rWorlds );
+		CompleteTask( rState, exclusiveTask );
+	}
+
+#if HELIUM_ASSERT_ENABLED
+	for ( size_t i = 0; i < taskCount; ++i )
+	{
+		HELIUM_ASSERT( rState.m_RemainingPredecessors[ i ] == 0 );
+	}
+#endif
+
+	rState.m_pCounter = NULL;
+}
+
 void Helium::TaskScheduler::ResetContracts()
 {
 	TaskDefinition *task = TaskDefinition::s_FirstTaskDefinition;
@@ -298,6 +596,8 @@ void Helium::TaskScheduler::ResetContracts()
 		task->m_RequiredTasks.Clear();
 		task->m_Contract.m_ContributedDependencies.Clear();
 		task->m_Contract.m_OrderRequirements.Clear();
+		task->m_Contract.m_ReadComponentTypes.Clear();
+		task->m_Contract.m_WrittenComponentTypes.Clear();
 		task = task->m_Next;
 	}
 
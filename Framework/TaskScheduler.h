@@ -38,6 +38,11 @@ namespace Helium
 {	
 	struct TaskDefinition;
 
+	namespace Components
+	{
+		struct TypeData;
+	}
+
 	namespace OrderRequirementTypes
 	{
 		enum OrderRequirementType
@@ -126,17 +131,55 @@ namespace Helium
 			m_TickType = tickType;
 		}
 
+		// This task reads components of type T (or any type derived from T)
+		template <class T>
+		void ReadsComponents()
+		{
+			ReadsComponents(T::GetStaticComponentTypeData());
+		}
+
+		// This task modifies components of type T (or any type derived from T)
+		template <class T>
+		void WritesComponents()
+		{
+			WritesComponents(T::GetStaticComponentTypeData());
+		}
+
+		void ReadsComponents(const Components::TypeData &rTypeData)
+		{
+			m_ReadComponentTypes.Push(&rTypeData);
+		}
+
+		void WritesComponents(const Components::TypeData &rTypeData)
+		{
+			m_WrittenComponentTypes.Push(&rTypeData);
+		}
+
+		// Tasks that declare their component access may run concurrently with other tasks that touch unrelated
+		// components. Such tasks must not allocate or free components (use FreeComponentDeferred instead) or touch
+		// state shared with other tasks outside of their declared components. Tasks that declare nothing always run
+		// alone on the thread executing the schedule.
+		bool DeclaresComponentAccess() const
+		{
+			return !m_ReadComponentTypes.IsEmpty() || !m_WrittenComponentTypes.IsEmpty();
+		}
+
 		// Every requirement to be before or after another dependency goes here
 		DynamicArray<OrderRequirement> m_OrderRequirements;
 
 		// All dependencies we contribute to fulfilling
 		DynamicArray<const TaskDefinition *> m_ContributedDependencies;
 
+		// Component types this task reads and writes
+		DynamicArray<const Components::TypeData *> m_ReadComponentTypes;
+		DynamicArray<const Components::TypeData *> m_WrittenComponentTypes;
+
 		TickType m_TickType;
 	};
 
 	class World;
 	typedef Helium::StrongPtr< World > WorldPtr;
+	class JobCounter;
 	typedef void (*TaskFunc)( DynamicArray< WorldPtr > & );
 
 	struct HELIUM_FRAMEWORK_API TaskDefinition
@@ -185,15 +228,75 @@ namespace Helium
 
 	struct TaskSchedule
 	{
+		TaskSchedule()
+			: m_Parallel( false )
+			, m_HasSharedStateTasks( false )
+		{
+
+		}
+
 		A_TaskDefinitionPtr m_ScheduleInfo;
 		DynamicArray<TaskFunc> m_ScheduleFunc; // Compact version of our schedule
+
+		// Dependency graph over m_ScheduleFunc used for parallel execution. For each task, the tasks that can't start
+		// until it finishes, and the number of tasks it must wait on. Order requirements and conflicting component
+		// access both add edges.
+		DynamicArray< DynamicArray< size_t > > m_Successors;
+		DynamicArray< uint32_t > m_PredecessorCounts;
+
+		// Tasks that did not declare their component access, which run on the thread executing the schedule
+		DynamicArray< bool > m_Exclusive;
+
+		// If false (or if the JobManager isn't running), the schedule is executed serially in m_ScheduleFunc order. Off
+		// by default, as many stock tasks don't declare their component access and only run exclusively, so parallel
+		// execution only pays off in schedules with enough declared tasks to overlap (GameSystem enables it with the
+		// -parallel_tasks command-line switch).
+		bool m_Parallel;
+
+		// True if any task runs for render or client ticks. Those tasks drive the renderer, windows and input devices,
+		// which are shared by all worlds, so the schedule can't be run for several worlds at once.
+		bool m_HasSharedStateTasks;
+	};
+
+	// Working storage for executing a schedule in parallel, kept by whoever executes the schedule so it can be reused
+	// from frame to frame. The same schedule may be executed for several worlds at once, each with its own state.
+	struct TaskScheduleState
+	{
+		struct TaskJob
+		{
+			TaskScheduleState *m_pState;
+			size_t m_TaskIndex;
+
+			static void RunCallback( void *pJob );
+		};
+
+		TaskScheduleState()
+			: m_pSchedule( NULL )
+			, m_pWorlds( NULL )
+			, m_pCounter( NULL )
+			, m_ReadyExclusiveTask( Invalid< size_t >() )
+		{
+
+		}
+
+		const TaskSchedule *m_pSchedule;
+		DynamicArray< WorldPtr > *m_pWorlds;
+		JobCounter *m_pCounter;
+
+		DynamicArray< TaskJob > m_Jobs;
+		DynamicArray< int32_t > m_RemainingPredecessors;
+
+		// Exclusive task whose predecessors have all finished, waiting for the thread executing the schedule
+		size_t m_ReadyExclusiveTask;
 	};
 
 	class HELIUM_FRAMEWORK_API TaskScheduler
 	{
 	public:
 		static bool CalculateSchedule( uint32_t tickType, TaskSchedule &schedule );
-		static void ExecuteSchedule( const TaskSchedule &schedule, DynamicArray< WorldPtr > &rWorlds );
+		static void ExecuteSchedule( const TaskSchedule &schedule, DynamicArray< WorldPtr > &rWorlds, TaskScheduleState &rState );
+		static void ExecuteScheduleSerial( const TaskSchedule &schedule, DynamicArray< WorldPtr > &rWorlds );
+		static void ExecuteScheduleParallel( const TaskSchedule &schedule, DynamicArray< WorldPtr > &rWorlds, TaskScheduleState &rState );
 
 		static void ResetContracts();
 
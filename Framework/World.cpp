@@ -1,6 +1,7 @@
 #include "FrameworkPch.h"
 #include "Framework/World.h"
 
+#include "Platform/Timer.h"
 #include "Rendering/Renderer.h"
 #include "Rendering/RSurface.h"
 #include "Framework/EntityDefinition.h"
@@ -21,6 +22,7 @@ HELIUM_DEFINE_CLASS( Helium::World );
 
 /// Constructor.
 World::World()
+: m_UpdateBudgetSeconds( 0.0f )
 {
 }
 
@@ -314,3 +316,55 @@ Slice* World::GetSlice( size_t index ) const
 
 	return m_Slices[ index ];
 }
+
+/// Record the time taken by an update of this world.
+///
+/// @param[in] updateTicks  Timer ticks spent updating this world.
+///
+/// @see GetUpdateStats(), SetUpdateBudgetSeconds()
+void World::RecordUpdate( uint64_t updateTicks )
+{
+	m_UpdateStats.m_LastUpdateTicks = updateTicks;
+	m_UpdateStats.m_MaxUpdateTicks = Max( m_UpdateStats.m_MaxUpdateTicks, updateTicks );
+	m_UpdateStats.m_TotalUpdateTicks += updateTicks;
+	++m_UpdateStats.m_UpdateCount;
+
+	if( m_UpdateBudgetSeconds > 0.0f )
+	{
+		float64_t updateSeconds = static_cast< float64_t >( updateTicks ) * Timer::GetSecondsPerTick();
+		if( updateSeconds > static_cast< float64_t >( m_UpdateBudgetSeconds ) )
+		{
+			++m_UpdateStats.m_OverBudgetCount;
+
+			HELIUM_TRACE(
+				TraceLevels::Debug,
+				TXT( "World::RecordUpdate(): World update took %.3f ms, exceeding its %.3f ms budget.\n" ),
+				updateSeconds * 1000.0,
+				static_cast< float64_t >( m_UpdateBudgetSeconds ) * 1000.0 );
+		}
+	}
+}
+
+void Helium::QueryTaggedComponentsInternal( World *pWorld, EntityTagId tag, Components::TypeId type, TaggedComponentCallback callback )
+{
+	HELIUM_ASSERT( pWorld );
+
+	for( size_t sliceIndex = 0; sliceIndex < pWorld->GetSliceCount(); ++sliceIndex )
+	{
+		Slice *pSlice = pWorld->GetSlice( sliceIndex );
+		const EntityTagBitSet *pTags = pSlice->GetEntityTags( tag );
+		if( !pTags )
+		{
+			continue;
+		}
+
+		for( size_t entityIndex = pTags->FindFirst(); IsValid( entityIndex ); entityIndex = pTags->FindNext( entityIndex ) )
+		{
+			Component *pComponent = pSlice->GetEntity( entityIndex )->GetComponents().GetFirst( type );
+			if( pComponent )
+			{
+				callback( pComponent );
+			}
+		}
+	}
+}
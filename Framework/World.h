@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Framework/ComponentQuery.h"
+#include "Framework/ComponentCommandBuffer.h"
+#include "Framework/EntityTags.h"
 #include "Framework/Framework.h"
 
 namespace Helium
@@ -11,6 +13,24 @@ namespace Helium
 	class Slice;
 	typedef Helium::StrongPtr< Slice > SlicePtr;
 
+	/// Timing statistics gathered while updating a world on its own.
+	struct HELIUM_FRAMEWORK_API WorldUpdateStats
+	{
+		/// Ticks spent updating the world during the most recent update.
+		uint64_t m_LastUpdateTicks;
+		/// Most ticks spent updating the world during a single update.
+		uint64_t m_MaxUpdateTicks;
+		/// Total ticks spent updating the world.
+		uint64_t m_TotalUpdateTicks;
+		/// Number of updates recorded.
+		uint32_t m_UpdateCount;
+		/// Number of updates that exceeded the world's update budget.
+		uint32_t m_OverBudgetCount;
+
+		inline WorldUpdateStats();
+		inline void Reset();
+	};
+
 	/// World instance.
 	///
 	/// A world contains a discrete group of entities that can be simulated within an application environment.  Multiple
@@ -64,6 +84,15 @@ namespace Helium
 		Slice* GetSlice( size_t index ) const;
 		//@}
 
+		/// @name Update Budget and Statistics
+		//@{
+		inline void SetUpdateBudgetSeconds( float32_t budgetSeconds );
+		inline float32_t GetUpdateBudgetSeconds() const;
+		inline const WorldUpdateStats& GetUpdateStats() const;
+		inline void ResetUpdateStats();
+		void RecordUpdate( uint64_t updateTicks );
+		//@}
+
 	public:
 		// TEMPORARY!
 		ComponentManagerPtr m_ComponentManager;
@@ -77,6 +106,11 @@ namespace Helium
 		/// Active slices.
 		DynamicArray< SlicePtr > m_Slices;
 		SlicePtr m_RootSlice;
+
+		/// Time (in seconds) an update of this world is expected to fit in, or zero for no budget.
+		float32_t m_UpdateBudgetSeconds;
+		/// Update timing statistics.
+		WorldUpdateStats m_UpdateStats;
 	};
 
 	typedef Helium::StrongPtr< World > WorldPtr;
@@ -119,6 +153,133 @@ namespace Helium
 		HELIUM_ASSERT( pComponentManager );
 		QueryComponentsInternal( *pComponentManager, types, HELIUM_ARRAY_COUNT(types), TupleHandler<A, B, C, F> );
 	}
+
+	// Same as the queries above, but passing each match to F along with a user context, so tasks don't need globals to
+	// hand per-world state (such as the world's graphics scene) to their callbacks
+	template <class A, class Context, void (*F)(A *, Context &)>
+	inline void QueryComponents( World *pWorld, Context &rContext )
+	{ 
+		ComponentManager *pComponentManager = pWorld->GetComponentManager();
+		HELIUM_ASSERT( pComponentManager );
+		for (ImplementingComponentIterator<A> iter( *pComponentManager ); iter.GetBaseComponent(); iter.Advance())
+		{
+			F( *iter, rContext );
+		}
+	}
+
+	template <class A, class B, class Context, void (*F)(A *, B *, Context &)>
+	inline void QueryComponents( World *pWorld, Context &rContext )
+	{
+		static Components::TypeId types[] = {
+			Components::GetType<A>(),
+			Components::GetType<B>()
+		};
+
+		ComponentManager *pComponentManager = pWorld->GetComponentManager();
+		HELIUM_ASSERT( pComponentManager );
+		QueryComponentsInternal( *pComponentManager, types, HELIUM_ARRAY_COUNT(types), TupleContextHandler<A, B, Context, F>, &rContext );
+	}
+
+	template <class A, class B, class C, class Context, void (*F)(A *, B *, C *, Context &)>
+	inline void QueryComponents( World *pWorld, Context &rContext )
+	{
+		static Components::TypeId types[] = {
+			Components::GetType<A>(),
+			Components::GetType<B>(),
+			Components::GetType<C>()
+		};
+
+		ComponentManager *pComponentManager = pWorld->GetComponentManager();
+		HELIUM_ASSERT( pComponentManager );
+		QueryComponentsInternal( *pComponentManager, types, HELIUM_ARRAY_COUNT(types), TupleContextHandler<A, B, C, Context, F>, &rContext );
+	}
+
+	// Parallel queries pass each match to F along with a user context shared by all chunks and a command buffer for
+	// the chunk. F may run on several threads at once, so it must only modify the components it is given (or data in
+	// the context it synchronizes itself), and must record frees and allocations in the command buffer.
+	template <class A, class Context, void (*F)(A *, Context &, ComponentCommandBuffer &)>
+	inline void ParallelQueryComponents( World *pWorld, Context &rContext, size_t chunkSize = Components::PARALLEL_QUERY_CHUNK_SIZE )
+	{
+		static Components::TypeId types[] = {
+			Components::GetType<A>()
+		};
+
+		ComponentManager *pComponentManager = pWorld->GetComponentManager();
+		HELIUM_ASSERT( pComponentManager );
+		ParallelQueryComponentsInternal( *pComponentManager, types, HELIUM_ARRAY_COUNT(types), TupleChunkHandler<A, Context, F>, &rContext, chunkSize );
+	}
+
+	template <class A, class B, class Context, void (*F)(A *, B *, Context &, ComponentCommandBuffer &)>
+	inline void ParallelQueryComponents( World *pWorld, Context &rContext, size_t chunkSize = Components::PARALLEL_QUERY_CHUNK_SIZE )
+	{
+		static Components::TypeId types[] = {
+			Components::GetType<A>(),
+			Components::GetType<B>()
+		};
+
+		ComponentManager *pComponentManager = pWorld->GetComponentManager();
+		HELIUM_ASSERT( pComponentManager );
+		ParallelQueryComponentsInternal( *pComponentManager, types, HELIUM_ARRAY_COUNT(types), TupleChunkHandler<A, B, Context, F>, &rContext, chunkSize );
+	}
+
+	template <class A, class B, class C, class Context, void (*F)(A *, B *, C *, Context &, ComponentCommandBuffer &)>
+	inline void ParallelQueryComponents( World *pWorld, Context &rContext, size_t chunkSize = Components::PARALLEL_QUERY_CHUNK_SIZE )
+	{
+		static Components::TypeId types[] = {
+			Components::GetType<A>(),
+			Components::GetType<B>(),
+			Components::GetType<C>()
+		};
+
+		ComponentManager *pComponentManager = pWorld->GetComponentManager();
+		HELIUM_ASSERT( pComponentManager );
+		ParallelQueryComponentsInternal( *pComponentManager, types, HELIUM_ARRAY_COUNT(types), TupleChunkHandler<A, B, C, Context, F>, &rContext, chunkSize );
+	}
+
+	// Parallel query for callbacks that only need the command buffer
+	template <class A, void (*F)(A *, ComponentCommandBuffer &)>
+	inline void ParallelQueryComponents( World *pWorld, size_t chunkSize = Components::PARALLEL_QUERY_CHUNK_SIZE )
+	{
+		static Components::TypeId types[] = {
+			Components::GetType<A>()
+		};
+
+		ComponentManager *pComponentManager = pWorld->GetComponentManager();
+		HELIUM_ASSERT( pComponentManager );
+		ParallelQueryComponentsInternal( *pComponentManager, types, HELIUM_ARRAY_COUNT(types), TupleChunkCommandHandler<A, F>, NULL, chunkSize );
+	}
+
+	// Parallel query for callbacks that make no structural changes
+	template <class A, class B, class Context, void (*F)(A *, B *, Context &)>
+	inline void ParallelQueryComponents( World *pWorld, Context &rContext, size_t chunkSize = Components::PARALLEL_QUERY_CHUNK_SIZE )
+	{
+		static Components::TypeId types[] = {
+			Components::GetType<A>(),
+			Components::GetType<B>()
+		};
+
+		ComponentManager *pComponentManager = pWorld->GetComponentManager();
+		HELIUM_ASSERT( pComponentManager );
+		ParallelQueryComponentsInternal( *pComponentManager, types, HELIUM_ARRAY_COUNT(types), TupleChunkContextHandler<A, B, Context, F>, &rContext, chunkSize );
+	}
+
+	typedef void (*TaggedComponentCallback)( Component *pComponent );
+
+	// Visits the first component of the given type on every entity with the tag set, only looking at set tag bits
+	void HELIUM_FRAMEWORK_API QueryTaggedComponentsInternal( World *pWorld, EntityTagId tag, Components::TypeId type, TaggedComponentCallback callback );
+
+	template <class A, void (*F)(A *)>
+	void TaggedComponentHandler( Component *pComponent )
+	{
+		F( static_cast<A *>( pComponent ) );
+	}
+
+	// Tagged entities without an A are skipped. F must not destroy entities, but may set and clear tags.
+	template <class A, void (*F)(A *)>
+	inline void QueryTaggedComponents( World *pWorld, EntityTagId tag )
+	{
+		QueryTaggedComponentsInternal( pWorld, tag, Components::GetType<A>(), TaggedComponentHandler<A, F> );
+	}
 }
 
 #include "Framework/World.inl"
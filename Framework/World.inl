@@ -1,5 +1,21 @@
 namespace Helium
 {
+	/// Constructor.
+	WorldUpdateStats::WorldUpdateStats()
+	{
+		Reset();
+	}
+
+	/// Clear all statistics.
+	void WorldUpdateStats::Reset()
+	{
+		m_LastUpdateTicks = 0;
+		m_MaxUpdateTicks = 0;
+		m_TotalUpdateTicks = 0;
+		m_UpdateCount = 0;
+		m_OverBudgetCount = 0;
+	}
+
 	ComponentCollection & Helium::World::GetComponents()
 	{
 		return m_Components;
@@ -19,4 +35,47 @@ namespace Helium
     {
         return m_Slices.GetSize();
     }
+
+    /// Set the time an update of this world is expected to take.
+    ///
+    /// Updates exceeding the budget are counted in the world's update statistics.
+    ///
+    /// @param[in] budgetSeconds  Update budget in seconds, or zero to disable budget tracking.
+    ///
+    /// @see GetUpdateBudgetSeconds(), GetUpdateStats()
+    void World::SetUpdateBudgetSeconds( float32_t budgetSeconds )
+    {
+        HELIUM_ASSERT( budgetSeconds >= 0.0f );
+        m_UpdateBudgetSeconds = budgetSeconds;
+    }
+
+    /// Get the time an update of this world is expected to take.
+    ///
+    /// @return  Update budget in seconds, or zero if no budget is set.
+    ///
+    /// @see SetUpdateBudgetSeconds()
+    float32_t World::GetUpdateBudgetSeconds() const
+    {
+        return m_UpdateBudgetSeconds;
+    }
+
+    /// Get the timing statistics for updates of this world.
+    ///
+    /// Statistics are only gathered while the WorldManager updates each world separately.
+    ///
+    /// @return  Update statistics.
+    ///
+    /// @see ResetUpdateStats(), RecordUpdate()
+    const WorldUpdateStats& World::GetUpdateStats() const
+    {
+        return m_UpdateStats;
+    }
+
+    /// Clear the timing statistics for updates of this world.
+    ///
+    /// @see GetUpdateStats()
+    void World::ResetUpdateStats()
+    {
+        m_UpdateStats.Reset();
+    }
 }
@@ -12,10 +12,12 @@ void Helium::WorldDefinition::PopulateMetaType( Reflect::MetaStruct& comp )
 {
 	comp.AddField( &WorldDefinition::m_ComponentSet, "m_ComponentSet" );
 	comp.AddField( &WorldDefinition::m_Components, "m_Components" );
+	comp.AddField( &WorldDefinition::m_UseArchetypeStorage, "m_UseArchetypeStorage" );
 }
 
 /// Constructor.
 WorldDefinition::WorldDefinition()
+: m_UseArchetypeStorage( false )
 {
 }
 
@@ -37,6 +39,11 @@ Helium::WorldPtr WorldDefinition::CreateWorld() const
 	{
 		return NULL;
 	}
+
+	if ( m_UseArchetypeStorage )
+	{
+		spWorld->GetComponentManager()->EnableArchetypeStorage();
+	}
 	
 	Components::DeployComponents(*spWorld, m_Components);
 	Components::DeployComponents(*spWorld, m_ComponentSet);
@@ -39,6 +39,9 @@ namespace Helium
 
 		ComponentSet m_ComponentSet;
 		DynamicArray<ComponentDefinitionPtr> m_Components;
+
+		// Keep the world's components grouped into archetype tables for faster queries
+		bool m_UseArchetypeStorage;
 	};
 	typedef Helium::StrongPtr<WorldDefinition> WorldDefinitionPtr;
 }
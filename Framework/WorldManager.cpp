@@ -3,6 +3,7 @@
 #include "Framework/WorldDefinition.h"
 
 #include "Platform/Timer.h"
+#include "EngineJobs/JobManager.h"
 #include "Framework/Slice.h"
 #include "Framework/Entity.h"
 #include "Framework/SceneDefinition.h"
@@ -19,6 +20,7 @@ WorldManager::WorldManager()
 , m_frameDeltaTickCount( 0 )
 , m_frameDeltaSeconds( 0.0f )
 , m_bProcessedFirstFrame( false )
+, m_bUpdateWorldsSeparately( false )
 {
 }
 
@@ -83,6 +85,7 @@ void WorldManager::Shutdown()
 	}
 
 	m_worlds.Clear();
+	m_worldUpdateJobs.Clear();
 }
 
 /// Get the path to the package containing all world instances.
@@ -180,32 +183,121 @@ void WorldManager::Update( TaskSchedule &schedule )
 	// Update the world time.
 	UpdateTime();
 	
-	Helium::TaskScheduler::ExecuteSchedule( schedule, m_worlds );
+	// Render and client tasks share the renderer and input devices between worlds, so schedules with any of those are
+	// always run over all worlds at once
+	if ( m_bUpdateWorldsSeparately && !schedule.m_HasSharedStateTasks )
+	{
+		UpdateWorldsSeparately( schedule );
+	}
+	else
+	{
+		Helium::TaskScheduler::ExecuteSchedule( schedule, m_worlds, m_scheduleState );
+	}
 	
 	Components::Tick();
 
-	// TODO: I plan to do a "flag system" - components that are super lightweight.. like bitflags.. that carry no data
-	// but mark an object. This data would be kept parallel with slices/worlds so that they would be far faster to query
-	// than this abomination
+	DestroyDeferredEntities();
+}
+
+/// Run the task schedule for each world as a separate job, returning once all worlds have been updated.
+///
+/// @param[in] schedule  Task schedule to run for each world.
+void WorldManager::UpdateWorldsSeparately( const TaskSchedule &schedule )
+{
+	size_t worldCount = m_worlds.GetSize();
+	m_worldUpdateJobs.Resize( worldCount );
+
+	// Spawn the worlds that took longest last frame first so that they don't end up holding up the end of the frame.
+	// Jobs spawned from this thread are picked up in the order they are spawned.
+	DynamicArray< size_t > worldOrder;
+	worldOrder.Reserve( worldCount );
+	for( size_t worldIndex = 0; worldIndex < worldCount; ++worldIndex )
+	{
+		uint64_t lastUpdateTicks = m_worlds[ worldIndex ]->GetUpdateStats().m_LastUpdateTicks;
+
+		size_t insertIndex = worldOrder.GetSize();
+		worldOrder.Push( worldIndex );
+		while( insertIndex > 0 &&
+			m_worlds[ worldOrder[ insertIndex - 1 ] ]->GetUpdateStats().m_LastUpdateTicks < lastUpdateTicks )
+		{
+			worldOrder[ insertIndex ] = worldOrder[ insertIndex - 1 ];
+			--insertIndex;
+		}
+
+		worldOrder[ insertIndex ] = worldIndex;
+	}
+
+	JobManager& rJobManager = JobManager::GetStaticInstance();
+	JobCounter counter;
+
+	for( size_t orderIndex = 0; orderIndex < worldCount; ++orderIndex )
+	{
+		size_t worldIndex = worldOrder[ orderIndex ];
+
+		WorldUpdateJob& rJob = m_worldUpdateJobs[ worldIndex ];
+		rJob.pSchedule = &schedule;
+		rJob.worlds.Resize( 0 );
+		rJob.worlds.Push( m_worlds[ worldIndex ] );
+
+		rJobManager.Spawn( rJob, &counter );
+	}
+
+	rJobManager.WaitForCounter( counter );
+
+	// Don't hold on to worlds that may be released before the next update.
+	for( size_t worldIndex = 0; worldIndex < worldCount; ++worldIndex )
+	{
+		m_worldUpdateJobs[ worldIndex ].worlds.Resize( 0 );
+	}
+}
+
+/// Destroy all entities flagged for deferred destruction during the current frame.
+void WorldManager::DestroyDeferredEntities()
+{
 	for ( DynamicArray< WorldPtr >::Iterator worldIter = m_worlds.Begin(); worldIter != m_worlds.End(); ++worldIter )
 	{
 		for ( size_t sliceIndex = 0; sliceIndex < (*worldIter)->GetSliceCount(); ++sliceIndex )
 		{
 			Slice *pSlice = (*worldIter)->GetSlice( sliceIndex );
-			for ( size_t entityIndex = 0; entityIndex < pSlice->GetEntityCount(); ++entityIndex )
+			const EntityTagBitSet *pTags = pSlice->GetEntityTags( EntityTags::DeferredDestroy );
+			if ( !pTags || pTags->IsEmpty() )
+			{
+				continue;
+			}
+
+			// Walk backwards so the entity swapped into a destroyed entity's slot has already been visited (and is not
+			// tagged, or it would have been destroyed too)
+			for ( size_t entityIndex = pTags->FindLast(); IsValid( entityIndex ); entityIndex = pTags->FindPrevious( entityIndex ) )
 			{
 				Entity *pEntity = pSlice->GetEntity( entityIndex );
 
-				if ( pEntity->IsDeferredDestroySet() )
-				{
-					// TODO: I don't like that strong pointers might be holding these references alive.. need to find a way to fix this
-					pSlice->DestroyEntity( pEntity );
-				}
+				// TODO: I don't like that strong pointers might be holding these references alive.. need to find a way to fix this
+				pSlice->DestroyEntity( pEntity );
 			}
 		}
 	}
 }
 
+/// Run the task schedule for the world assigned to this job and record how long it took.
+void WorldManager::WorldUpdateJob::Run()
+{
+	HELIUM_ASSERT( pSchedule );
+	HELIUM_ASSERT( worlds.GetSize() == 1 );
+
+	uint64_t startTickCount = Timer::GetTickCount();
+	TaskScheduler::ExecuteSchedule( *pSchedule, worlds, scheduleState );
+	worlds[ 0 ]->RecordUpdate( Timer::GetTickCount() - startTickCount );
+}
+
+/// Job callback for updating a single world.
+///
+/// @param[in] pJob  WorldUpdateJob instance to run.
+void WorldManager::WorldUpdateJob::RunCallback( void* pJob )
+{
+	HELIUM_ASSERT( pJob );
+	static_cast< WorldUpdateJob* >( pJob )->Run();
+}
+
 /// Get the singleton WorldManager instance, creating it if necessary.
 ///
 /// @return  Reference to the WorldManager instance.
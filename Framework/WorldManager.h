@@ -36,6 +36,9 @@ namespace Helium
         /// @name Updating
         //@{
         void Update( TaskSchedule &schedule );
+
+        inline void SetUpdateWorldsSeparately( bool bSeparately );
+        inline bool GetUpdateWorldsSeparately() const;
         //@}
 
         /// @name Timing
@@ -52,6 +55,20 @@ namespace Helium
         //@}
 
     private:
+        /// Job running the task schedule for a single world.
+        struct WorldUpdateJob
+        {
+            /// Schedule to execute.
+            const TaskSchedule* pSchedule;
+            /// World list containing only the world to update.
+            DynamicArray< WorldPtr > worlds;
+            /// Storage for executing the schedule, reused across updates.
+            TaskScheduleState scheduleState;
+
+            void Run();
+            static void RunCallback( void* pJob );
+        };
+
         /// World package.
         PackagePtr m_spRootSceneDefinitionsPackage;
         /// World instances.
@@ -68,6 +85,13 @@ namespace Helium
 
         /// True if the first frame has been processed.
         bool m_bProcessedFirstFrame;
+        /// True to run the schedule for each world as a separate job, false to run it once over all worlds.
+        bool m_bUpdateWorldsSeparately;
+
+        /// Storage for executing the schedule over all worlds at once, reused across updates.
+        TaskScheduleState m_scheduleState;
+        /// Per-world update jobs (only used while updating worlds separately).
+        DynamicArray< WorldUpdateJob > m_worldUpdateJobs;
 
         /// Singleton instance.
         static WorldManager* sm_pInstance;
@@ -82,6 +106,12 @@ namespace Helium
         //@{
         void UpdateTime();
         //@}
+
+        /// @name Private Utility Functions
+        //@{
+        void UpdateWorldsSeparately( const TaskSchedule &schedule );
+        void DestroyDeferredEntities();
+        //@}
     };
 }
 
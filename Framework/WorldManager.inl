@@ -35,4 +35,34 @@ namespace Helium
     {
         return m_frameDeltaSeconds;
     }
-}
\ No newline at end of file
+
+    /// Set whether each world should be updated on its own.
+    ///
+    /// By default, each task in the schedule runs once over all worlds.  When updating worlds separately, the whole
+    /// schedule is run for each world as a separate job, so independent worlds are updated in parallel and only
+    /// synchronize at the end of the frame.  Tasks must then only touch state belonging to the worlds they are given.
+    /// Per-world update statistics are only gathered in this mode.
+    ///
+    /// Only schedules without render or client tasks (such as those calculated for TickTypes::HeadlessGame) are run
+    /// separately, as those tasks use the renderer, windows and input devices shared by every world.  Other schedules
+    /// are still run once over all worlds.  GameSystem turns this on when running headless (-headless command-line
+    /// switch).
+    ///
+    /// @param[in] bSeparately  True to update each world separately, false to update all worlds together.
+    ///
+    /// @see GetUpdateWorldsSeparately(), World::GetUpdateStats()
+    void WorldManager::SetUpdateWorldsSeparately( bool bSeparately )
+    {
+        m_bUpdateWorldsSeparately = bSeparately;
+    }
+
+    /// Get whether each world is updated on its own.
+    ///
+    /// @return  True if worlds are updated separately, false if they are updated together.
+    ///
+    /// @see SetUpdateWorldsSeparately()
+    bool WorldManager::GetUpdateWorldsSeparately() const
+    {
+        return m_bUpdateWorldsSeparately;
+    }
+}
@@ -4,7 +4,8 @@
 #include "MathSimd/Plane.h"
 #include "MathSimd/Vector3Soa.h"
 #include "MathSimd/VectorConversion.h"
-#include "EngineJobs/EngineJobsInterface.h"
+#include "EngineJobs/JobManager.h"
+#include "EngineJobs/RadixSortJob.h"
 #include "Rendering/RConstantBuffer.h"
 #include "Rendering/RIndexBuffer.h"
 #include "Rendering/RPixelShader.h"
@@ -37,11 +38,25 @@ HELIUM_DEFINE_COMPONENT(Helium::SceneObjectTransform, 32);
 static const size_t SCENE_VIEW_BUFFERED_DRAWER_POOL_BLOCK_SIZE = 4;
 #endif // GRAPHICS_SCENE_BUFFERED_DRAWER
 
+/// Number of low sort key bits holding the sub-mesh index.
+static const uint32_t SORT_KEY_INDEX_BIT_COUNT = 24;
+/// Number of sort key bits holding the depth bucket.
+static const uint32_t SORT_KEY_DEPTH_BIT_COUNT = 16;
+/// Number of sort key bits holding each shader variant ID.
+static const uint32_t SORT_KEY_SHADER_BIT_COUNT = 12;
+/// Number of sort key bits holding the vertex/index buffer ID.
+static const uint32_t SORT_KEY_BUFFER_BIT_COUNT = 16;
+
 namespace Helium
 {
     HELIUM_DECLARE_RPTR( RRenderCommandProxy );
 }
 
+/// Initial number of entries in each sort key ID table (must be a power of two).
+static const size_t SORT_KEY_ID_TABLE_SIZE_MIN = 64;
+/// Minimum number of sub-meshes for which to spawn an additional sort key job.
+static const size_t SORT_KEY_JOB_SUB_MESH_COUNT_MIN = 2048;
+
 /// Constructor.
 GraphicsScene::GraphicsScene()
     :
@@ -59,6 +74,9 @@ GraphicsScene::GraphicsScene()
     , m_activeViewId( Invalid< uint32_t >() )
     , m_constantBufferSetIndex( 0 )
 {
+    m_shaderSortKeyIds.Initialize( SORT_KEY_SHADER_BIT_COUNT );
+    m_bufferSortKeyIds.Initialize( SORT_KEY_BUFFER_BIT_COUNT );
+
 #if GRAPHICS_SCENE_BUFFERED_DRAWER
     HELIUM_VERIFY( m_sceneBufferedDrawer.Initialize() );
 #endif // GRAPHICS_SCENE_BUFFERED_DRAWER
@@ -144,6 +162,9 @@ void GraphicsScene::Update( World *pWorld )
         iter->GraphicsSceneObjectUpdate(this);
     }
 
+    // Refit or rebuild the culling hierarchy with the updated object bounds.
+    m_sceneObjectBvh.Update();
+
     // Swap dynamic constant buffers and update their contents.
     SwapDynamicConstantBuffers();
 
@@ -274,9 +295,36 @@ void GraphicsScene::ReleaseSceneObject( size_t id )
     HELIUM_ASSERT( id < m_sceneObjects.GetSize() );
     HELIUM_ASSERT( m_sceneObjects.IsElementValid( id ) );
 
+    m_sceneObjectBvh.RemoveObject( id );
     m_sceneObjects.Remove( id );
 }
 
+/// Set the world-space bounds of a scene object, updating the culling hierarchy to match.
+///
+/// Objects are not considered for rendering until their bounds have been set at least once.
+///
+/// @param[in] id    ID of the object to update.
+/// @param[in] rBox  World-space bounding box.
+///
+/// @see GraphicsSceneObject::SetWorldBounds()
+void GraphicsScene::SetSceneObjectWorldBounds( size_t id, const Simd::AaBox& rBox )
+{
+    HELIUM_ASSERT( id < m_sceneObjects.GetSize() );
+    HELIUM_ASSERT( m_sceneObjects.IsElementValid( id ) );
+
+    GraphicsSceneObject& rSceneObject = m_sceneObjects[ id ];
+    rSceneObject.SetWorldBounds( rBox );
+
+    const Simd::Sphere& rSphere = rSceneObject.GetWorldSphere();
+    const Simd::Vector3& rCenter = rSphere.GetCenter();
+    m_sceneObjectBvh.SetObjectBounds(
+        id,
+        rCenter.GetElement( 0 ),
+        rCenter.GetElement( 1 ),
+        rCenter.GetElement( 2 ),
+        rSphere.GetRadius() );
+}
+
 /// Allocate new scene object sub-mesh data and add it to the scene.
 ///
 /// @param[in] sceneObjectId  ID of the parent graphics scene object used to control the placement of the sub-mesh
@@ -1160,16 +1208,31 @@ void GraphicsScene::DrawSceneView( uint_fast32_t viewIndex )
 
     const Simd::Frustum& rViewFrustum = rView.GetFrustum();
 
-    size_t sceneObjectCount = m_sceneObjects.GetSize();
-    for( size_t sceneObjectIndex = 0; sceneObjectIndex < sceneObjectCount; ++sceneObjectIndex )
+    if( m_cullingFrustum.Set( rViewFrustum ) )
     {
-        if( m_sceneObjects.IsElementValid( sceneObjectIndex ) )
+        m_visibleSceneObjectIds.Resize( 0 );
+        m_sceneObjectBvh.Cull( m_cullingFrustum, m_visibleSceneObjectIds );
+
+        size_t visibleObjectCount = m_visibleSceneObjectIds.GetSize();
+        for( size_t visibleIndex = 0; visibleIndex < visibleObjectCount; ++visibleIndex )
         {
-            //const AaBox& rObjectBounds = m_sceneObjects[ sceneObjectIndex ].GetWorldBox();
-            const Simd::Sphere& rObjectBounds = m_sceneObjects[ sceneObjectIndex ].GetWorldSphere();
-            if( rViewFrustum.Intersects( rObjectBounds ) )
+            m_visibleSceneObjects.SetElement( m_visibleSceneObjectIds[ visibleIndex ] );
+        }
+    }
+    else
+    {
+        // Frustums without a far clip plane can't be converted to a closed set of culling planes, so test each
+        // object directly.
+        size_t sceneObjectCount = m_sceneObjects.GetSize();
+        for( size_t sceneObjectIndex = 0; sceneObjectIndex < sceneObjectCount; ++sceneObjectIndex )
+        {
+            if( m_sceneObjects.IsElementValid( sceneObjectIndex ) )
             {
-                m_visibleSceneObjects.SetElement( sceneObjectIndex );
+                const Simd::Sphere& rObjectBounds = m_sceneObjects[ sceneObjectIndex ].GetWorldSphere();
+                if( rViewFrustum.Intersects( rObjectBounds ) )
+                {
+                    m_visibleSceneObjects.SetElement( sceneObjectIndex );
+                }
             }
         }
     }
@@ -1436,20 +1499,8 @@ void GraphicsScene::DrawShadowDepthPass( uint_fast32_t viewIndex )
     // Sort meshes based on distance from front to back in order to reduce overdraw.
     size_t subMeshIndexCount = m_sceneObjectSubMeshIndices.GetSize();
 
-    {
-		SortJob< size_t, SubMeshFrontToBackCompare > job;
-
-        SortJob< size_t, SubMeshFrontToBackCompare >::Parameters& rParameters = job.GetParameters();
-        rParameters.pBase = m_sceneObjectSubMeshIndices.GetData();
-        rParameters.count = subMeshIndexCount;
-        rParameters.compare = SubMeshFrontToBackCompare(
-            m_directionalLightDirection,
-            m_sceneObjects,
-            m_sceneObjectSubMeshes );
-        rParameters.singleJobCount = 100;
-
-		job.Run();
-    }
+    BuildDepthSortKeys( m_directionalLightDirection );
+    SortSubMeshIndices( SORT_KEY_DEPTH_BIT_COUNT );
 
     // Prepare the shadow depth pass scene for rendering.
     Renderer* pRenderer = Renderer::GetStaticInstance();
@@ -1643,15 +1694,8 @@ void GraphicsScene::DrawDepthPrePass( uint_fast32_t viewIndex )
 
     size_t subMeshIndexCount = m_sceneObjectSubMeshIndices.GetSize();
 
-    {
-		SortJob< size_t, SubMeshFrontToBackCompare > job;
-        SortJob< size_t, SubMeshFrontToBackCompare >::Parameters& rParameters = job.GetParameters();
-        rParameters.pBase = m_sceneObjectSubMeshIndices.GetData();
-        rParameters.count = subMeshIndexCount;
-        rParameters.compare = SubMeshFrontToBackCompare( rViewDirection, m_sceneObjects, m_sceneObjectSubMeshes );
-        rParameters.singleJobCount = 100;
-		job.Run();
-    }
+    BuildDepthSortKeys( rViewDirection );
+    SortSubMeshIndices( SORT_KEY_DEPTH_BIT_COUNT );
 
     // Initialize the blend state and shaders for performing no color writes.
     Renderer* pRenderer = Renderer::GetStaticInstance();
@@ -1824,16 +1868,8 @@ void GraphicsScene::DrawBasePass( uint_fast32_t viewIndex )
     // Sort meshes based on material in order to reduce shader switches.
     size_t subMeshIndexCount = m_sceneObjectSubMeshIndices.GetSize();
 
-	{
-		SortJob< size_t, SubMeshMaterialCompare > job;
-        SortJob< size_t, SubMeshMaterialCompare >::Parameters& rParameters = job.GetParameters();
-        rParameters.pBase = m_sceneObjectSubMeshIndices.GetData();
-        rParameters.count = subMeshIndexCount;
-        rParameters.compare = SubMeshMaterialCompare( m_sceneObjectSubMeshes );
-        rParameters.singleJobCount = 100;
-
-		job.Run();
-    }
+    BuildMaterialSortKeys();
+    SortSubMeshIndices( SORT_KEY_BUFFER_BIT_COUNT + SORT_KEY_SHADER_BIT_COUNT * 2 );
 
     // Set the opaque rendering blend state and per-view constant buffers for this pass.
     Renderer* pRenderer = Renderer::GetStaticInstance();
@@ -2103,157 +2139,446 @@ void GraphicsScene::DrawBasePass( uint_fast32_t viewIndex )
     }
 }
 
-/// Get a name identifier for "NONE" select options.
+/// Build sort keys ordering the visible sub-mesh list from front to back along a given direction.
 ///
-/// @return  Name for the string "NONE".
-Name GraphicsScene::GetNoneOptionName()
+/// Each key holds the sub-mesh index in its low bits, with the object depth above it quantized to the sign, exponent,
+/// and leading mantissa bits of its floating-point value.
+///
+/// @param[in] rDirection  Direction along which to sort.
+///
+/// @see BuildMaterialSortKeys(), SortSubMeshIndices()
+void GraphicsScene::BuildDepthSortKeys( const Simd::Vector3& rDirection )
 {
-    static Name noneOptionName( TXT( "NONE" ) );
-
-    return noneOptionName;
+    RunSortKeyJobs( SortKeyJob::MODE_DEPTH, &rDirection );
 }
 
-/// Get the name of the skinning system select for shaders.
+/// Build sort keys grouping the visible sub-mesh list by material in order to reduce state changes.
 ///
-/// @return  Skinning system select name.
+/// Keys are ordered by vertex shader variant, then pixel shader variant, then vertex buffer, with the sub-mesh index in
+/// the low bits.  Sub-meshes without a material (or without a given shader variant) use shader ID zero, placing them
+/// first.
 ///
-/// @see GetSkinningSmoothOptionName(), GetSkinningRigidOptionName()
-Name GraphicsScene::GetSkinningSysSelectName()
+/// If there are more distinct shader variants or vertex buffers than fit in the key bits, the excess ones share the
+/// overflow ID, and so are no longer grouped with each other; a warning is logged when this happens.
+///
+/// @see BuildDepthSortKeys(), SortSubMeshIndices()
+void GraphicsScene::BuildMaterialSortKeys()
 {
-    static Name skinningSysSelectName( TXT( "SKINNING" ) );
+    size_t jobCount = RunSortKeyJobs( SortKeyJob::MODE_MATERIAL, NULL );
 
-    return skinningSysSelectName;
+    // Map the IDs assigned by each job to shared IDs.
+    m_shaderSortKeyIds.Clear();
+    m_bufferSortKeyIds.Clear();
+
+    size_t localOverflowCount = 0;
+    for( size_t jobIndex = 0; jobIndex < jobCount; ++jobIndex )
+    {
+        SortKeyJob& rJob = m_sortKeyJobs[ jobIndex ];
+
+        uint32_t shaderIdCount = rJob.shaderIds.GetIdCount();
+        rJob.shaderIdMap.Resize( shaderIdCount );
+        for( uint32_t id = 0; id < shaderIdCount; ++id )
+        {
+            rJob.shaderIdMap[ id ] = m_shaderSortKeyIds.GetId( rJob.shaderIds.GetPointer( id ) );
+        }
+
+        uint32_t bufferIdCount = rJob.bufferIds.GetIdCount();
+        rJob.bufferIdMap.Resize( bufferIdCount );
+        for( uint32_t id = 0; id < bufferIdCount; ++id )
+        {
+            rJob.bufferIdMap[ id ] = m_bufferSortKeyIds.GetId( rJob.bufferIds.GetPointer( id ) );
+        }
+
+        localOverflowCount += rJob.shaderIds.GetOverflowCount() + rJob.bufferIds.GetOverflowCount();
+    }
+
+    if( localOverflowCount != 0 ||
+        m_shaderSortKeyIds.GetOverflowCount() != 0 ||
+        m_bufferSortKeyIds.GetOverflowCount() != 0 )
+    {
+        HELIUM_TRACE(
+            TraceLevels::Warning,
+            ( TXT( "GraphicsScene: Too many distinct shader variants or vertex buffers to fit in sort keys (%" ) PRIu32
+            TXT( " shader variants, %" ) PRIu32 TXT( " vertex buffers assigned); the excess ones will not be grouped " )
+            TXT( "together.\n" ) ),
+            m_shaderSortKeyIds.GetIdCount() - 1,
+            m_bufferSortKeyIds.GetIdCount() - 1 );
+    }
+
+    RunSortKeyJobs( SortKeyJob::MODE_MATERIAL_REMAP, NULL );
 }
 
-/// Get the name of the smooth skinning system select option for shaders.
+/// Split the visible sub-mesh list between sort key jobs and run them, waiting for all of them to finish.
 ///
-/// @return  Smooth skinning select option name.
+/// Small lists are handled by a single job on the calling thread.  When remapping material keys, the list is split
+/// exactly as it was when the keys were built, so that each job sees the keys built with its own ID tables.
 ///
-/// @see GetSkinningSysSelectName(), GetSkinningRigidOptionName()
-Name GraphicsScene::GetSkinningSmoothOptionName()
+/// @param[in] mode        Key building mode (SortKeyJob::EMode).
+/// @param[in] pDirection  Sort direction (depth sort keys only).
+///
+/// @return  Number of jobs run.
+size_t GraphicsScene::RunSortKeyJobs( uint32_t mode, const Simd::Vector3* pDirection )
 {
-    static Name skinningSmoothOptionName( TXT( "SKINNING_SMOOTH" ) );
+    size_t subMeshIndexCount = m_sceneObjectSubMeshIndices.GetSize();
+    HELIUM_ASSERT( subMeshIndexCount < ( static_cast< size_t >( 1 ) << SORT_KEY_INDEX_BIT_COUNT ) );
+    m_subMeshSortKeys.Resize( subMeshIndexCount );
 
-    return skinningSmoothOptionName;
+    JobManager& rJobManager = JobManager::GetStaticInstance();
+
+    size_t jobCount = 1;
+    if( rJobManager.IsInitialized() )
+    {
+        jobCount = Min< size_t >(
+            subMeshIndexCount / SORT_KEY_JOB_SUB_MESH_COUNT_MIN,
+            rJobManager.GetWorkerThreadCount() + 1 );
+        jobCount = Max< size_t >( jobCount, 1 );
+    }
+
+    // Jobs (and the ID tables they hold) are kept around for later frames.
+    size_t previousJobCount = m_sortKeyJobs.GetSize();
+    if( jobCount > previousJobCount )
+    {
+        m_sortKeyJobs.Resize( jobCount );
+        for( size_t jobIndex = previousJobCount; jobIndex < jobCount; ++jobIndex )
+        {
+            m_sortKeyJobs[ jobIndex ].shaderIds.Initialize( SORT_KEY_SHADER_BIT_COUNT );
+            m_sortKeyJobs[ jobIndex ].bufferIds.Initialize( SORT_KEY_BUFFER_BIT_COUNT );
+        }
+    }
+
+    size_t startIndex = 0;
+    for( size_t jobIndex = 0; jobIndex < jobCount; ++jobIndex )
+    {
+        SortKeyJob& rJob = m_sortKeyJobs[ jobIndex ];
+        rJob.pScene = this;
+        rJob.pDirection = pDirection;
+        rJob.startIndex = startIndex;
+        rJob.count = ( subMeshIndexCount - startIndex ) / ( jobCount - jobIndex );
+        rJob.mode = mode;
+
+        startIndex += rJob.count;
+    }
+
+    HELIUM_ASSERT( startIndex == subMeshIndexCount );
+
+    JobCounter counter;
+    for( size_t jobIndex = 1; jobIndex < jobCount; ++jobIndex )
+    {
+        rJobManager.Spawn( m_sortKeyJobs[ jobIndex ], &counter );
+    }
+
+    m_sortKeyJobs[ 0 ].Run();
+
+    if( jobCount > 1 )
+    {
+        rJobManager.WaitForCounter( counter );
+    }
+
+    return jobCount;
 }
 
-/// Get the name of the rigid skinning system select option for shaders.
+/// Sort the visible sub-mesh list using the keys built by BuildDepthSortKeys() or BuildMaterialSortKeys().
 ///
-/// @return  Rigid skinning select option name.
+/// @param[in] keyBitCount  Number of key bits above the sub-mesh index used for ordering.
 ///
-/// @see GetSkinningSysSelectName(), GetSkinningSmoothOptionName()
-Name GraphicsScene::GetSkinningRigidOptionName()
+/// @see BuildDepthSortKeys(), BuildMaterialSortKeys()
+void GraphicsScene::SortSubMeshIndices( uint32_t keyBitCount )
 {
-    static Name skinningRigidOptionName( TXT( "SKINNING_RIGID" ) );
+    size_t subMeshIndexCount = m_sceneObjectSubMeshIndices.GetSize();
+    HELIUM_ASSERT( m_subMeshSortKeys.GetSize() == subMeshIndexCount );
 
-    return skinningRigidOptionName;
-}
+    m_subMeshSortScratch.Resize( subMeshIndexCount );
 
-/// Constructor.
-GraphicsScene::SubMeshFrontToBackCompare::SubMeshFrontToBackCompare()
-: m_cameraDirection( 0.0f )
-, m_pSceneObjects( NULL )
-, m_pSubMeshes( NULL )
-{
+    RadixSortJob job;
+    RadixSortJob::Parameters& rParameters = job.GetParameters();
+    rParameters.pKeys = m_subMeshSortKeys.GetData();
+    rParameters.pScratch = m_subMeshSortScratch.GetData();
+    rParameters.count = subMeshIndexCount;
+    rParameters.keyShift = SORT_KEY_INDEX_BIT_COUNT;
+    rParameters.keyBitCount = keyBitCount;
+    job.Run();
+
+    const uint64_t indexMask = ( static_cast< uint64_t >( 1 ) << SORT_KEY_INDEX_BIT_COUNT ) - 1;
+    for( size_t meshIndexIndex = 0; meshIndexIndex < subMeshIndexCount; ++meshIndexIndex )
+    {
+        m_sceneObjectSubMeshIndices[ meshIndexIndex ] =
+            static_cast< size_t >( m_subMeshSortKeys[ meshIndexIndex ] & indexMask );
+    }
 }
 
 /// Constructor.
-///
-/// @param[in] rCameraDirection  Camera world direction.
-/// @param[in] rSceneObjects     List of graphics scene objects in the scene.
-/// @param[in] rSubMeshes        List of scene object sub-meshes in the scene.
-GraphicsScene::SubMeshFrontToBackCompare::SubMeshFrontToBackCompare(
-    const Simd::Vector3& rCameraDirection,
-    const SparseArray< GraphicsSceneObject >& rSceneObjects,
-    const SparseArray< GraphicsSceneObject::SubMeshData >& rSubMeshes )
-    : m_cameraDirection( rCameraDirection )
-    , m_pSceneObjects( &rSceneObjects )
-    , m_pSubMeshes( &rSubMeshes )
+GraphicsScene::SortKeyIdTable::SortKeyIdTable()
+    : m_mask( 0 )
+    , m_generation( 0 )
+    , m_overflowId( 0 )
+    , m_overflowCount( 0 )
 {
 }
 
-/// Compare two sub-meshes for sorting.
-///
-/// @param[in] subMeshIndex0  Index of the first sub-mesh to compare.
-/// @param[in] subMeshIndex1  Index of the second sub-mesh to compare.
+/// Set up this table for a given ID size, removing any existing IDs.
 ///
-/// @return  True if the first sub-mesh should be sorted before the second, false if it should be sorted after or if
-///          they share the same sorting priority.
-bool GraphicsScene::SubMeshFrontToBackCompare::operator()( size_t subMeshIndex0, size_t subMeshIndex1 ) const
+/// @param[in] idBitCount  Number of key bits available for each ID.
+void GraphicsScene::SortKeyIdTable::Initialize( uint32_t idBitCount )
 {
-    const GraphicsSceneObject::SubMeshData& rSubMesh0 = m_pSubMeshes->GetElement( subMeshIndex0 );
-    const GraphicsSceneObject::SubMeshData& rSubMesh1 = m_pSubMeshes->GetElement( subMeshIndex1 );
-
-    size_t sceneObjectIndex0 = rSubMesh0.GetSceneObjectId();
-    HELIUM_ASSERT( m_pSceneObjects->IsElementValid( sceneObjectIndex0 ) );
-    size_t sceneObjectIndex1 = rSubMesh1.GetSceneObjectId();
-    HELIUM_ASSERT( m_pSceneObjects->IsElementValid( sceneObjectIndex1 ) );
+    HELIUM_ASSERT( idBitCount > 1 && idBitCount < 32 );
 
-    const GraphicsSceneObject& rSceneObject0 = m_pSceneObjects->GetElement( sceneObjectIndex0 );
-    const GraphicsSceneObject& rSceneObject1 = m_pSceneObjects->GetElement( sceneObjectIndex1 );
+    m_overflowId = ( static_cast< uint32_t >( 1 ) << idBitCount ) - 1;
 
-    Simd::Vector3 object0Pos = Simd::Vector4ToVector3( rSceneObject0.GetTransform().GetRow( 3 ) );
-    Simd::Vector3 object1Pos = Simd::Vector4ToVector3( rSceneObject1.GetTransform().GetRow( 3 ) );
-
-    float distance0 = object0Pos.Dot( m_cameraDirection );
-    float distance1 = object1Pos.Dot( m_cameraDirection );
-
-    return ( distance0 < distance1 );
-}
+    m_pointers.Resize( SORT_KEY_ID_TABLE_SIZE_MIN );
+    m_ids.Resize( SORT_KEY_ID_TABLE_SIZE_MIN );
+    m_generations.Resize( SORT_KEY_ID_TABLE_SIZE_MIN );
+    MemoryZero( m_generations.GetData(), m_generations.GetSize() * sizeof( uint32_t ) );
+    m_mask = SORT_KEY_ID_TABLE_SIZE_MIN - 1;
 
-/// Constructor.
-GraphicsScene::SubMeshMaterialCompare::SubMeshMaterialCompare()
-: m_pSubMeshes( NULL )
-{
+    m_generation = 0;
+    Clear();
 }
 
-/// Constructor.
+/// Remove all IDs from this table.
 ///
-/// @param[in] rSubMeshes  List of scene object sub-meshes in the scene.
-GraphicsScene::SubMeshMaterialCompare::SubMeshMaterialCompare(
-    const SparseArray< GraphicsSceneObject::SubMeshData >& rSubMeshes )
-    : m_pSubMeshes( &rSubMeshes )
+/// Table entries are freed by advancing the table generation instead of clearing every entry.
+void GraphicsScene::SortKeyIdTable::Clear()
 {
+    ++m_generation;
+    if( m_generation == 0 )
+    {
+        MemoryZero( m_generations.GetData(), m_generations.GetSize() * sizeof( uint32_t ) );
+        m_generation = 1;
+    }
+
+    m_idPointers.Resize( 1 );
+    m_idPointers[ 0 ] = NULL;
+
+    m_overflowCount = 0;
 }
 
-/// Compare two sub-meshes for sorting.
+/// Get the ID for a pointer, assigning the next available ID if the pointer has not been seen since the table was last
+/// cleared.
 ///
-/// @param[in] subMeshIndex0  Index of the first sub-mesh to compare.
-/// @param[in] subMeshIndex1  Index of the second sub-mesh to compare.
+/// @param[in] pPointer  Pointer to look up.
 ///
-/// @return  True if the first sub-mesh should be sorted before the second, false if it should be sorted after or if
-///          they share the same sorting priority.
-bool GraphicsScene::SubMeshMaterialCompare::operator()( size_t subMeshIndex0, size_t subMeshIndex1 ) const
+/// @return  ID for the pointer, or the overflow ID if all other IDs have already been assigned.
+///
+/// @see GetOverflowId()
+uint32_t GraphicsScene::SortKeyIdTable::GetId( const void* pPointer )
 {
-    const GraphicsSceneObject::SubMeshData& rSubMesh0 = m_pSubMeshes->GetElement( subMeshIndex0 );
-    const GraphicsSceneObject::SubMeshData& rSubMesh1 = m_pSubMeshes->GetElement( subMeshIndex1 );
+    if( !pPointer )
+    {
+        return 0;
+    }
 
-    Material* pMaterial0 = rSubMesh0.GetMaterial();
-    Material* pMaterial1 = rSubMesh1.GetMaterial();
-    if( pMaterial0 == pMaterial1 )
+    // Keep the table at most half full, which also guarantees that the search below finds a free entry.
+    uint32_t id = static_cast< uint32_t >( m_idPointers.GetSize() );
+    if( id < m_overflowId && id * 2 > m_mask + 1 )
     {
-        return false;
+        Grow();
     }
 
-    if( !pMaterial0 )
+    size_t index = ( reinterpret_cast< uintptr_t >( pPointer ) >> 4 ) * 2654435761u;
+    for( ; ; ++index )
     {
-        return true;
+        index &= m_mask;
+        if( m_generations[ index ] != m_generation )
+        {
+            break;
+        }
+
+        if( m_pointers[ index ] == pPointer )
+        {
+            return m_ids[ index ];
+        }
     }
 
-    if( !pMaterial1 )
+    if( id >= m_overflowId )
     {
-        return false;
+        ++m_overflowCount;
+
+        return m_overflowId;
     }
 
-    ShaderVariant* pVariant0 = pMaterial0->GetShaderVariant( RShader::TYPE_VERTEX );
-    ShaderVariant* pVariant1 = pMaterial1->GetShaderVariant( RShader::TYPE_VERTEX );
-    if( pVariant0 != pVariant1 )
+    m_pointers[ index ] = pPointer;
+    m_ids[ index ] = id;
+    m_generations[ index ] = m_generation;
+    m_idPointers.Push( pPointer );
+
+    return id;
+}
+
+/// Double the size of this table, reinserting all pointers that currently have IDs.
+void GraphicsScene::SortKeyIdTable::Grow()
+{
+    size_t tableSize = ( m_mask + 1 ) * 2;
+    m_pointers.Resize( tableSize );
+    m_ids.Resize( tableSize );
+    m_generations.Resize( tableSize );
+    MemoryZero( m_generations.GetData(), tableSize * sizeof( uint32_t ) );
+    m_mask = tableSize - 1;
+    m_generation = 1;
+
+    uint32_t idCount = static_cast< uint32_t >( m_idPointers.GetSize() );
+    for( uint32_t id = 1; id < idCount; ++id )
     {
-        return ( pVariant0 < pVariant1 );
+        const void* pPointer = m_idPointers[ id ];
+
+        size_t index = ( reinterpret_cast< uintptr_t >( pPointer ) >> 4 ) * 2654435761u;
+        for( ; ; ++index )
+        {
+            index &= m_mask;
+            if( m_generations[ index ] != m_generation )
+            {
+                break;
+            }
+        }
+
+        m_pointers[ index ] = pPointer;
+        m_ids[ index ] = id;
+        m_generations[ index ] = m_generation;
+    }
+}
+
+/// Build the sort keys for this job's range of the visible sub-mesh list.
+void GraphicsScene::SortKeyJob::Run()
+{
+    HELIUM_ASSERT( pScene );
+
+    const uint32_t bufferShift = SORT_KEY_INDEX_BIT_COUNT;
+    const uint32_t pixelShaderShift = bufferShift + SORT_KEY_BUFFER_BIT_COUNT;
+    const uint32_t vertexShaderShift = pixelShaderShift + SORT_KEY_SHADER_BIT_COUNT;
+
+    const uint64_t indexMask = ( static_cast< uint64_t >( 1 ) << SORT_KEY_INDEX_BIT_COUNT ) - 1;
+    const uint64_t bufferMask = ( static_cast< uint64_t >( 1 ) << SORT_KEY_BUFFER_BIT_COUNT ) - 1;
+    const uint64_t shaderMask = ( static_cast< uint64_t >( 1 ) << SORT_KEY_SHADER_BIT_COUNT ) - 1;
+
+    const DynamicArray< size_t >& rSubMeshIndices = pScene->m_sceneObjectSubMeshIndices;
+    uint64_t* pKeys = pScene->m_subMeshSortKeys.GetData();
+
+    size_t endIndex = startIndex + count;
+
+    if( mode == MODE_MATERIAL )
+    {
+        shaderIds.Clear();
+        bufferIds.Clear();
+    }
+
+    for( size_t meshIndexIndex = startIndex; meshIndexIndex < endIndex; ++meshIndexIndex )
+    {
+        if( mode == MODE_MATERIAL_REMAP )
+        {
+            // Shared IDs are only missing for overflow IDs, which are the same in every table.
+            uint64_t key = pKeys[ meshIndexIndex ];
+            uint32_t bufferId = static_cast< uint32_t >( ( key >> bufferShift ) & bufferMask );
+            uint32_t pixelShaderId = static_cast< uint32_t >( ( key >> pixelShaderShift ) & shaderMask );
+            uint32_t vertexShaderId = static_cast< uint32_t >( ( key >> vertexShaderShift ) & shaderMask );
+
+            bufferId = ( bufferId < bufferIdMap.GetSize() ? bufferIdMap[ bufferId ] : bufferId );
+            pixelShaderId = ( pixelShaderId < shaderIdMap.GetSize() ? shaderIdMap[ pixelShaderId ] : pixelShaderId );
+            vertexShaderId = ( vertexShaderId < shaderIdMap.GetSize() ? shaderIdMap[ vertexShaderId ] : vertexShaderId );
+
+            pKeys[ meshIndexIndex ] =
+                ( key & indexMask ) |
+                ( static_cast< uint64_t >( bufferId ) << bufferShift ) |
+                ( static_cast< uint64_t >( pixelShaderId ) << pixelShaderShift ) |
+                ( static_cast< uint64_t >( vertexShaderId ) << vertexShaderShift );
+
+            continue;
+        }
+
+        size_t subMeshIndex = rSubMeshIndices[ meshIndexIndex ];
+        HELIUM_ASSERT( subMeshIndex < ( static_cast< size_t >( 1 ) << SORT_KEY_INDEX_BIT_COUNT ) );
+
+        const GraphicsSceneObject::SubMeshData& rSubMesh = pScene->m_sceneObjectSubMeshes[ subMeshIndex ];
+        size_t sceneObjectId = rSubMesh.GetSceneObjectId();
+        HELIUM_ASSERT( pScene->m_sceneObjects.IsElementValid( sceneObjectId ) );
+        const GraphicsSceneObject& rSceneObject = pScene->m_sceneObjects[ sceneObjectId ];
+
+        if( mode == MODE_DEPTH )
+        {
+            HELIUM_ASSERT( pDirection );
+
+            Simd::Vector3 position = Simd::Vector4ToVector3( rSceneObject.GetTransform().GetRow( 3 ) );
+            float32_t distance = position.Dot( *pDirection );
+
+            // Flip the float bits so that unsigned integer order matches floating-point order.
+            uint32_t depthBits;
+            MemoryCopy( &depthBits, &distance, sizeof( depthBits ) );
+            depthBits = ( depthBits & 0x80000000 ) ? ~depthBits : ( depthBits | 0x80000000 );
+
+            uint64_t depthBucket = depthBits >> ( 32 - SORT_KEY_DEPTH_BIT_COUNT );
+            pKeys[ meshIndexIndex ] = ( depthBucket << SORT_KEY_INDEX_BIT_COUNT ) | subMeshIndex;
+
+            continue;
+        }
+
+        HELIUM_ASSERT( mode == MODE_MATERIAL );
+
+        uint64_t key = subMeshIndex;
+        key |= static_cast< uint64_t >( bufferIds.GetId( rSceneObject.GetVertexBuffer() ) ) << bufferShift;
+
+        Material* pMaterial = rSubMesh.GetMaterial();
+        if( pMaterial )
+        {
+            uint64_t vertexShaderId = shaderIds.GetId( pMaterial->GetShaderVariant( RShader::TYPE_VERTEX ) );
+            uint64_t pixelShaderId = shaderIds.GetId( pMaterial->GetShaderVariant( RShader::TYPE_PIXEL ) );
+            key |= vertexShaderId << vertexShaderShift;
+            key |= pixelShaderId << pixelShaderShift;
+        }
+
+        pKeys[ meshIndexIndex ] = key;
     }
+}
 
-    pVariant0 = pMaterial0->GetShaderVariant( RShader::TYPE_PIXEL );
-    pVariant1 = pMaterial1->GetShaderVariant( RShader::TYPE_PIXEL );
+/// Callback executed to run the job.
+///
+/// @param[in] pJob  Job to run.
+void GraphicsScene::SortKeyJob::RunCallback( void* pJob )
+{
+    HELIUM_ASSERT( pJob );
+    static_cast< SortKeyJob* >( pJob )->Run();
+}
+
+/// Get a name identifier for "NONE" select options.
+///
+/// @return  Name for the string "NONE".
+Name GraphicsScene::GetNoneOptionName()
+{
+    static Name noneOptionName( TXT( "NONE" ) );
 
-    return ( pVariant0 < pVariant1 );
+    return noneOptionName;
 }
+
+/// Get the name of the skinning system select for shaders.
+///
+/// @return  Skinning system select name.
+///
+/// @see GetSkinningSmoothOptionName(), GetSkinningRigidOptionName()
+Name GraphicsScene::GetSkinningSysSelectName()
+{
+    static Name skinningSysSelectName( TXT( "SKINNING" ) );
+
+    return skinningSysSelectName;
+}
+
+/// Get the name of the smooth skinning system select option for shaders.
+///
+/// @return  Smooth skinning select option name.
+///
+/// @see GetSkinningSysSelectName(), GetSkinningRigidOptionName()
+Name GraphicsScene::GetSkinningSmoothOptionName()
+{
+    static Name skinningSmoothOptionName( TXT( "SKINNING_SMOOTH" ) );
+
+    return skinningSmoothOptionName;
+}
+
+/// Get the name of the rigid skinning system select option for shaders.
+///
+/// @return  Rigid skinning select option name.
+///
+/// @see GetSkinningSysSelectName(), GetSkinningSmoothOptionName()
+Name GraphicsScene::GetSkinningRigidOptionName()
+{
+    static Name skinningRigidOptionName( TXT( "SKINNING_RIGID" ) );
+
+    return skinningRigidOptionName;
+}
+
@@ -6,6 +6,7 @@
 
 #include "Foundation/BitArray.h"
 #include "Rendering/RRenderResource.h"
+#include "Graphics/GraphicsSceneCulling.h"
 #include "GraphicsTypes/GraphicsSceneObject.h"
 #include "GraphicsTypes/GraphicsSceneView.h"
 
@@ -56,6 +57,8 @@ namespace Helium
         size_t AllocateSceneObject();
         void ReleaseSceneObject( size_t id );
         inline GraphicsSceneObject* GetSceneObject( size_t id );
+
+        void SetSceneObjectWorldBounds( size_t id, const Simd::AaBox& rBox );
         //@}
 
         /// @name Scene Asset Sub-mesh Allocation
@@ -96,50 +99,93 @@ namespace Helium
         //@}
 
     private:
-        /// Front-to-back sub-mesh sort comparison function
-        class HELIUM_GRAPHICS_API SubMeshFrontToBackCompare
+        /// Table assigning small sequential IDs to pointers for packing into sort keys.
+        ///
+        /// The null pointer always maps to ID zero, and the largest ID that fits in the key bits is reserved for
+        /// pointers that arrive once all other IDs have been handed out.  The table is kept across frames and cleared
+        /// by advancing a generation counter, growing only as needed to hold the IDs assigned.
+        class SortKeyIdTable
         {
         public:
             /// @name Construction/Destruction
             //@{
-            SubMeshFrontToBackCompare();
-            SubMeshFrontToBackCompare(
-                const Simd::Vector3& rCameraDirection, const SparseArray< GraphicsSceneObject >& rSceneObjects,
-                const SparseArray< GraphicsSceneObject::SubMeshData >& rSubMeshes );
+            SortKeyIdTable();
             //@}
 
-            /// @name Overloaded Operators
+            /// @name Table Access
             //@{
-            bool operator()( size_t subMeshIndex0, size_t subMeshIndex1 ) const;
+            void Initialize( uint32_t idBitCount );
+            void Clear();
+
+            uint32_t GetId( const void* pPointer );
+
+            inline uint32_t GetIdCount() const;
+            inline const void* GetPointer( uint32_t id ) const;
+            inline uint32_t GetOverflowId() const;
+            inline size_t GetOverflowCount() const;
             //@}
 
         private:
-            /// Camera direction.
-            Simd::Vector3 m_cameraDirection;
-            /// Scene object list.
-            const SparseArray< GraphicsSceneObject >* m_pSceneObjects;
-            /// Scene object sub-mesh list.
-            const SparseArray< GraphicsSceneObject::SubMeshData >* m_pSubMeshes;
+            /// Pointer stored in each table entry.
+            DynamicArray< const void* > m_pointers;
+            /// ID assigned to each table entry.
+            DynamicArray< uint32_t > m_ids;
+            /// Generation in which each table entry was filled (entries from other generations are free).
+            DynamicArray< uint32_t > m_generations;
+            /// Pointer assigned to each ID.
+            DynamicArray< const void* > m_idPointers;
+            /// Table index mask.
+            size_t m_mask;
+            /// Current table generation.
+            uint32_t m_generation;
+            /// ID shared by all pointers that could not be given their own ID.
+            uint32_t m_overflowId;
+            /// Number of lookups that returned the overflow ID since the table was last cleared.
+            size_t m_overflowCount;
+
+            void Grow();
         };
 
-        /// Material-based sub-mesh sort comparison function
-        class HELIUM_GRAPHICS_API SubMeshMaterialCompare
+        /// Job building the sort keys for a range of the visible sub-mesh list.
+        ///
+        /// Material keys are first built using IDs local to each job, which are then mapped to IDs shared by all jobs
+        /// once each job's ID tables have been merged.
+        class SortKeyJob
         {
         public:
-            /// @name Construction/Destruction
-            //@{
-            SubMeshMaterialCompare();
-            explicit SubMeshMaterialCompare( const SparseArray< GraphicsSceneObject::SubMeshData >& rSubMeshes );
-            //@}
-
-            /// @name Overloaded Operators
-            //@{
-            bool operator()( size_t subMeshIndex0, size_t subMeshIndex1 ) const;
-            //@}
-
-        private:
-            /// Scene object sub-mesh list.
-            const SparseArray< GraphicsSceneObject::SubMeshData >* m_pSubMeshes;
+            /// Key building modes.
+            enum EMode
+            {
+                /// Build depth sort keys.
+                MODE_DEPTH,
+                /// Build material sort keys using job-local IDs.
+                MODE_MATERIAL,
+                /// Replace job-local IDs in material sort keys with shared IDs.
+                MODE_MATERIAL_REMAP
+            };
+
+            /// Scene for which to build keys.
+            GraphicsScene* pScene;
+            /// Sort direction (depth sort keys only).
+            const Simd::Vector3* pDirection;
+            /// Index of the first sub-mesh index list entry to process.
+            size_t startIndex;
+            /// Number of sub-mesh index list entries to process.
+            size_t count;
+            /// Key building mode (EMode).
+            uint32_t mode;
+
+            /// Job-local shader variant IDs.
+            SortKeyIdTable shaderIds;
+            /// Job-local vertex buffer IDs.
+            SortKeyIdTable bufferIds;
+            /// Shared shader variant ID for each job-local ID.
+            DynamicArray< uint32_t > shaderIdMap;
+            /// Shared vertex buffer ID for each job-local ID.
+            DynamicArray< uint32_t > bufferIdMap;
+
+            void Run();
+            static void RunCallback( void* pJob );
         };
 
         /// Scene view list.
@@ -158,10 +204,26 @@ namespace Helium
         DynamicArray< BufferedDrawer* > m_viewBufferedDrawers;
 #endif // GRAPHICS_SCENE_BUFFERED_DRAWER
 
+        /// Bounding volume hierarchy over scene object bounds used for view culling.
+        SceneObjectBvh m_sceneObjectBvh;
+        /// Culling planes for the current view.
+        CullingFrustum m_cullingFrustum;
+        /// IDs of scene objects visible in the current view.
+        DynamicArray< uint32_t > m_visibleSceneObjectIds;
         /// Visible scene objects for the current view.
         BitArray<> m_visibleSceneObjects;
         /// Scene object sub-data index list (for sorting during rendering).
         DynamicArray< size_t > m_sceneObjectSubMeshIndices;
+        /// Packed sort keys for each entry in the sub-data index list.
+        DynamicArray< uint64_t > m_subMeshSortKeys;
+        /// Scratch space for sorting the sub-data sort keys.
+        DynamicArray< uint64_t > m_subMeshSortScratch;
+        /// Shader variant IDs shared by all jobs building material sort keys.
+        SortKeyIdTable m_shaderSortKeyIds;
+        /// Vertex buffer IDs shared by all jobs building material sort keys.
+        SortKeyIdTable m_bufferSortKeyIds;
+        /// Jobs used to build sort keys (kept across frames along with their ID tables).
+        DynamicArray< SortKeyJob > m_sortKeyJobs;
 
         /// Ambient light top color.
         Color m_ambientLightTopColor;
@@ -228,6 +290,11 @@ namespace Helium
         void DrawShadowDepthPass( uint_fast32_t viewIndex );
         void DrawDepthPrePass( uint_fast32_t viewIndex );
         void DrawBasePass( uint_fast32_t viewIndex );
+
+        void BuildDepthSortKeys( const Simd::Vector3& rDirection );
+        void BuildMaterialSortKeys();
+        size_t RunSortKeyJobs( uint32_t mode, const Simd::Vector3* pDirection );
+        void SortSubMeshIndices( uint32_t keyBitCount );
         //@}
 
         /// @name Private Static Utility Functions
@@ -118,6 +118,42 @@ namespace Helium
         return m_directionalLightBrightness;
     }
 
+    /// Get the number of IDs in use, including the null pointer ID (zero).
+    ///
+    /// @return  Number of IDs in use (IDs range from zero to one less than this value, plus the overflow ID).
+    uint32_t GraphicsScene::SortKeyIdTable::GetIdCount() const
+    {
+        return static_cast< uint32_t >( m_idPointers.GetSize() );
+    }
+
+    /// Get the pointer assigned to an ID.
+    ///
+    /// @param[in] id  ID less than GetIdCount().
+    ///
+    /// @return  Pointer assigned to the ID.
+    const void* GraphicsScene::SortKeyIdTable::GetPointer( uint32_t id ) const
+    {
+        HELIUM_ASSERT( id < m_idPointers.GetSize() );
+
+        return m_idPointers[ id ];
+    }
+
+    /// Get the ID shared by all pointers that arrive once the table has run out of IDs.
+    ///
+    /// @return  Overflow ID.
+    uint32_t GraphicsScene::SortKeyIdTable::GetOverflowId() const
+    {
+        return m_overflowId;
+    }
+
+    /// Get the number of lookups that returned the overflow ID since the table was last cleared.
+    ///
+    /// @return  Overflow lookup count.
+    size_t GraphicsScene::SortKeyIdTable::GetOverflowCount() const
+    {
+        return m_overflowCount;
+    }
+
 #if GRAPHICS_SCENE_BUFFERED_DRAWER
     /// Get the buffered drawing interface for the entire scene.
     ///
@@ -0,0 +1,910 @@
+#include "GraphicsPch.h"
+#include "Graphics/GraphicsSceneCulling.h"
+
+#include "EngineJobs/JobManager.h"
+
+#include <algorithm>
+
+using namespace Helium;
+
+/// Number of floats stored per object in the master bounds array.
+static const size_t OBJECT_BOUNDS_STRIDE = 4;
+/// Tree depth at which subtrees are handed out to separate culling jobs.
+static const size_t PARALLEL_CULL_SUBTREE_DEPTH = 5;
+
+namespace
+{
+    /// Compare object IDs by the position of their bounding sphere center along one axis.
+    class CenterAxisCompare
+    {
+    public:
+        CenterAxisCompare( const float32_t* pObjectBounds, size_t axis )
+            : m_pObjectBounds( pObjectBounds )
+            , m_axis( axis )
+        {
+        }
+
+        bool operator()( uint32_t id0, uint32_t id1 ) const
+        {
+            return m_pObjectBounds[ id0 * OBJECT_BOUNDS_STRIDE + m_axis ] <
+                m_pObjectBounds[ id1 * OBJECT_BOUNDS_STRIDE + m_axis ];
+        }
+
+    private:
+        const float32_t* m_pObjectBounds;
+        size_t m_axis;
+    };
+}
+
+/// Constructor.
+CullingFrustum::CullingFrustum()
+    : m_planeCount( 0 )
+{
+}
+
+/// Extract the planes of a frustum for culling.
+///
+/// The planes are found from the frustum corners: every plane passing through three corners with all eight corners on
+/// the same side is a face of the (convex) frustum.  This only relies on the corner positions and not on their order.
+///
+/// @param[in] rFrustum  Frustum to convert.
+///
+/// @return  True if the frustum was converted, false if it has no far clip plane (in which case the caller should
+///          fall back to testing against the frustum directly).
+bool CullingFrustum::Set( const Simd::Frustum& rFrustum )
+{
+    m_planeCount = 0;
+
+    HELIUM_SIMD_ALIGN_PRE float32_t cornersX[ 8 ] HELIUM_SIMD_ALIGN_POST;
+    HELIUM_SIMD_ALIGN_PRE float32_t cornersY[ 8 ] HELIUM_SIMD_ALIGN_POST;
+    HELIUM_SIMD_ALIGN_PRE float32_t cornersZ[ 8 ] HELIUM_SIMD_ALIGN_POST;
+    size_t cornerCount = rFrustum.ComputeCornersSoa( cornersX, cornersY, cornersZ );
+    if( cornerCount != 8 )
+    {
+        return false;
+    }
+
+    float32_t centroidX = 0.0f;
+    float32_t centroidY = 0.0f;
+    float32_t centroidZ = 0.0f;
+    float32_t extent = 0.0f;
+    for( size_t cornerIndex = 0; cornerIndex < 8; ++cornerIndex )
+    {
+        centroidX += cornersX[ cornerIndex ];
+        centroidY += cornersY[ cornerIndex ];
+        centroidZ += cornersZ[ cornerIndex ];
+        extent = Max( extent, fabsf( cornersX[ cornerIndex ] ) );
+        extent = Max( extent, fabsf( cornersY[ cornerIndex ] ) );
+        extent = Max( extent, fabsf( cornersZ[ cornerIndex ] ) );
+    }
+
+    centroidX *= 0.125f;
+    centroidY *= 0.125f;
+    centroidZ *= 0.125f;
+
+    const float32_t epsilon = Max( extent, 1.0f ) * 1.0e-4f;
+
+    for( size_t i0 = 0; i0 < 8; ++i0 )
+    {
+        for( size_t i1 = i0 + 1; i1 < 8; ++i1 )
+        {
+            for( size_t i2 = i1 + 1; i2 < 8; ++i2 )
+            {
+                float32_t edge0X = cornersX[ i1 ] - cornersX[ i0 ];
+                float32_t edge0Y = cornersY[ i1 ] - cornersY[ i0 ];
+                float32_t edge0Z = cornersZ[ i1 ] - cornersZ[ i0 ];
+                float32_t edge1X = cornersX[ i2 ] - cornersX[ i0 ];
+                float32_t edge1Y = cornersY[ i2 ] - cornersY[ i0 ];
+                float32_t edge1Z = cornersZ[ i2 ] - cornersZ[ i0 ];
+
+                float32_t normalX = edge0Y * edge1Z - edge0Z * edge1Y;
+                float32_t normalY = edge0Z * edge1X - edge0X * edge1Z;
+                float32_t normalZ = edge0X * edge1Y - edge0Y * edge1X;
+                float32_t length = sqrtf( normalX * normalX + normalY * normalY + normalZ * normalZ );
+                if( length <= HELIUM_EPSILON )
+                {
+                    // Collinear corners.
+                    continue;
+                }
+
+                float32_t invLength = 1.0f / length;
+                normalX *= invLength;
+                normalY *= invLength;
+                normalZ *= invLength;
+                float32_t distance = -( normalX * cornersX[ i0 ] + normalY * cornersY[ i0 ] + normalZ * cornersZ[ i0 ] );
+
+                // Point the normal into the frustum.
+                if( normalX * centroidX + normalY * centroidY + normalZ * centroidZ + distance < 0.0f )
+                {
+                    normalX = -normalX;
+                    normalY = -normalY;
+                    normalZ = -normalZ;
+                    distance = -distance;
+                }
+
+                bool bSupporting = true;
+                for( size_t cornerIndex = 0; cornerIndex < 8; ++cornerIndex )
+                {
+                    if( normalX * cornersX[ cornerIndex ] + normalY * cornersY[ cornerIndex ] +
+                        normalZ * cornersZ[ cornerIndex ] + distance < -epsilon )
+                    {
+                        bSupporting = false;
+                        break;
+                    }
+                }
+
+                if( !bSupporting )
+                {
+                    continue;
+                }
+
+                // Each face is found once for every triple of its corners, so skip planes we already have.
+                bool bDuplicate = false;
+                for( size_t planeIndex = 0; planeIndex < m_planeCount; ++planeIndex )
+                {
+                    if( normalX * m_planeA[ planeIndex ] + normalY * m_planeB[ planeIndex ] +
+                        normalZ * m_planeC[ planeIndex ] > 1.0f - 1.0e-4f &&
+                        fabsf( distance - m_planeD[ planeIndex ] ) <= epsilon )
+                    {
+                        bDuplicate = true;
+                        break;
+                    }
+                }
+
+                if( bDuplicate )
+                {
+                    continue;
+                }
+
+                if( m_planeCount >= PLANE_COUNT_MAX )
+                {
+                    m_planeCount = 0;
+
+                    return false;
+                }
+
+                m_planeA[ m_planeCount ] = normalX;
+                m_planeB[ m_planeCount ] = normalY;
+                m_planeC[ m_planeCount ] = normalZ;
+                m_planeD[ m_planeCount ] = distance;
+                ++m_planeCount;
+            }
+        }
+    }
+
+    return ( m_planeCount != 0 );
+}
+
+/// Test an axis-aligned box against the frustum.
+///
+/// @param[in] pMinimum  Minimum box corner (x, y, z).
+/// @param[in] pMaximum  Maximum box corner (x, y, z).
+///
+/// @return  Whether the box is outside, partially inside, or fully inside the frustum.
+CullingFrustum::EContainment CullingFrustum::TestBox( const float32_t* pMinimum, const float32_t* pMaximum ) const
+{
+    EContainment containment = CONTAINMENT_INSIDE;
+
+    for( size_t planeIndex = 0; planeIndex < m_planeCount; ++planeIndex )
+    {
+        float32_t a = m_planeA[ planeIndex ];
+        float32_t b = m_planeB[ planeIndex ];
+        float32_t c = m_planeC[ planeIndex ];
+        float32_t d = m_planeD[ planeIndex ];
+
+        // Corner furthest along the plane normal, and the one furthest against it.
+        float32_t farDistance =
+            a * ( a >= 0.0f ? pMaximum[ 0 ] : pMinimum[ 0 ] ) +
+            b * ( b >= 0.0f ? pMaximum[ 1 ] : pMinimum[ 1 ] ) +
+            c * ( c >= 0.0f ? pMaximum[ 2 ] : pMinimum[ 2 ] ) + d;
+        if( farDistance < 0.0f )
+        {
+            return CONTAINMENT_OUTSIDE;
+        }
+
+        float32_t nearDistance =
+            a * ( a >= 0.0f ? pMinimum[ 0 ] : pMaximum[ 0 ] ) +
+            b * ( b >= 0.0f ? pMinimum[ 1 ] : pMaximum[ 1 ] ) +
+            c * ( c >= 0.0f ? pMinimum[ 2 ] : pMaximum[ 2 ] ) + d;
+        if( nearDistance < 0.0f )
+        {
+            containment = CONTAINMENT_INTERSECTS;
+        }
+    }
+
+    return containment;
+}
+
+/// Append the IDs of all spheres intersecting the frustum to a list.
+///
+/// Spheres with a negative radius are treated as empty entries and skipped.  Spheres are tested four at a time, with
+/// any remainder tested individually.
+///
+/// @param[in]  pCenterX     Sphere center x components.
+/// @param[in]  pCenterY     Sphere center y components.
+/// @param[in]  pCenterZ     Sphere center z components.
+/// @param[in]  pRadius      Sphere radii.
+/// @param[in]  pIds         ID to report for each sphere.
+/// @param[in]  count        Number of spheres.
+/// @param[out] rVisibleIds  List to which the IDs of visible spheres are appended.
+///
+/// @return  Number of IDs appended.
+size_t CullingFrustum::CullSpheres(
+    const float32_t* pCenterX,
+    const float32_t* pCenterY,
+    const float32_t* pCenterZ,
+    const float32_t* pRadius,
+    const uint32_t* pIds,
+    size_t count,
+    DynamicArray< uint32_t >& rVisibleIds ) const
+{
+    size_t startSize = rVisibleIds.GetSize();
+    size_t index = 0;
+
+#if HELIUM_SIMD_SSE
+    const Simd::Register zeroVec = _mm_setzero_ps();
+
+    for( ; index + 4 <= count; index += 4 )
+    {
+        Simd::Register centerX = _mm_loadu_ps( pCenterX + index );
+        Simd::Register centerY = _mm_loadu_ps( pCenterY + index );
+        Simd::Register centerZ = _mm_loadu_ps( pCenterZ + index );
+        Simd::Register radius = _mm_loadu_ps( pRadius + index );
+        Simd::Register negativeRadius = _mm_sub_ps( zeroVec, radius );
+
+        // Empty entries have a negative radius.
+        Simd::Register visibleMask = _mm_cmpge_ps( radius, zeroVec );
+
+        for( size_t planeIndex = 0; planeIndex < m_planeCount; ++planeIndex )
+        {
+            Simd::Register distance = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps( centerX, _mm_set1_ps( m_planeA[ planeIndex ] ) ),
+                    _mm_mul_ps( centerY, _mm_set1_ps( m_planeB[ planeIndex ] ) ) ),
+                _mm_add_ps(
+                    _mm_mul_ps( centerZ, _mm_set1_ps( m_planeC[ planeIndex ] ) ),
+                    _mm_set1_ps( m_planeD[ planeIndex ] ) ) );
+            visibleMask = _mm_and_ps( visibleMask, _mm_cmpge_ps( distance, negativeRadius ) );
+        }
+
+        int visibleBits = _mm_movemask_ps( visibleMask );
+        while( visibleBits )
+        {
+            int laneIndex = ( visibleBits & 1 ) ? 0 : ( visibleBits & 2 ) ? 1 : ( visibleBits & 4 ) ? 2 : 3;
+            rVisibleIds.Push( pIds[ index + laneIndex ] );
+            visibleBits &= ~( 1 << laneIndex );
+        }
+    }
+#endif
+
+    for( ; index < count; ++index )
+    {
+        float32_t radius = pRadius[ index ];
+        if( radius < 0.0f )
+        {
+            continue;
+        }
+
+        bool bVisible = true;
+        for( size_t planeIndex = 0; planeIndex < m_planeCount; ++planeIndex )
+        {
+            float32_t distance =
+                pCenterX[ index ] * m_planeA[ planeIndex ] +
+                pCenterY[ index ] * m_planeB[ planeIndex ] +
+                pCenterZ[ index ] * m_planeC[ planeIndex ] +
+                m_planeD[ planeIndex ];
+            if( distance < -radius )
+            {
+                bVisible = false;
+                break;
+            }
+        }
+
+        if( bVisible )
+        {
+            rVisibleIds.Push( pIds[ index ] );
+        }
+    }
+
+    return rVisibleIds.GetSize() - startSize;
+}
+
+/// Constructor.
+SceneObjectBvh::SceneObjectBvh()
+    : m_treeObjectCount( 0 )
+    , m_removedObjectCount( 0 )
+{
+}
+
+/// Destructor.
+SceneObjectBvh::~SceneObjectBvh()
+{
+}
+
+/// Set the bounding sphere of an object, adding the object to the hierarchy if necessary.
+///
+/// @param[in] id       Object ID.
+/// @param[in] centerX  Bounding sphere center x coordinate.
+/// @param[in] centerY  Bounding sphere center y coordinate.
+/// @param[in] centerZ  Bounding sphere center z coordinate.
+/// @param[in] radius   Bounding sphere radius.
+///
+/// @see RemoveObject(), Update()
+void SceneObjectBvh::SetObjectBounds( size_t id, float32_t centerX, float32_t centerY, float32_t centerZ, float32_t radius )
+{
+    HELIUM_ASSERT( IsValid( id ) );
+    HELIUM_ASSERT( radius >= 0.0f );
+
+    if( id >= m_objectSlots.GetSize() )
+    {
+        size_t oldObjectCount = m_objectSlots.GetSize();
+        m_objectSlots.Resize( id + 1 );
+        m_objectPendingIndices.Resize( id + 1 );
+        m_objectBounds.Resize( ( id + 1 ) * OBJECT_BOUNDS_STRIDE );
+        for( size_t objectIndex = oldObjectCount; objectIndex <= id; ++objectIndex )
+        {
+            SetInvalid( m_objectSlots[ objectIndex ] );
+            SetInvalid( m_objectPendingIndices[ objectIndex ] );
+        }
+    }
+
+    float32_t* pBounds = &m_objectBounds[ id * OBJECT_BOUNDS_STRIDE ];
+    pBounds[ 0 ] = centerX;
+    pBounds[ 1 ] = centerY;
+    pBounds[ 2 ] = centerZ;
+    pBounds[ 3 ] = radius;
+
+    uint32_t slot = m_objectSlots[ id ];
+    if( IsValid( slot ) )
+    {
+        m_slotCenterX[ slot ] = centerX;
+        m_slotCenterY[ slot ] = centerY;
+        m_slotCenterZ[ slot ] = centerZ;
+        m_slotRadius[ slot ] = radius;
+        MarkLeafDirty( m_slotNodes[ slot ] );
+
+        return;
+    }
+
+    uint32_t pendingIndex = m_objectPendingIndices[ id ];
+    if( IsInvalid( pendingIndex ) )
+    {
+        pendingIndex = static_cast< uint32_t >( m_pendingIds.GetSize() );
+        m_objectPendingIndices[ id ] = pendingIndex;
+        m_pendingIds.Push( static_cast< uint32_t >( id ) );
+        m_pendingCenterX.Push( centerX );
+        m_pendingCenterY.Push( centerY );
+        m_pendingCenterZ.Push( centerZ );
+        m_pendingRadius.Push( radius );
+
+        return;
+    }
+
+    m_pendingCenterX[ pendingIndex ] = centerX;
+    m_pendingCenterY[ pendingIndex ] = centerY;
+    m_pendingCenterZ[ pendingIndex ] = centerZ;
+    m_pendingRadius[ pendingIndex ] = radius;
+}
+
+/// Remove an object from the hierarchy.
+///
+/// @param[in] id  Object ID.  Objects that were never given bounds are ignored.
+///
+/// @see SetObjectBounds()
+void SceneObjectBvh::RemoveObject( size_t id )
+{
+    if( id >= m_objectSlots.GetSize() )
+    {
+        return;
+    }
+
+    uint32_t slot = m_objectSlots[ id ];
+    if( IsValid( slot ) )
+    {
+        // Leave the slot empty until the next rebuild.  The leaf bounds are left as they are, as they are still
+        // conservative.
+        m_slotRadius[ slot ] = -1.0f;
+        SetInvalid( m_slotIds[ slot ] );
+        SetInvalid( m_objectSlots[ id ] );
+
+        HELIUM_ASSERT( m_treeObjectCount != 0 );
+        --m_treeObjectCount;
+        ++m_removedObjectCount;
+    }
+    else
+    {
+        RemovePending( id );
+    }
+
+    m_objectBounds[ id * OBJECT_BOUNDS_STRIDE + 3 ] = -1.0f;
+}
+
+/// Apply pending changes, refitting the bounds of modified leaves or rebuilding the tree if it has drifted too far
+/// from the current set of objects.
+void SceneObjectBvh::Update()
+{
+    size_t pendingCount = m_pendingIds.GetSize();
+    size_t rebuildThreshold = Max< size_t >( m_treeObjectCount / 4, LEAF_OBJECT_COUNT_MAX * 4 );
+    if( pendingCount > rebuildThreshold || m_removedObjectCount > rebuildThreshold )
+    {
+        Build();
+
+        return;
+    }
+
+    size_t dirtyLeafCount = m_dirtyLeaves.GetSize();
+    for( size_t dirtyIndex = 0; dirtyIndex < dirtyLeafCount; ++dirtyIndex )
+    {
+        RefitLeaf( m_dirtyLeaves[ dirtyIndex ] );
+    }
+
+    for( size_t dirtyIndex = 0; dirtyIndex < dirtyLeafCount; ++dirtyIndex )
+    {
+        uint32_t nodeIndex = m_dirtyLeaves[ dirtyIndex ];
+        m_nodeDirtyFlags[ nodeIndex ] = false;
+        RefitParents( nodeIndex );
+    }
+
+    m_dirtyLeaves.Resize( 0 );
+}
+
+/// Append the IDs of all objects whose bounds intersect a frustum to a list.
+///
+/// Large trees are culled by spawning a job for each subtree at a fixed depth.  Results are always appended in tree
+/// order, followed by objects not yet inserted into the tree.
+///
+/// @param[in]  rFrustum     Frustum against which to cull.
+/// @param[out] rVisibleIds  List to which the IDs of visible objects are appended.
+void SceneObjectBvh::Cull( const CullingFrustum& rFrustum, DynamicArray< uint32_t >& rVisibleIds ) const
+{
+    JobManager& rJobManager = JobManager::GetStaticInstance();
+
+    if( !m_nodes.IsEmpty() )
+    {
+        if( m_treeObjectCount < PARALLEL_CULL_OBJECT_COUNT_MIN || !rJobManager.IsInitialized() )
+        {
+            CullSubtree( 0, rFrustum, rVisibleIds );
+        }
+        else
+        {
+            // Walk down to the subtree depth serially, skipping anything already outside the frustum.
+            DynamicArray< uint32_t > subtreeNodes;
+            DynamicArray< uint32_t > levelNodes;
+            levelNodes.Push( 0 );
+
+            for( size_t depth = 0; depth < PARALLEL_CULL_SUBTREE_DEPTH && !levelNodes.IsEmpty(); ++depth )
+            {
+                DynamicArray< uint32_t > nextLevelNodes;
+                size_t levelNodeCount = levelNodes.GetSize();
+                for( size_t levelIndex = 0; levelIndex < levelNodeCount; ++levelIndex )
+                {
+                    const Node& rNode = m_nodes[ levelNodes[ levelIndex ] ];
+                    CullingFrustum::EContainment containment = rFrustum.TestBox( rNode.minimum, rNode.maximum );
+                    if( containment == CullingFrustum::CONTAINMENT_OUTSIDE )
+                    {
+                        continue;
+                    }
+
+                    if( containment == CullingFrustum::CONTAINMENT_INSIDE || IsInvalid( rNode.firstChild ) )
+                    {
+                        subtreeNodes.Push( levelNodes[ levelIndex ] );
+                        continue;
+                    }
+
+                    nextLevelNodes.Push( rNode.firstChild );
+                    nextLevelNodes.Push( rNode.firstChild + 1 );
+                }
+
+                levelNodes = nextLevelNodes;
+            }
+
+            size_t levelNodeCount = levelNodes.GetSize();
+            for( size_t levelIndex = 0; levelIndex < levelNodeCount; ++levelIndex )
+            {
+                subtreeNodes.Push( levelNodes[ levelIndex ] );
+            }
+
+            // Hand out a few subtrees per job.
+            size_t subtreeCount = subtreeNodes.GetSize();
+            size_t jobCount = Min< size_t >( subtreeCount, rJobManager.GetWorkerThreadCount() * 2 + 1 );
+            if( jobCount != 0 )
+            {
+                DynamicArray< CullJob > jobs;
+                jobs.Resize( jobCount );
+
+                size_t subtreeIndex = 0;
+                for( size_t jobIndex = 0; jobIndex < jobCount; ++jobIndex )
+                {
+                    size_t jobSubtreeCount = ( subtreeCount - subtreeIndex ) / ( jobCount - jobIndex );
+
+                    CullJob& rJob = jobs[ jobIndex ];
+                    rJob.pBvh = this;
+                    rJob.pFrustum = &rFrustum;
+                    rJob.pNodes = subtreeNodes.GetData() + subtreeIndex;
+                    rJob.nodeCount = jobSubtreeCount;
+
+                    subtreeIndex += jobSubtreeCount;
+                }
+
+                JobCounter counter;
+                for( size_t jobIndex = 1; jobIndex < jobCount; ++jobIndex )
+                {
+                    rJobManager.Spawn( jobs[ jobIndex ], &counter );
+                }
+
+                jobs[ 0 ].Run();
+                rJobManager.WaitForCounter( counter );
+
+                for( size_t jobIndex = 0; jobIndex < jobCount; ++jobIndex )
+                {
+                    const DynamicArray< uint32_t >& rJobVisibleIds = jobs[ jobIndex ].visibleIds;
+                    size_t jobVisibleCount = rJobVisibleIds.GetSize();
+                    for( size_t visibleIndex = 0; visibleIndex < jobVisibleCount; ++visibleIndex )
+                    {
+                        rVisibleIds.Push( rJobVisibleIds[ visibleIndex ] );
+                    }
+                }
+            }
+        }
+    }
+
+    rFrustum.CullSpheres(
+        m_pendingCenterX.GetData(),
+        m_pendingCenterY.GetData(),
+        m_pendingCenterZ.GetData(),
+        m_pendingRadius.GetData(),
+        m_pendingIds.GetData(),
+        m_pendingIds.GetSize(),
+        rVisibleIds );
+}
+
+/// Rebuild the tree from all objects currently in the hierarchy.
+void SceneObjectBvh::Build()
+{
+    DynamicArray< uint32_t > ids;
+    ids.Reserve( m_treeObjectCount + m_pendingIds.GetSize() );
+
+    size_t objectCount = m_objectSlots.GetSize();
+    for( size_t id = 0; id < objectCount; ++id )
+    {
+        if( m_objectBounds[ id * OBJECT_BOUNDS_STRIDE + 3 ] >= 0.0f )
+        {
+            ids.Push( static_cast< uint32_t >( id ) );
+        }
+
+        SetInvalid( m_objectSlots[ id ] );
+        SetInvalid( m_objectPendingIndices[ id ] );
+    }
+
+    m_nodes.Resize( 0 );
+    m_slotNodes.Resize( 0 );
+    m_slotCenterX.Resize( 0 );
+    m_slotCenterY.Resize( 0 );
+    m_slotCenterZ.Resize( 0 );
+    m_slotRadius.Resize( 0 );
+    m_slotIds.Resize( 0 );
+    m_dirtyLeaves.Resize( 0 );
+
+    m_pendingIds.Resize( 0 );
+    m_pendingCenterX.Resize( 0 );
+    m_pendingCenterY.Resize( 0 );
+    m_pendingCenterZ.Resize( 0 );
+    m_pendingRadius.Resize( 0 );
+
+    m_treeObjectCount = ids.GetSize();
+    m_removedObjectCount = 0;
+
+    if( !ids.IsEmpty() )
+    {
+        m_nodes.Reserve( ( ids.GetSize() / ( LEAF_OBJECT_COUNT_MAX / 2 ) + 1 ) * 2 );
+        m_nodes.Resize( 1 );
+        SetInvalid( m_nodes[ 0 ].parent );
+        BuildNode( 0, ids.GetData(), ids.GetSize() );
+    }
+
+    m_nodeDirtyFlags.Resize( m_nodes.GetSize() );
+    for( size_t nodeIndex = 0; nodeIndex < m_nodes.GetSize(); ++nodeIndex )
+    {
+        m_nodeDirtyFlags[ nodeIndex ] = false;
+    }
+}
+
+/// Build a subtree for a range of objects.
+///
+/// @param[in] nodeIndex  Index of the (already allocated) subtree root node.
+/// @param[in] pIds       IDs of the objects in the subtree (reordered during the build).
+/// @param[in] idCount    Number of objects in the subtree.
+void SceneObjectBvh::BuildNode( uint32_t nodeIndex, uint32_t* pIds, size_t idCount )
+{
+    HELIUM_ASSERT( idCount != 0 );
+
+    if( idCount <= LEAF_OBJECT_COUNT_MAX )
+    {
+        // Leaves are padded with empty slots so they can be tested four spheres at a time.
+        uint32_t firstSlot = static_cast< uint32_t >( m_slotIds.GetSize() );
+        size_t paddedCount = ( idCount + 3 ) & ~static_cast< size_t >( 3 );
+        for( size_t slotIndex = 0; slotIndex < paddedCount; ++slotIndex )
+        {
+            m_slotNodes.Push( nodeIndex );
+
+            if( slotIndex < idCount )
+            {
+                uint32_t id = pIds[ slotIndex ];
+                const float32_t* pBounds = &m_objectBounds[ id * OBJECT_BOUNDS_STRIDE ];
+                m_slotCenterX.Push( pBounds[ 0 ] );
+                m_slotCenterY.Push( pBounds[ 1 ] );
+                m_slotCenterZ.Push( pBounds[ 2 ] );
+                m_slotRadius.Push( pBounds[ 3 ] );
+                m_slotIds.Push( id );
+                m_objectSlots[ id ] = firstSlot + static_cast< uint32_t >( slotIndex );
+            }
+            else
+            {
+                m_slotCenterX.Push( 0.0f );
+                m_slotCenterY.Push( 0.0f );
+                m_slotCenterZ.Push( 0.0f );
+                m_slotRadius.Push( -1.0f );
+                m_slotIds.Push( Invalid< uint32_t >() );
+            }
+        }
+
+        Node& rNode = m_nodes[ nodeIndex ];
+        SetInvalid( rNode.firstChild );
+        rNode.firstSlot = firstSlot;
+        rNode.slotCount = static_cast< uint32_t >( paddedCount );
+        RefitLeaf( nodeIndex );
+
+        return;
+    }
+
+    // Split at the median along the axis with the largest spread of sphere centers.
+    float32_t centerMinimum[ 3 ];
+    float32_t centerMaximum[ 3 ];
+    for( size_t axis = 0; axis < 3; ++axis )
+    {
+        centerMinimum[ axis ] = m_objectBounds[ pIds[ 0 ] * OBJECT_BOUNDS_STRIDE + axis ];
+        centerMaximum[ axis ] = centerMinimum[ axis ];
+    }
+
+    for( size_t idIndex = 1; idIndex < idCount; ++idIndex )
+    {
+        const float32_t* pBounds = &m_objectBounds[ pIds[ idIndex ] * OBJECT_BOUNDS_STRIDE ];
+        for( size_t axis = 0; axis < 3; ++axis )
+        {
+            centerMinimum[ axis ] = Min( centerMinimum[ axis ], pBounds[ axis ] );
+            centerMaximum[ axis ] = Max( centerMaximum[ axis ], pBounds[ axis ] );
+        }
+    }
+
+    size_t splitAxis = 0;
+    for( size_t axis = 1; axis < 3; ++axis )
+    {
+        if( centerMaximum[ axis ] - centerMinimum[ axis ] > centerMaximum[ splitAxis ] - centerMinimum[ splitAxis ] )
+        {
+            splitAxis = axis;
+        }
+    }
+
+    size_t splitCount = idCount / 2;
+    std::nth_element(
+        pIds, pIds + splitCount, pIds + idCount, CenterAxisCompare( m_objectBounds.GetData(), splitAxis ) );
+
+    // Children are allocated next to each other so only the first child index needs to be stored.  Note that
+    // allocating nodes may move the node array, so nodes are always accessed by index here.
+    uint32_t firstChild = static_cast< uint32_t >( m_nodes.GetSize() );
+    m_nodes.Resize( firstChild + 2 );
+    m_nodes[ firstChild ].parent = nodeIndex;
+    m_nodes[ firstChild + 1 ].parent = nodeIndex;
+
+    BuildNode( firstChild, pIds, splitCount );
+    BuildNode( firstChild + 1, pIds + splitCount, idCount - splitCount );
+
+    // Children are built depth-first, so their slots form one contiguous range.
+    Node& rNode = m_nodes[ nodeIndex ];
+    const Node& rChild0 = m_nodes[ firstChild ];
+    const Node& rChild1 = m_nodes[ firstChild + 1 ];
+    rNode.firstChild = firstChild;
+    rNode.firstSlot = rChild0.firstSlot;
+    rNode.slotCount = rChild1.firstSlot + rChild1.slotCount - rChild0.firstSlot;
+    for( size_t axis = 0; axis < 3; ++axis )
+    {
+        rNode.minimum[ axis ] = Min( rChild0.minimum[ axis ], rChild1.minimum[ axis ] );
+        rNode.maximum[ axis ] = Max( rChild0.maximum[ axis ], rChild1.maximum[ axis ] );
+    }
+}
+
+/// Recompute the bounds of a leaf from the spheres in its slots.
+///
+/// @param[in] nodeIndex  Leaf node index.
+void SceneObjectBvh::RefitLeaf( uint32_t nodeIndex )
+{
+    Node& rNode = m_nodes[ nodeIndex ];
+    HELIUM_ASSERT( IsInvalid( rNode.firstChild ) );
+
+    for( size_t axis = 0; axis < 3; ++axis )
+    {
+        rNode.minimum[ axis ] = NumericLimits< float32_t >::Maximum;
+        rNode.maximum[ axis ] = -NumericLimits< float32_t >::Maximum;
+    }
+
+    uint32_t slotEnd = rNode.firstSlot + rNode.slotCount;
+    for( uint32_t slot = rNode.firstSlot; slot < slotEnd; ++slot )
+    {
+        float32_t radius = m_slotRadius[ slot ];
+        if( radius < 0.0f )
+        {
+            continue;
+        }
+
+        rNode.minimum[ 0 ] = Min( rNode.minimum[ 0 ], m_slotCenterX[ slot ] - radius );
+        rNode.minimum[ 1 ] = Min( rNode.minimum[ 1 ], m_slotCenterY[ slot ] - radius );
+        rNode.minimum[ 2 ] = Min( rNode.minimum[ 2 ], m_slotCenterZ[ slot ] - radius );
+        rNode.maximum[ 0 ] = Max( rNode.maximum[ 0 ], m_slotCenterX[ slot ] + radius );
+        rNode.maximum[ 1 ] = Max( rNode.maximum[ 1 ], m_slotCenterY[ slot ] + radius );
+        rNode.maximum[ 2 ] = Max( rNode.maximum[ 2 ], m_slotCenterZ[ slot ] + radius );
+    }
+}
+
+/// Recompute the bounds of each ancestor of a node, stopping once an ancestor's bounds no longer change.
+///
+/// @param[in] nodeIndex  Index of the node whose bounds changed.
+void SceneObjectBvh::RefitParents( uint32_t nodeIndex )
+{
+    uint32_t parentIndex = m_nodes[ nodeIndex ].parent;
+    while( IsValid( parentIndex ) )
+    {
+        Node& rParent = m_nodes[ parentIndex ];
+        const Node& rChild0 = m_nodes[ rParent.firstChild ];
+        const Node& rChild1 = m_nodes[ rParent.firstChild + 1 ];
+
+        bool bChanged = false;
+        for( size_t axis = 0; axis < 3; ++axis )
+        {
+            float32_t minimum = Min( rChild0.minimum[ axis ], rChild1.minimum[ axis ] );
+            float32_t maximum = Max( rChild0.maximum[ axis ], rChild1.maximum[ axis ] );
+            bChanged |= ( minimum != rParent.minimum[ axis ] || maximum != rParent.maximum[ axis ] );
+            rParent.minimum[ axis ] = minimum;
+            rParent.maximum[ axis ] = maximum;
+        }
+
+        if( !bChanged )
+        {
+            break;
+        }
+
+        parentIndex = rParent.parent;
+    }
+}
+
+/// Queue a leaf for refitting during the next Update().
+///
+/// @param[in] nodeIndex  Leaf node index.
+void SceneObjectBvh::MarkLeafDirty( uint32_t nodeIndex )
+{
+    if( !m_nodeDirtyFlags[ nodeIndex ] )
+    {
+        m_nodeDirtyFlags[ nodeIndex ] = true;
+        m_dirtyLeaves.Push( nodeIndex );
+    }
+}
+
+/// Remove an object from the list of objects not yet in the tree.
+///
+/// @param[in] id  Object ID.
+void SceneObjectBvh::RemovePending( size_t id )
+{
+    uint32_t pendingIndex = m_objectPendingIndices[ id ];
+    if( IsInvalid( pendingIndex ) )
+    {
+        return;
+    }
+
+    SetInvalid( m_objectPendingIndices[ id ] );
+
+    size_t lastIndex = m_pendingIds.GetSize() - 1;
+    if( pendingIndex != lastIndex )
+    {
+        uint32_t movedId = m_pendingIds[ lastIndex ];
+        m_pendingIds[ pendingIndex ] = movedId;
+        m_pendingCenterX[ pendingIndex ] = m_pendingCenterX[ lastIndex ];
+        m_pendingCenterY[ pendingIndex ] = m_pendingCenterY[ lastIndex ];
+        m_pendingCenterZ[ pendingIndex ] = m_pendingCenterZ[ lastIndex ];
+        m_pendingRadius[ pendingIndex ] = m_pendingRadius[ lastIndex ];
+        m_objectPendingIndices[ movedId ] = pendingIndex;
+    }
+
+    m_pendingIds.Pop();
+    m_pendingCenterX.Pop();
+    m_pendingCenterY.Pop();
+    m_pendingCenterZ.Pop();
+    m_pendingRadius.Pop();
+}
+
+/// Cull a subtree against a frustum.
+///
+/// @param[in]  nodeIndex    Subtree root node index.
+/// @param[in]  rFrustum     Frustum against which to cull.
+/// @param[out] rVisibleIds  List to which the IDs of visible objects are appended.
+void SceneObjectBvh::CullSubtree( uint32_t nodeIndex, const CullingFrustum& rFrustum, DynamicArray< uint32_t >& rVisibleIds ) const
+{
+    uint32_t nodeStack[ 64 ];
+    size_t stackSize = 0;
+    nodeStack[ stackSize++ ] = nodeIndex;
+
+    while( stackSize != 0 )
+    {
+        const Node& rNode = m_nodes[ nodeStack[ --stackSize ] ];
+        if( rNode.slotCount == 0 )
+        {
+            continue;
+        }
+
+        CullingFrustum::EContainment containment = rFrustum.TestBox( rNode.minimum, rNode.maximum );
+        if( containment == CullingFrustum::CONTAINMENT_OUTSIDE )
+        {
+            continue;
+        }
+
+        if( containment == CullingFrustum::CONTAINMENT_INSIDE )
+        {
+            AddAllInRange( rNode.firstSlot, rNode.slotCount, rVisibleIds );
+            continue;
+        }
+
+        if( IsInvalid( rNode.firstChild ) )
+        {
+            rFrustum.CullSpheres(
+                m_slotCenterX.GetData() + rNode.firstSlot,
+                m_slotCenterY.GetData() + rNode.firstSlot,
+                m_slotCenterZ.GetData() + rNode.firstSlot,
+                m_slotRadius.GetData() + rNode.firstSlot,
+                m_slotIds.GetData() + rNode.firstSlot,
+                rNode.slotCount,
+                rVisibleIds );
+            continue;
+        }
+
+        // Push the second child first so the first child's objects come out first.
+        HELIUM_ASSERT( stackSize + 2 <= HELIUM_ARRAY_COUNT( nodeStack ) );
+        nodeStack[ stackSize++ ] = rNode.firstChild + 1;
+        nodeStack[ stackSize++ ] = rNode.firstChild;
+    }
+}
+
+/// Append the IDs of all objects in a range of slots.
+///
+/// @param[in]  firstSlot    First slot.
+/// @param[in]  slotCount    Number of slots.
+/// @param[out] rVisibleIds  List to which the object IDs are appended.
+void SceneObjectBvh::AddAllInRange( uint32_t firstSlot, uint32_t slotCount, DynamicArray< uint32_t >& rVisibleIds ) const
+{
+    uint32_t slotEnd = firstSlot + slotCount;
+    for( uint32_t slot = firstSlot; slot < slotEnd; ++slot )
+    {
+        if( m_slotRadius[ slot ] >= 0.0f )
+        {
+            rVisibleIds.Push( m_slotIds[ slot ] );
+        }
+    }
+}
+
+/// Cull each of the job's subtrees.
+void SceneObjectBvh::CullJob::Run()
+{
+    HELIUM_ASSERT( pBvh );
+    HELIUM_ASSERT( pFrustum );
+
+    for( size_t nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex )
+    {
+        pBvh->CullSubtree( pNodes[ nodeIndex ], *pFrustum, visibleIds );
+    }
+}
+
+/// Callback executed to run the job.
+///
+/// @param[in] pJob  Job to run.
+void SceneObjectBvh::CullJob::RunCallback( void* pJob )
+{
+    HELIUM_ASSERT( pJob );
+    static_cast< CullJob* >( pJob )->Run();
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "Graphics/Graphics.h"
+
+#include "Foundation/DynamicArray.h"
+#include "MathSimd/Frustum.h"
+
+namespace Helium
+{
+    /// View frustum planes laid out for testing several bounding spheres at once.
+    class HELIUM_GRAPHICS_API CullingFrustum
+    {
+    public:
+        /// Maximum number of planes (a closed frustum has six).
+        static const size_t PLANE_COUNT_MAX = 8;
+
+        /// Result of testing a box against the frustum.
+        enum EContainment
+        {
+            CONTAINMENT_OUTSIDE,
+            CONTAINMENT_INTERSECTS,
+            CONTAINMENT_INSIDE
+        };
+
+        /// @name Construction/Destruction
+        //@{
+        CullingFrustum();
+        //@}
+
+        /// @name Initialization
+        //@{
+        bool Set( const Simd::Frustum& rFrustum );
+        //@}
+
+        /// @name Testing
+        //@{
+        EContainment TestBox( const float32_t* pMinimum, const float32_t* pMaximum ) const;
+
+        size_t CullSpheres(
+            const float32_t* pCenterX, const float32_t* pCenterY, const float32_t* pCenterZ, const float32_t* pRadius,
+            const uint32_t* pIds, size_t count, DynamicArray< uint32_t >& rVisibleIds ) const;
+        //@}
+
+        /// @name Data Access
+        //@{
+        inline size_t GetPlaneCount() const;
+        //@}
+
+    private:
+        /// Plane normal x components (normals point into the frustum).
+        float32_t m_planeA[ PLANE_COUNT_MAX ];
+        /// Plane normal y components.
+        float32_t m_planeB[ PLANE_COUNT_MAX ];
+        /// Plane normal z components.
+        float32_t m_planeC[ PLANE_COUNT_MAX ];
+        /// Plane distances.
+        float32_t m_planeD[ PLANE_COUNT_MAX ];
+        /// Number of planes set.
+        size_t m_planeCount;
+    };
+
+    /// Bounding volume hierarchy over graphics scene object bounding spheres.
+    ///
+    /// Objects are grouped into leaves of up to LEAF_OBJECT_COUNT_MAX spheres stored as structure-of-arrays, so leaves
+    /// that straddle a frustum plane can be tested four spheres at a time. Bounds changes refit the affected leaves and
+    /// their ancestors, and newly added objects are kept in a separate list until enough have accumulated (or enough
+    /// have been removed) to make rebuilding the tree worthwhile.
+    class HELIUM_GRAPHICS_API SceneObjectBvh : NonCopyable
+    {
+    public:
+        /// Maximum number of objects in a leaf (must be a multiple of four).
+        static const size_t LEAF_OBJECT_COUNT_MAX = 16;
+        /// Minimum number of objects in the tree before culling is split into jobs.
+        static const size_t PARALLEL_CULL_OBJECT_COUNT_MIN = 4096;
+
+        /// @name Construction/Destruction
+        //@{
+        SceneObjectBvh();
+        ~SceneObjectBvh();
+        //@}
+
+        /// @name Object Management
+        //@{
+        void SetObjectBounds( size_t id, float32_t centerX, float32_t centerY, float32_t centerZ, float32_t radius );
+        void RemoveObject( size_t id );
+        void Update();
+        //@}
+
+        /// @name Culling
+        //@{
+        void Cull( const CullingFrustum& rFrustum, DynamicArray< uint32_t >& rVisibleIds ) const;
+        //@}
+
+        /// @name Data Access
+        //@{
+        inline size_t GetObjectCount() const;
+        //@}
+
+    private:
+        /// Tree node.  Each node covers a contiguous range of slots; interior nodes have two consecutive children.
+        struct Node
+        {
+            /// Minimum corner of the node bounds.
+            float32_t minimum[ 3 ];
+            /// Maximum corner of the node bounds.
+            float32_t maximum[ 3 ];
+            /// Parent node index (invalid for the root).
+            uint32_t parent;
+            /// Index of the first child node (invalid for leaves).
+            uint32_t firstChild;
+            /// First slot covered by this node.
+            uint32_t firstSlot;
+            /// Number of slots covered by this node.
+            uint32_t slotCount;
+        };
+
+        /// Job culling a list of subtrees.
+        class CullJob
+        {
+        public:
+            const SceneObjectBvh* pBvh;
+            const CullingFrustum* pFrustum;
+            const uint32_t* pNodes;
+            size_t nodeCount;
+            DynamicArray< uint32_t > visibleIds;
+
+            void Run();
+            static void RunCallback( void* pJob );
+        };
+
+        /// Master copy of the bounds of each object, indexed by object ID (negative radius if not in the BVH).
+        DynamicArray< float32_t > m_objectBounds;
+        /// Slot holding each object, indexed by object ID.
+        DynamicArray< uint32_t > m_objectSlots;
+        /// Index of each object in the pending list, indexed by object ID.
+        DynamicArray< uint32_t > m_objectPendingIndices;
+
+        /// Tree nodes (the root is node 0).
+        DynamicArray< Node > m_nodes;
+        /// Leaf node owning each slot.
+        DynamicArray< uint32_t > m_slotNodes;
+        /// Sphere center x components for each slot.
+        DynamicArray< float32_t > m_slotCenterX;
+        /// Sphere center y components for each slot.
+        DynamicArray< float32_t > m_slotCenterY;
+        /// Sphere center z components for each slot.
+        DynamicArray< float32_t > m_slotCenterZ;
+        /// Sphere radius for each slot (negative if the slot is empty).
+        DynamicArray< float32_t > m_slotRadius;
+        /// Object ID for each slot.
+        DynamicArray< uint32_t > m_slotIds;
+
+        /// Leaves whose bounds need to be refit.
+        DynamicArray< uint32_t > m_dirtyLeaves;
+        /// Whether each node is in the dirty leaf list.
+        DynamicArray< bool > m_nodeDirtyFlags;
+
+        /// Objects not yet in the tree.
+        DynamicArray< uint32_t > m_pendingIds;
+        /// Sphere center x components for each pending object.
+        DynamicArray< float32_t > m_pendingCenterX;
+        /// Sphere center y components for each pending object.
+        DynamicArray< float32_t > m_pendingCenterY;
+        /// Sphere center z components for each pending object.
+        DynamicArray< float32_t > m_pendingCenterZ;
+        /// Sphere radius for each pending object.
+        DynamicArray< float32_t > m_pendingRadius;
+
+        /// Number of live objects stored in the tree.
+        size_t m_treeObjectCount;
+        /// Number of slots emptied since the tree was last built.
+        size_t m_removedObjectCount;
+
+        /// @name Private Utility Functions
+        //@{
+        void Build();
+        void BuildNode( uint32_t nodeIndex, uint32_t* pIds, size_t idCount );
+        void RefitLeaf( uint32_t nodeIndex );
+        void RefitParents( uint32_t nodeIndex );
+        void MarkLeafDirty( uint32_t nodeIndex );
+        void RemovePending( size_t id );
+        void CullSubtree( uint32_t nodeIndex, const CullingFrustum& rFrustum, DynamicArray< uint32_t >& rVisibleIds ) const;
+        void AddAllInRange( uint32_t firstSlot, uint32_t slotCount, DynamicArray< uint32_t >& rVisibleIds ) const;
+        //@}
+    };
+}
+
+#include "Graphics/GraphicsSceneCulling.inl"
@@ -0,0 +1,18 @@
+namespace Helium
+{
+    /// Get the number of planes set for culling.
+    ///
+    /// @return  Plane count, or zero if the frustum could not be converted.
+    size_t CullingFrustum::GetPlaneCount() const
+    {
+        return m_planeCount;
+    }
+
+    /// Get the number of objects in the hierarchy, including objects not yet inserted into the tree.
+    ///
+    /// @return  Object count.
+    size_t SceneObjectBvh::GetObjectCount() const
+    {
+        return m_treeObjectCount + m_pendingIds.GetSize();
+    }
+}
@@ -1,6 +1,8 @@
 #include "GraphicsJobsPch.h"
 #include "GraphicsJobs/GraphicsJobsInterface.h"
 
+#include "EngineJobs/JobManager.h"
+
 /// Maximum number of child jobs to spawn at once.
 static const uint_fast32_t SCENE_OBJECT_CHILD_JOB_MAX = 128;
 /// Maximum number of graphics scene objects to update in each child job.
@@ -12,7 +14,6 @@ using namespace Helium;
 /// Spawn jobs to update the constant buffer data for all graphics scene objects.
 void UpdateGraphicsSceneObjectBuffersJobSpawner::Run()
 {
-
     const GraphicsSceneObject* pSceneObjects = m_parameters.pSceneObjects;
     float32_t* const* ppConstantBufferData = m_parameters.ppConstantBufferData;
 
@@ -25,34 +26,37 @@ void UpdateGraphicsSceneObjectBuffersJobSpawner::Run()
         jobCount = SCENE_OBJECT_CHILD_JOB_MAX;
     }
 
+    JobManager& rJobManager = JobManager::GetStaticInstance();
+    JobCounter counter;
+
+    UpdateGraphicsSceneObjectBuffersJob childJobs[ SCENE_OBJECT_CHILD_JOB_MAX ];
+    for( uint_fast32_t jobIndex = 0; jobIndex < jobCount; ++jobIndex )
     {
-        for( uint_fast32_t jobIndex = 0; jobIndex < jobCount; ++jobIndex )
-        {
-            uint_fast32_t jobObjectCount = Min( sceneObjectCount, SCENE_OBJECT_CHILD_JOB_OBJECT_COUNT_MAX );
-            HELIUM_ASSERT( jobObjectCount != 0 );
-            sceneObjectCount -= jobObjectCount;
-
-			// NOTE: These were run in parallel but now synchronous since TBB has been removed
-			UpdateGraphicsSceneObjectBuffersJob job;
-            UpdateGraphicsSceneObjectBuffersJob::Parameters& rParameters = job.GetParameters();
-            rParameters.sceneObjectCount = static_cast< uint32_t >( jobObjectCount );
-            rParameters.pSceneObjects = pSceneObjects;
-            rParameters.ppConstantBufferData = ppConstantBufferData;
-			job.Run();
-
-            pSceneObjects += jobObjectCount;
-            ppConstantBufferData += jobObjectCount;
-        }
-
-		// This was a continuation task but now just exectues inline here since TBB was removed
-        if( sceneObjectCount != 0 )
-        {
-			UpdateGraphicsSceneObjectBuffersJobSpawner job;
-            UpdateGraphicsSceneObjectBuffersJobSpawner::Parameters& rParameters = job.GetParameters();
-            rParameters.sceneObjectCount = sceneObjectCount;
-            rParameters.pSceneObjects = pSceneObjects;
-            rParameters.ppConstantBufferData = ppConstantBufferData;
-			job.Run();
-        }
+        uint_fast32_t jobObjectCount = Min( sceneObjectCount, SCENE_OBJECT_CHILD_JOB_OBJECT_COUNT_MAX );
+        HELIUM_ASSERT( jobObjectCount != 0 );
+        sceneObjectCount -= jobObjectCount;
+
+        UpdateGraphicsSceneObjectBuffersJob& rJob = childJobs[ jobIndex ];
+        UpdateGraphicsSceneObjectBuffersJob::Parameters& rParameters = rJob.GetParameters();
+        rParameters.sceneObjectCount = static_cast< uint32_t >( jobObjectCount );
+        rParameters.pSceneObjects = pSceneObjects;
+        rParameters.ppConstantBufferData = ppConstantBufferData;
+        rJobManager.Spawn( rJob, &counter );
+
+        pSceneObjects += jobObjectCount;
+        ppConstantBufferData += jobObjectCount;
     }
+
+    // Spawn another spawner to handle any remaining objects.
+    UpdateGraphicsSceneObjectBuffersJobSpawner remainderJob;
+    if( sceneObjectCount != 0 )
+    {
+        UpdateGraphicsSceneObjectBuffersJobSpawner::Parameters& rParameters = remainderJob.GetParameters();
+        rParameters.sceneObjectCount = static_cast< uint32_t >( sceneObjectCount );
+        rParameters.pSceneObjects = pSceneObjects;
+        rParameters.ppConstantBufferData = ppConstantBufferData;
+        rJobManager.Spawn( remainderJob, &counter );
+    }
+
+    rJobManager.WaitForCounter( counter );
 }
@@ -1,6 +1,8 @@
 #include "GraphicsJobsPch.h"
 #include "GraphicsJobs/GraphicsJobsInterface.h"
 
+#include "EngineJobs/JobManager.h"
+
 /// Maximum number of child jobs to spawn at once.
 static const uint_fast32_t SUB_MESH_CHILD_JOB_MAX = 128;
 /// Maximum number of sub-meshes to update in each child job.
@@ -9,8 +11,6 @@ static const uint_fast32_t SUB_MESH_CHILD_JOB_OBJECT_COUNT_MAX = 100;
 using namespace Helium;
 
 /// Spawn jobs to update the constant buffer data for all graphics scene object sub-meshes.
-///
-/// @param[in] pContext  Context in which this job is running.
 void UpdateGraphicsSceneSubMeshBuffersJobSpawner::Run()
 {
     const GraphicsSceneObject::SubMeshData* pSubMeshes = m_parameters.pSubMeshes;
@@ -27,37 +27,39 @@ void UpdateGraphicsSceneSubMeshBuffersJobSpawner::Run()
         jobCount = SUB_MESH_CHILD_JOB_MAX;
     }
 
+    JobManager& rJobManager = JobManager::GetStaticInstance();
+    JobCounter counter;
+
+    UpdateGraphicsSceneSubMeshBuffersJob childJobs[ SUB_MESH_CHILD_JOB_MAX ];
+    for( uint_fast32_t jobIndex = 0; jobIndex < jobCount; ++jobIndex )
+    {
+        uint_fast32_t jobObjectCount = Min( subMeshCount, SUB_MESH_CHILD_JOB_OBJECT_COUNT_MAX );
+        HELIUM_ASSERT( jobObjectCount != 0 );
+        subMeshCount -= jobObjectCount;
+
+        UpdateGraphicsSceneSubMeshBuffersJob& rJob = childJobs[ jobIndex ];
+        UpdateGraphicsSceneSubMeshBuffersJob::Parameters& rParameters = rJob.GetParameters();
+        rParameters.subMeshCount = static_cast< uint32_t >( jobObjectCount );
+        rParameters.pSubMeshes = pSubMeshes;
+        rParameters.pSceneObjects = pSceneObjects;
+        rParameters.ppConstantBufferData = ppConstantBufferData;
+        rJobManager.Spawn( rJob, &counter );
+
+        pSubMeshes += jobObjectCount;
+        ppConstantBufferData += jobObjectCount;
+    }
+
+    // Spawn another spawner to handle any remaining sub-meshes.
+    UpdateGraphicsSceneSubMeshBuffersJobSpawner remainderJob;
+    if( subMeshCount != 0 )
     {
-        for( uint_fast32_t jobIndex = 0; jobIndex < jobCount; ++jobIndex )
-        {
-			// These were all in parallel but TBB was removed
-            uint_fast32_t jobObjectCount = Min( subMeshCount, SUB_MESH_CHILD_JOB_OBJECT_COUNT_MAX );
-            HELIUM_ASSERT( jobObjectCount != 0 );
-            subMeshCount -= jobObjectCount;
-
-			UpdateGraphicsSceneSubMeshBuffersJob job;
-            UpdateGraphicsSceneSubMeshBuffersJob::Parameters& rParameters = job.GetParameters();
-            rParameters.subMeshCount = static_cast< uint32_t >( jobObjectCount );
-            rParameters.pSubMeshes = pSubMeshes;
-            rParameters.pSceneObjects = pSceneObjects;
-            rParameters.ppConstantBufferData = ppConstantBufferData;
-			job.Run();
-
-            pSubMeshes += jobObjectCount;
-            ppConstantBufferData += jobObjectCount;
-        }
-
-        if( subMeshCount != 0 )
-        {
-			// NOTE: This was a continuation job from above but is now inline since TBB was removed
-			UpdateGraphicsSceneSubMeshBuffersJobSpawner job;
-            UpdateGraphicsSceneSubMeshBuffersJobSpawner::Parameters& rParameters =
-                job.GetParameters();
-            rParameters.subMeshCount = subMeshCount;
-            rParameters.pSubMeshes = pSubMeshes;
-            rParameters.pSceneObjects = pSceneObjects;
-            rParameters.ppConstantBufferData = ppConstantBufferData;
-			job.Run();
-        }
+        UpdateGraphicsSceneSubMeshBuffersJobSpawner::Parameters& rParameters = remainderJob.GetParameters();
+        rParameters.subMeshCount = static_cast< uint32_t >( subMeshCount );
+        rParameters.pSubMeshes = pSubMeshes;
+        rParameters.pSceneObjects = pSceneObjects;
+        rParameters.ppConstantBufferData = ppConstantBufferData;
+        rJobManager.Spawn( remainderJob, &counter );
     }
+
+    rJobManager.WaitForCounter( counter );
 }
@@ -392,6 +392,7 @@ Helium.DoExampleMainProjectSettings = function(demoName)
 		"bullet",
 		"mongo-c",
 		"ois",
+		"zlib",
 	}
 
 	if _OPTIONS[ "gfxapi" ] == "opengl" then
@@ -0,0 +1,513 @@
+#include "PcSupportPch.h"
+
+#if HELIUM_TOOLS
+
+#include "PcSupport/AssetCooker.h"
+
+#include "Platform/Timer.h"
+#include "Engine/AssetLoader.h"
+#include "Engine/AsyncLoader.h"
+#include "Engine/PackageLoader.h"
+
+using namespace Helium;
+
+/// Constructor.
+AssetCooker::AssetCooker()
+	: m_failureCount( 0 )
+{
+}
+
+/// Destructor.
+AssetCooker::~AssetCooker()
+{
+}
+
+/// Cook all assets in the given packages (including all child packages).
+///
+/// This must be called from the thread driving the AssetLoader, with an AssetPreprocessor instance created.  If the
+/// JobManager has been initialized, resource preprocessing is spread across its worker threads, otherwise all work is
+/// done on the calling thread.
+///
+/// @param[in] rPackagePaths  Paths of the packages to cook.
+///
+/// @return  True if all assets were cooked successfully, false if any errors occurred.
+///
+/// @see CookAll(), GetAssetTimings()
+bool AssetCooker::Cook( const DynamicArray< AssetPath >& rPackagePaths )
+{
+	Reset();
+
+	AssetPreprocessor* pAssetPreprocessor = AssetPreprocessor::GetStaticInstance();
+	if( !pAssetPreprocessor )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "AssetCooker::Cook(): Missing AssetPreprocessor to use for cooking.\n" ) );
+
+		return false;
+	}
+
+	uint64_t startTicks = Timer::GetTickCount();
+
+	// Load everything up front, queueing resources that can be preprocessed on other threads.
+	pAssetPreprocessor->SetDeferPreprocessing( true );
+	LoadAssets( rPackagePaths );
+	pAssetPreprocessor->SetDeferPreprocessing( false );
+	pAssetPreprocessor->TakeDeferredResources( m_deferredResources );
+
+	uint64_t loadEndTicks = Timer::GetTickCount();
+
+	HELIUM_TRACE(
+		TraceLevels::Info,
+		( TXT( "AssetCooker::Cook(): Loaded %" ) PRIuSZ TXT( " assets (%" ) PRIuSZ TXT( " resources to preprocess) " )
+		TXT( "in %.2f seconds.\n" ) ),
+		m_nodes.GetSize(),
+		m_deferredResources.GetSize(),
+		Timer::TicksToMilliseconds( loadEndTicks - startTicks ) / 1000.0f );
+
+	BuildDependencyGraph();
+	RunDependencyGraph();
+
+	HELIUM_TRACE(
+		TraceLevels::Info,
+		( TXT( "AssetCooker::Cook(): Cooked %" ) PRIuSZ TXT( " assets (%" ) PRIuSZ TXT( " failed) in %.2f seconds.\n" ) ),
+		m_assetTimings.GetSize(),
+		m_failureCount,
+		Timer::TicksToMilliseconds( Timer::GetTickCount() - startTicks ) / 1000.0f );
+
+	// Release the cooked assets.
+	m_nodes.Clear();
+	m_nodeMap.Clear();
+	m_deferredResources.Clear();
+	m_preprocessJobs.Clear();
+
+	return ( m_failureCount == 0 );
+}
+
+/// Cook all assets in all root packages.
+///
+/// @return  True if all assets were cooked successfully, false if any errors occurred.
+///
+/// @see Cook()
+bool AssetCooker::CookAll()
+{
+	AssetLoader* pAssetLoader = AssetLoader::GetStaticInstance();
+	HELIUM_ASSERT( pAssetLoader );
+
+	DynamicArray< AssetPath > rootPackages;
+	pAssetLoader->EnumerateRootPackages( rootPackages );
+
+	return Cook( rootPackages );
+}
+
+/// Clear out all state and results from the previous cook.
+void AssetCooker::Reset()
+{
+	HELIUM_ASSERT( m_jobCounter.IsDone() );
+
+	m_nodes.Clear();
+	m_nodeMap.Clear();
+	m_deferredResources.Clear();
+	m_preprocessJobs.Clear();
+	m_assetTimings.Clear();
+	m_failureCount = 0;
+
+	Locker< DynamicArray< size_t >, SpinLock >::Handle handle( m_preprocessedNodes );
+	handle->Clear();
+}
+
+/// Load all assets in the given packages and their child packages, adding a graph node for each loaded asset.
+///
+/// @param[in] rPackagePaths  Paths of the packages to load.
+void AssetCooker::LoadAssets( const DynamicArray< AssetPath >& rPackagePaths )
+{
+	AssetLoader* pAssetLoader = AssetLoader::GetStaticInstance();
+	HELIUM_ASSERT( pAssetLoader );
+
+	AsyncLoader& rAsyncLoader = AsyncLoader::GetStaticInstance();
+
+	DynamicArray< PendingLoad > pendingLoads;
+
+	size_t packageCount = rPackagePaths.GetSize();
+	for( size_t packageIndex = 0; packageIndex < packageCount; ++packageIndex )
+	{
+		BeginLoad( rPackagePaths[ packageIndex ], pendingLoads );
+	}
+
+	// Keep all loads in flight at once, queueing loads for the children of each package as it finishes loading.
+	while( !pendingLoads.IsEmpty() )
+	{
+		// Read before ticking so that anything completing during the tick cuts the wait below short.
+		uint32_t progressCount = rAsyncLoader.GetProgressCount();
+
+		pAssetLoader->Tick();
+
+		bool bProgress = false;
+
+		size_t loadIndex = 0;
+		while( loadIndex < pendingLoads.GetSize() )
+		{
+			AssetPtr spAsset;
+			if( !pAssetLoader->TryFinishLoad( pendingLoads[ loadIndex ].loadId, spAsset ) )
+			{
+				++loadIndex;
+
+				continue;
+			}
+
+			bProgress = true;
+
+			AssetPath path = pendingLoads[ loadIndex ].path;
+			pendingLoads.RemoveSwap( loadIndex );
+
+			if( !spAsset || spAsset->GetAnyFlagSet( Asset::FLAG_BROKEN ) )
+			{
+				HELIUM_TRACE( TraceLevels::Error, TXT( "AssetCooker: Failed to load \"%s\".\n" ), *path.ToString() );
+				AddFailure( path );
+
+				continue;
+			}
+
+			if( spAsset->IsPackage() )
+			{
+				Package* pPackage = Reflect::AssertCast< Package >( spAsset.Get() );
+				PackageLoader* pPackageLoader = pPackage->GetLoader();
+				HELIUM_ASSERT( pPackageLoader );
+
+				DynamicArray< AssetPath > childPaths;
+				pPackageLoader->EnumerateChildren( childPaths );
+
+				size_t childCount = childPaths.GetSize();
+				for( size_t childIndex = 0; childIndex < childCount; ++childIndex )
+				{
+					BeginLoad( childPaths[ childIndex ], pendingLoads );
+				}
+
+				continue;
+			}
+
+			AddNode( spAsset );
+		}
+
+		if( !bProgress )
+		{
+			rAsyncLoader.WaitForProgress( progressCount, LOAD_TICK_INTERVAL );
+		}
+	}
+}
+
+/// Begin loading an asset, unless it has already been requested.
+///
+/// @param[in] path           Asset path.
+/// @param[in] rPendingLoads  Outstanding load requests, to which the new request is added.
+void AssetCooker::BeginLoad( AssetPath path, DynamicArray< PendingLoad >& rPendingLoads )
+{
+	HashMap< AssetPath, size_t >::Iterator mapIter = m_nodeMap.Find( path );
+	if( mapIter != m_nodeMap.End() )
+	{
+		return;
+	}
+
+	m_nodeMap.Insert( mapIter, HashMap< AssetPath, size_t >::ValueType( path, Invalid< size_t >() ) );
+
+	size_t loadId = AssetLoader::GetStaticInstance()->BeginLoadObject( path );
+	if( IsInvalid( loadId ) )
+	{
+		HELIUM_TRACE( TraceLevels::Error, TXT( "AssetCooker: Failed to begin loading \"%s\".\n" ), *path.ToString() );
+		AddFailure( path );
+
+		return;
+	}
+
+	PendingLoad* pLoad = rPendingLoads.New();
+	HELIUM_ASSERT( pLoad );
+	pLoad->path = path;
+	pLoad->loadId = loadId;
+}
+
+/// Get the graph node for an asset, adding a new node if one does not exist yet.
+///
+/// @param[in] pAsset  Loaded asset.
+///
+/// @return  Node index.
+size_t AssetCooker::AddNode( Asset* pAsset )
+{
+	HELIUM_ASSERT( pAsset );
+
+	AssetPath path = pAsset->GetPath();
+
+	HashMap< AssetPath, size_t >::Iterator mapIter = m_nodeMap.Find( path );
+	if( mapIter != m_nodeMap.End() && IsValid( mapIter->Second() ) )
+	{
+		return mapIter->Second();
+	}
+
+	size_t nodeIndex = m_nodes.GetSize();
+
+	Node* pNode = m_nodes.New();
+	HELIUM_ASSERT( pNode );
+	pNode->spAsset = pAsset;
+	SetInvalid( pNode->deferredResourceIndex );
+	pNode->pendingDependencyCount = 0;
+	pNode->preprocessTicks = 0;
+	pNode->bPreprocessSuccess = true;
+
+	if( mapIter != m_nodeMap.End() )
+	{
+		mapIter->Second() = nodeIndex;
+	}
+	else
+	{
+		m_nodeMap.Insert( mapIter, HashMap< AssetPath, size_t >::ValueType( path, nodeIndex ) );
+	}
+
+	return nodeIndex;
+}
+
+/// Attach the deferred resources to their graph nodes and link each node to the nodes on which it depends.
+///
+/// Assets that are not in the packages being cooked but were loaded as dependencies of them (and would otherwise
+/// have been cached when loaded) are added to the graph as well.
+void AssetCooker::BuildDependencyGraph()
+{
+	size_t resourceCount = m_deferredResources.GetSize();
+	for( size_t resourceIndex = 0; resourceIndex < resourceCount; ++resourceIndex )
+	{
+		size_t nodeIndex = AddNode( m_deferredResources[ resourceIndex ].spResource );
+		m_nodes[ nodeIndex ].deferredResourceIndex = resourceIndex;
+	}
+
+	// Nodes added for dependencies are appended, so they get linked up by this loop as well.
+	for( size_t nodeIndex = 0; nodeIndex < m_nodes.GetSize(); ++nodeIndex )
+	{
+		Asset* pAsset = m_nodes[ nodeIndex ].spAsset;
+		HELIUM_ASSERT( pAsset );
+
+		Asset* dependencies[] =
+		{
+			pAsset->GetOwner(),
+			Reflect::AssertCast< Asset >( pAsset->GetTemplate() )
+		};
+
+		for( size_t dependencyIndex = 0; dependencyIndex < HELIUM_ARRAY_COUNT( dependencies ); ++dependencyIndex )
+		{
+			Asset* pDependency = dependencies[ dependencyIndex ];
+			if( !pDependency || pDependency->IsPackage() || pDependency->IsDefaultTemplate() )
+			{
+				continue;
+			}
+
+			size_t dependencyNodeIndex = AddNode( pDependency );
+			m_nodes[ dependencyNodeIndex ].dependents.Push( nodeIndex );
+			++m_nodes[ nodeIndex ].pendingDependencyCount;
+		}
+	}
+}
+
+/// Preprocess and cache all graph nodes, in dependency order.
+///
+/// Nodes are preprocessed as jobs as soon as all of their dependencies have been cached, while the calling thread
+/// caches nodes as they finish preprocessing and runs pending jobs while waiting.
+void AssetCooker::RunDependencyGraph()
+{
+	JobManager& rJobManager = JobManager::GetStaticInstance();
+	size_t threadCount = ( rJobManager.IsInitialized() ? rJobManager.GetWorkerThreadCount() + 1 : 1 );
+	size_t jobLimit = threadCount * JOBS_IN_FLIGHT_PER_THREAD;
+
+	size_t nodeCount = m_nodes.GetSize();
+	m_preprocessJobs.Resize( nodeCount );
+
+	DynamicArray< size_t > readyNodes;
+	DynamicArray< size_t > preprocessedNodes;
+
+	for( size_t nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex )
+	{
+		if( m_nodes[ nodeIndex ].pendingDependencyCount == 0 )
+		{
+			ReleaseNode( nodeIndex, readyNodes, preprocessedNodes );
+		}
+	}
+
+	size_t cookedCount = 0;
+	size_t jobsInFlight = 0;
+	while( cookedCount < nodeCount )
+	{
+		// Keep the number of jobs in flight bounded so that finished nodes are cached (and their dependents released)
+		// promptly.
+		while( !readyNodes.IsEmpty() && jobsInFlight < jobLimit )
+		{
+			size_t nodeIndex = readyNodes[ readyNodes.GetSize() - 1 ];
+			readyNodes.Pop();
+
+			PreprocessJob& rJob = m_preprocessJobs[ nodeIndex ];
+			rJob.pCooker = this;
+			rJob.nodeIndex = nodeIndex;
+
+			++jobsInFlight;
+			rJobManager.Spawn( rJob, &m_jobCounter );
+		}
+
+		// Read before collecting finished nodes so that any job finishing afterwards cuts the wait below short.
+		AsyncLoader& rAsyncLoader = AsyncLoader::GetStaticInstance();
+		uint32_t progressCount = rAsyncLoader.GetProgressCount();
+
+		{
+			Locker< DynamicArray< size_t >, SpinLock >::Handle handle( m_preprocessedNodes );
+
+			size_t finishedCount = handle->GetSize();
+			HELIUM_ASSERT( finishedCount <= jobsInFlight );
+			jobsInFlight -= finishedCount;
+
+			const size_t* pFinishedNodes = handle->GetData();
+			for( size_t finishedIndex = 0; finishedIndex < finishedCount; ++finishedIndex )
+			{
+				preprocessedNodes.Push( pFinishedNodes[ finishedIndex ] );
+			}
+
+			handle->Resize( 0 );
+		}
+
+		if( preprocessedNodes.IsEmpty() )
+		{
+			// Help out with preprocessing while waiting for jobs to finish, sleeping until one reports progress if all
+			// of them have already been picked up by workers.
+			HELIUM_ASSERT( jobsInFlight != 0 );
+			if( !rJobManager.TryRunPendingJob() )
+			{
+				rAsyncLoader.WaitForProgress( progressCount, LOAD_TICK_INTERVAL );
+			}
+
+			continue;
+		}
+
+		// Cache each preprocessed node on this thread, releasing any dependents whose dependencies are now all cached.
+		for( size_t preprocessedIndex = 0; preprocessedIndex < preprocessedNodes.GetSize(); ++preprocessedIndex )
+		{
+			size_t nodeIndex = preprocessedNodes[ preprocessedIndex ];
+			CacheNode( nodeIndex );
+			++cookedCount;
+
+			const DynamicArray< size_t >& rDependents = m_nodes[ nodeIndex ].dependents;
+			size_t dependentCount = rDependents.GetSize();
+			for( size_t dependentIndex = 0; dependentIndex < dependentCount; ++dependentIndex )
+			{
+				size_t dependentNodeIndex = rDependents[ dependentIndex ];
+				Node& rDependent = m_nodes[ dependentNodeIndex ];
+				HELIUM_ASSERT( rDependent.pendingDependencyCount != 0 );
+				if( --rDependent.pendingDependencyCount == 0 )
+				{
+					ReleaseNode( dependentNodeIndex, readyNodes, preprocessedNodes );
+				}
+			}
+		}
+
+		preprocessedNodes.Resize( 0 );
+	}
+
+	rJobManager.WaitForCounter( m_jobCounter );
+}
+
+/// Queue a node whose dependencies have all been cached for preprocessing, or for caching if it has no resource
+/// data to preprocess.
+///
+/// @param[in] nodeIndex           Node index.
+/// @param[in] rReadyNodes         Nodes waiting for a preprocessing job.
+/// @param[in] rPreprocessedNodes  Nodes ready to be cached.
+void AssetCooker::ReleaseNode(
+	size_t nodeIndex,
+	DynamicArray< size_t >& rReadyNodes,
+	DynamicArray< size_t >& rPreprocessedNodes )
+{
+	if( IsValid( m_nodes[ nodeIndex ].deferredResourceIndex ) )
+	{
+		rReadyNodes.Push( nodeIndex );
+	}
+	else
+	{
+		rPreprocessedNodes.Push( nodeIndex );
+	}
+}
+
+/// Cache the asset for a graph node and record its timings.
+///
+/// @param[in] nodeIndex  Node index.
+///
+/// @return  True if caching was successful, false if not.
+bool AssetCooker::CacheNode( size_t nodeIndex )
+{
+	const Node& rNode = m_nodes[ nodeIndex ];
+	Asset* pAsset = rNode.spAsset;
+	HELIUM_ASSERT( pAsset );
+
+	AssetTiming* pTiming = m_assetTimings.New();
+	HELIUM_ASSERT( pTiming );
+	pTiming->path = pAsset->GetPath();
+	pTiming->preprocessMs = Timer::TicksToMilliseconds( rNode.preprocessTicks );
+	pTiming->cacheMs = 0.0f;
+	pTiming->bSuccess = false;
+
+	if( !rNode.bPreprocessSuccess )
+	{
+		++m_failureCount;
+
+		return false;
+	}
+
+	uint64_t startTicks = Timer::GetTickCount();
+	bool bSuccess = AssetLoader::GetStaticInstance()->CacheObject( pAsset, true );
+	pTiming->cacheMs = Timer::TicksToMilliseconds( Timer::GetTickCount() - startTicks );
+	pTiming->bSuccess = bSuccess;
+
+	if( !bSuccess )
+	{
+		++m_failureCount;
+	}
+
+	return bSuccess;
+}
+
+/// Record an asset that could not be loaded.
+///
+/// @param[in] rPath  Asset path.
+void AssetCooker::AddFailure( const AssetPath& rPath )
+{
+	AssetTiming* pTiming = m_assetTimings.New();
+	HELIUM_ASSERT( pTiming );
+	pTiming->path = rPath;
+	pTiming->preprocessMs = 0.0f;
+	pTiming->cacheMs = 0.0f;
+	pTiming->bSuccess = false;
+
+	++m_failureCount;
+}
+
+/// Preprocess the deferred resource for a graph node.
+///
+/// @param[in] pJob  Preprocessing job.
+void AssetCooker::PreprocessJob::RunCallback( void* pJob )
+{
+	PreprocessJob* pPreprocessJob = static_cast< PreprocessJob* >( pJob );
+	HELIUM_ASSERT( pPreprocessJob );
+
+	AssetCooker* pCooker = pPreprocessJob->pCooker;
+	HELIUM_ASSERT( pCooker );
+
+	size_t nodeIndex = pPreprocessJob->nodeIndex;
+	Node& rNode = pCooker->m_nodes[ nodeIndex ];
+
+	AssetPreprocessor* pAssetPreprocessor = AssetPreprocessor::GetStaticInstance();
+	HELIUM_ASSERT( pAssetPreprocessor );
+
+	uint64_t startTicks = Timer::GetTickCount();
+	rNode.bPreprocessSuccess = pAssetPreprocessor->PreprocessDeferredResource(
+		pCooker->m_deferredResources[ rNode.deferredResourceIndex ] );
+	rNode.preprocessTicks = Timer::GetTickCount() - startTicks;
+
+	{
+		Locker< DynamicArray< size_t >, SpinLock >::Handle handle( pCooker->m_preprocessedNodes );
+		handle->Push( nodeIndex );
+	}
+
+	// Wake up the cooking thread if it is waiting for preprocessing to finish.
+	AsyncLoader::GetStaticInstance().NotifyProgress();
+}
+
+#endif  // HELIUM_TOOLS
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "PcSupport/PcSupport.h"
+
+#if HELIUM_TOOLS
+
+#include "Platform/Locks.h"
+
+#include "Foundation/DynamicArray.h"
+#include "Foundation/HashMap.h"
+
+#include "Engine/Asset.h"
+
+#include "EngineJobs/JobManager.h"
+
+#include "PcSupport/AssetPreprocessor.h"
+
+namespace Helium
+{
+	/// Headless batch asset cooker.
+	///
+	/// Cooking runs in two phases.  First, all assets in the packages being cooked are loaded with resource
+	/// preprocessing deferred (see AssetPreprocessor::SetDeferPreprocessing()), so that loading is not held up
+	/// preprocessing resources one at a time.  Then, a dependency graph is built from the loaded assets, with each asset
+	/// depending on its owner and its template, and the deferred resources are preprocessed as JobManager jobs as soon
+	/// as their dependencies have been cooked.  The thread running the cook is the single writer into the cache: it
+	/// caches each asset once the asset and its dependencies are ready, and helps run preprocessing jobs in between.
+	///
+	/// Timings for each cooked asset are recorded and can be retrieved with GetAssetTimings() once cooking finishes.
+	class HELIUM_PC_SUPPORT_API AssetCooker : NonCopyable
+	{
+	public:
+		/// Number of preprocessing jobs kept in flight for each thread running jobs.
+		static const size_t JOBS_IN_FLIGHT_PER_THREAD = 2;
+		/// Maximum time (in milliseconds) to wait for loading progress between ticks of the AssetLoader while loading.
+		static const uint32_t LOAD_TICK_INTERVAL = 10;
+
+		/// Timing information for a cooked asset.
+		struct AssetTiming
+		{
+			/// Asset path.
+			AssetPath path;
+			/// Time spent preprocessing resource data during the cook, in milliseconds (zero if not preprocessed).
+			float preprocessMs;
+			/// Time spent caching the asset, in milliseconds.
+			float cacheMs;
+			/// True if the asset was cooked successfully, false if not.
+			bool bSuccess;
+		};
+
+		/// @name Construction/Destruction
+		//@{
+		AssetCooker();
+		~AssetCooker();
+		//@}
+
+		/// @name Cooking
+		//@{
+		bool Cook( const DynamicArray< AssetPath >& rPackagePaths );
+		bool CookAll();
+		//@}
+
+		/// @name Results
+		//@{
+		inline const DynamicArray< AssetTiming >& GetAssetTimings() const;
+		inline size_t GetFailureCount() const;
+		//@}
+
+	private:
+		/// Outstanding asset load request.
+		struct PendingLoad
+		{
+			/// Asset path.
+			AssetPath path;
+			/// AssetLoader request ID.
+			size_t loadId;
+		};
+
+		/// Asset dependency graph node.
+		struct Node
+		{
+			/// Asset to cook.
+			AssetPtr spAsset;
+			/// Index of the deferred resource to preprocess for this asset, or an invalid index if none.
+			size_t deferredResourceIndex;
+			/// Indices of nodes that depend on this node.
+			DynamicArray< size_t > dependents;
+			/// Number of dependencies that have not yet been cooked.
+			size_t pendingDependencyCount;
+			/// Time spent preprocessing, in ticks.
+			uint64_t preprocessTicks;
+			/// True if preprocessing succeeded (or was not needed).
+			bool bPreprocessSuccess;
+		};
+
+		/// Preprocessing job for a single node.
+		struct PreprocessJob
+		{
+			/// Cooker running the job.
+			AssetCooker* pCooker;
+			/// Index of the node to preprocess.
+			size_t nodeIndex;
+
+			/// @name Job Interface
+			//@{
+			static void RunCallback( void* pJob );
+			//@}
+		};
+
+		/// Dependency graph nodes.
+		DynamicArray< Node > m_nodes;
+		/// Node index for each asset path encountered while loading (invalid for packages and failed loads).
+		HashMap< AssetPath, size_t > m_nodeMap;
+
+		/// Resources queued for preprocessing while loading.
+		DynamicArray< AssetPreprocessor::DeferredResource > m_deferredResources;
+		/// Preprocessing job instances, one for each node.
+		DynamicArray< PreprocessJob > m_preprocessJobs;
+		/// Counter for all spawned preprocessing jobs.
+		JobCounter m_jobCounter;
+
+		/// Indices of nodes that have finished preprocessing and are ready to be cached.
+		Locker< DynamicArray< size_t >, SpinLock > m_preprocessedNodes;
+
+		/// Per-asset timing results.
+		DynamicArray< AssetTiming > m_assetTimings;
+		/// Number of assets that failed to load or cook.
+		size_t m_failureCount;
+
+		/// @name Private Utility Functions
+		//@{
+		void Reset();
+		void LoadAssets( const DynamicArray< AssetPath >& rPackagePaths );
+		void BeginLoad( AssetPath path, DynamicArray< PendingLoad >& rPendingLoads );
+		size_t AddNode( Asset* pAsset );
+		void BuildDependencyGraph();
+		void RunDependencyGraph();
+		void ReleaseNode(
+			size_t nodeIndex, DynamicArray< size_t >& rReadyNodes, DynamicArray< size_t >& rPreprocessedNodes );
+		bool CacheNode( size_t nodeIndex );
+		void AddFailure( const AssetPath& rPath );
+		//@}
+	};
+}
+
+#include "PcSupport/AssetCooker.inl"
+
+#endif  // HELIUM_TOOLS
@@ -0,0 +1,22 @@
+namespace Helium
+{
+	/// Get the timings recorded for each asset during the last cook.
+	///
+	/// @return  Per-asset timings, in the order in which the assets were cooked.
+	///
+	/// @see GetFailureCount()
+	const DynamicArray< AssetCooker::AssetTiming >& AssetCooker::GetAssetTimings() const
+	{
+		return m_assetTimings;
+	}
+
+	/// Get the number of assets that failed to load or cook during the last cook.
+	///
+	/// @return  Number of failed assets.
+	///
+	/// @see GetAssetTimings()
+	size_t AssetCooker::GetFailureCount() const
+	{
+		return m_failureCount;
+	}
+}
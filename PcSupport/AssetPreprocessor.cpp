@@ -10,6 +10,7 @@
 #include "Engine/CacheManager.h"
 #include "Engine/AssetLoader.h"
 #include "Engine/Resource.h"
+#include "Engine/StableHash.h"
 #include "Engine/Config.h"
 #include "PcSupport/PlatformPreprocessor.h"
 #include "PcSupport/ResourceHandler.h"
@@ -21,13 +22,36 @@ AssetPreprocessor* AssetPreprocessor::sm_pInstance = NULL;
 
 /// Constructor.
 AssetPreprocessor::AssetPreprocessor()
+#if HELIUM_TOOLS
+	: m_bDeferPreprocessing( false )
+	, m_bFileHashesDirty( false )
+#endif
 {
 	MemoryZero( m_pPlatformPreprocessors, sizeof( m_pPlatformPreprocessors ) );
+
+#if HELIUM_TOOLS
+	// Keep the content store and the file hash memo in the user data directory by default.
+	FilePath userDataDirectory;
+	if( FileLocations::GetUserDataDirectory( userDataDirectory ) )
+	{
+		SetContentStoreDirectory( userDataDirectory + TXT( "ContentStore/" ) );
+
+		m_fileHashMemoPath = userDataDirectory + TXT( "SourceFileHashes.index" );
+		LoadFileHashMemo();
+	}
+#endif
 }
 
 /// Destructor.
 AssetPreprocessor::~AssetPreprocessor()
 {
+#if HELIUM_TOOLS
+	if( m_bFileHashesDirty )
+	{
+		SaveFileHashMemo();
+	}
+#endif
+
 	for( size_t platformIndex = 0; platformIndex < HELIUM_ARRAY_COUNT( m_pPlatformPreprocessors ); ++platformIndex )
 	{
 		delete m_pPlatformPreprocessors[ platformIndex ];
@@ -50,6 +74,93 @@ void AssetPreprocessor::SetPlatformPreprocessor( Cache::EPlatform platform, Plat
 	m_pPlatformPreprocessors[ platform ] = pPreprocessor;
 }
 
+/// Set the directory of the content-addressed store for preprocessed resource data.
+///
+/// Preprocessed data is written to the store under its content key, and looked up there whenever the cached data for
+/// a resource is out-of-date, so pointing multiple workspaces (or build machines) at the same directory lets them
+/// reuse each other's preprocessed data.
+///
+/// @param[in] rDirectory  Content store directory, or an empty path to disable the content store.
+///
+/// @see GetContentStoreDirectory()
+void AssetPreprocessor::SetContentStoreDirectory( const FilePath& rDirectory )
+{
+	m_contentStoreDirectory = rDirectory;
+
+	if( !m_contentStoreDirectory.Get().empty() && !m_contentStoreDirectory.MakePath() )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Warning,
+			( TXT( "AssetPreprocessor::SetContentStoreDirectory(): Failed to create content store directory " )
+			TXT( "\"%s\".  Content store disabled.\n" ) ),
+			m_contentStoreDirectory.c_str() );
+
+		m_contentStoreDirectory.Clear();
+	}
+}
+
+#if HELIUM_TOOLS
+/// Set whether preprocessing of resources should be deferred.
+///
+/// While preprocessing is deferred, resources that need to be preprocessed when loaded are queued up instead if
+/// their resource handler supports concurrent caching (see ResourceHandler::CanCacheConcurrently()).  Such resources
+/// are loaded without their preprocessed data, and the queued resources should be retrieved with
+/// TakeDeferredResources() and preprocessed with PreprocessDeferredResource() before they are cached.  Resources
+/// handled by other resource handlers are still preprocessed as they are loaded.
+///
+/// Note that the AssetLoader does not cache objects automatically while preprocessing is deferred.
+///
+/// @param[in] bDefer  True to defer preprocessing, false to preprocess resources as they are loaded.
+///
+/// @see GetDeferPreprocessing()
+void AssetPreprocessor::SetDeferPreprocessing( bool bDefer )
+{
+	m_bDeferPreprocessing = bDefer;
+}
+
+/// Retrieve and clear the list of resources queued for preprocessing while preprocessing was deferred.
+///
+/// @param[out] rResources  List of queued resources.  Any existing contents will be replaced.
+///
+/// @see SetDeferPreprocessing(), PreprocessDeferredResource()
+void AssetPreprocessor::TakeDeferredResources( DynamicArray< DeferredResource >& rResources )
+{
+	rResources = m_deferredResources;
+	m_deferredResources.Clear();
+}
+
+/// Preprocess a resource queued while preprocessing was deferred.
+///
+/// This can be called from any thread, and multiple resources can be preprocessed concurrently, as long as no other
+/// thread accesses the resource being preprocessed in the mean time.  The preprocessed data is kept in memory with
+/// the resource, ready for caching, and written to the content store.
+///
+/// @param[in] rResource  Queued resource.
+///
+/// @return  True if preprocessing was successful, false if not.
+///
+/// @see TakeDeferredResources()
+bool AssetPreprocessor::PreprocessDeferredResource( const DeferredResource& rResource )
+{
+	Resource* pResource = Reflect::AssertCast< Resource >( rResource.spResource.Get() );
+	HELIUM_ASSERT( pResource );
+
+	if( !PreprocessResource( rResource.path, pResource, rResource.sourceFilePath ) )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "AssetPreprocessor::PreprocessDeferredResource(): Preprocessing of resource \"%s\" failed.\n" ),
+			*rResource.path.ToString() );
+
+		return false;
+	}
+
+	CommitPreprocessedResourceData( pResource, rResource.contentKeys );
+
+	return true;
+}
+#endif  // HELIUM_TOOLS
+
 /// Cache an object for all registered platforms.
 ///
 /// @param[in] pObject                                 Asset to cache.
@@ -120,9 +231,21 @@ bool AssetPreprocessor::CacheObject(
 		HELIUM_ASSERT( pCache );
 		pCache->EnforceTocLoad();
 
+		// Resource entries are stamped with the content key of their preprocessed data instead of a timestamp.
+		int64_t entryTimestamp = timestamp;
+		if( pResource )
+		{
+			const Resource::PreprocessedData& rResourceData = pResource->GetPreprocessedData(
+				static_cast< Cache::EPlatform >( platformIndex ) );
+			if( rResourceData.bLoaded )
+			{
+				entryTimestamp = static_cast< int64_t >( rResourceData.contentKey );
+			}
+		}
+
 		// Don't recache the object if an up-to-date cache entry already exists for it.
 		const Cache::Entry* pEntry = pCache->FindEntry( objectPath, 0 );
-		if( pEntry && pEntry->timestamp == timestamp )
+		if( pEntry && pEntry->timestamp == entryTimestamp )
 		{
 			continue;
 		}
@@ -209,8 +332,9 @@ bool AssetPreprocessor::CacheObject(
 			objectPath,
 			0,
 			objectStreamBuffer.GetData(),
-			timestamp,
-			static_cast< uint32_t >( objectDataSize ) );
+			entryTimestamp,
+			static_cast< uint32_t >( objectDataSize ),
+			CacheCompression::CODEC_LZ4 );
 		if( !bCacheResult )
 		{
 			HELIUM_TRACE(
@@ -252,8 +376,9 @@ bool AssetPreprocessor::CacheObject(
 							objectPath,
 							static_cast< uint32_t >( subDataBufferIndex ),
 							rSubData.GetData(),
-							timestamp,
-							static_cast< uint32_t >( rSubData.GetSize() ) );
+							entryTimestamp,
+							static_cast< uint32_t >( rSubData.GetSize() ),
+							CacheCompression::CODEC_DEFLATE );
 						if( !bCacheResult )
 						{
 							HELIUM_TRACE(
@@ -301,17 +426,19 @@ bool AssetPreprocessor::CacheObject(
 
 /// Load data for the specified resource into memory, preprocessing it from source data if it is out-of-date.
 ///
-/// @param[in] pResource        Resource to load.
-/// @param[in] objectTimestamp  Timestamp of the object data stored on disk.  This will be combined with the source
-///                             asset timestamp to get the timestamp value with which to compare against the cached
-///                             data.
+/// For each platform, the content key of the resource is compared against that of the cached resource data.  If the
+/// cached data is out-of-date, the content store is checked for data preprocessed from the same content before
+/// falling back to preprocessing the resource.
+///
+/// @param[in] resourcePath  Path of the resource.
+/// @param[in] pResource     Resource to load.
 void AssetPreprocessor::LoadResourceData( const AssetPath &resourcePath, Resource* pResource )
 {
 #if HELIUM_TOOLS
 
 	HELIUM_ASSERT( pResource );
 
-	// Locate the source asset file of the source template resource and combine its timestamp with the object timestamp.
+	// Locate the source asset file of the source template resource.
 	// This will be the asset that extends the default asset (i.e. test.png, which would have Helium::Texture2D as template)
 	Resource* pSourceResource = pResource;
 	Asset* pTestTemplate = Reflect::AssertCast< Asset >( pResource->GetTemplate() );
@@ -341,18 +468,15 @@ void AssetPreprocessor::LoadResourceData( const AssetPath &resourcePath, Resourc
 
 	sourceFilePath += baseResourcePath.ToFilePathString().GetData();
 
-	Helium::Status stat;
-	stat.Read( sourceFilePath );
-
-	int64_t sourceFileTimestamp = stat.m_ModifiedTime;
-	int64_t assetFileTimestamp = AssetLoader::GetAssetFileTimestamp( baseResourcePath );
+	uint64_t sourceContentKey = ComputeSourceContentKey( resourcePath, baseResourcePath, pResource, sourceFilePath );
 
-	int64_t timestamp = Max( assetFileTimestamp, sourceFileTimestamp );
+	uint64_t contentKeys[ Cache::PLATFORM_MAX ];
+	MemoryZero( contentKeys, sizeof( contentKeys ) );
 
-	// Check if data is loaded for each supported platform, attempting to load the data from the cache if it exists
-	// and is up-to-date.
-	size_t platformIndex;
-	for( platformIndex = 0; platformIndex < HELIUM_ARRAY_COUNT( m_pPlatformPreprocessors ); ++platformIndex )
+	// Check if data is loaded for each supported platform, attempting to load the data from the cache or the content
+	// store if either has data preprocessed from the current content.
+	bool bPreprocess = false;
+	for( size_t platformIndex = 0; platformIndex < HELIUM_ARRAY_COUNT( m_pPlatformPreprocessors ); ++platformIndex )
 	{
 		// Skip platforms for which we don't have preprocessing support.
 		PlatformPreprocessor* pPreprocessor = m_pPlatformPreprocessors[ platformIndex ];
@@ -361,56 +485,90 @@ void AssetPreprocessor::LoadResourceData( const AssetPath &resourcePath, Resourc
 			continue;
 		}
 
+		Cache::EPlatform platform = static_cast< Cache::EPlatform >( platformIndex );
+		contentKeys[ platformIndex ] = ComputeContentKey( sourceContentKey, platform );
+
 		// Check if we already have loaded resource data.
-		const Resource::PreprocessedData& rPreprocessedData = pResource->GetPreprocessedData(
-			static_cast< Cache::EPlatform >( platformIndex ) );
-		if( rPreprocessedData.bLoaded )
+		const Resource::PreprocessedData& rPreprocessedData = pResource->GetPreprocessedData( platform );
+		if( bPreprocess || ( rPreprocessedData.bLoaded && rPreprocessedData.contentKey == contentKeys[ platformIndex ] ) )
 		{
 			continue;
 		}
 
-		// Retrieve the timestamp of the cached data using the object cache.
-		AssetLoader* pAssetLoader = AssetLoader::GetStaticInstance();
-		HELIUM_ASSERT( pAssetLoader );
-
+		// Retrieve the content key of the cached data using the object cache.
 		CacheManager& rCacheManager = CacheManager::GetStaticInstance();
-		Cache* pCache = rCacheManager.GetCache(
-			Name( HELIUM_ASSET_CACHE_NAME ),
-			static_cast< Cache::EPlatform >( platformIndex ) );
+		Cache* pCache = rCacheManager.GetCache( Name( HELIUM_ASSET_CACHE_NAME ), platform );
 		HELIUM_ASSERT( pCache );
 		pCache->EnforceTocLoad();
 
 		const Cache::Entry* pCacheEntry = pCache->FindEntry( resourcePath, 0 );
-		if( !pCacheEntry || pCacheEntry->timestamp != timestamp )
+		if( pCacheEntry && pCacheEntry->timestamp == static_cast< int64_t >( contentKeys[ platformIndex ] ) )
 		{
+			// Cached data should be up-to-date, so attempt to load the data from the cache.
+			if( LoadCachedResourceData( resourcePath, pResource, platform ) )
+			{
+				pResource->GetPreprocessedData( platform ).contentKey = contentKeys[ platformIndex ];
+
+				continue;
+			}
+
 			HELIUM_TRACE(
-				TraceLevels::Info,
-				( TXT( "AssetPreprocessor::LoadResourceData(): Cached resource data not found or is out-of-date " )
-				TXT( "for resource \"%s\".  Resource will be preprocessed.\n" ) ),
+				TraceLevels::Warning,
+				( TXT( "AssetPreprocessor::LoadResourceData(): Failed to load cached resource data for " )
+				TXT( "\"%s\".\n" ) ),
 				*resourcePath.ToString() );
-
-			break;
 		}
 
-		// Cached data should be up-to-date, so attempt to load the data from the cache.
-		if( !LoadCachedResourceData( resourcePath, pResource, static_cast< Cache::EPlatform >( platformIndex ) ) )
+		// Check the content store for data preprocessed from the same content elsewhere.
+		if( LoadStoredResourceData( pResource, platform, contentKeys[ platformIndex ] ) )
 		{
 			HELIUM_TRACE(
-				TraceLevels::Warning,
-				( TXT( "AssetPreprocessor::LoadResourceData(): Failed to load cached resource data for " )
-				TXT( "\"%s\".  Resource will be preprocessed again.\n" ) ),
+				TraceLevels::Info,
+				TXT( "AssetPreprocessor::LoadResourceData(): Reusing stored resource data for \"%s\".\n" ),
 				*resourcePath.ToString() );
 
-			break;
+			if( platform == CacheManager::GetStaticInstance().GetCurrentPlatform() )
+			{
+				LoadCurrentPlatformPersistentResourceObject( pResource );
+			}
+
+			continue;
 		}
+
+		HELIUM_TRACE(
+			TraceLevels::Info,
+			( TXT( "AssetPreprocessor::LoadResourceData(): Resource data not found or is out-of-date for resource " )
+			TXT( "\"%s\".  Resource will be preprocessed.\n" ) ),
+			*resourcePath.ToString() );
+
+		// Keep computing the content keys of the remaining platforms, as all platforms will be preprocessed.
+		bPreprocess = true;
 	}
 
-	if( platformIndex >= HELIUM_ARRAY_COUNT( m_pPlatformPreprocessors ) )
+	if( !bPreprocess )
 	{
 		// All supported platforms loaded successfully, so nothing else needs to be done.
 		return;
 	}
 
+	// Queue the resource up for preprocessing later if preprocessing is being deferred and the resource handler can
+	// safely run on other threads.
+	if( m_bDeferPreprocessing )
+	{
+		ResourceHandler* pResourceHandler = ResourceHandler::FindResourceHandlerForType( pResource->GetAssetType() );
+		if( pResourceHandler && pResourceHandler->CanCacheConcurrently() )
+		{
+			DeferredResource* pDeferredResource = m_deferredResources.New();
+			HELIUM_ASSERT( pDeferredResource );
+			pDeferredResource->path = resourcePath;
+			pDeferredResource->spResource = pResource;
+			pDeferredResource->sourceFilePath = sourceFilePath.c_str();
+			MemoryCopy( pDeferredResource->contentKeys, contentKeys, sizeof( contentKeys ) );
+
+			return;
+		}
+	}
+
 	// Preprocess all resources for each supported platform.
 	if( !PreprocessResource( resourcePath, pResource, String( sourceFilePath.c_str() ) ) )
 	{
@@ -418,8 +576,12 @@ void AssetPreprocessor::LoadResourceData( const AssetPath &resourcePath, Resourc
 			TraceLevels::Error,
 			TXT( "AssetPreprocessor::LoadResourceData(): Preprocessing of resource \"%s\" failed.\n" ),
 			*resourcePath.ToString() );
+
+		return;
 	}
 
+	CommitPreprocessedResourceData( pResource, contentKeys );
+
 #else  // HELIUM_TOOLS
 
 	HELIUM_UNREF( pResource );
@@ -483,7 +645,7 @@ uint32_t AssetPreprocessor::LoadPersistentResourceData(
 		return Invalid< uint32_t >();
 	}
 
-	if( pCacheEntry->size < sizeof( uint32_t ) )
+	if( pCacheEntry->uncompressedSize < sizeof( uint32_t ) )
 	{
 		HELIUM_TRACE(
 			TraceLevels::Error,
@@ -494,63 +656,32 @@ uint32_t AssetPreprocessor::LoadPersistentResourceData(
 		return Invalid< uint32_t >();
 	}
 
-	FileStream* pFileStream = FileStream::OpenFileStream( pCache->GetCacheFileName(), FileStream::MODE_READ );
-	if( !pFileStream )
+	DynamicArray< uint8_t > entryData;
+	if( !pCache->ReadEntry( *pCacheEntry, entryData ) )
 	{
 		HELIUM_TRACE(
 			TraceLevels::Error,
-			( TXT( "AssetPreprocessor::LoadPersistentResourceData(): Failed to open cache file \"%s\" for " )
-			TXT( "retrieving cached object data for \"%s\".\n" ) ),
-			*pCache->GetCacheFileName(),
-			*resourcePath.ToString() );
+			( TXT( "AssetPreprocessor::LoadPersistentResourceData(): Failed to read cached object data for " )
+			TXT( "\"%s\" from cache file \"%s\".\n" ) ),
+			*resourcePath.ToString(),
+			*pCache->GetCacheFileName() );
 
 		return Invalid< uint32_t >();
 	}
 
-	BufferedStream bufferedStream( pFileStream );
-
-	int64_t seekLocation = bufferedStream.Seek( pCacheEntry->offset, SeekOrigins::Begin );
-	if( static_cast< uint64_t >( seekLocation ) != pCacheEntry->offset )
-	{
-		HELIUM_TRACE(
-			TraceLevels::Error,
-			( TXT( "AssetPreprocessor::LoadPersistentResourceData(): Failed to seek to byte offset %" ) PRIu64
-			TXT( " in cache file \"%s\" for retrieving cached object data for \"%s\".\n" ) ),
-			pCacheEntry->offset,
-			*pCache->GetCacheFileName(),
-			*resourcePath.ToString() );
-
-		bufferedStream.Close();
-		delete pFileStream;
-
-		return Invalid< uint32_t >();
-	}
+	uint32_t entrySize = static_cast< uint32_t >( entryData.GetSize() );
 
-	ByteSwappingStream byteSwapStream( &bufferedStream );
+	StaticMemoryStream entryStream( entryData.GetData(), entryData.GetSize() );
+	ByteSwappingStream byteSwapStream( &entryStream );
 	Stream* pReadStream =
 		( pPreprocessor->SwapBytes()
 		? static_cast< Stream* >( &byteSwapStream )
-		: static_cast< Stream* >( &bufferedStream ) );
+		: static_cast< Stream* >( &entryStream ) );
 
 	uint32_t propertyDataSize = 0;
-	size_t readCount = pReadStream->Read( &propertyDataSize, sizeof( propertyDataSize ), 1 );
-	if( readCount != 1 )
-	{
-		HELIUM_TRACE(
-			TraceLevels::Error,
-			( TXT( "AssetPreprocessor::LoadPersistentResourceData(): Failed to read the size of the object " )
-			TXT( "property stream for \"%s\" from cache \"%s\".\n" ) ),
-			*resourcePath.ToString(),
-			*pCache->GetCacheFileName() );
-
-		byteSwapStream.Close();
-		bufferedStream.Close();
-		delete pFileStream;
+	pReadStream->Read( &propertyDataSize, sizeof( propertyDataSize ), 1 );
 
-		return Invalid< uint32_t >();
-	}
-
-	if( propertyDataSize > pCacheEntry->size - sizeof( propertyDataSize ) )
+	if( propertyDataSize > entrySize - sizeof( propertyDataSize ) )
 	{
 		HELIUM_TRACE(
 			TraceLevels::Error,
@@ -559,12 +690,12 @@ uint32_t AssetPreprocessor::LoadPersistentResourceData(
 			TXT( "Size will be clamped.\n" ) ),
 			*resourcePath.ToString(),
 			propertyDataSize,
-			pCacheEntry->size );
+			entrySize );
 
-		propertyDataSize = pCacheEntry->size - sizeof( propertyDataSize );
+		propertyDataSize = entrySize - sizeof( propertyDataSize );
 	}
 
-	if( pCacheEntry->size - sizeof( propertyDataSize ) - propertyDataSize < sizeof( uint32_t ) )
+	if( entrySize - sizeof( propertyDataSize ) - propertyDataSize < sizeof( uint32_t ) )
 	{
 		HELIUM_TRACE(
 			TraceLevels::Error,
@@ -572,70 +703,22 @@ uint32_t AssetPreprocessor::LoadPersistentResourceData(
 			TXT( "large enough to provide the resource sub-data count.\n" ) ),
 			*resourcePath.ToString() );
 
-		byteSwapStream.Close();
-		bufferedStream.Close();
-		delete pFileStream;
-
 		return Invalid< uint32_t >();
 	}
 
-	uint64_t newOffset = pCacheEntry->offset + sizeof( propertyDataSize ) + propertyDataSize;
-	seekLocation = bufferedStream.Seek( newOffset, SeekOrigins::Begin );
-	if( static_cast< uint64_t >( seekLocation ) != newOffset )
-	{
-		HELIUM_TRACE(
-			TraceLevels::Error,
-			( TXT( "AssetPreprocessor::LoadPersistentResourceData(): Failed to seek to byte offset %" ) PRIu64
-			TXT( " in cache file \"%s\" for the cached persistent resource data for \"%s\".\n" ) ),
-			newOffset,
-			*pCache->GetCacheFileName(),
-			*resourcePath.ToString() );
-
-		byteSwapStream.Close();
-		bufferedStream.Close();
-		delete pFileStream;
-
-		return Invalid< uint32_t >();
-	}
-
-	size_t resourceDataStreamSize =
-		pCacheEntry->size - sizeof( propertyDataSize ) - propertyDataSize - sizeof( uint32_t );
+	size_t resourceDataOffset = sizeof( propertyDataSize ) + propertyDataSize;
+	size_t resourceDataStreamSize = entrySize - resourceDataOffset - sizeof( uint32_t );
 
 	rPersistentDataBuffer.Reserve( resourceDataStreamSize );
 	rPersistentDataBuffer.Resize( resourceDataStreamSize );
-
-	size_t bytesRead = bufferedStream.Read( rPersistentDataBuffer.GetData(), 1, resourceDataStreamSize );
-	if( bytesRead != resourceDataStreamSize )
-	{
-		HELIUM_TRACE(
-			TraceLevels::Warning,
-			( TXT( "AssetPreprocessor::LoadPersistentResourceData(): Attempted to load %" ) PRIuSZ
-			TXT( " bytes from offset %" ) PRIu64 TXT( " in cache file \"%s\", but only %" ) PRIuSZ
-			TXT( " bytes could be read.\n" ) ),
-			resourceDataStreamSize,
-			newOffset,
-			*pCache->GetCacheFileName(),
-			bytesRead );
-
-		rPersistentDataBuffer.Resize( bytesRead );
-	}
-
 	rPersistentDataBuffer.Trim();
+	MemoryCopy( rPersistentDataBuffer.GetData(), entryData.GetData() + resourceDataOffset, resourceDataStreamSize );
 
 	uint32_t subDataCount = 0;
-	readCount = bufferedStream.Read( &subDataCount, sizeof( subDataCount ), 1 );
-	if( readCount != 1 )
-	{
-		HELIUM_TRACE(
-			TraceLevels::Warning,
-			( TXT( "AssetPreprocessor::LoadPersistentResourceData(): Failed to read resource sub-data count for " )
-			TXT( "\"%s\" from the end of its object data stream.\n" ) ),
-			*resourcePath.ToString() );
-	}
-
-	byteSwapStream.Close();
-	bufferedStream.Close();
-	delete pFileStream;
+	MemoryCopy(
+		&subDataCount,
+		entryData.GetData() + resourceDataOffset + resourceDataStreamSize,
+		sizeof( subDataCount ) );
 
 	return subDataCount;
 }
@@ -735,19 +818,6 @@ bool AssetPreprocessor::LoadCachedResourceData( const AssetPath &path, Resource*
 			return false;
 		}
 
-		FileStream* pFileStream = FileStream::OpenFileStream( resourceCachePath.c_str(), FileStream::MODE_READ );
-		if( !pFileStream )
-		{
-			HELIUM_TRACE(
-				TraceLevels::Error,
-				( TXT( "AssetPreprocessor::LoadCachedResourceData(): Failed to open cache file for cache \"%s\" " )
-				TXT( "for resource \"%s\".\n" ) ),
-				*resourceCacheName,
-				*path.ToString() );
-
-			return false;
-		}
-
 		DynamicArray< DynamicArray< uint8_t > >& rSubDataBuffers = rPreprocessedData.subDataBuffers;
 		rSubDataBuffers.Reserve( subDataCount );
 		rSubDataBuffers.Resize( subDataCount );
@@ -765,56 +835,25 @@ bool AssetPreprocessor::LoadCachedResourceData( const AssetPath &path, Resource*
 					*path.ToString(),
 					*resourceCacheName );
 
-				delete pFileStream;
-
-				return false;
-			}
-
-			int64_t newOffset = pFileStream->Seek( pResourceCacheEntry->offset, SeekOrigins::Begin );
-			if( static_cast< uint64_t >( newOffset ) != pResourceCacheEntry->offset )
-			{
-				HELIUM_TRACE(
-					TraceLevels::Error,
-					( TXT( "AssetPreprocessor::LoadCachedResourceData(): Failed to seek to offset %" ) PRIu64
-					TXT( " in cache \"%s\" when loading sub-data %" ) PRIu32 TXT( " of resource \"%s\".\n" ) ),
-					pResourceCacheEntry->offset,
-					*resourceCacheName,
-					subDataIndex,
-					*path.ToString() );
-
-				delete pFileStream;
-
 				return false;
 			}
 
-			uint32_t subDataSize = pResourceCacheEntry->size;
-
 			DynamicArray< uint8_t >& rSubData = rSubDataBuffers[ subDataIndex ];
-			rSubData.Reserve( subDataSize );
-			rSubData.Resize( subDataSize );
-			rSubData.Trim();
-
-			size_t bytesRead = pFileStream->Read( rSubData.GetData(), 1, subDataSize );
-			if( bytesRead != subDataSize )
+			if( !pResourceCache->ReadEntry( *pResourceCacheEntry, rSubData ) )
 			{
 				HELIUM_TRACE(
 					TraceLevels::Error,
-					( TXT( "AssetPreprocessor::LoadCachedResourceData(): Failed to read %" ) PRIu32
-					TXT( " bytes from cache \"%s\" for sub-data %" ) PRIu32 TXT( " of resource \"%s\" (only %" )
-					PRIuSZ TXT( " bytes read).\n" ) ),
-					subDataSize,
-					*resourceCacheName,
+					( TXT( "AssetPreprocessor::LoadCachedResourceData(): Failed to read sub-data %" ) PRIu32
+					TXT( " of resource \"%s\" from cache \"%s\".\n" ) ),
 					subDataIndex,
 					*path.ToString(),
-					bytesRead );
-
-				delete pFileStream;
+					*resourceCacheName );
 
 				return false;
 			}
-		}
 
-		delete pFileStream;
+			rSubData.Trim();
+		}
 	}
 
 	// Loaded.
@@ -876,6 +915,18 @@ bool AssetPreprocessor::PreprocessResource( const AssetPath &path, Resource* pRe
 		return false;
 	}
 
+	LoadCurrentPlatformPersistentResourceObject( pResource );
+
+	return true;
+}
+
+/// Reload the persistent resource object of a resource from the preprocessed data for the current platform.
+///
+/// @param[in] pResource  Resource to update.
+void AssetPreprocessor::LoadCurrentPlatformPersistentResourceObject( Resource* pResource )
+{
+	HELIUM_ASSERT( pResource );
+
 	// Reserialize the current platform's persistent resource data.
 	CacheManager& rCacheManager = CacheManager::GetStaticInstance();
 	Cache::EPlatform platform = rCacheManager.GetCurrentPlatform();
@@ -896,7 +947,543 @@ bool AssetPreprocessor::PreprocessResource( const AssetPath &path, Resource* pRe
 			}
 		}
 	}
+}
+
+/// Tag newly preprocessed resource data with its content key, and keep a copy of it in the content store.
+///
+/// @param[in] pResource     Preprocessed resource.
+/// @param[in] pContentKeys  Content key of the resource data for each platform.
+void AssetPreprocessor::CommitPreprocessedResourceData( Resource* pResource, const uint64_t* pContentKeys )
+{
+	HELIUM_ASSERT( pResource );
+	HELIUM_ASSERT( pContentKeys );
+
+	for( size_t platformIndex = 0; platformIndex < HELIUM_ARRAY_COUNT( m_pPlatformPreprocessors ); ++platformIndex )
+	{
+		Cache::EPlatform platform = static_cast< Cache::EPlatform >( platformIndex );
+		Resource::PreprocessedData& rPreprocessedData = pResource->GetPreprocessedData( platform );
+		if( !m_pPlatformPreprocessors[ platformIndex ] || !rPreprocessedData.bLoaded )
+		{
+			continue;
+		}
+
+		rPreprocessedData.contentKey = pContentKeys[ platformIndex ];
+		StoreResourceData( pResource, platform, pContentKeys[ platformIndex ] );
+	}
+}
+
+/// Compute the platform-independent part of the content key for a resource.
+///
+/// This covers everything the preprocessed data is built from aside from the platform settings: the source file and
+/// any dependencies reported by the resource handler, the object data of the resource (and of the base resource, if
+/// different), and the resource handler type and version.
+///
+/// @param[in] resourcePath      Path of the resource.
+/// @param[in] baseResourcePath  Path of the base resource from which the source file path was built.
+/// @param[in] pResource         Resource.
+/// @param[in] rSourceFilePath   Source file path.
+///
+/// @return  Source content key.
+///
+/// @see ComputeContentKey()
+uint64_t AssetPreprocessor::ComputeSourceContentKey(
+	const AssetPath& resourcePath,
+	const AssetPath& baseResourcePath,
+	Resource* pResource,
+	const FilePath& rSourceFilePath )
+{
+	HELIUM_ASSERT( pResource );
+
+	uint64_t hash = StableHash::SEED;
+
+	uint32_t keyVersion = CONTENT_KEY_VERSION;
+	hash = StableHash::AddUint32( hash, keyVersion );
+
+	// Include the resource handler and its output version.
+	const AssetType* pResourceType = pResource->GetAssetType();
+	HELIUM_ASSERT( pResourceType );
+
+	Name typeName = pResourceType->GetName();
+	hash = StableHash::AddData( hash, *typeName, StringLength( *typeName ) );
+
+	ResourceHandler* pResourceHandler = ResourceHandler::FindResourceHandlerForType( pResourceType );
+	uint32_t handlerVersion = ( pResourceHandler ? pResourceHandler->GetVersion() : Invalid< uint32_t >() );
+	hash = StableHash::AddUint32( hash, handlerVersion );
+
+	// Include the object data of the resource and of the base resource that provides the source file.
+	hash = HashFileContents( hash, AssetLoader::GetAssetFileSystemPath( resourcePath ) );
+	if( baseResourcePath != resourcePath )
+	{
+		hash = HashFileContents( hash, AssetLoader::GetAssetFileSystemPath( baseResourcePath ) );
+	}
+
+	// Include the source data.
+	hash = HashFileContents( hash, rSourceFilePath );
+
+	if( pResourceHandler )
+	{
+		DynamicArray< FilePath > dependencies;
+		pResourceHandler->GetSourceDependencies( pResource, String( rSourceFilePath.c_str() ), dependencies );
+
+		size_t dependencyCount = dependencies.GetSize();
+		for( size_t dependencyIndex = 0; dependencyIndex < dependencyCount; ++dependencyIndex )
+		{
+			hash = HashFileContents( hash, dependencies[ dependencyIndex ] );
+		}
+	}
+
+	return hash;
+}
+
+/// Compute the content key for the preprocessed data of a resource for a specific platform.
+///
+/// @param[in] sourceContentKey  Platform-independent content key (see ComputeSourceContentKey()).
+/// @param[in] platform          Target platform.
+///
+/// @return  Content key.
+uint64_t AssetPreprocessor::ComputeContentKey( uint64_t sourceContentKey, Cache::EPlatform platform ) const
+{
+	HELIUM_ASSERT( static_cast< size_t >( platform ) < static_cast< size_t >( Cache::PLATFORM_MAX ) );
+
+	PlatformPreprocessor* pPreprocessor = m_pPlatformPreprocessors[ platform ];
+	HELIUM_ASSERT( pPreprocessor );
+
+	uint32_t platformIndex = static_cast< uint32_t >( platform );
+	uint64_t settingsHash = pPreprocessor->GetSettingsHash();
+
+	uint64_t hash = StableHash::AddUint32( sourceContentKey, platformIndex );
+	hash = StableHash::AddData( hash, &settingsHash, sizeof( settingsHash ) );
+
+	return hash;
+}
+
+/// Get the name of the content store file for the given content key.
+///
+/// @param[in]  contentKey  Content key.
+/// @param[out] rFileName   Content store file name.
+void AssetPreprocessor::GetContentStoreFileName( uint64_t contentKey, String& rFileName ) const
+{
+	char keyString[ 32 ];
+	StringPrint( keyString, TXT( "%016" ) PRIx64 TXT( ".bin" ), contentKey );
+	keyString[ HELIUM_ARRAY_COUNT( keyString ) - 1 ] = TXT( '\0' );
+
+	rFileName = m_contentStoreDirectory.c_str();
+	rFileName += keyString;
+}
+
+/// Load the preprocessed data for a resource from the content store.
+///
+/// @param[in] pResource   Resource to load.  The data will be loaded into the proper Resource::PreprocessedData
+///                        structure stored in memory with the resource.
+/// @param[in] platform    Platform for which to load the resource data.
+/// @param[in] contentKey  Content key of the data to load.
+///
+/// @return  True if the data was found in the store and loaded, false if not.
+bool AssetPreprocessor::LoadStoredResourceData( Resource* pResource, Cache::EPlatform platform, uint64_t contentKey )
+{
+	HELIUM_ASSERT( pResource );
+
+	if( m_contentStoreDirectory.Get().empty() )
+	{
+		return false;
+	}
+
+	String fileName;
+	GetContentStoreFileName( contentKey, fileName );
+
+	FileStream* pStream = FileStream::OpenFileStream( fileName, FileStream::MODE_READ );
+	if( !pStream )
+	{
+		return false;
+	}
+
+	int64_t fileSize = pStream->GetSize();
+	DynamicArray< uint8_t > fileData;
+	if( fileSize > 0 && static_cast< uint64_t >( fileSize ) <= UINT32_MAX )
+	{
+		fileData.Resize( static_cast< size_t >( fileSize ) );
+		if( pStream->Read( fileData.GetData(), 1, fileData.GetSize() ) != fileData.GetSize() )
+		{
+			fileData.Clear();
+		}
+	}
+
+	delete pStream;
+
+	// Parse the stored data, treating anything malformed (such as a file from an older version) as a miss.
+	const uint8_t* pCurrent = fileData.GetData();
+	const uint8_t* pEnd = pCurrent + fileData.GetSize();
+
+	uint32_t magic = 0;
+	uint32_t keyVersion = 0;
+	uint64_t storedKey = 0;
+	uint32_t persistentDataSize = 0;
+	if( static_cast< size_t >( pEnd - pCurrent ) < sizeof( magic ) + sizeof( keyVersion ) + sizeof( storedKey ) +
+		sizeof( persistentDataSize ) )
+	{
+		return false;
+	}
+
+	MemoryCopy( &magic, pCurrent, sizeof( magic ) );
+	pCurrent += sizeof( magic );
+	MemoryCopy( &keyVersion, pCurrent, sizeof( keyVersion ) );
+	pCurrent += sizeof( keyVersion );
+	MemoryCopy( &storedKey, pCurrent, sizeof( storedKey ) );
+	pCurrent += sizeof( storedKey );
+	MemoryCopy( &persistentDataSize, pCurrent, sizeof( persistentDataSize ) );
+	pCurrent += sizeof( persistentDataSize );
+
+	if( magic != CONTENT_STORE_MAGIC || keyVersion != CONTENT_KEY_VERSION || storedKey != contentKey ||
+		persistentDataSize > static_cast< size_t >( pEnd - pCurrent ) )
+	{
+		return false;
+	}
+
+	DynamicArray< uint8_t > persistentDataBuffer;
+	persistentDataBuffer.Resize( persistentDataSize );
+	MemoryCopy( persistentDataBuffer.GetData(), pCurrent, persistentDataSize );
+	pCurrent += persistentDataSize;
+
+	uint32_t subDataCount = 0;
+	if( static_cast< size_t >( pEnd - pCurrent ) < sizeof( subDataCount ) )
+	{
+		return false;
+	}
+
+	MemoryCopy( &subDataCount, pCurrent, sizeof( subDataCount ) );
+	pCurrent += sizeof( subDataCount );
+
+	DynamicArray< DynamicArray< uint8_t > > subDataBuffers;
+	for( uint32_t subDataIndex = 0; subDataIndex < subDataCount; ++subDataIndex )
+	{
+		uint32_t subDataSize = 0;
+		if( static_cast< size_t >( pEnd - pCurrent ) < sizeof( subDataSize ) )
+		{
+			return false;
+		}
+
+		MemoryCopy( &subDataSize, pCurrent, sizeof( subDataSize ) );
+		pCurrent += sizeof( subDataSize );
+
+		if( subDataSize > static_cast< size_t >( pEnd - pCurrent ) )
+		{
+			return false;
+		}
+
+		DynamicArray< uint8_t >* pSubData = subDataBuffers.New();
+		HELIUM_ASSERT( pSubData );
+		pSubData->Resize( subDataSize );
+		MemoryCopy( pSubData->GetData(), pCurrent, subDataSize );
+		pCurrent += subDataSize;
+	}
+
+	if( pCurrent != pEnd )
+	{
+		return false;
+	}
+
+	Resource::PreprocessedData& rPreprocessedData = pResource->GetPreprocessedData( platform );
+	rPreprocessedData.persistentDataBuffer = persistentDataBuffer;
+	rPreprocessedData.subDataBuffers = subDataBuffers;
+	rPreprocessedData.contentKey = contentKey;
+	rPreprocessedData.bLoaded = true;
 
 	return true;
 }
+
+/// Write the preprocessed data for a resource to the content store.
+///
+/// The file is replaced atomically, so other processes sharing the store never see partially written data.
+///
+/// @param[in] pResource   Resource whose data should be stored.
+/// @param[in] platform    Platform of the data to store.
+/// @param[in] contentKey  Content key of the data.
+///
+/// @return  True if the data was stored (or the content store is disabled), false if writing failed.
+bool AssetPreprocessor::StoreResourceData( const Resource* pResource, Cache::EPlatform platform, uint64_t contentKey )
+{
+	HELIUM_ASSERT( pResource );
+
+	if( m_contentStoreDirectory.Get().empty() )
+	{
+		return true;
+	}
+
+	const Resource::PreprocessedData& rPreprocessedData = pResource->GetPreprocessedData( platform );
+	HELIUM_ASSERT( rPreprocessedData.bLoaded );
+
+	DynamicArray< uint8_t > fileData;
+	DynamicMemoryStream fileStream( &fileData );
+
+	uint32_t magic = CONTENT_STORE_MAGIC;
+	uint32_t keyVersion = CONTENT_KEY_VERSION;
+	fileStream.Write( &magic, sizeof( magic ), 1 );
+	fileStream.Write( &keyVersion, sizeof( keyVersion ), 1 );
+	fileStream.Write( &contentKey, sizeof( contentKey ), 1 );
+
+	const DynamicArray< uint8_t >& rPersistentDataBuffer = rPreprocessedData.persistentDataBuffer;
+	HELIUM_ASSERT( rPersistentDataBuffer.GetSize() <= UINT32_MAX );
+	uint32_t persistentDataSize = static_cast< uint32_t >( rPersistentDataBuffer.GetSize() );
+	fileStream.Write( &persistentDataSize, sizeof( persistentDataSize ), 1 );
+	fileStream.Write( rPersistentDataBuffer.GetData(), 1, persistentDataSize );
+
+	const DynamicArray< DynamicArray< uint8_t > >& rSubDataBuffers = rPreprocessedData.subDataBuffers;
+	HELIUM_ASSERT( rSubDataBuffers.GetSize() <= UINT32_MAX );
+	uint32_t subDataCount = static_cast< uint32_t >( rSubDataBuffers.GetSize() );
+	fileStream.Write( &subDataCount, sizeof( subDataCount ), 1 );
+
+	for( uint32_t subDataIndex = 0; subDataIndex < subDataCount; ++subDataIndex )
+	{
+		const DynamicArray< uint8_t >& rSubData = rSubDataBuffers[ subDataIndex ];
+		HELIUM_ASSERT( rSubData.GetSize() <= UINT32_MAX );
+		uint32_t subDataSize = static_cast< uint32_t >( rSubData.GetSize() );
+		fileStream.Write( &subDataSize, sizeof( subDataSize ), 1 );
+		fileStream.Write( rSubData.GetData(), 1, subDataSize );
+	}
+
+	fileStream.Close();
+
+	String fileName;
+	GetContentStoreFileName( contentKey, fileName );
+
+	// Resources with identical content share a store file, so serialize writes in case both are preprocessed at once.
+	MutexScopeLock storeLock( m_contentStoreLock );
+
+	if( !Cache::WriteFileAtomic( fileName, fileData.GetData(), fileData.GetSize() ) )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Warning,
+			TXT( "AssetPreprocessor::StoreResourceData(): Failed to write content store file \"%s\".\n" ),
+			*fileName );
+
+		return false;
+	}
+
+	return true;
+}
+
+/// Add the size and contents of a file to a hash (see StableHash).
+///
+/// Missing files are hashed as empty, so a file appearing or disappearing still changes the hash.  The hash of the
+/// file contents is taken from the file hash memo if the file size and time stamp have not changed since the file was
+/// last hashed, in which case the file is not read at all.
+///
+/// @param[in] hash       Current hash value.
+/// @param[in] rFilePath  File to hash.
+///
+/// @return  Updated hash value.
+uint64_t AssetPreprocessor::HashFileContents( uint64_t hash, const FilePath& rFilePath )
+{
+	int64_t fileSize = -1;
+	uint64_t contentHash = StableHash::SEED;
+
+	Status status;
+	if( !rFilePath.Get().empty() && status.Read( rFilePath.c_str() ) )
+	{
+		uint64_t pathHash = StableHash::AddString( StableHash::SEED, rFilePath.c_str() );
+		int64_t fileTimeStamp = static_cast< int64_t >( status.m_ModifiedTime );
+
+		bool bMemoized = false;
+		{
+			MutexScopeLock hashLock( m_fileHashLock );
+
+			HashMap< uint64_t, FileHashEntry >::ConstIterator hashIter = m_fileHashes.Find( pathHash );
+			if( hashIter != m_fileHashes.End() &&
+				hashIter->Second().fileSize == static_cast< int64_t >( status.m_Size ) &&
+				hashIter->Second().fileTimeStamp == fileTimeStamp )
+			{
+				fileSize = hashIter->Second().fileSize;
+				contentHash = hashIter->Second().contentHash;
+				bMemoized = true;
+			}
+		}
+
+		if( !bMemoized )
+		{
+			FileStream* pStream = FileStream::OpenFileStream( String( rFilePath.c_str() ), FileStream::MODE_READ );
+			if( pStream )
+			{
+				fileSize = pStream->GetSize();
+
+				uint8_t buffer[ 16 * 1024 ];
+				for( ; ; )
+				{
+					size_t bytesRead = pStream->Read( buffer, 1, sizeof( buffer ) );
+					if( bytesRead == 0 )
+					{
+						break;
+					}
+
+					contentHash = StableHash::AddData( contentHash, buffer, bytesRead );
+				}
+
+				delete pStream;
+
+				FileHashEntry entry;
+				entry.fileSize = fileSize;
+				entry.fileTimeStamp = fileTimeStamp;
+				entry.contentHash = contentHash;
+
+				MutexScopeLock hashLock( m_fileHashLock );
+
+				HashMap< uint64_t, FileHashEntry >::Iterator hashIter;
+				if( !m_fileHashes.Insert( hashIter, KeyValue< uint64_t, FileHashEntry >( pathHash, entry ) ) )
+				{
+					hashIter->Second() = entry;
+				}
+
+				m_bFileHashesDirty = true;
+			}
+		}
+	}
+
+	hash = StableHash::AddData( hash, &contentHash, sizeof( contentHash ) );
+	hash = StableHash::AddData( hash, &fileSize, sizeof( fileSize ) );
+
+	return hash;
+}
+
+/// Read a value from file hash memo data.
+///
+/// @param[in,out] rpCurrent  Current position in the memo data (advanced past the value if read).
+/// @param[in]     pEnd       End of the memo data.
+/// @param[out]    pValue     Value to fill in.
+/// @param[in]     size       Size of the value, in bytes.
+///
+/// @return  True if the value was read, false if the end of the data was reached.
+static bool ReadFileHashMemoValue( const uint8_t*& rpCurrent, const uint8_t* pEnd, void* pValue, size_t size )
+{
+	if( static_cast< size_t >( pEnd - rpCurrent ) < size )
+	{
+		return false;
+	}
+
+	MemoryCopy( pValue, rpCurrent, size );
+	rpCurrent += size;
+
+	return true;
+}
+
+/// Load the file hash memo file.
+///
+/// A missing or malformed memo (such as one written by an older version) is treated as empty, so every file is hashed
+/// again the first time it is used.
+///
+/// @see SaveFileHashMemo()
+void AssetPreprocessor::LoadFileHashMemo()
+{
+	m_fileHashes.Clear();
+	m_bFileHashesDirty = false;
+
+	if( m_fileHashMemoPath.Get().empty() )
+	{
+		return;
+	}
+
+	FileStream* pStream = FileStream::OpenFileStream( String( m_fileHashMemoPath.c_str() ), FileStream::MODE_READ );
+	if( !pStream )
+	{
+		return;
+	}
+
+	int64_t fileSize = pStream->GetSize();
+	DynamicArray< uint8_t > fileData;
+	if( fileSize > 0 && static_cast< uint64_t >( fileSize ) <= UINT32_MAX )
+	{
+		fileData.Resize( static_cast< size_t >( fileSize ) );
+		if( pStream->Read( fileData.GetData(), 1, fileData.GetSize() ) != fileData.GetSize() )
+		{
+			fileData.Clear();
+		}
+	}
+
+	delete pStream;
+
+	const uint8_t* pCurrent = fileData.GetData();
+	const uint8_t* pEnd = pCurrent + fileData.GetSize();
+
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint32_t entryCount = 0;
+	bool bValid =
+		ReadFileHashMemoValue( pCurrent, pEnd, &magic, sizeof( magic ) ) &&
+		ReadFileHashMemoValue( pCurrent, pEnd, &version, sizeof( version ) ) &&
+		magic == FILE_HASH_MEMO_MAGIC &&
+		version == FILE_HASH_MEMO_VERSION &&
+		ReadFileHashMemoValue( pCurrent, pEnd, &entryCount, sizeof( entryCount ) );
+
+	for( uint32_t entryIndex = 0; bValid && entryIndex < entryCount; ++entryIndex )
+	{
+		uint64_t pathHash = 0;
+		FileHashEntry entry;
+		bValid =
+			ReadFileHashMemoValue( pCurrent, pEnd, &pathHash, sizeof( pathHash ) ) &&
+			ReadFileHashMemoValue( pCurrent, pEnd, &entry.fileSize, sizeof( entry.fileSize ) ) &&
+			ReadFileHashMemoValue( pCurrent, pEnd, &entry.fileTimeStamp, sizeof( entry.fileTimeStamp ) ) &&
+			ReadFileHashMemoValue( pCurrent, pEnd, &entry.contentHash, sizeof( entry.contentHash ) );
+		if( bValid )
+		{
+			HashMap< uint64_t, FileHashEntry >::Iterator hashIter;
+			m_fileHashes.Insert( hashIter, KeyValue< uint64_t, FileHashEntry >( pathHash, entry ) );
+		}
+	}
+
+	if( !bValid )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Info,
+			TXT( "AssetPreprocessor: File hash memo \"%s\" is out of date and will be rebuilt.\n" ),
+			m_fileHashMemoPath.c_str() );
+
+		m_fileHashes.Clear();
+		m_bFileHashesDirty = true;
+	}
+}
+
+/// Write out the file hash memo file.
+///
+/// @see LoadFileHashMemo()
+void AssetPreprocessor::SaveFileHashMemo()
+{
+	if( m_fileHashMemoPath.Get().empty() )
+	{
+		return;
+	}
+
+	MutexScopeLock hashLock( m_fileHashLock );
+
+	DynamicArray< uint8_t > fileData;
+	DynamicMemoryStream fileStream( &fileData );
+
+	uint32_t magic = FILE_HASH_MEMO_MAGIC;
+	uint32_t version = FILE_HASH_MEMO_VERSION;
+	uint32_t entryCount = static_cast< uint32_t >( m_fileHashes.GetSize() );
+	fileStream.Write( &magic, sizeof( magic ), 1 );
+	fileStream.Write( &version, sizeof( version ), 1 );
+	fileStream.Write( &entryCount, sizeof( entryCount ), 1 );
+
+	HashMap< uint64_t, FileHashEntry >::ConstIterator hashEnd = m_fileHashes.End();
+	for( HashMap< uint64_t, FileHashEntry >::ConstIterator hashIter = m_fileHashes.Begin(); hashIter != hashEnd; ++hashIter )
+	{
+		const FileHashEntry& rEntry = hashIter->Second();
+		fileStream.Write( &hashIter->First(), sizeof( uint64_t ), 1 );
+		fileStream.Write( &rEntry.fileSize, sizeof( rEntry.fileSize ), 1 );
+		fileStream.Write( &rEntry.fileTimeStamp, sizeof( rEntry.fileTimeStamp ), 1 );
+		fileStream.Write( &rEntry.contentHash, sizeof( rEntry.contentHash ), 1 );
+	}
+
+	fileStream.Close();
+
+	if( !Cache::WriteFileAtomic( String( m_fileHashMemoPath.c_str() ), fileData.GetData(), fileData.GetSize() ) )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Warning,
+			TXT( "AssetPreprocessor: Failed to write file hash memo \"%s\".\n" ),
+			m_fileHashMemoPath.c_str() );
+
+		return;
+	}
+
+	m_bFileHashesDirty = false;
+}
 #endif  // HELIUM_TOOLS
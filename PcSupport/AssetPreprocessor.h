@@ -2,6 +2,12 @@
 
 #include "PcSupport/PcSupport.h"
 
+#include "Platform/Locks.h"
+
+#include "Foundation/FilePath.h"
+#include "Foundation/HashMap.h"
+
+#include "Engine/Asset.h"
 #include "Engine/Cache.h"
 
 namespace Helium
@@ -11,9 +17,47 @@ namespace Helium
     class PlatformPreprocessor;
 
     /// Asset caching and resource preprocessing interface.
+    ///
+    /// Preprocessed resource data is keyed by content rather than by timestamp: the key for each resource and platform
+    /// hashes the source file and its dependencies, the asset's object data, the resource handler version, and the
+    /// platform preprocessor settings.  Cached data is reused whenever its key matches, and preprocessed data is also
+    /// kept in a local content-addressed store, which can be shared between workspaces (see SetContentStoreDirectory()).
+    ///
+    /// Hashing every source file whenever a resource is loaded would mean reading all source data just to find that the
+    /// cached data is current, so the hash of each file's contents is memoized by path along with the file size and
+    /// modification time.  The memo is saved in the user data directory when the preprocessor is destroyed, and files
+    /// are only read and hashed again once their size or modification time changes.
+    ///
+    /// For batch caching, preprocessing can be deferred (see SetDeferPreprocessing()), in which case resources handled
+    /// by resource handlers that support concurrent caching are queued up instead of being preprocessed while they are
+    /// loaded, so that they can be preprocessed across multiple threads afterward.
     class HELIUM_PC_SUPPORT_API AssetPreprocessor : NonCopyable
     {
     public:
+        /// Content store file magic number.
+        static const uint32_t CONTENT_STORE_MAGIC = 0x52534348;  // 'HCSR'
+        /// Content key format version (incremented whenever the data included in content keys changes).
+        static const uint32_t CONTENT_KEY_VERSION = 2;
+        /// File hash memo file magic number.
+        static const uint32_t FILE_HASH_MEMO_MAGIC = 0x4d484648;  // 'HFHM'
+        /// File hash memo file format version.
+        static const uint32_t FILE_HASH_MEMO_VERSION = 1;
+
+#if HELIUM_TOOLS
+        /// Resource queued for preprocessing while preprocessing is deferred.
+        struct DeferredResource
+        {
+            /// Resource path.
+            AssetPath path;
+            /// Resource (kept loaded until it has been preprocessed).
+            AssetPtr spResource;
+            /// Source file path.
+            String sourceFilePath;
+            /// Content key of the resource data for each platform.
+            uint64_t contentKeys[ Cache::PLATFORM_MAX ];
+        };
+#endif
+
         /// @name Platform Preprocessor Registration
         //@{
         void SetPlatformPreprocessor( Cache::EPlatform platform, PlatformPreprocessor* pPreprocessor );
@@ -30,6 +74,23 @@ namespace Helium
         void LoadResourceData( const AssetPath &path, Resource* pResource );
         //@}
 
+        /// @name Content Store
+        //@{
+        void SetContentStoreDirectory( const FilePath& rDirectory );
+        inline const FilePath& GetContentStoreDirectory() const;
+        //@}
+
+#if HELIUM_TOOLS
+        /// @name Deferred Preprocessing
+        //@{
+        void SetDeferPreprocessing( bool bDefer );
+        inline bool GetDeferPreprocessing() const;
+
+        void TakeDeferredResources( DynamicArray< DeferredResource >& rResources );
+        bool PreprocessDeferredResource( const DeferredResource& rResource );
+        //@}
+#endif
+
         /// @name Static Access
         //@{
         static AssetPreprocessor* CreateStaticInstance();
@@ -41,6 +102,37 @@ namespace Helium
     private:
         /// Platform-specific preprocessing support.
         PlatformPreprocessor* m_pPlatformPreprocessors[ Cache::PLATFORM_MAX ];
+        /// Content-addressed store directory for preprocessed resource data (empty if disabled).
+        FilePath m_contentStoreDirectory;
+        /// Lock held while writing to the content store.
+        Mutex m_contentStoreLock;
+
+#if HELIUM_TOOLS
+        /// True if preprocessing of resources that support concurrent caching should be deferred.
+        bool m_bDeferPreprocessing;
+        /// Resources queued for preprocessing while preprocessing is deferred.
+        DynamicArray< DeferredResource > m_deferredResources;
+
+        /// Memoized hash of a source file's contents.
+        struct FileHashEntry
+        {
+            /// File size, in bytes.
+            int64_t fileSize;
+            /// File time stamp.
+            int64_t fileTimeStamp;
+            /// Hash of the file contents.
+            uint64_t contentHash;
+        };
+
+        /// File hash memo file path (empty if the memo is not persisted).
+        FilePath m_fileHashMemoPath;
+        /// Memoized file content hashes, by hash of the file path.
+        HashMap< uint64_t, FileHashEntry > m_fileHashes;
+        /// Lock held while accessing the file hash memo.
+        Mutex m_fileHashLock;
+        /// True if the file hash memo has changed since it was loaded.
+        bool m_bFileHashesDirty;
+#endif
 
         /// Singleton instance.
         static AssetPreprocessor* sm_pInstance;
@@ -56,6 +148,21 @@ namespace Helium
 #if HELIUM_TOOLS
         bool LoadCachedResourceData( const AssetPath &path, Resource* pResource, Cache::EPlatform platform );
         bool PreprocessResource( const AssetPath &path, Resource* pResource, const String& rSourceFilePath );
+        void LoadCurrentPlatformPersistentResourceObject( Resource* pResource );
+        void CommitPreprocessedResourceData( Resource* pResource, const uint64_t* pContentKeys );
+
+        uint64_t ComputeSourceContentKey(
+            const AssetPath& resourcePath, const AssetPath& baseResourcePath, Resource* pResource,
+            const FilePath& rSourceFilePath );
+        uint64_t ComputeContentKey( uint64_t sourceContentKey, Cache::EPlatform platform ) const;
+
+        void GetContentStoreFileName( uint64_t contentKey, String& rFileName ) const;
+        bool LoadStoredResourceData( Resource* pResource, Cache::EPlatform platform, uint64_t contentKey );
+        bool StoreResourceData( const Resource* pResource, Cache::EPlatform platform, uint64_t contentKey );
+
+        uint64_t HashFileContents( uint64_t hash, const FilePath& rFilePath );
+        void LoadFileHashMemo();
+        void SaveFileHashMemo();
 
         uint32_t LoadPersistentResourceData(
             AssetPath resourcePath, Cache::EPlatform platform, DynamicArray< uint8_t >& rPersistentDataBuffer );
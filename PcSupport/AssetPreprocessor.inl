@@ -13,4 +13,26 @@ namespace Helium
 
         return m_pPlatformPreprocessors[ platform ];
     }
+
+    /// Get the directory of the content-addressed store for preprocessed resource data.
+    ///
+    /// @return  Content store directory, or an empty path if the content store is disabled.
+    ///
+    /// @see SetContentStoreDirectory()
+    const FilePath& AssetPreprocessor::GetContentStoreDirectory() const
+    {
+        return m_contentStoreDirectory;
+    }
+
+#if HELIUM_TOOLS
+    /// Get whether preprocessing of resources that support concurrent caching is currently being deferred.
+    ///
+    /// @return  True if preprocessing is being deferred, false if resources are preprocessed as they are loaded.
+    ///
+    /// @see SetDeferPreprocessing(), TakeDeferredResources()
+    bool AssetPreprocessor::GetDeferPreprocessing() const
+    {
+        return m_bDeferPreprocessing;
+    }
+#endif
 }
@@ -1,12 +1,21 @@
 #include "PcSupportPch.h"
 #include "LooseAssetFileWatcher.h"
 
+#include "Platform/File.h"
+#include "Platform/Timer.h"
 #include "Foundation/DirectoryIterator.h"
 #include "PcSupport/LoosePackageLoader.h"
 #include "Foundation/Log.h"
 #include "Persist/ArchiveJson.h"
 #include "PcSupport/ResourceHandler.h"
 
+#if HELIUM_OS_LINUX
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
 using namespace Helium;
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -27,12 +36,15 @@ inline void SleepBetweenTracking( bool* cancel = NULL, const uint32_t minutes =
 	//	}
 	//}
 
-	Thread::Sleep( 1000 );
+	Thread::Sleep( LooseAssetFileWatcher::POLL_INTERVAL );
 }
 
-LooseAssetFileWatcher::LooseAssetFileWatcher() 
+LooseAssetFileWatcher::LooseAssetFileWatcher()
 : m_StopTracking( false )
 , m_InterruptTracking( 0 )
+#if HELIUM_OS_LINUX
+, m_InotifyDescriptor( -1 )
+#endif
 {
 
 }
@@ -48,7 +60,7 @@ LooseAssetFileWatcher::~LooseAssetFileWatcher()
 void LooseAssetFileWatcher::AddPackage( LoosePackageLoader *pPackageLoader )
 {
 	AtomicIncrement( m_InterruptTracking );
-	SpinLock lock( m_PathsToWatchLock );
+	m_PathsToWatchLock.Lock();
 
 #if HELIUM_ASSERT_ENABLED
 	for ( DynamicArray<WatchedPackage>::Iterator iter = m_PathsToWatch.Begin(); iter != m_PathsToWatch.End(); ++iter )
@@ -61,18 +73,36 @@ void LooseAssetFileWatcher::AddPackage( LoosePackageLoader *pPackageLoader )
 	WatchedPackage *pWatchedPackage = m_PathsToWatch.New();
 	pWatchedPackage->m_Path = pPackageLoader->m_packageDirPath;
 	pWatchedPackage->m_Loader = pPackageLoader;
+	pWatchedPackage->m_WatchDescriptor = -1;
+	pWatchedPackage->m_NeedsScan = true;
+
+#if HELIUM_OS_LINUX
+	if ( m_InotifyDescriptor >= 0 )
+	{
+		AddWatch( *pWatchedPackage );
+	}
+#endif
+
+	m_PathsToWatchLock.Unlock();
 	AtomicDecrement( m_InterruptTracking );
 }
 
 void LooseAssetFileWatcher::RemovePackage( LoosePackageLoader *pPackageLoader )
 {
 	AtomicIncrement( m_InterruptTracking );
-	SpinLock lock( m_PathsToWatchLock );
+	m_PathsToWatchLock.Lock();
 
 	for ( size_t i = 0; i < m_PathsToWatch.GetSize(); ++i)
 	{
 		if (pPackageLoader == m_PathsToWatch[i].m_Loader)
 		{
+#if HELIUM_OS_LINUX
+			if ( m_InotifyDescriptor >= 0 && m_PathsToWatch[i].m_WatchDescriptor >= 0 )
+			{
+				inotify_rm_watch( m_InotifyDescriptor, m_PathsToWatch[i].m_WatchDescriptor );
+			}
+#endif
+
 			m_PathsToWatch.RemoveSwap(i);
 			break;
 		}
@@ -86,6 +116,7 @@ void LooseAssetFileWatcher::RemovePackage( LoosePackageLoader *pPackageLoader )
 	}
 #endif
 
+	m_PathsToWatchLock.Unlock();
 	AtomicDecrement( m_InterruptTracking );
 }
 
@@ -95,6 +126,30 @@ void LooseAssetFileWatcher::StartThread()
 
 	m_StopTracking = false;
 
+#if HELIUM_OS_LINUX
+	// Watch packages with inotify if possible, otherwise everything is polled.
+	HELIUM_ASSERT( m_InotifyDescriptor < 0 );
+	m_InotifyDescriptor = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+	if ( m_InotifyDescriptor < 0 )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Warning,
+			TXT( "LooseAssetFileWatcher: Failed to initialize inotify (error %d), falling back to polling.\n" ),
+			errno );
+	}
+	else
+	{
+		m_PathsToWatchLock.Lock();
+
+		for ( DynamicArray<WatchedPackage>::Iterator iter = m_PathsToWatch.Begin(); iter != m_PathsToWatch.End(); ++iter )
+		{
+			AddWatch( *iter );
+		}
+
+		m_PathsToWatchLock.Unlock();
+	}
+#endif
+
 	Helium::CallbackThread::Entry entry = &Helium::CallbackThread::EntryHelper<LooseAssetFileWatcher, &LooseAssetFileWatcher::TrackEverything>;
 	if ( !m_Thread.Create( entry, this, TXT( "LooseAssetFileWatcher Thread" ), ThreadPriorities::Low ) )
 	{
@@ -109,12 +164,182 @@ void LooseAssetFileWatcher::StopThread()
 	m_StopTracking = true;
 
 	m_Thread.Join();
+
+#if HELIUM_OS_LINUX
+	if ( m_InotifyDescriptor >= 0 )
+	{
+		// Closing the inotify instance removes all of its watches.
+		close( m_InotifyDescriptor );
+		m_InotifyDescriptor = -1;
+
+		m_PathsToWatchLock.Lock();
+
+		for ( DynamicArray<WatchedPackage>::Iterator iter = m_PathsToWatch.Begin(); iter != m_PathsToWatch.End(); ++iter )
+		{
+			iter->m_WatchDescriptor = -1;
+			iter->m_NeedsScan = true;
+			iter->m_PendingFiles.Clear();
+		}
+
+		m_PathsToWatchLock.Unlock();
+	}
+#endif
 }
 
 void LooseAssetFileWatcher::TrackEverything()
 {
 	m_StopTracking = false;
 
+#if HELIUM_OS_LINUX
+	if ( m_InotifyDescriptor >= 0 )
+	{
+		TrackInotify();
+		return;
+	}
+#endif
+
+	TrackPolling();
+}
+
+/// Scan all files in a package directory for changes.
+///
+/// @param[in] rPackage  Package to scan.
+///
+/// @return  True if the scan completed, false if it was cut short by the thread stopping or being interrupted.
+bool LooseAssetFileWatcher::ScanPackage( WatchedPackage& rPackage )
+{
+	//Log::Print( Log::Levels::Default, TXT("Tracker: Scanning package %s\n"), rPackage.m_Path.c_str() );
+
+	Helium::DirectoryIterator directory( rPackage.m_Path );
+
+	// For each file
+	for( ; !directory.IsDone(); directory.Next() )
+	{
+		// If our thread is supposed to die, bail early
+		if ( m_StopTracking || m_InterruptTracking != 0 )
+		{
+			return false;
+		}
+
+		const DirectoryIteratorItem& item = directory.GetItem();
+		CheckFile( rPackage, item.m_Path, static_cast<int64_t>( item.m_ModTime ) );
+	}
+
+	rPackage.m_NeedsScan = false;
+
+	return true;
+}
+
+/// Check whether a file in a package directory is new or has changed since it was loaded, queuing a notification if
+/// so.
+///
+/// @param[in] rPackage   Package containing the file.
+/// @param[in] rFilePath  Path of the file.
+/// @param[in] modTime    File modification time.
+void LooseAssetFileWatcher::CheckFile( WatchedPackage& rPackage, const FilePath& rFilePath, int64_t modTime )
+{
+	Name objectName;
+	size_t objectIndex = Invalid< size_t >();
+
+	if ( rFilePath.IsDirectory() )
+	{
+		// Skip directories
+		return;
+	}
+	else if ( rFilePath.Extension() == Persist::ArchiveExtensions[ Persist::ArchiveTypes::Json ] )
+	{
+		// JSON files get handled special
+		objectName.Set( rFilePath.Basename().c_str() );
+		objectIndex = rPackage.m_Loader->FindObjectByName( objectName );
+	}
+	else
+	{
+		// See if it's a raw asset that we can handle
+		String objectNameString( rFilePath.Filename().c_str() );
+
+		ResourceHandler* pBestHandler = ResourceHandler::GetBestResourceHandlerForFile( objectNameString );
+
+		if (!pBestHandler)
+		{
+			// We don't know what this file is.. skip it
+			return;
+		}
+
+		objectName.Set( rFilePath.Filename().c_str() );
+		objectIndex = rPackage.m_Loader->FindObjectByName( objectName );
+	}
+
+	// If the package says it loaded something as fresh as the file, do nothing
+	if ( objectIndex != Invalid< size_t >() &&
+		rPackage.m_Loader->m_objects[objectIndex].fileTimeStamp >= modTime)
+	{
+		return;
+	}
+
+	// If we have already emitted a message for this object, skip it
+	HashMap< Name, WatchedAsset >::Iterator watchedAssetItr = rPackage.m_Assets.Find( objectName );
+	if (watchedAssetItr != rPackage.m_Assets.End())
+	{
+		if (watchedAssetItr->Second().m_LastMessageTime >= modTime )
+		{
+			// We already emitted a message for this file change, so don't do anything
+			return;
+		}
+
+		// We've emitted a message, but it's been modified again. Emit another message and update the timestamp
+		watchedAssetItr->Second().m_LastMessageTime = modTime;
+	}
+	else
+	{
+		// We've never emitted a message, so record that we will
+		WatchedAsset watchedAsset;
+		watchedAsset.m_LastMessageTime = modTime;
+
+		rPackage.m_Assets.Insert(
+			watchedAssetItr,
+			KeyValue< Name, WatchedAsset >( objectName, watchedAsset ) );
+	}
+
+	// We know the file is changed and we should throw an event.. choose a different event based on new vs. changed
+	if (objectIndex != Invalid< size_t >())
+	{
+		m_ChangeNotifications.Add( rPackage.m_Loader->GetAssetPath( objectIndex ) );
+	}
+	else
+	{
+		AssetPath path;
+		path.Set( objectName, false, rPackage.m_Loader->GetPackagePath());
+
+		m_NewNotifications.Add( path );
+	}
+}
+
+/// Send out the notifications queued for changed and new assets, reloading the changed assets.
+void LooseAssetFileWatcher::DispatchNotifications()
+{
+	for ( DynamicArray<AssetPath>::Iterator changedAssetIter = m_ChangeNotifications.Begin(); changedAssetIter != m_ChangeNotifications.End(); ++changedAssetIter )
+	{
+		HELIUM_TRACE( TraceLevels::Info, TXT(" %s IS MODIFIED\n"), *changedAssetIter->ToString());
+		AssetTracker::GetStaticInstance()->NotifyAssetChangedExternally( *changedAssetIter );
+
+		AssetPtr asset;
+		AssetLoader::GetStaticInstance()->LoadObject( *changedAssetIter, asset, true );
+		Asset::ReplaceAsset( asset.Get(), *changedAssetIter );
+	}
+
+	for ( DynamicArray<AssetPath>::Iterator newAssetIter = m_NewNotifications.Begin(); newAssetIter != m_NewNotifications.End(); ++newAssetIter )
+	{
+		HELIUM_TRACE( TraceLevels::Info, TXT(" %s IS MODIFIED\n"), *newAssetIter->ToString());
+		AssetTracker::GetStaticInstance()->NotifyAssetCreatedExternally( *newAssetIter );
+	}
+
+	m_ChangeNotifications.Clear();
+	m_NewNotifications.Clear();
+}
+
+/// Tracking loop used when change events are not available, rescanning every package directory on a timer.
+void LooseAssetFileWatcher::TrackPolling()
+{
 	AssetAwareThreadSynchronizer assetSync;
 
 	while ( !m_StopTracking )
@@ -124,146 +349,262 @@ void LooseAssetFileWatcher::TrackEverything()
 		// Do this once outside the inner loop in case we are iterating over nothing
 		assetSync.Sync();
 
+		m_PathsToWatchLock.Lock();
+
+		// Go through all the packages we're tracking
+		for ( DynamicArray<WatchedPackage>::Iterator packageIter = m_PathsToWatch.Begin(); packageIter != m_PathsToWatch.End(); ++packageIter )
 		{
-			SpinLock lock( m_PathsToWatchLock );
+			assetSync.Sync();
 
-			// Go through all the packages we're tracking
-			for ( DynamicArray<WatchedPackage>::Iterator packageIter = m_PathsToWatch.Begin(); packageIter != m_PathsToWatch.End(); ++packageIter )
+			if ( !ScanPackage( *packageIter ) )
 			{
-				assetSync.Sync();
+				// Our thread is supposed to die, bail early
+				break;
+			}
+		}
+
+		m_PathsToWatchLock.Unlock();
+
+		DispatchNotifications();
+
+		if ( !m_StopTracking )
+		{
+			// Sleep between runs and yield to other threads
+			// The complex loop is to prevent Editor from hanging on exit (max hang will be "increments" seconds)
+			SleepBetweenTracking( &m_StopTracking );
+		}
+	}
+}
+
+#if HELIUM_OS_LINUX
+/// Start watching a package directory with inotify, falling back to polling the directory if it cannot be watched.
+///
+/// @param[in] rPackage  Package to watch.
+void LooseAssetFileWatcher::AddWatch( WatchedPackage& rPackage )
+{
+	HELIUM_ASSERT( m_InotifyDescriptor >= 0 );
+
+	rPackage.m_WatchDescriptor = inotify_add_watch(
+		m_InotifyDescriptor,
+		rPackage.m_Path.c_str(),
+		IN_CREATE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVED_TO );
+	if ( rPackage.m_WatchDescriptor < 0 )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Warning,
+			TXT( "LooseAssetFileWatcher: Failed to watch \"%s\" (error %d), falling back to polling.\n" ),
+			rPackage.m_Path.c_str(),
+			errno );
+	}
+
+	// Catch anything that changed before the watch was added.
+	rPackage.m_NeedsScan = true;
+}
 
-				//Log::Print( Log::Levels::Default, TXT("Tracker: Scanning package %s\n"), packageIter->m_Path.c_str() );
+/// Tracking loop used with inotify.  Change events for each file are collected as they arrive, and files are checked
+/// once their events have settled.  Packages that could not be watched are rescanned on the polling timer.
+void LooseAssetFileWatcher::TrackInotify()
+{
+	AssetAwareThreadSynchronizer assetSync;
 
-				SimpleTimer packageTimer;
-				Helium::DirectoryIterator directory( packageIter->m_Path );
+	uint64_t lastPollTicks = Timer::GetTickCount();
 
-				// For each file
-				for( ; !directory.IsDone(); directory.Next() )
+	while ( !m_StopTracking )
+	{
+		assetSync.Sync();
+
+		uint64_t currentTicks = Timer::GetTickCount();
+		bool bPollDue = ( Timer::TicksToMilliseconds( currentTicks - lastPollTicks ) >= static_cast< float >( POLL_INTERVAL ) );
+		if ( bPollDue )
+		{
+			lastPollTicks = currentTicks;
+		}
+
+		uint64_t nextCheckTicks = lastPollTicks + ( Timer::GetTicksPerSecond() * POLL_INTERVAL ) / 1000;
+
+		m_PathsToWatchLock.Lock();
+
+		for ( DynamicArray<WatchedPackage>::Iterator packageIter = m_PathsToWatch.Begin(); packageIter != m_PathsToWatch.End(); ++packageIter )
+		{
+			if ( m_StopTracking || m_InterruptTracking != 0 )
+			{
+				break;
+			}
+
+			if ( packageIter->m_NeedsScan || ( packageIter->m_WatchDescriptor < 0 && bPollDue ) )
+			{
+				// A full scan covers any pending events as well.
+				if ( ScanPackage( *packageIter ) )
 				{
-					// If our thread is supposed to die, bail early
-					if ( m_StopTracking )
-					{
-						break;
-					}
-
-					const DirectoryIteratorItem& item = directory.GetItem();
-
-					bool isNewFile = true;
-					bool isChangedFile = false;
-
-					Name objectName;
-					size_t objectIndex = Invalid< size_t >();
-
-					if ( item.m_Path.IsDirectory() )
-					{
-						// Skip directories
-						continue;
-					}
-					else if ( item.m_Path.Extension() == Persist::ArchiveExtensions[ Persist::ArchiveTypes::Json ] )
-					{
-						// JSON files get handled special
-						objectName.Set( item.m_Path.Basename().c_str() );
-						objectIndex = packageIter->m_Loader->FindObjectByName( objectName );
-					}
-					else
-					{
-						// See if it's a raw asset that we can handle
-						String objectNameString( item.m_Path.Filename().c_str() );
-
-						ResourceHandler* pBestHandler = ResourceHandler::GetBestResourceHandlerForFile( objectNameString );
-
-						if (!pBestHandler)
-						{
-							// We don't know what this file is.. skip it
-							continue;
-						}
-
-						objectName.Set( item.m_Path.Filename().c_str() );
-						objectIndex = packageIter->m_Loader->FindObjectByName( objectName );
-					}
-
-					// If the package says it loaded something as fresh as the file, do nothing
-					if ( objectIndex != Invalid< size_t >() &&
-						packageIter->m_Loader->m_objects[objectIndex].fileTimeStamp >= static_cast<int64_t>( directory.GetItem().m_ModTime ))
-					{
-						continue;
-					}
-
-					// If we have already emitted a message for this object, skip it
-					HashMap< Name, WatchedAsset >::Iterator watchedAssetItr = packageIter->m_Assets.Find( objectName );
-					if (watchedAssetItr != packageIter->m_Assets.End())
-					{
-						if (watchedAssetItr->Second().m_LastMessageTime >= static_cast<int64_t>( directory.GetItem().m_ModTime ) )
-						{
-							// We already emitted a message for this file change, so don't do anything
-							continue;
-						}
-
-						// We've emitted a message, but it's been modified again. Emit another message and update the timestamp
-						watchedAssetItr->Second().m_LastMessageTime = static_cast<int64_t>( directory.GetItem().m_ModTime );
-					}
-					else
-					{
-						// We've never emitted a message, so record that we will
-						WatchedAsset watchedAsset;
-						watchedAsset.m_LastMessageTime = static_cast<int64_t>( directory.GetItem().m_ModTime );
-
-						packageIter->m_Assets.Insert(
-							watchedAssetItr, 
-							KeyValue< Name, WatchedAsset >( objectName, watchedAsset ) );
-					}
-				
-					// We know the file is changed and we should throw an event.. choose a different event based on new vs. changed
-					if (objectIndex != Invalid< size_t >())
-					{
-						m_ChangeNotifications.Add( packageIter->m_Loader->GetAssetPath( objectIndex ) );
-					}
-					else
-					{
-						AssetPath path;
-						path.Set( objectName, false, packageIter->m_Loader->GetPackagePath());
-
-						m_NewNotifications.Add( path );
-					}
+					packageIter->m_PendingFiles.Clear();
 				}
 
-				if ( m_StopTracking || m_InterruptTracking != 0 )
+				continue;
+			}
+
+			CheckPendingFiles( *packageIter, currentTicks, nextCheckTicks );
+		}
+
+		m_PathsToWatchLock.Unlock();
+
+		DispatchNotifications();
+
+		if ( m_StopTracking )
+		{
+			break;
+		}
+
+		// Wait for more events, waking up when the next pending file is due to be checked or polled packages are due to
+		// be rescanned.
+		currentTicks = Timer::GetTickCount();
+		int timeout = 0;
+		if ( nextCheckTicks > currentTicks )
+		{
+			timeout = static_cast< int >( Timer::TicksToMilliseconds( nextCheckTicks - currentTicks ) ) + 1;
+			timeout = Min( timeout, static_cast< int >( POLL_INTERVAL ) );
+		}
+
+		pollfd pollDescriptor;
+		pollDescriptor.fd = m_InotifyDescriptor;
+		pollDescriptor.events = POLLIN;
+		pollDescriptor.revents = 0;
+		if ( poll( &pollDescriptor, 1, timeout ) > 0 )
+		{
+			ReadInotifyEvents();
+		}
+	}
+}
+
+/// Read all available inotify events, recording the files they refer to as pending a check.
+void LooseAssetFileWatcher::ReadInotifyEvents()
+{
+	// Buffer large enough for a good number of events, aligned for reading inotify_event structures.
+	union
+	{
+		inotify_event event;
+		char buffer[ 16 * 1024 ];
+	} eventData;
+
+	for ( ; ; )
+	{
+		ssize_t bytesRead = read( m_InotifyDescriptor, eventData.buffer, sizeof( eventData.buffer ) );
+		if ( bytesRead <= 0 )
+		{
+			// EAGAIN once all events have been read.
+			break;
+		}
+
+		uint64_t eventTicks = Timer::GetTickCount();
+
+		m_PathsToWatchLock.Lock();
+
+		for ( const char* pEventData = eventData.buffer; pEventData < eventData.buffer + bytesRead; )
+		{
+			const inotify_event* pEvent = reinterpret_cast< const inotify_event* >( pEventData );
+			pEventData += sizeof( inotify_event ) + pEvent->len;
+
+			if ( pEvent->mask & IN_Q_OVERFLOW )
+			{
+				// Events were lost, so rescan everything.
+				for ( DynamicArray<WatchedPackage>::Iterator packageIter = m_PathsToWatch.Begin(); packageIter != m_PathsToWatch.End(); ++packageIter )
 				{
-					// Our thread is supposed to die, bail early
-					//Log::Print( Log::Levels::Default, TXT("Tracker: Pre-empted after %.2fm\n"), packageTimer.Elapsed() / 1000.f / 60.f );
-					break;
+					packageIter->m_NeedsScan = true;
 				}
-				else 
+
+				continue;
+			}
+
+			WatchedPackage* pPackage = NULL;
+			for ( DynamicArray<WatchedPackage>::Iterator packageIter = m_PathsToWatch.Begin(); packageIter != m_PathsToWatch.End(); ++packageIter )
+			{
+				if ( packageIter->m_WatchDescriptor == pEvent->wd )
 				{
-					//Log::Print( Log::Levels::Default, TXT("Tracker: Package scanned in %.2fm\n") , packageTimer.Elapsed() / 1000.f / 60.f );
+					pPackage = &*packageIter;
+					break;
 				}
 			}
-		}
 
-		for ( DynamicArray<AssetPath>::Iterator changedAssetIter = m_ChangeNotifications.Begin(); changedAssetIter != m_ChangeNotifications.End(); ++changedAssetIter )
-		{
-			HELIUM_TRACE( TraceLevels::Info, TXT(" %s IS MODIFIED\n"), *changedAssetIter->ToString());
-			AssetTracker::GetStaticInstance()->NotifyAssetChangedExternally( *changedAssetIter );
+			if ( !pPackage )
+			{
+				// Package was removed after the event was queued.
+				continue;
+			}
 
-			AssetPtr asset;
-			AssetLoader::GetStaticInstance()->LoadObject( *changedAssetIter, asset, true );
-			Asset::ReplaceAsset( asset.Get(), *changedAssetIter );
+			if ( pEvent->mask & IN_IGNORED )
+			{
+				// The watch was removed (such as when the directory is deleted), so poll the package from now on.
+				pPackage->m_WatchDescriptor = -1;
+				pPackage->m_NeedsScan = true;
+
+				continue;
+			}
+
+			if ( pEvent->len == 0 || ( pEvent->mask & IN_ISDIR ) )
+			{
+				continue;
+			}
+
+			// Coalesce events for the same file, pushing back the time at which it will be checked.
+			Name fileName( pEvent->name );
+			HashMap< Name, uint64_t >::Iterator pendingIter = pPackage->m_PendingFiles.Find( fileName );
+			if ( pendingIter != pPackage->m_PendingFiles.End() )
+			{
+				pendingIter->Second() = eventTicks;
+			}
+			else
+			{
+				pPackage->m_PendingFiles.Insert( pendingIter, KeyValue< Name, uint64_t >( fileName, eventTicks ) );
+			}
 		}
 
-		for ( DynamicArray<AssetPath>::Iterator newAssetIter = m_NewNotifications.Begin(); newAssetIter != m_NewNotifications.End(); ++newAssetIter )
+		m_PathsToWatchLock.Unlock();
+	}
+}
+
+/// Check the files in a package with pending change events that have had no further events for DEBOUNCE_INTERVAL
+/// milliseconds.
+///
+/// @param[in]     rPackage         Package to update.
+/// @param[in]     currentTicks     Current tick count.
+/// @param[in,out] rNextCheckTicks  Tick count at which pending files next need to be checked.  This is moved earlier
+///                                 if any files in this package will be due before then.
+void LooseAssetFileWatcher::CheckPendingFiles( WatchedPackage& rPackage, uint64_t currentTicks, uint64_t& rNextCheckTicks )
+{
+	if ( rPackage.m_PendingFiles.GetSize() == 0 )
+	{
+		return;
+	}
+
+	const uint64_t debounceTicks = ( Timer::GetTicksPerSecond() * DEBOUNCE_INTERVAL ) / 1000;
+
+	DynamicArray< Name > readyFiles;
+	for ( HashMap< Name, uint64_t >::Iterator pendingIter = rPackage.m_PendingFiles.Begin(); pendingIter != rPackage.m_PendingFiles.End(); ++pendingIter )
+	{
+		uint64_t dueTicks = pendingIter->Second() + debounceTicks;
+		if ( dueTicks <= currentTicks )
+		{
+			readyFiles.Add( pendingIter->First() );
+		}
+		else if ( dueTicks < rNextCheckTicks )
 		{
-			HELIUM_TRACE( TraceLevels::Info, TXT(" %s IS MODIFIED\n"), *newAssetIter->ToString());
-			AssetTracker::GetStaticInstance()->NotifyAssetCreatedExternally( *newAssetIter );
+			rNextCheckTicks = dueTicks;
 		}
+	}
 
-		m_ChangeNotifications.Clear();
-		m_NewNotifications.Clear();
+	for ( DynamicArray< Name >::Iterator fileIter = readyFiles.Begin(); fileIter != readyFiles.End(); ++fileIter )
+	{
+		rPackage.m_PendingFiles.Remove( *fileIter );
 
-		if ( !m_StopTracking )
+		FilePath filePath( rPackage.m_Path + **fileIter );
+
+		Status status;
+		if ( !status.Read( filePath.c_str() ) )
 		{
-			// Sleep between runs and yield to other threads
-			// The complex loop is to prevent Editor from hanging on exit (max hang will be "increments" seconds)
-			SleepBetweenTracking( &m_StopTracking );
+			// File was removed again before it could be checked.
+			continue;
 		}
+
+		CheckFile( rPackage, filePath, status.m_ModifiedTime );
 	}
-}
\ No newline at end of file
+}
+#endif  // HELIUM_OS_LINUX
@@ -4,9 +4,21 @@ namespace Helium
 {
 	class LoosePackageLoader;
 
+	/// Watches the directories of loose packages for changes to asset files, notifying the AssetTracker of changed and
+	/// new assets and reloading changed assets.
+	///
+	/// On Linux, changes are reported by inotify as they happen.  Bursts of events for the same file are coalesced, with
+	/// each file only checked once no further events for it have arrived for DEBOUNCE_INTERVAL milliseconds.  Other
+	/// platforms, and package directories that cannot be watched (such as when the inotify watch limit has been
+	/// reached), fall back to rescanning the package directories every POLL_INTERVAL milliseconds.
 	class HELIUM_PC_SUPPORT_API LooseAssetFileWatcher
 	{
 	public:
+		/// Interval (in milliseconds) between rescans of package directories that are polled for changes.
+		static const uint32_t POLL_INTERVAL = 1000;
+		/// Time (in milliseconds) to wait after the last change event for a file before checking the file.
+		static const uint32_t DEBOUNCE_INTERVAL = 50;
+
 		LooseAssetFileWatcher();
 		virtual ~LooseAssetFileWatcher();
 
@@ -35,6 +47,13 @@ namespace Helium
 			LoosePackageLoader *m_Loader;
 
 			HashMap< Name, WatchedAsset > m_Assets;
+
+			/// inotify watch descriptor for the package directory, or -1 if the directory is polled.
+			int m_WatchDescriptor;
+			/// True if the package directory needs a full scan (when first watched, or after events were lost).
+			bool m_NeedsScan;
+			/// Names of files with unchecked change events, mapped to the tick count of the latest event.
+			HashMap< Name, uint64_t > m_PendingFiles;
 		};
 
 		DynamicArray<WatchedPackage> m_PathsToWatch;
@@ -42,6 +61,23 @@ namespace Helium
 
 		DynamicArray<AssetPath> m_ChangeNotifications;
 		DynamicArray<AssetPath> m_NewNotifications;
+
+#if HELIUM_OS_LINUX
+		/// inotify instance file descriptor, or -1 if inotify is not in use.
+		int m_InotifyDescriptor;
+#endif
+
+		bool ScanPackage( WatchedPackage& rPackage );
+		void CheckFile( WatchedPackage& rPackage, const FilePath& rFilePath, int64_t modTime );
+		void DispatchNotifications();
+		void TrackPolling();
+
+#if HELIUM_OS_LINUX
+		void AddWatch( WatchedPackage& rPackage );
+		void TrackInotify();
+		void ReadInotifyEvents();
+		void CheckPendingFiles( WatchedPackage& rPackage, uint64_t currentTicks, uint64_t& rNextCheckTicks );
+#endif
 	};
 }
 
@@ -69,6 +69,14 @@ void LooseAssetLoader::TickPackageLoaders()
 /// @copydoc AssetLoader::OnLoadComplete()
 void LooseAssetLoader::OnLoadComplete( const AssetPath &path, Asset* pAsset, PackageLoader* /*pPackageLoader*/ )
 {
+	// While resource preprocessing is deferred, the resource data may not be ready yet, so caching is left to whoever
+	// is driving the batch (see AssetCooker).
+	AssetPreprocessor* pAssetPreprocessor = AssetPreprocessor::GetStaticInstance();
+	if( pAssetPreprocessor && pAssetPreprocessor->GetDeferPreprocessing() )
+	{
+		return;
+	}
+
 	if( pAsset )
 	{
 		CacheObject( pAsset, true );
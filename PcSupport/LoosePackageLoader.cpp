@@ -11,6 +11,8 @@
 #include "Engine/Config.h"
 #include "Engine/AssetLoader.h"
 #include "Engine/Resource.h"
+#include "Engine/StableHash.h"
+#include "Engine/TaskDispatcher.h"
 #include "PcSupport/AssetPreprocessor.h"
 #include "PcSupport/ResourceHandler.h"
 #include "Reflect/TranslatorDeduction.h"
@@ -18,6 +20,8 @@
 
 #include "LooseAssetLoader.h"
 
+#include <string.h>
+
 using namespace Helium;
 
 /// Constructor.
@@ -25,6 +29,9 @@ LoosePackageLoader::LoosePackageLoader()
 	: m_startPreloadCounter( 0 )
 	, m_preloadedCounter( 0 )
 	, m_loadRequestPool( LOAD_REQUEST_POOL_BLOCK_SIZE )
+	, m_bIndexDirty( false )
+	, m_pFileDataBuffer( NULL )
+	, m_fileDataReferenceCount( 0 )
 	, m_parentPackageLoadId( Invalid< size_t >() )
 	//, m_pTocLoadBuffer( 0 )
 	//, m_tocAsyncLoadId( Invalid<size_t>() )
@@ -131,6 +138,24 @@ bool LoosePackageLoader::Initialize( AssetPath packagePath )
 
 	// First do this check without a trailing "/" so that FilePath has to actually look at the file system
 	FilePath package_dir = dataDirectory + packagePath.ToFilePathString().GetData();
+
+	// The package index is kept with the user data so that the data directory is never written to.  Its name includes
+	// a hash of the package directory, so that the same package in different data directories (such as separate
+	// checkouts sharing a user data directory) each gets its own index.
+	FilePath userDataDirectory;
+	if ( FileLocations::GetUserDataDirectory( userDataDirectory ) )
+	{
+		FilePath packageDirPath = package_dir + TXT("/");
+
+		char directoryHash[ 32 ];
+		StringPrint(
+			directoryHash,
+			TXT( ".%016" ) PRIx64 TXT( ".index" ),
+			StableHash::AddString( StableHash::SEED, packageDirPath.c_str() ) );
+		directoryHash[ HELIUM_ARRAY_COUNT( directoryHash ) - 1 ] = TXT( '\0' );
+
+		m_indexFilePath = userDataDirectory + TXT( "PackageIndex/" ) + packagePath.ToFilePathString().GetData() + directoryHash;
+	}
 	
 	if (!package_dir.Exists())
 	{
@@ -187,12 +212,43 @@ void LoosePackageLoader::Shutdown()
 		{
 			LoadRequest* pRequest = m_loadRequests[ requestIndex ];
 			HELIUM_ASSERT( pRequest );
+
+			// Deserialization tasks read from the request buffers, so let any in progress finish first.  Help run
+			// pending tasks where possible (the task may be queued behind this thread), otherwise sleep until the
+			// task reports progress.
+			AsyncLoader& rAsyncLoader = AsyncLoader::GetStaticInstance();
+			for( ; ; )
+			{
+				uint32_t progressCount = rAsyncLoader.GetProgressCount();
+				if( pRequest->deserializeState != DESERIALIZE_STATE_PENDING )
+				{
+					break;
+				}
+
+				if( TaskDispatcher::TryRunPendingTask() )
+				{
+					continue;
+				}
+
+				rAsyncLoader.WaitForProgress( progressCount, AssetLoader::FINISH_LOAD_TICK_INTERVAL );
+			}
+
+			pRequest->deferredResolver.Clear();
+
 			m_loadRequestPool.Release( pRequest );
 		}
 	}
 
 	m_loadRequests.Clear();
 
+	DefaultAllocator().Free( m_pFileDataBuffer );
+	m_pFileDataBuffer = NULL;
+	m_fileDataReferenceCount = 0;
+
+	m_indexEntries.Clear();
+	m_indexFilePath.Clear();
+	m_bIndexDirty = false;
+
 	m_packageDirPath.Clear();
 }
 
@@ -237,9 +293,14 @@ bool LoosePackageLoader::BeginPreload()
 	}
 	else
 	{
+		LoadPackageIndex();
+
 		DirectoryIterator packageDirectory( m_packageDirPath );
 
-		HELIUM_TRACE( TraceLevels::Info, TXT(" LoosePackageLoader::BeginPreload - Issuing read requests for all files in %s\n"), m_packageDirPath.c_str() );
+		HELIUM_TRACE( TraceLevels::Info, TXT(" LoosePackageLoader::BeginPreload - Issuing read requests for changed files in %s\n"), m_packageDirPath.c_str() );
+
+		size_t fileDataSize = 0;
+		size_t indexedObjectCount = 0;
 
 		for( ; !packageDirectory.IsDone(); packageDirectory.Next() )
 		{
@@ -258,30 +319,94 @@ bool LoosePackageLoader::BeginPreload()
 #endif
 			if ( item.m_Path.Extension() == Persist::ArchiveExtensions[ Persist::ArchiveTypes::Json ] )
 			{
-				HELIUM_TRACE( TraceLevels::Info, TXT("- Reading file [%s]\n"), item.m_Path.c_str() );
+				// Files that have not changed since they were last indexed are registered straight from the index.
+				// Their contents are only read once the object is actually loaded.
+				Name objectName( item.m_Path.Basename().c_str() );
+				HashMap< Name, IndexEntry >::Iterator indexIter = m_indexEntries.Find( objectName );
+				if ( indexIter != m_indexEntries.End() &&
+					indexIter->Second().fileSize == static_cast< uint64_t >( item.m_Size ) &&
+					indexIter->Second().fileTimeStamp == static_cast< int64_t >( item.m_ModTime ) )
+				{
+					const IndexEntry& rEntry = indexIter->Second();
+
+					SerializedObjectData* pObjectData = m_objects.New();
+					HELIUM_ASSERT( pObjectData );
+					HELIUM_VERIFY( pObjectData->objectPath.Set( objectName, false, m_packagePath ) );
+					pObjectData->typeName = rEntry.typeName;
+					pObjectData->templatePath.Clear();
+					if ( !rEntry.templatePath.IsEmpty() )
+					{
+						pObjectData->templatePath.Set( rEntry.templatePath );
+					}
+					pObjectData->filePath = item.m_Path;
+					pObjectData->fileTimeStamp = rEntry.fileTimeStamp;
+					pObjectData->fileSize = rEntry.fileSize;
+					pObjectData->contentHash = rEntry.contentHash;
+					pObjectData->pFileData = NULL;
+					pObjectData->fileDataSize = 0;
+					pObjectData->bMetadataParsed = true;
+					pObjectData->bMetadataGood = true;
+
+					++indexedObjectCount;
+
+					continue;
+				}
 
-				FileReadRequest *request = m_fileReadRequests.New();
-				request->expectedSize = item.m_Size;
+				HELIUM_TRACE( TraceLevels::Info, TXT("- Reading file [%s]\n"), item.m_Path.c_str() );
 
 				HELIUM_ASSERT( item.m_Size < UINT32_MAX );
 
-				// Create a buffer for the file to be read into temporarily
-				request->pLoadBuffer = DefaultAllocator().Allocate( static_cast< size_t > ( item.m_Size ) + 1 );
-				static_cast< char* >( request->pLoadBuffer )[ static_cast< size_t > ( item.m_Size ) ] = '\0'; // for efficiency parsing text files
-				HELIUM_ASSERT( request->pLoadBuffer );
-
-				// Queue up the read
-				request->asyncLoadId = rAsyncLoader.QueueRequest( request->pLoadBuffer, String( item.m_Path.c_str() ), 0, static_cast< size_t >( item.m_Size ) );
-				HELIUM_ASSERT( IsValid( request->asyncLoadId ) );
-
+				FileReadRequest *request = m_fileReadRequests.New();
+				request->expectedSize = item.m_Size;
+				request->pLoadBuffer = NULL;
+				SetInvalid( request->asyncLoadId );
 				request->filePath = item.m_Path;
 				request->fileTimestamp = item.m_ModTime;
+
+				fileDataSize += static_cast< size_t >( item.m_Size ) + 1;
 			}
 			else
 			{
 				HELIUM_TRACE( TraceLevels::Info, TXT("- Skipping file [%s] (Extension is %s)\n"), item.m_Path.c_str(), item.m_Path.Extension().c_str() );
 			}
 		}
+
+		// Index entries for files that were removed or changed need to be dropped or replaced.
+		if( indexedObjectCount != m_indexEntries.GetSize() )
+		{
+			m_bIndexDirty = true;
+		}
+
+		// Read all changed object files into a single buffer owned by the package.  Each file's contents are kept (null
+		// terminated) until the object is deserialized, so object files are only read once and no per-file buffers
+		// need to be allocated.
+		if( fileDataSize != 0 )
+		{
+			HELIUM_ASSERT( !m_pFileDataBuffer );
+			m_pFileDataBuffer = static_cast< char* >( DefaultAllocator().Allocate( fileDataSize ) );
+			HELIUM_ASSERT( m_pFileDataBuffer );
+
+			// Preloading holds its own reference to the buffer until all reads have completed.
+			m_fileDataReferenceCount = 1;
+
+			char* pFileData = m_pFileDataBuffer;
+			size_t requestCount = m_fileReadRequests.GetSize();
+			for( size_t requestIndex = 0; requestIndex < requestCount; ++requestIndex )
+			{
+				FileReadRequest& rRequest = m_fileReadRequests[ requestIndex ];
+				size_t fileSize = static_cast< size_t >( rRequest.expectedSize );
+
+				rRequest.pLoadBuffer = pFileData;
+				pFileData[ fileSize ] = '\0';
+				pFileData += fileSize + 1;
+
+				// Queue up the read
+				rRequest.asyncLoadId = rAsyncLoader.QueueRequest( rRequest.pLoadBuffer, String( rRequest.filePath.c_str() ), 0, fileSize );
+				HELIUM_ASSERT( IsValid( rRequest.asyncLoadId ) );
+			}
+
+			HELIUM_ASSERT( pFileData == m_pFileDataBuffer + fileDataSize );
+		}
 	}
 
 	AtomicExchangeRelease( m_startPreloadCounter, 1 );
@@ -340,6 +465,8 @@ size_t LoosePackageLoader::BeginLoadObject( AssetPath path, Reflect::ObjectResol
 		SetInvalid( pRequest->asyncFileLoadId );
 		pRequest->pAsyncFileLoadBuffer = NULL;
 		pRequest->asyncFileLoadBufferSize = 0;
+		pRequest->bPreloadedFileData = false;
+		pRequest->deserializeState = DESERIALIZE_STATE_IDLE;
 		pRequest->pResolver = NULL;
 		pRequest->forceReload = forceReload;
 
@@ -365,12 +492,26 @@ size_t LoosePackageLoader::BeginLoadObject( AssetPath path, Reflect::ObjectResol
 
 	SerializedObjectData& rObjectData = m_objects[ objectIndex ];
 
+	// Read the type and template from the object file the first time the object is requested.  This can release the
+	// shared file data buffer, which Tick() may be doing concurrently for other objects.
+	bool bMetadataGood;
+	{
+		MutexScopeLock scopeLock( m_accessLock );
+
+		if( !rObjectData.bMetadataParsed )
+		{
+			ParseObjectMetadata( rObjectData );
+		}
+
+		bMetadataGood = rObjectData.bMetadataGood;
+	}
+
 	// Verify that the metadata was read successfully
-	if( !rObjectData.bMetadataGood )
+	if( !bMetadataGood )
 	{
 		HELIUM_TRACE(
 			TraceLevels::Error,
-			TXT( "LoosePackageLoader::BeginLoadObject(): Failed to read metadata for object \"%s\" during PackagePreload. Search log for parsing errors.\n" ),
+			TXT( "LoosePackageLoader::BeginLoadObject(): Failed to read metadata for object \"%s\". Search log for parsing errors.\n" ),
 			*path.ToString() );
 
 		return Invalid< size_t >();
@@ -437,6 +578,8 @@ size_t LoosePackageLoader::BeginLoadObject( AssetPath path, Reflect::ObjectResol
 	SetInvalid( pRequest->asyncFileLoadId );
 	pRequest->pAsyncFileLoadBuffer = NULL;
 	pRequest->asyncFileLoadBufferSize = 0;
+	pRequest->bPreloadedFileData = false;
+	pRequest->deserializeState = DESERIALIZE_STATE_IDLE;
 	pRequest->pResolver = pResolver;
 	pRequest->forceReload = forceReload;
 
@@ -713,89 +856,50 @@ void LoosePackageLoader::TickPreload()
 			// the name is deduced from the file name (bad idea to store it in the file)
 			Name name ( m_fileReadRequests[i].filePath.Basename().c_str() );
 
-			// read some preliminary data from the json
-			struct PreliminaryObjectHandler : rapidjson::BaseReaderHandler<>
+			// Keep the file contents around for deserialization.  The type and template are only read from them once
+			// the object is actually requested (see ParseObjectMetadata()).
+			SerializedObjectData* pObjectData = m_objects.New();
+			HELIUM_ASSERT( pObjectData );
+			HELIUM_VERIFY( pObjectData->objectPath.Set( name, false, m_packagePath ) );
+			pObjectData->typeName = Name( NULL_NAME );
+			pObjectData->templatePath.Clear();
+			pObjectData->filePath = rRequest.filePath;
+			pObjectData->fileTimeStamp = rRequest.fileTimestamp;
+			pObjectData->fileSize = bytes_read;
+			pObjectData->contentHash = StableHash::AddData( StableHash::SEED, rRequest.pLoadBuffer, bytes_read );
+			pObjectData->pFileData = static_cast< const char* >( rRequest.pLoadBuffer );
+			pObjectData->fileDataSize = bytes_read;
+			pObjectData->bMetadataParsed = false;
+			pObjectData->bMetadataGood = false;
+
+			++m_fileDataReferenceCount;
+
+			// Reuse the indexed metadata if only the file time stamp changed, otherwise read it now so that it can be
+			// indexed.
+			HashMap< Name, IndexEntry >::Iterator indexIter = m_indexEntries.Find( name );
+			if( indexIter != m_indexEntries.End() &&
+				indexIter->Second().fileSize == pObjectData->fileSize &&
+				indexIter->Second().contentHash == pObjectData->contentHash )
 			{
-				Helium::Name typeName;
-				Helium::String templatePath;
-				bool templateIsNext;
-
-				PreliminaryObjectHandler()
-					: typeName( ENullName () )
-					, templatePath( "" )
-				{
-					templateIsNext = false;
-				}
-
-				void String(const Ch* chars, rapidjson::SizeType length, bool copy)
+				const IndexEntry& rEntry = indexIter->Second();
+				pObjectData->typeName = rEntry.typeName;
+				if( !rEntry.templatePath.IsEmpty() )
 				{
-					if ( typeName.IsEmpty() )
-					{
-						typeName.Set( Helium::String ( chars, length ) );
-						return;
-					}
-
-					if ( templatePath.IsEmpty() )
-					{
-						Helium::String str ( chars, length ); 
-
-						if ( templateIsNext )
-						{
-							templatePath = str;
-							templateIsNext = false;
-							return;
-						}
-						else
-						{
-							if ( str == "m_spTemplate" )
-							{
-								templateIsNext = true;
-								return;
-							}
-						}
-					}
+					pObjectData->templatePath.Set( rEntry.templatePath );
 				}
 
-				void StartObject() { Default(); }
-				void EndObject( rapidjson::SizeType ) { Default(); }
-
-			} handler;
-
-			// non destructive in-place stream helper
-			rapidjson::StringStream stream ( static_cast< char* >( rRequest.pLoadBuffer ) );
-
-			// the main reader object
-			rapidjson::Reader reader;
-			if ( reader.Parse< rapidjson::kParseDefaultFlags >( stream, handler ) )
-			{
-				SerializedObjectData* pObjectData = m_objects.New();
-				HELIUM_ASSERT( pObjectData );
-				HELIUM_VERIFY( pObjectData->objectPath.Set( name, false, m_packagePath ) );
-				pObjectData->templatePath.Set( handler.templatePath );
-				pObjectData->typeName = handler.typeName;
-				pObjectData->filePath = rRequest.filePath;
-				pObjectData->fileTimeStamp = rRequest.fileTimestamp;
+				pObjectData->bMetadataParsed = true;
 				pObjectData->bMetadataGood = true;
-
-				HELIUM_TRACE(
-					TraceLevels::Debug,
-					TXT( "LoosePackageLoader: Success reading preliminary data for object '%s' from file '%s'.\n" ),
-					*name,
-					rRequest.filePath.c_str() );
 			}
 			else
 			{
-				HELIUM_TRACE(
-					TraceLevels::Error,
-					TXT( "LoosePackageLoader: Failure reading preliminary data for object '%s' from file '%s': %s\n" ),
-					*name,
-					rRequest.filePath.c_str(),
-					reader.GetParseError() );
+				ParseObjectMetadata( *pObjectData );
 			}
+
+			m_bIndexDirty = true;
 		}
 
-		// We're finished with this load, so deallocate memory and get rid of the request
-		DefaultAllocator().Free( rRequest.pLoadBuffer );
+		// We're finished with this load, so get rid of the request (the file data buffer is owned by the package)
 		rRequest.pLoadBuffer = NULL;
 		SetInvalid(rRequest.asyncLoadId);
 		m_fileReadRequests.RemoveSwap(i);
@@ -897,6 +1001,11 @@ void LoosePackageLoader::TickPreload()
 			pObjectData->templatePath.Clear();
 			pObjectData->filePath.Clear();
 			pObjectData->fileTimeStamp = packageDirectory.GetItem().m_ModTime;
+			pObjectData->fileSize = static_cast< uint64_t >( packageDirectory.GetItem().m_Size );
+			pObjectData->contentHash = 0;
+			pObjectData->pFileData = NULL;
+			pObjectData->fileDataSize = 0;
+			pObjectData->bMetadataParsed = true;
 			pObjectData->bMetadataGood = true;
 		}
 		else
@@ -919,6 +1028,27 @@ void LoosePackageLoader::TickPreload()
 		}
 	}
 
+	// Release the preload reference to the file data buffer (freeing it if no object files could be read).
+	if( m_pFileDataBuffer )
+	{
+		HELIUM_ASSERT( m_fileDataReferenceCount != 0 );
+		--m_fileDataReferenceCount;
+		if( m_fileDataReferenceCount == 0 )
+		{
+			DefaultAllocator().Free( m_pFileDataBuffer );
+			m_pFileDataBuffer = NULL;
+		}
+	}
+
+	// Update the package index with any files that were read.
+	if( m_bIndexDirty )
+	{
+		SavePackageIndex();
+		m_bIndexDirty = false;
+	}
+
+	m_indexEntries.Clear();
+
 	// Package preloading is now complete.
 	pPackage->SetFlags( Asset::FLAG_PRELOADED | Asset::FLAG_LINKED );
 	pPackage->ConditionalFinalizeLoad();
@@ -931,6 +1061,9 @@ void LoosePackageLoader::TickPreload()
 /// Update load processing of object load requests.
 void LoosePackageLoader::TickLoadRequests()
 {
+	AssetLoader* pAssetLoader = AssetLoader::GetStaticInstance();
+	HELIUM_ASSERT( pAssetLoader );
+
 	size_t loadRequestCount = m_loadRequests.GetSize();
 	for( size_t loadRequestIndex = 0; loadRequestIndex < loadRequestCount; ++loadRequestIndex )
 	{
@@ -942,6 +1075,12 @@ void LoosePackageLoader::TickLoadRequests()
 		LoadRequest* pRequest = m_loadRequests[ loadRequestIndex ];
 		HELIUM_ASSERT( pRequest );
 
+		if( ( pRequest->flags & LOAD_FLAG_PRELOADED ) == LOAD_FLAG_PRELOADED )
+		{
+			// Already reported to the asset loader.
+			continue;
+		}
+
 		if( !( pRequest->flags & LOAD_FLAG_PROPERTY_PRELOADED ) )
 		{
 			if( !TickDeserialize( pRequest ) )
@@ -961,6 +1100,9 @@ void LoosePackageLoader::TickLoadRequests()
 				continue;
 			}
 		}
+
+		// Let the asset loader know the object can be picked up.
+		pAssetLoader->NotifyObjectPreloaded( m_objects[ pRequest->index ].objectPath );
 	}
 }
 
@@ -1090,12 +1232,36 @@ bool LoosePackageLoader::TickDeserialize( LoadRequest* pRequest )
 	HELIUM_ASSERT( !pOwner || pOwner->IsFullyLoaded() );
 	HELIUM_ASSERT( !pTemplate || pTemplate->IsFullyLoaded() );
 
+	// If the properties are being read on a worker thread, wait for it to finish.
+	if( pRequest->deserializeState != DESERIALIZE_STATE_IDLE )
+	{
+		if( pRequest->deserializeState != DESERIALIZE_STATE_DONE )
+		{
+			return false;
+		}
+
+		pRequest->deserializeState = DESERIALIZE_STATE_IDLE;
+		if( pRequest->pResolver )
+		{
+			pRequest->deferredResolver.Replay( pRequest->pResolver );
+		}
+
+		return FinishDeserialize( pRequest, true, false );
+	}
+
 	AsyncLoader& rAsyncLoader = AsyncLoader::GetStaticInstance();
 	FilePath object_file_path = m_packageDirPath + *rObjectData.objectPath.GetName() + TXT( "." ) + Persist::ArchiveExtensions[ Persist::ArchiveTypes::Json ];
 
 	bool load_properties_from_file = true;
 	size_t object_file_size = 0;
-	if ( !IsValid( pRequest->asyncFileLoadId ) )
+	if ( rObjectData.pFileData && !pRequest->forceReload )
+	{
+		// The object file was already read during package preloading, so deserialize straight from its contents.
+		pRequest->pAsyncFileLoadBuffer = const_cast< char* >( rObjectData.pFileData );
+		pRequest->asyncFileLoadBufferSize = rObjectData.fileDataSize;
+		pRequest->bPreloadedFileData = true;
+	}
+	else if ( !IsValid( pRequest->asyncFileLoadId ) )
 	{
 		if (!object_file_path.IsFile())
 		{
@@ -1186,7 +1352,11 @@ bool LoosePackageLoader::TickDeserialize( LoadRequest* pRequest )
 	}
 	
 	size_t bytesRead = 0;
-	if (load_properties_from_file)
+	if ( pRequest->bPreloadedFileData )
+	{
+		bytesRead = pRequest->asyncFileLoadBufferSize;
+	}
+	else if (load_properties_from_file)
 	{
 		HELIUM_ASSERT( IsValid( pRequest->asyncFileLoadId ) );
 
@@ -1285,31 +1455,73 @@ bool LoosePackageLoader::TickDeserialize( LoadRequest* pRequest )
 		}
 		else
 		{
-			StaticMemoryStream archiveStream ( pRequest->pAsyncFileLoadBuffer, pRequest->asyncFileLoadBufferSize );
-
 			HELIUM_TRACE(
 				TraceLevels::Info,
 				TXT( "LoosePackageLoader: Reading %s. pResolver = %x\n"), 
 				object_file_path.c_str(),
 				pRequest->pResolver);
 
-			DynamicArray< Reflect::ObjectPtr > objects;
-			objects.Push( pRequest->spObject.Get() ); // use existing objects
-			Persist::ArchiveReaderJson::ReadFromStream( archiveStream, objects, pRequest->pResolver );
-			HELIUM_ASSERT( objects[0].Get() == pRequest->spObject.Get() );
+			// Read the properties into the new object on a worker thread.  The object has already been registered, so
+			// only the archive read is left to the task.
+			pRequest->deserializeState = DESERIALIZE_STATE_PENDING;
+			TaskDispatcher::Dispatch( DeserializeTask, pRequest );
+			if( pRequest->deserializeState != DESERIALIZE_STATE_DONE )
+			{
+				return false;
+			}
+
+			pRequest->deserializeState = DESERIALIZE_STATE_IDLE;
+			if( pRequest->pResolver )
+			{
+				pRequest->deferredResolver.Replay( pRequest->pResolver );
+			}
 		}
 	}
 
-	if (load_properties_from_file)
+	return FinishDeserialize( pRequest, load_properties_from_file, object_creation_failure );
+}
+
+/// Finish object property preloading for a given load request once the properties have been read.
+///
+/// @param[in] pRequest                   Load request to process.
+/// @param[in] bLoadedPropertiesFromFile  True if the object properties were loaded from the object file, false if
+///                                       the object was left with its default properties.
+/// @param[in] bObjectCreationFailure     True if the object could not be created or reused for loading.
+///
+/// @return  Always true (property preloading has completed).
+bool LoosePackageLoader::FinishDeserialize(
+	LoadRequest* pRequest,
+	bool bLoadedPropertiesFromFile,
+	bool bObjectCreationFailure )
+{
+	HELIUM_ASSERT( pRequest );
+	HELIUM_ASSERT( pRequest->deserializeState == DESERIALIZE_STATE_IDLE );
+
+	HELIUM_ASSERT( pRequest->index < m_objects.GetSize() );
+	SerializedObjectData& rObjectData = m_objects[ pRequest->index ];
+
+	Asset* pObject = pRequest->spObject;
+	HELIUM_ASSERT( pObject );
+
+	if( bLoadedPropertiesFromFile )
 	{
-		DefaultAllocator().Free(pRequest->pAsyncFileLoadBuffer);
+		if( pRequest->bPreloadedFileData )
+		{
+			ReleaseFileData( rObjectData );
+			pRequest->bPreloadedFileData = false;
+		}
+		else
+		{
+			DefaultAllocator().Free(pRequest->pAsyncFileLoadBuffer);
+		}
+
 		pRequest->pAsyncFileLoadBuffer = NULL;
 		pRequest->asyncFileLoadBufferSize = 0;
 	}
 
 	pRequest->flags |= LOAD_FLAG_PROPERTY_PRELOADED;
 
-	if( object_creation_failure )
+	if( bObjectCreationFailure )
 	{
 		HELIUM_TRACE(
 			TraceLevels::Error,
@@ -1336,23 +1548,25 @@ bool LoosePackageLoader::TickDeserialize( LoadRequest* pRequest )
 			pCache->EnforceTocLoad();
 
 			const Cache::Entry* pEntry = pCache->FindEntry( rObjectData.objectPath, 0 );
-			if( pEntry && pEntry->size != 0 )
+			if( pEntry && pEntry->uncompressedSize != 0 )
 			{
 				HELIUM_ASSERT( IsInvalid( pRequest->persistentResourceDataLoadId ) );
 				HELIUM_ASSERT( !pRequest->pCachedObjectDataBuffer );
 
 				pRequest->pCachedObjectDataBuffer =
-					static_cast< uint8_t* >( DefaultAllocator().Allocate( pEntry->size ) );
+					static_cast< uint8_t* >( DefaultAllocator().Allocate( pEntry->uncompressedSize ) );
 				HELIUM_ASSERT( pRequest->pCachedObjectDataBuffer );
-				pRequest->cachedObjectDataBufferSize = pEntry->size;
-
-				AsyncLoader& rAsyncLoader = AsyncLoader::GetStaticInstance();
-				pRequest->persistentResourceDataLoadId = rAsyncLoader.QueueRequest(
-					pRequest->pCachedObjectDataBuffer,
-					pCache->GetCacheFileName(),
-					pEntry->offset,
-					pEntry->size );
-				HELIUM_ASSERT( IsValid( pRequest->persistentResourceDataLoadId ) );
+				pRequest->cachedObjectDataBufferSize = pEntry->uncompressedSize;
+
+				pRequest->persistentResourceDataLoadId = pCache->BeginLoadEntry(
+					*pEntry,
+					pRequest->pCachedObjectDataBuffer );
+				if( IsInvalid( pRequest->persistentResourceDataLoadId ) )
+				{
+					DefaultAllocator().Free( pRequest->pCachedObjectDataBuffer );
+					pRequest->pCachedObjectDataBuffer = NULL;
+					pRequest->cachedObjectDataBufferSize = 0;
+				}
 			}
 		}
 	}
@@ -1368,6 +1582,34 @@ bool LoosePackageLoader::TickDeserialize( LoadRequest* pRequest )
 	return true;
 }
 
+/// Task for reading the properties of a load request's object from its object file.
+///
+/// This may be run on any thread, so asset references are recorded using the request's deferred resolver instead of
+/// being resolved directly.
+///
+/// @param[in] pData  Load request.
+void LoosePackageLoader::DeserializeTask( void* pData )
+{
+	LoadRequest* pRequest = static_cast< LoadRequest* >( pData );
+	HELIUM_ASSERT( pRequest );
+	HELIUM_ASSERT( pRequest->deserializeState == DESERIALIZE_STATE_PENDING );
+
+	StaticMemoryStream archiveStream ( pRequest->pAsyncFileLoadBuffer, pRequest->asyncFileLoadBufferSize );
+
+	DynamicArray< Reflect::ObjectPtr > objects;
+	objects.Push( pRequest->spObject.Get() ); // use existing objects
+	Persist::ArchiveReaderJson::ReadFromStream(
+		archiveStream,
+		objects,
+		( pRequest->pResolver ? &pRequest->deferredResolver : NULL ) );
+	HELIUM_ASSERT( objects[0].Get() == pRequest->spObject.Get() );
+
+	AtomicExchangeRelease( pRequest->deserializeState, DESERIALIZE_STATE_DONE );
+
+	// Wake up any thread waiting for the load to finish.
+	AsyncLoader::GetStaticInstance().NotifyProgress();
+}
+
 /// Update processing of persistent resource data loading for a given load request.
 ///
 /// @param[in] pRequest  Load request to process.
@@ -1382,17 +1624,23 @@ bool LoosePackageLoader::TickPersistentResourcePreload( LoadRequest* pRequest )
 	HELIUM_ASSERT( pResource );
 
 	// Wait for the cached data load to complete.
-	AsyncLoader& rAsyncLoader = AsyncLoader::GetStaticInstance();
+	Cache* pCache = CacheManager::GetStaticInstance().GetCache( Name( HELIUM_ASSET_CACHE_NAME ) );
+	HELIUM_ASSERT( pCache );
 
 	size_t bytesRead = 0;
 	HELIUM_ASSERT( IsValid( pRequest->persistentResourceDataLoadId ) );
-	if( !rAsyncLoader.TrySyncRequest( pRequest->persistentResourceDataLoadId, bytesRead ) )
+	if( !pCache->TryFinishLoadEntry( pRequest->persistentResourceDataLoadId, bytesRead ) )
 	{
 		return false;
 	}
 
 	SetInvalid( pRequest->persistentResourceDataLoadId );
 
+	if( IsInvalid( bytesRead ) )
+	{
+		bytesRead = 0;
+	}
+
 	if( bytesRead != pRequest->cachedObjectDataBufferSize )
 	{
 		HELIUM_TRACE(
@@ -1490,3 +1738,493 @@ bool LoosePackageLoader::TickPersistentResourcePreload( LoadRequest* pRequest )
 
 	return true;
 }
+
+/// Skip over whitespace in JSON text.
+///
+/// @param[in] pText  Current position in the text.
+/// @param[in] pEnd   End of the text.
+///
+/// @return  First non-whitespace character at or after the current position, or the end of the text.
+static const char* SkipJsonWhitespace( const char* pText, const char* pEnd )
+{
+	while( pText < pEnd && ( *pText == ' ' || *pText == '\t' || *pText == '\n' || *pText == '\r' ) )
+	{
+		++pText;
+	}
+
+	return pText;
+}
+
+/// Find the closing quote of a JSON string.
+///
+/// @param[in] pText  First character after the opening quote.
+/// @param[in] pEnd   End of the text.
+///
+/// @return  Closing quote of the string, or null if the string is not terminated.
+static const char* FindJsonStringEnd( const char* pText, const char* pEnd )
+{
+	for( ; pText < pEnd; ++pText )
+	{
+		if( *pText == '\\' )
+		{
+			++pText;
+		}
+		else if( *pText == '"' )
+		{
+			return pText;
+		}
+	}
+
+	return NULL;
+}
+
+/// Convert the contents of a JSON string to a String, resolving any escape sequences.
+///
+/// @param[in]  pText    First character of the string contents.
+/// @param[in]  pEnd     Closing quote of the string.
+/// @param[out] rString  Unescaped string.
+static void UnescapeJsonString( const char* pText, const char* pEnd, String& rString )
+{
+	rString.Remove( 0, rString.GetSize() );
+	rString.Reserve( static_cast< size_t >( pEnd - pText ) );
+
+	while( pText < pEnd )
+	{
+		char character = *pText++;
+		if( character != '\\' || pText >= pEnd )
+		{
+			rString.Add( character );
+			continue;
+		}
+
+		character = *pText++;
+		switch( character )
+		{
+		case 'b':
+			rString.Add( '\b' );
+			break;
+
+		case 'f':
+			rString.Add( '\f' );
+			break;
+
+		case 'n':
+			rString.Add( '\n' );
+			break;
+
+		case 'r':
+			rString.Add( '\r' );
+			break;
+
+		case 't':
+			rString.Add( '\t' );
+			break;
+
+		case 'u':
+			{
+				uint32_t codePoint = 0;
+				for( size_t digitIndex = 0; digitIndex < 4 && pText < pEnd; ++digitIndex, ++pText )
+				{
+					char digit = *pText;
+					codePoint <<= 4;
+					if( digit >= '0' && digit <= '9' )
+					{
+						codePoint |= static_cast< uint32_t >( digit - '0' );
+					}
+					else if( digit >= 'a' && digit <= 'f' )
+					{
+						codePoint |= static_cast< uint32_t >( digit - 'a' + 10 );
+					}
+					else if( digit >= 'A' && digit <= 'F' )
+					{
+						codePoint |= static_cast< uint32_t >( digit - 'A' + 10 );
+					}
+				}
+
+				// Encode as UTF-8 (surrogate pairs are not expected in type names or asset paths).
+				if( codePoint < 0x80 )
+				{
+					rString.Add( static_cast< char >( codePoint ) );
+				}
+				else if( codePoint < 0x800 )
+				{
+					rString.Add( static_cast< char >( 0xc0 | ( codePoint >> 6 ) ) );
+					rString.Add( static_cast< char >( 0x80 | ( codePoint & 0x3f ) ) );
+				}
+				else
+				{
+					rString.Add( static_cast< char >( 0xe0 | ( codePoint >> 12 ) ) );
+					rString.Add( static_cast< char >( 0x80 | ( ( codePoint >> 6 ) & 0x3f ) ) );
+					rString.Add( static_cast< char >( 0x80 | ( codePoint & 0x3f ) ) );
+				}
+			}
+
+			break;
+
+		default:
+			// '"', '\\', and '/' map to themselves.
+			rString.Add( character );
+			break;
+		}
+	}
+}
+
+/// Read the type name and template path of an object from its preloaded object file contents.
+///
+/// Rather than parsing the entire file, only the strings in it are scanned: the type name is the first string in the
+/// file (the key naming the object's type), and the template path is the string value of the first "m_spTemplate"
+/// member.  The file contents are parsed in full only once, when the object properties are deserialized.
+///
+/// @param[in] rObjectData  Serialized object data to update.
+///
+/// @return  True if the metadata was read successfully, false if not.
+bool LoosePackageLoader::ParseObjectMetadata( SerializedObjectData& rObjectData )
+{
+	HELIUM_ASSERT( !rObjectData.bMetadataParsed );
+
+	rObjectData.bMetadataParsed = true;
+	rObjectData.bMetadataGood = false;
+
+	if( !rObjectData.pFileData )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "LoosePackageLoader: No file data available to read preliminary data for object '%s' from.\n" ),
+			*rObjectData.objectPath.ToString() );
+
+		return false;
+	}
+
+	static const char templateMemberName[] = "m_spTemplate";
+	static const size_t templateMemberNameLength = sizeof( templateMemberName ) / sizeof( templateMemberName[ 0 ] ) - 1;
+
+	const char* pText = rObjectData.pFileData;
+	const char* pEnd = pText + rObjectData.fileDataSize;
+
+	String typeName;
+	String templatePath;
+	bool bTemplateIsNext = false;
+	bool bTerminated = true;
+
+	while( pText < pEnd )
+	{
+		// Quotes can only appear in JSON as string delimiters, so skip straight to the next string.
+		pText = static_cast< const char* >( memchr( pText, '"', static_cast< size_t >( pEnd - pText ) ) );
+		if( !pText )
+		{
+			break;
+		}
+
+		const char* pStringStart = pText + 1;
+		const char* pStringEnd = FindJsonStringEnd( pStringStart, pEnd );
+		if( !pStringEnd )
+		{
+			bTerminated = false;
+			break;
+		}
+
+		pText = pStringEnd + 1;
+
+		if( typeName.IsEmpty() )
+		{
+			UnescapeJsonString( pStringStart, pStringEnd, typeName );
+			continue;
+		}
+
+		if( bTemplateIsNext )
+		{
+			UnescapeJsonString( pStringStart, pStringEnd, templatePath );
+			break;
+		}
+
+		if( static_cast< size_t >( pStringEnd - pStringStart ) == templateMemberNameLength &&
+			memcmp( pStringStart, templateMemberName, templateMemberNameLength ) == 0 )
+		{
+			// Only take the template path if the member is set to a string (null templates have no path).
+			pText = SkipJsonWhitespace( pText, pEnd );
+			if( pText < pEnd && *pText == ':' )
+			{
+				pText = SkipJsonWhitespace( pText + 1, pEnd );
+				bTemplateIsNext = ( pText < pEnd && *pText == '"' );
+			}
+		}
+	}
+
+	if( !bTerminated || typeName.IsEmpty() )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Error,
+			TXT( "LoosePackageLoader: Failure reading preliminary data for object '%s' from file '%s': %s\n" ),
+			*rObjectData.objectPath.ToString(),
+			rObjectData.filePath.c_str(),
+			( bTerminated ? TXT( "no type name found" ) : TXT( "unterminated string" ) ) );
+
+		// The object cannot be loaded, so its file contents are no longer needed.
+		ReleaseFileData( rObjectData );
+
+		return false;
+	}
+
+	rObjectData.typeName.Set( typeName );
+	if( !templatePath.IsEmpty() )
+	{
+		rObjectData.templatePath.Set( templatePath );
+	}
+
+	rObjectData.bMetadataGood = true;
+
+	HELIUM_TRACE(
+		TraceLevels::Debug,
+		TXT( "LoosePackageLoader: Success reading preliminary data for object '%s' from file '%s'.\n" ),
+		*rObjectData.objectPath.ToString(),
+		rObjectData.filePath.c_str() );
+
+	return true;
+}
+
+/// Release the reference of an object to its preloaded object file contents.
+///
+/// The package file data buffer is freed once no objects reference it.  The caller must hold m_accessLock.
+///
+/// @param[in] rObjectData  Serialized object data for the object.
+void LoosePackageLoader::ReleaseFileData( SerializedObjectData& rObjectData )
+{
+	if( !rObjectData.pFileData )
+	{
+		return;
+	}
+
+	rObjectData.pFileData = NULL;
+	rObjectData.fileDataSize = 0;
+
+	HELIUM_ASSERT( m_fileDataReferenceCount != 0 );
+	--m_fileDataReferenceCount;
+	if( m_fileDataReferenceCount == 0 )
+	{
+		DefaultAllocator().Free( m_pFileDataBuffer );
+		m_pFileDataBuffer = NULL;
+	}
+}
+
+/// Read a value from package index file data.
+///
+/// @param[in,out] rpCurrent  Current position in the index data (advanced past the value if read).
+/// @param[in]     pEnd       End of the index data.
+/// @param[out]    pValue     Value to fill in.
+/// @param[in]     size       Size of the value, in bytes.
+///
+/// @return  True if the value was read, false if the end of the data was reached.
+static bool ReadIndexValue( const uint8_t*& rpCurrent, const uint8_t* pEnd, void* pValue, size_t size )
+{
+	if( static_cast< size_t >( pEnd - rpCurrent ) < size )
+	{
+		return false;
+	}
+
+	MemoryCopy( pValue, rpCurrent, size );
+	rpCurrent += size;
+
+	return true;
+}
+
+/// Read a length-prefixed string from package index file data.
+///
+/// @param[in,out] rpCurrent  Current position in the index data (advanced past the string if read).
+/// @param[in]     pEnd       End of the index data.
+/// @param[out]    rString    String to fill in.
+///
+/// @return  True if the string was read, false if the end of the data was reached.
+static bool ReadIndexString( const uint8_t*& rpCurrent, const uint8_t* pEnd, String& rString )
+{
+	uint32_t length = 0;
+	if( !ReadIndexValue( rpCurrent, pEnd, &length, sizeof( length ) ) ||
+		static_cast< size_t >( pEnd - rpCurrent ) < length )
+	{
+		return false;
+	}
+
+	rString = String( reinterpret_cast< const char* >( rpCurrent ), length );
+	rpCurrent += length;
+
+	return true;
+}
+
+/// Write a length-prefixed string to package index file data.
+///
+/// @param[in] rStream  Stream to which the index data is being written.
+/// @param[in] pString  String to write.
+static void WriteIndexString( Stream& rStream, const char* pString )
+{
+	HELIUM_ASSERT( pString );
+
+	uint32_t length = static_cast< uint32_t >( StringLength( pString ) );
+	rStream.Write( &length, sizeof( length ), 1 );
+	rStream.Write( pString, 1, length );
+}
+
+/// Load the package index file, which records the metadata of each object file in this package as of the last time
+/// it was read.
+///
+/// A missing or malformed index (such as one written by an older version), or one written for a different package
+/// directory, is treated as empty, so all object files are read and the index is rewritten once preloading completes.
+///
+/// @see SavePackageIndex()
+void LoosePackageLoader::LoadPackageIndex()
+{
+	m_indexEntries.Clear();
+	m_bIndexDirty = false;
+
+	if( m_indexFilePath.Get().empty() )
+	{
+		return;
+	}
+
+	FileStream* pStream = FileStream::OpenFileStream( String( m_indexFilePath.c_str() ), FileStream::MODE_READ );
+	if( !pStream )
+	{
+		m_bIndexDirty = true;
+
+		return;
+	}
+
+	int64_t fileSize = pStream->GetSize();
+	DynamicArray< uint8_t > fileData;
+	if( fileSize > 0 && static_cast< uint64_t >( fileSize ) <= UINT32_MAX )
+	{
+		fileData.Resize( static_cast< size_t >( fileSize ) );
+		if( pStream->Read( fileData.GetData(), 1, fileData.GetSize() ) != fileData.GetSize() )
+		{
+			fileData.Clear();
+		}
+	}
+
+	delete pStream;
+
+	const uint8_t* pCurrent = fileData.GetData();
+	const uint8_t* pEnd = pCurrent + fileData.GetSize();
+
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	String packageDirPath;
+	uint32_t entryCount = 0;
+	bool bValid =
+		ReadIndexValue( pCurrent, pEnd, &magic, sizeof( magic ) ) &&
+		ReadIndexValue( pCurrent, pEnd, &version, sizeof( version ) ) &&
+		magic == PACKAGE_INDEX_MAGIC &&
+		version == PACKAGE_INDEX_VERSION &&
+		ReadIndexString( pCurrent, pEnd, packageDirPath ) &&
+		ReadIndexValue( pCurrent, pEnd, &entryCount, sizeof( entryCount ) ) &&
+		packageDirPath == String( m_packageDirPath.c_str() );
+
+	String objectName;
+	String typeName;
+	for( uint32_t entryIndex = 0; bValid && entryIndex < entryCount; ++entryIndex )
+	{
+		IndexEntry entry;
+		bValid =
+			ReadIndexString( pCurrent, pEnd, objectName ) &&
+			ReadIndexString( pCurrent, pEnd, typeName ) &&
+			ReadIndexString( pCurrent, pEnd, entry.templatePath ) &&
+			ReadIndexValue( pCurrent, pEnd, &entry.fileSize, sizeof( entry.fileSize ) ) &&
+			ReadIndexValue( pCurrent, pEnd, &entry.fileTimeStamp, sizeof( entry.fileTimeStamp ) ) &&
+			ReadIndexValue( pCurrent, pEnd, &entry.contentHash, sizeof( entry.contentHash ) ) &&
+			!objectName.IsEmpty() &&
+			!typeName.IsEmpty();
+		if( bValid )
+		{
+			entry.typeName.Set( typeName );
+
+			Name name( objectName );
+			HashMap< Name, IndexEntry >::Iterator indexIter = m_indexEntries.Find( name );
+			m_indexEntries.Insert( indexIter, KeyValue< Name, IndexEntry >( name, entry ) );
+		}
+	}
+
+	if( !bValid )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Info,
+			TXT( "LoosePackageLoader: Package index \"%s\" is missing or out of date and will be rebuilt.\n" ),
+			m_indexFilePath.c_str() );
+
+		m_indexEntries.Clear();
+		m_bIndexDirty = true;
+	}
+}
+
+/// Write the package index file from the metadata of the object files in this package.
+///
+/// @see LoadPackageIndex()
+void LoosePackageLoader::SavePackageIndex()
+{
+	if( m_indexFilePath.Get().empty() )
+	{
+		return;
+	}
+
+	FilePath indexDirectory( m_indexFilePath.Directory() );
+	if( !indexDirectory.MakePath() )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Warning,
+			TXT( "LoosePackageLoader: Failed to create package index directory \"%s\".\n" ),
+			indexDirectory.c_str() );
+
+		return;
+	}
+
+	// Only objects backed by object files with readable metadata are indexed; anything else is read again next time.
+	uint32_t entryCount = 0;
+	size_t objectCount = m_objects.GetSize();
+	for( size_t objectIndex = 0; objectIndex < objectCount; ++objectIndex )
+	{
+		const SerializedObjectData& rObjectData = m_objects[ objectIndex ];
+		if( !rObjectData.filePath.Get().empty() && rObjectData.bMetadataParsed && rObjectData.bMetadataGood )
+		{
+			++entryCount;
+		}
+	}
+
+	DynamicArray< uint8_t > fileData;
+	DynamicMemoryStream fileStream( &fileData );
+
+	uint32_t magic = PACKAGE_INDEX_MAGIC;
+	uint32_t version = PACKAGE_INDEX_VERSION;
+	fileStream.Write( &magic, sizeof( magic ), 1 );
+	fileStream.Write( &version, sizeof( version ), 1 );
+	WriteIndexString( fileStream, m_packageDirPath.c_str() );
+	fileStream.Write( &entryCount, sizeof( entryCount ), 1 );
+
+	String templatePath;
+	for( size_t objectIndex = 0; objectIndex < objectCount; ++objectIndex )
+	{
+		const SerializedObjectData& rObjectData = m_objects[ objectIndex ];
+		if( rObjectData.filePath.Get().empty() || !rObjectData.bMetadataParsed || !rObjectData.bMetadataGood )
+		{
+			continue;
+		}
+
+		templatePath.Remove( 0, templatePath.GetSize() );
+		if( !rObjectData.templatePath.IsEmpty() )
+		{
+			rObjectData.templatePath.ToString( templatePath );
+		}
+
+		WriteIndexString( fileStream, *rObjectData.objectPath.GetName() );
+		WriteIndexString( fileStream, *rObjectData.typeName );
+		WriteIndexString( fileStream, templatePath.IsEmpty() ? TXT( "" ) : *templatePath );
+		fileStream.Write( &rObjectData.fileSize, sizeof( rObjectData.fileSize ), 1 );
+		fileStream.Write( &rObjectData.fileTimeStamp, sizeof( rObjectData.fileTimeStamp ), 1 );
+		fileStream.Write( &rObjectData.contentHash, sizeof( rObjectData.contentHash ), 1 );
+	}
+
+	fileStream.Close();
+
+	if( !Cache::WriteFileAtomic( String( m_indexFilePath.c_str() ), fileData.GetData(), fileData.GetSize() ) )
+	{
+		HELIUM_TRACE(
+			TraceLevels::Warning,
+			TXT( "LoosePackageLoader: Failed to write package index \"%s\".\n" ),
+			m_indexFilePath.c_str() );
+	}
+}
@@ -2,9 +2,11 @@
 
 #include "Engine/Engine.h"
 #include "Engine/Asset.h"
+#include "Engine/AssetLoader.h"
 #include "Engine/PackageLoader.h"
 
 #include "Foundation/FilePath.h"
+#include "Foundation/HashMap.h"
 
 namespace Helium
 {
@@ -19,6 +21,11 @@ namespace Helium
 		/// Maximum number of bytes to parse at a time.
 		static const size_t PARSE_CHUNK_SIZE = 4 * 1024;
 
+		/// Package index file magic number.
+		static const uint32_t PACKAGE_INDEX_MAGIC = 0x58495048;  // 'HPIX'
+		/// Package index file format version.
+		static const uint32_t PACKAGE_INDEX_VERSION = 2;
+
 		/// Serialized object data.
 		struct SerializedObjectData
 		{
@@ -28,10 +35,21 @@ namespace Helium
 			FilePath filePath;
 			/// File time stamp
 			int64_t fileTimeStamp;
+			/// Object file size, in bytes.
+			uint64_t fileSize;
+			/// Hash of the object file contents.
+			uint64_t contentHash;
 			/// Type name.
 			Name typeName;
 			/// Template path.
 			AssetPath templatePath;
+			/// Object file contents read during preloading (within the package file data buffer), or null if not
+			/// available.
+			const char* pFileData;
+			/// Size of the preloaded object file contents, in bytes.
+			size_t fileDataSize;
+			/// True once the type name and template path have been read from the preloaded object file contents.
+			bool bMetadataParsed;
 			/// Is metadata good?
 			bool bMetadataGood;
 		};
@@ -97,6 +115,17 @@ namespace Helium
 			LOAD_FLAG_ERROR = 1 << 2
 		};
 
+		/// Object property deserialization task states.
+		enum EDeserializeState
+		{
+			/// Deserialization task not yet started.
+			DESERIALIZE_STATE_IDLE,
+			/// Deserialization task dispatched.
+			DESERIALIZE_STATE_PENDING,
+			/// Deserialization task completed.
+			DESERIALIZE_STATE_DONE
+		};
+
 		/// Asset load request data.
 		struct LoadRequest
 		{
@@ -129,6 +158,13 @@ namespace Helium
 			size_t asyncFileLoadId;
 			void* pAsyncFileLoadBuffer;
 			size_t asyncFileLoadBufferSize;
+			/// True if the object file buffer is the object's preloaded file data instead of a separate allocation.
+			bool bPreloadedFileData;
+
+			/// Property deserialization task state (EDeserializeState).
+			volatile int32_t deserializeState;
+			/// Resolver recording asset references read by the deserialization task.
+			DeferredAssetResolver deferredResolver;
 
 			/// Load flags.
 			uint32_t flags;
@@ -159,6 +195,28 @@ namespace Helium
 		/// Load request pool.
 		ObjectPool< LoadRequest > m_loadRequestPool;
 
+		/// Package index entry for an object file.
+		struct IndexEntry
+		{
+			/// Object type name.
+			Name typeName;
+			/// Object template path string (empty if the object uses the default template).
+			String templatePath;
+			/// Object file size, in bytes.
+			uint64_t fileSize;
+			/// Object file time stamp.
+			int64_t fileTimeStamp;
+			/// Hash of the object file contents.
+			uint64_t contentHash;
+		};
+
+		/// Package index file path.
+		FilePath m_indexFilePath;
+		/// Index entries loaded from the package index file, by object name (only kept during preloading).
+		HashMap< Name, IndexEntry > m_indexEntries;
+		/// True if the package index file needs to be rewritten once preloading completes.
+		bool m_bIndexDirty;
+
 		/// Package file path name.
 		FilePath m_packageDirPath;
 		
@@ -172,6 +230,11 @@ namespace Helium
 		};
 		DynamicArray<FileReadRequest> m_fileReadRequests;
 
+		/// Buffer holding the contents of every object file read during preloading.
+		char* m_pFileDataBuffer;
+		/// Number of objects still referencing data in the file data buffer.
+		size_t m_fileDataReferenceCount;
+
 		/// Parent package load request ID.
 		size_t m_parentPackageLoadId;
 
@@ -184,9 +247,18 @@ namespace Helium
 
 		void TickLoadRequests();
 		bool TickDeserialize( LoadRequest* pRequest );
+		bool FinishDeserialize( LoadRequest* pRequest, bool bLoadedPropertiesFromFile, bool bObjectCreationFailure );
 		bool TickPersistentResourcePreload( LoadRequest* pRequest );
+
+		bool ParseObjectMetadata( SerializedObjectData& rObjectData );
+		void ReleaseFileData( SerializedObjectData& rObjectData );
+
+		void LoadPackageIndex();
+		void SavePackageIndex();
 		//@}
 
+		static void DeserializeTask( void* pData );
+
 		size_t FindObjectByPath( const AssetPath &path ) const;
 		size_t FindObjectByName( const Name &name ) const;
 	};
@@ -1,6 +1,8 @@
 #include "PcSupportPch.h"
 #include "PcSupport/PlatformPreprocessor.h"
 
+#include "Engine/StableHash.h"
+
 using namespace Helium;
 
 /// Destructor.
@@ -13,6 +15,21 @@ PlatformPreprocessor::~PlatformPreprocessor()
 ///
 /// @return  Preferred platform byte order.
 
+/// Get a hash of the settings that affect the data produced by this preprocessor.
+///
+/// This is included in the content key of each preprocessed resource, so preprocessors with additional settings that
+/// change their output (compiler flags, for instance) should override this to include them.
+///
+/// @return  Settings hash.
+uint64_t PlatformPreprocessor::GetSettingsHash() const
+{
+	uint64_t hash = StableHash::SEED;
+	hash = StableHash::AddUint32( hash, static_cast< uint32_t >( GetByteOrder() ) );
+	hash = StableHash::AddUint32( hash, static_cast< uint32_t >( GetShaderProfileCount() ) );
+
+	return hash;
+}
+
 /// @fn size_t PlatformPreprocessor::GetShaderProfileCount() const
 /// Get the number of different shader profiles for the target platform.
 ///
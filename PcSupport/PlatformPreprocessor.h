@@ -55,6 +55,8 @@ namespace Helium
         //@{
         virtual EByteOrder GetByteOrder() const = 0;
         inline bool SwapBytes() const;
+
+        virtual uint64_t GetSettingsHash() const;
         //@}
 
         /// @name Shader Compiling
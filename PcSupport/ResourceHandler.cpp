@@ -33,6 +33,18 @@ void ResourceHandler::GetSourceExtensions( const char* const*& rppExtensions, si
     rExtensionCount = 0;
 }
 
+/// Get the version of the data produced by this handler.
+///
+/// This is included in the content key of each resource preprocessed by this handler, so it should be incremented
+/// whenever a change to the handler changes its output, forcing resources it handles to be preprocessed again.  Each
+/// resource handler overrides this with its own version (starting at one), as this base version does not change.
+///
+/// @return  Preprocessed data version.
+uint32_t ResourceHandler::GetVersion() const
+{
+    return 0;
+}
+
 #if HELIUM_TOOLS
 /// Preprocess and cache the resource data for the given resource for all enabled target platforms.
 ///
@@ -48,6 +60,34 @@ bool ResourceHandler::CacheResource(
 {
     return false;
 }
+
+/// Get the additional files (aside from the source file itself) from which the data for the given resource is
+/// preprocessed, such as files included by the source file.
+///
+/// The contents of these files are included in the content key of the resource, so that changes to them cause the
+/// resource to be preprocessed again.
+///
+/// @param[in]  pResource        Resource object.
+/// @param[in]  rSourceFilePath  Prebuilt path name of the source resource file.
+/// @param[out] rDependencies    Array to which the paths of any dependencies should be added.
+void ResourceHandler::GetSourceDependencies(
+                                            const Resource* /*pResource*/,
+                                            const String& /*rSourceFilePath*/,
+                                            DynamicArray< FilePath >& /*rDependencies*/ ) const
+{
+}
+
+/// Get whether CacheResource() can be called from any thread, concurrently with the caching of other resources.
+///
+/// Resource handlers that rely on shared state that is not thread-safe, or that load other objects while caching a
+/// resource, should leave this disabled, in which case their resources are always preprocessed on the thread
+/// driving the AssetLoader.
+///
+/// @return  True if resources of this type can be cached concurrently, false if not.
+bool ResourceHandler::CanCacheConcurrently() const
+{
+    return false;
+}
 #endif  // HELIUM_TOOLS
 
 
@@ -30,10 +30,14 @@ namespace Helium
         //@{
         virtual const AssetType* GetResourceType() const;
         virtual void GetSourceExtensions( const char* const*& rppExtensions, size_t& rExtensionCount ) const;
+        virtual uint32_t GetVersion() const;
 
 #if HELIUM_TOOLS
         virtual bool CacheResource(
             AssetPreprocessor* pAssetPreprocessor, Resource* pResource, const String& rSourceFilePath );
+        virtual void GetSourceDependencies(
+            const Resource* pResource, const String& rSourceFilePath, DynamicArray< FilePath >& rDependencies ) const;
+        virtual bool CanCacheConcurrently() const;
         
         void SaveObjectToPersistentDataBuffer(Reflect::Object *_object, DynamicArray< uint8_t > &_buffer);
 #endif
@@ -22,6 +22,9 @@ project( prefix .. "Engine" )
 			prefix .. "Persist",
 			prefix .. "Math",
 			prefix .. "MathSimd",
+
+			-- dependencies
+			"zlib",
 		}
 
 project( prefix .. "EngineJobs" )
@@ -558,6 +561,7 @@ project( prefix .. "ExampleGame" )
 
 			"ois",
 			"mongo-c",
+			"zlib",
 		}
 
 project( prefix .. "ExampleMain_PhysicsDemo" )
@@ -642,6 +646,7 @@ project( prefix .. "EmptyGame" )
 
 			"ois",
 			"mongo-c",
+			"zlib",
 		}
 
 project( prefix .. "EmptyMain" )
@@ -748,6 +753,7 @@ project( prefix .. "EmptyMain" )
 		"bullet",
 		"mongo-c",
 		"ois",
+		"zlib",
 	}
 
 	configuration "linux"